@@ -15,6 +15,8 @@
 #include "Utils/VS_TimerSystem.h"
 #include "Physics/VS_CollisionSystem.h"
 #include "Sound/VS_SoundSystem.h"
+#include "Threads/VS_JobSystem.h"
+#include "VS/Graphics/VS_TextureStreamer.h"
 
 #include "VS/Graphics/VS_Scene.h"
 #include "VS/Graphics/VS_Screen.h"
@@ -114,6 +116,8 @@ coreGame::CreateGameSystems()
 {
 	s_system[ GameSystem_Timer ] = new vsTimerSystem;
 	s_system[ GameSystem_Input ] = new vsInput;
+	s_system[ GameSystem_Jobs ] = new vsJobSystem;
+	s_system[ GameSystem_TextureStreaming ] = new vsTextureStreamer;
 #ifdef USE_BOX2D_PHYSICS
 	s_system[ GameSystem_Collision ] = new vsCollisionSystem;
 #endif
@@ -127,6 +131,8 @@ coreGame::DestroyGameSystems()
 {
 	vsDelete( s_system[ GameSystem_Timer] );
 	vsDelete( s_system[ GameSystem_Input] );
+	vsDelete( s_system[ GameSystem_TextureStreaming] );
+	vsDelete( s_system[ GameSystem_Jobs] );
 #ifdef USE_BOX2D_PHYSICS
 	vsDelete( s_system[ GameSystem_Collision] );
 #endif
@@ -250,3 +256,9 @@ coreGame::GetTimer()
 	return (vsTimerSystem *)s_system[GameSystem_Timer];
 }
 
+vsJobSystem *
+coreGame::GetJobs()
+{
+	return (vsJobSystem *)s_system[GameSystem_Jobs];
+}
+
@@ -15,6 +15,8 @@ enum GameSystem
 {
 	GameSystem_Timer,			// this system caps our frame rate
 	GameSystem_Input,			// this system reads input devices
+	GameSystem_Jobs,			// this system runs jobs on worker threads
+	GameSystem_TextureStreaming,	// this system uploads textures which have loaded in the background
 #ifdef USE_BOX2D_PHYSICS
 	GameSystem_Collision,		// this system performs collision tests
 #endif // USE_BOX2D_PHYSICS
@@ -30,6 +32,7 @@ class vsInput;
 class vsCollisionSystem;
 class vsSoundSystem;
 class vsTimerSystem;
+class vsJobSystem;
 
 class coreGame
 {
@@ -92,6 +95,7 @@ public:
 	vsSoundSystem *				GetSound();
 #endif
 	vsTimerSystem *				GetTimer();
+	vsJobSystem *				GetJobs();
 };
 
 #endif // CORE_GAME_H
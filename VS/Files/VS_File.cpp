@@ -8,12 +8,15 @@
  */
 
 #include "VS_File.h"
+#include "VS_Codec.h"
 #include "VS_FileCache.h"
+#include "VS_MappedFile.h"
 #include "VS_Record.h"
 #include "VS_Store.h"
 #include "VS_Mutex.h"
 #include "Core.h"
 #include "CORE_Game.h"
+#include "VS/Threads/VS_JobSystem.h"
 
 #include "VS_PhysFS.h"
 
@@ -88,7 +91,8 @@ namespace
 		"ZLib_Stream",
 		"ZLib_Data",
 		"ZLib_Memory",
-		"ZLib_Version"
+		"ZLib_Version",
+		"CompressedData"
 	};
 
 	vsFile::Error convert_zlib_error( int error )
@@ -281,10 +285,122 @@ namespace {
 struct zipdata
 {
 	z_stream m_zipStream;
+
+	// blocked compressed files only
+	bool m_blocked;
+	const vsCodec *m_codec;
+	uint32_t m_blockSize;		// largest uncompressed size of any block
+	vsStore *m_block;			// writing:  uncompressed data for the block we're filling
+	vsStore *m_packed;			// writing:  that block, once it's been compressed
+	bool m_finished;			// progressive reading:  we've read the end marker
+
+	zipdata():
+		m_blocked(false),
+		m_codec(nullptr),
+		m_blockSize(0),
+		m_block(nullptr),
+		m_packed(nullptr),
+		m_finished(false)
+	{
+	}
+
+	~zipdata()
+	{
+		vsDelete( m_block );
+		vsDelete( m_packed );
+	}
 };
 
 namespace
 {
+	// Blocked compressed files (MODE_WriteCompressedBlocked) look like this:
+	//
+	//   'V' 'S' tag 'B'   where 'tag' is the vsCodec::GetTag() of the codec
+	//                     which compressed the blocks
+	//   uint32            largest uncompressed size of any block
+	//
+	// followed by any number of blocks, each compressed independently, with a
+	// header of its own:
+	//
+	//   uint32    uncompressed size
+	//   uint32    compressed size
+	//   ...       compressed data
+	//
+	// and finally a block header with both sizes zero, to mark the end.  Sizes
+	// are in network byte order, the way vsStore writes them.  A zlib stream
+	// can never start with 'V' (the low four bits of its first byte are always
+	// 8), so the first four bytes tell us which format a file is in.
+	const size_t c_blockedHeaderSize = 8;
+	const size_t c_blockHeaderSize = 8;
+	const uint32_t c_compressedBlockSize = 256 * 1024;
+
+	struct compressedBlock
+	{
+		const char *	in;
+		size_t			inLength;
+		size_t			out;		// offset of this block's data in the whole file
+		size_t			outLength;
+	};
+
+	bool IsBlockedCompressed( const vsStore *store )
+	{
+		const char *data = store->GetReadHead();
+		return store->BytesLeftForReading() >= c_blockedHeaderSize &&
+			data[0] == 'V' && data[1] == 'S' && data[3] == 'B';
+	}
+
+	// Reads the file header of a blocked file, returning its codec and block
+	// size.  Returns nullptr if we don't know the codec.
+	const vsCodec * ReadBlockedHeader( vsStore *compressed, uint32_t *blockSize )
+	{
+		const vsCodec *codec = vsCodec::FindByTag( compressed->GetReadHead()[2] );
+		compressed->AdvanceReadHead( 4 );
+		*blockSize = compressed->ReadUint32();
+		return codec;
+	}
+
+	// Walks the headers of a whole blocked file, to find where each block is
+	// and where its contents go.  Returns nullptr if the headers don't make
+	// sense, or we don't know the codec.
+	const vsCodec * FindCompressedBlocks( vsStore *compressed, vsArray<compressedBlock> *block, size_t *totalLength )
+	{
+		uint32_t blockSize;
+		const vsCodec *codec = ReadBlockedHeader( compressed, &blockSize );
+		if ( !codec )
+			return nullptr;
+
+		*totalLength = 0;
+		for (;;)
+		{
+			if ( compressed->BytesLeftForReading() < c_blockHeaderSize )
+				return nullptr;
+			uint32_t outLength = compressed->ReadUint32();
+			uint32_t inLength = compressed->ReadUint32();
+			if ( inLength == 0 )
+				return codec;
+			if ( outLength > blockSize || inLength > compressed->BytesLeftForReading() )
+				return nullptr;
+
+			compressedBlock b = { compressed->GetReadHead(), inLength, *totalLength, outLength };
+			block->AddItem( b );
+			compressed->AdvanceReadHead( inLength );
+			*totalLength += outLength;
+		}
+	}
+
+	// Decompresses blocks [start,end) into 'out'.  Returns false if any of
+	// them are corrupt.
+	bool DecompressBlocks( const vsCodec *codec, const vsArray<compressedBlock> &block, int start, int end, char *out )
+	{
+		for ( int i = start; i < end; i++ )
+		{
+			const compressedBlock &b = block[i];
+			if ( !codec->Decompress( b.in, b.inLength, out + b.out, b.outLength ) )
+				return false;
+		}
+		return true;
+	}
+
 	vsString MakeWriteFilename( const vsString& in )
 	{
 		vsString out(in);
@@ -310,6 +426,8 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 	m_file(nullptr),
 	m_compressedStore(nullptr),
 	m_store(nullptr),
+	m_mapping(nullptr),
+	m_cacheEntry(nullptr),
 	m_zipData(nullptr),
 	m_ok(true),
 	m_error(ERROR_Ok),
@@ -320,7 +438,7 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 	PROFILE("vsFile::vsFile");
 	vsString filename(filename_in);
 
-	if ( mode == MODE_Write || mode == MODE_WriteDirectly || mode == MODE_WriteCompressed )
+	if ( mode == MODE_Write || mode == MODE_WriteDirectly || mode == MODE_WriteCompressed || mode == MODE_WriteCompressedBlocked )
 	{
 		// Convert our 'user/' filename into a write directory-relative path.
 		vsAssertF(0 == filename.find("user/"), "Code error: trying to write into a file '%s' which isn't in our user-writable directory!", filename_in);
@@ -330,24 +448,53 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 
 	// vsAssert( !DirectoryExists(filename), vsFormatString("Attempted to open directory '%s' as a plain file", filename.c_str()) );
 
-	if ( (mode == MODE_Read || mode == MODE_ReadCompressed) &&
-			vsFileCache::IsFileInCache( filename ) )
+	bool isRead = (mode == MODE_Read || mode == MODE_ReadCompressed || mode == MODE_ReadMapped);
+	bool shouldCache = isRead && vsFileCache::ShouldCache( filename );
+	vsFileCacheEntry *cached = shouldCache ? vsFileCache::Acquire( filename ) : nullptr;
+
+	if ( cached )
 	{
 		PROFILE_CACHED(filename);
-		vsStore *c = vsFileCache::GetFileContents( filename );
-		m_store = new vsStore(*c);
-		m_mode = MODE_Read;
-		m_length = m_store->BufferLength();
-		m_ok = true;
+		// share the cached contents, instead of copying them.
+		_ReadFromCacheEntry( cached );
+	}
+	else if ( mode == MODE_ReadMapped &&
+			(m_mapping = _MapNativeFile( filename )) != nullptr )
+	{
+		PROFILE(filename);
+		if ( shouldCache )
+		{
+			// the cache entry holds its own reference to the mapping.
+			_ReadFromCacheEntry( vsFileCache::Insert( filename, m_mapping ) );
+			m_mapping->ReleaseReference();
+			m_mapping = nullptr;
+		}
+		else
+		{
+			// The vsStore is just a view of the mapping;  no copies, and the OS
+			// pages the file in as our client reads through it.
+			m_store = new vsStore( const_cast<char*>(m_mapping->GetData()), m_mapping->GetLength() );
+			m_mode = MODE_Read;
+			m_length = m_mapping->GetLength();
+			m_ok = true;
+		}
 	}
 	else
 	{
 		PROFILE(filename);
+		if ( mode == MODE_ReadMapped )
+		{
+			// we couldn't map this file;  probably because it's inside an
+			// archive.  Read it the normal way.
+			mode = MODE_Read;
+			m_mode = MODE_Read;
+		}
+
 		if ( mode == MODE_Read || mode == MODE_ReadCompressed || mode == MODE_ReadCompressed_Progressive )
 		{
 			m_file = PHYSFS_openRead( filename.c_str() );
 		}
-		else if ( mode == MODE_Write || mode == MODE_WriteCompressed )
+		else if ( mode == MODE_Write || mode == MODE_WriteCompressed || mode == MODE_WriteCompressedBlocked )
 		{
 			// in normal 'Write' mode, we actually write into a temporary file, and
 			// then move it into position when the file is closed.  We do this so
@@ -389,9 +536,37 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 				//
 				// As a result, we want to buffer our writes!
 			}
+			else if ( mode == MODE_WriteCompressedBlocked )
+			{
+				// Blocked files are compressed a block at a time, as each block
+				// fills up.  Other than that, they're written the same way as
+				// regular compressed files, so from here on we're just
+				// 'WriteCompressed'.
+				mode = MODE_WriteCompressed;
+				m_mode = MODE_WriteCompressed;
+
+				const vsCodec *codec = vsCodec::GetDefault();
+				m_zipData = new zipdata;
+				m_zipData->m_blocked = true;
+				m_zipData->m_codec = codec;
+				m_zipData->m_blockSize = c_compressedBlockSize;
+				m_zipData->m_block = new vsStore( c_compressedBlockSize );
+				m_zipData->m_packed = new vsStore( c_blockHeaderSize + codec->GetMaxCompressedLength( c_compressedBlockSize ) );
+
+				vsStore header( c_blockedHeaderSize );
+				const char magic[4] = { 'V', 'S', codec->GetTag(), 'B' };
+				header.WriteBuffer( magic, sizeof(magic) );
+				header.WriteUint32( c_compressedBlockSize );
+				_WriteFinalBytes_Buffered( header.GetReadHead(), header.BytesLeftForReading() );
+			}
 		}
 		else if ( mode == MODE_WriteDirectly )
 		{
+			// Remove any existing file instead of letting PHYSFS_openWrite()
+			// truncate it in place.  Anybody who has the old file mapped keeps
+			// reading its old contents, rather than crashing when they touch
+			// pages which no longer exist.
+			PHYSFS_delete( filename.c_str() );
 			m_file = PHYSFS_openWrite( filename.c_str() );
 			mode = MODE_Write;
 			m_mode = MODE_Write;
@@ -434,9 +609,6 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 			m_ok = false;
 		}
 
-		bool shouldCache = (filename.find(".win") != vsString::npos) ||
-			(filename.find(".glsl") != vsString::npos);
-
 		if ( mode == MODE_Read )
 		{
 			// in read mode, let's just read out all the data right now in a single
@@ -450,98 +622,47 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 			PHYSFS_close(m_file);
 			m_file = nullptr;
 
-			if ( shouldCache )
-				vsFileCache::SetFileContents( filename, *m_store );
+			if ( shouldCache && m_ok )
+			{
+				// hand our store over to the cache, and read from its copy.
+				vsStore *store = m_store;
+				m_store = nullptr;
+				_ReadFromCacheEntry( vsFileCache::Insert( filename, store ) );
+			}
 		}
 		else if ( mode == MODE_ReadCompressed )
 		{
-			// in COMPRESSED read mode, we can't do the clever thing we did above
-			// where we just made a single store and loaded the whole file into it
-			// all at once, because we don't know how big the file is going to wind
-			// up being.
-			//
-			// So here's what we're going to do;  we're going to load all the data
-			// into a store (as above), decompress it once just to figure out how
-			// big it's going to be, then decompress it AGAIN, into a store that's
-			// the right size to hold it.
+			// in COMPRESSED read mode, we load all the compressed data into a
+			// store (as above), and then decompress the whole thing into
+			// m_store before we return.  Blocked files can be decompressed in
+			// parallel;  regular zlib ones take a single pass.
 
 			vsStore *compressedData = new vsStore( m_length );
 			Store(compressedData);
 			PHYSFS_close(m_file);
 			m_file = nullptr;
 
-			// we're going to read the compressed data TWICE.
-			// First, we're just going to count how many bytes we inflate into.
-			m_zipData = new zipdata;
-			m_zipData->m_zipStream.zalloc = Z_NULL;
-			m_zipData->m_zipStream.zfree = Z_NULL;
-			m_zipData->m_zipStream.opaque = Z_NULL;
-			m_zipData->m_zipStream.avail_in = 0;
-			m_zipData->m_zipStream.next_in = Z_NULL;
-			int ret = inflateInit(&m_zipData->m_zipStream);
-			if ( !_ZLibIsOkay( "inflateInit", ret ) )
-			{
-				m_ok = false;
-				return;
-			}
-
-			uint32_t decompressedSize = 0;
-			const uint32_t zipBufferSize = 1024;
-			char zipBuffer[zipBufferSize];
-			m_zipData->m_zipStream.avail_in = (uInt)compressedData->BytesLeftForReading();
-			m_zipData->m_zipStream.next_in = (Bytef*)compressedData->GetReadHead();
-			do
-			{
-				m_zipData->m_zipStream.avail_out = zipBufferSize;
-				m_zipData->m_zipStream.next_out = (Bytef*)zipBuffer;
-				int ret = inflate(&m_zipData->m_zipStream, Z_NO_FLUSH);
-
-				if ( !_ZLibIsOkay( "inflate", ret ) )
-				{
-					m_ok = false;
-					return;
-				}
-
-				uint32_t decompressedBytes = zipBufferSize - m_zipData->m_zipStream.avail_out;
-				decompressedSize += decompressedBytes;
-
-			}while( m_zipData->m_zipStream.avail_out == 0 );
-			inflateEnd(&m_zipData->m_zipStream);
-
-			m_store = new vsStore( decompressedSize );
-
-			// Now let's decompress it FOR REAL.
-			ret = inflateInit(&m_zipData->m_zipStream);
-			if ( ret != Z_OK )
+			bool inflated = IsBlockedCompressed( compressedData ) ?
+				_DecompressBlocks( compressedData ) :
+				_InflateStream( compressedData );
+			vsDelete( compressedData );
+			if ( !inflated )
 			{
 				m_ok = false;
-				vsAssertF( ret == Z_OK, "File '%s': inflateInit error: %d", filename, ret );
 				return;
 			}
 
-			m_zipData->m_zipStream.avail_in = (uInt)compressedData->BytesLeftForReading();
-			m_zipData->m_zipStream.next_in = (Bytef*)compressedData->GetReadHead();
-			do
-			{
-				m_zipData->m_zipStream.avail_out = zipBufferSize;
-				m_zipData->m_zipStream.next_out = (Bytef*)zipBuffer;
-				int ret = inflate(&m_zipData->m_zipStream, Z_NO_FLUSH);
-				vsAssert(ret != Z_STREAM_ERROR, "Zip State not clobbered in destructor");
-
-				int decompressedBytes = zipBufferSize - m_zipData->m_zipStream.avail_out;
-				m_store->WriteBuffer( zipBuffer, decompressedBytes );
-
-			}while( m_zipData->m_zipStream.avail_out == 0 );
-			inflateEnd(&m_zipData->m_zipStream);
-
 			// and now that we've decompressed all the data, we can drop into
 			// regular 'Read' mode to serve the data to our clients.
 			m_mode = MODE_Read;
-			m_length = decompressedSize;
-			vsDelete( compressedData );
+			m_length = m_store->Length();
 
 			if ( shouldCache )
-				vsFileCache::SetFileContents( filename, *m_store );
+			{
+				vsStore *store = m_store;
+				m_store = nullptr;
+				_ReadFromCacheEntry( vsFileCache::Insert( filename, store ) );
+			}
 		}
 		else if ( mode == MODE_ReadCompressed_Progressive )
 		{
@@ -581,6 +702,46 @@ vsFile::vsFile( const vsString &filename_in, vsFile::Mode mode ):
 				return;
 			}
 
+			// Read the first chunk of the file now, so we can tell whether
+			// it's a blocked file.
+			if ( m_file )
+			{
+				PHYSFS_sint64 n = PHYSFS_readBytes( m_file,
+						m_compressedStore->GetWriteHead(),
+						m_compressedStore->BytesLeftForWriting() );
+				if ( n < (PHYSFS_sint64)m_compressedStore->BytesLeftForWriting() )
+				{
+					PHYSFS_close( m_file );
+					m_file = nullptr;
+				}
+				if ( n > 0 )
+					m_compressedStore->AdvanceWriteHead(n);
+
+				if ( IsBlockedCompressed( m_compressedStore ) )
+				{
+					m_zipData->m_blocked = true;
+					m_zipData->m_codec = ReadBlockedHeader( m_compressedStore, &m_zipData->m_blockSize );
+					if ( !m_zipData->m_codec )
+					{
+						SetError( ERROR_CompressedData );
+						_LogError( "unknown codec" );
+						return;
+					}
+
+					// We decompress blocked files a whole block at a time, so
+					// make sure we have room for one.
+					size_t maxBlockLength = c_blockHeaderSize + m_zipData->m_codec->GetMaxCompressedLength( m_zipData->m_blockSize );
+					if ( m_compressedStore->BufferLength() < maxBlockLength )
+					{
+						vsStore *bigger = new vsStore( maxBlockLength );
+						m_compressedStore->EraseReadBytes();
+						bigger->Append( m_compressedStore );
+						vsDelete( m_compressedStore );
+						m_compressedStore = bigger;
+					}
+				}
+			}
+
 			m_zipData->m_zipStream.avail_in = m_compressedStore->BytesLeftForReading();
 			m_zipData->m_zipStream.next_in = (Bytef*)m_compressedStore->GetReadHead();
 		}
@@ -593,7 +754,8 @@ vsFile::~vsFile()
 	if ( m_mode == MODE_WriteCompressed )
 	{
 		_PumpCompression( nullptr, 0, true );
-		deflateEnd(&m_zipData->m_zipStream);
+		if ( !m_zipData->m_blocked )
+			deflateEnd(&m_zipData->m_zipStream);
 	}
 	else if ( m_mode == MODE_ReadCompressed_Progressive )
 	{
@@ -605,6 +767,10 @@ vsFile::~vsFile()
 	vsDelete( m_compressedStore );
 	vsDelete( m_zipData );
 	vsDelete( m_store );
+	if ( m_mapping )
+		m_mapping->ReleaseReference();
+	if ( m_cacheEntry )
+		vsFileCache::Release( m_cacheEntry );
 	if ( m_file )
 		PHYSFS_close(m_file);
 
@@ -620,6 +786,9 @@ vsFile::~vsFile()
 		{
 			Delete( m_moveOnDestruction ? m_tempFilename : m_filename );
 		}
+
+		// don't let anybody keep reading what was there before.
+		vsFileCache::Invalidate( m_filename );
 	}
 }
 
@@ -667,6 +836,29 @@ vsFile::_DoWriteLiteralBytes( const void* bytes, size_t byteCount )
 	}
 }
 
+void
+vsFile::_ReadFromCacheEntry( vsFileCacheEntry *entry )
+{
+	m_cacheEntry = entry;
+	m_store = new vsStore( const_cast<char*>(entry->GetData()), entry->GetLength() );
+	m_mode = MODE_Read;
+	m_length = entry->GetLength();
+	m_ok = true;
+}
+
+vsMappedFile *
+vsFile::_MapNativeFile( const vsString &filename )
+{
+	PROFILE("vsFile::_MapNativeFile");
+	// PhysFS can tell us which search path entry the file came from.  If that's
+	// a directory, the file is a plain file on disk and we can map it.  If it's
+	// an archive, the path we build here won't exist, and mapping fails.
+	const char* physDir = PHYSFS_getRealDir( filename.c_str() );
+	if ( !physDir )
+		return nullptr;
+	return vsMappedFile::Open( GetFullFilename( filename ) );
+}
+
 bool
 vsFile::Exists( const vsString &filename ) // static method
 {
@@ -1186,6 +1378,45 @@ vsFile::PeekLine( vsString *line )
 	// return result;
 }
 
+bool
+vsFile::ReadLine( const char **line, size_t *length )
+{
+	if ( AtEnd() )
+		return false;
+
+	const char *start = m_store->GetReadHead();
+	size_t bytes = m_store->BytesLeftForReading();
+
+	// lines end at a newline or a null, as above.
+	const char *lineEnd = (const char*)memchr( start, '\n', bytes );
+	if ( !lineEnd )
+		lineEnd = start + bytes;
+	const char *terminator = (const char*)memchr( start, 0, lineEnd - start );
+	if ( terminator )
+		lineEnd = terminator;
+
+	size_t consumed = lineEnd - start;
+	if ( consumed < bytes )
+		consumed++;	// the newline or null
+	m_store->AdvanceReadHead( consumed );
+
+	if ( lineEnd != start && lineEnd[-1] == '\r' )
+		lineEnd--;
+
+	*line = start;
+	*length = lineEnd - start;
+	return true;
+}
+
+bool
+vsFile::PeekLine( const char **line, size_t *length )
+{
+	size_t filePos = m_store->GetReadHeadPosition();
+	bool result = ReadLine(line, length);
+	m_store->SeekReadHeadTo(filePos);
+	return result;
+}
+
 void
 vsFile::Rewind()
 {
@@ -1291,7 +1522,16 @@ vsFile::ReadBytes( void* data, size_t bytes )
 		while ( m_store->BytesLeftForReading() < bytes && !atEnd )
 		{
 			// decompress data from our compressed buffer!
-			if ( m_compressedStore->BytesLeftForReading() )
+			if ( m_zipData->m_blocked )
+			{
+				m_store->EraseReadBytes();
+				if ( !_PumpBlockDecompression( bytes ) )
+				{
+					m_ok = false;
+					return 0;
+				}
+			}
+			else if ( m_compressedStore->BytesLeftForReading() )
 			{
 				m_store->EraseReadBytes();
 
@@ -1407,6 +1647,12 @@ vsFile::_PumpCompression( const void* bytes, size_t byteCount, bool finish )
 {
 	vsAssert( m_mode == MODE_WriteCompressed, "Trying to pump compression when we're not in WriteCompressed mode??" );
 
+	if ( m_zipData->m_blocked )
+	{
+		_PumpBlockCompression( bytes, byteCount, finish );
+		return;
+	}
+
 	const int zipBufferSize = 1024 * 100;
 	char zipBuffer[zipBufferSize];
 	m_zipData->m_zipStream.avail_in = byteCount;
@@ -1430,6 +1676,199 @@ vsFile::_PumpCompression( const void* bytes, size_t byteCount, bool finish )
 	vsAssert( m_zipData->m_zipStream.avail_in == 0, "Didn't compress all the available input data?" );
 }
 
+void
+vsFile::_PumpBlockCompression( const void* bytes, size_t byteCount, bool finish )
+{
+	vsStore *block = m_zipData->m_block;
+	const char *in = (const char*)bytes;
+	while ( byteCount > 0 )
+	{
+		size_t bytesWeCanTake = vsMin( byteCount, block->BytesLeftForWriting() );
+		block->WriteBuffer( in, bytesWeCanTake );
+		in += bytesWeCanTake;
+		byteCount -= bytesWeCanTake;
+
+		if ( block->BytesLeftForWriting() == 0 )
+			_WriteCompressedBlock();
+	}
+
+	if ( finish )
+	{
+		if ( block->BytesLeftForReading() )
+			_WriteCompressedBlock();
+
+		vsStore endMarker( c_blockHeaderSize );
+		endMarker.WriteUint32( 0 );
+		endMarker.WriteUint32( 0 );
+		_WriteFinalBytes_Buffered( endMarker.GetReadHead(), endMarker.BytesLeftForReading() );
+	}
+}
+
+void
+vsFile::_WriteCompressedBlock()
+{
+	vsStore *block = m_zipData->m_block;
+	vsStore *packed = m_zipData->m_packed;
+
+	packed->Clear();
+	packed->WriteUint32( (uint32_t)block->BytesLeftForReading() );
+	packed->WriteUint32( 0 );	// compressed size;  filled in below
+
+	size_t packedLength = m_zipData->m_codec->Compress( block->GetReadHead(), block->BytesLeftForReading(),
+			packed->GetWriteHead(), packed->BytesLeftForWriting() );
+	block->Clear();
+	if ( packedLength == 0 )
+	{
+		SetError( ERROR_CompressedData );
+		_LogError( "compress" );
+		return;
+	}
+
+	packed->RewindWriteHeadTo( sizeof(uint32_t) );
+	packed->WriteUint32( (uint32_t)packedLength );
+	packed->AdvanceWriteHead( packedLength );
+	_WriteFinalBytes_Buffered( packed->GetReadHead(), packed->BytesLeftForReading() );
+}
+
+bool
+vsFile::_InflateStream( vsStore *compressed )
+{
+	// A regular compressed file doesn't tell us how big it's going to be once
+	// it's inflated, so guess, and grow m_store if we guessed too small.
+	// Growing costs a copy, but that's still much cheaper than inflating the
+	// whole file twice to find out how big it is first.
+	z_stream zipStream;
+	zipStream.zalloc = Z_NULL;
+	zipStream.zfree = Z_NULL;
+	zipStream.opaque = Z_NULL;
+	zipStream.avail_in = 0;
+	zipStream.next_in = Z_NULL;
+	int ret = inflateInit(&zipStream);
+	if ( !_ZLibIsOkay( "inflateInit", ret ) )
+		return false;
+
+	m_store = new vsStore( vsMax( compressed->BytesLeftForReading() * 4, (size_t)1024 ) );
+
+	zipStream.avail_in = (uInt)compressed->BytesLeftForReading();
+	zipStream.next_in = (Bytef*)compressed->GetReadHead();
+	do
+	{
+		if ( m_store->BytesLeftForWriting() == 0 )
+		{
+			vsStore *bigger = new vsStore( m_store->BufferLength() * 2 );
+			bigger->Append( m_store );
+			vsDelete( m_store );
+			m_store = bigger;
+		}
+
+		zipStream.avail_out = (uInt)m_store->BytesLeftForWriting();
+		zipStream.next_out = (Bytef*)m_store->GetWriteHead();
+		ret = inflate(&zipStream, Z_NO_FLUSH);
+		m_store->AdvanceWriteHead( (char*)zipStream.next_out - m_store->GetWriteHead() );
+
+		if ( !_ZLibIsOkay( "inflate", ret ) )
+		{
+			inflateEnd(&zipStream);
+			return false;
+		}
+	}while( ret != Z_STREAM_END && zipStream.avail_out == 0 );
+	inflateEnd(&zipStream);
+
+	return true;
+}
+
+bool
+vsFile::_DecompressBlocks( vsStore *compressed )
+{
+	vsArray<compressedBlock> block;
+	size_t totalLength;
+	const vsCodec *codec = FindCompressedBlocks( compressed, &block, &totalLength );
+	if ( !codec )
+	{
+		SetError( ERROR_CompressedData );
+		_LogError( "block headers" );
+		return false;
+	}
+
+	m_store = new vsStore( totalLength );
+	char *out = m_store->WriteSpace( totalLength );
+
+	// Every block was compressed on its own, and we know where each one's
+	// data goes, so we can decompress them all at once, straight into m_store.
+	std::atomic<bool> ok( true );
+	auto decompressBlocks = [codec, &block, &ok, out]( int start, int end )
+	{
+		if ( !DecompressBlocks( codec, block, start, end, out ) )
+			ok = false;
+	};
+
+	vsJobSystem *jobs = vsJobSystem::Instance();
+	if ( jobs )
+		jobs->ParallelFor( 0, block.ItemCount(), 1, decompressBlocks );
+	else
+		decompressBlocks( 0, block.ItemCount() );
+
+	if ( !ok )
+	{
+		SetError( ERROR_CompressedData );
+		_LogError( codec->GetName() );
+		return false;
+	}
+	return true;
+}
+
+bool
+vsFile::_PumpBlockDecompression( size_t bytesWanted )
+{
+	zipdata *zip = m_zipData;
+	while ( !zip->m_finished && m_store->BytesLeftForReading() < bytesWanted )
+	{
+		// We can only decompress whole blocks.
+		if ( m_compressedStore->BytesLeftForReading() < c_blockHeaderSize )
+			return true;	// wait until we've read more from disk
+
+		size_t blockStart = m_compressedStore->GetReadHeadPosition();
+		uint32_t outLength = m_compressedStore->ReadUint32();
+		uint32_t inLength = m_compressedStore->ReadUint32();
+		if ( inLength == 0 )
+		{
+			zip->m_finished = true;
+			return true;
+		}
+		if ( outLength > zip->m_blockSize || inLength > zip->m_codec->GetMaxCompressedLength( zip->m_blockSize ) )
+		{
+			SetError( ERROR_CompressedData );
+			_LogError( "block header" );
+			return false;
+		}
+		if ( m_compressedStore->BytesLeftForReading() < inLength )
+		{
+			m_compressedStore->SeekReadHeadTo( blockStart );
+			return true;	// wait until we've read the rest of the block
+		}
+
+		if ( m_store->BytesLeftForWriting() < outLength )
+		{
+			// make room for the whole block, as well as everything that's
+			// still waiting to be read.
+			vsStore *bigger = new vsStore( m_store->Length() + outLength );
+			bigger->Append( m_store );
+			vsDelete( m_store );
+			m_store = bigger;
+		}
+
+		if ( !zip->m_codec->Decompress( m_compressedStore->GetReadHead(), inLength, m_store->GetWriteHead(), outLength ) )
+		{
+			SetError( ERROR_CompressedData );
+			_LogError( zip->m_codec->GetName() );
+			return false;
+		}
+		m_compressedStore->AdvanceReadHead( inLength );
+		m_store->AdvanceWriteHead( outLength );
+	}
+	return true;
+}
+
 void
 vsFile::StoreBytes( vsStore *s, size_t bytes )
 {
@@ -1499,6 +1938,15 @@ vsFile::GetFullFilename(const vsString &filename_in)
 }
 
 
+const char*
+vsFile::GetContents() const
+{
+	vsAssert( m_mode == MODE_Read, "GetContents() is only supported in read modes!" );
+	if ( !m_ok || !m_store )
+		return nullptr;
+	return m_store->GetBuffer();
+}
+
 bool
 vsFile::AtEnd()
 {
@@ -1661,6 +2109,26 @@ vsFile::IsCompressedFileValid( const vsString& filename, vsString& outError )
 
 	PHYSFS_close(file);
 
+	if ( IsBlockedCompressed( &compressedData ) )
+	{
+		vsArray<compressedBlock> block;
+		size_t totalLength;
+		const vsCodec *codec = FindCompressedBlocks( &compressedData, &block, &totalLength );
+		if ( !codec )
+		{
+			outError = "Block headers are corrupt, or use an unknown codec";
+			return false;
+		}
+
+		vsStore decompressed( totalLength );
+		if ( !DecompressBlocks( codec, block, 0, block.ItemCount(), decompressed.WriteSpace( totalLength ) ) )
+		{
+			outError = vsFormatString("%s data is corrupt", codec->GetName());
+			return false;
+		}
+		return true;
+	}
+
 	z_stream zipStream;
 	zipStream.zalloc = Z_NULL;
 	zipStream.zfree = Z_NULL;
@@ -1682,7 +2150,7 @@ vsFile::IsCompressedFileValid( const vsString& filename, vsString& outError )
 		zipStream.avail_out = zipBufferSize;
 		zipStream.next_out = (Bytef*)zipBuffer;
 		// int ret = inflate(&zipStream, Z_NO_FLUSH);
-		int ret = inflate(&zipStream, Z_SYNC_FLUSH);
+		ret = inflate(&zipStream, Z_SYNC_FLUSH);
 		if ( ret == Z_STREAM_ERROR )
 		{
 			outError = "zlib error:  Z_STREAM_ERROR";
@@ -1693,7 +2161,7 @@ vsFile::IsCompressedFileValid( const vsString& filename, vsString& outError )
 			outError = "zlib error:  Z_DATA_ERROR (file is corrupt on disk)";
 			return false;
 		}
-		if ( ret == Z_DATA_ERROR )
+		if ( ret == Z_MEM_ERROR )
 		{
 			outError = "zlib error:  Z_MEM_ERROR (Out of memory)";
 			return false;
@@ -1705,6 +2173,11 @@ vsFile::IsCompressedFileValid( const vsString& filename, vsString& outError )
 			outError = "zlib error:  Z_VERSION_ERROR (Incompatible version)";
 			return false;
 		}
+		if ( ret == Z_BUF_ERROR && zipStream.avail_in == 0 )
+		{
+			outError = "File is truncated";
+			return false;
+		}
 
 		// uint32_t decompressedBytes = zipBufferSize - zipStream.avail_out;
 		// decompressedSize += decompressedBytes;
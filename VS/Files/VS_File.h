@@ -12,6 +12,8 @@
 
 struct PHYSFS_File;
 
+class vsFileCacheEntry;
+class vsMappedFile;
 class vsRecord;
 class vsStore;
 
@@ -35,6 +37,10 @@ public:
 
 		MODE_ReadCompressed_Progressive, // open an existing file and read from it, decompressing into temporary buffers as we go.  We only support a limited set of read operations, since we won't have the whole thing in memory at once!
 
+		MODE_ReadMapped, // like 'Read', but if the file is a plain file on disk (not inside an archive), memory map it instead of copying it into memory.  Otherwise, falls back to 'Read'.
+
+		MODE_WriteCompressedBlocked, // like 'WriteCompressed', but compresses the data in independent blocks with vsCodec::GetDefault(), so that 'ReadCompressed' can decompress them in parallel.  Both compressed read modes can read either format.
+
 		MODE_MAX
 	};
 
@@ -73,6 +79,7 @@ public:
 		ERROR_ZLib_Data,
 		ERROR_ZLib_Memory,
 		ERROR_ZLib_Version,
+		ERROR_CompressedData, // a blocked compressed file is corrupt, or uses a codec we don't know
 	};
 
 private:
@@ -82,6 +89,8 @@ private:
 
 	vsStore *m_compressedStore;
 	vsStore *m_store;
+	vsMappedFile *m_mapping; // if set, m_store is a view into it
+	vsFileCacheEntry *m_cacheEntry; // if set, m_store is a view into it
 	struct zipdata *m_zipData;
 	bool m_ok;
 	Error m_error;
@@ -98,9 +107,27 @@ private:
 
 	// do some processing of file compression.
 	void _PumpCompression( const void* bytes, size_t byteCount, bool finish );
+	void _PumpBlockCompression( const void* bytes, size_t byteCount, bool finish );
+	void _WriteCompressedBlock();
+
+	// decompress all of 'compressed' into a new m_store, for MODE_ReadCompressed.
+	bool _InflateStream( vsStore *compressed );
+	bool _DecompressBlocks( vsStore *compressed );
+
+	// MODE_ReadCompressed_Progressive on a blocked file;  decompress whole
+	// blocks from m_compressedStore into m_store until it holds 'bytesWanted'
+	// bytes, or we need more data from disk.
+	bool _PumpBlockDecompression( size_t bytesWanted );
 
 	bool _IsWrite() const;
 
+	// takes ownership of a reference to 'entry', and reads from it.
+	void _ReadFromCacheEntry( vsFileCacheEntry *entry );
+
+	// returns nullptr if the file isn't a plain file on the native filesystem,
+	// or couldn't be mapped.
+	static vsMappedFile* _MapNativeFile( const vsString &filename );
+
 	bool _ZLibIsOkay( const char* context, int retval );
 	bool _PhysFSError( const char* context, int retval );
 
@@ -170,6 +197,12 @@ public:
 	bool		PeekLine( vsString *line );
 	bool		ReadLine( vsString *line );
 
+	// As above, but without copying;  'line' points into our own buffer, and
+	// stays valid until this vsFile reads more data or is destroyed.  A
+	// trailing '\r' isn't counted as part of the line.
+	bool		PeekLine( const char **line, size_t *length );
+	bool		ReadLine( const char **line, size_t *length );
+
 	bool		Record_Binary( vsRecord *record );		// returns true if we found or successfully wrote another record
 
 	void		Rewind();
@@ -180,6 +213,7 @@ public:
 	void		ConsumeBytes( size_t bytes ); // ONLY IN READ OPERATIONS.  Count this many bytes as having been read.  (Usually used in combination with the above)
 
 	int			ReadBytes( void* data, size_t bytes ); // this is a more direct version  of aa Read operation.  Will assert if we're not in a Read mode.
+	const char*	GetContents() const; // ONLY IN READ OPERATIONS (not progressive).  The whole file's contents, GetLength() bytes long, without copying them.  Only valid until this vsFile is destroyed.
 	void		WriteBytes( const void* data, size_t bytes ); // this is a more direct version of 'Store'.  Will assert if we're not in a Write mode.
 
 	void		FlushBufferedWrites();
@@ -8,53 +8,261 @@
  */
 
 #include "VS_FileCache.h"
+#include "VS_Array.h"
 #include "VS_HashTable.h"
+#include "VS_MappedFile.h"
+#include "VS_Mutex.h"
 #include "VS_Store.h"
 
-static vsHashTable<vsStore> *s_cache = nullptr;
+namespace
+{
+	// s_mutex protects everything below, and the LRU links of every cached
+	// entry.
+	vsMutex s_mutex;
+	vsHashTable<vsFileCacheEntry*> *s_cache = nullptr;
+	vsArray<vsString> *s_pattern = nullptr;
+
+	vsFileCacheEntry *s_head = nullptr;	// most recently used
+	vsFileCacheEntry *s_tail = nullptr;	// least recently used
+	int s_count = 0;
+	size_t s_bytes = 0;
+	size_t s_budget = 0;
+
+	uint64_t s_hits = 0;
+	uint64_t s_misses = 0;
+	uint64_t s_evictions = 0;
+	uint64_t s_insertions = 0;
+};
+
+vsFileCacheEntry::vsFileCacheEntry( const vsString& filename ):
+	m_filename(filename),
+	m_store(nullptr),
+	m_mapping(nullptr),
+	m_data(nullptr),
+	m_length(0),
+	m_references(1),
+	m_prev(nullptr),
+	m_next(nullptr)
+{
+}
+
+vsFileCacheEntry::~vsFileCacheEntry()
+{
+	vsDelete( m_store );
+	if ( m_mapping )
+		m_mapping->ReleaseReference();
+}
 
 void
-vsFileCache::Startup()
+vsFileCache::Startup( size_t budget )
 {
-	s_cache = new vsHashTable<vsStore>(128);
+	vsScopedLock lock( s_mutex );
+	s_cache = new vsHashTable<vsFileCacheEntry*>(256);
+	s_pattern = new vsArray<vsString>;
+	s_pattern->AddItem( ".win" );
+	s_pattern->AddItem( ".glsl" );
+	s_budget = budget;
+	s_hits = s_misses = s_evictions = s_insertions = 0;
 }
 
 void
 vsFileCache::Shutdown()
 {
+	Purge();
+
+	vsScopedLock lock( s_mutex );
+	vsDelete( s_pattern );
 	vsDelete( s_cache );
 }
 
 void
 vsFileCache::Purge()
 {
-	Shutdown();
-	Startup();
+	vsScopedLock lock( s_mutex );
+	while ( s_head )
+		_Remove( s_head );
+}
+
+void
+vsFileCache::SetBudget( size_t bytes )
+{
+	vsScopedLock lock( s_mutex );
+	s_budget = bytes;
+	while ( s_bytes > s_budget )
+	{
+		_Remove( s_tail );
+		s_evictions++;
+	}
+}
+
+void
+vsFileCache::AddCachePattern( const vsString& pattern )
+{
+	vsScopedLock lock( s_mutex );
+	if ( s_pattern )
+		s_pattern->AddItem( pattern );
 }
 
 bool
-vsFileCache::IsFileInCache(const vsString& filename)
+vsFileCache::ShouldCache( const vsString& filename )
 {
-	if ( !s_cache )
+	vsScopedLock lock( s_mutex );
+	if ( !s_pattern )
 		return false;
 
-	vsStore *s = s_cache->FindItem(filename);
+	for ( int i = 0; i < s_pattern->ItemCount(); i++ )
+	{
+		if ( filename.find( (*s_pattern)[i] ) != vsString::npos )
+			return true;
+	}
+	return false;
+}
+
+vsFileCacheEntry*
+vsFileCache::Acquire( const vsString& filename )
+{
+	vsScopedLock lock( s_mutex );
+	if ( !s_cache )
+		return nullptr;
 
-	return nullptr != s;
+	vsFileCacheEntry **found = s_cache->FindItem( filename );
+	if ( !found )
+	{
+		s_misses++;
+		return nullptr;
+	}
+
+	s_hits++;
+	vsFileCacheEntry *entry = *found;
+	if ( entry != s_head )
+	{
+		_Unlink( entry );
+		_LinkAtHead( entry );
+	}
+	entry->m_references++;
+	return entry;
 }
 
-vsStore*
-vsFileCache::GetFileContents(const vsString& filename)
+vsFileCacheEntry*
+vsFileCache::Insert( const vsString& filename, vsStore *store )
 {
-	vsStore *s = s_cache->FindItem(filename);
-	return s;
+	vsFileCacheEntry *entry = new vsFileCacheEntry( filename );
+	entry->m_store = store;
+	entry->m_data = store->GetBuffer();
+	entry->m_length = store->Length();
+	return _Insert( entry );
+}
+
+vsFileCacheEntry*
+vsFileCache::Insert( const vsString& filename, vsMappedFile *mapping )
+{
+	vsFileCacheEntry *entry = new vsFileCacheEntry( filename );
+	mapping->AddReference();
+	entry->m_mapping = mapping;
+	entry->m_data = mapping->GetData();
+	entry->m_length = mapping->GetLength();
+	return _Insert( entry );
+}
+
+vsFileCacheEntry*
+vsFileCache::_Insert( vsFileCacheEntry *entry )
+{
+	vsScopedLock lock( s_mutex );
+	if ( !s_cache || entry->m_length > s_budget )
+		return entry;	// not cached;  the caller has the only reference.
+
+	// If two threads load the same file at once, the second one to finish
+	// replaces the first one's entry.  The contents are the same either way.
+	vsFileCacheEntry **existing = s_cache->FindItem( entry->m_filename );
+	if ( existing )
+		_Remove( *existing );
+
+	entry->m_references++;	// the cache's reference
+	s_cache->AddItemWithKey( entry, entry->m_filename );
+	_LinkAtHead( entry );
+	s_count++;
+	s_bytes += entry->m_length;
+	s_insertions++;
+
+	while ( s_bytes > s_budget )
+	{
+		_Remove( s_tail );
+		s_evictions++;
+	}
+	return entry;
+}
+
+void
+vsFileCache::Release( vsFileCacheEntry *entry )
+{
+	if ( --entry->m_references == 0 )
+		delete entry;
 }
 
 void
-vsFileCache::SetFileContents(const vsString& filename, const vsStore &store)
+vsFileCache::Invalidate( const vsString& filename )
 {
+	vsScopedLock lock( s_mutex );
 	if ( !s_cache )
 		return;
-	s_cache->AddItemWithKey(store, filename);
+
+	vsFileCacheEntry **existing = s_cache->FindItem( filename );
+	if ( existing )
+		_Remove( *existing );
 }
 
+vsFileCache::Stats
+vsFileCache::GetStats()
+{
+	vsScopedLock lock( s_mutex );
+	Stats stats;
+	stats.hits = s_hits;
+	stats.misses = s_misses;
+	stats.evictions = s_evictions;
+	stats.insertions = s_insertions;
+	stats.entries = s_count;
+	stats.bytes = s_bytes;
+	stats.budget = s_budget;
+	return stats;
+}
+
+void
+vsFileCache::_Unlink( vsFileCacheEntry *entry )
+{
+	if ( entry->m_prev )
+		entry->m_prev->m_next = entry->m_next;
+	else
+		s_head = entry->m_next;
+
+	if ( entry->m_next )
+		entry->m_next->m_prev = entry->m_prev;
+	else
+		s_tail = entry->m_prev;
+
+	entry->m_prev = entry->m_next = nullptr;
+}
+
+void
+vsFileCache::_LinkAtHead( vsFileCacheEntry *entry )
+{
+	entry->m_prev = nullptr;
+	entry->m_next = s_head;
+	if ( s_head )
+		s_head->m_prev = entry;
+	else
+		s_tail = entry;
+	s_head = entry;
+}
+
+void
+vsFileCache::_Remove( vsFileCacheEntry *entry )
+{
+	_Unlink( entry );
+	s_cache->RemoveItemWithKey( entry, entry->m_filename );
+	s_count--;
+	s_bytes -= entry->m_length;
+
+	// drop the cache's reference.  If nobody else is using the entry, this
+	// deletes it.
+	Release( entry );
+}
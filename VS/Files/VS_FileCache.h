@@ -10,20 +10,99 @@
 #ifndef VS_FILECACHE_H
 #define VS_FILECACHE_H
 
+#include <atomic>
+
 class vsStore;
+class vsMappedFile;
+
+// The contents of one cached file.  Entries are immutable and reference
+// counted;  vsFileCache::Acquire() and Insert() hand out a reference, which
+// must be given back with vsFileCache::Release().  An entry which is evicted
+// from the cache while someone is still using it stays alive until they
+// release it.
+class vsFileCacheEntry
+{
+	vsString			m_filename;
+	vsStore *			m_store;	// if set, we own it
+	vsMappedFile *		m_mapping;	// if set, we hold a reference to it
+	const char *		m_data;
+	size_t				m_length;
+	std::atomic<int>	m_references;
+
+	// LRU list;  only meaningful while we're in the cache
+	vsFileCacheEntry *	m_prev;
+	vsFileCacheEntry *	m_next;
+
+	vsFileCacheEntry( const vsString& filename );
+	~vsFileCacheEntry();
+
+	friend class vsFileCache;
+public:
+
+	const vsString&	GetFilename() const { return m_filename; }
+	const char *	GetData() const { return m_data; }
+	size_t			GetLength() const { return m_length; }
+};
+
+// vsFileCache keeps the contents of recently read files in memory, so that
+// vsFile can serve them again without touching the disk or copying them.
+// It's bounded by a byte budget;  when it's over budget, the least recently
+// used files are evicted.  It's safe to use from any thread.
+//
+// Only files matching one of our cache patterns (by default, ".win" and
+// ".glsl") are cached, so that files which change on disk during development
+// get picked up without a Purge().  Games can add patterns for their own
+// frequently loaded files;  an empty pattern matches every file.
 
 class vsFileCache
 {
+	static vsFileCacheEntry* _Insert( vsFileCacheEntry *entry );
+
+	// these expect our mutex to be locked.
+	static void _Unlink( vsFileCacheEntry *entry );
+	static void _LinkAtHead( vsFileCacheEntry *entry );
+	static void _Remove( vsFileCacheEntry *entry );
+
 public:
 
-	static void Startup();
+	static const size_t c_defaultBudget = 64 * 1024 * 1024;
+
+	struct Stats
+	{
+		uint64_t	hits;
+		uint64_t	misses;
+		uint64_t	evictions;
+		uint64_t	insertions;
+		int			entries;
+		size_t		bytes;		// contents of files currently in the cache
+		size_t		budget;
+	};
+
+	static void Startup( size_t budget = c_defaultBudget );
 	static void Shutdown();
-	static void Purge();
+	static void Purge();	// evict everything
+
+	static void SetBudget( size_t bytes );
+	static void AddCachePattern( const vsString& pattern );	// cache files whose names contain 'pattern'
+	static bool ShouldCache( const vsString& filename );
 
-	static bool IsFileInCache(const vsString& filename);
-	static vsStore* GetFileContents(const vsString& filename);
-	static void SetFileContents(const vsString& filename, const vsStore &store);
+	// Returns a reference to the cached contents of 'filename', or nullptr if
+	// it's not in the cache.  Counts as a hit or a miss.
+	static vsFileCacheEntry* Acquire( const vsString& filename );
+
+	// Adds a file's contents to the cache, replacing any previous contents,
+	// and returns a reference to them.  Takes ownership of 'store' (whose
+	// contents we use without copying), or adds a reference to 'mapping'.  A
+	// file bigger than our whole budget isn't cached, but still gets an entry.
+	static vsFileCacheEntry* Insert( const vsString& filename, vsStore *store );
+	static vsFileCacheEntry* Insert( const vsString& filename, vsMappedFile *mapping );
+
+	static void Release( vsFileCacheEntry *entry );
+
+	// Drops our copy of 'filename', if we have one.  (For when it's rewritten)
+	static void Invalidate( const vsString& filename );
+
+	static Stats GetStats();
 };
 
 #endif // VS_FILECACHE_H
-
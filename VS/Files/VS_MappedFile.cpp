@@ -0,0 +1,112 @@
+/*
+ *  VS_MappedFile.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+vsMappedFile::vsMappedFile( const vsString &filename ):
+	m_filename(filename),
+	m_data(nullptr),
+	m_length(0),
+	m_references(1)
+#if defined(_WIN32)
+	,
+	m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+#endif
+{
+}
+
+vsMappedFile::~vsMappedFile()
+{
+#if defined(_WIN32)
+	if ( m_data )
+		UnmapViewOfFile( m_data );
+	if ( m_mapping )
+		CloseHandle( m_mapping );
+	if ( m_file != INVALID_HANDLE_VALUE )
+		CloseHandle( m_file );
+#else
+	if ( m_data )
+		munmap( m_data, m_length );
+#endif
+}
+
+vsMappedFile *
+vsMappedFile::Open( const vsString &nativeFilename )
+{
+	vsMappedFile *result = new vsMappedFile( nativeFilename );
+	if ( !result->_Map() )
+		vsDelete( result );
+	return result;
+}
+
+bool
+vsMappedFile::_Map()
+{
+#if defined(_WIN32)
+	std::wstring wideFilename = std::filesystem::u8path( m_filename ).wstring();
+	m_file = CreateFileW( wideFilename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if ( m_file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( m_file, &size ) || size.QuadPart == 0 )
+		return false;
+	m_length = (size_t)size.QuadPart;
+
+	m_mapping = CreateFileMappingW( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if ( !m_mapping )
+		return false;
+
+	m_data = (char*)MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 );
+	return m_data != nullptr;
+#else
+	int fd = open( m_filename.c_str(), O_RDONLY );
+	if ( fd < 0 )
+		return false;
+
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size == 0 )
+	{
+		close( fd );
+		return false;
+	}
+	m_length = (size_t)st.st_size;
+
+	void *data = mmap( nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0 );
+	// the mapping keeps the file alive on its own;  we don't need the
+	// descriptor any more.
+	close( fd );
+	if ( data == MAP_FAILED )
+		return false;
+
+	// our clients almost always parse files from front to back.
+	madvise( data, m_length, MADV_SEQUENTIAL );
+	m_data = (char*)data;
+	return true;
+#endif
+}
+
+void
+vsMappedFile::ReleaseReference()
+{
+	if ( --m_references == 0 )
+		delete this;
+}
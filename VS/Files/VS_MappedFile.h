@@ -0,0 +1,66 @@
+/*
+ *  VS_MappedFile.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_MAPPEDFILE_H
+#define VS_MAPPEDFILE_H
+
+#include "VS/Utils/VS_String.h"
+#include <atomic>
+
+// vsMappedFile is a read-only memory mapping of a whole file on the native
+// filesystem, so its contents can be read without copying them into a buffer
+// of our own;  the OS pages them in as they're touched, and can drop them
+// again under memory pressure.  It's reference counted, so a single mapping
+// can be shared between every vsFile (and vsFileCache) which is reading it.
+//
+// Normally you don't use this directly;  open a vsFile in MODE_ReadMapped.
+//
+// Since the mapping is read-only, writing into it will crash.  And if some
+// other program truncates the file while we have it mapped, reading the
+// missing part will also crash.  vsFile's own writes are safe:  MODE_Write
+// goes into a temporary file which replaces the original when it's finished,
+// and MODE_WriteDirectly (which vsFile::Copy() and the fallback path of
+// vsFile::Move() use) removes the original before creating its new file.
+// Either way, existing mappings keep looking at the original.  (On Windows,
+// nobody can open a mapped file for writing, so at worst those writes fail)
+
+class vsMappedFile
+{
+	vsString			m_filename;
+	char *				m_data;
+	size_t				m_length;
+	std::atomic<int>	m_references;
+
+#if defined(_WIN32)
+	void *				m_file;
+	void *				m_mapping;
+#endif
+
+	vsMappedFile( const vsString &filename );
+	~vsMappedFile();
+
+	bool		_Map();
+
+public:
+
+	// Maps 'nativeFilename' (a real path, as from vsFile::GetFullFilename()),
+	// and returns it with one reference, which the caller owns.  Returns
+	// nullptr if it couldn't be mapped;  for example, if it's empty, or if it's
+	// actually a file inside an archive.
+	static vsMappedFile *	Open( const vsString &nativeFilename );
+
+	void			AddReference() { m_references++; }
+	void			ReleaseReference();	// deletes the mapping when the last reference is released
+
+	const vsString&	GetFilename() const { return m_filename; }
+	const char *	GetData() const { return m_data; }
+	size_t			GetLength() const { return m_length; }
+};
+
+#endif // VS_MAPPEDFILE_H
@@ -14,15 +14,69 @@
 #include "VS/Math/VS_Vector.h"
 #include "VS/Memory/VS_Serialiser.h"
 
+#include <algorithm>
+
+// Hands out child records for vsRecords in arena mode.  Records are allocated
+// c_blockSize at a time, and ones which have been given back are reused
+// (most recently returned first) before any new ones are handed out.
+class vsRecordArena
+{
+	static const int c_blockSize = 256;
+
+	vsArray<vsRecord*>	m_block;	// each is c_blockSize records long
+	vsArray<vsRecord*>	m_free;
+	int					m_blockUsed;	// how many records we've handed out from our last block
+
+public:
+
+	vsRecordArena():
+		m_block(16),
+		m_free(c_blockSize),
+		m_blockUsed(c_blockSize)
+	{
+	}
+
+	~vsRecordArena()
+	{
+		for ( int i = 0; i < m_block.ItemCount(); i++ )
+			vsDeleteArray( m_block[i] );
+	}
+
+	vsRecord *	Borrow()
+	{
+		if ( !m_free.IsEmpty() )
+		{
+			vsRecord *result = m_free[ m_free.ItemCount()-1 ];
+			m_free.PopBack();
+			return result;
+		}
+
+		if ( m_blockUsed == c_blockSize )
+		{
+			m_block.AddItem( new vsRecord[c_blockSize] );
+			m_blockUsed = 0;
+		}
+		vsRecord *result = &m_block[ m_block.ItemCount()-1 ][ m_blockUsed++ ];
+		result->m_arena = this;
+		return result;
+	}
+
+	void		Return( vsRecord *record )
+	{
+		m_free.AddItem( record );
+	}
+};
+
 vsRecord::vsRecord():
 	m_token(0),
 	m_childList(0),
+	m_arena(nullptr),
+	m_ownsArena(false),
 	m_streamMode(false)
 {
 	m_childList.Clear();
 	m_hasLabel = false;
 	m_lastChild = nullptr;
-	// m_pool = nullptr;
 
 	Init();
 }
@@ -30,12 +84,13 @@ vsRecord::vsRecord():
 vsRecord::vsRecord( const char* fromString ):
 	m_token(0),
 	m_childList(0),
+	m_arena(nullptr),
+	m_ownsArena(false),
 	m_streamMode(false)
 {
 	m_childList.Clear();
 	m_hasLabel = false;
 	m_lastChild = nullptr;
-	// m_pool = nullptr;
 
 	Init();
 	ParseString( fromString );
@@ -44,12 +99,13 @@ vsRecord::vsRecord( const char* fromString ):
 vsRecord::vsRecord( const vsString& fromString ):
 	m_token(0),
 	m_childList(0),
+	m_arena(nullptr),
+	m_ownsArena(false),
 	m_streamMode(false)
 {
 	m_childList.Clear();
 	m_hasLabel = false;
 	m_lastChild = nullptr;
-	// m_pool = nullptr;
 
 	Init();
 	ParseString( fromString );
@@ -57,6 +113,7 @@ vsRecord::vsRecord( const vsString& fromString ):
 
 vsRecord::~vsRecord()
 {
+	SetArenaMode(false);
 	Init(); // to clear out our children.
 }
 
@@ -65,16 +122,17 @@ vsRecord::Init()
 {
 	for ( int i = 0; i < m_childList.ItemCount(); i++ )
 	{
-		// if ( m_childList[i]->m_pool )
-		// {
-		// 	m_childList[i]->Init();
-		// 	m_childList[i]->m_pool->Return(m_childList[i]);
-		// }
-		// else
+		vsRecord *child = m_childList[i];
+		if ( child->m_arena && !child->m_ownsArena )
 		{
-			vsDelete(m_childList[i]);
+			// it came from an arena;  give it back to be reused.
+			child->Init();
+			child->m_arena->Return(child);
+		}
+		else
+		{
+			vsDelete(child);
 		}
-		// vsDelete(m_childList[i]);
 	}
 	m_childList.Clear();
 	m_token.Clear();
@@ -85,6 +143,38 @@ vsRecord::Init()
 	m_lastChild = nullptr;
 }
 
+void
+vsRecord::SetArenaMode( bool arena )
+{
+	if ( arena == m_ownsArena )
+		return;
+
+	Init();
+	if ( arena )
+	{
+		vsAssert( !m_arena, "Can't put a record from an arena into arena mode" );
+		m_arena = new vsRecordArena;
+		m_ownsArena = true;
+	}
+	else
+	{
+		vsDelete( m_arena );
+		m_ownsArena = false;
+	}
+}
+
+vsRecord *
+vsRecord::_NewChild()
+{
+	vsRecord *child = m_arena ? m_arena->Borrow() : new vsRecord;
+
+	// Siblings usually look alike (think of a list of vertices), so make room
+	// for as many tokens as the last one had.
+	if ( m_lastChild )
+		child->m_token.Reserve( m_lastChild->m_token.ItemCount() );
+	return child;
+}
+
 void
 vsRecord::PopulateStringTable( vsStringTable& stringTable )
 {
@@ -118,7 +208,7 @@ vsRecord::SerialiseBinaryV1( vsSerialiser *s, vsStringTable& stringTable )
 	{
 		for ( uint32_t i = 0; i < childCount; i++ )
 		{
-			vsRecord *child = new vsRecord;
+			vsRecord *child = _NewChild();
 			child->SerialiseBinaryV1(s, stringTable);
 			AddChild(child);
 		}
@@ -153,7 +243,7 @@ vsRecord::SerialiseBinaryV2( vsSerialiser *s )
 	{
 		for ( uint32_t i = 0; i < childCount; i++ )
 		{
-			vsRecord *child = new vsRecord;
+			vsRecord *child = _NewChild();
 			child->SerialiseBinaryV2(s);
 			AddChild(child);
 		}
@@ -442,6 +532,21 @@ vsRecord::SetExpectedChildCount( int count )
 	m_childList.Reserve(count);
 }
 
+// vsFile's zero-copy ReadLine() only drops a '\r' from the end of a line, but
+// the vsString version drops them from everywhere.  Match it, copying the line
+// into 'scratch' if we have to.
+static void
+StripCarriageReturns( const char **line, size_t *length, vsString *scratch )
+{
+	if ( memchr( *line, '\r', *length ) )
+	{
+		scratch->assign( *line, *length );
+		scratch->erase( std::remove( scratch->begin(), scratch->end(), '\r' ), scratch->end() );
+		*line = scratch->c_str();
+		*length = scratch->size();
+	}
+}
+
 bool
 vsRecord::Parse( vsFile *file )
 {
@@ -449,31 +554,50 @@ vsRecord::Parse( vsFile *file )
 	bool valid = false;
 	bool haveLine = true;
 
+	vsString lineScratch, nextLineScratch;
+
 	while ( haveLine && (!valid || !done))
 	{
 		done = true;
 
-		vsString parseString;
-		haveLine = file->ReadLine(&parseString);
+		const char *line;
+		size_t lineLength;
+		haveLine = file->ReadLine(&line, &lineLength);
 
 		if ( haveLine )
 		{
-			vsString nextLine;
-			bool haveNextLine = file->PeekLine( &nextLine );
+			StripCarriageReturns( &line, &lineLength, &lineScratch );
+
+			bool parsed = false;
+			const char *nextLine;
+			size_t nextLineLength;
+			bool haveNextLine = file->PeekLine( &nextLine, &nextLineLength );
 			if ( haveNextLine )
 			{
+				StripCarriageReturns( &nextLine, &nextLineLength, &nextLineScratch );
+
 				vsToken t;
-				t.ExtractFrom(nextLine);
+				const char *cursor = nextLine;
+				t.ExtractFrom(cursor, nextLine + nextLineLength);
 				if( t.GetType() == vsToken::Type_OpenBrace )
 				{
 					// next line starts with an open brace -- append the next line to this one, for the purposes of parsing!
 
-					file->ReadLine( &nextLine );
-					parseString = parseString + nextLine;
+					const char *skipped;
+					size_t skippedLength;
+					file->ReadLine( &skipped, &skippedLength );
+
+					vsString parseString( line, lineLength );
+					parseString.append( nextLine, nextLineLength );
+					valid = _ParseTokens( parseString.c_str(), parseString.c_str() + parseString.size() );
+					parsed = true;
 				}
 			}
 
-			valid = ParseString( parseString );
+			if ( !parsed )
+				valid = _ParseTokens( line, line + lineLength );
+
+			AppendToken( vsToken( vsToken::Type_NewLine ) );
 			if ( m_inBlock )
 			{
 				done = false;
@@ -492,16 +616,24 @@ vsRecord::Parse( vsFile *file )
 }
 
 bool
-vsRecord::ParseString( vsString parseString )
+vsRecord::ParseString( const vsString& parseString )
+{
+	bool valid = _ParseTokens( parseString.c_str(), parseString.c_str() + parseString.size() );
+
+	AppendToken( vsToken( vsToken::Type_NewLine ) );
+	return valid;
+}
+
+bool
+vsRecord::_ParseTokens( const char *cursor, const char *end )
 {
 	vsToken t;
 
 	bool valid = false;
 
-
-	while ( !parseString.empty() )
+	while ( cursor != end )
 	{
-		t.ExtractFrom(parseString);
+		t.ExtractFrom(cursor, end);
 		if( t.GetType() != vsToken::Type_None )
 		{
 			valid = true;
@@ -509,7 +641,6 @@ vsRecord::ParseString( vsString parseString )
 		AppendToken(t);
 	}
 
-	AppendToken( vsToken( vsToken::Type_NewLine ) );
 	return valid;
 }
 
@@ -579,7 +710,7 @@ vsRecord::AppendToken( const vsToken &t )
 		}
 		else if ( m_childList.IsEmpty() || (m_lastChild->AppendToken(t) == false) )
 		{
-			AddChild( new vsRecord );
+			AddChild( _NewChild() );
 			m_lastChild->AppendToken(t);
 		}
 	}
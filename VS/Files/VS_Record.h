@@ -23,6 +23,7 @@ class vsSerialiser;
 
 class vsSerialiserReadStream;
 class vsSerialiserWriteStream;
+class vsRecordArena;
 
 #include "VS_Token.h"
 
@@ -35,7 +36,8 @@ class vsRecord
 	vsArray<vsRecord*>	m_childList;
 	vsRecord *	m_lastChild;
 
-	// vsPool<vsRecord> *m_pool;
+	vsRecordArena *	m_arena;	// if set, our children come from here
+	bool		m_ownsArena;	// if not, we came from it ourselves
 
 	bool		m_inBlock;
 	bool		m_hasLabel;
@@ -52,17 +54,31 @@ class vsRecord
 	void		PopulateStringTable( vsStringTable& array );
 	void		Clean();
 
+	bool		_ParseTokens( const char *cursor, const char *end );	// doesn't append the final newline
+	vsRecord *	_NewChild();
+
+	friend class vsRecordArena;
+
 public:
 	vsRecord();
 	vsRecord( const char* fromString );
 	vsRecord( const vsString& fromString );
 	~vsRecord();
 
-	// void		SetPool( vsPool<vsRecord> *pool ) { m_pool = pool; }
 	void		Init();
 
+	// In arena mode, our child records (and their children, and so on) are
+	// allocated in blocks, and when we're Init()ed -- as vsFile::Record()
+	// does before each read -- they're kept to be reused, token storage and
+	// all, rather than freed.  This makes parsing big text files, or reading
+	// lots of records one after another into the same vsRecord, much
+	// cheaper.  The memory isn't released until arena mode is turned off or
+	// we're destroyed, and our children must not be moved into other records.
+	void		SetArenaMode( bool arena );
+	bool		IsArenaMode() const { return m_ownsArena; }
+
 	bool		Parse( vsFile *file );                 // attempt to fill out this vsRecord from a vsString
-	bool		ParseString( vsString string );
+	bool		ParseString( const vsString& string );
 	bool		AppendToken( const vsToken &token );   // add this token to me.
 	vsString	ToString( int childLevel = 0 ) const;  // convert this vsRecord into a vsString.
 
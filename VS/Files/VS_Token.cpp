@@ -10,7 +10,11 @@
 #include "VS_Token.h"
 
 #include "VS/Memory/VS_Serialiser.h"
-#include <stdexcept>
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 // #ifdef MSVC
@@ -48,8 +52,7 @@ static bool IsWhitespace( char c )
 
 static bool IsAlpha( char c )
 {
-	c = toupper(c);
-	return ( (c >= 'A' && c <= 'Z') || c == '_');	// we also allow '_' as an 'alphabetic' character, just because it's often used that way, to separate words inside a single label string
+	return ( (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_');	// we also allow '_' as an 'alphabetic' character, just because it's often used that way, to separate words inside a single label string
 }
 
 static bool IsNumeric( char c )
@@ -64,89 +67,53 @@ static bool IsAlphaNumeric( char c )
 }
 
 
-static void RemoveLeadingWhitespace( vsString &string )
+static void SkipWhitespace( const char *&cursor, const char *end )
 {
-	bool done = false;
-
-	while(!done)
-	{
-		done = true;
-
-		if ( !string.empty() && IsWhitespace(string[0]) )
-		{
-			string.erase(0,1);
-			done = false;
-		}
-	}
+	while ( cursor != end && IsWhitespace(*cursor) )
+		cursor++;
 }
 
 
-static vsString ExtractStringToken( vsString &string )
+static void ExtractStringToken( vsString *output, const char *&cursor, const char *end )
 {
-	vsAssert(string[0] == '\"', "Tried to extract a string that didn't start with \"!");
-
-	vsString result;
+	vsAssert(*cursor == '\"', "Tried to extract a string that didn't start with \"!");
 
-	//result.append( 1, string[0] );	// get first '"'
-	string.erase(0,1);
+	output->clear();
+	cursor++;	// skip the first '"'
 
-	bool escaped = false;
-	while( !string.empty() && string[0] ){
-		if ( escaped )
+	// copy across runs of unescaped characters in one go.
+	const char *run = cursor;
+	while ( cursor != end && *cursor )
+	{
+		if ( *cursor == '\"' )
 		{
-			if ( string[0] == 'n' )
-			{
-				result.append( 1, '\n' );
-			}
-			else
-			{
-				result.append( 1, string[0] );
-			}
-			escaped = false;
+			break; // end of string!
 		}
-		else
+		else if ( *cursor == '\\' )
 		{
-			if ( string[0] == '\"' )
-			{
-				break; // end of string!
-			}
-			else if ( string[0] == '\\' )
+			output->append( run, cursor - run );
+			cursor++;
+			if ( cursor == end || !*cursor )
 			{
-				escaped = true;
-			}
-			else
-			{
-				result.append( 1, string[0] );
+				run = cursor;
+				break;
 			}
+			output->append( 1, (*cursor == 'n') ? '\n' : *cursor );
+			run = cursor+1;
 		}
-		string.erase(0,1);
+		cursor++;
 	}
-	//result.append( 1, string[0] );	// get last '"'
-	string.erase(0,1);
+	output->append( run, cursor - run );
 
-	return result;
+	if ( cursor != end )
+		cursor++;	// skip the last '"'
 }
 
-static vsString ExtractWhitespaceStringToken( vsString &string )	// pull out a string defined by whitespace
+static const char * FindWhitespace( const char *cursor, const char *end )	// find the end of a string defined by whitespace
 {
-	vsString label;
-
-	size_t len = string.length();
-	size_t index = 0;
-
-	for ( index = 0; index < len; index++ )
-	{
-		if ( IsWhitespace(string[index]) )	// this character is whitespace, so isn't part of the label
-		{
-			index--;					// back up one character
-			break;						// exit the loop
-		}
-	}
-
-	label = string.substr(0, index+1);
-	string.erase(0,index+1);
-
-	return label;
+	while ( cursor != end && !IsWhitespace(*cursor) )
+		cursor++;
+	return cursor;
 }
 
 // static vsString ExtractLabelToken( vsString &string )
@@ -198,28 +165,83 @@ static vsString ExtractWhitespaceStringToken( vsString &string )	// pull out a s
 // }
 //
 
-static vsString PeekNumberToken( vsString &string )
+static bool PeekNumberTokenHasDecimal( const char *cursor, const char *end )
 {
-	vsAssert(::IsNumeric(string[0]), "Tried to extract a number from something that isn't a number!");
-	// okay.  We need to find
-	vsString numberString;
+	vsAssert(::IsNumeric(*cursor), "Tried to extract a number from something that isn't a number!");
 
-	size_t len = string.length();
-	size_t index = 0;
+	for ( ; cursor != end && ::IsNumeric(*cursor); cursor++ )
+	{
+		if ( *cursor == '.' )
+			return true;
+	}
+	return false;
+}
+
+// A fast path for the plain decimal numbers we write ourselves (like
+// "-12.500000").  With few enough digits, the mantissa and the power of ten
+// are both exact as doubles, so dividing them gives a correctly rounded
+// double, which rounds to the same float strtof() would give us, unless it
+// landed exactly halfway between two floats.  Anything else (exponents, too
+// many digits, halfway cases, denormals) is left for strtof().
+static bool ParseSimpleFloat( const char *cursor, const char *end, float *output, const char **numberEnd )
+{
+	static const double c_powerOfTen[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const int c_maxDigits = 15;	// 10^15 < 2^53
+	const int c_maxFractionDigits = 22;
+
+	const char *c = cursor;
+	bool negative = false;
+	if ( *c == '-' || *c == '+' )
+	{
+		negative = ( *c == '-' );
+		c++;
+	}
 
-	for ( index = 0; index < len; index++ )
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int significantDigits = 0;
+	int fractionDigits = 0;
+	bool haveDecimal = false;
+	for ( ; c != end; c++ )
 	{
-		if ( !IsNumeric(string[index]) )	// this character isn't alphabetic, so isn't part of the label
+		if ( *c >= '0' && *c <= '9' )
 		{
-			index--;					// back up one character
-			break;						// exit the loop
+			mantissa = mantissa * 10 + (*c - '0');
+			digits++;
+			if ( mantissa != 0 )
+				significantDigits++;
+			if ( haveDecimal )
+				fractionDigits++;
 		}
+		else if ( *c == '.' && !haveDecimal )
+			haveDecimal = true;
+		else
+			break;
+
+		if ( significantDigits > c_maxDigits || fractionDigits > c_maxFractionDigits )
+			return false;
 	}
+	if ( digits == 0 || ( c != end && ( *c == 'e' || *c == 'E' ) ) )
+		return false;
 
-	numberString = string.substr(0, index+1);
-	return numberString;
-}
+	double value = (double)mantissa / c_powerOfTen[fractionDigits];
+	if ( value != 0.0 && ( value < FLT_MIN || value > FLT_MAX ) )
+		return false;
+
+	uint64_t bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	const uint64_t c_extraBits = (1ull << 29) - 1;	// double mantissa bits which don't fit in a float
+	if ( (bits & c_extraBits) == (1ull << 28) )
+		return false;
 
+	*output = negative ? -(float)value : (float)value;
+	*numberEnd = c;
+	return true;
+}
 
 
 vsToken::vsToken():
@@ -283,152 +305,193 @@ vsToken::~vsToken()
 }
 
 bool
-vsToken::ExtractLabelString( vsString* output, vsString& input )
+vsToken::ExtractLabelString( const char *&cursor, const char *end )
 {
-	if ( !::IsAlpha( input[0] ) )
+	if ( !::IsAlpha( *cursor ) )
 		return false;
 
-	while ( ::IsAlphaNumeric( input[0] ) )
-	{
-		output->push_back(input[0]);
-		input.erase(0,1);
-	}
+	const char *start = cursor;
+	while ( cursor != end && ::IsAlphaNumeric( *cursor ) )
+		cursor++;
+
+	SetType( Type_Label );
+	m_string.assign( start, cursor - start );
 	return true;
 }
 
 bool
-vsToken::ExtractFloat( float* output, vsString& input )
+vsToken::ExtractFloat( float* output, const char *&cursor, const char *end )
 {
-	if (!::IsNumeric(input[0]))
+	if (!::IsNumeric(*cursor))
 		return false;
 
-	vsString numberToken = PeekNumberToken(input);
-	if ( numberToken.find('.') == vsString::npos )
+	if ( !PeekNumberTokenHasDecimal(cursor, end) )
 		return false;
 
-	size_t bytesProcessed = 0;
-	float val = 0.f;
-	try
+	const char *simpleEnd;
+	if ( ParseSimpleFloat( cursor, end, output, &simpleEnd ) )
 	{
-		val = std::stof( input.c_str(), &bytesProcessed );
-
-		*output = val;
-		input.erase(0,bytesProcessed);
+		cursor = simpleEnd;
 		return true;
 	}
-	catch(std::out_of_range& oor)
+
+	// strtof() needs a terminated string, and our text might not be, so copy
+	// out everything (within reason) which could be part of the number.
+	char buffer[64];
+	size_t length = 0;
+	while ( cursor+length != end && length < sizeof(buffer)-1 &&
+			( ::IsNumeric(cursor[length]) || cursor[length] == 'e' || cursor[length] == 'E' ) )
 	{
-		vsLog("Token '%s' out of float range", input);
-		*output = 0;
-		return true;
+		buffer[length] = cursor[length];
+		length++;
 	}
-	catch(std::exception& e)
+	buffer[length] = 0;
+
+	char *numberEnd = nullptr;
+	errno = 0;
+	float val = strtof( buffer, &numberEnd );
+	if ( numberEnd == buffer )
+		return false;
+
+	cursor += numberEnd - buffer;
+	if ( errno == ERANGE )
 	{
+		vsLog("Token '%s' out of float range", buffer);
+		val = 0.f;
 	}
-	return false;
+	*output = val;
+	return true;
 }
 
 bool
-vsToken::ExtractInteger( int* output, vsString& input )
+vsToken::ExtractInteger( int* output, const char *&cursor, const char *end )
 {
-	if (!::IsNumeric(input[0]))
+	if (!::IsNumeric(*cursor))
 		return false;
 
-	size_t bytesProcessed = 0;
-	int val = 0;
-	try
+	const char *c = cursor;
+	bool negative = false;
+	if ( *c == '-' || *c == '+' )
 	{
-		val = std::stoi( input.c_str(), &bytesProcessed );
-
-		*output = val;
-		input.erase(0,bytesProcessed);
-		return true;
+		negative = ( *c == '-' );
+		c++;
 	}
-	catch(std::out_of_range& oor)
+	if ( c == end || *c < '0' || *c > '9' )
+		return false;
+
+	const char *digits = c;
+	int64_t val = 0;
+	bool outOfRange = false;
+	for ( ; c != end && *c >= '0' && *c <= '9'; c++ )
 	{
-		vsLog("Token '%s' out of int range", input);
-		*output = 0;
-		return true;
+		val = val * 10 + (*c - '0');
+		if ( val > (int64_t)INT_MAX + 1 )
+		{
+			outOfRange = true;
+			val = 0;
+		}
 	}
-	catch(std::exception& e)
+	if ( negative )
+		val = -val;
+
+	if ( outOfRange || val > INT_MAX || val < INT_MIN )
 	{
+		vsLog("Token '%s' out of int range", vsString(digits, c));
+		val = 0;
 	}
-	return false;
+	*output = (int)val;
+	cursor = c;
+	return true;
 }
 
 bool
 vsToken::ExtractFrom( vsString &string )
 {
-	vsString labelResult;
+	const char *cursor = string.c_str();
+	const char *end = cursor + string.size();
+	bool result = ExtractFrom( cursor, end );
+	if ( result )
+		string.erase( 0, cursor - string.c_str() );
+	else
+		string.clear();	// there was nothing left but whitespace or a comment
+	return result;
+}
+
+bool
+vsToken::ExtractFrom( const char *&cursor, const char *end )
+{
 	float floatResult;
 	int intResult;
 
 	SetType( Type_None );
 
-	RemoveLeadingWhitespace(string);
+	SkipWhitespace(cursor, end);
 
-	if ( !string.empty() )
+	if ( cursor != end )
 	{
-		if ( string[0] == '\"' )
+		if ( *cursor == '\"' )
 		{
-			SetString( ExtractStringToken(string) );
+			SetType( Type_String );
+			ExtractStringToken( &m_string, cursor, end );
 			return true;
 		}
-		else if ( string[0] == '{' )
+		else if ( *cursor == '{' )
 		{
 			SetType( Type_OpenBrace );
-			string.erase(0,1);
+			cursor++;
 			return true;
 		}
-		else if ( string[0] == '}' )
+		else if ( *cursor == '}' )
 		{
 			SetType( Type_CloseBrace );
-			string.erase(0,1);
+			cursor++;
 			return true;
 		}
-		else if ( string[0] == ';' )
+		else if ( *cursor == ';' )
 		{
 			SetType( Type_Semicolon );
-			string.erase(0,1);
+			cursor++;
 			return true;
 		}
-		else if ( string[0] == '\n' )
+		else if ( *cursor == '\n' )
 		{
 			SetType( Type_NewLine );
-			string.erase(0,1);
+			cursor++;
 			return true;
 		}
-		else if ( ExtractLabelString(&labelResult, string) )
+		else if ( ExtractLabelString(cursor, end) )
 		{
-			SetLabel( labelResult );
 			return true;
 		}
-		else if ( ExtractFloat(&floatResult, string) )
+		else if ( ExtractFloat(&floatResult, cursor, end) )
 		{
 			SetFloat(floatResult);
 			return true;
 		}
-		else if ( ExtractInteger(&intResult, string) )
+		else if ( ExtractInteger(&intResult, cursor, end) )
 		{
 			SetInteger(intResult);
 			return true;
 		}
-		else if ( string[0] == '#' )
+		else if ( *cursor == '#' )
 		{
 			// comment!  Consume the rest of the line!
-			string = vsEmptyString;
+			cursor = end;
 		}
-		else if ( string[0] == '=' )
+		else if ( *cursor == '=' )
 		{
 			SetType( Type_Equals );
-			string.erase(0,1);
+			cursor++;
 			return true;
 		}
 		else
 		{
 			// no clue what it was!  Just treat it as a string, breaking at the next whitespace
 
-			SetString( ExtractWhitespaceStringToken(string) );
+			const char *start = cursor;
+			cursor = FindWhitespace(cursor, end);
+			SetType( Type_String );
+			m_string.assign( start, cursor - start );
 			return true;
 		}
 	}
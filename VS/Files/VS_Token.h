@@ -42,9 +42,9 @@ private:
 	};
 	void SetStringField( const vsString& s );
 
-	bool ExtractLabelString( vsString* output, vsString& input );
-	bool ExtractFloat( float* output, vsString& input );
-	bool ExtractInteger( int* output, vsString& input );
+	bool ExtractLabelString( const char *&cursor, const char *end );
+	bool ExtractFloat( float* output, const char *&cursor, const char *end );
+	bool ExtractInteger( int* output, const char *&cursor, const char *end );
 
 public:
 
@@ -60,6 +60,12 @@ public:
 
 	bool		ExtractFrom( vsString &string );
 
+	// As above, but reads from the text between 'cursor' and 'end', and
+	// advances 'cursor' past whatever it extracted, without modifying or
+	// copying the text.  The only allocation is for a label or string token
+	// too long to fit inside our own vsString.
+	bool		ExtractFrom( const char *&cursor, const char *end );
+
 	// back to a string, exactly as we were extracted from.
 	//
 	// N.B.: If we're of "String" type, the returned string will have quotes
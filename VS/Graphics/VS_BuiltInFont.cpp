@@ -324,6 +324,7 @@ vsBuiltInFont::CreateString_Internal(const char* string, float size, float capSi
 	vsDisplayList loader(1024 * 10);
 
 	CreateStringInDisplayList( &loader, string, size, capSize, j, maxWidth );
+	loader.Optimise();
 
 	size_t displayListSize = loader.GetSize();
 	if ( displayListSize )
@@ -460,6 +461,7 @@ vsBuiltInFont::CreateCharacter(char c, float size, float capSize)
 	vsDisplayList loader(1024);
 
 	BuildDisplayListFromCharacter( &loader, c, size, capSize );
+	loader.Optimise();
 
 	vsDisplayList *result = new vsDisplayList( loader.GetSize() );
 	result->Append(loader);
@@ -110,6 +110,7 @@ public:
 	// positive Y axis will be used)
 	void				LookAt( const vsVector3D &lookat, const vsVector3D &upDirection = vsVector3D::YAxis );
 
+	const vsFrustum &	GetFrustum() const { return m_frustum; }
 	bool				IsPositionVisible( const vsVector3D &pos, float r=0.f ) const;
 
 	enum VisibilityType
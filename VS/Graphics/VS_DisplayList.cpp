@@ -26,6 +26,8 @@
 #include "SDL2/SDL_opengl.h"
 #endif
 
+#include <type_traits>
+
 static vsString g_opCodeName[vsDisplayList::OpCode_MAX] =
 {
 	"SetColor",
@@ -131,6 +133,7 @@ vsDisplayList::Load_Vec( const vsString &filename )
 
 	vsFile *file = new vsFile(filename + vsString(".vec"));
 	vsRecord r;
+	r.SetArenaMode(true);
 
 	vsMaterial *materialList[MAX_OWNED_MATERIALS];
 	int materialCount = 0;
@@ -143,6 +146,7 @@ vsDisplayList::Load_Vec( const vsString &filename )
 	delete file;
 
 	vsAssert(loader->GetSize() > 0.f, "Didn't get any operations in a loaded display list!" )
+	loader->Optimise();
 	vsDisplayList *result = new vsDisplayList( loader->GetSize() );
 	for ( int i = 0; i < materialCount; i++ )
 	{
@@ -167,6 +171,7 @@ vsDisplayList::Load_Vec( vsRecord *record )
 	}
 
 	vsAssert(loader->GetSize() > 0.f, "Didn't get any operations in a loaded display list!" )
+	loader->Optimise();
 	vsDisplayList *result = new vsDisplayList( loader->GetSize() );
 
 	result->Append(*loader);
@@ -390,6 +395,7 @@ vsDisplayList::Load_Obj( const vsString &filename )
 	delete file;
 
 	vsAssert(loader->GetSize() > 0, "Didn't get any operations in a loaded display list!" )
+	loader->Optimise();
 	vsLog("Display list is %d bytes", loader->GetSize());
 	vsDisplayList *result = new vsDisplayList( loader->GetSize() );
 	result->Append(*loader);
@@ -466,12 +472,24 @@ vsDisplayList::vsDisplayList( size_t memSize, bool resizable ):
 	m_colorSet(false)
 {
 	m_fifo = new vsStore(memSize);
+	m_ownsFifo = true;
 	if ( resizable )
 		SetResizable();
 
 	Clear();
 }
 
+vsDisplayList::vsDisplayList( vsStore &fifo ):
+	m_fifo(&fifo),
+	m_ownsFifo(false),
+	m_instanceParent(nullptr),
+	m_instanceCount(0),
+	m_materialCount(0),
+	m_colorSet(false)
+{
+	Clear();
+}
+
 void
 vsDisplayList::SetResizable()
 {
@@ -489,7 +507,8 @@ vsDisplayList::~vsDisplayList()
 
 	if ( m_fifo )
 	{
-		delete m_fifo;
+		if ( m_ownsFifo )
+			delete m_fifo;
 		m_fifo = nullptr;
 	}
 	else if ( m_instanceParent )
@@ -540,8 +559,7 @@ vsDisplayList::Rewind()
 void
 vsDisplayList::SetColor( const vsColor &color )
 {
-	m_fifo->WriteUint8( OpCode_SetColor );
-	m_fifo->WriteColor( color );
+	WriteOp( OpCode_SetColor, color );
 	m_nextLineColor = color;
 	m_colorSet = true;
 }
@@ -565,8 +583,7 @@ vsDisplayList::LineTo( const vsVector3D &pos )
 
 	if ( m_colorSet )
 	{
-		m_fifo->WriteUint8( OpCode_SetColor );
-		m_fifo->WriteColor( c_white );
+		WriteOp( OpCode_SetColor, c_white );
 
 		c[0] = m_cursorColor;
 		c[1] = m_nextLineColor;
@@ -623,8 +640,7 @@ vsDisplayList::DrawLine( const vsVector3D &from, const vsVector3D &to )
 void
 vsDisplayList::PushTransform( const vsTransform2D &t )
 {
-	m_fifo->WriteUint8( OpCode_PushTransform );
-	m_fifo->WriteTransform2D( t );
+	WriteOp( OpCode_PushTransform, t );
 //    PushMatrix4x4( t.GetMatrix() );
 }
 
@@ -644,143 +660,128 @@ vsDisplayList::PushTransform( const vsTransform3D &t )
 void
 vsDisplayList::PushMatrix4x4( const vsMatrix4x4 &m )
 {
-	m_fifo->WriteUint8( OpCode_PushMatrix4x4 );
-	m_fifo->WriteMatrix4x4( m );
+	WriteOp( OpCode_PushMatrix4x4, m );
 }
 
 void
 vsDisplayList::SetMatrix4x4( const vsMatrix4x4 &m )
 {
-	m_fifo->WriteUint8( OpCode_SetMatrix4x4 );
-	m_fifo->WriteMatrix4x4( m );
+	WriteOp( OpCode_SetMatrix4x4, m );
 }
 
 void
 vsDisplayList::SetMatrices4x4( const vsMatrix4x4 *m, int count )
 {
-	m_fifo->WriteUint8( OpCode_SetMatrices4x4 );
-	m_fifo->WriteUint32( count );
-	m_fifo->WriteVoidStar( (char*)m );
+	uint32_t count32 = count;
+	char *payload = WriteOpHeader( OpCode_SetMatrices4x4, sizeof(void*) + sizeof(uint32_t) );
+	memcpy( payload, &m, sizeof(void*) );
+	memcpy( payload + sizeof(void*), &count32, sizeof(uint32_t) );
 }
 
 void
 vsDisplayList::SetMatrices4x4Buffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_SetMatrices4x4Buffer );
-	m_fifo->WriteVoidStar( (char*)buffer );
+	WritePointerOp( OpCode_SetMatrices4x4Buffer, buffer );
 }
 
 void
 vsDisplayList::SetColors( const vsColor *c, int count )
 {
-	m_fifo->WriteUint8( OpCode_SetColors );
-	m_fifo->WriteUint32( count );
-	m_fifo->WriteVoidStar( (char*)c );
+	uint32_t count32 = count;
+	char *payload = WriteOpHeader( OpCode_SetColors, sizeof(void*) + sizeof(uint32_t) );
+	memcpy( payload, &c, sizeof(void*) );
+	memcpy( payload + sizeof(void*), &count32, sizeof(uint32_t) );
 }
 
 void
 vsDisplayList::SetColorsBuffer( const vsRenderBuffer *b )
 {
-	m_fifo->WriteUint8( OpCode_SetColorsBuffer );
-	m_fifo->WriteVoidStar( (char*)b );
+	WritePointerOp( OpCode_SetColorsBuffer, b );
 }
 
 void
 vsDisplayList::SnapMatrix()
 {
-	m_fifo->WriteUint8( OpCode_SnapMatrix );
+	WriteOp( OpCode_SnapMatrix );
 }
 
 void
 vsDisplayList::SetShaderValues( vsShaderValues *values )
 {
-	m_fifo->WriteUint8( OpCode_SetShaderValues );
-	m_fifo->WriteVoidStar( (char*)values );
+	WritePointerOp( OpCode_SetShaderValues, values );
 }
 
 void
 vsDisplayList::ClearShaderValues()
 {
-	m_fifo->WriteUint8( OpCode_ClearShaderValues );
+	WriteOp( OpCode_ClearShaderValues );
 }
 
 void
 vsDisplayList::PushShaderOptions( const vsShaderOptions &options )
 {
-	m_fifo->WriteUint8( OpCode_PushShaderOptions );
-	m_fifo->WriteUint32( options.mask );
-	m_fifo->WriteUint32( options.value );
+	WriteOp( OpCode_PushShaderOptions, options );
 }
 
 void
 vsDisplayList::PopShaderOptions()
 {
-	m_fifo->WriteUint8( OpCode_PopShaderOptions );
+	WriteOp( OpCode_PopShaderOptions );
 }
 
 void
 vsDisplayList::SetWorldToViewMatrix4x4( const vsMatrix4x4 &m )
 {
-	m_fifo->WriteUint8( OpCode_SetWorldToViewMatrix4x4 );
-	m_fifo->WriteMatrix4x4( m );
+	WriteOp( OpCode_SetWorldToViewMatrix4x4, m );
 }
 
 void
 vsDisplayList::PushTranslation( const vsVector3D &offset )
 {
-	m_fifo->WriteUint8( OpCode_PushTranslation );
-	m_fifo->WriteVector3D( offset );
+	WriteOp( OpCode_PushTranslation, offset );
 }
 
 void
 vsDisplayList::SetCameraTransform( const vsTransform2D &t )
 {
-	m_fifo->WriteUint8( OpCode_SetCameraTransform );
-	m_fifo->WriteTransform2D( t );
+	WriteOp( OpCode_SetCameraTransform, t );
 }
 
 void
 vsDisplayList::Set3DProjection( float fov, float nearPlane, float farPlane )
 {
-	m_fifo->WriteUint8( OpCode_Set3DProjection );
-	m_fifo->WriteFloat(fov);
-	m_fifo->WriteFloat(nearPlane);
-	m_fifo->WriteFloat(farPlane);
+	float *payload = (float*)WriteOpHeader( OpCode_Set3DProjection, 3 * sizeof(float) );
+	payload[0] = fov;
+	payload[1] = nearPlane;
+	payload[2] = farPlane;
 }
 
 void
 vsDisplayList::SetProjectionMatrix4x4( const vsMatrix4x4 &m )
 {
-	m_fifo->WriteUint8( OpCode_SetProjectionMatrix4x4 );
-	m_fifo->WriteMatrix4x4( m );
+	WriteOp( OpCode_SetProjectionMatrix4x4, m );
 }
 
 void
 vsDisplayList::PopTransform()
 {
-	m_fifo->WriteUint8( OpCode_PopTransform );
+	WriteOp( OpCode_PopTransform );
 }
 
 void
 vsDisplayList::VertexArray( const vsVector2D *array, int arrayCount )
 {
-	m_fifo->WriteUint8( OpCode_VertexArray );
-	m_fifo->WriteUint32( arrayCount );
+	vsVector3D *payload = (vsVector3D*)WriteOpHeader( OpCode_VertexArray, sizeof(vsVector3D) * arrayCount );
 	for ( int i = 0; i < arrayCount; i++ )
 	{
-		m_fifo->WriteVector3D( array[i] );
+		payload[i] = array[i];
 	}
 }
 
 void
 vsDisplayList::VertexArray( const vsVector3D *array, int arrayCount )
 {
-	m_fifo->WriteUint8( OpCode_VertexArray );
-	m_fifo->WriteUint32( arrayCount );
-	for ( int i = 0; i < arrayCount; i++ )
-	{
-		m_fifo->WriteVector3D( array[i] );
-	}
+	memcpy( WriteOpHeader( OpCode_VertexArray, sizeof(vsVector3D) * arrayCount ), array, sizeof(vsVector3D) * arrayCount );
 }
 
 void
@@ -789,19 +790,13 @@ vsDisplayList::VertexBuffer( vsRenderBuffer *buffer )
 	vsAssert(buffer->GetContentType() == vsRenderBuffer::ContentType_Custom ||
 			buffer->GetContentType() == vsRenderBuffer::ContentType_P,
 			"Known render buffer types should use ::BindBuffer");
-	m_fifo->WriteUint8( OpCode_VertexBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_VertexBuffer, buffer );
 }
 
 void
 vsDisplayList::NormalArray( const vsVector3D *array, int arrayCount )
 {
-	m_fifo->WriteUint8( OpCode_NormalArray );
-	m_fifo->WriteUint32( arrayCount );
-	for ( int i = 0; i < arrayCount; i++ )
-	{
-		m_fifo->WriteVector3D( array[i] );
-	}
+	memcpy( WriteOpHeader( OpCode_NormalArray, sizeof(vsVector3D) * arrayCount ), array, sizeof(vsVector3D) * arrayCount );
 }
 
 void
@@ -809,8 +804,7 @@ vsDisplayList::NormalBuffer( vsRenderBuffer *buffer )
 {
 	vsAssert(buffer->GetContentType() == vsRenderBuffer::ContentType_Custom,
 			"Non-custom render buffer types should use ::BindBuffer");
-	m_fifo->WriteUint8( OpCode_NormalBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_NormalBuffer, buffer );
 }
 
 void
@@ -818,8 +812,7 @@ vsDisplayList::TexelBuffer( vsRenderBuffer *buffer )
 {
 	vsAssert(buffer->GetContentType() == vsRenderBuffer::ContentType_Custom,
 			"Non-custom render buffer types should use ::BindBuffer");
-	m_fifo->WriteUint8( OpCode_TexelBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_TexelBuffer, buffer );
 }
 
 void
@@ -827,236 +820,178 @@ vsDisplayList::ColorBuffer( vsRenderBuffer *buffer )
 {
 	vsAssert(buffer->GetContentType() == vsRenderBuffer::ContentType_Custom,
 			"Non-custom render buffer types should use ::BindBuffer");
-	m_fifo->WriteUint8( OpCode_ColorBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_ColorBuffer, buffer );
 }
 
 void
 vsDisplayList::BindBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_BindBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_BindBuffer, buffer );
 }
 
 void
 vsDisplayList::UnbindBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_UnbindBuffer );
-	m_fifo->WriteVoidStar( buffer );
+	WritePointerOp( OpCode_UnbindBuffer, buffer );
 }
 
 
 void
 vsDisplayList::SetVertexArrayObject( vsVertexArrayObject *vao )
 {
-	m_fifo->WriteUint8( OpCode_SetVertexArrayObject );
-	m_fifo->WriteVoidStar( vao );
+	WritePointerOp( OpCode_SetVertexArrayObject, vao );
 }
 
 void
 vsDisplayList::ClearVertexArrayObject()
 {
-	m_fifo->WriteUint8( OpCode_ClearVertexArrayObject );
+	WriteOp( OpCode_ClearVertexArrayObject );
 }
 
 void
 vsDisplayList::SetLinear( bool linear )
 {
-	m_fifo->WriteUint8( OpCode_SetLinear );
-	m_fifo->WriteUint8( linear );
+	WriteOp( OpCode_SetLinear, (uint32_t)linear );
 }
 
 void
 vsDisplayList::ClearVertexArray(  )
 {
-	m_fifo->WriteUint8( OpCode_ClearVertexArray );
+	WriteOp( OpCode_ClearVertexArray );
 }
 
 void
 vsDisplayList::ClearNormalArray(  )
 {
-	m_fifo->WriteUint8( OpCode_ClearNormalArray );
+	WriteOp( OpCode_ClearNormalArray );
 }
 
 void
 vsDisplayList::ClearTexelArray(  )
 {
-	m_fifo->WriteUint8( OpCode_ClearTexelArray );
+	WriteOp( OpCode_ClearTexelArray );
 }
 
 void
 vsDisplayList::ClearColorArray(  )
 {
-	m_fifo->WriteUint8( OpCode_ClearColorArray );
+	WriteOp( OpCode_ClearColorArray );
 }
 
 void
 vsDisplayList::ClearArrays()
 {
-	m_fifo->WriteUint8( OpCode_ClearArrays );
+	WriteOp( OpCode_ClearArrays );
 }
 
 void
 vsDisplayList::TexelArray( const vsVector2D *array, int arrayCount )
 {
-	m_fifo->WriteUint8( OpCode_TexelArray );
-	m_fifo->WriteUint32( arrayCount );
-	for ( int i = 0; i < arrayCount; i++ )
-	{
-		m_fifo->WriteVector2D( array[i] );
-	}
+	memcpy( WriteOpHeader( OpCode_TexelArray, sizeof(vsVector2D) * arrayCount ), array, sizeof(vsVector2D) * arrayCount );
 }
 
 void
 vsDisplayList::ColorArray( const vsColor *array, int arrayCount )
 {
-	m_fifo->WriteUint8( OpCode_ColorArray );
-	m_fifo->WriteUint32( arrayCount );
 	m_colorSet = true;
-	for ( int i = 0; i < arrayCount; i++ )
-	{
-		m_fifo->WriteColor( array[i] );
-	}
+	memcpy( WriteOpHeader( OpCode_ColorArray, sizeof(vsColor) * arrayCount ), array, sizeof(vsColor) * arrayCount );
 }
 
 void
 vsDisplayList::LineListArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_LineListArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_LineListArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::LineStripArray( uint16_t *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_LineStripArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	memcpy( WriteOpHeader( OpCode_LineStripArray, sizeof(uint16_t) * vertexCount ), idArray, sizeof(uint16_t) * vertexCount );
 }
 
 void
 vsDisplayList::LineStripArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_LineStripArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_LineStripArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::TriangleListArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_TriangleListArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_TriangleListArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::TriangleStripArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_TriangleStripArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_TriangleStripArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::TriangleStripBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_TriangleStripBuffer );
-	m_fifo->WriteVoidStar(buffer);
+	WritePointerOp( OpCode_TriangleStripBuffer, buffer );
 }
 
 void
 vsDisplayList::TriangleListBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_TriangleListBuffer );
-	m_fifo->WriteVoidStar(buffer);
+	WritePointerOp( OpCode_TriangleListBuffer, buffer );
 }
 
 void
 vsDisplayList::TriangleFanBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_TriangleFanBuffer );
-	m_fifo->WriteVoidStar(buffer);
+	WritePointerOp( OpCode_TriangleFanBuffer, buffer );
 }
 
 void
 vsDisplayList::LineListBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_LineListBuffer );
-	m_fifo->WriteVoidStar(buffer);
+	WritePointerOp( OpCode_LineListBuffer, buffer );
 }
 
 void
 vsDisplayList::LineStripBuffer( vsRenderBuffer *buffer )
 {
-	m_fifo->WriteUint8( OpCode_LineStripBuffer );
-	m_fifo->WriteVoidStar(buffer);
+	WritePointerOp( OpCode_LineStripBuffer, buffer );
 }
 
 void
 vsDisplayList::PointsArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_PointsArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_PointsArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::TriangleFanArray( int *idArray, int vertexCount )
 {
-	m_fifo->WriteUint8( OpCode_TriangleFanArray );
-	m_fifo->WriteUint32( vertexCount );
-	for ( int i = 0; i < vertexCount; i++ )
-	{
-		m_fifo->WriteUint16Native( idArray[i] );
-	}
+	WriteIndexArrayOp( OpCode_TriangleFanArray, idArray, vertexCount );
 }
 
 void
 vsDisplayList::SetMaterial( vsMaterial *material )
 {
-	m_fifo->WriteUint8( OpCode_SetMaterial );
-	m_fifo->WriteVoidStar( material );
+	WritePointerOp( OpCode_SetMaterial, material );
 }
 
 
 void
 vsDisplayList::SetRenderTarget( vsRenderTarget *target )
 {
-	m_fifo->WriteUint8( OpCode_SetRenderTarget );
-	m_fifo->WriteVoidStar( target );
+	WritePointerOp( OpCode_SetRenderTarget, target );
 }
 
 void
 vsDisplayList::ClearRenderTarget()
 {
-	m_fifo->WriteUint8( OpCode_ClearRenderTarget );
+	WriteOp( OpCode_ClearRenderTarget );
 }
 
 void
 vsDisplayList::ClearRenderTargetColor( const vsColor& c )
 {
-	m_fifo->WriteUint8( OpCode_ClearRenderTargetColor );
-	m_fifo->WriteColor( c );
+	WriteOp( OpCode_ClearRenderTargetColor, c );
 }
 
 void
@@ -1064,516 +999,456 @@ vsDisplayList::ResolveRenderTarget( vsRenderTarget *target )
 {
 	// Woo, this operation is going away!
 
-	// m_fifo->WriteUint8( OpCode_ResolveRenderTarget );
-	// m_fifo->WriteVoidStar( target );
+	// WritePointerOp( OpCode_ResolveRenderTarget, target );
 }
 
 void
 vsDisplayList::BlitRenderTarget( vsRenderTarget *from, vsRenderTarget *to )
 {
-	m_fifo->WriteUint8( OpCode_BlitRenderTarget );
-	m_fifo->WriteVoidStar( from );
-	m_fifo->WriteVoidStar( to );
+	char *payload = WriteOpHeader( OpCode_BlitRenderTarget, 2 * sizeof(void*) );
+	memcpy( payload, &from, sizeof(void*) );
+	memcpy( payload + sizeof(void*), &to, sizeof(void*) );
 }
 
 void
 vsDisplayList::BlitRenderTargetRect( vsRenderTarget *from, vsRenderTarget *to, const vsBox2D& fromRect, const vsBox2D& toRect )
 {
-	m_fifo->WriteUint8( OpCode_BlitRenderTargetRect );
-	m_fifo->WriteVoidStar( from );
-	m_fifo->WriteVoidStar( to );
-	m_fifo->WriteVector2D( fromRect.GetMin() );
-	m_fifo->WriteVector2D( fromRect.GetMax() );
-	m_fifo->WriteVector2D( toRect.GetMin() );
-	m_fifo->WriteVector2D( toRect.GetMax() );
+	char *payload = WriteOpHeader( OpCode_BlitRenderTargetRect, 2 * sizeof(void*) + 2 * sizeof(vsBox2D) );
+	memcpy( payload, &from, sizeof(void*) );
+	memcpy( payload + sizeof(void*), &to, sizeof(void*) );
+	memcpy( payload + 2 * sizeof(void*), &fromRect, sizeof(vsBox2D) );
+	memcpy( payload + 2 * sizeof(void*) + sizeof(vsBox2D), &toRect, sizeof(vsBox2D) );
 }
 
 void
 vsDisplayList::Light( const vsLight &light )
 {
-	m_fifo->WriteUint8( OpCode_Light );
-	m_fifo->WriteLight( light );
+	LightData data;
+	data.position = light.GetPosition();
+	data.direction = light.GetDirection();
+	data.color = light.GetColor();
+	data.ambient = light.GetAmbientColor();
+	data.specular = light.GetSpecularColor();
+	data.type = light.GetType();
+	WriteOp( OpCode_Light, data );
 }
 
 void
 vsDisplayList::ClearLights()
 {
-	m_fifo->WriteUint8( OpCode_ClearLights );
+	WriteOp( OpCode_ClearLights );
 }
 
 void
 vsDisplayList::Fog( const vsFog &fog )
 {
-	m_fifo->WriteUint8( OpCode_Fog );
-	m_fifo->WriteFog( fog );
+	WriteOp( OpCode_Fog, fog );
 }
 
 void
 vsDisplayList::ClearFog()
 {
-	m_fifo->WriteUint8( OpCode_ClearFog );
+	WriteOp( OpCode_ClearFog );
 }
 
 void
 vsDisplayList::FlatShading()
 {
-	m_fifo->WriteUint8( OpCode_FlatShading );
+	WriteOp( OpCode_FlatShading );
 }
 
 void
 vsDisplayList::SmoothShading()
 {
-	m_fifo->WriteUint8( OpCode_SmoothShading );
+	WriteOp( OpCode_SmoothShading );
 }
 
 void
 vsDisplayList::EnableStencil()
 {
-	m_fifo->WriteUint8( OpCode_EnableStencil );
+	WriteOp( OpCode_EnableStencil );
 }
 
 void
 vsDisplayList::DisableStencil()
 {
-	m_fifo->WriteUint8( OpCode_DisableStencil );
+	WriteOp( OpCode_DisableStencil );
 }
 
 void
 vsDisplayList::EnableScissor( const vsBox2D& box )
 {
-	m_fifo->WriteUint8( OpCode_EnableScissor );
-	m_fifo->WriteBox2D( box );
+	WriteOp( OpCode_EnableScissor, box );
 }
 
 void
 vsDisplayList::DisableScissor()
 {
-	m_fifo->WriteUint8( OpCode_DisableScissor );
+	WriteOp( OpCode_DisableScissor );
 }
 
 void
 vsDisplayList::ClearStencil()
 {
-	m_fifo->WriteUint8( OpCode_ClearStencil );
+	WriteOp( OpCode_ClearStencil );
 }
 
 void
 vsDisplayList::ClearDepth()
 {
-	m_fifo->WriteUint8( OpCode_ClearDepth );
+	WriteOp( OpCode_ClearDepth );
 }
 
 void
 vsDisplayList::SetViewport( const vsBox2D &box )
 {
-	m_fifo->WriteUint8( OpCode_SetViewport );
-	m_fifo->WriteBox2D( box );
+	WriteOp( OpCode_SetViewport, box );
 }
 
 void
 vsDisplayList::ClearViewport()
 {
-	m_fifo->WriteUint8( OpCode_ClearViewport );
+	WriteOp( OpCode_ClearViewport );
 }
 
 void
 vsDisplayList::Debug(const vsString &string )
 {
-	m_fifo->WriteUint8( OpCode_Debug );
-	m_fifo->WriteString(string);
+	memcpy( WriteOpHeader( OpCode_Debug, string.size() ), string.c_str(), string.size() );
 }
 
-vsDisplayList::OpCode
-vsDisplayList::PeekOpType()
+// Payloads are written and read with memcpy() and in-place casts, so anything
+// we store directly has to be trivially copyable.
+static_assert( std::is_trivially_copyable<vsColor>::value, "vsColor payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsVector3D>::value, "vsVector3D payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsMatrix4x4>::value, "vsMatrix4x4 payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsTransform2D>::value, "vsTransform2D payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsBox2D>::value, "vsBox2D payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsFog>::value, "vsFog payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsShaderOptions>::value, "vsShaderOptions payloads must be trivially copyable" );
+static_assert( std::is_trivially_copyable<vsDisplayList::LightData>::value, "LightData payloads must be trivially copyable" );
+
+char *
+vsDisplayList::WriteOpHeader( OpCode code, size_t payloadSize )
 {
-	OpCode result = OpCode_MAX;
-	if ( !m_fifo->AtEnd() )
+	vsAssert( payloadSize <= OpView::c_maxPayloadSize, "Display list op payload is too big!" );
+
+	bool extended = ( payloadSize >= OpView::c_extendedSize );
+	size_t headerSize = extended ? 2 * OpView::c_headerSize : OpView::c_headerSize;
+	uint32_t header = code | ((extended ? OpView::c_extendedSize : (uint32_t)payloadSize) << 8);
+	size_t paddedSize = (payloadSize + 3) & ~3;
+	char *op = m_fifo->WriteSpace( headerSize + paddedSize );
+	memcpy( op, &header, sizeof(header) );
+	if ( extended )
 	{
-		result = (OpCode)m_fifo->PeekUint8();
+		uint32_t size = (uint32_t)payloadSize;
+		memcpy( op + OpView::c_headerSize, &size, sizeof(size) );
 	}
 
-	return result;
+	// zero the padding, so identical ops are identical bytes
+	char *payload = op + headerSize;
+	memset( payload + payloadSize, 0, paddedSize - payloadSize );
+	return payload;
 }
 
-static vsColor		s_color;
-static vsVector2D	s_vector;
-static vsVector3D	s_vector3d;
-static vsTransform2D	s_transform;
+void
+vsDisplayList::WritePointerOp( OpCode code, const void *pointer )
+{
+	memcpy( WriteOpHeader( code, sizeof(void*) ), &pointer, sizeof(void*) );
+}
 
-vsDisplayList::op *
-vsDisplayList::PopOp()
+void
+vsDisplayList::WriteIndexArrayOp( OpCode code, const int *idArray, int vertexCount )
 {
-	if ( !m_fifo->AtEnd() )
+	uint16_t *payload = (uint16_t*)WriteOpHeader( code, sizeof(uint16_t) * vertexCount );
+	for ( int i = 0; i < vertexCount; i++ )
 	{
-		m_currentOp.type = (OpCode)m_fifo->ReadUint8();
+		vsAssert( idArray[i] >= 0 && idArray[i] <= 0xffff, "Index doesn't fit in a display list's 16-bit index array!" );
+		payload[i] = idArray[i];
+	}
+}
 
-		switch( m_currentOp.type )
-		{
-			case OpCode_SetColor:
-			case OpCode_ClearRenderTargetColor:
-				m_fifo->ReadColor(&m_currentOp.data.color);
-				break;
-			case OpCode_SetLinear:
-				{
-					m_currentOp.data.i = m_fifo->ReadUint8();
-				}
-				break;
-			case OpCode_SetColors:
-				{
-					int count = m_fifo->ReadUint32();
-					m_currentOp.data.Set( count );
-					m_currentOp.data.SetPointer( (char*)m_fifo->ReadVoidStar() );
-					break;
-				}
-			case OpCode_PushTranslation:
-				m_fifo->ReadVector3D(&m_currentOp.data.vector);
-				break;
-			case OpCode_VertexArray:
-			{
-				int count = m_fifo->ReadUint32();
-				m_currentOp.data.Set( count );
-				m_currentOp.data.SetPointer( m_fifo->GetReadHead() );
+vsDisplayList::Iterator
+vsDisplayList::GetOps() const
+{
+	if ( m_instanceParent )
+		return m_instanceParent->GetOps();
 
-				m_fifo->AdvanceReadHead( sizeof(s_vector3d) * count );
-				//for ( int i = 0; i < count; i++ )
-				//	m_fifo->ReadVector3D(&s_vector3d);
+	const char *begin = m_fifo->GetBuffer();
+	return Iterator( begin, begin + m_fifo->Length() );
+}
 
-				break;
-			}
-			case OpCode_NormalArray:
-			{
-				int count = m_fifo->ReadUint32();
-				m_currentOp.data.Set( count );
-				m_currentOp.data.SetPointer( m_fifo->GetReadHead() );
+void
+vsDisplayList::AppendOp( const OpView& op )
+{
+	m_fifo->WriteBuffer( op.GetData(), op.GetSize() );
+}
 
-				m_fifo->AdvanceReadHead( sizeof(s_vector3d) * count );
-//				for ( int i = 0; i < count; i++ )
-//					m_fifo->ReadVector3D(&s_vector3d);
+static bool IsDrawOp( vsDisplayList::OpCode code )
+{
+	return ( code >= vsDisplayList::OpCode_LineListArray && code <= vsDisplayList::OpCode_TriangleFanBuffer );
+}
 
-				break;
-			}
-			case OpCode_SetShaderValues:
-			case OpCode_SetColorsBuffer:
-			case OpCode_VertexBuffer:
-			case OpCode_NormalBuffer:
-			case OpCode_TexelBuffer:
-			case OpCode_ColorBuffer:
-			case OpCode_BindBuffer:
-			case OpCode_UnbindBuffer:
-			case OpCode_SetVertexArrayObject:
-			{
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				break;
-			}
-			case OpCode_PushShaderOptions:
+// Draws which can be concatenated just by concatenating their indices.
+// (Strips and fans can't, without primitive restart)
+static bool IsMergeableDrawOp( vsDisplayList::OpCode code )
+{
+	return ( code == vsDisplayList::OpCode_LineListArray ||
+			code == vsDisplayList::OpCode_TriangleListArray ||
+			code == vsDisplayList::OpCode_PointsArray );
+}
+
+static bool IsIdentityPush( const vsDisplayList::OpView& op )
+{
+	switch( op.GetType() )
+	{
+		case vsDisplayList::OpCode_PushTransform:
 			{
-				m_currentOp.data.shaderOptions.mask = m_fifo->ReadInt32();
-				m_currentOp.data.shaderOptions.value = m_fifo->ReadInt32();
-				break;
+				const vsTransform2D& t = op.Get<vsTransform2D>();
+				return ( t.GetTranslation() == vsVector2D::Zero &&
+						t.GetAngle().Get() == 0.f &&
+						t.GetScale() == vsVector2D::One );
 			}
-			case OpCode_TexelArray:
-			{
-				int count = m_fifo->ReadUint32();
-				m_currentOp.data.Set( count );
-				m_currentOp.data.SetPointer( m_fifo->GetReadHead() );
+		case vsDisplayList::OpCode_PushTranslation:
+			return ( op.Get<vsVector3D>() == vsVector3D::Zero );
+		case vsDisplayList::OpCode_PushMatrix4x4:
+			return ( op.Get<vsMatrix4x4>() == vsMatrix4x4::Identity );
+		default:
+			return false;
+	}
+}
 
-				m_fifo->AdvanceReadHead( sizeof(s_vector) * count );
-//				for ( int i = 0; i < count; i++ )
-//					m_fifo->ReadVector2D(&s_vector);
+int
+vsDisplayList::Optimise()
+{
+	vsAssert( !m_instanceParent, "Tried to optimise an instanced display list!" );
 
-				break;
-			}
-			case OpCode_ColorArray:
-			{
-				int count = m_fifo->ReadUint32();
-				m_currentOp.data.Set( count );
-				m_currentOp.data.SetPointer( m_fifo->GetReadHead() );
-
-				m_fifo->AdvanceReadHead( sizeof(s_color) * count );
-//				for ( int i = 0; i < count; i++ )
-//				{
-//					m_fifo->ReadColor(&s_color);
-//				}
-				break;
-			}
-			case OpCode_LineListArray:
-			case OpCode_LineStripArray:
-			case OpCode_TriangleListArray:
-			case OpCode_TriangleStripArray:
-			case OpCode_TriangleFanArray:
-			case OpCode_PointsArray:
-			{
-				int count = m_fifo->ReadUint32();
-				m_currentOp.data.Set( count );
-				m_currentOp.data.SetPointer( m_fifo->GetReadHead() );
+	// First pass:  walk the ops tracking the renderer state they set up, and
+	// decide which ones can go.  We only ever trust state which was set by
+	// an earlier op in this list;  everything starts out unknown.
+	vsArray<bool> remove;
 
-				m_fifo->AdvanceReadHead( sizeof(uint16_t) * count );
-//				for ( int i = 0; i < count; i++ )
-//					m_fifo->Readuint16_t();
+	bool colorKnown = false;
+	vsColor color;
+	int pendingColor = -1;	// last SetColor we've kept, if nothing has drawn using it yet
 
+	bool materialKnown = false;
+	vsMaterial *material = nullptr;
+
+	bool valuesKnown = false;
+	vsShaderValues *values = nullptr;
+
+	vsRenderBuffer *boundBuffer = nullptr;	// bound by BindBuffer, with no array changes since
+	vsArray<int> unbinds;	// UnbindBuffers since then, which a following BindBuffer would make redundant
+
+	bool singleMatrixKnown = false;	// whether we know we're not drawing instanced
+	vsArray<int> pushStack;	// for each transform stack level we've pushed, the index of the push op if it was an identity we're removing, or -1
+
+	Iterator ops = GetOps();
+	for ( OpView o = ops.Next(); o.IsValid(); o = ops.Next() )
+	{
+		int i = remove.ItemCount();
+		bool redundant = false;
+		OpCode type = o.GetType();
+
+		switch( type )
+		{
+			case OpCode_SetColor:
+				{
+					const vsColor& c = o.Get<vsColor>();
+					if ( colorKnown && c == color )
+						redundant = true;
+					else
+					{
+						// nothing drew with the last color we set, so it
+						// didn't matter.
+						if ( pendingColor >= 0 )
+							remove[pendingColor] = true;
+						colorKnown = true;
+						color = c;
+						pendingColor = i;
+					}
+					break;
+				}
+			case OpCode_SetColors:
+			case OpCode_SetColorsBuffer:
+				// these stop a SetColor() from being redundant, and get reset
+				// by SetMaterial().
+				colorKnown = false;
+				materialKnown = false;
 				break;
-			}
-			case OpCode_LineListBuffer:
-			case OpCode_LineStripBuffer:
-			case OpCode_TriangleStripBuffer:
-			case OpCode_TriangleListBuffer:
-			case OpCode_TriangleFanBuffer:
-			{
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				break;
-			}
-			case OpCode_PushTransform:
-			case OpCode_SetCameraTransform:
-				m_fifo->ReadTransform2D( &m_currentOp.data.transform );
-				break;
-			case OpCode_PushMatrix4x4:
-			case OpCode_SetMatrix4x4:
-			case OpCode_SetWorldToViewMatrix4x4:
-				m_fifo->ReadMatrix4x4( &m_currentOp.data.matrix4x4 );
-				break;
-			case OpCode_SetMatrices4x4:
+			case OpCode_SetMaterial:
 				{
-					int count = m_fifo->ReadUint32();
-					m_currentOp.data.SetPointer( (char*)m_fifo->ReadVoidStar() );
-					m_currentOp.data.i = count;
+					vsMaterial *m = o.GetPointer<vsMaterial>();
+					if ( materialKnown && m == material )
+						redundant = true;
+					else
+					{
+						// a new material may set its own color.
+						materialKnown = true;
+						material = m;
+						colorKnown = false;
+					}
 					break;
 				}
-			case OpCode_SetMatrices4x4Buffer:
+			case OpCode_SetShaderValues:
+			case OpCode_ClearShaderValues:
 				{
-					m_currentOp.data.SetPointer( (char*)m_fifo->ReadVoidStar() );
+					vsShaderValues *v = ( type == OpCode_SetShaderValues ) ? o.GetPointer<vsShaderValues>() : nullptr;
+					if ( valuesKnown && v == values )
+						redundant = true;
+					valuesKnown = true;
+					values = v;
 					break;
 				}
-			case OpCode_Set3DProjection:
-				m_currentOp.data.fov = m_fifo->ReadFloat();
-				m_currentOp.data.nearPlane = m_fifo->ReadFloat();
-				m_currentOp.data.farPlane = m_fifo->ReadFloat();
-				break;
-			case OpCode_SetProjectionMatrix4x4:
-				m_fifo->ReadMatrix4x4( &m_currentOp.data.matrix4x4 );
-				break;
-			case OpCode_SetMaterial:
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				break;
-			case OpCode_SetRenderTarget:
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				break;
-			// case OpCode_ResolveRenderTarget:
-			// 	m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-			// 	break;
-			case OpCode_BlitRenderTarget:
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				m_currentOp.data.SetPointer2( (char *)m_fifo->ReadVoidStar() );
-				break;
-			case OpCode_BlitRenderTargetRect:
-				m_currentOp.data.SetPointer( (char *)m_fifo->ReadVoidStar() );
-				m_currentOp.data.SetPointer2( (char *)m_fifo->ReadVoidStar() );
-				m_currentOp.data.box2D.Clear();
-				m_currentOp.data.box2D2.Clear();
+			case OpCode_PushTransform:
+			case OpCode_PushTranslation:
+			case OpCode_PushMatrix4x4:
+				// Pushing an identity changes nothing except the stack depth,
+				// as long as we weren't drawing instanced.  We only know
+				// whether it's safe once we find its PopTransform, below.
+				if ( singleMatrixKnown && IsIdentityPush(o) )
 				{
-					vsVector2D v;
-
-					m_fifo->ReadVector2D(&v);
-					m_currentOp.data.box2D.ExpandToInclude( v );
-					m_fifo->ReadVector2D(&v);
-					m_currentOp.data.box2D.ExpandToInclude( v );
-					m_fifo->ReadVector2D(&v);
-					m_currentOp.data.box2D2.ExpandToInclude( v );
-					m_fifo->ReadVector2D(&v);
-					m_currentOp.data.box2D2.ExpandToInclude( v );
+					redundant = true;
+					pushStack.AddItem(i);
 				}
+				else
+					pushStack.AddItem(-1);
+				singleMatrixKnown = true;
 				break;
-			case OpCode_Light:
-				m_fifo->ReadLight( &m_currentOp.data.light );
+			case OpCode_SetMatrix4x4:
+			case OpCode_SnapMatrix:
+				pushStack.AddItem(-1);
+				singleMatrixKnown = true;
 				break;
-			case OpCode_Fog:
-				m_fifo->ReadFog( &m_currentOp.data.fog );
+			case OpCode_SetMatrices4x4:
+			case OpCode_SetMatrices4x4Buffer:
+				pushStack.AddItem(-1);
+				singleMatrixKnown = false;
 				break;
-			case OpCode_SetViewport:
-				m_fifo->ReadBox2D( &m_currentOp.data.box2D );
+			case OpCode_PopTransform:
+				if ( pushStack.ItemCount() > 0 )
+				{
+					redundant = ( pushStack[pushStack.ItemCount()-1] >= 0 );
+					pushStack.PopBack();
+				}
+				singleMatrixKnown = true;
 				break;
-			case OpCode_Debug:
-				 m_currentOp.data.string = m_fifo->ReadString();
+			case OpCode_BindBuffer:
+				{
+					// BindBuffer unbinds everything first, so any UnbindBuffer
+					// since the last draw did nothing.
+					for ( int u = 0; u < unbinds.ItemCount(); u++ )
+						remove[ unbinds[u] ] = true;
+					unbinds.Clear();
+
+					vsRenderBuffer *b = o.GetPointer<vsRenderBuffer>();
+					if ( b == boundBuffer )
+						redundant = true;
+					boundBuffer = b;
+					break;
+				}
+			case OpCode_UnbindBuffer:
+				unbinds.AddItem(i);
 				break;
-			case OpCode_EnableScissor:
-				m_fifo->ReadBox2D( &m_currentOp.data.box2D );
+			case OpCode_SetVertexArrayObject:
+			case OpCode_ClearVertexArrayObject:
+				// the unbinds were from the old VAO, so we have to keep them.
+				unbinds.Clear();
+				boundBuffer = nullptr;
 				break;
-			case OpCode_ClearRenderTarget:
-			case OpCode_ClearLights:
-			case OpCode_PopTransform:
+			case OpCode_VertexArray:
+			case OpCode_NormalArray:
+			case OpCode_TexelArray:
+			case OpCode_ColorArray:
+			case OpCode_VertexBuffer:
+			case OpCode_NormalBuffer:
+			case OpCode_TexelBuffer:
+			case OpCode_ColorBuffer:
 			case OpCode_ClearVertexArray:
 			case OpCode_ClearNormalArray:
 			case OpCode_ClearTexelArray:
 			case OpCode_ClearColorArray:
 			case OpCode_ClearArrays:
-			case OpCode_FlatShading:
-			case OpCode_SmoothShading:
-			case OpCode_EnableStencil:
-			case OpCode_DisableStencil:
-			case OpCode_DisableScissor:
-			case OpCode_ClearStencil:
-			case OpCode_ClearShaderValues:
-			case OpCode_ClearDepth:
-			case OpCode_ClearViewport:
-			case OpCode_PopShaderOptions:
-			case OpCode_ClearVertexArrayObject:
+				boundBuffer = nullptr;
+				break;
 			default:
+				if ( IsDrawOp(type) )
+				{
+					pendingColor = -1;
+					if ( unbinds.ItemCount() > 0 )
+					{
+						// we're drawing with those unbinds, so they stay.
+						unbinds.Clear();
+						boundBuffer = nullptr;
+					}
+				}
 				break;
 		}
 
-		return &m_currentOp;
+		remove.AddItem( redundant );
 	}
 
-	return nullptr;
-}
+	// identity pushes which are still open at the end of the list get popped
+	// by somebody else, so we have to keep them.
+	for ( int i = 0; i < pushStack.ItemCount(); i++ )
+		if ( pushStack[i] >= 0 )
+			remove[ pushStack[i] ] = false;
+
+	// Second pass:  compact the ops we're keeping down towards the front of
+	// the fifo, merging list draws into the previous draw when nothing we've
+	// kept has come between them.  We only ever write at or behind where
+	// we're reading, so we can do this in place.
+	char *buffer = const_cast<char*>( m_fifo->GetBuffer() );
+	size_t writePos = 0;
+	size_t lastOpPos = 0;
+	OpCode lastOpType = OpCode_MAX;
+	int removed = 0;
+
+	ops = GetOps();
+	int i = 0;
+	for ( OpView o = ops.Next(); o.IsValid(); o = ops.Next(), i++ )
+	{
+		if ( remove[i] )
+		{
+			removed++;
+			continue;
+		}
 
-void
-vsDisplayList::AppendOp(vsDisplayList::op * o)
-{
-	OpCode type = o->type;
+		OpCode type = o.GetType();
+		if ( type == lastOpType && IsMergeableDrawOp(type) )
+		{
+			OpView last( buffer + lastOpPos );
+			uint32_t lastSize = last.GetPayloadSize();
+			uint32_t size = o.GetPayloadSize();
+			// only merge into ops whose size still fits in a plain header, so
+			// we can rewrite that header in place.
+			if ( (uint64_t)lastSize + size < OpView::c_extendedSize )
+			{
+				char *payloadEnd = last.GetPayload() + lastSize;
+				memmove( payloadEnd, o.GetPayload(), size );
 
-	switch( type )
-	{
-		case OpCode_SetColor:
-		case OpCode_ClearRenderTargetColor:
-			SetColor( o->data.GetColor() );
-			break;
-		case OpCode_SetColors:
-			SetColors( (vsColor*)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_SetColorsBuffer:
-			SetColorsBuffer( (vsRenderBuffer*)o->data.p );
-			break;
-		case OpCode_VertexArray:
-			VertexArray( (vsVector3D *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_NormalArray:
-			NormalArray( (vsVector3D *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_TexelArray:
-			TexelArray( (vsVector2D *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_ColorArray:
-			ColorArray( (vsColor *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_VertexBuffer:
-			VertexBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_TexelBuffer:
-			TexelBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_ColorBuffer:
-			ColorBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_BindBuffer:
-			BindBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_UnbindBuffer:
-			UnbindBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_ClearVertexArray:
-			ClearVertexArray();
-			break;
-		case OpCode_ClearNormalArray:
-			ClearNormalArray();
-			break;
-		case OpCode_ClearTexelArray:
-			ClearTexelArray();
-			break;
-		case OpCode_ClearColorArray:
-			ClearColorArray();
-			break;
-		case OpCode_ClearArrays:
-			ClearArrays();
-			break;
-		case OpCode_LineListArray:
-			LineListArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_LineStripArray:
-			LineStripArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_TriangleListArray:
-			TriangleListArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_TriangleStripArray:
-			TriangleStripArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_PointsArray:
-			PointsArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_LineListBuffer:
-			LineListBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_LineStripBuffer:
-			LineStripBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_TriangleStripBuffer:
-			TriangleStripBuffer( (vsRenderBuffer *)o->data.p );
-			break;
-		case OpCode_TriangleFanArray:
-			TriangleFanArray( (int *)o->data.p, o->data.GetUInt() );
-			break;
-		case OpCode_PushTransform:
-			PushTransform( o->data.GetTransform() );
-			break;
-		case OpCode_SetCameraTransform:
-			SetCameraTransform( o->data.GetTransform() );
-			break;
-		case OpCode_SetMatrix4x4:
-			SetMatrix4x4( o->data.GetMatrix4x4() );
-			break;
-		case OpCode_PushMatrix4x4:
-			PushMatrix4x4( o->data.GetMatrix4x4() );
-			break;
-		case OpCode_SetMatrices4x4:
-			SetMatrices4x4( (vsMatrix4x4*)o->data.p, o->data.i );
-			break;
-		case OpCode_SetMatrices4x4Buffer:
-			SetMatrices4x4Buffer( (vsRenderBuffer*)o->data.p );
-			break;
-		case OpCode_SetWorldToViewMatrix4x4:
-			SetWorldToViewMatrix4x4( o->data.GetMatrix4x4() );
-			break;
-		case OpCode_Set3DProjection:
-			Set3DProjection( o->data.fov, o->data.nearPlane, o->data.farPlane );
-			break;
-		case OpCode_SetProjectionMatrix4x4:
-			SetProjectionMatrix4x4( o->data.GetMatrix4x4() );
-			break;
-		case OpCode_PopTransform:
-			PopTransform();
-			break;
-		case OpCode_EnableStencil:
-			EnableStencil();
-			break;
-		case OpCode_DisableStencil:
-			DisableStencil();
-			break;
-		case OpCode_EnableScissor:
-			EnableScissor( o->data.GetBox2D() );
-			break;
-		case OpCode_DisableScissor:
-			DisableScissor();
-			break;
-		case OpCode_ClearStencil:
-			ClearStencil();
-			break;
-		case OpCode_ClearDepth:
-			ClearDepth();
-			break;
-		case OpCode_SetViewport:
-			SetViewport( o->data.GetBox2D() );
-			break;
-		case OpCode_ClearViewport:
-			ClearViewport();
-			break;
-		case OpCode_Debug:
-			Debug( o->data.GetString() );
-			break;
-		default:
-			break;
+				uint32_t header = type | ((lastSize + size) << 8);
+				memcpy( buffer + lastOpPos, &header, sizeof(header) );
+
+				uint32_t paddedSize = (lastSize + size + 3) & ~3;
+				memset( payloadEnd + size, 0, paddedSize - (lastSize + size) );
+				writePos = lastOpPos + OpView::c_headerSize + paddedSize;
+				removed++;
+				continue;
+			}
+		}
+
+		uint32_t opSize = o.GetSize();
+		memmove( buffer + writePos, o.GetData(), opSize );
+		lastOpPos = writePos;
+		lastOpType = type;
+		writePos += opSize;
 	}
-}
+	m_fifo->RewindWriteHeadTo( writePos );
 
+	return removed;
+}
 
 void
 vsDisplayList::GetBoundingCircle(vsVector2D &center, float &radius)
@@ -1588,16 +1463,16 @@ vsDisplayList::GetBoundingCircle(vsVector2D &center, float &radius)
 		vsVector3D max(-1000000.0f, -1000000.0f,-1000000.f);
 
 		vsTransform2D currentTransform;
-		Rewind();
-		op *o = PopOp();
+		Iterator ops = GetOps();
+		OpView o = ops.Next();
 
-		while(o)
+		while( o.IsValid() )
 		{
-			if ( o->type == OpCode_VertexArray )
+			if ( o.GetType() == OpCode_VertexArray )
 			{
 				vsVector3D pos;
-				int count = o->data.GetUInt();
-				float *shuttle = (float *) o->data.p;
+				int count = o.GetArrayCount<vsVector3D>();
+				float *shuttle = o.GetArray<float>();
 
 				for ( int i = 0; i < count; i++ )
 				{
@@ -1613,7 +1488,7 @@ vsDisplayList::GetBoundingCircle(vsVector2D &center, float &radius)
 					shuttle += 3;
 				}
 			}
-			o = PopOp();
+			o = ops.Next();
 		}
 
 		center = 0.5f * (max + min);
@@ -1651,12 +1526,12 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 		vsVector3D		*currentVertexArray = nullptr;
 		vsRenderBuffer *currentVertexBuffer = nullptr;
 
-		Rewind();
-		op *o = PopOp();
+		Iterator ops = GetOps();
+		OpView o = ops.Next();
 
-		while(o)
+		while( o.IsValid() )
 		{
-			switch( o->type )
+			switch( o.GetType() )
 			{
 				case OpCode_SnapMatrix:
 					// TODO:  We can't really snap here;  we don't know that we have a full transform stack.
@@ -1664,13 +1539,13 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 					transformStackLevel++;
 					break;
 				case OpCode_PushTransform:
-					transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o->data.transform;
+					transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o.Get<vsTransform2D>();
 					transformStackLevel++;
 					break;
 				case OpCode_PushTranslation:
 					{
 						vsTransform2D transform;
-						transform.SetTranslation( o->data.GetVector3D() );
+						transform.SetTranslation( o.Get<vsVector3D>() );
 						transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * transform;
 						transformStackLevel++;
 						break;
@@ -1681,12 +1556,12 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 					break;
 				case OpCode_VertexArray:
 					currentVertexBuffer = nullptr;
-					currentVertexArray = (vsVector3D *)o->data.p;
+					currentVertexArray = o.GetArray<vsVector3D>();
 					break;
 				case OpCode_VertexBuffer:
 				case OpCode_BindBuffer:
 					currentVertexArray = nullptr;
-					currentVertexBuffer = (vsRenderBuffer *)o->data.p;
+					currentVertexBuffer = o.GetPointer<vsRenderBuffer>();
 					break;
 				case OpCode_LineListBuffer:
 				case OpCode_LineStripBuffer:
@@ -1694,7 +1569,7 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 				case OpCode_TriangleStripBuffer:
 				case OpCode_TriangleFanBuffer:
 					{
-						vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+						vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 						uint16_t *shuttle = buffer->GetIntArray();
 
 						for ( int i = 0; i < buffer->GetIntArraySize(); i++ )
@@ -1716,8 +1591,8 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 				case OpCode_TriangleFanArray:
 				case OpCode_PointsArray:
 					{
-						uint16_t *shuttle = (uint16_t *)o->data.p;
-						int count = o->data.GetUInt();
+						uint16_t *shuttle = o.GetArray<uint16_t>();
+						int count = o.GetArrayCount<uint16_t>();
 
 						for ( int i = 0; i < count; i++ )
 						{
@@ -1735,7 +1610,7 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 					break;
 			}
 
-			o = PopOp();
+			o = ops.Next();
 		}
 	}
 
@@ -1743,6 +1618,21 @@ vsDisplayList::GetBoundingBox( vsVector2D &topLeft, vsVector2D &bottomRight )
 	bottomRight = box.GetMax();
 }
 
+// Expands 'box' to include 'points' transformed by 'matrix', using the batch
+// math functions a block at a time.
+static void
+ExpandToIncludeTransformed( vsBox3D &box, const vsMatrix4x4 &matrix, const vsVector3D *points, int count )
+{
+	const int c_blockSize = 64;
+	vsVector3D transformed[c_blockSize];
+	for ( int start = 0; start < count; start += c_blockSize )
+	{
+		int blockCount = vsMin( c_blockSize, count - start );
+		matrix.ApplyTo( points + start, transformed, blockCount );
+		box.ExpandToInclude( transformed, blockCount );
+	}
+}
+
 void
 vsDisplayList::GetBoundingBox( vsBox3D &box )
 {
@@ -1759,66 +1649,49 @@ vsDisplayList::GetBoundingBox( vsBox3D &box )
 		vsVector3D		*currentVertexArray = nullptr;
 		//int			currentVertexArraySize = 0;
 
-		Rewind();
-		op *o = PopOp();
+		Iterator ops = GetOps();
+		OpView o = ops.Next();
 
-		while(o)
+		while( o.IsValid() )
 		{
-			if ( o->type == OpCode_PushMatrix4x4 )
+			if ( o.GetType() == OpCode_PushMatrix4x4 )
 			{
-				transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o->data.matrix4x4;
+				transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o.Get<vsMatrix4x4>();
 				transformStackLevel++;
 			}
-			if ( o->type == OpCode_SetMatrix4x4 )
+			if ( o.GetType() == OpCode_SetMatrix4x4 )
 			{
-				transformStack[++transformStackLevel] = o->data.matrix4x4;
+				transformStack[++transformStackLevel] = o.Get<vsMatrix4x4>();
 			}
-			else if ( o->type == OpCode_SetMatrices4x4 )
+			else if ( o.GetType() == OpCode_SetMatrices4x4 )
 			{
-				vsMatrix4x4 *mat = (vsMatrix4x4*)o->data.p;
+				vsMatrix4x4 *mat = o.GetPointer<vsMatrix4x4>();
 				transformStack[++transformStackLevel] = *mat;
 			}
-			else if ( o->type == OpCode_PopTransform )
+			else if ( o.GetType() == OpCode_PopTransform )
 			{
 				transformStackLevel--;
 			}
-			else if ( o->type == OpCode_VertexArray )
+			else if ( o.GetType() == OpCode_VertexArray )
 			{
-				vsVector3D pos;
-				int count = o->data.GetUInt();
-				float *shuttle = (float *) o->data.p;
-				currentVertexArray = (vsVector3D *)shuttle;
+				int count = o.GetArrayCount<vsVector3D>();
+				currentVertexArray = o.GetArray<vsVector3D>();
 				//currentVertexArraySize = count*3;
 
-				for ( int i = 0; i < count; i++ )
-				{
-					pos.Set(shuttle[0],shuttle[1],shuttle[2]);
-					pos = transformStack[transformStackLevel].ApplyTo( pos );
-
-					box.ExpandToInclude( pos );
-
-					shuttle += 3;
-				}
+				ExpandToIncludeTransformed( box, transformStack[transformStackLevel], currentVertexArray, count );
 			}
-			else if ( o->type == OpCode_VertexBuffer )
+			else if ( o.GetType() == OpCode_VertexBuffer )
 			{
-				vsVector3D pos;
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				currentVertexArray = buffer->GetVector3DArray();
 				//currentVertexArraySize = buffer->GetVector3DArraySize();
 
-				for ( int i = 0; i < buffer->GetVector3DArraySize(); i++ )
-				{
-					pos = buffer->GetVector3DArray()[i];
-					pos = transformStack[transformStackLevel].ApplyTo( pos );
-
-					box.ExpandToInclude( pos );
-				}
+				ExpandToIncludeTransformed( box, transformStack[transformStackLevel], currentVertexArray, buffer->GetVector3DArraySize() );
 			}
-			else if ( o->type == OpCode_BindBuffer )
+			else if ( o.GetType() == OpCode_BindBuffer )
 			{
 				vsVector3D pos;
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				int positionCount = buffer->GetPositionCount();
 
 				for ( int i = 0; i < positionCount; i++ )
@@ -1829,9 +1702,9 @@ vsDisplayList::GetBoundingBox( vsBox3D &box )
 					box.ExpandToInclude( pos );
 				}
 			}
-			else if ( o->type == OpCode_LineListBuffer || o->type == OpCode_LineStripBuffer )
+			else if ( o.GetType() == OpCode_LineListBuffer || o.GetType() == OpCode_LineStripBuffer )
 			{
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				uint16_t *shuttle = buffer->GetIntArray();
 
 				for ( int i = 0; i < buffer->GetIntArraySize(); i++ )
@@ -1840,10 +1713,10 @@ vsDisplayList::GetBoundingBox( vsBox3D &box )
 					box.ExpandToInclude( transformStack[transformStackLevel].ApplyTo( currentVertexArray[index] ) );
 				}
 			}
-			else if ( o->type == OpCode_LineStripArray )
+			else if ( o.GetType() == OpCode_LineStripArray )
 			{
-				uint16_t *shuttle = (uint16_t *)o->data.p;
-				int count = o->data.GetUInt();
+				uint16_t *shuttle = o.GetArray<uint16_t>();
+				int count = o.GetArrayCount<uint16_t>();
 
 				for ( int i = 0; i < count; i++ )
 				{
@@ -1852,7 +1725,7 @@ vsDisplayList::GetBoundingBox( vsBox3D &box )
 				}
 			}
 
-			o = PopOp();
+			o = ops.Next();
 		}
 	}
 }
@@ -1874,53 +1747,53 @@ vsDisplayList::GetTriangles(vsArray<struct Triangle>& result)
 		vsRenderBuffer		*currentVertexBuffer = nullptr;
 		//int			currentVertexArraySize = 0;
 
-		Rewind();
-		op *o = PopOp();
+		Iterator ops = GetOps();
+		OpView o = ops.Next();
 
-		while(o)
+		while( o.IsValid() )
 		{
-			if ( o->type == OpCode_PushMatrix4x4 )
+			if ( o.GetType() == OpCode_PushMatrix4x4 )
 			{
-				transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o->data.matrix4x4;
+				transformStack[transformStackLevel+1] = transformStack[transformStackLevel] * o.Get<vsMatrix4x4>();
 				transformStackLevel++;
 			}
-			if ( o->type == OpCode_SetMatrix4x4 )
+			if ( o.GetType() == OpCode_SetMatrix4x4 )
 			{
-				transformStack[++transformStackLevel] = o->data.matrix4x4;
+				transformStack[++transformStackLevel] = o.Get<vsMatrix4x4>();
 			}
-			else if ( o->type == OpCode_SetMatrices4x4 )
+			else if ( o.GetType() == OpCode_SetMatrices4x4 )
 			{
-				vsMatrix4x4 *mat = (vsMatrix4x4*)o->data.p;
+				vsMatrix4x4 *mat = o.GetPointer<vsMatrix4x4>();
 				transformStack[++transformStackLevel] = *mat;
 			}
-			else if ( o->type == OpCode_PopTransform )
+			else if ( o.GetType() == OpCode_PopTransform )
 			{
 				transformStackLevel--;
 			}
-			else if ( o->type == OpCode_VertexArray )
+			else if ( o.GetType() == OpCode_VertexArray )
 			{
 				vsVector3D pos;
-				float *shuttle = (float *) o->data.p;
+				float *shuttle = o.GetArray<float>();
 				currentVertexArray = (vsVector3D *)shuttle;
 				currentVertexBuffer = nullptr;
 			}
-			else if ( o->type == OpCode_VertexBuffer )
+			else if ( o.GetType() == OpCode_VertexBuffer )
 			{
 				vsVector3D pos;
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				currentVertexArray = buffer->GetVector3DArray();
 				currentVertexBuffer = nullptr;
 			}
-			else if ( o->type == OpCode_BindBuffer )
+			else if ( o.GetType() == OpCode_BindBuffer )
 			{
 				vsVector3D pos;
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				currentVertexArray = nullptr;//buffer->GetVector3DArray();
 				currentVertexBuffer = buffer;
 			}
-			else if ( o->type == OpCode_TriangleListBuffer )
+			else if ( o.GetType() == OpCode_TriangleListBuffer )
 			{
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				uint16_t *shuttle = buffer->GetIntArray();
 
 				for ( int i = 0; i < buffer->GetIntArraySize(); i+=3 )
@@ -1948,9 +1821,9 @@ vsDisplayList::GetTriangles(vsArray<struct Triangle>& result)
 					count++;
 				}
 			}
-			else if ( o->type == OpCode_TriangleStripBuffer )
+			else if ( o.GetType() == OpCode_TriangleStripBuffer )
 			{
-				vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+				vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 				uint16_t *shuttle = buffer->GetIntArray();
 
 				for ( int i = 2; i < buffer->GetIntArraySize(); i++ )
@@ -1979,7 +1852,7 @@ vsDisplayList::GetTriangles(vsArray<struct Triangle>& result)
 				}
 			}
 
-			o = PopOp();
+			o = ops.Next();
 		}
 	}
 	return count;
@@ -1993,41 +1866,41 @@ vsDisplayList::CalculateStats()
 	s.vertexCount = 0;
 	s.triangleCount = 0;
 
-	Rewind();
-	op *o = PopOp();
+	Iterator ops = GetOps();
+	OpView o = ops.Next();
 
-	while(o)
+	while( o.IsValid() )
 	{
-		if ( o->type == OpCode_VertexArray )
+		if ( o.GetType() == OpCode_VertexArray )
 		{
-			int count = o->data.GetUInt();
+			int count = o.GetArrayCount<vsVector3D>();
 			s.vertexCount += count;
 		}
-		else if ( o->type == OpCode_VertexBuffer )
+		else if ( o.GetType() == OpCode_VertexBuffer )
 		{
-			vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+			vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 			s.vertexCount += buffer->GetVector3DArraySize();
 		}
-		else if ( o->type == OpCode_BindBuffer )
+		else if ( o.GetType() == OpCode_BindBuffer )
 		{
 			vsVector3D pos;
-			vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+			vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 			s.vertexCount += buffer->GetPositionCount();
 		}
-		else if ( o->type == OpCode_TriangleListBuffer )
+		else if ( o.GetType() == OpCode_TriangleListBuffer )
 		{
-			vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+			vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 			s.triangleCount += buffer->GetIntArraySize() / 3;
 			s.drawCount++;
 		}
-		else if ( o->type == OpCode_TriangleStripBuffer )
+		else if ( o.GetType() == OpCode_TriangleStripBuffer )
 		{
-			vsRenderBuffer *buffer = (vsRenderBuffer *)o->data.p;
+			vsRenderBuffer *buffer = o.GetPointer<vsRenderBuffer>();
 			s.triangleCount += buffer->GetIntArraySize() - 2;
 			s.drawCount++;
 		}
 
-		o = PopOp();
+		o = ops.Next();
 	}
 	return s;
 }
@@ -2039,16 +1912,16 @@ vsDisplayList::ApplyOffset(const vsVector2D &offset)
 
 	vsTransform2D currentTransform;
 
-	Rewind();
-	op *o = PopOp();
+	Iterator ops = GetOps();
+	OpView o = ops.Next();
 
-	while(o)
+	while( o.IsValid() )
 	{
-		if ( o->type == OpCode_VertexArray )
+		if ( o.GetType() == OpCode_VertexArray )
 		{
 			vsVector3D pos;
-			int count = o->data.GetUInt();
-			float *shuttle = (float *) o->data.p;
+			int count = o.GetArrayCount<vsVector3D>();
+			float *shuttle = o.GetArray<float>();
 
 			for ( int i = 0; i < count; i++ )
 			{
@@ -2059,7 +1932,7 @@ vsDisplayList::ApplyOffset(const vsVector2D &offset)
 			}
 		}
 
-		o = PopOp();
+		o = ops.Next();
 	}
 }
 
@@ -138,55 +138,104 @@ public:
 		OpCode_MAX
 	};
 
-	struct Data
+	// Ops are stored in our fifo in native byte order, as a four byte header
+	// followed by the op's payload.  The header holds the OpCode in its low
+	// eight bits and the payload size in bytes in the rest.  Payloads too big
+	// for those 24 bits (huge inline vertex or index arrays) store
+	// c_extendedSize there instead, and the real size in a second four byte
+	// word right after the header.  Payloads are padded out to a multiple of
+	// four bytes, so every header and payload starts four-byte aligned.
+	// Nothing is ever byte-swapped or copied out of the fifo while decoding;
+	// an OpView just points at an op in place.
+	//
+	// Array payloads (VertexArray, TriangleListArray, etc) are just the array
+	// data, so the element count is the payload size over the element size.
+	// Pointers are stored unaligned, so read them with GetPointer().
+	class OpView
 	{
-		uint32_t i;
-		vsShaderOptions shaderOptions;
-		vsVector3D vector;
-		vsBox2D box2D;
-		vsBox2D box2D2;
-		vsColor color;
-		vsTransform2D transform;
-		vsLight light;
-		vsFog fog;
-		vsMatrix4x4 matrix4x4;
-		vsString string;
-		float fov;
-		float nearPlane;
-		float farPlane;
-		char *p;
-		char *p2;
-
-		void Set(uint32_t id) {i = id;}
-		void Set(const vsBox2D & in) {box2D = in;}
-		void Set(const vsVector3D & in) {vector = in;}
-		void Set(const vsColor & in) {color = in;}
-		void Set(const vsTransform2D &t) {transform = t;}
-		void Set(const vsMatrix4x4 &m, float fov_in, float nearPlane_in, float farPlane_in) {matrix4x4 = m; fov = fov_in; nearPlane = nearPlane_in; farPlane = farPlane_in;}
-		void Set(const vsString &s) {string = s;}
-		void SetPointer(char *pointer) {p = pointer;}
-		void SetPointer2(char *pointer) {p2 = pointer;}
-
-		uint32_t GetUInt() { return i; }
-		vsBox2D GetBox2D() {return box2D;}
-		vsVector3D GetVector3D() {return vector;}
-		vsColor GetColor() {return color; }
-		vsTransform2D GetTransform() {return transform;}
-		vsMatrix4x4 & GetMatrix4x4() {return matrix4x4;}
-		vsString GetString() {return string;}
+		const char *	m_op;
+
+		uint32_t	Header() const { uint32_t h; memcpy(&h, m_op, sizeof(h)); return h; }
+		uint32_t	HeaderSize() const { return ( (Header() >> 8) == c_extendedSize ) ? 2 * c_headerSize : c_headerSize; }
+	public:
+		static const uint32_t c_headerSize = sizeof(uint32_t);
+		static const uint32_t c_extendedSize = (1 << 24) - 1;
+		static const uint32_t c_maxPayloadSize = 0xfffffff0;
+
+		OpView(): m_op(nullptr) {}
+		explicit OpView( const char *op ): m_op(op) {}
+
+		bool			IsValid() const { return m_op != nullptr; }
+		OpCode			GetType() const { return (OpCode)(Header() & 0xff); }
+		uint32_t		GetPayloadSize() const
+		{
+			uint32_t size = Header() >> 8;
+			if ( size == c_extendedSize )
+				memcpy( &size, m_op + c_headerSize, sizeof(size) );
+			return size;
+		}
+		uint32_t		GetSize() const { return HeaderSize() + ((GetPayloadSize() + 3) & ~3); }	// header, payload, and padding
+		const char *	GetData() const { return m_op; }
+		char *			GetPayload() const { return const_cast<char*>(m_op + HeaderSize()); }
+
+		// A payload value of type T, 'offset' bytes into the payload.
+		template<typename T>
+		const T&		Get( uint32_t offset = 0 ) const
+		{
+			static_assert( alignof(T) <= 4, "Display list payloads are only four-byte aligned" );
+			return *reinterpret_cast<const T*>( GetPayload() + offset );
+		}
+
+		// The 'index'th pointer in the payload.
+		template<typename T>
+		T *				GetPointer( int index = 0 ) const
+		{
+			T *result;
+			memcpy( &result, GetPayload() + index * sizeof(void*), sizeof(result) );
+			return result;
+		}
+
+		// Array payloads.
+		template<typename T>
+		T *				GetArray() const { return reinterpret_cast<T*>( GetPayload() ); }
+		template<typename T>
+		int				GetArrayCount() const { return GetPayloadSize() / sizeof(T); }
+	};
+
+	// Walks the ops in a display list, front to back.
+	class Iterator
+	{
+		const char *	m_cursor;
+		const char *	m_end;
+	public:
+		Iterator( const char *begin, const char *end ): m_cursor(begin), m_end(end) {}
+
+		// Returns an invalid OpView once we've run out of ops.
+		OpView			Next()
+		{
+			if ( m_cursor >= m_end )
+				return OpView();
+			OpView result( m_cursor );
+			m_cursor += result.GetSize();
+			return result;
+		}
 	};
 
-	struct op
+	// vsLight isn't trivially copyable, so Light ops store this instead.
+	struct LightData
 	{
-		OpCode	type;
-		Data	data;
+		vsVector3D	position;
+		vsVector3D	direction;
+		vsColor		color;
+		vsColor		ambient;
+		vsColor		specular;
+		int32_t		type;
 	};
 
 private:
 
 	vsStore *	m_fifo;
-
-	op  m_currentOp;
+	bool		m_ownsFifo;
 
 	vsDisplayList *	m_instanceParent;		// if set, I'm an instance of this other vsDisplayList, and contain no actual data myself
 	int				m_instanceCount;		// The number of instances that have been derived off of me.  If this value isn't zero, assert if someone tries to delete me.
@@ -201,6 +250,13 @@ private:
 	vsVector3D		m_cursorPos;
 
 
+	char *		WriteOpHeader( OpCode code, size_t payloadSize );	// returns where to write the payload
+	void		WriteOp( OpCode code ) { WriteOpHeader( code, 0 ); }
+	template<typename T>
+	void		WriteOp( OpCode code, const T& payload ) { memcpy( WriteOpHeader( code, sizeof(T) ), &payload, sizeof(T) ); }
+	void		WritePointerOp( OpCode code, const void *pointer );
+	void		WriteIndexArrayOp( OpCode code, const int *idArray, int vertexCount );
+
 	static vsDisplayList *	Load_Vec( const vsString & );
 	static vsDisplayList *	Load_Vec( vsRecord *record );
 	static vsDisplayList *	Load_Obj(const vsString &);
@@ -215,6 +271,7 @@ public:
 	static vsDisplayList *	Load( vsRecord *record );
 
 			vsDisplayList(size_t memSize = 50 * 1024, bool autoResize = false );
+			vsDisplayList( vsStore &fifo );	// write into an externally owned store, which we won't delete.
 	virtual	~vsDisplayList();
 
 	vsStore *		GetFifo() { return m_fifo; }
@@ -362,9 +419,18 @@ public:
 	// Can be useful for debugging renderer commands.
 	void	Debug(const vsString &message);
 
-	OpCode	PeekOpType();
-	op *	PopOp();
-	void	AppendOp(op *);
+	Iterator	GetOps() const;	// iterate over our ops (or our instance parent's)
+	void		AppendOp( const OpView& op );
+
+	// Strips out ops which can't change what gets drawn (setting a material
+	// or color which is already set, pushing an identity transform, binding a
+	// buffer which is already bound, etc), and merges adjacent list draws of
+	// the same type into a single draw.  Meant to be run once, when a display
+	// list has finished being built.  We assume nothing about the renderer's
+	// state when the list starts, so this is always safe to do to a list which
+	// will later be appended into another one.  Returns the number of ops
+	// removed.
+	int			Optimise();
 
 	static const vsString& GetOpCodeString( OpCode code );
 
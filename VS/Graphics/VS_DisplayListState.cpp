@@ -0,0 +1,251 @@
+/*
+ *  VS_DisplayListState.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_DisplayListState.h"
+
+#include "VS_Fog.h"
+#include "VS_RenderBuffer.h"
+#include "VS/Math/VS_Transform.h"
+
+vsDisplayListState::vsDisplayListState():
+	m_currentTransformStackLevel(0),
+	m_currentLocalToWorld(nullptr),
+	m_currentLocalToWorldBuffer(nullptr),
+	m_currentLocalToWorldCount(0),
+	m_currentColor(c_white),
+	m_currentColors(nullptr),
+	m_currentColorsBuffer(nullptr),
+	m_currentFogDensity(0.001f),
+	m_currentShaderValues(nullptr),
+	m_currentVertexArray(nullptr),
+	m_currentNormalArray(nullptr),
+	m_currentTexelArray(nullptr),
+	m_currentColorArray(nullptr),
+	m_currentVertexArrayCount(0),
+	m_currentNormalArrayCount(0),
+	m_currentTexelArrayCount(0),
+	m_currentColorArrayCount(0),
+	m_currentVertexBuffer(nullptr),
+	m_currentNormalBuffer(nullptr),
+	m_currentTexelBuffer(nullptr),
+	m_currentColorBuffer(nullptr)
+{
+	m_transformStack[0] = vsMatrix4x4::Identity;
+}
+
+void
+vsDisplayListState::ResetDisplayListState()
+{
+	m_currentColor = c_white;
+	m_currentColors = nullptr;
+	m_currentColorsBuffer = nullptr;
+	m_currentFogDensity = 0.001f;
+	m_currentLocalToWorld = nullptr;
+	m_currentLocalToWorldBuffer = nullptr;
+	m_currentLocalToWorldCount = 0;
+	m_currentShaderValues = nullptr;
+	m_currentTransformStackLevel = 0;
+	m_transformStack[m_currentTransformStackLevel] = vsMatrix4x4::Identity;
+	m_optionsStack.Clear();
+	ClearArrays();
+}
+
+void
+vsDisplayListState::PushLocalToWorld( const vsMatrix4x4& localToWorld )
+{
+	vsAssert( m_currentTransformStackLevel < c_maxTransformStackLevel-1, "Renderer transform stack overflow??" );
+	m_transformStack[++m_currentTransformStackLevel] = localToWorld;
+	m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
+	m_currentLocalToWorldCount = 1;
+	m_currentLocalToWorldBuffer = nullptr;
+}
+
+void
+vsDisplayListState::ClearArrays()
+{
+	m_currentColorArray = nullptr;
+	m_currentColorBuffer = nullptr;
+	m_currentColorArrayCount = 0;
+
+	m_currentTexelBuffer = nullptr;
+	m_currentTexelArray = nullptr;
+	m_currentTexelArrayCount = 0;
+
+	m_currentNormalBuffer = nullptr;
+	m_currentNormalArray = nullptr;
+	m_currentNormalArrayCount = 0;
+
+	m_currentVertexBuffer = nullptr;
+	m_currentVertexArray = nullptr;
+	m_currentVertexArrayCount = 0;
+}
+
+bool
+vsDisplayListState::ApplyStateOp( const vsDisplayList::OpView& op )
+{
+	switch( op.GetType() )
+	{
+		case vsDisplayList::OpCode_SetColor:
+			m_currentColor = op.Get<vsColor>();
+			m_currentColors = nullptr;
+			m_currentColorsBuffer = nullptr;
+			return true;
+		case vsDisplayList::OpCode_SetColors:
+			m_currentColors = op.GetPointer<vsColor>();
+			m_currentColorsBuffer = nullptr;
+			return true;
+		case vsDisplayList::OpCode_SetColorsBuffer:
+			m_currentColors = nullptr;
+			m_currentColorsBuffer = op.GetPointer<vsRenderBuffer>();
+			return true;
+		case vsDisplayList::OpCode_PushTransform:
+			PushLocalToWorld( m_transformStack[m_currentTransformStackLevel] * op.Get<vsTransform2D>().GetMatrix() );
+			return true;
+		case vsDisplayList::OpCode_PushTranslation:
+			{
+				vsMatrix4x4 m;
+				m.SetTranslation( op.Get<vsVector3D>() );
+				PushLocalToWorld( m_transformStack[m_currentTransformStackLevel] * m );
+				return true;
+			}
+		case vsDisplayList::OpCode_PushMatrix4x4:
+			PushLocalToWorld( m_transformStack[m_currentTransformStackLevel] * op.Get<vsMatrix4x4>() );
+			return true;
+		case vsDisplayList::OpCode_SetMatrix4x4:
+			PushLocalToWorld( op.Get<vsMatrix4x4>() );
+			return true;
+		case vsDisplayList::OpCode_SetMatrices4x4:
+			{
+				vsMatrix4x4 *m = op.GetPointer<vsMatrix4x4>();
+				PushLocalToWorld( m[0] );
+				m_currentLocalToWorld = m;
+				m_currentLocalToWorldCount = op.Get<uint32_t>( sizeof(void*) );
+				return true;
+			}
+		case vsDisplayList::OpCode_SetMatrices4x4Buffer:
+			{
+				vsRenderBuffer *b = op.GetPointer<vsRenderBuffer>();
+				PushLocalToWorld( vsMatrix4x4::Identity );
+				m_currentLocalToWorld = nullptr;
+				m_currentLocalToWorldCount = b->GetActiveMatrix4x4ArraySize();
+				m_currentLocalToWorldBuffer = b;
+				return true;
+			}
+		case vsDisplayList::OpCode_SnapMatrix:
+			{
+				vsMatrix4x4 m = m_transformStack[m_currentTransformStackLevel];
+				vsVector4D &t = m.w;
+				t.x = (float)vsFloor(t.x + 0.5f);
+				t.y = (float)vsFloor(t.y + 0.5f);
+				t.z = (float)vsFloor(t.z + 0.5f);
+				PushLocalToWorld( m );
+				return true;
+			}
+		case vsDisplayList::OpCode_PopTransform:
+			vsAssert(m_currentTransformStackLevel > 0, "Renderer transform stack underflow??");
+			m_currentTransformStackLevel--;
+			m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
+			m_currentLocalToWorldCount = 1;
+			m_currentLocalToWorldBuffer = nullptr;
+			return true;
+		case vsDisplayList::OpCode_SetWorldToViewMatrix4x4:
+			m_currentWorldToView = op.Get<vsMatrix4x4>();
+			return true;
+		case vsDisplayList::OpCode_SetProjectionMatrix4x4:
+			m_currentViewToProjection = op.Get<vsMatrix4x4>();
+			return true;
+		case vsDisplayList::OpCode_SetShaderValues:
+			m_currentShaderValues = op.GetPointer<vsShaderValues>();
+			return true;
+		case vsDisplayList::OpCode_ClearShaderValues:
+			m_currentShaderValues = nullptr;
+			return true;
+		case vsDisplayList::OpCode_PushShaderOptions:
+			m_optionsStack.AddItem( op.Get<vsShaderOptions>() );
+			return true;
+		case vsDisplayList::OpCode_PopShaderOptions:
+			m_optionsStack.SetArraySize( m_optionsStack.ItemCount() - 1 );
+			return true;
+		case vsDisplayList::OpCode_Fog:
+			{
+				const vsFog& fog = op.Get<vsFog>();
+				m_currentFogColor = fog.GetColor();
+				m_currentFogDensity = fog.GetDensity();
+				return true;
+			}
+		case vsDisplayList::OpCode_VertexArray:
+			m_currentVertexArray = op.GetArray<vsVector3D>();
+			m_currentVertexArrayCount = op.GetArrayCount<vsVector3D>();
+			m_currentVertexBuffer = nullptr;
+			return true;
+		case vsDisplayList::OpCode_VertexBuffer:
+			m_currentVertexBuffer = op.GetPointer<vsRenderBuffer>();
+			m_currentVertexArray = nullptr;
+			m_currentVertexArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_NormalArray:
+			m_currentNormalArray = op.GetArray<vsVector3D>();
+			m_currentNormalArrayCount = op.GetArrayCount<vsVector3D>();
+			return true;
+		case vsDisplayList::OpCode_NormalBuffer:
+			m_currentNormalBuffer = op.GetPointer<vsRenderBuffer>();
+			m_currentNormalArray = nullptr;
+			m_currentNormalArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_TexelArray:
+			m_currentTexelArray = op.GetArray<vsVector2D>();
+			m_currentTexelArrayCount = op.GetArrayCount<vsVector2D>();
+			return true;
+		case vsDisplayList::OpCode_TexelBuffer:
+			m_currentTexelBuffer = op.GetPointer<vsRenderBuffer>();
+			m_currentTexelArray = nullptr;
+			m_currentTexelArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_ColorArray:
+			m_currentColorArray = op.GetArray<vsColor>();
+			m_currentColorArrayCount = op.GetArrayCount<vsColor>();
+			return true;
+		case vsDisplayList::OpCode_ColorBuffer:
+			m_currentColorBuffer = op.GetPointer<vsRenderBuffer>();
+			m_currentColorArray = nullptr;
+			m_currentColorArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_ClearVertexArray:
+			m_currentVertexBuffer = nullptr;
+			m_currentVertexArray = nullptr;
+			m_currentVertexArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_ClearNormalArray:
+			m_currentNormalBuffer = nullptr;
+			m_currentNormalArray = nullptr;
+			m_currentNormalArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_ClearColorArray:
+			m_currentColorBuffer = nullptr;
+			m_currentColorArray = nullptr;
+			m_currentColorArrayCount = 0;
+			return true;
+		case vsDisplayList::OpCode_ClearArrays:
+			ClearArrays();
+			return true;
+		case vsDisplayList::OpCode_ClearTexelArray:
+		case vsDisplayList::OpCode_SetCameraTransform:
+		case vsDisplayList::OpCode_ClearFog:
+		case vsDisplayList::OpCode_FlatShading:
+		case vsDisplayList::OpCode_SmoothShading:
+		case vsDisplayList::OpCode_EnableStencil:
+		case vsDisplayList::OpCode_DisableStencil:
+		case vsDisplayList::OpCode_Debug:
+			// nothing to track for these.
+			return true;
+		default:
+			return false;
+	}
+}
+
@@ -0,0 +1,82 @@
+/*
+ *  VS_DisplayListState.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_DISPLAYLISTSTATE_H
+#define VS_DISPLAYLISTSTATE_H
+
+#include "VS_Color.h"
+#include "VS_DisplayList.h"
+#include "VS_ShaderOptions.h"
+#include "VS/Math/VS_Matrix.h"
+#include "VS/Utils/VS_Array.h"
+
+class vsRenderBuffer;
+class vsShaderValues;
+
+// vsDisplayListState is the state which a renderer builds up as it walks a
+// display list:  the transform stack, current colors, vertex arrays and
+// buffers, shader values and options, and so on.  Every renderer decodes
+// those ops through ApplyStateOp(), so they all agree on what each one means;
+// the renderers themselves only handle ops which have to talk to the GPU (or
+// pretend to), and whatever else they need to do after the state changes.
+
+class vsDisplayListState
+{
+public:
+	static const int c_maxTransformStackLevel = 30;
+
+protected:
+
+	vsMatrix4x4			m_transformStack[c_maxTransformStackLevel];
+	int					m_currentTransformStackLevel;
+	vsMatrix4x4 *		m_currentLocalToWorld;
+	vsRenderBuffer *	m_currentLocalToWorldBuffer;
+	int					m_currentLocalToWorldCount;
+	vsMatrix4x4			m_currentWorldToView;
+	vsMatrix4x4			m_currentViewToProjection;
+
+	vsColor				m_currentColor;
+	vsColor *			m_currentColors;
+	vsRenderBuffer *	m_currentColorsBuffer;
+	vsColor				m_currentFogColor;
+	float				m_currentFogDensity;
+
+	vsShaderValues *	m_currentShaderValues;
+	vsArray<vsShaderOptions> m_optionsStack;
+
+	vsVector3D *		m_currentVertexArray;
+	vsVector3D *		m_currentNormalArray;
+	vsVector2D *		m_currentTexelArray;
+	vsColor *			m_currentColorArray;
+	int					m_currentVertexArrayCount;
+	int					m_currentNormalArrayCount;
+	int					m_currentTexelArrayCount;
+	int					m_currentColorArrayCount;
+
+	vsRenderBuffer *	m_currentVertexBuffer;
+	vsRenderBuffer *	m_currentNormalBuffer;
+	vsRenderBuffer *	m_currentTexelBuffer;
+	vsRenderBuffer *	m_currentColorBuffer;
+
+	void	PushLocalToWorld( const vsMatrix4x4& localToWorld );
+	void	ClearArrays();
+
+	// Back to the state at the start of a display list.
+	void	ResetDisplayListState();
+
+	// If 'op' only changes state which we track, apply it and return true.
+	// Returns false for ops which the renderer has to handle by itself.
+	bool	ApplyStateOp( const vsDisplayList::OpView& op );
+
+public:
+	vsDisplayListState();
+};
+
+#endif // VS_DISPLAYLISTSTATE_H
+
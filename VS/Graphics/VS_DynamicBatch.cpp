@@ -14,7 +14,9 @@
 
 vsDynamicBatch::vsDynamicBatch():
 	m_vbo(vsRenderBuffer::Type_Stream),
-	m_ibo(vsRenderBuffer::Type_Stream)
+	m_ibo(vsRenderBuffer::Type_Stream),
+	m_vboCapacity(0),
+	m_iboCapacity(0)
 {
 }
 
@@ -45,7 +47,22 @@ vsDynamicBatch::Supports( vsRenderBuffer::ContentType type )
 bool
 vsDynamicBatch::CanFitVertices( int vertexCount ) const
 {
-	return (m_vbo.GetPositionCount() + vertexCount) <= 200;
+	return (m_vbo.GetPositionCount() + vertexCount) <= c_maxVertices;
+}
+
+void
+vsDynamicBatch::GrowBuffer( vsRenderBuffer& buffer, int& capacity, int bytes )
+{
+	if ( bytes > capacity )
+	{
+		int bucket = vsMax( 4 * 1024, capacity );
+		while ( bucket < bytes )
+			bucket *= 4;
+		buffer.ResizeArray( bucket );
+		capacity = bucket;
+	}
+	// this never reallocates, since we've already got enough storage.
+	buffer.ResizeArray( bytes );
 }
 
 void
@@ -79,7 +96,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::P);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::P* i = fvbo->GetPArray();
 		vsRenderBuffer::P* o = m_vbo.GetPArray();
 
@@ -94,7 +111,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PN);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PN* i = fvbo->GetPNArray();
 		vsRenderBuffer::PN* o = m_vbo.GetPNArray();
 
@@ -110,7 +127,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PT);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PT* i = fvbo->GetPTArray();
 		vsRenderBuffer::PT* o = m_vbo.GetPTArray();
 
@@ -126,7 +143,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PC);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PC* i = fvbo->GetPCArray();
 		vsRenderBuffer::PC* o = m_vbo.GetPCArray();
 
@@ -142,7 +159,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PCT);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PCT* i = fvbo->GetPCTArray();
 		vsRenderBuffer::PCT* o = m_vbo.GetPCTArray();
 
@@ -159,7 +176,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PCN);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PCN* i = fvbo->GetPCNArray();
 		vsRenderBuffer::PCN* o = m_vbo.GetPCNArray();
 
@@ -176,7 +193,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 	{
 		int size = first ? 0 : m_vbo.GetGenericArraySize();
 		indexOfFirstVertex = size / sizeof(vsRenderBuffer::PCNT);
-		m_vbo.ResizeArray( size + fvbo->GetGenericArraySize() );
+		GrowBuffer( m_vbo, m_vboCapacity, size + fvbo->GetGenericArraySize() );
 		vsRenderBuffer::PCNT* i = fvbo->GetPCNTArray();
 		vsRenderBuffer::PCNT* o = m_vbo.GetPCNTArray();
 
@@ -212,7 +229,7 @@ vsDynamicBatch::AddToBatch_Internal( vsRenderBuffer *fvbo, vsRenderBuffer *fibo,
 		}
 
 		int newIndexCount = oo + (3*trianglesForNewFragment);
-		m_ibo.ResizeArray( newIndexCount * sizeof(uint16_t) );
+		GrowBuffer( m_ibo, m_iboCapacity, newIndexCount * sizeof(uint16_t) );
 		// m_ibo.SetIntArraySize( oo + (3*trianglesForNewFragment) );
 
 		uint16_t* i = fibo->GetIntArray();
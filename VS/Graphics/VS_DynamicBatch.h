@@ -25,14 +25,28 @@ class vsDisplayList;
 // vsDynamcicBatchManager, which is notified after each
 // frame is drawn, so these dynamic batch items return to
 // the global pool.
+//
+// A batch's buffers grow through a series of pre-sized buckets (4kb, 16kb,
+// 64kb, ...) rather than being resized for every fragment added, and keep
+// their storage when the batch is returned to the pool;  so once the pool has
+// warmed up, building batches doesn't allocate.
 
 class vsDynamicBatch
 {
 	vsRenderBuffer m_vbo;
 	vsRenderBuffer m_ibo;
+	int m_vboCapacity;	// bytes
+	int m_iboCapacity;	// bytes
 
+	static void GrowBuffer( vsRenderBuffer& buffer, int& capacity, int bytes );
 	void AddToBatch_Internal( vsRenderBuffer *vbo, vsRenderBuffer *ibo, const vsMatrix4x4& mat, vsFragment::SimpleType type, bool first );
 public:
+	// fragments with at least this many vertices aren't worth merging.
+	static const int c_maxMergeableVertices = 100;
+	// upper limit on the size of a whole batch.  (Must stay below 65536, as
+	// our merged index buffers are 16-bit)
+	static const int c_maxVertices = 8192;
+
 	vsDynamicBatch();
 
 	void Reset();
@@ -13,7 +13,10 @@
 vsDynamicBatchManager * vsDynamicBatchManager::s_instance = nullptr;
 
 vsDynamicBatchManager::vsDynamicBatchManager():
-	m_unusedBatches(50, vsPool<vsDynamicBatch>::Type_Expandable)
+	m_unusedBatches(50, vsPool<vsDynamicBatch>::Type_Expandable),
+	m_mergedFragments(0),
+	m_batches(0),
+	m_drawCalls(0)
 {
 	vsAssert(s_instance == nullptr, "Multiple vsDynamicBatchManagers created??");
 
@@ -30,8 +33,11 @@ vsDynamicBatchManager::~vsDynamicBatchManager()
 vsDynamicBatch *
 vsDynamicBatchManager::GetNewBatch()
 {
+	m_lock.Lock();
 	vsDynamicBatch *result = m_unusedBatches.Borrow();
 	m_usedBatches.AddItem(result);
+	m_lock.Unlock();
+	m_batches.fetch_add(1, std::memory_order_relaxed);
 
 	return result;
 }
@@ -39,6 +45,14 @@ vsDynamicBatchManager::GetNewBatch()
 void
 vsDynamicBatchManager::FrameRendered()
 {
+	// We get called both by the renderer and by coreGame at the end of each
+	// frame;  don't let the second call wipe out the first one's stats.
+	if ( m_drawCalls.load() > 0 || m_batches.load() > 0 )
+	{
+		m_lastFrameStats.mergedFragments = m_mergedFragments.exchange(0);
+		m_lastFrameStats.batches = m_batches.exchange(0);
+		m_lastFrameStats.drawCalls = m_drawCalls.exchange(0);
+	}
 	ResetBatches();
 }
 
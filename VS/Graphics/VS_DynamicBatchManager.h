@@ -12,14 +12,37 @@
 
 #include "VS/Utils/VS_Array.h"
 #include "VS/Utils/VS_Pool.h"
+#include "VS/Threads/VS_Spinlock.h"
+#include <atomic>
 class vsDynamicBatch;
 
+// Render queues may be built on worker threads (see vsParallelDraw), so
+// GetNewBatch() and the Count*() functions are safe to call from any thread.
+// FrameRendered() is not;  it's only called once nobody is building a queue.
+
 class vsDynamicBatchManager
 {
 	static vsDynamicBatchManager *	s_instance;
 
+public:
+	struct Stats
+	{
+		int mergedFragments;	// fragments which were merged into another fragment's batch
+		int batches;			// dynamic batches built
+		int drawCalls;			// draws issued by the render queue (a dynamic batch counts as one)
+
+		Stats(): mergedFragments(0), batches(0), drawCalls(0) {}
+	};
+private:
+
 	vsPool<vsDynamicBatch> m_unusedBatches;
 	vsArray<vsDynamicBatch*> m_usedBatches;
+	vsSpinlock m_lock;	// protects the two batch lists
+
+	std::atomic<int> m_mergedFragments;
+	std::atomic<int> m_batches;
+	std::atomic<int> m_drawCalls;
+	Stats m_lastFrameStats;
 
 	void ResetBatches();
 public:
@@ -30,6 +53,10 @@ public:
 
 	vsDynamicBatch * GetNewBatch();
 	void FrameRendered();
+
+	void CountMergedFragment() { m_mergedFragments.fetch_add(1, std::memory_order_relaxed); }
+	void CountDrawCalls( int count ) { m_drawCalls.fetch_add(count, std::memory_order_relaxed); }
+	const Stats& GetLastFrameStats() const { return m_lastFrameStats; }
 };
 
 
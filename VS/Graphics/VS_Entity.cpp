@@ -12,6 +12,8 @@
 #include "VS_Scene.h"
 #include "VS_Screen.h"
 #include "VS_System.h"
+#include "VS_ParallelDraw.h"
+#include "VS_FrameArena.h"
 
 vsEntity::vsEntity():
 	m_name( vsEmptyString ),
@@ -152,6 +154,30 @@ vsEntity::DrawChildren( vsRenderQueue *queue )
 	}
 }
 
+void
+vsEntity::DrawChildrenParallel( vsRenderQueue *queue )
+{
+	if ( !vsParallelDraw::Instance() )
+	{
+		DrawChildren( queue );
+		return;
+	}
+
+	int childCount = 0;
+	for ( vsEntity *child = m_child; child; child = child->m_next )
+		childCount++;
+
+	vsEntity **visible = vsFrameArena::Instance()->Alloc<vsEntity*>( childCount );
+	int visibleCount = 0;
+	for ( vsEntity *child = m_child; child; child = child->m_next )
+	{
+		if ( child->OnScreen(g_drawingCameraTransform) )
+			visible[visibleCount++] = child;
+	}
+
+	vsParallelDraw::Instance()->Draw( queue, visible, visibleCount );
+}
+
 void
 vsEntity::Draw( vsRenderQueue *queue )
 {
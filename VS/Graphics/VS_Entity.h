@@ -39,6 +39,11 @@ protected:
 	bool			m_extractQueued;
 
 	void			DrawChildren( vsRenderQueue *queue );
+	// Same as DrawChildren(), but for entities with lots of children;  builds
+	// the children's part of the render queue on several threads at once.  Only
+	// use this if the children's Draw() functions are thread-safe!  (See
+	// vsParallelDraw for details)
+	void			DrawChildrenParallel( vsRenderQueue *queue );
 
 	void			DoExtract();
 
@@ -148,6 +148,7 @@ vsFontSize::LoadOldFormat( vsFile *font )
 		}
 	}
 
+	MapTexelsToAtlas();
 	m_ptBuffer = new vsRenderBuffer;
 
 	vsRenderBuffer::PT	*pt = new vsRenderBuffer::PT[m_glyphCount*4];
@@ -175,6 +176,18 @@ vsFontSize::LoadOldFormat( vsFile *font )
 
 }
 
+void
+vsFontSize::MapTexelsToAtlas()
+{
+	if ( !m_material )
+		return;
+	for ( int i = 0; i < m_glyphCount; i++ )
+	{
+		for ( int j = 0; j < 4; j++ )
+			m_glyph[i].texel[j] = m_material->MapTexel( m_glyph[i].texel[j] );
+	}
+}
+
 vsToken * GetBMFontValue( vsRecord *r, const vsString& label )
 {
 	for ( int i = 0; i < r->GetTokenCount()-2; i++ )
@@ -333,6 +346,7 @@ vsFontSize::LoadBMFont( vsFile *file )
 		}
 	}
 
+	MapTexelsToAtlas();
 	m_ptBuffer = new vsRenderBuffer;
 
 	vsRenderBuffer::PT *pt = new vsRenderBuffer::PT[m_glyphCount*4];
@@ -470,15 +484,21 @@ vsFont::~vsFont()
 	}
 }
 
-vsFontSize *
-vsFont::Size(float size)
+float
+vsFont::GetResolutionScale()
 {
 	if ( vsScreen::Instance()->GetTrueWidth() <
 			vsScreen::Instance()->GetMainRenderTarget()->GetWidth() )
 	{
-		float factor = vsScreen::Instance()->GetMainRenderTarget()->GetWidth() / (float)vsScreen::Instance()->GetTrueWidth();
-		size *= factor;
+		return vsScreen::Instance()->GetMainRenderTarget()->GetWidth() / (float)vsScreen::Instance()->GetTrueWidth();
 	}
+	return 1.f;
+}
+
+vsFontSize *
+vsFont::Size(float size)
+{
+	size *= GetResolutionScale();
 
 	int sizeCount = m_size.ItemCount();
 	for ( int i = 0; i < sizeCount; i++ )
@@ -11,6 +11,7 @@
 #define VS_FONT_H
 
 #include "VS_Texture.h"
+#include "VS_FontLayoutCache.h"
 #include "VS/Math/VS_Transform.h"
 #include "VS_RenderBuffer.h"
 #include "VS/Math/VS_Box.h"
@@ -88,6 +89,7 @@ class vsFontSize
 
 	void LoadOldFormat(vsFile *file);
 	void LoadBMFont(vsFile *file);
+	void MapTexelsToAtlas(); // in case our material's texture was packed into a vsTextureAtlas
 public:
 
 	vsFontSize( const vsString &filename );
@@ -119,6 +121,7 @@ class vsFont
 {
 	vsArrayStore<vsFontSize> m_size;
 	vsArray<vsFontFragment*> m_fragment;
+	vsFontLayoutCache m_layoutCache;
 public:
 	vsFont( const vsString &filename );
 	~vsFont();
@@ -126,6 +129,13 @@ public:
 	vsFontSize* Size(float size);
 	float MaxSize();
 
+	// How much Size() scales up requested sizes, to account for the main
+	// render target being larger than the window (eg: on HighDPI displays).
+	float GetResolutionScale();
+
+	// Shaped strings which vsFontRenderers have built with this font.
+	vsFontLayoutCache& GetLayoutCache() { return m_layoutCache; }
+
 	void RegisterFragment( vsFontFragment *fragment );
 	void RemoveFragment( vsFontFragment *fragment );
 
@@ -0,0 +1,143 @@
+/*
+ *  VS_FontLayoutCache.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_FontLayoutCache.h"
+
+vsFontLayoutCache::vsFontLayoutCache( int capacity ):
+	m_layout( capacity ),
+	m_head(nullptr),
+	m_tail(nullptr),
+	m_count(0),
+	m_capacity(capacity),
+	m_hits(0),
+	m_misses(0),
+	m_evictions(0)
+{
+	vsAssert( capacity > 0, "vsFontLayoutCache needs room for at least one layout" );
+}
+
+vsFontLayoutCache::~vsFontLayoutCache()
+{
+	Clear();
+}
+
+void
+vsFontLayoutCache::_Unlink( vsFontLayout *layout )
+{
+	if ( layout->prev )
+		layout->prev->next = layout->next;
+	else
+		m_head = layout->next;
+
+	if ( layout->next )
+		layout->next->prev = layout->prev;
+	else
+		m_tail = layout->prev;
+
+	layout->prev = layout->next = nullptr;
+}
+
+void
+vsFontLayoutCache::_LinkAtHead( vsFontLayout *layout )
+{
+	layout->prev = nullptr;
+	layout->next = m_head;
+	if ( m_head )
+		m_head->prev = layout;
+	else
+		m_tail = layout;
+	m_head = layout;
+}
+
+void
+vsFontLayoutCache::_EvictDownTo( int count )
+{
+	while ( m_count > count )
+	{
+		vsFontLayout *victim = m_tail;
+		_Unlink( victim );
+		m_layout.RemoveItemWithKey( victim, victim->key );
+		vsDelete( victim );
+		m_count--;
+		m_evictions++;
+	}
+}
+
+const vsFontLayout *
+vsFontLayoutCache::Find( const vsString &key )
+{
+	vsFontLayout **found = m_layout.FindItem( key );
+	if ( !found )
+	{
+		m_misses++;
+		return nullptr;
+	}
+
+	m_hits++;
+	vsFontLayout *layout = *found;
+	if ( layout != m_head )
+	{
+		_Unlink( layout );
+		_LinkAtHead( layout );
+	}
+	return layout;
+}
+
+void
+vsFontLayoutCache::Add( const vsString &key, vsFontLayout *layout )
+{
+	vsAssert( m_layout.FindItem( key ) == nullptr, "Layout is already cached??" );
+
+	_EvictDownTo( m_capacity-1 );
+
+	layout->key = key;
+	m_layout.AddItemWithKey( layout, key );
+	_LinkAtHead( layout );
+	m_count++;
+}
+
+void
+vsFontLayoutCache::Clear()
+{
+	m_layout.Clear();
+	while ( m_head )
+	{
+		vsFontLayout *layout = m_head;
+		m_head = layout->next;
+		vsDelete( layout );
+	}
+	m_tail = nullptr;
+	m_count = 0;
+}
+
+void
+vsFontLayoutCache::SetCapacity( int capacity )
+{
+	vsAssert( capacity > 0, "vsFontLayoutCache needs room for at least one layout" );
+	m_capacity = capacity;
+	_EvictDownTo( m_capacity );
+}
+
+vsFontLayoutCache::Stats
+vsFontLayoutCache::GetStats() const
+{
+	Stats stats;
+	stats.hits = m_hits;
+	stats.misses = m_misses;
+	stats.evictions = m_evictions;
+	stats.entries = m_count;
+	stats.capacity = m_capacity;
+	return stats;
+}
+
+void
+vsFontLayoutCache::ResetStats()
+{
+	m_hits = m_misses = m_evictions = 0;
+}
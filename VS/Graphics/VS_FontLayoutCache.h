@@ -0,0 +1,117 @@
+/*
+ *  VS_FontLayoutCache.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_FONTLAYOUTCACHE_H
+#define VS_FONTLAYOUTCACHE_H
+
+#include "VS/Utils/VS_Array.h"
+#include "VS/Utils/VS_HashTable.h"
+
+struct vsGlyph;
+class vsFontSize;
+
+// One glyph of a shaped string.  'x' is where the glyph's origin goes on its
+// line, in font units (that is, before scaling by the font size), with
+// justification and kerning already applied.
+struct vsFontLayoutGlyph
+{
+	vsGlyph *	glyph;
+	uint32_t	codepoint;
+	int			index;		// which codepoint of the whole string this is;  indexes glyph transforms and colours
+	float		x;
+};
+
+// One wrapped line of a shaped string.
+struct vsFontLayoutLine
+{
+	vsString	text;
+	float		y;					// in font units
+	float		width;				// in pixels, at the layout's size
+	int			firstGlyph;			// into vsFontLayout::glyph
+	int			glyphCount;
+	int			firstCodepoint;		// of the whole string
+	int			codepointCount;		// including ones which don't draw anything
+};
+
+// Everything vsFontRenderer works out about a string before it starts
+// emitting vertices:  how it wraps, what size it ends up at to fit inside
+// its bounds, and which glyph goes where on each line.
+struct vsFontLayout
+{
+	float						size;		// after shrinking to fit the bounds
+	float						texSize;	// which vsFontSize the glyphs come from
+	float						topLinePosition;
+	vsFontSize *				fontSize;	// == vsFont::Size(texSize)
+	vsArray<vsFontLayoutLine>	line;
+	vsArray<vsFontLayoutGlyph>	glyph;
+
+	// for vsFontLayoutCache's use only
+	vsString					key;
+	vsFontLayout *				prev;
+	vsFontLayout *				next;
+
+	vsFontLayout(): size(0.f), texSize(0.f), topLinePosition(0.f), fontSize(nullptr), prev(nullptr), next(nullptr) {}
+};
+
+// vsFontLayoutCache remembers the most recently used vsFontLayouts for a
+// single vsFont, so that building the same string again with the same
+// renderer settings (as UI code does with numbers and labels, frame after
+// frame) only has to emit vertices.  When full, it throws away whichever
+// layout was used least recently.
+//
+// Keys are built by vsFontRenderer from everything which affects layout.
+// Like the rest of vsFont, this isn't thread safe.
+
+class vsFontLayoutCache
+{
+	vsHashTable<vsFontLayout*>	m_layout;
+	vsFontLayout *				m_head;		// most recently used
+	vsFontLayout *				m_tail;		// least recently used
+	int							m_count;
+	int							m_capacity;
+
+	uint64_t					m_hits;
+	uint64_t					m_misses;
+	uint64_t					m_evictions;
+
+	void	_Unlink( vsFontLayout *layout );
+	void	_LinkAtHead( vsFontLayout *layout );
+	void	_EvictDownTo( int count );	// least recently used first
+
+public:
+
+	static const int c_defaultCapacity = 256;
+
+	struct Stats
+	{
+		uint64_t	hits;
+		uint64_t	misses;
+		uint64_t	evictions;
+		int			entries;
+		int			capacity;
+	};
+
+	vsFontLayoutCache( int capacity = c_defaultCapacity );
+	~vsFontLayoutCache();
+
+	// Returns the layout for 'key', or nullptr if we don't have it.  Counts as
+	// a hit or a miss.  The layout stays valid until the next Add() or Clear().
+	const vsFontLayout *	Find( const vsString &key );
+
+	// Takes ownership of 'layout', which must not already be cached.
+	void	Add( const vsString &key, vsFontLayout *layout );
+
+	void	Clear();
+	void	SetCapacity( int capacity );
+
+	Stats	GetStats() const;
+	void	ResetStats();
+};
+
+#endif // VS_FONTLAYOUTCACHE_H
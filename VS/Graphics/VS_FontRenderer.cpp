@@ -186,13 +186,23 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 	try
 	{
 		size_t stringLength = string.length();
-		float size = m_size;
 
 		if ( stringLength == 0 )
 			return;
 
-		size_t requiredSize = stringLength * 4;      // we need a maximum of four verts for each character in the string.
-		size_t requiredTriangles = stringLength * 6; // three indices per triangle, two triangles per character, max.
+		// figure out our wrapping, final render size, and where every glyph goes
+		const vsFontLayout *layout = GetLayout( context, string );
+		float size = layout->size;
+		float topLinePosition = layout->topLinePosition;
+		if ( ShouldSnap( context ) )
+		{
+			int positionInPixels = (int)(topLinePosition * m_size);
+			topLinePosition = positionInPixels / m_size;
+		}
+
+		size_t glyphCount = layout->glyph.ItemCount();
+		size_t requiredSize = glyphCount * 4;      // four verts for each glyph we draw.
+		size_t requiredTriangles = glyphCount * 6; // three indices per triangle, two triangles per glyph.
 
 		if ( m_hasDropShadow )
 		{
@@ -218,15 +228,6 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 		constructor.lineLastGlyph = nullptr;
 		constructor.lineCount = 0;
 
-		// figure out our wrapping and final render size
-		float topLinePosition;
-		WrapStringSizeTop(string, &size, &topLinePosition);
-		if ( ShouldSnap( context ) )
-		{
-			int positionInPixels = (int)(topLinePosition * m_size);
-			topLinePosition = positionInPixels / m_size;
-		}
-
 		vsVector2D size_vec(size, size);
 		if ( context == FontContext_3D )
 		{
@@ -235,12 +236,9 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 
 		if ( m_buildMapping )
 		{
-			for ( int i = 0; i < m_wrappedLine.ItemCount(); i++ )
-			{
-				ptrdiff_t glyphs = utf8::distance( m_wrappedLine[i].c_str(), m_wrappedLine[i].c_str() + m_wrappedLine[i].size() );
-				constructor.glyphCount += glyphs;
-			}
-			constructor.lineCount = m_wrappedLine.ItemCount();
+			for ( int i = 0; i < layout->line.ItemCount(); i++ )
+				constructor.glyphCount += layout->line[i].codepointCount;
+			constructor.lineCount = layout->line.ItemCount();
 			if ( constructor.glyphCount > 0 )
 			{
 				constructor.glyphBox = new vsBox2D[constructor.glyphCount];
@@ -251,12 +249,6 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 		}
 
 
-		vsVector2D baseOffset(0.f,topLinePosition);
-		vsVector2D offset(0.f,topLinePosition);
-		int nextGlyph = 0;
-		float lineHeight = 1.f;
-		float lineMargin = lineHeight * m_font->Size(size)->m_lineSpacing;
-
 		bool doSnap = ShouldSnap( context );
 		if ( doSnap )
 		{
@@ -271,28 +263,11 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 		{
 			// BLAH.  Seems like our x offset is in pixels, and our y offset is scaled by font size?
 			// That's terrible;  must fix!
-			offset = baseOffset;
-			for ( int i = 0; i < m_wrappedLine.ItemCount(); i++ )
-			{
-				offset.y = topLinePosition + (i*(lineHeight+lineMargin));
-
-				AppendStringToArrays( &constructor, context, m_wrappedLine[i].c_str(), size_vec, m_justification, offset, nextGlyph, i, true );
-
-				ptrdiff_t glyphsInThisLine = utf8::distance( m_wrappedLine[i].c_str(), m_wrappedLine[i].c_str() + m_wrappedLine[i].size() );
-				nextGlyph += (int)glyphsInThisLine;
-			}
-		}
-		offset = baseOffset;
-		nextGlyph = 0;
-		for ( int i = 0; i < m_wrappedLine.ItemCount(); i++ )
-		{
-			offset.y = topLinePosition + (i*(lineHeight+lineMargin));
-
-			AppendStringToArrays( &constructor, context, m_wrappedLine[i].c_str(), size_vec, m_justification, offset, nextGlyph, i, false );
-
-			ptrdiff_t glyphsInThisLine = utf8::distance( m_wrappedLine[i].c_str(), m_wrappedLine[i].c_str() + m_wrappedLine[i].size() );
-			nextGlyph += (int)glyphsInThisLine;
+			for ( int i = 0; i < layout->line.ItemCount(); i++ )
+				AppendStringToArrays( &constructor, layout, i, size_vec, topLinePosition, true );
 		}
+		for ( int i = 0; i < layout->line.ItemCount(); i++ )
+			AppendStringToArrays( &constructor, layout, i, size_vec, topLinePosition, false );
 
 		if ( constructor.ptIndex == 0 || constructor.tlIndex == 0 )
 		{
@@ -308,7 +283,7 @@ vsFontRenderer::CreateString_InFragment( FontContext context, vsFontFragment *fr
 		ptBuffer->SetArray( constructor.ptArray, constructor.ptIndex );
 		tlBuffer->SetArray( constructor.tlArray, constructor.tlIndex );
 
-		fragment->SetMaterial( m_font->Size(m_texSize)->m_material );
+		fragment->SetMaterial( layout->fontSize->m_material );
 		// fragment->AddBuffer( ptBuffer );
 		// fragment->AddBuffer( tlBuffer );
 
@@ -370,19 +345,14 @@ vsFontRenderer::CreateString_InDisplayList( FontContext context, vsDisplayList *
 		if ( doSnap )
 			list->SnapMatrix();
 
-		float size, topLinePosition;
-		WrapStringSizeTop(string, &size, &topLinePosition);
-
-		float lineHeight = 1.f;
-		float lineMargin = m_font->Size(size)->m_lineSpacing;
+		const vsFontLayout *layout = GetLayout( context, string );
+		vsVector2D offset(0.f,layout->topLinePosition);
 
-		vsVector2D offset(0.f,topLinePosition);
-
-		for ( int i = 0; i < m_wrappedLine.ItemCount(); i++ )
+		for ( int i = 0; i < layout->line.ItemCount(); i++ )
 		{
-			offset.y = topLinePosition + (i*(lineHeight+lineMargin));
+			offset.y = layout->topLinePosition + layout->line[i].y;
 			s_tempFontList.Clear();
-			BuildDisplayListGeometryFromString( context, &s_tempFontList, m_wrappedLine[i].c_str(), m_size, m_justification, offset );
+			BuildDisplayListGeometryFromString( context, &s_tempFontList, layout->line[i].text.c_str(), m_size, m_justification, offset );
 			list->Append(s_tempFontList);
 		}
 
@@ -470,6 +440,7 @@ vsFontRenderer::DisplayList2D( const vsString& string )
 	m_texSize = m_size;
 	vsDisplayList *loader = new vsDisplayList(1024 * 10);
 	CreateString_InDisplayList(FontContext_2D, loader, string);
+	loader->Optimise();
 
 	vsDisplayList *result = new vsDisplayList( loader->GetSize() );
 	result->Append(*loader);
@@ -484,6 +455,7 @@ vsFontRenderer::DisplayList3D( const vsString& string )
 	m_texSize = m_font->MaxSize();
 	vsDisplayList *loader = new vsDisplayList(1024 * 10);
 	CreateString_InDisplayList(FontContext_3D, loader, string);
+	loader->Optimise();
 
 	vsDisplayList *result = new vsDisplayList( loader->GetSize() );
 	result->Append(*loader);
@@ -498,6 +470,7 @@ vsFontRenderer::DisplayList2D( vsDisplayList *list, const vsString& string )
 	m_texSize = m_size;
 	vsDisplayList *loader = new vsDisplayList(1024 * 10);
 	CreateString_InDisplayList(FontContext_3D, loader, string);
+	loader->Optimise();
 
 	list->Append(*loader);
 	delete loader;
@@ -509,6 +482,7 @@ vsFontRenderer::DisplayList3D( vsDisplayList *list, const vsString& string )
 	m_texSize = m_font->MaxSize();
 	vsDisplayList *loader = new vsDisplayList(1024 * 10);
 	CreateString_InDisplayList(FontContext_3D, loader, string);
+	loader->Optimise();
 
 	list->Append(*loader);
 	delete loader;
@@ -525,19 +499,18 @@ vsFontRenderer::GetStringDimensions( const vsString& string )
 	loader->GetBoundingBox( topLeft, bottomRight );
 	return bottomRight - topLeft;
 #else
-	float size;
-	float topLinePosition;
-	WrapStringSizeTop(string, &size, &topLinePosition);
+	const vsFontLayout *layout = GetLayout( FontContext_2D, string );
+	float size = layout->size;
+	int lineCount = layout->line.ItemCount();
 
 	vsVector2D result;
-	for ( int i = 0; i < m_wrappedLine.ItemCount(); i++ )
+	for ( int i = 0; i < lineCount; i++ )
 	{
-		float width = m_font->Size(size)->GetStringWidth(m_wrappedLine[i], size);
-		result.x = vsMax( width, result.x );
+		result.x = vsMax( layout->line[i].width, result.x );
 	}
 	float lineHeight = 1.0;
 	float lineMargin = m_font->Size(size)->m_lineSpacing;
-	float totalScaledHeight = size * ((lineHeight * m_wrappedLine.ItemCount()) + (lineMargin * (m_wrappedLine.ItemCount()-1)));
+	float totalScaledHeight = size * ((lineHeight * lineCount) + (lineMargin * (lineCount-1)));
 	result.y = totalScaledHeight;
 	return result;
 #endif
@@ -546,10 +519,153 @@ vsFontRenderer::GetStringDimensions( const vsString& string )
 int
 vsFontRenderer::GetLineCount( const vsString& string )
 {
-	float size;
-	float topLinePosition;
-	WrapStringSizeTop(string, &size, &topLinePosition);
-	return m_wrappedLine.ItemCount();
+	return GetLayout( FontContext_2D, string )->line.ItemCount();
+}
+
+// Everything which changes how a string gets laid out, other than the string
+// itself.  Fonts each have their own cache, so the font isn't part of it.
+struct vsFontLayoutKey
+{
+	float		size;
+	float		sizeBias;
+	float		boundsX;
+	float		boundsY;
+	float		resolutionScale;
+	int32_t		justification;
+	int32_t		snap;
+};
+
+const vsFontLayout*
+vsFontRenderer::GetLayout( FontContext context, const vsString &string )
+{
+	vsFontLayoutKey header;
+	header.size = m_size;
+	header.sizeBias = m_sizeBias;
+	header.boundsX = m_bounds.x;
+	header.boundsY = m_bounds.y;
+	header.resolutionScale = m_font->GetResolutionScale();
+	header.justification = m_justification;
+	header.snap = ShouldSnap( context );
+
+	vsString key;
+	key.reserve( sizeof(header) + string.size() );
+	key.append( reinterpret_cast<const char*>(&header), sizeof(header) );
+	key.append( string );
+
+	vsFontLayoutCache &cache = m_font->GetLayoutCache();
+	const vsFontLayout *layout = cache.Find( key );
+	if ( !layout )
+	{
+		vsFontLayout *built = new vsFontLayout;
+		BuildLayout( context, string, built );
+		cache.Add( key, built );
+		layout = built;
+	}
+	m_texSize = layout->texSize;
+	return layout;
+}
+
+void
+vsFontRenderer::BuildLayout( FontContext context, const vsString &string, vsFontLayout *layout )
+{
+	WrapStringSizeTop( string, &layout->size, &layout->topLinePosition );
+	layout->texSize = m_texSize;
+	layout->fontSize = m_font->Size(m_texSize);
+
+	float size = layout->size;
+	vsFontSize *fontSize = layout->fontSize;
+	vsFontSize *wrapSize = m_font->Size(size);
+	float lineHeight = 1.f;
+	float lineMargin = lineHeight * wrapSize->m_lineSpacing;
+	JustificationType j = m_justification;
+	int nextCodepoint = 0;
+
+	layout->line.Reserve( m_wrappedLine.ItemCount() );
+	for ( int lineId = 0; lineId < m_wrappedLine.ItemCount(); lineId++ )
+	{
+		vsFontLayoutLine line;
+		line.text = m_wrappedLine[lineId];
+		line.y = lineId * (lineHeight+lineMargin);
+		line.width = wrapSize->GetStringWidth(line.text, size);
+		line.firstGlyph = layout->glyph.ItemCount();
+		line.glyphCount = 0;
+		line.firstCodepoint = nextCodepoint;
+
+		float x = 0.f;
+		if ( j != Justification_Left && j != Justification_TopLeft && j != Justification_BottomLeft )
+		{
+			float width = fontSize->GetStringWidth(line.text, size);
+
+			if ( j == Justification_Right || j == Justification_TopRight || j == Justification_BottomRight )
+				x = -width;
+			else if ( j == Justification_Center || j == Justification_TopCenter || j == Justification_BottomCenter )
+				x = -(width*0.5f);
+
+			if ( ShouldSnap( context ) )
+			{
+				// snap our offsets!
+				x = (float)(int)(x);
+			}
+
+			x *= (1.f / size);
+		}
+
+		const char* lineString = line.text.c_str();
+		const char* lineEnd = lineString + strlen(lineString);
+		size_t len = utf8::distance(lineString, lineEnd);
+		const char* w = lineString;
+
+		for ( size_t i = 0; i < len; i++ )
+		{
+			uint32_t cp = utf8::next(w, lineEnd);
+			vsGlyph *g;
+			if ( cp == '\r' )
+				continue;
+			else if ( cp == '\t' )
+				continue;
+			else if ( cp == 0x200b ) // zero-width space;  just ignore
+				continue;
+			else if ( cp == 0x00a0 ) // non-breaking space
+				g = fontSize->FindGlyphForCharacter( ' ' );
+			else
+				g = fontSize->FindGlyphForCharacter( cp );
+
+			if ( !g )
+			{
+				vsString glyph;
+				utf8::append( cp, back_inserter(glyph) );
+				vsLog("Missing character in font: %d (%s)", cp, glyph);
+
+				const char* missingGlyphString = u8"□";
+				g = fontSize->FindGlyphForCharacter(utf8::next(missingGlyphString, missingGlyphString + strlen(missingGlyphString)));
+
+				if ( !g )
+					g = fontSize->FindGlyphForCharacter( '?' );
+			}
+			if ( g )
+			{
+				vsFontLayoutGlyph placed;
+				placed.glyph = g;
+				placed.codepoint = cp;
+				placed.index = nextCodepoint + (int)i;
+				placed.x = x;
+				layout->glyph.AddItem( placed );
+				line.glyphCount++;
+
+				x += g->xAdvance;
+
+				if ( i < len-1 )
+				{
+					uint32_t ncp = utf8::peek_next(w, lineEnd);
+					x += fontSize->GetCharacterKerning( cp, ncp, 1.f );
+				}
+			}
+		}
+
+		line.codepointCount = (int)len;
+		nextCodepoint += (int)len;
+		layout->line.AddItem( line );
+	}
 }
 
 
@@ -616,39 +732,20 @@ vsFontRenderer::WrapLine(const vsString &string, float size)
 }
 
 void
-vsFontRenderer::AppendStringToArrays( vsFontRenderer::FragmentConstructor *constructor, FontContext context, const char* string, const vsVector2D &size, JustificationType j, const vsVector2D &offset_in, int nextGlyphId, int lineId, bool dropShadow)
+vsFontRenderer::AppendStringToArrays( vsFontRenderer::FragmentConstructor *constructor, const vsFontLayout *layout, int lineId, const vsVector2D &size, float topLinePosition, bool dropShadow)
 {
+	const vsFontLayoutLine &line = layout->line[lineId];
+	int nextGlyphId = line.firstCodepoint;
+
 	if ( m_buildMapping )
 	{
 		constructor->lineFirstGlyph[lineId] = nextGlyphId;
 	}
 
-	vsVector3D offset = offset_in;
+	vsVector3D offset( 0.f, topLinePosition + line.y, 0.f );
 	vsBox2D lineBox;
 	int glyphCount = 0;
 
-	if ( j != Justification_Left && j != Justification_TopLeft && j != Justification_BottomLeft )
-	{
-		s_tempFontList.Clear();
-
-		float width = m_font->Size(m_texSize)->GetStringWidth(string, size.x);
-
-		if ( j == Justification_Right || j == Justification_TopRight || j == Justification_BottomRight )
-			offset.x = -width;
-		else if ( j == Justification_Center || j == Justification_TopCenter || j == Justification_BottomCenter )
-			offset.x = -(width*0.5f);
-
-		if ( ShouldSnap( context ) )
-		{
-			// snap our offsets!
-			offset.x = (float)(int)(offset.x);
-		}
-
-		offset.x *= (1.f / size.x);
-
-		s_tempFontList.Clear();
-	}
-
 	if ( dropShadow )
 	{
 		offset.x += m_dropShadowOffset.x / size.x;
@@ -659,120 +756,82 @@ vsFontRenderer::AppendStringToArrays( vsFontRenderer::FragmentConstructor *const
 
 	uint16_t glyphIndices[6] = { 0, 2, 1, 1, 2, 3 };
 
-	size_t len = utf8::distance(string, string + strlen(string));
-	const char* w = string;
-	size_t startGlyphId = nextGlyphId;
-	size_t endGlyphId = nextGlyphId + len;
-	vsFontSize *fontSize = m_font->Size(m_texSize);
-	// float sizeScale = m_texSize / fontSize->GetNativeSize();
-
-	for ( size_t glyphId = startGlyphId; glyphId < endGlyphId; glyphId++ )
+	for ( int glyph = line.firstGlyph; glyph < line.firstGlyph + line.glyphCount; glyph++ )
 	{
-		uint32_t cp = utf8::next(w, string + strlen(string));
-		vsGlyph *g;
-		if ( cp == '\r' )
-			continue;
-		else if ( cp == '\t' )
-			continue;
-		else if ( cp == 0x200b ) // zero-width space;  just ignore
-			continue;
-		else if ( cp == 0x00a0 ) // non-breaking space
-			g = fontSize->FindGlyphForCharacter( ' ' );
-		else
-			g = fontSize->FindGlyphForCharacter( cp );
-
-		if ( !g )
-		{
-			vsString glyph;
-			utf8::append( cp, back_inserter(glyph) );
-			vsLog("Missing character in font: %d (%s)", cp, glyph);
+		const vsFontLayoutGlyph &placed = layout->glyph[glyph];
+		vsGlyph *g = placed.glyph;
+		uint32_t cp = placed.codepoint;
+		size_t glyphId = placed.index;
 
-			const char* missingGlyphString = u8"□";
-			g = fontSize->FindGlyphForCharacter(utf8::next(missingGlyphString, missingGlyphString + strlen(missingGlyphString)));
+		vsVector3D penPosition( offset.x + placed.x, offset.y, offset.z );
+		vsVector3D characterOffset = penPosition - g->baseline;
+		vsVector3D scaledPosition;
 
-			if ( !g )
-				g = fontSize->FindGlyphForCharacter( '?' );
-		}
-		if ( g )
-		{
-			vsVector3D characterOffset = offset - g->baseline;
-			vsVector3D scaledPosition;
+		// now, add our four verts and two triangles onto the arrays.
 
-			// now, add our four verts and two triangles onto the arrays.
 
+		for ( int i = 0; i < 4; i++ )
+		{
+			vsVector3D v = g->vertex[i];
+			vsColor color = c_white;
 
-			for ( int i = 0; i < 4; i++ )
+			if ( glyphId < (size_t)m_glyphTransform.ItemCount() )
 			{
-				vsVector3D v = g->vertex[i];
-				vsColor color = c_white;
-
-				if ( glyphId < (size_t)m_glyphTransform.ItemCount() )
-				{
-					// Now, I just so happen to know that vertices (0,1) are
-					// on the left and right sides of this quad.  And (1,2) are
-					// at the top and bottom.  So let's offset by half, before we
-					// transform the vertex, then offset back.
-					v.x -= (g->vertex[0].x + g->vertex[1].x) * 0.5f;
-					v.y -= (g->vertex[1].y + g->vertex[2].y) * 0.5f;
-					v = m_glyphTransform[glyphId].ApplyTo( v );
-					v.x += (g->vertex[0].x + g->vertex[1].x) * 0.5f;
-					v.y += (g->vertex[1].y + g->vertex[2].y) * 0.5f;
-				}
-				if ( glyphId < (size_t)m_glyphColor.ItemCount() )
-				{
-					color = m_glyphColor[glyphId];
-				}
-				if ( !dropShadow && m_hasColor )
-				{
-					color *= m_color;
-				}
-				if ( dropShadow )
-				{
-					color *= m_dropShadowColor;
-				}
-
-				scaledPosition = v + characterOffset;
-				scaledPosition.x *= size.x;
-				scaledPosition.y *= size.y;
-
-				vsVector3D transformedPosition = m_transform.ApplyTo(scaledPosition);
-
-				constructor->ptArray[ constructor->ptIndex+i ].position = transformedPosition;
-				constructor->ptArray[ constructor->ptIndex+i ].color = color;
-				constructor->ptArray[ constructor->ptIndex+i ].texel = g->texel[i];
-
-				if ( m_buildMapping )
-				{
-					vsVector2D mappingPosition = scaledPosition;
-					if ( cp == ' ' && i == 1) // let's map spaces better
-					{
-						mappingPosition.x += g->xAdvance * size.x;
-					}
-					constructor->glyphBox[nextGlyphId].ExpandToInclude(mappingPosition);
-					lineBox.ExpandToInclude(mappingPosition);
-				}
+				// Now, I just so happen to know that vertices (0,1) are
+				// on the left and right sides of this quad.  And (1,2) are
+				// at the top and bottom.  So let's offset by half, before we
+				// transform the vertex, then offset back.
+				v.x -= (g->vertex[0].x + g->vertex[1].x) * 0.5f;
+				v.y -= (g->vertex[1].y + g->vertex[2].y) * 0.5f;
+				v = m_glyphTransform[glyphId].ApplyTo( v );
+				v.x += (g->vertex[0].x + g->vertex[1].x) * 0.5f;
+				v.y += (g->vertex[1].y + g->vertex[2].y) * 0.5f;
 			}
-
-			for ( int i = 0; i < 6; i++ )
+			if ( glyphId < (size_t)m_glyphColor.ItemCount() )
+			{
+				color = m_glyphColor[glyphId];
+			}
+			if ( !dropShadow && m_hasColor )
+			{
+				color *= m_color;
+			}
+			if ( dropShadow )
 			{
-				constructor->tlArray[ constructor->tlIndex+i ] = constructor->ptIndex + glyphIndices[i];
+				color *= m_dropShadowColor;
 			}
 
-			constructor->ptIndex += 4;
-			constructor->tlIndex += 6;
+			scaledPosition = v + characterOffset;
+			scaledPosition.x *= size.x;
+			scaledPosition.y *= size.y;
 
-			offset.x += g->xAdvance;
+			vsVector3D transformedPosition = m_transform.ApplyTo(scaledPosition);
 
-			if ( glyphId < endGlyphId-1 )
+			constructor->ptArray[ constructor->ptIndex+i ].position = transformedPosition;
+			constructor->ptArray[ constructor->ptIndex+i ].color = color;
+			constructor->ptArray[ constructor->ptIndex+i ].texel = g->texel[i];
+
+			if ( m_buildMapping )
 			{
-				const char* stringEnd = string + strlen(string);
-				uint32_t ncp = utf8::peek_next(w, stringEnd);
-				offset.x += fontSize->GetCharacterKerning( cp, ncp, 1.f );
+				vsVector2D mappingPosition = scaledPosition;
+				if ( cp == ' ' && i == 1) // let's map spaces better
+				{
+					mappingPosition.x += g->xAdvance * size.x;
+				}
+				constructor->glyphBox[nextGlyphId].ExpandToInclude(mappingPosition);
+				lineBox.ExpandToInclude(mappingPosition);
 			}
+		}
 
-			nextGlyphId++;
-			glyphCount++;
+		for ( int i = 0; i < 6; i++ )
+		{
+			constructor->tlArray[ constructor->tlIndex+i ] = constructor->ptIndex + glyphIndices[i];
 		}
+
+		constructor->ptIndex += 4;
+		constructor->tlIndex += 6;
+
+		nextGlyphId++;
+		glyphCount++;
 	}
 
 	if ( m_buildMapping )
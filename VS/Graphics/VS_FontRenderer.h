@@ -63,10 +63,17 @@ class vsFontRenderer
 
 	void		WrapStringSizeTop(const vsString &string, float *size_out, float *top_out);
 	void		WrapLine(const vsString &string, float size);
+
+	// Wrapping, sizing and shaping a string are cached in our font's
+	// vsFontLayoutCache, keyed on our settings which affect them.  GetLayout()
+	// also sets m_texSize from the layout.
+	const vsFontLayout*	GetLayout( FontContext context, const vsString &string );
+	void		BuildLayout( FontContext context, const vsString &string, vsFontLayout *layout );
+
 	// vsFragment* CreateString_Fragment( FontContext context, const vsString& string );
 	void		CreateString_InFragment( FontContext context, vsFontFragment *fragment, const vsString& string );
 	void		CreateString_InDisplayList( FontContext context, vsDisplayList *list, const vsString &string );
-	void		AppendStringToArrays( vsFontRenderer::FragmentConstructor *constructor, FontContext context, const char* string, const vsVector2D &size, JustificationType type, const vsVector2D &offset, int nextGlyphId, int lineId, bool dropShadow);
+	void		AppendStringToArrays( vsFontRenderer::FragmentConstructor *constructor, const vsFontLayout *layout, int lineId, const vsVector2D &size, float topLinePosition, bool dropShadow);
 	void		BuildDisplayListGeometryFromString( FontContext context, vsDisplayList * list, const char* string, float size, JustificationType type, const vsVector2D &offset);
 
 	bool		ShouldSnap( FontContext context );
@@ -334,6 +334,7 @@ vsFragment::Load( vsRecord *record )
 				}
 			}
 
+			loader->Optimise();
 			vsDisplayList *list = new vsDisplayList( loader->GetSize() );
 			list->Append(*loader);
 			vsDelete(loader);
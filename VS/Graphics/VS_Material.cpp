@@ -14,6 +14,7 @@
 #include "VS_Texture.h"
 #include "VS_OpenGL.h"
 #include "VS_Profile.h"
+#include "VS_Renderer.h"
 
 vsMaterial *vsMaterial::White = nullptr;
 
@@ -39,17 +40,22 @@ vsMaterial::vsMaterial( const vsMaterial &other ):
 
 vsMaterial::~vsMaterial()
 {
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 void
 vsMaterial::SetupParameters()
 {
-	// Do some generic setup.
-	SetUniformF( "alphaRef", GetResource()->m_alphaRef );
-	SetUniformB( "fog", GetResource()->m_fog );
-	BindUniformB( "glow", &GetResource()->m_glow );
-	BindUniformF( "glowFactor", &GetResource()->m_glowFactor );
-	m_values.SetParent( GetResource()->GetShaderValues() );
+	// Do some generic setup.  We take these from our batch material (which
+	// matches ours in all these settings), so that materials which batch
+	// together also have matching shader values.
+	vsMaterialInternal *resource = GetResource()->GetBatchMaterial();
+	SetUniformF( "alphaRef", resource->m_alphaRef );
+	SetUniformB( "fog", resource->m_fog );
+	BindUniformB( "glow", &resource->m_glow );
+	BindUniformF( "glowFactor", &resource->m_glowFactor );
+	m_values.SetParent( resource->GetShaderValues() );
 }
 
 // int32_t
@@ -297,7 +303,7 @@ vsMaterial::MatchesForBatching( vsMaterial *other ) const
 {
 	PROFILE("vsMaterial::MatchesForBatching");
 
-	if ( GetResource() != other->GetResource() )
+	if ( GetResource()->GetBatchMaterial() != other->GetResource()->GetBatchMaterial() )
 		return false;
 
 	if ( m_values != other->m_values )
@@ -89,6 +89,10 @@ public:
 
 	bool MatchesForBatching( vsMaterial *other ) const;
 
+	// Geometry using this material should pass its texels through here, in
+	// case our texture has been packed into a vsTextureAtlas.
+	vsVector2D MapTexel( const vsVector2D &texel ) const { return GetResource()->MapTexel( texel ); }
+
 	vsShaderValues* GetShaderValues() { return &m_values; }
 	vsShaderOptions* GetShaderOptions() { return &m_options; }
 
@@ -14,12 +14,13 @@
 #include "VS_Shader.h"
 #include "VS_ShaderRef.h"
 #include "VS_ShaderCache.h"
+#include "VS_TextureAtlas.h"
 
 #include "VS_File.h"
 #include "VS_Record.h"
 #include "VS_Token.h"
 
-#include "VS_Renderer_OpenGL3.h"
+#include "VS_Renderer.h"
 
 #include <atomic>
 
@@ -44,6 +45,7 @@ static const vsString s_cullString[CULL_MAX] =
 };
 
 static std::atomic<int>	s_codeMaterialCount( 0 );
+static std::atomic<int>	s_nextMaterialId( 0 );
 vsMaterialInternal::vsMaterialInternal():
 	vsResource(vsFormatString("CodeMaterial%02d", s_codeMaterialCount++)),
 	m_textureCount(0),
@@ -73,7 +75,10 @@ vsMaterialInternal::vsMaterialInternal():
 	m_hasColor(true),
 	m_blend(true),
 	m_shaderIsMine(false),
-	m_flags(0)
+	m_flags(0),
+	m_id(s_nextMaterialId++),
+	m_atlasRegion(nullptr),
+	m_batchMaterial(nullptr)
 {
 	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
 	{
@@ -112,7 +117,10 @@ vsMaterialInternal::vsMaterialInternal( const vsString &name ):
 	m_hasColor(true),
 	m_blend(true),
 	m_shaderIsMine(false),
-	m_flags(0)
+	m_flags(0),
+	m_id(s_nextMaterialId++),
+	m_atlasRegion(nullptr),
+	m_batchMaterial(nullptr)
 {
 	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
 	{
@@ -132,6 +140,9 @@ vsMaterialInternal::vsMaterialInternal( const vsString &name ):
 		vsAssert(vsFile::Exists(fileName), vsFormatString("Requested material file doesn't exist: %s", fileName.c_str()));
 	}
 	SetShader();
+
+	if ( m_atlasRegion )
+		m_batchMaterial = vsTextureAtlas::Instance()->GetBatchMaterial( this );
 }
 
 vsMaterialInternal::~vsMaterialInternal()
@@ -152,6 +163,10 @@ vsMaterialInternal::Reload()
 	{
 		vsFile materialFile(fileName);
 		LoadFromFile( &materialFile );
+
+		m_batchMaterial = nullptr;
+		if ( m_atlasRegion )
+			m_batchMaterial = vsTextureAtlas::Instance()->GetBatchMaterial( this );
 	}
 	else
 	{
@@ -173,11 +188,21 @@ vsMaterialInternal::LoadFromFile( vsFile *materialFile )
 			vsDelete( m_texture[i] );
 	}
 	m_textureCount = 0;
+	m_atlasRegion = nullptr;
 
 	while( materialFile->Record(&r) )
 	{
 		if ( r.GetLabel().AsString() == "Material" )
 		{
+			// 'atlas' changes how we load our texture, so look for it before
+			// we get to the texture, wherever it is in the file.
+			bool atlas = false;
+			for ( int i = 0; i < r.GetChildCount(); i++ )
+			{
+				if ( r.GetChild(i)->GetLabel().AsString() == "atlas" )
+					atlas = r.GetChild(i)->Bool();
+			}
+
 			for ( int i = 0; i < r.GetChildCount(); i++ )
 			{
 				vsRecord *sr = r.GetChild(i);
@@ -279,7 +304,13 @@ vsMaterialInternal::LoadFromFile( vsFile *materialFile )
 				{
 					vsAssert( sr->GetTokenCount() >= 1, "Texture directive with more than one token??" );
 					vsString textureString = sr->String();
-					m_texture[m_textureCount] = new vsTexture( textureString );
+					if ( atlas && m_textureCount == 0 && vsTextureAtlas::Instance() )
+						m_atlasRegion = vsTextureAtlas::Instance()->Add( textureString );
+
+					if ( m_atlasRegion && m_textureCount == 0 )
+						m_texture[m_textureCount] = new vsTexture( *m_atlasRegion->texture );
+					else
+						m_texture[m_textureCount] = new vsTexture( textureString );
 					m_textureFromFile[m_textureCount] = true;
 
 					if ( sr->GetTokenCount() > 1 )
@@ -384,7 +415,7 @@ vsMaterialInternal::SetShader()
 {
 	if (!m_shader && !m_shaderRef )
 	{
-		m_shader = vsRenderer_OpenGL3::Instance()->DefaultShaderFor(this);
+		m_shader = vsRenderer::Instance()->DefaultShaderFor(this);
 		m_shaderIsMine = false;
 	}
 }
@@ -397,6 +428,59 @@ vsMaterialInternal::HasAnyTextures() const
 	return false;
 }
 
+bool
+vsMaterialInternal::MatchesForBatching( const vsMaterialInternal &other ) const
+{
+	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
+	{
+		if ( (m_texture[i] == nullptr) != (other.m_texture[i] == nullptr) )
+			return false;
+		if ( m_texture[i] && !m_texture[i]->MatchesForBatching( *other.m_texture[i] ) )
+			return false;
+	}
+
+	return m_shader == other.m_shader &&
+		m_color == other.m_color &&
+		m_specularColor == other.m_specularColor &&
+		m_drawMode == other.m_drawMode &&
+		m_cullingType == other.m_cullingType &&
+		m_alphaRef == other.m_alphaRef &&
+		m_depthBiasConstant == other.m_depthBiasConstant &&
+		m_depthBiasFactor == other.m_depthBiasFactor &&
+		m_glowFactor == other.m_glowFactor &&
+		m_layer == other.m_layer &&
+		m_stencilOp == other.m_stencilOp &&
+		m_stencilRead == other.m_stencilRead &&
+		m_stencilWrite == other.m_stencilWrite &&
+		m_alphaTest == other.m_alphaTest &&
+		m_fog == other.m_fog &&
+		m_zRead == other.m_zRead &&
+		m_zWrite == other.m_zWrite &&
+		m_zSort == other.m_zSort &&
+		m_glow == other.m_glow &&
+		m_preGlow == other.m_preGlow &&
+		m_postGlow == other.m_postGlow &&
+		m_postGeneric == other.m_postGeneric &&
+		m_hasColor == other.m_hasColor &&
+		m_blend == other.m_blend &&
+		m_flags == other.m_flags &&
+		m_values == other.m_values;
+}
+
+vsVector2D
+vsMaterialInternal::MapTexel( const vsVector2D &texel ) const
+{
+	if ( m_atlasRegion )
+	{
+		const float epsilon = 0.0001f;
+		vsAssert( texel.x >= -epsilon && texel.x <= 1.f + epsilon && texel.y >= -epsilon && texel.y <= 1.f + epsilon,
+				vsFormatString( "Material '%s' is atlased, but is being drawn with texel (%f,%f), outside [0..1].  Atlased materials can't tile!",
+					GetName().c_str(), texel.x, texel.y ) );
+		return m_atlasRegion->Map( texel );
+	}
+	return texel;
+}
+
 void
 vsMaterialInternal::SetTexture(int i, vsTexture *texture)
 {
@@ -57,6 +57,7 @@ enum vsDrawMode
 class vsFile;
 class vsShader;
 class vsShaderRef;
+struct vsAtlasRegion;
 
 #include "VS/Graphics/VS_ShaderValues.h"
 
@@ -119,6 +120,12 @@ public:
 	bool		m_shaderIsMine;						// if true, we own this shader and must destroy it.
 
 	int			m_flags;
+	int			m_id;		// unique per material;  used as a stable tie-breaker when sorting batches
+
+	// If we were loaded with 'atlas true', our first texture is a page of the
+	// vsTextureAtlas, and this is where our image is on it.
+	const vsAtlasRegion *m_atlasRegion;
+	vsMaterialInternal *m_batchMaterial;	// the material we batch as;  nullptr for ourself
 
 	vsMaterialInternal(); // no material name;  we'll create our own name instead.
 	vsMaterialInternal( const vsString & name ); // for loading this material from a file
@@ -135,6 +142,13 @@ public:
 	vsTexture *	GetBufferTexture() const { return GetTexture(9); }
 	bool HasAnyTextures() const;
 
+	// The render queue puts everything with the same batch material into
+	// the same batch.  Materials atlased onto the same page with otherwise
+	// identical settings share a batch material.  (See vsTextureAtlas)
+	vsMaterialInternal *	GetBatchMaterial() { return m_batchMaterial ? m_batchMaterial : this; }
+	bool		MatchesForBatching( const vsMaterialInternal &other ) const; // true if we match in everything but name
+	vsVector2D	MapTexel( const vsVector2D &texel ) const; // moves a texel on our image onto our atlas page, if we have one
+
 	void SetTexture(int i, vsTexture *texture); // we'll take a copy of this texture;  caller must dispose of their own copy
 
 	void operator=(const vsMaterialInternal &b);
@@ -19,6 +19,9 @@
 #include "VS_Record.h"
 #include "VS_Serialiser.h"
 #include "VS_Store.h"
+#include "VS/Math/VS_TriangleBVH.h"
+
+#include "VS_Profile.h"
 
 
 vsModel *
@@ -308,9 +311,8 @@ vsModel::LoadBinary( const vsString &filename )
 {
 	vsModel *result = nullptr;
 
-	vsFile file(filename);
-	vsStore store(file.GetLength());
-	file.Store(&store);
+	vsFile file(filename, vsFile::MODE_ReadMapped);
+	vsStore store( const_cast<char*>(file.GetContents()), file.GetLength() );
 	vsSerialiserRead r(&store);
 
 	result = LoadModel_Internal(r);
@@ -324,6 +326,7 @@ vsModel::LoadText( const vsString &filename )
 {
 	vsFile file(filename);
 	vsRecord r;
+	r.SetArenaMode(true);
 
 	while( file.Record(&r) )
 	{
@@ -416,6 +419,7 @@ vsModel::vsModel( vsDisplayList *list ):
 	m_boundingRadius(0.f),
 	m_lodLevel(0),
 	m_instanceGroup(nullptr),
+	m_collision(nullptr),
 	m_displayList(list)
 {
 	SetLodCount(1);
@@ -430,6 +434,7 @@ vsModel::~vsModel()
 		vsDelete(m_displayList);
 	vsDelete( m_material );
 	vsDelete( m_instanceGroup );
+	InvalidateCollision();
 }
 
 void
@@ -449,6 +454,7 @@ vsModel::SetDisplayList( vsDisplayList *list )
 	m_displayList = list;
 
 	BuildBoundingBox();
+	InvalidateCollision();
 }
 
 void
@@ -456,7 +462,11 @@ vsModel::AddLodFragment( int lodLevel, vsFragment *fragment )
 {
 	vsAssert((int)lodLevel < m_lod.ItemCount(), "Tried to add a fragment to a non-existant lod??");
 	if ( fragment )
+	{
 		m_lod[lodLevel]->fragment.AddItem( fragment );
+		if ( lodLevel == 0 )
+			InvalidateCollision();
+	}
 }
 
 void
@@ -464,12 +474,14 @@ vsModel::DestroyFragment( vsFragment *fragment )
 {
 	for ( int i = 0; i < m_lod.ItemCount(); i++ )
 		m_lod[i]->fragment.RemoveItem( fragment );
+	InvalidateCollision();
 }
 
 void
 vsModel::ClearFragments()
 {
 	m_lod[0]->fragment.Clear();
+	InvalidateCollision();
 }
 
 void
@@ -683,46 +695,110 @@ vsModel::GetLodFragmentCount( int lodId ) const
 	return m_lod[lodId]->fragment.ItemCount();
 }
 
+void
+vsModel::InvalidateCollision()
+{
+	vsTriangleBVH *collision = m_collision.exchange( nullptr );
+	vsDelete( collision );
+}
+
+const vsTriangleBVH *
+vsModel::GetCollision() const
+{
+	vsTriangleBVH *collision = m_collision.load( std::memory_order_acquire );
+	if ( !collision )
+	{
+		PROFILE("vsModel::BuildCollision");
+		vsArray<vsDisplayList::Triangle> triangles;
+		if ( m_displayList )
+			m_displayList->GetTriangles(triangles);
+		for ( int i = 0; i < GetFragmentCount(); i++ )
+		{
+			m_lod[0]->fragment[i]->GetTriangles(triangles);
+		}
+
+		static_assert( sizeof(vsDisplayList::Triangle) == sizeof(vsVector3D) * 3, "Triangles must be tightly packed vertices" );
+		vsTriangleBVH *built = new vsTriangleBVH;
+		if ( !triangles.IsEmpty() )
+			built->Build( &triangles[0].vertex[0], triangles.ItemCount() );
+
+		// Several threads may have made their first query at once, and all
+		// built a hierarchy.  Only the first to finish publishes theirs;  the
+		// rest throw their copies away and use that one.
+		if ( m_collision.compare_exchange_strong( collision, built, std::memory_order_acq_rel, std::memory_order_acquire ) )
+			collision = built;
+		else
+			vsDelete( built );
+	}
+	return collision;
+}
+
 bool
 vsModel::CollideRay(vsVector3D *result, vsVector3D *resultNormal, float *resultT, const vsVector3D &pos, const vsVector3D &dir) const
 {
-	vsVector3D localPos = m_transform.ApplyInverseTo(pos);
-	vsVector3D localDir = m_transform.GetRotation().Inverse().ApplyTo(dir);
+	vsTriangleBVH::Ray ray;
+	ray.pos = m_transform.ApplyInverseTo(pos);
+	ray.dir = m_transform.GetRotation().Inverse().ApplyTo(dir);
+	ray.maxT = *resultT;
+
+	vsTriangleBVH::Hit hit;
+	const vsTriangleBVH *collision = GetCollision();
+	if ( !collision->CollideRay( ray, &hit ) )
+		return false;
+
+	*result = pos + dir * (hit.t);
+	*resultT = hit.t;
+	*resultNormal = m_transform.GetRotation().ApplyTo( collision->GetTriangleNormal( hit.triangle, ray.dir ) );
+	return true;
+}
 
-	// now we need to collision test against all our triangles.
-	vsArray<vsDisplayList::Triangle> triangles;
-	if ( m_displayList )
-		m_displayList->GetTriangles(triangles);
-	for ( int i = 0; i < GetFragmentCount(); i++ )
+bool
+vsModel::CollideRayAny(const vsVector3D &pos, const vsVector3D &dir, float maxT) const
+{
+	vsTriangleBVH::Ray ray;
+	ray.pos = m_transform.ApplyInverseTo(pos);
+	ray.dir = m_transform.GetRotation().Inverse().ApplyTo(dir);
+	ray.maxT = maxT;
+
+	return GetCollision()->CollideRayAny( ray );
+}
+
+int
+vsModel::CollideRays(vsVector3D *result, vsVector3D *resultNormal, float *resultT, bool *hit, const vsVector3D *pos, const vsVector3D *dir, int count) const
+{
+	if ( count <= 0 )
+		return 0;
+
+	const vsTriangleBVH *collision = GetCollision();
+	vsQuaternion inverseRotation = m_transform.GetRotation().Inverse();
+
+	vsArray<vsTriangleBVH::Ray> ray;
+	vsArray<vsTriangleBVH::Hit> rayHit;
+	ray.SetArraySize( count );
+	rayHit.SetArraySize( count );
+	for ( int i = 0; i < count; i++ )
 	{
-		m_lod[0]->fragment[i]->GetTriangles(triangles);
+		ray[i].pos = m_transform.ApplyInverseTo(pos[i]);
+		ray[i].dir = inverseRotation.ApplyTo(dir[i]);
+		ray[i].maxT = resultT[i];
 	}
 
-	bool hit = false;
-	for ( int i = 0; i < triangles.ItemCount(); i++ )
+	int hitCount = collision->CollideRays( &ray[0], &rayHit[0], count );
+
+	for ( int i = 0; i < count; i++ )
 	{
-		float u, v;
-		vsDisplayList::Triangle &t = triangles[i];
-		float localT;
-		if ( vsCollideRayVsTriangle( localPos, localDir,
-					t.vertex[0], t.vertex[1], t.vertex[2],
-					&localT, &u, &v ) )
-		{
-			if ( localT < *resultT )
-			{
-				hit = true;
-				*result = pos + dir * (localT);
-				*resultT = localT;
-
-				vsVector3D triangleNormal = (t.vertex[2]-t.vertex[0]).Cross( t.vertex[1]-t.vertex[0] );
-				triangleNormal.NormaliseSafe();
-				if ( triangleNormal.Dot( localDir ) > 0.f ) // reversed!  (is this the right thing to do if we're hitting the back of a triangle?
-					triangleNormal *= -1.f;
-				*resultNormal = m_transform.GetRotation().ApplyTo( triangleNormal );
-			}
+		const vsTriangleBVH::Hit &h = rayHit[i];
+		bool didHit = ( h.triangle >= 0 );
+		if ( hit )
+			hit[i] = didHit;
+		if ( didHit )
+		{
+			result[i] = pos[i] + dir[i] * (h.t);
+			resultT[i] = h.t;
+			resultNormal[i] = m_transform.GetRotation().ApplyTo( collision->GetTriangleNormal( h.triangle, ray[i].dir ) );
 		}
 	}
-	return hit;
+	return hitCount;
 }
 
 void
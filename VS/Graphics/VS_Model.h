@@ -19,11 +19,13 @@
 #include "VS/Math/VS_Transform.h"
 #include "VS/Utils/VS_Array.h"
 #include "VS/Utils/VS_ArrayStore.h"
+#include <atomic>
 
 class vsModel;
 struct vsModelInstance;
 class vsModelInstanceGroup;
 class vsSerialiserRead;
+class vsTriangleBVH;
 class vsVertexArrayObject;
 
 struct vsLod
@@ -48,6 +50,10 @@ class vsModel : public vsEntity
 	vsArrayStore<vsLod> m_lod; // new-new-style rendering.
 	int m_lodLevel; // which lod am I rendering right now?  0 == 'm_fragment'.
 	vsModelInstanceGroup *m_instanceGroup;
+
+	mutable std::atomic<vsTriangleBVH*> m_collision; // built on the first ray query, thrown away when our geometry changes
+
+	const vsTriangleBVH *	GetCollision() const;
 protected:
 
 	vsDisplayList	*m_displayList;				// old-style rendering
@@ -129,7 +135,21 @@ public:
 
 	void	DrawInstanced( vsRenderQueue *list, vsVertexArrayObject* vao, vsRenderBuffer* matrixBuffer, vsRenderBuffer* colorBuffer, vsShaderValues *values, vsShaderOptions *options, int lodLevel );
 
+	// Ray queries run against a bounding volume hierarchy over our display
+	// list and lod 0 fragments, which is built on first use.  Any number of
+	// threads may query at once, including the first query.  (Changing our
+	// geometry while other threads are querying is not safe.)  If you modify
+	// a fragment's geometry in place, call InvalidateCollision() so the
+	// hierarchy gets rebuilt.
 	bool		CollideRay(vsVector3D *result, vsVector3D *resultNormal, float *resultT, const vsVector3D &pos, const vsVector3D &dir) const;
+	bool		CollideRayAny(const vsVector3D &pos, const vsVector3D &dir, float maxT) const; // true if anything blocks the ray before 'maxT'
+
+	// Batched CollideRay().  For each ray, 'resultT' is both the maximum
+	// distance in and the hit distance out.  Returns the number of hits;
+	// 'hit' (if passed) is set per ray.
+	int			CollideRays(vsVector3D *result, vsVector3D *resultNormal, float *resultT, bool *hit, const vsVector3D *pos, const vsVector3D *dir, int count) const;
+
+	void		InvalidateCollision();
 
 	void SaveOBJ( const vsString& filename );
 	void SaveBinary( const vsString &filename );
@@ -11,6 +11,13 @@
 #include "VS_ModelInstance.h"
 #include "VS_Model.h"
 #include "VS_VertexArrayObject.h"
+#include "VS_Camera.h"
+#include "VS_RenderQueue.h"
+#include "VS_Scene.h"
+#include "VS_FrameArena.h"
+#include "VS/Threads/VS_JobSystem.h"
+
+#include "VS_Profile.h"
 
 vsModelInstanceLodGroup::vsModelInstanceLodGroup( vsModelInstanceGroup *group, vsModel *model, size_t lodLevel ):
 	m_group(group),
@@ -18,7 +25,11 @@ vsModelInstanceLodGroup::vsModelInstanceLodGroup( vsModelInstanceGroup *group, v
 	m_lodLevel(lodLevel),
 	// m_vao(nullptr),
 	m_values(nullptr),
-	m_options(nullptr)
+	m_options(nullptr),
+	m_drawMatrix(nullptr),
+	m_drawColor(nullptr),
+	m_drawCount(0),
+	m_culled(false)
 #ifdef INSTANCED_MODEL_USES_LOCAL_BUFFER
 	,
 	m_matrixBuffer(vsRenderBuffer::Type_Dynamic),
@@ -72,6 +83,11 @@ vsModelInstanceLodGroup::UpdateInstance( vsModelInstance *inst, bool show )
 			m_matrix.AddItem( inst->matrix );
 			m_color.AddItem( inst->color );
 			m_matrixInstanceId.AddItem( inst->index );
+			m_boundX.AddItem( 0.f );
+			m_boundY.AddItem( 0.f );
+			m_boundZ.AddItem( 0.f );
+			m_boundRadius.AddItem( 0.f );
+			SetBounds( inst->matrixIndex, inst->matrix );
 #ifdef INSTANCED_MODEL_USES_LOCAL_BUFFER
 			m_bufferIsDirty = true;
 #endif
@@ -80,6 +96,7 @@ vsModelInstanceLodGroup::UpdateInstance( vsModelInstance *inst, bool show )
 		{
 			m_matrix[inst->matrixIndex] = inst->matrix;
 			m_color[inst->matrixIndex] = inst->color;
+			SetBounds( inst->matrixIndex, inst->matrix );
 #ifdef INSTANCED_MODEL_USES_LOCAL_BUFFER
 			m_bufferIsDirty = true;
 #endif
@@ -99,11 +116,19 @@ vsModelInstanceLodGroup::UpdateInstance( vsModelInstance *inst, bool show )
 			m_matrix[swapTo] = m_matrix[swapFrom];
 			m_color[swapTo] = m_color[swapFrom];
 			m_matrixInstanceId[swapTo] = m_matrixInstanceId[swapFrom];
+			m_boundX[swapTo] = m_boundX[swapFrom];
+			m_boundY[swapTo] = m_boundY[swapFrom];
+			m_boundZ[swapTo] = m_boundZ[swapFrom];
+			m_boundRadius[swapTo] = m_boundRadius[swapFrom];
 			swapper->matrixIndex = swapTo;
 		}
 		m_matrix.PopBack();
 		m_color.PopBack();
 		m_matrixInstanceId.PopBack();
+		m_boundX.PopBack();
+		m_boundY.PopBack();
+		m_boundZ.PopBack();
+		m_boundRadius.PopBack();
 		inst->matrixIndex = -1;
 #ifdef INSTANCED_MODEL_USES_LOCAL_BUFFER
 		m_bufferIsDirty = true;
@@ -111,6 +136,21 @@ vsModelInstanceLodGroup::UpdateInstance( vsModelInstance *inst, bool show )
 	}
 }
 
+void
+vsModelInstanceLodGroup::SetBounds( int matrixIndex, const vsMatrix4x4 &matrix )
+{
+	// Our model's bounding box as a sphere, scaled up by the longest of the
+	// matrix's axes.
+	const vsBox3D &box = m_model->GetBoundingBox();
+	vsVector3D center = matrix.ApplyTo( box.Middle() );
+	float sqScale = vsMax( vsVector3D(matrix.x).SqLength(), vsMax( vsVector3D(matrix.y).SqLength(), vsVector3D(matrix.z).SqLength() ) );
+
+	m_boundX[matrixIndex] = center.x;
+	m_boundY[matrixIndex] = center.y;
+	m_boundZ[matrixIndex] = center.z;
+	m_boundRadius[matrixIndex] = box.Extents().Length() * 0.5f * vsSqrt( sqScale );
+}
+
 void
 vsModelInstanceLodGroup::AddInstance( vsModelInstance *inst )
 {
@@ -187,6 +227,17 @@ vsModelInstanceLodGroup::RemoveInstance( vsModelInstance *inst )
 void
 vsModelInstanceLodGroup::Draw( vsRenderQueue *queue )
 {
+	// If our group culled us this frame, draw just the instances which
+	// survived that, instead of everything which is shown.  Those live in
+	// this frame's arena, so unlike our render buffers, they're still intact
+	// when the display list gets around to reading them.
+	if ( m_culled )
+	{
+		if ( m_drawCount > 0 )
+			m_model->DrawInstanced( queue, m_drawMatrix, m_drawColor, m_drawCount, m_values, m_options, m_lodLevel );
+		return;
+	}
+
 	if ( m_matrix.IsEmpty() )
 		return;
 
@@ -220,14 +271,16 @@ void
 vsModelInstanceLodGroup::CalculateBounds( vsBox3D& out )
 {
 	vsBox3D box = GetModel()->GetBoundingBox();
+	vsVector3D corner[8];
+	vsVector3D pos[8];
+	for ( int c = 0; c < 8; c++ )
+		corner[c] = box.Corner(c);
+
 	out.Clear();
 	for ( int i = 0; i < m_instance.ItemCount(); i++ )
 	{
-		for ( int c = 0; c < 8; c++ )
-		{
-			vsVector3D pos = m_instance[i]->matrix.ApplyTo( box.Corner(c) );
-			out.ExpandToInclude( pos );
-		}
+		m_instance[i]->matrix.ApplyTo( corner, pos, 8 );
+		out.ExpandToInclude( pos, 8 );
 	}
 	// for ( int i = 0; i < m_matrix.ItemCount(); i++ )
 	// {
@@ -241,7 +294,8 @@ vsModelInstanceLodGroup::CalculateBounds( vsBox3D& out )
 
 vsModelInstanceGroup::vsModelInstanceGroup( vsModel *model ):
 	m_model( model ),
-	m_lod( model->GetLodCount() )
+	m_lod( model->GetLodCount() ),
+	m_frustumCulling( false )
 {
 	for ( int i = 0; i < model->GetLodCount(); i++ )
 	{
@@ -374,12 +428,234 @@ vsModelInstanceGroup::CalculateBounds( vsBox3D& out )
 	}
 }
 
+void
+vsModelInstanceGroup::SetLodScreenSizes( const float *screenSize, int count )
+{
+	vsAssert( count < m_lod.ItemCount(), "More lod screen sizes than we have lods?" );
+	vsAssert( count <= c_maxLodScreenSizes, "Too many lod screen sizes" );
+	m_lodScreenSize.Clear();
+	for ( int i = 0; i < count; i++ )
+	{
+		vsAssert( i == 0 || screenSize[i] <= screenSize[i-1], "Lod screen sizes must be in decreasing order" );
+		m_lodScreenSize.AddItem( screenSize[i] );
+	}
+}
+
+struct vsModelInstanceGroup::CullParams
+{
+	const vsFrustum *frustum;	// null if we're not frustum culling
+
+	bool autoLod;
+	float eyeX, eyeY, eyeZ;
+	float sizeScale;		// squared screen height per unit of (radius squared / distance squared)
+	float distanceWeight;	// 1 for perspective cameras, 0 for orthographic ones
+	float distanceBias;		// 0 for perspective cameras, 1 for orthographic ones
+	float threshold[c_maxLodScreenSizes];	// squared;  unused entries are negative, so nothing is ever smaller than them
+};
+
+void
+vsModelInstanceGroup::ClassifyChunk( int chunk, const CullParams &params )
+{
+	const CullChunk &c = m_cullChunk[chunk];
+	vsModelInstanceLodGroup *source = c.source;
+	const float *x = &source->m_boundX[0];
+	const float *y = &source->m_boundY[0];
+	const float *z = &source->m_boundZ[0];
+	const float *r = &source->m_boundRadius[0];
+	uint8_t *out = &source->m_cullLod[0];
+
+	vsFrustum::Classification visibility[c_cullChunkSize];
+	int chunkSize = c.end - c.start;
+	if ( params.frustum )
+		params.frustum->ClassifySpheres( x + c.start, y + c.start, z + c.start, r + c.start, visibility, chunkSize );
+	else
+	{
+		for ( int i = 0; i < chunkSize; i++ )
+			visibility[i] = vsFrustum::Inside;
+	}
+
+	// Take a local copy of the parameters;  since 'out' is a byte array, the
+	// compiler has to assume that writing to it might change 'params'.
+	const CullParams p = params;
+	const int baseLod = p.autoLod ? 0 : (int)source->m_lodLevel;
+
+	// Nothing in here branches, so that the compiler can vectorise it.  (Even
+	// the final select is done with arithmetic;  'visible - 1' is all ones
+	// for culled instances, which gives us c_culledLod)
+	for ( int i = c.start; i < c.end; i++ )
+	{
+		int visible = ( visibility[i - c.start] != vsFrustum::Outside );
+
+		float dx = x[i] - p.eyeX;
+		float dy = y[i] - p.eyeY;
+		float dz = z[i] - p.eyeZ;
+		float size = r[i] * r[i] * p.sizeScale;
+		float distance = (dx*dx + dy*dy + dz*dz) * p.distanceWeight + p.distanceBias;
+		int lod = baseLod;
+		for ( int t = 0; t < c_maxLodScreenSizes; t++ )
+			lod += ( size < p.threshold[t] * distance );
+
+		out[i] = (uint8_t)( lod | (visible - 1) );
+	}
+
+	int lodCount = m_lod.ItemCount();
+	int *count = &m_cullChunkCount[chunk * lodCount];
+	for ( int l = 0; l < lodCount; l++ )
+		count[l] = 0;
+	for ( int i = c.start; i < c.end; i++ )
+	{
+		if ( out[i] != c_culledLod )
+			count[ out[i] ]++;
+	}
+}
+
+void
+vsModelInstanceGroup::ScatterChunk( int chunk )
+{
+	const CullChunk &c = m_cullChunk[chunk];
+	vsModelInstanceLodGroup *source = c.source;
+	int *offset = &m_cullChunkCount[chunk * m_lod.ItemCount()];
+
+	for ( int i = c.start; i < c.end; i++ )
+	{
+		uint8_t lod = source->m_cullLod[i];
+		if ( lod == c_culledLod )
+			continue;
+		vsModelInstanceLodGroup *dest = m_lod[lod];
+		int o = offset[lod]++;
+		dest->m_drawMatrix[o] = source->m_matrix[i];
+		dest->m_drawColor[o] = source->m_color[i];
+	}
+}
+
+void
+vsModelInstanceGroup::Cull( const vsCamera3D *camera )
+{
+	PROFILE("vsModelInstanceGroup::Cull");
+
+	CullParams params;
+	params.frustum = m_frustumCulling ? &camera->GetFrustum() : nullptr;
+
+	// An instance's screen size is the fraction of the screen's height which
+	// its bounding sphere covers;  r / (distance * tan(fov/2)) for perspective
+	// cameras, or just r / fov for orthographic ones (whose "fov" is half the
+	// height of the view).  We compare squares, to avoid square roots.
+	params.autoLod = !m_lodScreenSize.IsEmpty();
+	vsVector3D eye = camera->GetPosition();
+	params.eyeX = eye.x;
+	params.eyeY = eye.y;
+	params.eyeZ = eye.z;
+	if ( camera->GetProjectionType() == vsCamera3D::PT_Perspective )
+	{
+		float tanHalfFov = vsTan( camera->GetFOV() * 0.5f );
+		params.sizeScale = 1.f / (tanHalfFov * tanHalfFov);
+		params.distanceWeight = 1.f;
+		params.distanceBias = 0.f;
+	}
+	else
+	{
+		params.sizeScale = 1.f / (camera->GetFOV() * camera->GetFOV());
+		params.distanceWeight = 0.f;
+		params.distanceBias = 1.f;
+	}
+	for ( int t = 0; t < c_maxLodScreenSizes; t++ )
+	{
+		float size = ( t < m_lodScreenSize.ItemCount() ) ? m_lodScreenSize[t] : -1.f;
+		params.threshold[t] = ( size < 0.f ) ? -1.f : size * size;
+	}
+
+	// Split all our shown instances into fixed-size chunks.
+	int lodCount = m_lod.ItemCount();
+	int instanceCount = 0;
+	m_cullChunk.Clear();
+	for ( int l = 0; l < lodCount; l++ )
+	{
+		vsModelInstanceLodGroup *group = m_lod[l];
+		int count = group->m_matrix.ItemCount();
+		group->m_cullLod.SetArraySize( count );
+		for ( int start = 0; start < count; start += c_cullChunkSize )
+		{
+			CullChunk chunk = { group, start, vsMin( start + c_cullChunkSize, count ) };
+			m_cullChunk.AddItem( chunk );
+		}
+		instanceCount += count;
+	}
+	int chunkCount = m_cullChunk.ItemCount();
+	m_cullChunkCount.SetArraySize( chunkCount * lodCount );
+
+	vsJobSystem *jobs = vsJobSystem::Instance();
+	bool parallel = jobs && jobs->GetWorkerCount() > 0 && instanceCount >= c_minParallelCull;
+
+	if ( parallel )
+	{
+		jobs->ParallelFor( 0, chunkCount, 1, [this, &params]( int start, int end )
+		{
+			for ( int i = start; i < end; i++ )
+				ClassifyChunk( i, params );
+		} );
+	}
+	else
+	{
+		for ( int i = 0; i < chunkCount; i++ )
+			ClassifyChunk( i, params );
+	}
+
+	// Turn each chunk's counts into the offsets where its instances go in
+	// each lod's output arrays, so chunks can write them independently and
+	// the output is still in the same order as m_matrix.
+	for ( int l = 0; l < lodCount; l++ )
+	{
+		int total = 0;
+		for ( int c = 0; c < chunkCount; c++ )
+		{
+			int &count = m_cullChunkCount[c * lodCount + l];
+			int chunkTotal = count;
+			count = total;
+			total += chunkTotal;
+		}
+		vsFrameArena *arena = vsFrameArena::Instance();
+		m_lod[l]->m_drawMatrix = arena->Alloc<vsMatrix4x4>( total );
+		m_lod[l]->m_drawColor = arena->Alloc<vsColor>( total );
+		m_lod[l]->m_drawCount = total;
+		m_lod[l]->m_culled = true;
+	}
+
+	if ( parallel )
+	{
+		jobs->ParallelFor( 0, chunkCount, 1, [this]( int start, int end )
+		{
+			for ( int i = start; i < end; i++ )
+				ScatterChunk( i );
+		} );
+	}
+	else
+	{
+		for ( int i = 0; i < chunkCount; i++ )
+			ScatterChunk( i );
+	}
+}
+
 void
 vsModelInstanceGroup::Draw( vsRenderQueue *queue )
 {
+	const vsCamera3D *camera = nullptr;
+	if ( m_frustumCulling || !m_lodScreenSize.IsEmpty() )
+	{
+		vsScene *scene = queue->GetScene();
+		if ( scene && scene->Is3D() )
+			camera = scene->GetCamera3D();
+	}
+
+	if ( camera )
+		Cull( camera );
+	else
+	{
+		for ( int i = 0; i < m_lod.ItemCount(); i++ )
+			m_lod[i]->m_culled = false;
+	}
+
 	for ( int i = 0; i < m_lod.ItemCount(); i++ )
 	{
 		m_lod[i]->Draw(queue);
 	}
 }
-
@@ -18,6 +18,7 @@
 #include "VS/Utils/VS_Array.h"
 #include "VS/Utils/VS_ArrayStore.h"
 
+class vsCamera3D;
 class vsModel;
 struct vsModelInstance;
 class vsModelInstanceGroup;
@@ -39,6 +40,27 @@ class vsModelInstanceLodGroup : public vsEntity
 	vsArray<vsColorPacked> m_color;
 	vsArray<int> m_matrixInstanceId;
 	vsArray<vsModelInstance*> m_instance;
+
+	// World-space bounding spheres of the shown instances, in the same order
+	// as m_matrix.  Kept as separate arrays so the culling pass can run down
+	// them several instances at a time.
+	vsArray<float> m_boundX;
+	vsArray<float> m_boundY;
+	vsArray<float> m_boundZ;
+	vsArray<float> m_boundRadius;
+	vsArray<uint8_t> m_cullLod; // the culling pass's verdict on each shown instance
+
+	// When our group culled us this frame, these hold the instances we're
+	// actually going to draw.  They're allocated from the vsFrameArena for
+	// each draw, since the display list only keeps a pointer to them until
+	// the frame is rendered, and we might be drawn more than once per frame.
+	vsMatrix4x4 *m_drawMatrix;
+	vsColor *m_drawColor;
+	int m_drawCount;
+	bool m_culled;
+
+	void SetBounds( int matrixIndex, const vsMatrix4x4 &matrix );
+	friend class vsModelInstanceGroup;
 #ifdef INSTANCED_MODEL_USES_LOCAL_BUFFER
 	vsRenderBuffer m_matrixBuffer;
 	vsRenderBuffer m_colorBuffer;
@@ -61,6 +83,11 @@ public:
 	void UpdateInstance( vsModelInstance *instance, bool show = true ); // must be called to change the matrix on this instance
 	vsModel * GetModel() { return m_model; }
 
+	// After our group has culled us this frame, the instances which we're
+	// going to draw, in the order they were shown.
+	int GetCulledCount() const { return m_drawCount; }
+	const vsMatrix4x4 * GetCulledMatrices() const { return m_drawMatrix; }
+
 	// find the bounds of our matrix translations.
 	void CalculateMatrixBounds( vsBox3D& out );
 	void CalculateBounds( vsBox3D& out );
@@ -70,12 +97,55 @@ public:
 
 class vsModelInstanceGroup: public vsEntity
 {
+	struct CullChunk
+	{
+		vsModelInstanceLodGroup *source;
+		int start;
+		int end;
+	};
+	struct CullParams;
+
 	vsModel *m_model;
 	vsArrayStore<vsModelInstanceLodGroup> m_lod;
+
+	bool m_frustumCulling;
+	vsArray<float> m_lodScreenSize;
+
+	vsArray<CullChunk> m_cullChunk;
+	vsArray<int> m_cullChunkCount;	// [chunk * lodCount + lod];  instance counts, then output offsets
+
+	void ClassifyChunk( int chunk, const CullParams &params );
+	void ScatterChunk( int chunk );
 public:
+	static const int c_cullChunkSize = 4096;	// instances per culling job.  Fixed, so results don't depend on thread count
+	static const int c_minParallelCull = 16384;	// culling passes smaller than this just run on the calling thread
+	static const uint8_t c_culledLod = 0xff;
+	static const int c_maxLodScreenSizes = 8;
 
 	vsModelInstanceGroup( vsModel *model );
 
+	// Per-frame culling.  While enabled, Draw() tests each shown instance's
+	// bounding sphere (from the model's bounding box) against the drawing
+	// scene's 3D camera, and only submits the instances which might be
+	// visible.  Off by default.
+	void SetFrustumCulling( bool cull ) { m_frustumCulling = cull; }
+	bool IsFrustumCulling() const { return m_frustumCulling; }
+
+	// Automatic lod selection.  'screenSize' has an entry for each lod except
+	// the last one, in decreasing order.  Each frame, an instance whose
+	// bounding sphere covers at least screenSize[i] of the screen's height is
+	// drawn at the first such lod 'i', and smaller instances are drawn at the
+	// last lod.  While set, this overrides the lod levels of the instances
+	// themselves.  Pass a 'count' of zero to go back to using those.
+	void SetLodScreenSizes( const float *screenSize, int count );
+
+	// Runs the culling and lod selection which Draw() does, against 'camera',
+	// and leaves each lod's results in its GetCulledMatrices() until the end
+	// of the frame.
+	void Cull( const vsCamera3D *camera );
+	int GetLodCount() const { return m_lod.ItemCount(); }
+	vsModelInstanceLodGroup * GetLod( int lod ) { return m_lod[lod]; }
+
 	void TakeInstancesFromGroup( vsModelInstanceGroup *otherGroup );
 	void SetShaderValues( vsShaderValues *values );
 	void SetShaderOptions( vsShaderOptions *options );
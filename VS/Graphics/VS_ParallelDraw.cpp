@@ -0,0 +1,149 @@
+/*
+ *  VS_ParallelDraw.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_ParallelDraw.h"
+
+#include "VS_Entity.h"
+#include "VS_RenderQueue.h"
+#include "VS_FrameArena.h"
+#include "VS/Threads/VS_JobSystem.h"
+#include "VS/Threads/VS_Thread.h"
+
+#include "VS_Profile.h"
+
+vsParallelDraw * vsParallelDraw::s_instance = nullptr;
+
+namespace
+{
+	// Which vsParallelDraw's arena this thread is using.  We identify the
+	// owner by id rather than by pointer, so a new vsParallelDraw which
+	// happens to be created at the same address doesn't pick up a deleted
+	// arena.
+	struct ThreadArena
+	{
+		int				owner;
+		vsFrameArena *	arena;
+	};
+	thread_local ThreadArena s_threadArena = { 0, nullptr };
+	int s_nextId = 1;
+};
+
+struct vsParallelDraw::Segment
+{
+	vsRenderQueue	queue;
+	vsEntity **		entity;
+	int				entityCount;
+
+	Segment():
+		entity(nullptr),
+		entityCount(0)
+	{
+	}
+};
+
+vsParallelDraw::vsParallelDraw():
+	m_segment(new Segment[c_maxSegments]),
+	m_id(s_nextId++),
+	m_drawing(false)
+{
+	vsAssert(s_instance == nullptr, "Multiple vsParallelDraws created??");
+	s_instance = this;
+}
+
+vsParallelDraw::~vsParallelDraw()
+{
+	for ( int i = 0; i < m_threadArena.ItemCount(); i++ )
+		vsDelete( m_threadArena[i] );
+	vsDeleteArray( m_segment );
+
+	vsAssert(s_instance == this, "vsParallelDraw instance isn't me??");
+	s_instance = nullptr;
+}
+
+vsFrameArena *
+vsParallelDraw::GetThreadArena()
+{
+	// The main thread just uses the shared arena.
+	if ( vsThread::IsMainThread() )
+		return nullptr;
+
+	if ( s_threadArena.owner != m_id )
+	{
+		vsFrameArena *arena = new vsFrameArena( 256 * 1024, false );
+		m_threadArenaLock.Lock();
+		m_threadArena.AddItem( arena );
+		m_threadArenaLock.Unlock();
+
+		s_threadArena.owner = m_id;
+		s_threadArena.arena = arena;
+	}
+	return s_threadArena.arena;
+}
+
+void
+vsParallelDraw::Draw( vsRenderQueue *queue, vsEntity **entity, int count )
+{
+	int segmentCount = vsMin( c_maxSegments, count / c_minEntitiesPerSegment );
+	vsJobSystem *jobs = vsJobSystem::Instance();
+
+	if ( m_drawing || !jobs || jobs->GetWorkerCount() == 0 || segmentCount < 2 || !vsThread::IsMainThread() )
+	{
+		for ( int i = 0; i < count; i++ )
+			entity[i]->Draw( queue );
+		return;
+	}
+
+	PROFILE("ParallelDraw::Draw");
+	m_drawing = true;
+
+	// Segment boundaries depend only on the entity count, never on how many
+	// threads we have, so that the merged queue is the same on every machine.
+	for ( int i = 0; i < segmentCount; i++ )
+	{
+		int start = (i * count) / segmentCount;
+		int end = ((i+1) * count) / segmentCount;
+		Segment &segment = m_segment[i];
+		segment.entity = entity + start;
+		segment.entityCount = end - start;
+		segment.queue.StartSegment( queue );
+	}
+
+	jobs->ParallelFor( 0, segmentCount, 1, [this]( int start, int end ) { DrawSegments( start, end ); } );
+
+	for ( int i = 0; i < segmentCount; i++ )
+		queue->MergeSegment( &m_segment[i].queue );
+
+	m_drawing = false;
+}
+
+void
+vsParallelDraw::DrawSegments( int start, int end )
+{
+	PROFILE("ParallelDraw::Segment");
+
+	// The main thread is waiting for us, so it can't be in the middle of
+	// flipping the shared arena right now.
+	vsFrameArena *arena = GetThreadArena();
+	if ( arena )
+	{
+		arena->CatchUp();
+		vsFrameArena::SetThreadInstance( arena );
+	}
+
+	for ( int s = start; s < end; s++ )
+	{
+		Segment &segment = m_segment[s];
+		for ( int i = 0; i < segment.entityCount; i++ )
+			segment.entity[i]->Draw( &segment.queue );
+	}
+
+	if ( arena )
+		vsFrameArena::SetThreadInstance( nullptr );
+}
+
@@ -0,0 +1,73 @@
+/*
+ *  VS_ParallelDraw.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_PARALLELDRAW_H
+#define VS_PARALLELDRAW_H
+
+#include "VS/Threads/VS_Spinlock.h"
+#include "VS/Utils/VS_Array.h"
+
+class vsEntity;
+class vsFrameArena;
+class vsRenderQueue;
+
+// vsParallelDraw builds a render queue for a list of entities on several
+// threads at once.  The entities are split into contiguous segments;  each
+// segment is drawn into its own vsRenderQueue by a vsJobSystem job, and then
+// the segments are merged back into the real queue in their original order.
+// So the result doesn't depend on which thread drew what.  Only the building
+// of the queue happens on other threads;  the queue is still drawn into a
+// display list and submitted to the renderer on the main thread, same as
+// always.
+//
+// This is opt-in (see vsScene::SetParallelDraw() and
+// vsEntity::DrawChildrenParallel()), since it requires that the Draw()
+// functions of everything involved are safe to run on several threads at
+// once.  In practice that means that they only read shared state, and only
+// write to the render queue they're passed.
+//
+// Each thread which draws a segment (other than the main thread) gets its own
+// vsFrameArena, so render queue allocations don't need any locking.
+//
+// Parallel draws don't nest;  if an entity being drawn on a worker calls
+// DrawChildrenParallel(), its children are just drawn normally.
+
+class vsParallelDraw
+{
+	static vsParallelDraw *	s_instance;
+
+	struct Segment;
+
+	Segment *		m_segment;
+	int				m_id;
+	bool			m_drawing;
+
+	vsArray<vsFrameArena*>	m_threadArena;
+	vsSpinlock		m_threadArenaLock;
+
+	vsFrameArena *	GetThreadArena();
+	void			DrawSegments( int start, int end );
+
+public:
+	static const int c_maxSegments = 16;
+	static const int c_minEntitiesPerSegment = 32;	// don't bother splitting up less work than this
+
+	static vsParallelDraw* Instance() { return s_instance; }
+
+	vsParallelDraw();
+	~vsParallelDraw();
+
+	// Draws 'count' entities into 'queue', in parallel if there are enough of
+	// them to be worth it.  Must be called from the main thread, inside a
+	// render (between the queue's StartRender() and Draw()).
+	void			Draw( vsRenderQueue *queue, vsEntity **entity, int count );
+};
+
+#endif // VS_PARALLELDRAW_H
+
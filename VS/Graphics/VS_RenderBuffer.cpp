@@ -11,6 +11,7 @@
 
 #include "VS_OpenGL.h"
 #include "VS_Profile.h"
+#include "VS_Renderer.h"
 #include "VS_Transform.h"
 #include "VS_GraphicsMemoryProfiler.h"
 
@@ -69,8 +70,10 @@ vsRenderBuffer::vsRenderBuffer(vsRenderBuffer::Type type):
 	vsAssert( sizeof( uint16_t ) == 2, "I've gotten the size wrong??" );
 
 	// TESTING:  Seems like iPhone runs SLOWER with VBOs than with arrays, so just use our vsRenderBuffer in "array" mode.
+	// And when headless there's no GL context to make VBOs in, so we just
+	// keep our data in our CPU-side array.
 #if !TARGET_OS_IPHONE
-	if ( glGenBuffers && m_type != Type_NoVBO )
+	if ( !vsRenderer::IsHeadless() && glGenBuffers && m_type != Type_NoVBO )
 	{
 		m_vbo = true;
 	}
@@ -92,6 +95,8 @@ vsRenderBuffer::~vsRenderBuffer()
 	{
 		vsDeleteArray( m_array );
 	}
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 vsVertexArrayObject *
@@ -214,6 +219,8 @@ vsRenderBuffer::SetArray_Internal( char *data, int size, vsRenderBuffer::BindTyp
 		}
 #endif
 	}
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyBufferUploaded( size );
 	m_activeBytes = size;
 
 	if ( data != m_array )
@@ -18,9 +18,11 @@
 #include "VS_DynamicBatchManager.h"
 
 #include "VS_MaterialInternal.h"
+#include "VS_FrameArena.h"
+#include "VS_Store.h"
 
 #include "VS/VS_DisableDebugNew.h"
-#include <map>
+#include <algorithm>
 #include "VS/VS_EnableDebugNew.h"
 
 #include "VS_Profile.h"
@@ -30,22 +32,29 @@ class vsRenderQueueStage
 public:
 	struct BatchMap;
 	struct BatchElement;
+	struct BatchElementOverrides;
+	struct MergeTarget;
 	struct Batch;
 private:
 	vsMatrix4x4			m_worldToView;
 
 	BatchMap*			m_batchMap;
-	Batch*				m_batch;
-	int					m_batchCount;
-
-	Batch *				m_batchPool;
-	BatchElement * 		m_batchElementPool;
-
-	vsLinkedListStore<vsDisplayList>	m_temporaryLists;
-
-	Batch *			FindBatch( vsMaterial *material );
-
-	inline void _AddElementToBatch( vsRenderQueueStage::BatchElement *element, vsRenderQueueStage::Batch *batch );
+	vsArray<Batch*>		m_batches;		// unsorted until Draw()
+	vsArray<vsMatrix4x4>	m_matrices;	// local-to-world matrices for this frame's elements
+	bool				m_deferMerging;	// leave simple batches for Merge() to combine
+
+	// Batches, BatchElements and temporary display lists all live in the
+	// vsFrameArena, and are thrown away together at the end of the frame.
+	vsArray<vsDisplayList*>	m_temporaryLists;
+
+	Batch *			FindBatch( vsMaterial *material ) { return FindBatch( material->GetResource()->GetBatchMaterial() ); }
+	Batch *			FindBatch( vsMaterialInternal *resource );
+	void			ReserveElements( Batch *batch, int count );
+	BatchElement *	NewElement( Batch *batch, vsMaterial *material, const vsMatrix4x4 *matrix );
+	BatchElementOverrides *	Overrides( BatchElement *element );
+	MergeTarget *	FindMergeTarget( Batch *batch, vsMaterial *material, vsRenderBuffer::ContentType contentType );
+	void			SortBatches();
+	void			SortElementsByDepth( Batch *batch );
 
 public:
 
@@ -54,10 +63,13 @@ public:
 
 	void			SetWorldToView( const vsMatrix4x4& wtv ) { m_worldToView = wtv; }
 
-	void			StartRender();
+	void			StartRender( bool deferMerging = false );
 	void			Draw( vsDisplayList *list );	// write our batches into here.
 	void			EndRender();
 
+	// Move everything from 'other' onto the end of our batches.
+	void			Merge( vsRenderQueueStage &other );
+
 	// Add a batch to this stage
 	void			AddBatch( vsMaterial *material, const vsMatrix4x4 &matrix, vsDisplayList *batch );
 	void			AddBatch( vsMaterial *material, vsVertexArrayObject *vao, const vsMatrix4x4 &matrix, vsDisplayList *batch );
@@ -78,10 +90,26 @@ public:
 };
 
 
+// BatchElements are stored in contiguous arrays, one per Batch, and we walk
+// every one of them each frame in Draw().  So we keep them small:  the
+// matrix lives in the stage's m_matrices array, and everything which only
+// instanced draws or shader overrides use is split off into a separate
+// BatchElementOverrides struct, which most elements don't have at all.
 struct vsRenderQueueStage::BatchElement
 {
-	vsMatrix4x4		matrix;
 	vsMaterial *	material;
+	vsDisplayList *	list;
+	vsVertexArrayObject *vao;
+	vsRenderBuffer *vbo;
+	vsRenderBuffer *ibo;
+	vsDynamicBatch * batch;
+	BatchElementOverrides *overrides;
+	int				matrixIndex;	// index into m_matrices, or -1 for identity
+	vsFragment::SimpleType simpleType;
+};
+
+struct vsRenderQueueStage::BatchElementOverrides
+{
 	vsShaderValues *shaderValues;
 	vsShaderOptions *shaderOptions;
 	const vsMatrix4x4 *	instanceMatrix;
@@ -89,230 +117,301 @@ struct vsRenderQueueStage::BatchElement
 	int				instanceMatrixCount;
 	vsRenderBuffer *instanceMatrixBuffer;
 	vsRenderBuffer *instanceColorBuffer;
-	vsDisplayList *	list;
-	vsVertexArrayObject *vao;
-	vsRenderBuffer *vbo;
-	vsRenderBuffer *ibo;
-	vsFragment::SimpleType simpleType;
-	BatchElement *	next;
-
-	float           sortValue;
 
-	vsDynamicBatch * batch;
-
-	BatchElement():
-		material(nullptr),
+	BatchElementOverrides():
 		shaderValues(nullptr),
 		shaderOptions(nullptr),
 		instanceMatrix(nullptr),
 		instanceColor(nullptr),
 		instanceMatrixCount(0),
 		instanceMatrixBuffer(nullptr),
-		instanceColorBuffer(nullptr),
-		list(nullptr),
-		vao(nullptr),
-		vbo(nullptr),
-		ibo(nullptr),
-		next(nullptr),
-		sortValue(0.f),
-		batch(nullptr)
-	{
-	}
-
-	void Clear()
+		instanceColorBuffer(nullptr)
 	{
-		material = nullptr;
-		shaderValues = nullptr;
-		shaderOptions = nullptr;
-		instanceMatrix = nullptr;
-		instanceMatrixCount = 0;
-		instanceMatrixBuffer = nullptr;
-		instanceColorBuffer = nullptr;
-		instanceColor = nullptr;
-		list = nullptr;
-		vao = nullptr;
-		vbo = nullptr;
-		ibo = nullptr;
-		sortValue = 0.f;
-		batch = nullptr;
 	}
+};
 
+// A simple element which later simple elements in the same batch can be
+// merged into, if they have the same vertex format and material values.
+struct vsRenderQueueStage::MergeTarget
+{
+	vsMaterial *		material;
+	vsRenderBuffer::ContentType contentType;
+	int					elementIndex;
+	MergeTarget *		next;
 };
 
 struct vsRenderQueueStage::Batch
 {
 	vsMaterialInternal*	material;
-	BatchElement*		elementList;
+	BatchElement*		element;		// in submission order
+	int					elementCount;
+	int					elementCapacity;
+	MergeTarget*		mergeTargets;
 	vsVertexArrayObject *vao;
-	Batch*				next;
+	uint64_t			sortKey;	// layer in the high bits, material id in the low bits
 
 	Batch();
-	~Batch();
 };
 
+// Open-addressed (linear probing) table from material to this frame's Batch
+// for that material.  We look up a batch for every single thing that gets
+// added to the render queue, so this wants to be quick;  it lives in a single
+// flat array and never allocates once it's grown to fit the scene.
 struct vsRenderQueueStage::BatchMap
 {
-	std::map<vsMaterialInternal*,vsRenderQueueStage::Batch*> map;
+	struct Slot
+	{
+		vsMaterialInternal *	key;
+		Batch *					batch;
+	};
+
+	Slot *	m_slot;
+	int		m_capacity;	// always a power of two
+	int		m_count;
+
+	BatchMap():
+		m_slot(nullptr),
+		m_capacity(0),
+		m_count(0)
+	{
+		Resize(64);
+	}
+
+	~BatchMap()
+	{
+		vsDeleteArray( m_slot );
+	}
+
+	int	SlotFor( vsMaterialInternal *key ) const
+	{
+		// Fibonacci hash of the pointer, discarding the low bits which are
+		// always zero due to alignment.
+		uint64_t hash = ((uint64_t)(uintptr_t)key >> 4) * 11400714819323198485ull;
+		return (int)(hash >> 32) & (m_capacity-1);
+	}
+
+	Batch *	Find( vsMaterialInternal *key ) const
+	{
+		int i = SlotFor(key);
+		while ( m_slot[i].key )
+		{
+			if ( m_slot[i].key == key )
+				return m_slot[i].batch;
+			i = (i+1) & (m_capacity-1);
+		}
+		return nullptr;
+	}
+
+	void	Insert( vsMaterialInternal *key, Batch *batch )
+	{
+		// keep the load factor at or below 50%, so probe sequences stay short.
+		if ( (m_count+1) * 2 > m_capacity )
+			Resize( m_capacity * 2 );
+
+		int i = SlotFor(key);
+		while ( m_slot[i].key )
+			i = (i+1) & (m_capacity-1);
+		m_slot[i].key = key;
+		m_slot[i].batch = batch;
+		m_count++;
+	}
+
+	void	Resize( int capacity )
+	{
+		Slot *oldSlot = m_slot;
+		int oldCapacity = m_capacity;
+
+		m_slot = new Slot[capacity];
+		m_capacity = capacity;
+		m_count = 0;
+		memset( m_slot, 0, sizeof(Slot) * capacity );
+
+		for ( int i = 0; i < oldCapacity; i++ )
+		{
+			if ( oldSlot[i].key )
+				Insert( oldSlot[i].key, oldSlot[i].batch );
+		}
+		vsDeleteArray( oldSlot );
+	}
+
+	void	Clear()
+	{
+		if ( m_count > 0 )
+		{
+			memset( m_slot, 0, sizeof(Slot) * m_capacity );
+			m_count = 0;
+		}
+	}
 };
 
 
 vsRenderQueueStage::Batch::Batch():
 	material(nullptr),
-	elementList(nullptr),
-	next(nullptr)
+	element(nullptr),
+	elementCount(0),
+	elementCapacity(0),
+	mergeTargets(nullptr),
+	vao(nullptr),
+	sortKey(0)
 {
 }
 
-vsRenderQueueStage::Batch::~Batch()
+namespace
 {
-}
+	// Maps a float onto a uint32_t which sorts in the opposite order;  that
+	// is, larger floats produce smaller keys.
+	inline uint32_t DescendingSortKey( float value )
+	{
+		uint32_t bits;
+		memcpy( &bits, &value, sizeof(bits) );
+		if ( bits == 0x80000000u )
+			bits = 0; // -0 == +0
+		uint32_t ascending = ( bits & 0x80000000u ) ? ~bits : ( bits | 0x80000000u );
+		return ~ascending;
+	}
+
+	// Stable LSD radix sort of 'value' by 'key', eight bits at a time.  The
+	// scratch arrays must be at least 'count' long.  Returns whichever of
+	// 'value' or 'valueScratch' holds the sorted result.
+	template<typename T>
+	T* RadixSort( uint32_t *key, T *value, uint32_t *keyScratch, T *valueScratch, int count )
+	{
+		for ( int shift = 0; shift < 32; shift += 8 )
+		{
+			int histogram[256] = {0};
+			for ( int i = 0; i < count; i++ )
+				histogram[ (key[i] >> shift) & 0xff ]++;
+
+			// if every key has the same value in this byte, this pass wouldn't
+			// change anything.  This is very common for depths, where most
+			// keys share their exponent bits.
+			if ( histogram[ (key[0] >> shift) & 0xff ] == count )
+				continue;
+
+			int offset = 0;
+			for ( int i = 0; i < 256; i++ )
+			{
+				int c = histogram[i];
+				histogram[i] = offset;
+				offset += c;
+			}
+			for ( int i = 0; i < count; i++ )
+			{
+				int dest = histogram[ (key[i] >> shift) & 0xff ]++;
+				keyScratch[dest] = key[i];
+				valueScratch[dest] = value[i];
+			}
+
+			uint32_t *swapKey = key; key = keyScratch; keyScratch = swapKey;
+			T *swapValue = value; value = valueScratch; valueScratch = swapValue;
+		}
+		return value;
+	}
+};
 
 vsRenderQueueStage::vsRenderQueueStage():
 	m_batchMap(new BatchMap),
-	m_batch(nullptr),
-	m_batchCount(0),
-	m_batchPool(nullptr),
-	m_batchElementPool(nullptr)
+	m_batches(64),
+	m_matrices(1024),
+	m_deferMerging(false)
 {
 }
 
 vsRenderQueueStage::~vsRenderQueueStage()
 {
 	vsDelete( m_batchMap );
-	while( m_batchPool )
-	{
-		Batch *b = m_batchPool;
-		m_batchPool = m_batchPool->next;
-		vsDelete(b);
-	}
-	while( m_batchElementPool )
-	{
-		BatchElement *e = m_batchElementPool;
-		m_batchElementPool = m_batchElementPool->next;
-		vsDelete(e);
-	}
 }
 
 void
-vsRenderQueueStage::_AddElementToBatch( vsRenderQueueStage::BatchElement *element, vsRenderQueueStage::Batch *batch )
+vsRenderQueueStage::ReserveElements( Batch *batch, int count )
 {
-	// check if sorting is enabled.
-
-	if ( batch->material->m_zSort )
+	if ( count > batch->elementCapacity )
 	{
-		// okay, we need to insert this batch somewhere in our list according to our
-		// zSort.
-
-		// how can I figure out my sort value?
-		vsVector4D viewPos = m_worldToView.ApplyTo( element->matrix.w );
-		float sortVal = viewPos.z;
+		// Out of room;  move to a bigger array.  The old one stays in the
+		// frame arena until the frame ends, which is fine.
+		int newCapacity = vsMax( 16, batch->elementCapacity * 2 );
+		while ( newCapacity < count )
+			newCapacity *= 2;
+		BatchElement *newElement = vsFrameArena::Instance()->Alloc<BatchElement>( newCapacity );
+		if ( batch->elementCount > 0 )
+			memcpy( newElement, batch->element, sizeof(BatchElement) * batch->elementCount );
+		batch->element = newElement;
+		batch->elementCapacity = newCapacity;
+	}
+}
 
-		element->sortValue = sortVal;
-		// now, we insert into this batch's element list.
+vsRenderQueueStage::BatchElement *
+vsRenderQueueStage::NewElement( Batch *batch, vsMaterial *material, const vsMatrix4x4 *matrix )
+{
+	ReserveElements( batch, batch->elementCount+1 );
 
-		if ( !batch->elementList || batch->elementList->sortValue < element->sortValue )
-		{
-			element->next = batch->elementList;
-			batch->elementList = element;
-			return;
-		}
-		else
-		{
-			BatchElement *next = batch->elementList;
-			// if ( !next->next && next->sortValue < element->sortValue )
-			// {
-			// 	// we go BEFORE the first thing in the list now!
-            //
-			// 	element->next = batch->elementList;
-			// 	batch->elementList = element;
-			// 	return;
-			// }
-
-			while ( next )
-			{
-				if ( !next->next || next->next->sortValue < element->sortValue )
-				{
-					element->next = next->next;
-					next->next = element;
-					return;
-				}
-				else
-				{
-					next = next->next;
-				}
-			}
-		}
-	}
-	else
+	BatchElement *element = &batch->element[ batch->elementCount++ ];
+	element->material = material;
+	element->list = nullptr;
+	element->vao = nullptr;
+	element->vbo = nullptr;
+	element->ibo = nullptr;
+	element->batch = nullptr;
+	element->overrides = nullptr;
+	element->matrixIndex = -1;
+	element->simpleType = vsFragment::SimpleType_TriangleList;
+
+	if ( matrix )
 	{
-		element->next = batch->elementList;
-		batch->elementList = element;
+		element->matrixIndex = m_matrices.ItemCount();
+		m_matrices.AddItem( *matrix );
 	}
+
+	return element;
+}
+
+vsRenderQueueStage::BatchElementOverrides *
+vsRenderQueueStage::Overrides( BatchElement *element )
+{
+	if ( !element->overrides )
+		element->overrides = vsFrameArena::Instance()->New<BatchElementOverrides>();
+	return element->overrides;
 }
 
 
 vsRenderQueueStage::Batch *
-vsRenderQueueStage::FindBatch( vsMaterial *material )
+vsRenderQueueStage::FindBatch( vsMaterialInternal *resource )
 {
 	PROFILE("RenderQueueStage::FindBatch");
 
-	std::map<vsMaterialInternal*, vsRenderQueueStage::Batch*>::iterator it = m_batchMap->map.find(material->GetResource());
-	if ( it != m_batchMap->map.end() )
-	{
-		return it->second;
-	}
+	Batch *batch = m_batchMap->Find(resource);
+	if ( batch )
+		return batch;
 
-	if ( !m_batchPool )
-	{
-		m_batchPool = new Batch;
-	}
-	Batch *batch = m_batchPool;
-	m_batchPool = batch->next;
-	batch->next = nullptr;
-	batch->material = material->GetResource();
+	batch = vsFrameArena::Instance()->New<Batch>();
+	batch->material = resource;
 
-	// insert this batch into our batch list, SORTED.
-	bool inserted = false;
+	// Batches draw in order of material layer, and then by material id so that
+	// the order is stable from frame to frame.  We don't keep the list sorted
+	// as we go;  we just sort it once, right before we draw.
+	uint32_t layerBits = (uint32_t)resource->m_layer ^ 0x80000000u;	// so negative layers sort first
+	batch->sortKey = ((uint64_t)layerBits << 32) | (uint32_t)resource->m_id;
 
-	if ( m_batch == nullptr )
-	{
-		m_batch = batch;
-	}
-	else
-	{
-		if ( m_batch->material->m_layer > material->GetResource()->m_layer )
-		{
-			// we should sort before the first thing in the batch list.
-			batch->next = m_batch;
-			m_batch = batch;
-			inserted = true;
-		}
-		else
-		{
-			Batch *lb;
-			for(lb = m_batch; lb->next; lb = lb->next)
-			{
-				if ( lb->next->material->m_layer > material->GetResource()->m_layer )
-				{
-					batch->next = lb->next;
-					lb->next = batch;
-					inserted = true;
-					break;
-				}
-			}
-
-			if ( !inserted )
-			{
-				lb->next = batch;
-			}
-		}
-	}
-	m_batchCount++;
-	m_batchMap->map[material->GetResource()] = batch;
+	m_batches.AddItem(batch);
+	m_batchMap->Insert(resource, batch);
 
 	return batch;
 }
 
+void
+vsRenderQueueStage::SortBatches()
+{
+	PROFILE("RenderQueueStage::SortBatches");
+
+	int count = m_batches.ItemCount();
+	if ( count > 1 )
+	{
+		Batch **first = &m_batches[0];
+		std::sort( first, first + count,
+				[](const Batch *a, const Batch *b) { return a->sortKey < b->sortKey; } );
+	}
+}
+
 
 void
 vsRenderQueueStage::AddBatch( vsMaterial *material, const vsMatrix4x4 &matrix, vsDisplayList *batchList )
@@ -326,24 +425,9 @@ vsRenderQueueStage::AddBatch( vsMaterial *material, vsVertexArrayObject *vao, co
 	PROFILE("AddBatch");
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->matrix = matrix;
+	BatchElement *element = NewElement( batch, material, &matrix );
 	element->list = batchList;
 	element->vao = vao;
-	element->instanceMatrix = nullptr;
-	element->instanceMatrixBuffer = nullptr;
-	element->instanceColorBuffer = nullptr;
-
-	_AddElementToBatch( element, batch );
 }
 
 void
@@ -358,7 +442,7 @@ vsRenderQueueStage::AddSimpleBatch( vsMaterial *material, vsVertexArrayObject *v
 	PROFILE("AddSimpleBatch");
 	Batch *batch = FindBatch(material);
 
-	if ( vsSystem::Instance()->GetPreferences()->GetDynamicBatching() )
+	if ( !m_deferMerging && vsSystem::Instance()->GetPreferences()->GetDynamicBatching() )
 	{
 		// Check for compatible simple BatchElements in this batch.  If I find
 		// one, we'll merge together.
@@ -376,87 +460,96 @@ vsRenderQueueStage::AddSimpleBatch( vsMaterial *material, vsVertexArrayObject *v
 		// with a three-attribute vertex format like PCT, you can do 300 vertices.
 		// But with PCNT, you only get 225.)  I could do something like that, I guess?
 
-		BatchElement *mergeCandidate = nullptr;
 		// don't even try to merge things that are too big.
-		if ( vbo->GetPositionCount() < 100 &&
-				vsDynamicBatch::Supports( vbo->GetContentType() ) )
+		vsRenderBuffer::ContentType contentType = vbo->GetContentType();
+		bool mergeable = vbo->GetPositionCount() < vsDynamicBatch::c_maxMergeableVertices &&
+			vsDynamicBatch::Supports( contentType );
+
+		if ( mergeable )
 		{
+			// Rather than searching every element in the batch for something
+			// compatible, each batch keeps a MergeTarget for every
+			// (content type, material values) combination it's seen this frame,
+			// pointing at the most recent element we could merge into.  In
+			// practice there are only ever one or two of these per batch.
 			PROFILE("Finding merge candidate");
-			mergeCandidate = batch->elementList;
-			while(mergeCandidate)
+			MergeTarget *target = FindMergeTarget( batch, material, contentType );
+			BatchElement *mergeCandidate = target ? &batch->element[target->elementIndex] : nullptr;
+
+			if ( mergeCandidate && mergeCandidate->batch &&
+					!mergeCandidate->batch->CanFitVertices( vbo->GetPositionCount() ) )
+			{
+				// that dynamic batch is full;  we'll become the new merge
+				// target for anything which comes after us.
+				mergeCandidate = nullptr;
+			}
+
+			if (mergeCandidate)
 			{
-				// [TODO] I should also be checking whether there's space in the
-				// mergeCandidate's buffer to merge with it.
-				if ( mergeCandidate->instanceMatrix == nullptr &&
-						mergeCandidate->vbo &&
-						mergeCandidate->vbo->GetContentType() == vbo->GetContentType() &&
-						mergeCandidate->material->MatchesForBatching( material ) )
+				PROFILE("Doing merge");
+				// Okay.  So what we're going to do is this:
+				//
+				// First, we need to understand whether this batch is already a "merge"
+				// batch, because if so we can safely add ourself to it.  If NOT, we
+				// must create a "merge" batch and add BOTH the merge candidate AND
+				// this batch to it, then remove the mergeCandidate.
+				//
+				// This implies that we need to have some set of "merge" batches around
+				// and ready for use.  And we need a way to mark which BatchElements
+				// represent these "merge" batches
+
+				if ( mergeCandidate->batch == nullptr )
 				{
-					if ( mergeCandidate->batch == nullptr )
-					{
-						if ( mergeCandidate->vbo->GetPositionCount() + vbo->GetPositionCount() < 100 )
-							break;
-					}
-					else
-					{
-						if ( mergeCandidate->batch->CanFitVertices( vbo->GetPositionCount() ) )
-							break;
-					}
+					mergeCandidate->batch = vsDynamicBatchManager::Instance()->GetNewBatch();
+					mergeCandidate->batch->StartBatch( mergeCandidate->vbo,
+							mergeCandidate->ibo,
+							m_matrices[mergeCandidate->matrixIndex],
+							mergeCandidate->simpleType );
 				}
-				mergeCandidate = mergeCandidate->next;
+				mergeCandidate->batch->AddToBatch( vbo, ibo, matrix, simpleType );
+				vsDynamicBatchManager::Instance()->CountMergedFragment();
+				return;
 			}
-		}
 
-		if (mergeCandidate)
-		{
-			PROFILE("Doing merge");
-			// vsLog("Found merge candidate!");
-			// Okay.  So what we're going to do is this:
-			//
-			// First, we need to understand whether this batch is already a "merge"
-			// batch, because if so we can safely add ourself to it.  If NOT, we
-			// must create a "merge" batch and add BOTH the merge candidate AND
-			// this batch to it, then remove the mergeCandidate.
-			//
-			// This implies that we need to have some set of "merge" batches around
-			// and ready for use.  And we need a way to mark which BatchElements
-			// represent these "merge" batches
-
-			if ( mergeCandidate->batch == nullptr )
+			BatchElement *element = NewElement( batch, material, &matrix );
+			element->vao = vao;
+			element->vbo = vbo;
+			element->ibo = ibo;
+			element->simpleType = simpleType;
+
+			if ( !target )
 			{
-				mergeCandidate->batch = vsDynamicBatchManager::Instance()->GetNewBatch();
-				mergeCandidate->batch->StartBatch( mergeCandidate->vbo,
-						mergeCandidate->ibo,
-						mergeCandidate->matrix,
-						mergeCandidate->simpleType );
+				target = vsFrameArena::Instance()->New<MergeTarget>();
+				target->material = material;
+				target->contentType = contentType;
+				target->next = batch->mergeTargets;
+				batch->mergeTargets = target;
 			}
-			mergeCandidate->batch->AddToBatch( vbo, ibo, matrix, simpleType );
+			target->elementIndex = batch->elementCount-1;
 			return;
 		}
 	}
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->matrix = matrix;
-	element->list = nullptr;
+	BatchElement *element = NewElement( batch, material, &matrix );
 	element->vao = vao;
 	element->vbo = vbo;
 	element->ibo = ibo;
 	element->simpleType = simpleType;
-	element->instanceMatrix = nullptr;
-	element->instanceMatrixBuffer = nullptr;
-	element->instanceColorBuffer = nullptr;
+}
 
-	_AddElementToBatch( element, batch );
+vsRenderQueueStage::MergeTarget *
+vsRenderQueueStage::FindMergeTarget( Batch *batch, vsMaterial *material, vsRenderBuffer::ContentType contentType )
+{
+	for ( MergeTarget *target = batch->mergeTargets; target; target = target->next )
+	{
+		if ( target->contentType != contentType )
+			continue;
+		// Lots of fragments share a single vsMaterial, so check for that
+		// before doing the full comparison of material values.
+		if ( target->material == material || target->material->MatchesForBatching( material ) )
+			return target;
+	}
+	return nullptr;
 }
 
 void
@@ -464,46 +557,18 @@ vsRenderQueueStage::AddInstanceBatch( vsMaterial *material, const vsMatrix4x4 *m
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->instanceMatrixCount = matrixCount;
-	element->instanceMatrix = matrix;
-	element->instanceMatrixBuffer = nullptr;
-	element->instanceColorBuffer = nullptr;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->list = batchList;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->instanceMatrixCount = matrixCount;
+	overrides->instanceMatrix = matrix;
 }
 
 void
 vsRenderQueueStage::AddInstanceBatch( vsMaterial *material, vsRenderBuffer *matrixBuffer, vsRenderBuffer *colorBuffer, vsDisplayList *batchList, vsShaderValues *values, vsShaderOptions *options )
 {
-	Batch *batch = FindBatch(material);
-
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
-	element->instanceMatrixBuffer = matrixBuffer;
-	element->instanceColorBuffer = colorBuffer;
-	element->list = batchList;
-
-	_AddElementToBatch( element, batch );
+	AddInstanceBatch( material, nullptr, matrixBuffer, colorBuffer, batchList, values, options );
 }
 
 void
@@ -511,24 +576,15 @@ vsRenderQueueStage::AddInstanceBatch( vsMaterial *material, vsVertexArrayObject
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->vao = vao;
-	element->instanceMatrixBuffer = matrixBuffer;
-	element->instanceColorBuffer = colorBuffer;
 	element->list = batchList;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->shaderValues = values;
+	overrides->shaderOptions = options;
+	overrides->instanceMatrixBuffer = matrixBuffer;
+	overrides->instanceColorBuffer = colorBuffer;
 }
 
 void
@@ -536,74 +592,36 @@ vsRenderQueueStage::AddInstanceBatch( vsMaterial *material, const vsMatrix4x4 *m
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
-	element->instanceMatrixCount = matrixCount;
-	element->instanceMatrix = matrix;
-	element->instanceColor = color;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->list = batchList;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->shaderValues = values;
+	overrides->shaderOptions = options;
+	overrides->instanceMatrixCount = matrixCount;
+	overrides->instanceMatrix = matrix;
+	overrides->instanceColor = color;
 }
+
 void
 vsRenderQueueStage::AddSimpleInstanceBatch( vsMaterial *material, const vsMatrix4x4 *matrix, int matrixCount, vsRenderBuffer *vbo, vsRenderBuffer *ibo, vsFragment::SimpleType simpleType )
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->instanceMatrixCount = matrixCount;
-	element->instanceMatrix = matrix;
-	element->instanceMatrixBuffer = nullptr;
-	element->instanceColorBuffer = nullptr;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->vbo = vbo;
 	element->ibo = ibo;
 	element->simpleType = simpleType;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->instanceMatrixCount = matrixCount;
+	overrides->instanceMatrix = matrix;
 }
 
 void
 vsRenderQueueStage::AddSimpleInstanceBatch( vsMaterial *material, vsRenderBuffer *matrixBuffer, vsRenderBuffer *colorBuffer, vsRenderBuffer *vbo, vsRenderBuffer *ibo, vsFragment::SimpleType simpleType, vsShaderValues *values, vsShaderOptions *options )
 {
-	Batch *batch = FindBatch(material);
-
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
-	element->instanceMatrixBuffer = matrixBuffer;
-	element->instanceColorBuffer = colorBuffer;
-	element->vbo = vbo;
-	element->ibo = ibo;
-	element->simpleType = simpleType;
-
-	_AddElementToBatch( element, batch );
+	AddSimpleInstanceBatch( material, nullptr, matrixBuffer, colorBuffer, vbo, ibo, simpleType, values, options );
 }
 
 void
@@ -611,26 +629,17 @@ vsRenderQueueStage::AddSimpleInstanceBatch( vsMaterial *material, vsVertexArrayO
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
-	element->instanceMatrixBuffer = matrixBuffer;
-	element->instanceColorBuffer = colorBuffer;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->vao = vao;
 	element->vbo = vbo;
 	element->ibo = ibo;
 	element->simpleType = simpleType;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->shaderValues = values;
+	overrides->shaderOptions = options;
+	overrides->instanceMatrixBuffer = matrixBuffer;
+	overrides->instanceColorBuffer = colorBuffer;
 }
 
 void
@@ -638,26 +647,17 @@ vsRenderQueueStage::AddSimpleInstanceBatch( vsMaterial *material, const vsMatrix
 {
 	Batch *batch = FindBatch(material);
 
-	if ( !m_batchElementPool )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = element->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->shaderValues = values;
-	element->shaderOptions = options;
-	element->instanceMatrixCount = matrixCount;
-	element->instanceMatrix = matrix;
-	element->instanceColor = color;
+	BatchElement *element = NewElement( batch, material, nullptr );
 	element->vbo = vbo;
 	element->ibo = ibo;
 	element->simpleType = simpleType;
 
-	_AddElementToBatch( element, batch );
+	BatchElementOverrides *overrides = Overrides(element);
+	overrides->shaderValues = values;
+	overrides->shaderOptions = options;
+	overrides->instanceMatrixCount = matrixCount;
+	overrides->instanceMatrix = matrix;
+	overrides->instanceColor = color;
 }
 
 vsDisplayList *
@@ -665,42 +665,88 @@ vsRenderQueueStage::MakeTemporaryBatchList( vsMaterial *material, const vsMatrix
 {
 	Batch *batch = FindBatch(material);
 
-	if ( m_batchElementPool == nullptr )
-	{
-		m_batchElementPool = new BatchElement;
-	}
-	BatchElement *element = m_batchElementPool;
-	m_batchElementPool = m_batchElementPool->next;
-	element->next = nullptr;
-	element->Clear();
-
-	element->material = material;
-	element->matrix = matrix;
-	element->list = new vsDisplayList(size);
+	BatchElement *element = NewElement( batch, material, &matrix );
 
-	_AddElementToBatch( element, batch );
+	vsFrameArena *arena = vsFrameArena::Instance();
+	// Display list ops need to start four-byte aligned.
+	vsStore *store = arena->New<vsStore>( (char*)arena->Alloc(size), size );
+	store->Clear();
+	element->list = arena->New<vsDisplayList>( *store );
 	m_temporaryLists.AddItem(element->list);
 
 	return element->list;
 }
 
 void
-vsRenderQueueStage::StartRender()
+vsRenderQueueStage::SortElementsByDepth( Batch *batch )
 {
-	m_batchCount = 0;
-	vsAssert( m_batch == nullptr, "Batches not cleared?" );
-	//	m_batch = nullptr;
+	PROFILE("RenderQueueStage::SortElementsByDepth");
+
+	int count = batch->elementCount;
+	if ( count < 2 )
+		return;
+
+	vsFrameArena *arena = vsFrameArena::Instance();
+	uint32_t *key = arena->Alloc<uint32_t>( count * 2 );
+	int *index = arena->Alloc<int>( count * 2 );
+
+	// An element's depth is the view space z of its origin.  We work those
+	// out for the whole batch at once here, rather than as each element is
+	// added.
+	vsVector3D *position = arena->Alloc<vsVector3D>( count );
+	for ( int i = 0; i < count; i++ )
+	{
+		int matrixIndex = batch->element[i].matrixIndex;
+		position[i] = ( matrixIndex >= 0 ) ? vsVector3D( m_matrices[matrixIndex].w ) : vsVector3D::Zero;
+	}
+	m_worldToView.ApplyTo( position, position, count );
+
+	for ( int i = 0; i < count; i++ )
+	{
+		key[i] = DescendingSortKey( position[i].z );
+		index[i] = i;
+	}
+
+	// The sort is stable, so elements at equal depths keep drawing in the
+	// order they were submitted.
+	int *sorted = RadixSort( key, index, key + count, index + count, count );
+
+	BatchElement *element = arena->Alloc<BatchElement>( count );
+	for ( int i = 0; i < count; i++ )
+		element[i] = batch->element[ sorted[i] ];
 
+	batch->element = element;
+	batch->elementCapacity = count;
+}
+
+void
+vsRenderQueueStage::StartRender( bool deferMerging )
+{
+	vsAssert( m_batches.IsEmpty(), "Batches not cleared?" );
+	m_deferMerging = deferMerging;
 
 }
 
 void
 vsRenderQueueStage::Draw( vsDisplayList *list )
 {
-	for (Batch *b = m_batch; b; b = b->next)
+	SortBatches();
+
+	int drawCount = 0;
+	for ( int i = 0; i < m_batches.ItemCount(); i++ )
 	{
-		for (BatchElement *e = b->elementList; e; e = e->next)
+		Batch *b = m_batches[i];
+		drawCount += b->elementCount;
+		if ( b->material->m_zSort )
+			SortElementsByDepth( b );
+
+		// zSort batches draw in the back-to-front order we just sorted them
+		// into.  Everything else draws most-recently-submitted first.
+		bool backwards = !b->material->m_zSort;
+		for ( int j = 0; j < b->elementCount; j++ )
 		{
+			BatchElement *e = &b->element[ backwards ? b->elementCount-1-j : j ];
+			BatchElementOverrides *o = e->overrides;
 			list->SetMaterial( e->material );
 			if ( e->batch )
 			{
@@ -715,26 +761,28 @@ vsRenderQueueStage::Draw( vsDisplayList *list )
 				else
 					list->ClearVertexArrayObject();
 
-				if ( e->instanceMatrixBuffer )
-					list->SetMatrices4x4Buffer( e->instanceMatrixBuffer );
-				else if ( e->instanceMatrix )
-					list->SetMatrices4x4( e->instanceMatrix, e->instanceMatrixCount );
+				if ( o && o->instanceMatrixBuffer )
+					list->SetMatrices4x4Buffer( o->instanceMatrixBuffer );
+				else if ( o && o->instanceMatrix )
+					list->SetMatrices4x4( o->instanceMatrix, o->instanceMatrixCount );
+				else if ( e->matrixIndex >= 0 )
+					list->SetMatrix4x4( m_matrices[e->matrixIndex] );
 				else
-					list->SetMatrix4x4( e->matrix );
+					list->SetMatrix4x4( vsMatrix4x4::Identity );
 
 				// We need to set shader values even if it's nullptr, to remove whatever
 				// shader values object was last used.  If we were smart we would
 				// remember what went in last so we weren't re-setting nullptrs, but
 				// maybe I'll leave that as a [TODO] rather than worrying about it
 				// riht now while I'm working on shader options.  -- Trevor 24/6/2020
-				if ( e->shaderValues )
-					list->SetShaderValues( e->shaderValues );
-				if ( e->shaderOptions )
-					list->PushShaderOptions( *e->shaderOptions );
-				if ( e->instanceColorBuffer )
-					list->SetColorsBuffer( e->instanceColorBuffer );
-				else if ( e->instanceColor )
-					list->SetColors( e->instanceColor, e->instanceMatrixCount );
+				if ( o && o->shaderValues )
+					list->SetShaderValues( o->shaderValues );
+				if ( o && o->shaderOptions )
+					list->PushShaderOptions( *o->shaderOptions );
+				if ( o && o->instanceColorBuffer )
+					list->SetColorsBuffer( o->instanceColorBuffer );
+				else if ( o && o->instanceColor )
+					list->SetColors( o->instanceColor, o->instanceMatrixCount );
 
 				if ( e->list )
 					list->Append( *e->list );
@@ -755,46 +803,82 @@ vsRenderQueueStage::Draw( vsDisplayList *list )
 				}
 				list->ClearArrays();
 
-				if ( e->shaderOptions )
+				if ( o && o->shaderOptions )
 					list->PopShaderOptions();
-				if ( e->shaderValues )
+				if ( o && o->shaderValues )
 					list->ClearShaderValues();
 				list->PopTransform();
 			}
 		}
 	}
+
+	vsDynamicBatchManager::Instance()->CountDrawCalls( drawCount );
 }
 
 void
 vsRenderQueueStage::EndRender()
 {
-	m_batchCount = 0;
-	Batch *last = nullptr;
-	for (Batch *b = m_batch; b; b = b->next)
+	m_batches.Clear();
+	m_matrices.Clear();
+
+	// The arena doesn't run destructors, so tear down our temporary lists
+	// (and the stores they were writing into) by hand.
+	for ( int i = 0; i < m_temporaryLists.ItemCount(); i++ )
 	{
-		last = b;
-		BatchElement *lastElement = b->elementList;
-		while ( lastElement->next )
-		{
-			lastElement->instanceMatrix = nullptr;
-			lastElement->instanceMatrixCount = 0;
-			lastElement = lastElement->next;
-		}
-		lastElement->instanceMatrix = nullptr;
-		lastElement->instanceMatrixCount = 0;
-		lastElement->next = m_batchElementPool;
-		m_batchElementPool = b->elementList;
-		b->elementList = nullptr;
+		vsDisplayList *list = m_temporaryLists[i];
+		vsStore *store = list->GetFifo();
+		list->~vsDisplayList();
+		store->~vsStore();
 	}
-	if ( last )
+	m_temporaryLists.Clear();
+	m_batchMap->Clear();
+}
+
+void
+vsRenderQueueStage::Merge( vsRenderQueueStage &other )
+{
+	PROFILE("RenderQueueStage::Merge");
+
+	vsAssert( other.m_deferMerging, "Merging a stage which has already done its own dynamic batching" );
+
+	// Walk the other stage's batches in the order they were created, so that
+	// new batches land in our m_batches in a deterministic order too.
+	for ( int i = 0; i < other.m_batches.ItemCount(); i++ )
 	{
-		last->next = m_batchPool;
-		m_batchPool = m_batch;
+		Batch *from = other.m_batches[i];
+		Batch *to = FindBatch( from->material );
+
+		for ( int j = 0; j < from->elementCount; j++ )
+		{
+			const BatchElement &e = from->element[j];
+			const vsMatrix4x4 &matrix = ( e.matrixIndex >= 0 ) ? other.m_matrices[e.matrixIndex] : vsMatrix4x4::Identity;
+
+			// 'other' left its simple batches unmerged, so run them through
+			// AddSimpleBatch() here, in order, on this thread.  They merge
+			// exactly as they would have if they'd been added to us directly,
+			// and the dynamic batches they use are claimed in the same order
+			// however many threads built the segments.
+			if ( e.vbo && !e.list && !e.batch && !e.overrides )
+			{
+				AddSimpleBatch( e.material, e.vao, matrix, e.vbo, e.ibo, e.simpleType );
+				continue;
+			}
+
+			ReserveElements( to, to->elementCount+1 );
+			BatchElement *element = &to->element[ to->elementCount++ ];
+			*element = e;
+			if ( e.matrixIndex >= 0 )
+			{
+				element->matrixIndex = m_matrices.ItemCount();
+				m_matrices.AddItem( matrix );
+			}
+		}
 	}
-	m_batch = nullptr;
 
-	m_temporaryLists.Clear();
-	m_batchMap->map.clear();
+	// Temporary lists are now ours to tear down.
+	for ( int i = 0; i < other.m_temporaryLists.ItemCount(); i++ )
+		m_temporaryLists.AddItem( other.m_temporaryLists[i] );
+	other.m_temporaryLists.Clear();
 }
 
 vsRenderQueue::vsRenderQueue():
@@ -858,6 +942,48 @@ vsRenderQueue::StartRender( const vsMatrix4x4& projection, const vsMatrix4x4& wo
 	m_genericList->Clear();
 }
 
+void
+vsRenderQueue::StartSegment( vsRenderQueue *parent )
+{
+	vsAssert( !m_rendering, "vsRenderQueue::StartSegment called when already in the middle of a render" );
+	vsAssert( parent->m_rendering, "vsRenderQueue::StartSegment called with a parent which isn't rendering" );
+	m_rendering = true;
+
+	m_materialHideFlags = parent->m_materialHideFlags;
+	m_scene = parent->m_scene;
+	m_screenBox = parent->m_screenBox;
+	m_pixelX = parent->m_pixelX;
+	m_pixelY = parent->m_pixelY;
+	m_projection = parent->m_projection;
+	m_worldToView = parent->m_worldToView;
+	m_fov = parent->m_fov;
+	m_transformStack[0] = parent->GetMatrix();
+	m_transformStackLevel = 1;
+
+	for ( int i = 0; i < m_stageCount; i++ )
+	{
+		m_stage[i].SetWorldToView( m_worldToView );
+		m_stage[i].StartRender( true );
+	}
+	m_genericList->Clear();
+}
+
+void
+vsRenderQueue::MergeSegment( vsRenderQueue *segment )
+{
+	PROFILE("RenderQueue::MergeSegment");
+	vsAssert( segment->m_transformStackLevel == 1, "Unbalanced push/pop of transforms in render queue segment?");
+
+	for ( int i = 0; i < m_stageCount; i++ )
+	{
+		m_stage[i].Merge( segment->m_stage[i] );
+	}
+	m_genericList->Append( *segment->m_genericList );
+
+	segment->DeinitialiseTransformStack();
+	segment->EndRender();
+}
+
 void
 vsRenderQueue::Draw( vsDisplayList *list )
 {
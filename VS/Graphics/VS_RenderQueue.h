@@ -69,6 +69,17 @@ public:
 	void			Draw( vsDisplayList *list );	// write our queue contents into here.  Called internally.
 	void			EndRender();
 
+	// Segments let several threads build parts of a single render queue at
+	// once (see vsParallelDraw).  StartSegment() begins a render which draws
+	// with 'parent's current settings and matrix, and MergeSegment() appends a
+	// segment's contents onto ours and ends its render.  Merging segments in a
+	// fixed order produces the same queue as drawing their contents into us
+	// directly;  segments don't do dynamic batching themselves, so that
+	// simple batches merge across segment boundaries just as they would have
+	// without segments.
+	void			StartSegment( vsRenderQueue *parent );
+	void			MergeSegment( vsRenderQueue *segment );
+
 	void SetPixelDimensions( int width, int height ) { m_pixelX = width; m_pixelY = height; }
 	int GetPixelsX() { return m_pixelX; }
 	int GetPixelsY() { return m_pixelY; }
@@ -10,6 +10,7 @@
 #include "VS_TextureManager.h"
 #include "VS_Color.h"
 #include "VS_OpenGL.h"
+#include "VS_Renderer.h"
 #include "VS_RendererState.h"
 #include "VS_GraphicsMemoryProfiler.h"
 #include "VS_Thread.h"
@@ -139,6 +140,8 @@ vsRenderTarget::~vsRenderTarget()
 	vsDelete( m_textureSurface );
 	vsDelete( m_renderBufferSurface );
 	m_bufferCount = 0;
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 vsTexture*
@@ -159,7 +162,7 @@ vsRenderTarget::ResolveDepth()
 
 	if ( m_needsDepthResolve )
 	{
-		if ( m_renderBufferSurface )
+		if ( m_renderBufferSurface && !vsRenderer::IsHeadless() )
 		{
 			vsRendererStateBlock backup = vsRendererState::Instance()->StateBlock();
 
@@ -205,6 +208,9 @@ vsRenderTarget::Resolve(int id)
 	vsAssert(m_bufferCount > 0, "vsRenderTarget::Resolve called with <= 0 bufferCount?" );
 	vsAssert(m_texture, "No texture array??");
 
+	if ( m_needsResolve & BIT(id) && vsRenderer::IsHeadless() )
+		m_needsResolve &= ~BIT(id);
+
 	if ( m_needsResolve & BIT(id) )
 	{
 		if ( m_renderBufferSurface )
@@ -283,6 +289,8 @@ vsRenderTarget::Bind()
 {
 	// somebody's going to draw into us, mark us as needing to be resolved.
 	CreateDeferred();
+	if ( vsRenderer::IsHeadless() )
+		return;
 
 	GL_CHECK_SCOPED("vsRenderTarget::Bind");
 	if ( m_renderBufferSurface )
@@ -317,6 +325,11 @@ vsRenderTarget::Clear()
 	vsAssert( vsThread::IsMainThread(), "Should only get into here on the main thread." );
 
 	Bind();
+	if ( vsRenderer::IsHeadless() )
+	{
+		InvalidateResolve();
+		return;
+	}
 	GL_CHECK_SCOPED("vsRenderTarget::Clear");
 
 	GLbitfield bits = GL_COLOR_BUFFER_BIT;
@@ -341,6 +354,11 @@ void
 vsRenderTarget::ClearColor( const vsColor&c )
 {
 	Bind();
+	if ( vsRenderer::IsHeadless() )
+	{
+		InvalidateResolve();
+		return;
+	}
 	GL_CHECK_SCOPED("vsRenderTarget::ClearColor");
 
 	GLbitfield bits = GL_COLOR_BUFFER_BIT;
@@ -379,6 +397,8 @@ vsRenderTarget::BlitRect( vsRenderTarget *other, const vsBox2D& src, const vsBox
 {
 	CreateDeferred();
 	other->CreateDeferred();
+	if ( vsRenderer::IsHeadless() )
+		return;
 
 	for ( int i = 0; i < vsMin( m_bufferCount, other->m_bufferCount ); i++ )
 		Resolve(i);
@@ -570,6 +590,12 @@ vsSurface::~vsSurface()
 	else
 		vsGraphicsMemoryProfiler::Remove( vsGraphicsMemoryProfiler::Type_RenderTarget, pixels * bytesPerPixel );
 
+	if ( vsRenderer::IsHeadless() )
+	{
+		vsDeleteArray(m_texture);
+		return;
+	}
+
 	GL_CHECK_SCOPED("vsSurface destructor");
 	for ( int i = 0; i < m_textureCount; i++ )
 	{
@@ -757,6 +783,15 @@ vsSurface::Resize( int width, int height )
 	else
 		vsGraphicsMemoryProfiler::Add( vsGraphicsMemoryProfiler::Type_RenderTarget, bytesPerPixel * (pixelsAfter - pixelsBefore) );
 
+	if ( vsRenderer::IsHeadless() )
+	{
+		// No GPU surfaces to make;  just keep track of our size.
+		for ( int i = 0; i < m_textureCount; i++ )
+			m_texture[i] = 0;
+		m_stencil = m_settings.stencil;
+		return;
+	}
+
 	if ( m_fbo != 0 )
 	{
 		for ( int i = 0; i < m_textureCount; i++ )
@@ -8,8 +8,11 @@
  */
 
 #include "VS_Renderer.h"
+#include "VS_Shader.h"
+#include "VS_ShaderVariant.h"
 
 vsRenderer*  vsRenderer::s_instance = nullptr;
+bool vsRenderer::s_headless = false;
 
 vsRenderer::Settings::Settings():
 	shaderSuite(nullptr),
@@ -27,10 +30,14 @@ vsRenderer::vsRenderer(int width, int height, int depth, int flags):
 	m_height(height),
 	m_viewportWidth(width),
 	m_viewportHeight(height),
-	m_refreshRate(60)
+	m_refreshRate(60),
+	m_uniformUploads(0),
+	m_uniformUploadsSkipped(0),
+	m_rendererUniformsGeneration(0)
 {
 	vsAssert(s_instance == nullptr, "Duplicate vsRenderer instance?");
 	s_instance = this;
+	RendererUniformsChanged();
 }
 
 vsRenderer::~vsRenderer()
@@ -38,3 +45,14 @@ vsRenderer::~vsRenderer()
 	s_instance = nullptr;
 }
 
+void
+vsRenderer::FinishFrameUniformStats()
+{
+	vsShaderVariant::ConsumeUniformStats( &m_uniformUploads, &m_uniformUploadsSkipped );
+}
+
+void
+vsRenderer::RendererUniformsChanged()
+{
+	m_rendererUniformsGeneration = vsShader::NextRendererUniformsGeneration();
+}
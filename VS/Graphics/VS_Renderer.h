@@ -26,6 +26,7 @@ class vsOverlay;
 class vsRenderBuffer;
 class vsShader;
 class vsShaderSuite;
+class vsShaderVariant;
 class vsTransform2D;
 class vsVector2D;
 struct SDL_Surface;
@@ -48,6 +49,7 @@ public:
 	};
 
 	static vsRenderer*  s_instance;
+	static bool			s_headless;
 	Settings			m_currentSettings;
 
 	// m_width, m_viewportWidth, m_height, and m_viewportHeight are the
@@ -69,9 +71,32 @@ public:
 	// minimum of 1fps.
 	int					m_refreshRate;
 
+protected:
+
+	int					m_uniformUploads;
+	int					m_uniformUploadsSkipped;
+
+	// Tags the current values of the renderer's own shader uniforms (fog,
+	// camera, projection, viewport, and lights);  see
+	// vsShader::NeedsRendererUniforms().  Call RendererUniformsChanged()
+	// whenever any of them might have changed.
+	uint32_t			m_rendererUniformsGeneration;
+	void				RendererUniformsChanged();
+
+	// Called by each renderer at the end of a frame, to collect the frame's
+	// uniform counts from the shaders.
+	void				FinishFrameUniformStats();
+
 public:
 
 	static vsRenderer* Instance() { return s_instance; }
+
+	// Are we running without a GPU?  (See vsRenderer_Recording)  Code which
+	// talks to OpenGL directly should check this and skip its GL calls, while
+	// still doing any CPU-side bookkeeping.
+	static bool IsHeadless() { return s_headless; }
+	static void SetHeadless( bool headless ) { s_headless = headless; }
+
 	enum
 	{
 		Flag_Fullscreen = BIT(0),
@@ -118,6 +143,26 @@ public:
 
 	const Settings& GetCurrentSettings() const { return m_currentSettings; }
 
+	virtual vsShader*	DefaultShaderFor( vsMaterialInternal *mat ) = 0;
+
+	// Called by vsRenderBuffer whenever it sends data to the GPU.
+	virtual void	NotifyBufferUploaded( int bytes ) {}
+
+	// Called by shaders when headless, in place of each glUniform call.
+	// 'uniform' is an index into the shader variant's uniforms.
+	virtual void	NotifyUniformUploaded( const vsShaderVariant *variant, int uniform ) {}
+
+	// Called by buffers, textures, shaders, render targets and so on as
+	// they're destroyed, so that a renderer can forget anything it was
+	// remembering about them.  May be called from any thread.
+	virtual void	NotifyResourceDestroyed( const void *resource ) {}
+
+	// How many uniform values the shaders sent to the GPU during the last
+	// frame, and how many they skipped sending because the GPU already had
+	// those values.
+	int		GetUniformUploads() const { return m_uniformUploads; }
+	int		GetUniformUploadsSkipped() const { return m_uniformUploadsSkipped; }
+
 	virtual vsImage*	Screenshot() = 0;
 	virtual vsImage*	Screenshot_Async() = 0;
 	virtual vsImage*	ScreenshotBack() = 0;
@@ -310,10 +310,6 @@ static void printAttributes ()
 vsRenderer_OpenGL3::vsRenderer_OpenGL3(int width, int height, int depth, int flags, int bufferCount):
 	vsRenderer(width, height, depth, flags),
 	m_flags(flags),
-	m_currentLocalToWorld(nullptr),
-	m_currentLocalToWorldBuffer(nullptr),
-	m_currentColors(nullptr),
-	m_currentColorsBuffer(nullptr),
 	m_window(nullptr),
 	m_scene(nullptr),
 	m_currentRenderTarget(nullptr),
@@ -322,15 +318,6 @@ vsRenderer_OpenGL3::vsRenderer_OpenGL3(int width, int height, int depth, int fla
 	m_currentMaterial(nullptr),
 	m_currentMaterialInternal(nullptr),
 	m_currentShader(nullptr),
-	m_currentShaderValues(nullptr),
-	m_currentVertexArray(nullptr),
-	m_currentNormalArray(nullptr),
-	m_currentTexelArray(nullptr),
-	m_currentColorArray(nullptr),
-	m_currentVertexBuffer(nullptr),
-	m_currentNormalBuffer(nullptr),
-	m_currentTexelBuffer(nullptr),
-	m_currentColorBuffer(nullptr),
 	m_lastShaderId(0),
 	m_bufferCount(bufferCount)
 {
@@ -818,6 +805,7 @@ vsRenderer_OpenGL3::ResizeRenderTargetsToMatchWindow()
 			vsVector2D::Zero,
 			vsVector2D( m_widthPixels, m_heightPixels )
 			);
+	RendererUniformsChanged();
 }
 
 bool
@@ -1101,6 +1089,7 @@ vsRenderer_OpenGL3::Present()
 	// }
 
 	vsDynamicBatchManager::Instance()->FrameRendered();
+	FinishFrameUniformStats();
 
 }
 
@@ -1291,7 +1280,6 @@ vsRenderer_OpenGL3::FlushRenderState()
 
 		{
 			PROFILE_GL("ShaderValues");
-			m_currentShader->SetFog( m_currentMaterialInternal->m_fog, m_currentFogColor, m_currentFogDensity );
 			m_currentShader->SetTextures( m_currentMaterialInternal->m_texture );
 			if ( m_currentLocalToWorldBuffer )
 				m_currentShader->SetLocalToWorld( m_currentVAO, m_currentLocalToWorldBuffer );
@@ -1316,16 +1304,20 @@ vsRenderer_OpenGL3::FlushRenderState()
 				m_currentShader->SetInstanceColors( m_currentVAO, m_currentColors, m_currentLocalToWorldCount );
 			else
 				m_currentShader->SetInstanceColors( m_currentVAO, &c_white, 1 );
-			m_currentShader->SetWorldToView( m_currentWorldToView );
-			m_currentShader->SetViewToProjection( m_currentViewToProjection );
-			m_currentShader->SetViewport( m_currentViewportPixels.Extents() );
-			int i = 0;
-			// for ( int i = 0; i < MAX_LIGHTS; i++ )
+			if ( m_currentShader->NeedsRendererUniforms( m_rendererUniformsGeneration ) )
 			{
-				vsVector3D halfVector;
-				m_currentShader->SetLight( i, m_lightStatus[i].ambient, m_lightStatus[i].diffuse,
-						m_lightStatus[i].specular, m_lightStatus[i].position,
-						halfVector);
+				m_currentShader->SetFog( m_currentMaterialInternal->m_fog, m_currentFogColor, m_currentFogDensity );
+				m_currentShader->SetWorldToView( m_currentWorldToView );
+				m_currentShader->SetViewToProjection( m_currentViewToProjection );
+				m_currentShader->SetViewport( m_currentViewportPixels.Extents() );
+				int i = 0;
+				// for ( int i = 0; i < MAX_LIGHTS; i++ )
+				{
+					vsVector3D halfVector;
+					m_currentShader->SetLight( i, m_lightStatus[i].ambient, m_lightStatus[i].diffuse,
+							m_lightStatus[i].specular, m_lightStatus[i].position,
+							halfVector);
+				}
 			}
 			m_currentShader->ValidateCache( m_currentMaterial );
 		}
@@ -1372,7 +1364,8 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 #endif // VS_TRACY
 	m_currentCameraPosition = vsVector3D::Zero;
 
-	vsDisplayList::op *op = list->PopOp();
+	vsDisplayList::Iterator ops = list->GetOps();
+	vsDisplayList::OpView op = ops.Next();
 	//vsVector3D	cursorPos;
 	//vsColor		cursorColor;
 	//vsColor		currentColor(-1,-1,-1,0);
@@ -1387,18 +1380,18 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 	//bool		usingVertexArray = false;
 	// ClearState();
 
-	while(op)
+	while( op.IsValid() )
 	{
 		GL_CHECK("ProcOp");
 // #define LOG_OPS
 #ifdef LOG_OPS
-		vsLog("%s", vsDisplayList::GetOpCodeString(op->type).c_str());
+		vsLog("%s", vsDisplayList::GetOpCodeString(op.GetType()).c_str());
 #endif // LOG_OPS
-		switch( op->type )
+		switch( op.GetType() )
 		{
 			case vsDisplayList::OpCode_SetVertexArrayObject:
 				{
-					m_nextVAO = (vsVertexArrayObject*)op->data.p;
+					m_nextVAO = op.GetPointer<vsVertexArrayObject>();
 					if ( m_nextVAO != m_currentVAO )
 					{
 						m_currentVAO->Exit();
@@ -1426,36 +1419,15 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				}
 			case vsDisplayList::OpCode_SetLinear:
 				{
-					if ( op->data.i )
+					if ( op.Get<uint32_t>() )
 						glEnable( GL_FRAMEBUFFER_SRGB );
 					else
 						glDisable( GL_FRAMEBUFFER_SRGB );
 					break;
 				}
-			case vsDisplayList::OpCode_SetColor:
-				{
-					m_currentColor = op->data.GetColor();
-					m_currentColors = nullptr;
-					m_currentColorsBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetColors:
-				{
-					// m_currentColor = c_white;
-					m_currentColors = (vsColor*)op->data.p;
-					m_currentColorsBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetColorsBuffer:
-				{
-					// m_currentColor = c_white;
-					m_currentColors = nullptr;
-					m_currentColorsBuffer = (vsRenderBuffer*)op->data.p;
-					break;
-				}
 			case vsDisplayList::OpCode_SetMaterial:
 				{
-					vsMaterial *material = (vsMaterial *)op->data.p;
+					vsMaterial *material = op.GetPointer<vsMaterial>();
 					vsAssert(material, "SetMaterial called with no material?");
 					if ( m_currentMaterialInternal != material->GetResource() )
 					{
@@ -1477,7 +1449,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 			case vsDisplayList::OpCode_SetRenderTarget:
 				{
 					PROFILE_GL("SetRenderTarget");
-					vsRenderTarget *target = (vsRenderTarget*)op->data.p;
+					vsRenderTarget *target = op.GetPointer<vsRenderTarget>();
 					SetRenderTarget(target);
 					break;
 				}
@@ -1500,7 +1472,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					m_state.SetBool( vsRendererState::Bool_DepthMask, true ); // when we're clearing a render target, make sure we're writing to depth!
 					m_state.SetBool( vsRendererState::Bool_StencilTest, true ); // when we're clearing a render target, make sure we're not testing stencil bits!
 					m_state.Flush();
-					m_currentRenderTarget->ClearColor( op->data.color );
+					m_currentRenderTarget->ClearColor( op.Get<vsColor>() );
 					break;
 				};
 				// case vsDisplayList::OpCode_ResolveRenderTarget:
@@ -1509,7 +1481,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				// 		// Since resolving a render target can involve a blit,
 				// 		// flush render state first.
 				// 		m_state.Flush();
-				// 		// vsRenderTarget *target = (vsRenderTarget*)op->data.p;
+				// 		// vsRenderTarget *target = op.GetPointer<vsRenderTarget>();
 				// 		// if ( target )
 				// 		// 	target->Resolve();
 				// 		// else // nullptr target means main render target.
@@ -1520,8 +1492,8 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE_GL("Blit");
 					m_state.Flush(); // flush our renderer state before blitting!
-					vsRenderTarget *from = (vsRenderTarget*)op->data.p;
-					vsRenderTarget *to = (vsRenderTarget*)op->data.p2;
+					vsRenderTarget *from = op.GetPointer<vsRenderTarget>(0);
+					vsRenderTarget *to = op.GetPointer<vsRenderTarget>(1);
 					from->BlitTo(to);
 					to->InvalidateResolve();
 					break;
@@ -1530,270 +1502,73 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE_GL("Blit");
 					m_state.Flush(); // flush our renderer state before blitting!
-					vsRenderTarget *from = (vsRenderTarget*)op->data.p;
-					vsRenderTarget *to = (vsRenderTarget*)op->data.p2;
-					vsBox2D fromRect = op->data.box2D;
-					vsBox2D toRect = op->data.box2D2;
+					vsRenderTarget *from = op.GetPointer<vsRenderTarget>(0);
+					vsRenderTarget *to = op.GetPointer<vsRenderTarget>(1);
+					const vsBox2D& fromRect = op.Get<vsBox2D>( 2 * sizeof(void*) );
+					const vsBox2D& toRect = op.Get<vsBox2D>( 2 * sizeof(void*) + sizeof(vsBox2D) );
 					from->BlitRect(to, fromRect, toRect);
 					to->InvalidateResolve();
 
-					break;
-				}
-			case vsDisplayList::OpCode_PushTransform:
-				{
-					vsTransform2D t = op->data.GetTransform();
-
-					vsMatrix4x4 localToWorld = m_transformStack[m_currentTransformStackLevel] * t.GetMatrix();
-					m_transformStack[++m_currentTransformStackLevel] = localToWorld;
-
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_PushTranslation:
-				{
-					vsVector3D &v = op->data.vector;
-
-					vsMatrix4x4 m;
-					m.SetTranslation(v);
-					vsMatrix4x4 localToWorld = m_transformStack[m_currentTransformStackLevel] * m;
-					m_transformStack[++m_currentTransformStackLevel] = localToWorld;
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_PushMatrix4x4:
-				{
-					vsMatrix4x4 m = op->data.GetMatrix4x4();
-					vsMatrix4x4 localToWorld = m_transformStack[m_currentTransformStackLevel] * m;
-					m_transformStack[++m_currentTransformStackLevel] = localToWorld;
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetMatrix4x4:
-				{
-					const vsMatrix4x4& m = op->data.matrix4x4;
-					m_transformStack[++m_currentTransformStackLevel] = m;
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetMatrices4x4:
-				{
-					vsMatrix4x4 *m = (vsMatrix4x4*)op->data.p;
-					int count = op->data.i;
-					m_transformStack[++m_currentTransformStackLevel] = m[0];
-					m_currentLocalToWorld = m;
-					m_currentLocalToWorldCount = count;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetMatrices4x4Buffer:
-				{
-					vsRenderBuffer *b = (vsRenderBuffer*)op->data.p;
-					m_transformStack[++m_currentTransformStackLevel] = vsMatrix4x4::Identity;
-					m_currentLocalToWorld = nullptr;
-					m_currentLocalToWorldCount = b->GetActiveMatrix4x4ArraySize();
-					m_currentLocalToWorldBuffer = b;
-					break;
-				}
-			case vsDisplayList::OpCode_SetShaderValues:
-				{
-					vsShaderValues *sv = (vsShaderValues*)op->data.p;
-					m_currentShaderValues = sv;
-					break;
-				}
-			case vsDisplayList::OpCode_ClearShaderValues:
-				{
-					m_currentShaderValues = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_PushShaderOptions:
-				{
-					m_optionsStack.AddItem( op->data.shaderOptions );
-					break;
-				}
-			case vsDisplayList::OpCode_PopShaderOptions:
-				{
-					m_optionsStack.SetArraySize( m_optionsStack.ItemCount() - 1 );
-					break;
-				}
-			case vsDisplayList::OpCode_SnapMatrix:
-				{
-					vsMatrix4x4 m = m_transformStack[m_currentTransformStackLevel];
-					vsVector4D &t = m.w;
-					t.x = (float)vsFloor(t.x + 0.5f);
-					t.y = (float)vsFloor(t.y + 0.5f);
-					t.z = (float)vsFloor(t.z + 0.5f);
-					m_transformStack[++m_currentTransformStackLevel] = m;
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
 					break;
 				}
 			case vsDisplayList::OpCode_SetWorldToViewMatrix4x4:
-				{
-					m_currentWorldToView = op->data.GetMatrix4x4();
-					break;
-				}
-			case vsDisplayList::OpCode_PopTransform:
-				{
-					vsAssert(m_currentTransformStackLevel > 0, "Renderer transform stack underflow??");
-					m_currentTransformStackLevel--;
-					m_currentLocalToWorld = &m_transformStack[m_currentTransformStackLevel];
-					m_currentLocalToWorldCount = 1;
-					m_currentLocalToWorldBuffer = nullptr;
-					break;
-				}
-			case vsDisplayList::OpCode_SetCameraTransform:
-				{
-					break;
-				}
 			case vsDisplayList::OpCode_SetProjectionMatrix4x4:
+			case vsDisplayList::OpCode_Fog:
 				{
-					vsMatrix4x4 &m = op->data.GetMatrix4x4();
-					m_currentViewToProjection = m;
-					break;
-				}
-			case vsDisplayList::OpCode_VertexArray:
-				{
-					m_currentVertexArray = (vsVector3D*)op->data.p;
-					m_currentVertexArrayCount = op->data.i;
-					m_currentVertexBuffer = nullptr;
+					ApplyStateOp( op );
+					RendererUniformsChanged();
 					break;
 				}
 			case vsDisplayList::OpCode_VertexBuffer:
 				{
-					m_currentVertexBuffer = (vsRenderBuffer *)op->data.p;
-					m_currentVertexArray = nullptr;
-					m_currentVertexArrayCount = 0;
+					ApplyStateOp( op );
 					m_currentVertexBuffer->BindVertexBuffer( m_currentVAO );
 					break;
 				}
-			case vsDisplayList::OpCode_NormalArray:
-				{
-					m_currentNormalArray = (vsVector3D*)op->data.p;
-					m_currentNormalArrayCount = op->data.i;
-					break;
-				}
 			case vsDisplayList::OpCode_NormalBuffer:
 				{
-					m_currentNormalBuffer = (vsRenderBuffer *)op->data.p;
+					ApplyStateOp( op );
 					m_currentNormalBuffer->BindNormalBuffer( m_currentVAO );
-					m_currentNormalArray = nullptr;
-					m_currentNormalArrayCount = 0;
-					break;
-				}
-			case vsDisplayList::OpCode_ClearVertexArray:
-				{
-					m_currentVertexBuffer = nullptr;
-					m_currentVertexArray = nullptr;
-					m_currentVertexArrayCount = 0;
-					break;
-				}
-			case vsDisplayList::OpCode_ClearNormalArray:
-				{
-					m_currentNormalBuffer = nullptr;
-					m_currentNormalArray = nullptr;
-					m_currentNormalArrayCount = 0;
 					break;
 				}
 			case vsDisplayList::OpCode_TexelArray:
 				{
-					m_currentTexelArray = (vsVector2D*)op->data.p;
-					m_currentTexelArrayCount = op->data.i;
-					vsRenderBuffer::BindTexelArray( m_currentVAO, op->data.p, op->data.i );
+					ApplyStateOp( op );
+					vsRenderBuffer::BindTexelArray( m_currentVAO, op.GetPayload(), m_currentTexelArrayCount );
 					break;
 				}
 			case vsDisplayList::OpCode_TexelBuffer:
 				{
-					m_currentTexelBuffer = (vsRenderBuffer *)op->data.p;
-					m_currentTexelArray = nullptr;
-					m_currentTexelArrayCount = 0;
+					ApplyStateOp( op );
 					m_currentTexelBuffer->BindTexelBuffer( m_currentVAO );
 					break;
 				}
-			case vsDisplayList::OpCode_ClearTexelArray:
-				{
-					break;
-				}
-			case vsDisplayList::OpCode_ColorArray:
-				{
-					m_currentColorArray = (vsColor*)op->data.p;
-					m_currentColorArrayCount = op->data.i;
-					break;
-				}
 			case vsDisplayList::OpCode_ColorBuffer:
 				{
-					m_currentColorBuffer = (vsRenderBuffer *)op->data.p;
+					ApplyStateOp( op );
 					m_currentColorBuffer->BindColorBuffer( m_currentVAO );
-					m_currentColorArray = 0;
-					m_currentColorArrayCount = 0;
-					break;
-				}
-			case vsDisplayList::OpCode_ClearColorArray:
-				{
-					if ( m_currentColorBuffer )
-					{
-						//m_currentColorBuffer->UnbindColorBuffer();
-						m_currentColorBuffer = nullptr;
-					}
-					m_currentColorArray = nullptr;
-					m_currentColorArrayCount = 0;
 					break;
 				}
 			case vsDisplayList::OpCode_ClearArrays:
 				{
-					m_currentColorArray = nullptr;
-					m_currentColorBuffer = nullptr;
-					m_currentColorArrayCount = 0;
-
-					m_currentTexelBuffer = nullptr;
-					m_currentTexelArray = nullptr;
-					m_currentTexelArrayCount = 0;
-
-					m_currentNormalBuffer = nullptr;
-					m_currentNormalArray = nullptr;
-					m_currentNormalArrayCount = 0;
-
-					m_currentVertexBuffer = nullptr;
-					m_currentVertexArray = nullptr;
-					m_currentVertexArrayCount = 0;
-
+					ClearArrays();
 					m_currentVAO->UnbindAll();
-
 					break;
 				}
 			case vsDisplayList::OpCode_BindBuffer:
 				{
 					PROFILE_GL("BindBuffer");
 					m_currentVAO->UnbindAll(); // this is really very wrong
-					m_currentColorArray = nullptr;
-					m_currentColorBuffer = nullptr;
-					m_currentColorArrayCount = 0;
-					m_currentTexelBuffer = nullptr;
-					m_currentTexelArray = nullptr;
-					m_currentTexelArrayCount = 0;
-					m_currentNormalBuffer = nullptr;
-					m_currentNormalArray = nullptr;
-					m_currentNormalArrayCount = 0;
-					m_currentVertexBuffer = nullptr;
-					m_currentVertexArray = nullptr;
-					m_currentVertexArrayCount = 0;
-
-					vsRenderBuffer *buffer = (vsRenderBuffer *)op->data.p;
+					ClearArrays();
+
+					vsRenderBuffer *buffer = op.GetPointer<vsRenderBuffer>();
 					buffer->Bind( m_currentVAO );
 					break;
 				}
 			case vsDisplayList::OpCode_UnbindBuffer:
 				{
 					PROFILE_GL("UnbindBuffer");
-					vsRenderBuffer *buffer = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *buffer = op.GetPointer<vsRenderBuffer>();
 					buffer->Unbind( m_currentVAO );
 					break;
 				}
@@ -1801,7 +1576,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE("LineListArray");
 					FlushRenderState();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_LINES, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_LINES, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1812,7 +1587,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE("LineStripArray");
 					FlushRenderState();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_LINE_STRIP, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_LINE_STRIP, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1825,7 +1600,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("TriangleListArray");
 					FlushRenderState();
 					m_currentVAO->Flush();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLES, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLES, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1838,7 +1613,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("TriangleStripArray");
 					FlushRenderState();
 					m_currentVAO->Flush();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLE_STRIP, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLE_STRIP, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1849,7 +1624,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE("TriangleStripBuffer");
 
-					vsRenderBuffer *ib = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *ib = op.GetPointer<vsRenderBuffer>();
 					// if ( ib->UsesPrimitiveRestart() )
 					// 	m_state.SetBool(vsRendererState::Bool_PrimitiveRestartFixedIndex,true);
 					FlushRenderState();
@@ -1868,7 +1643,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("TriangleListBuffer");
 					// PROFILE_GL("TriangleListBuffer");
 					FlushRenderState();
-					vsRenderBuffer *ib = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *ib = op.GetPointer<vsRenderBuffer>();
 					ib->TriListBuffer(m_currentVAO, m_currentLocalToWorldCount);
 #ifdef VS_TRACY
 					drawCount++;
@@ -1882,7 +1657,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 			case vsDisplayList::OpCode_TriangleFanBuffer:
 				{
 					PROFILE("TriangleFanBuffer");
-					vsRenderBuffer *ib = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *ib = op.GetPointer<vsRenderBuffer>();
 					// if ( ib->UsesPrimitiveRestart() )
 					// 	m_state.SetBool(vsRendererState::Bool_PrimitiveRestartFixedIndex,true);
 					FlushRenderState();
@@ -1900,7 +1675,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE("LineListBuffer");
 					FlushRenderState();
-					vsRenderBuffer *ib = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *ib = op.GetPointer<vsRenderBuffer>();
 					ib->LineListBuffer(m_currentVAO, m_currentLocalToWorldCount);
 #ifdef VS_TRACY
 					drawCount++;
@@ -1914,7 +1689,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 				{
 					PROFILE("LineStripBuffer");
 					FlushRenderState();
-					vsRenderBuffer *ib = (vsRenderBuffer *)op->data.p;
+					vsRenderBuffer *ib = op.GetPointer<vsRenderBuffer>();
 					ib->LineStripBuffer(m_currentVAO, m_currentLocalToWorldCount);
 #ifdef VS_TRACY
 					drawCount++;
@@ -1929,7 +1704,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("TriangleFanArray");
 					FlushRenderState();
 					m_currentVAO->Flush();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLE_FAN, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_TRIANGLE_FAN, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1941,7 +1716,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("PointsArray");
 					FlushRenderState();
 					m_currentVAO->Flush();
-					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_POINTS, op->data.p, op->data.GetUInt(), m_currentLocalToWorldCount );
+					vsRenderBuffer::DrawElementsImmediate( m_currentVAO, GL_POINTS, op.GetPayload(), op.GetArrayCount<uint16_t>(), m_currentLocalToWorldCount );
 #ifdef VS_TRACY
 					immediateDrawCount++;
 					instanceCount+= m_currentLocalToWorldCount;
@@ -1953,26 +1728,27 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 					PROFILE("Light");
 					if ( m_lightCount < MAX_LIGHTS - 1 )
 					{
-						vsLight &l = op->data.light;
-						if ( l.m_type == vsLight::Type_Ambient )
+						const vsDisplayList::LightData &l = op.Get<vsDisplayList::LightData>();
+						if ( l.type == vsLight::Type_Ambient )
 						{
 							m_lightStatus[m_lightCount].type = 1;
 						}
-						if ( l.m_type == vsLight::Type_Directional )
+						if ( l.type == vsLight::Type_Directional )
 						{
 							m_lightStatus[m_lightCount].type = 2;
-							m_lightStatus[m_lightCount].position = l.m_direction;
+							m_lightStatus[m_lightCount].position = l.direction;
 						}
-						if ( l.m_type == vsLight::Type_Point )
+						if ( l.type == vsLight::Type_Point )
 						{
 							m_lightStatus[m_lightCount].type = 3;
-							m_lightStatus[m_lightCount].position = l.m_position;
+							m_lightStatus[m_lightCount].position = l.position;
 						}
-						m_lightStatus[m_lightCount].ambient = l.m_ambient;
-						m_lightStatus[m_lightCount].diffuse = l.m_color;
-						m_lightStatus[m_lightCount].specular = l.m_specular;
+						m_lightStatus[m_lightCount].ambient = l.ambient;
+						m_lightStatus[m_lightCount].diffuse = l.color;
+						m_lightStatus[m_lightCount].specular = l.specular;
 
 						m_lightCount++;
+						RendererUniformsChanged();
 					}
 					break;
 				}
@@ -1983,43 +1759,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 						m_lightStatus[i].type = 0;
 					}
 					m_lightCount = 0;
-					break;
-				}
-			case vsDisplayList::OpCode_Fog:
-				{
-					vsColor fogColor = op->data.fog.GetColor();
-					m_currentFogColor = fogColor;
-					m_currentFogDensity = op->data.fog.GetDensity();
-					break;
-				}
-			case vsDisplayList::OpCode_ClearFog:
-				{
-#if 0
-					glFogf(GL_FOG_DENSITY, 0.f );
-#endif // 0
-					break;
-				}
-			case vsDisplayList::OpCode_FlatShading:
-				{
-					// glShadeModel( GL_FLAT );
-					break;
-				}
-			case vsDisplayList::OpCode_SmoothShading:
-				{
-					// glShadeModel( GL_SMOOTH );
-					break;
-				}
-				// Disabling 'EnableStencil' and 'DisableStencil' opcodes;  moving them to materials.
-			case vsDisplayList::OpCode_EnableStencil:
-				{
-					// m_state.SetBool( vsRendererState::Bool_StencilTest, true );
-					// glStencilFunc(GL_EQUAL, 0x1, 0x1);
-					break;
-				}
-			case vsDisplayList::OpCode_DisableStencil:
-				{
-					// m_state.SetBool( vsRendererState::Bool_StencilTest, false );
-					// glStencilFunc(GL_ALWAYS, 0x1, 0x1);
+					RendererUniformsChanged();
 					break;
 				}
 			case vsDisplayList::OpCode_ClearStencil:
@@ -2043,7 +1783,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 			case vsDisplayList::OpCode_EnableScissor:
 				{
 					m_state.SetBool( vsRendererState::Bool_ScissorTest, true );
-					const vsBox2D& box = op->data.box2D;
+					const vsBox2D& box = op.Get<vsBox2D>();
 					GLsizei x = (GLsizei)(box.GetMin().x * m_currentViewportPixels.Width());
 					GLsizei y = (GLsizei)(box.GetMin().y * m_currentViewportPixels.Height());
 					GLsizei wid = (GLsizei)(box.Width() * m_currentViewportPixels.Width());
@@ -2063,7 +1803,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 						int currentTargetWidth = m_currentRenderTarget->GetViewportWidth();
 						int currentTargetHeight = m_currentRenderTarget->GetViewportHeight();
 
-						const vsBox2D& box = op->data.box2D;
+						const vsBox2D& box = op.Get<vsBox2D>();
 						m_currentViewportPixels.Set(
 								vsVector2D( box.GetMin().x * currentTargetWidth, box.GetMin().y * currentTargetHeight ),
 								vsVector2D( box.GetMax().x * currentTargetWidth, box.GetMax().y * currentTargetHeight )
@@ -2073,6 +1813,7 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 								(GLsizei)( m_currentViewportPixels.GetMin().y ),
 								(GLsizei)( m_currentViewportPixels.Width() ),
 								(GLsizei)( m_currentViewportPixels.Height() ) );
+						RendererUniformsChanged();
 					}
 					break;
 				}
@@ -2085,27 +1826,30 @@ vsRenderer_OpenGL3::RenderDisplayList( vsDisplayList *list )
 							vsVector2D::Zero,
 							vsVector2D( currentTargetWidth, currentTargetHeight )
 							);
+					RendererUniformsChanged();
 					break;
 				}
 			case vsDisplayList::OpCode_Debug:
 				{
-					if ( op->data.string == "screenshot" )
+					vsString message( op.GetPayload(), op.GetPayloadSize() );
+					if ( message == "screenshot" )
 					{
 						static int foo = 0;
 						vsImage img(m_currentRenderTarget->Resolve(0));
 						img.SavePNG_FullAlpha(vsFormatString("screenshot-%d.png", foo++));
 					}
 					else
-						vsRenderDebug( op->data.string );
+						vsRenderDebug( message );
 					break;
 				}
 			default:
-				vsAssert(false, "Unknown opcode type in display list!");	// error;  unknown opcode type in the display list!
+				if ( !ApplyStateOp( op ) )
+					vsAssert(false, "Unknown opcode type in display list!");	// error;  unknown opcode type in the display list!
 		}
 		// GL_CHECK("RenderOp");
 		{
-			PROFILE("PopOp");
-			op = list->PopOp();
+			PROFILE("NextOp");
+			op = ops.Next();
 		}
 	}
 	ClearState();
@@ -2685,6 +2429,7 @@ vsRenderer_OpenGL3::SetRenderTarget( vsRenderTarget *target )
 				vsVector2D::Zero,
 				vsVector2D( m_currentRenderTarget->GetViewportWidth(), m_currentRenderTarget->GetViewportHeight() )
 				);
+		RendererUniformsChanged();
 	}
 }
 
@@ -2805,29 +2550,11 @@ vsRenderer_OpenGL3::ClearState()
 	m_state.SetBool( vsRendererState::Bool_ScissorTest, false );
 	m_state.Flush();
 
-	m_currentColor = c_white;
-	m_currentColorArray = nullptr;
-	m_currentColorBuffer = nullptr;
-	m_currentColors = nullptr;
-	m_currentColorsBuffer = nullptr;
-	m_currentFogDensity = 0.001f;
-	m_currentLocalToWorld = nullptr;
-	m_currentLocalToWorldBuffer = nullptr;
-	m_currentLocalToWorldCount = 0;
+	ResetDisplayListState();
+	RendererUniformsChanged();
 	m_currentMaterial = nullptr;
 	m_currentMaterialInternal = nullptr;
-	m_currentNormalArray = nullptr;
 	m_currentShader = nullptr;
-	m_currentShaderValues = nullptr;
-	m_currentTexelArray = nullptr;
-	m_currentTexelBuffer = nullptr;
-	m_currentTransformStackLevel = 0;
-	m_currentVertexArray = nullptr;
-	m_currentVertexArrayCount = 0;
-	m_currentColorArrayCount = 0;
-	m_currentTexelArrayCount = 0;
-	m_currentNormalArrayCount = 0;
-	m_currentVertexBuffer = nullptr;
 	m_lightCount = 0;
 	m_usingNormalArray = false;
 	m_usingTexelArray = false;
@@ -2836,12 +2563,9 @@ vsRenderer_OpenGL3::ClearState()
 	m_currentVAO->Enter();
 	m_nextVAO = m_currentVAO;
 
-	m_transformStack[m_currentTransformStackLevel] = vsMatrix4x4::Identity;
-
 	s_previousMaterial = nullptr;
 	s_previousShaderValues = nullptr;
 	m_lastShaderId = -1;
-	m_optionsStack.Clear();
 	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
 	{
 		glActiveTexture(GL_TEXTURE0 + i);
@@ -2854,8 +2578,4 @@ vsRenderer_OpenGL3::ClearState()
 	glClearStencil(0);
 	glColorMask(GL_TRUE,GL_TRUE,GL_TRUE,GL_TRUE);
 	// glStencilFunc(GL_ALWAYS, 0x1, 0x1);
-
-
-	m_optionsStack.Clear();
-
 }
@@ -14,6 +14,7 @@
 
 #include "VS_Renderer.h"
 #include "VS_Color.h"
+#include "VS_DisplayListState.h"
 #include "VS_Fog.h"
 #include "VS_Material.h"
 #include "VS_RendererState.h"
@@ -34,10 +35,9 @@ class vsTransform2D;
 class vsVector2D;
 struct SDL_Surface;
 
-#define MAX_STACK_LEVEL (30)
 #define CHECK_GL_ERRORS
 
-class vsRenderer_OpenGL3: public vsRenderer
+class vsRenderer_OpenGL3: public vsRenderer, protected vsDisplayListState
 {
 	int					m_flags;
 	vsShaderSuite		*m_defaultShaderSuite;
@@ -45,18 +45,6 @@ class vsRenderer_OpenGL3: public vsRenderer
 	vsVector3D           m_currentCameraPosition;
 	Settings             m_currentSettings;
 
-	vsMatrix4x4			*m_currentLocalToWorld;
-	vsRenderBuffer		*m_currentLocalToWorldBuffer;
-	int					m_currentLocalToWorldCount;
-	vsMatrix4x4			m_currentWorldToView;
-	vsMatrix4x4			m_currentViewToProjection;
-
-	vsColor				m_currentColor;
-	vsColor *			m_currentColors;
-	vsRenderBuffer *	m_currentColorsBuffer;
-	vsColor				m_currentFogColor;
-	float				m_currentFogDensity;
-
 	vsRenderTarget *     m_window;
 	vsRenderTarget *     m_scene;
 	vsRenderTarget *     m_currentRenderTarget;
@@ -70,19 +58,6 @@ class vsRenderer_OpenGL3: public vsRenderer
 	vsMaterial *         m_currentMaterial;
 	vsMaterialInternal * m_currentMaterialInternal;
 	vsShader *           m_currentShader;
-	vsShaderValues *     m_currentShaderValues;
-
-	vsVector3D *         m_currentVertexArray;
-	vsVector3D *         m_currentNormalArray;
-	vsVector2D *         m_currentTexelArray;
-	vsColor *            m_currentColorArray;
-
-	vsRenderBuffer *     m_currentVertexBuffer;
-	vsRenderBuffer *     m_currentNormalBuffer;
-	vsRenderBuffer *     m_currentTexelBuffer;
-	vsRenderBuffer *     m_currentColorBuffer;
-
-	vsArray<vsShaderOptions> m_optionsStack;
 
 	vsBox2D m_currentViewportPixels;
 
@@ -98,12 +73,6 @@ class vsRenderer_OpenGL3: public vsRenderer
 		vsColor specular;
 	};
 
-	vsMatrix4x4          m_transformStack[MAX_STACK_LEVEL];
-	int                  m_currentTransformStackLevel;
-	int                  m_currentVertexArrayCount;
-	int                  m_currentNormalArrayCount;
-	int                  m_currentTexelArrayCount;
-	int                  m_currentColorArrayCount;
 	int                  m_lightCount;
 	int                  m_bufferCount;
 	lightStatus          m_lightStatus[MAX_LIGHTS];
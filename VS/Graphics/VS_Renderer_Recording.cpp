@@ -0,0 +1,978 @@
+/*
+ *  VS_Renderer_Recording.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Renderer_Recording.h"
+
+#include "VS_DynamicBatchManager.h"
+#include "VS_Image.h"
+#include "VS_Light.h"
+#include "VS_Material.h"
+#include "VS_RenderBuffer.h"
+#include "VS_RenderTarget.h"
+#include "VS_Shader.h"
+#include "VS_ShaderSuite.h"
+#include "VS_ShaderValues.h"
+#include "VS_TextureInternal.h"
+
+#include "VS_Profile.h"
+#include "VS_Heap.h"
+
+extern vsHeap *g_globalHeap;
+
+namespace
+{
+	// Values for State_BlendFunc.  Each draw mode maps to its own blend
+	// equation and function, so we use the draw mode itself for those;  this
+	// is the (GL_SRC_ALPHA, GL_ONE) function which ClearState() sets.
+	const uint32_t c_blendFuncCleared = 0xff;
+
+	// Values for State_DepthFunc and State_StencilFunc.
+	const uint32_t c_funcLessEqual = 1;
+	const uint32_t c_funcAlways = 2;
+	const uint32_t c_funcEqual = 3;
+
+	uint32_t HashFloats( const float *f, int count )
+	{
+		uint32_t hash = 2166136261u;
+		for ( int i = 0; i < count; i++ )
+		{
+			uint32_t bits;
+			memcpy( &bits, &f[i], sizeof(bits) );
+			hash = (hash ^ bits) * 16777619u;
+		}
+		return hash;
+	}
+
+	uint32_t HashInts( int a, int b, int c, int d )
+	{
+		const int v[4] = { a, b, c, d };
+		return HashFloats( reinterpret_cast<const float*>(v), 4 );
+	}
+};
+
+vsRenderer_Recording::Stats::Stats()
+{
+	Clear();
+}
+
+void
+vsRenderer_Recording::Stats::Clear()
+{
+	memset( this, 0, sizeof(Stats) );
+}
+
+void
+vsRenderer_Recording::Stats::Add( const Stats& other )
+{
+	frames += other.frames;
+	ops += other.ops;
+	draws += other.draws;
+	instances += other.instances;
+	indices += other.indices;
+	commands += other.commands;
+	stateSets += other.stateSets;
+	redundantStateSets += other.redundantStateSets;
+	programChanges += other.programChanges;
+	shaderPrepares += other.shaderPrepares;
+	textureBinds += other.textureBinds;
+	redundantTextureBinds += other.redundantTextureBinds;
+	renderTargetChanges += other.renderTargetChanges;
+	materialChanges += other.materialChanges;
+	redundantOps += other.redundantOps;
+	bytesUploaded += other.bytesUploaded;
+	bufferBytesUploaded += other.bufferBytesUploaded;
+	uniformUploads += other.uniformUploads;
+	uniformUploadsSkipped += other.uniformUploadsSkipped;
+	for ( int i = 0; i < vsDisplayList::OpCode_MAX; i++ )
+	{
+		opCount[i] += other.opCount[i];
+		redundantOpCount[i] += other.redundantOpCount[i];
+	}
+}
+
+vsRenderer_Recording::vsRenderer_Recording(int width, int height, int depth, int flags, int bufferCount):
+	vsRenderer(width, height, depth, flags),
+	m_bufferCount(bufferCount),
+	m_antialias( (flags & Flag_Antialias) != 0 ),
+	m_defaultShaderSuite(nullptr),
+	m_window(nullptr),
+	m_scene(nullptr),
+	m_currentRenderTarget(nullptr),
+	m_currentVAO(nullptr),
+	m_lightCount(0),
+	m_lightAmbient(c_black),
+	m_lightDiffuse(c_black),
+	m_lightSpecular(c_black),
+	m_nextResourceId(1),
+	m_logIndex(0),
+	m_lastFrameHash(0),
+	m_bufferBytesUploaded(0)
+{
+	// Anything which gets created from here on mustn't try to talk to OpenGL.
+	SetHeadless(true);
+
+	m_logStorage[0] = m_logStorage[1] = 0;
+
+	m_widthPixels = m_viewportWidthPixels = width;
+	m_heightPixels = m_viewportHeightPixels = height;
+
+	m_defaultShaderSuite = new vsShaderSuite;
+	m_defaultShaderSuite->InitShaders("default_v.glsl", "default_f.glsl", vsShaderSuite::OwnerType_System);
+
+	ResizeRenderTargetsToMatchWindow();
+	ClearState();
+	ResetStats();
+}
+
+vsRenderer_Recording::~vsRenderer_Recording()
+{
+	LogStats( m_total );
+	vsDelete( m_defaultShaderSuite );
+}
+
+void
+vsRenderer_Recording::Deinit()
+{
+	vsDelete(m_window);
+	vsDelete(m_scene);
+	m_currentRenderTarget = nullptr;
+}
+
+bool
+vsRenderer_Recording::CheckVideoMode()
+{
+	return false;
+}
+
+void
+vsRenderer_Recording::UpdateVideoMode(int width, int height, int depth, WindowType type, int bufferCount, bool antialias, bool vsync, bool borderless)
+{
+	m_bufferCount = bufferCount;
+	m_antialias = antialias;
+	NotifyResized( width, height );
+}
+
+void
+vsRenderer_Recording::NotifyResized( int width, int height )
+{
+	m_width = m_viewportWidth = width;
+	m_height = m_viewportHeight = height;
+	m_widthPixels = m_viewportWidthPixels = width;
+	m_heightPixels = m_viewportHeightPixels = height;
+	ResizeRenderTargetsToMatchWindow();
+}
+
+void
+vsRenderer_Recording::ResizeRenderTargetsToMatchWindow()
+{
+	// Same targets as vsRenderer_OpenGL3 makes, so that render pipelines set
+	// themselves up identically.  In headless mode these don't own any GPU
+	// surfaces;  they're just sizes and textures for the pipeline to refer to.
+	if ( m_window )
+		m_window->Resize( m_widthPixels, m_heightPixels );
+	else
+	{
+		vsSurface::Settings settings;
+		settings.depth = false;
+		settings.width = m_widthPixels;
+		settings.height = m_heightPixels;
+		m_window = new vsRenderTarget( vsRenderTarget::Type_Window, settings );
+	}
+
+	if ( m_scene )
+		m_scene->Resize( m_widthPixels, m_heightPixels );
+	else
+	{
+		vsSurface::Settings settings;
+		settings.bufferSettings[2].format = vsSurface::Format_HalfFloat;
+		settings.width = m_widthPixels;
+		settings.height = m_heightPixels;
+		settings.depth = true;
+		settings.mipMaps = false;
+		settings.stencil = true;
+		settings.buffers = m_bufferCount;
+
+		if ( m_antialias )
+			m_scene = new vsRenderTarget( vsRenderTarget::Type_Multisample, settings );
+		else
+			m_scene = new vsRenderTarget( vsRenderTarget::Type_Texture, settings );
+	}
+	SetRenderTarget( m_scene );
+	m_lastShader = nullptr;
+	m_currentViewportPixels.Set( vsVector2D::Zero, vsVector2D( m_widthPixels, m_heightPixels ) );
+	RendererUniformsChanged();
+}
+
+uint32_t
+vsRenderer_Recording::ResourceId( const void *resource )
+{
+	if ( !resource )
+		return 0;
+	vsScopedLock lock( m_resourceIdMutex );
+	auto it = m_resourceId.find( resource );
+	if ( it != m_resourceId.end() )
+		return it->second;
+	uint32_t id = m_nextResourceId++;
+	m_resourceId[resource] = id;
+	return id;
+}
+
+uint32_t
+vsRenderer_Recording::FindResourceId( const void *resource )
+{
+	vsScopedLock lock( m_resourceIdMutex );
+	auto it = m_resourceId.find( resource );
+	return ( it != m_resourceId.end() ) ? it->second : 0;
+}
+
+void
+vsRenderer_Recording::Record( CommandType type, uint8_t detail, uint32_t a, uint32_t b )
+{
+	Command c;
+	c.type = (uint8_t)type;
+	c.detail = detail;
+	c.padding = 0;
+	c.a = a;
+	c.b = b;
+
+	vsArray<Command> &log = m_log[m_logIndex];
+	if ( log.ItemCount() == m_logStorage[m_logIndex] )
+	{
+		// Don't charge the log's growth to whichever game is running;  it
+		// lasts as long as we do.
+		m_logStorage[m_logIndex] = vsMax( 1024, m_logStorage[m_logIndex] * 2 );
+		vsHeap::Push(g_globalHeap);
+		log.Reserve( m_logStorage[m_logIndex] );
+		vsHeap::Pop(g_globalHeap);
+	}
+	log.AddItem( c );
+	m_frame.commands++;
+}
+
+void
+vsRenderer_Recording::SetState( State state, uint32_t value )
+{
+	m_frame.stateSets++;
+	if ( m_state[state] == value )
+	{
+		m_frame.redundantStateSets++;
+		return;
+	}
+	m_state[state] = value;
+	Record( Command_SetState, (uint8_t)state, value );
+}
+
+void
+vsRenderer_Recording::Redundant( vsDisplayList::OpCode op, bool redundant )
+{
+	if ( redundant )
+	{
+		m_frame.redundantOps++;
+		m_frame.redundantOpCount[op]++;
+	}
+}
+
+void
+vsRenderer_Recording::RecordUpload( Upload type, size_t bytes )
+{
+	m_frame.bytesUploaded += bytes;
+	Record( Command_Upload, (uint8_t)type, (uint32_t)bytes );
+}
+
+void
+vsRenderer_Recording::RecordDraw( Primitive primitive, int indexCount )
+{
+	FlushRenderState();
+	RecordUpload( Upload_Index, indexCount * sizeof(uint16_t) );
+	Record( Command_Draw, (uint8_t)primitive, indexCount, m_currentLocalToWorldCount );
+	m_frame.draws++;
+	m_frame.instances += m_currentLocalToWorldCount;
+	m_frame.indices += indexCount;
+}
+
+void
+vsRenderer_Recording::RecordDrawBuffer( Primitive primitive, vsRenderBuffer *ib )
+{
+	FlushRenderState();
+	Record( Command_DrawBuffer, (uint8_t)primitive, ResourceId(ib), m_currentLocalToWorldCount );
+	m_frame.draws++;
+	m_frame.instances += m_currentLocalToWorldCount;
+	m_frame.indices += ib->GetIntArraySize();
+}
+
+void
+vsRenderer_Recording::BindBuffer( Upload type, vsRenderBuffer *buffer )
+{
+	Record( Command_BindBuffer, (uint8_t)type, ResourceId(buffer) );
+}
+
+void
+vsRenderer_Recording::SetVertexArrayObject( const void *vao, vsDisplayList::OpCode op )
+{
+	Redundant( op, vao == m_currentVAO );
+	if ( vao != m_currentVAO )
+	{
+		m_currentVAO = vao;
+		Record( Command_SetVertexArrayObject, 0, ResourceId(vao) );
+	}
+}
+
+void
+vsRenderer_Recording::SetRenderTarget( vsRenderTarget *target )
+{
+	if ( !target )
+		target = m_scene;
+
+	if ( target != m_currentRenderTarget )
+	{
+		m_currentRenderTarget = target;
+		Record( Command_SetRenderTarget, 0, ResourceId(target) );
+		m_frame.renderTargetChanges++;
+
+		m_currentViewportPixels.Set(
+				vsVector2D::Zero,
+				vsVector2D( m_currentRenderTarget->GetViewportWidth(), m_currentRenderTarget->GetViewportHeight() )
+				);
+		RendererUniformsChanged();
+	}
+}
+
+void
+vsRenderer_Recording::RenderDisplayList( vsDisplayList *list )
+{
+	PROFILE("RenderDisplayList");
+
+	vsDisplayList::Iterator ops = list->GetOps();
+	vsDisplayList::OpView op = ops.Next();
+
+	while( op.IsValid() )
+	{
+		const vsDisplayList::OpCode type = op.GetType();
+		m_frame.ops++;
+		if ( type < vsDisplayList::OpCode_MAX )
+			m_frame.opCount[type]++;
+
+		switch( type )
+		{
+			case vsDisplayList::OpCode_SetVertexArrayObject:
+				SetVertexArrayObject( op.GetPointer<vsVertexArrayObject>(), type );
+				break;
+			case vsDisplayList::OpCode_ClearVertexArrayObject:
+				SetVertexArrayObject( nullptr, type );
+				break;
+			case vsDisplayList::OpCode_SetLinear:
+				SetState( State_FramebufferSRGB, op.Get<uint32_t>() ? 1 : 0 );
+				break;
+			case vsDisplayList::OpCode_SetColor:
+				{
+					const vsColor &color = op.Get<vsColor>();
+					Redundant( type, color == m_currentColor && !m_currentColors && !m_currentColorsBuffer );
+					ApplyStateOp( op );
+					break;
+				}
+			case vsDisplayList::OpCode_SetMaterial:
+				{
+					vsMaterial *material = op.GetPointer<vsMaterial>();
+					vsAssert(material, "SetMaterial called with no material?");
+					Redundant( type, material == m_currentMaterial && material->GetResource() == m_currentMaterialInternal );
+					if ( m_currentMaterialInternal != material->GetResource() )
+						SetMaterialInternal( material->GetResource() );
+					m_currentMaterial = material;
+					m_currentColors = nullptr;
+					m_currentColorsBuffer = nullptr;
+					break;
+				}
+			case vsDisplayList::OpCode_SetRenderTarget:
+				{
+					vsRenderTarget *target = op.GetPointer<vsRenderTarget>();
+					Redundant( type, (target ? target : m_scene) == m_currentRenderTarget );
+					SetRenderTarget( target );
+					break;
+				}
+			case vsDisplayList::OpCode_ClearRenderTarget:
+			case vsDisplayList::OpCode_ClearRenderTargetColor:
+				{
+					m_lastShader = nullptr;
+					SetState( State_DepthMask, true );
+					SetState( State_StencilTest, true );
+					// vsRenderTarget::Clear() leaves the stencil mask fully open.
+					m_state[State_StencilMask] = 0xff;
+					Record( Command_Clear, Clear_Color | Clear_Depth | Clear_Stencil );
+					break;
+				}
+			case vsDisplayList::OpCode_BlitRenderTarget:
+			case vsDisplayList::OpCode_BlitRenderTargetRect:
+				{
+					vsRenderTarget *from = op.GetPointer<vsRenderTarget>(0);
+					vsRenderTarget *to = op.GetPointer<vsRenderTarget>(1);
+					Record( Command_Blit, 0, ResourceId(from), ResourceId(to) );
+					to->InvalidateResolve();
+					break;
+				}
+			case vsDisplayList::OpCode_SetShaderValues:
+				Redundant( type, op.GetPointer<vsShaderValues>() == m_currentShaderValues );
+				ApplyStateOp( op );
+				break;
+			case vsDisplayList::OpCode_ClearShaderValues:
+				Redundant( type, m_currentShaderValues == nullptr );
+				ApplyStateOp( op );
+				break;
+			case vsDisplayList::OpCode_SetWorldToViewMatrix4x4:
+				Redundant( type, op.Get<vsMatrix4x4>() == m_currentWorldToView );
+				ApplyStateOp( op );
+				RendererUniformsChanged();
+				break;
+			case vsDisplayList::OpCode_SetProjectionMatrix4x4:
+				Redundant( type, op.Get<vsMatrix4x4>() == m_currentViewToProjection );
+				ApplyStateOp( op );
+				RendererUniformsChanged();
+				break;
+			case vsDisplayList::OpCode_Fog:
+				ApplyStateOp( op );
+				RendererUniformsChanged();
+				break;
+			case vsDisplayList::OpCode_VertexArray:
+			case vsDisplayList::OpCode_NormalArray:
+			case vsDisplayList::OpCode_ColorArray:
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				break;
+			case vsDisplayList::OpCode_TexelArray:
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				// the OpenGL renderer binds texel arrays immediately, as well
+				// as again before the draw.
+				RecordUpload( Upload_Texel, m_currentTexelArrayCount * sizeof(vsVector2D) );
+				break;
+			case vsDisplayList::OpCode_VertexBuffer:
+				Redundant( type, op.GetPointer<vsRenderBuffer>() == m_currentVertexBuffer );
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				BindBuffer( Upload_Vertex, m_currentVertexBuffer );
+				break;
+			case vsDisplayList::OpCode_NormalBuffer:
+				Redundant( type, op.GetPointer<vsRenderBuffer>() == m_currentNormalBuffer );
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				BindBuffer( Upload_Normal, m_currentNormalBuffer );
+				break;
+			case vsDisplayList::OpCode_TexelBuffer:
+				Redundant( type, op.GetPointer<vsRenderBuffer>() == m_currentTexelBuffer );
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				BindBuffer( Upload_Texel, m_currentTexelBuffer );
+				break;
+			case vsDisplayList::OpCode_ColorBuffer:
+				Redundant( type, op.GetPointer<vsRenderBuffer>() == m_currentColorBuffer );
+				ApplyStateOp( op );
+				m_currentBoundBuffer = nullptr;
+				BindBuffer( Upload_Color, m_currentColorBuffer );
+				break;
+			case vsDisplayList::OpCode_ClearArrays:
+				ClearArrays();
+				m_currentBoundBuffer = nullptr;
+				break;
+			case vsDisplayList::OpCode_BindBuffer:
+				{
+					vsRenderBuffer *buffer = op.GetPointer<vsRenderBuffer>();
+					Redundant( type, buffer == m_currentBoundBuffer );
+					ClearArrays();
+					m_currentBoundBuffer = buffer;
+					BindBuffer( Upload_Buffer, buffer );
+					break;
+				}
+			case vsDisplayList::OpCode_UnbindBuffer:
+				m_currentBoundBuffer = nullptr;
+				break;
+			case vsDisplayList::OpCode_LineListArray:
+				RecordDraw( Primitive_Lines, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_LineStripArray:
+				RecordDraw( Primitive_LineStrip, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_TriangleListArray:
+				RecordDraw( Primitive_Triangles, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_TriangleStripArray:
+				RecordDraw( Primitive_TriangleStrip, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_TriangleFanArray:
+				RecordDraw( Primitive_TriangleFan, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_PointsArray:
+				RecordDraw( Primitive_Points, op.GetArrayCount<uint16_t>() );
+				break;
+			case vsDisplayList::OpCode_TriangleStripBuffer:
+				RecordDrawBuffer( Primitive_TriangleStrip, op.GetPointer<vsRenderBuffer>() );
+				break;
+			case vsDisplayList::OpCode_TriangleListBuffer:
+				RecordDrawBuffer( Primitive_Triangles, op.GetPointer<vsRenderBuffer>() );
+				break;
+			case vsDisplayList::OpCode_TriangleFanBuffer:
+				RecordDrawBuffer( Primitive_TriangleFan, op.GetPointer<vsRenderBuffer>() );
+				break;
+			case vsDisplayList::OpCode_LineListBuffer:
+				RecordDrawBuffer( Primitive_Lines, op.GetPointer<vsRenderBuffer>() );
+				break;
+			case vsDisplayList::OpCode_LineStripBuffer:
+				RecordDrawBuffer( Primitive_LineStrip, op.GetPointer<vsRenderBuffer>() );
+				break;
+			case vsDisplayList::OpCode_Light:
+				// Same limit as the OpenGL renderer, which only passes the
+				// first light through to shaders.
+				if ( m_lightCount < 3 )
+				{
+					if ( m_lightCount == 0 )
+					{
+						const vsDisplayList::LightData &l = op.Get<vsDisplayList::LightData>();
+						if ( l.type == vsLight::Type_Directional )
+							m_lightPosition = l.direction;
+						else if ( l.type == vsLight::Type_Point )
+							m_lightPosition = l.position;
+						m_lightAmbient = l.ambient;
+						m_lightDiffuse = l.color;
+						m_lightSpecular = l.specular;
+					}
+					m_lightCount++;
+					RendererUniformsChanged();
+				}
+				break;
+			case vsDisplayList::OpCode_ClearLights:
+				m_lightCount = 0;
+				RendererUniformsChanged();
+				break;
+			case vsDisplayList::OpCode_ClearStencil:
+				m_lastShader = nullptr;
+				Record( Command_Clear, Clear_Stencil );
+				break;
+			case vsDisplayList::OpCode_ClearDepth:
+				m_lastShader = nullptr;
+				SetState( State_DepthMask, true );
+				Record( Command_Clear, Clear_Depth );
+				break;
+			case vsDisplayList::OpCode_EnableScissor:
+				{
+					const vsBox2D& box = op.Get<vsBox2D>();
+					SetState( State_ScissorTest, true );
+					SetState( State_Scissor, HashInts(
+								(int)(box.GetMin().x * m_currentViewportPixels.Width()),
+								(int)(box.GetMin().y * m_currentViewportPixels.Height()),
+								(int)(box.Width() * m_currentViewportPixels.Width()),
+								(int)(box.Height() * m_currentViewportPixels.Height()) ) );
+					break;
+				}
+			case vsDisplayList::OpCode_DisableScissor:
+				SetState( State_ScissorTest, false );
+				break;
+			case vsDisplayList::OpCode_SetViewport:
+				{
+					int currentTargetWidth = m_currentRenderTarget->GetViewportWidth();
+					int currentTargetHeight = m_currentRenderTarget->GetViewportHeight();
+
+					const vsBox2D& box = op.Get<vsBox2D>();
+					m_currentViewportPixels.Set(
+							vsVector2D( box.GetMin().x * currentTargetWidth, box.GetMin().y * currentTargetHeight ),
+							vsVector2D( box.GetMax().x * currentTargetWidth, box.GetMax().y * currentTargetHeight )
+							);
+					SetState( State_Viewport, HashInts(
+								(int)m_currentViewportPixels.GetMin().x,
+								(int)m_currentViewportPixels.GetMin().y,
+								(int)m_currentViewportPixels.Width(),
+								(int)m_currentViewportPixels.Height() ) );
+					RendererUniformsChanged();
+					break;
+				}
+			case vsDisplayList::OpCode_ClearViewport:
+				{
+					int currentTargetWidth = m_currentRenderTarget->GetViewportWidth();
+					int currentTargetHeight = m_currentRenderTarget->GetViewportHeight();
+					m_currentViewportPixels.Set( vsVector2D::Zero, vsVector2D( currentTargetWidth, currentTargetHeight ) );
+					SetState( State_Viewport, HashInts( 0, 0, currentTargetWidth, currentTargetHeight ) );
+					RendererUniformsChanged();
+					break;
+				}
+			default:
+				if ( !ApplyStateOp( op ) )
+					vsAssert(false, "Unknown opcode type in display list!");
+		}
+		op = ops.Next();
+	}
+	ClearState();
+}
+
+void
+vsRenderer_Recording::FlushRenderState()
+{
+	if ( m_currentColorArray )
+		RecordUpload( Upload_Color, m_currentColorArrayCount * sizeof(vsColor) );
+	if ( m_currentNormalArray )
+		RecordUpload( Upload_Normal, m_currentNormalArrayCount * sizeof(vsVector3D) );
+	if ( m_currentTexelArray )
+		RecordUpload( Upload_Texel, m_currentTexelArrayCount * sizeof(vsVector2D) );
+	if ( m_currentVertexArray )
+		RecordUpload( Upload_Vertex, m_currentVertexArrayCount * sizeof(vsVector3D) );
+
+	vsAssert( m_currentShader, "Trying to flush render state with no shader set?" );
+	if ( m_currentShader )
+	{
+		uint32_t shaderOptionsValue = m_currentMaterial->GetShaderOptions()->value &
+			m_currentMaterial->GetShaderOptions()->mask;
+		uint32_t shaderOptionsSet = 0;
+		for( int i = m_optionsStack.ItemCount()-1; i >= 0; i-- )
+		{
+			const vsShaderOptions &s = m_optionsStack[i];
+			shaderOptionsValue |= s.value & s.mask & ~shaderOptionsSet;
+			shaderOptionsSet |= s.mask;
+		}
+		shaderOptionsValue |= vsShader::GetVariantBitsFor( m_currentMaterial->GetShaderValues() );
+		shaderOptionsValue |= vsShader::GetVariantBitsFor( m_currentMaterialInternal->GetShaderValues() );
+		shaderOptionsValue |= vsShader::GetVariantBitsFor( m_currentShaderValues );
+		shaderOptionsValue &= m_currentShader->GetVariantBitsSupported();
+
+		if ( m_lastShader != m_currentShader || shaderOptionsValue != m_currentShader->GetCurrentVariantBits() )
+		{
+			m_currentShader->SetForVariantBits( shaderOptionsValue );
+			Record( Command_UseProgram, 0, ResourceId(m_currentShader), shaderOptionsValue );
+			Record( Command_PrepareShader, 0, ResourceId(m_currentMaterial), ResourceId(m_currentShaderValues) );
+			m_currentShader->Prepare( m_currentMaterial, m_currentShaderValues, m_currentRenderTarget );
+			m_frame.programChanges++;
+			m_frame.shaderPrepares++;
+			m_lastShader = m_currentShader;
+			m_previousMaterial = m_currentMaterial;
+		}
+		else if ( m_currentMaterial != m_previousMaterial || m_currentShaderValues != m_previousShaderValues )
+		{
+			Record( Command_PrepareShader, 0, ResourceId(m_currentMaterial), ResourceId(m_currentShaderValues) );
+			m_currentShader->Prepare( m_currentMaterial, m_currentShaderValues, m_currentRenderTarget );
+			m_frame.shaderPrepares++;
+			m_previousMaterial = m_currentMaterial;
+			m_previousShaderValues = m_currentShaderValues;
+		}
+
+		BindTextures();
+
+		// The same uniforms as the OpenGL renderer sets;  the shaders record
+		// each one they actually send via NotifyUniformUploaded().  We have
+		// no VAOs, and headless shaders have no attributes to bind to them.
+		if ( m_currentLocalToWorldBuffer )
+			m_currentShader->SetLocalToWorld( nullptr, m_currentLocalToWorldBuffer );
+		else if ( m_currentLocalToWorldCount > 0 )
+			m_currentShader->SetLocalToWorld( nullptr, m_currentLocalToWorld, m_currentLocalToWorldCount );
+		else
+			m_currentShader->SetLocalToWorld( nullptr, &m_transformStack[0], 1 );
+		m_currentShader->SetColor( nullptr, m_currentColor );
+		if ( m_currentColorsBuffer )
+			m_currentShader->SetInstanceColors( nullptr, m_currentColorsBuffer );
+		else if ( m_currentColors )
+			m_currentShader->SetInstanceColors( nullptr, m_currentColors, m_currentLocalToWorldCount );
+		else
+			m_currentShader->SetInstanceColors( nullptr, &c_white, 1 );
+		if ( m_currentShader->NeedsRendererUniforms( m_rendererUniformsGeneration ) )
+		{
+			m_currentShader->SetFog( m_currentMaterialInternal->m_fog, m_currentFogColor, m_currentFogDensity );
+			m_currentShader->SetWorldToView( m_currentWorldToView );
+			m_currentShader->SetViewToProjection( m_currentViewToProjection );
+			m_currentShader->SetViewport( m_currentViewportPixels.Extents() );
+			m_currentShader->SetLight( 0, m_lightAmbient, m_lightDiffuse, m_lightSpecular, m_lightPosition, vsVector3D::Zero );
+		}
+
+		// Single matrices and colors go in as static attributes;  arrays of
+		// them get streamed into a buffer.
+		if ( !m_currentLocalToWorldBuffer && m_currentLocalToWorldCount > 1 )
+			RecordUpload( Upload_LocalToWorld, m_currentLocalToWorldCount * sizeof(vsMatrix4x4) );
+		if ( !m_currentColorsBuffer && m_currentColors && m_currentLocalToWorldCount > 1 )
+			RecordUpload( Upload_InstanceColor, m_currentLocalToWorldCount * sizeof(vsColor) );
+	}
+
+	if ( m_currentRenderTarget )
+		m_currentRenderTarget->InvalidateResolve();
+}
+
+void
+vsRenderer_Recording::BindTextures()
+{
+	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
+	{
+		vsTexture *t = nullptr;
+		if ( m_currentShaderValues && m_currentShaderValues->HasTextureOverride(i) )
+			t = m_currentShaderValues->GetTextureOverride(i);
+		else if ( m_currentMaterial->GetShaderValues()->HasTextureOverride(i) )
+			t = m_currentMaterial->GetShaderValues()->GetTextureOverride(i);
+		else
+			t = m_currentMaterialInternal->GetTexture(i);
+
+		uint32_t id = 0;
+		if ( t )
+		{
+			vsTextureInternal *ti = t->GetResource();
+			id = ti->IsTextureBuffer() ? ResourceId( ti->GetTextureBuffer() ) : ResourceId( ti );
+			if ( !ti->IsTextureBuffer() )
+			{
+				ti->SetClampedU( t->GetClampU() );
+				ti->SetClampedV( t->GetClampV() );
+			}
+		}
+		else if ( m_boundTexture[i] == 0 )
+			continue;	// the OpenGL renderer doesn't even look at empty slots which are already empty.
+
+		m_frame.textureBinds++;
+		if ( m_boundTexture[i] == id )
+			m_frame.redundantTextureBinds++;
+		else
+		{
+			m_boundTexture[i] = id;
+			Record( Command_BindTexture, (uint8_t)i, id );
+		}
+	}
+}
+
+void
+vsRenderer_Recording::SetMaterialInternal( vsMaterialInternal *material )
+{
+	vsAssert( material, "SetMaterialInternal called with nullptr material?" );
+	if ( material == m_currentMaterialInternal )
+		return;
+
+	m_currentMaterialInternal = material;
+	m_frame.materialChanges++;
+
+	SetState( State_ColorMask, m_currentSettings.writeColor );
+	SetState( State_DepthMask, m_currentSettings.writeDepth && material->m_zWrite );
+	SetState( State_StencilTest, material->m_stencilRead || material->m_stencilWrite );
+	SetState( State_StencilFunc, material->m_stencilRead ? c_funcEqual : c_funcAlways );
+	if ( material->m_stencilWrite )
+	{
+		SetState( State_StencilMask, 0xff );
+		SetState( State_StencilOp, material->m_stencilOp );
+	}
+	else
+		SetState( State_StencilMask, 0 );
+
+	m_currentShader = material->m_shader ? material->m_shader : DefaultShaderFor( material );
+	if ( !material->m_shader && m_currentSettings.shaderSuite )
+	{
+		// The OpenGL renderer prefers a custom suite's shader, where there is one.
+		vsShaderSuite::ShaderType type = (material->m_drawMode == DrawMode_Lit) ?
+			( material->m_texture[0] ? vsShaderSuite::LitTex : vsShaderSuite::Lit ) :
+			( material->m_texture[0] ? vsShaderSuite::NormalTex : vsShaderSuite::Normal );
+		if ( m_currentSettings.shaderSuite->GetShader(type) )
+			m_currentShader = m_currentSettings.shaderSuite->GetShader(type);
+	}
+
+	if ( material->m_zRead || material->m_zWrite )
+	{
+		SetState( State_DepthTest, true );
+		SetState( State_DepthMask, material->m_zWrite );
+		SetState( State_DepthFunc, material->m_zRead ? c_funcLessEqual : c_funcAlways );
+	}
+	else
+		SetState( State_DepthTest, false );
+
+	if ( material->m_depthBiasConstant == 0.f && material->m_depthBiasFactor == 0.f )
+		SetState( State_PolygonOffsetFill, false );
+	else
+	{
+		const float bias[2] = { material->m_depthBiasConstant, material->m_depthBiasFactor };
+		SetState( State_PolygonOffsetFill, true );
+		SetState( State_PolygonOffset, HashFloats( bias, 2 ) );
+	}
+
+	if ( material->m_cullingType == Cull_None )
+		SetState( State_CullFace, false );
+	else
+	{
+		bool cullingBack = (material->m_cullingType == Cull_Back);
+		if ( m_currentSettings.invertCull )
+			cullingBack = !cullingBack;
+		SetState( State_CullFace, true );
+		SetState( State_CullMode, cullingBack ? Cull_Back : Cull_Front );
+	}
+
+	SetState( State_Blend, material->m_blend );
+	SetState( State_BlendFunc, material->m_drawMode );
+
+	m_currentColor = material->m_hasColor ? material->m_color : c_white;
+}
+
+vsShader*
+vsRenderer_Recording::DefaultShaderFor( vsMaterialInternal *mat )
+{
+	switch( mat->m_drawMode )
+	{
+		case DrawMode_Lit:
+			return m_defaultShaderSuite->GetShader( mat->m_texture[0] ? vsShaderSuite::LitTex : vsShaderSuite::Lit );
+		default:
+			return m_defaultShaderSuite->GetShader( mat->m_texture[0] ? vsShaderSuite::NormalTex : vsShaderSuite::Normal );
+	}
+}
+
+void
+vsRenderer_Recording::NotifyBufferUploaded( int bytes )
+{
+	m_bufferBytesUploaded += bytes;
+}
+
+void
+vsRenderer_Recording::NotifyUniformUploaded( const vsShaderVariant *variant, int uniform )
+{
+	Record( Command_Uniform, 0, ResourceId(variant), uniform );
+}
+
+void
+vsRenderer_Recording::NotifyResourceDestroyed( const void *resource )
+{
+	vsScopedLock lock( m_resourceIdMutex );
+	m_resourceId.erase( resource );
+}
+
+void
+vsRenderer_Recording::ClearState()
+{
+	m_lastShader = nullptr;
+	SetRenderTarget( m_scene );
+	SetState( State_ColorMask, true );
+	SetState( State_Blend, true );
+	SetState( State_DepthMask, true );
+	SetState( State_CullFace, true );
+	SetState( State_DepthTest, true );
+	SetState( State_PolygonOffsetFill, false );
+	SetState( State_StencilTest, false );
+	SetState( State_ScissorTest, false );
+	SetState( State_BlendFunc, c_blendFuncCleared );
+
+	ResetDisplayListState();
+	RendererUniformsChanged();
+	m_currentMaterial = nullptr;
+	m_currentMaterialInternal = nullptr;
+	m_currentShader = nullptr;
+	m_currentBoundBuffer = nullptr;
+	m_lightCount = 0;
+
+	if ( m_currentVAO )
+	{
+		m_currentVAO = nullptr;
+		Record( Command_SetVertexArrayObject, 0, 0 );
+	}
+
+	m_previousMaterial = nullptr;
+	m_previousShaderValues = nullptr;
+
+	// The OpenGL renderer unbinds every texture slot here.
+	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
+	{
+		m_frame.textureBinds++;
+		if ( m_boundTexture[i] == 0 )
+			m_frame.redundantTextureBinds++;
+		else
+		{
+			m_boundTexture[i] = 0;
+			Record( Command_BindTexture, (uint8_t)i, 0 );
+		}
+	}
+}
+
+void
+vsRenderer_Recording::Present()
+{
+	PROFILE("Present");
+	Record( Command_Present );
+
+	m_frame.frames = 1;
+	m_frame.bufferBytesUploaded = m_bufferBytesUploaded.exchange(0);
+	m_frame.bytesUploaded += m_frame.bufferBytesUploaded;
+	FinishFrameUniformStats();
+	m_frame.uniformUploads = m_uniformUploads;
+	m_frame.uniformUploadsSkipped = m_uniformUploadsSkipped;
+
+	const vsArray<Command> &log = m_log[m_logIndex];
+	uint64_t hash = 14695981039346656037ull;
+	for ( int i = 0; i < log.ItemCount(); i++ )
+	{
+		const uint8_t *bytes = reinterpret_cast<const uint8_t*>( &log[i] );
+		for ( size_t b = 0; b < sizeof(Command); b++ )
+			hash = (hash ^ bytes[b]) * 1099511628211ull;
+	}
+	m_lastFrameHash = hash;
+
+	m_lastFrame = m_frame;
+	m_total.Add( m_frame );
+	m_frame.Clear();
+
+	m_logIndex ^= 1;
+	m_log[m_logIndex].Clear();
+
+	vsDynamicBatchManager::Instance()->FrameRendered();
+}
+
+void
+vsRenderer_Recording::ResetStats()
+{
+	m_frame.Clear();
+	m_lastFrame.Clear();
+	m_total.Clear();
+	m_log[0].Clear();
+	m_log[1].Clear();
+	m_bufferBytesUploaded = 0;
+	FinishFrameUniformStats();
+}
+
+void
+vsRenderer_Recording::LogStats( const Stats& s ) const
+{
+	vsLog("Recording renderer:  %llu frames, %llu ops (%llu redundant), %llu draws, %llu instances, %llu indices",
+			(unsigned long long)s.frames, (unsigned long long)s.ops, (unsigned long long)s.redundantOps,
+			(unsigned long long)s.draws, (unsigned long long)s.instances, (unsigned long long)s.indices);
+	vsLog("  state sets:  %llu (%llu redundant), texture binds: %llu (%llu redundant)",
+			(unsigned long long)s.stateSets, (unsigned long long)s.redundantStateSets,
+			(unsigned long long)s.textureBinds, (unsigned long long)s.redundantTextureBinds);
+	vsLog("  programs: %llu, shader prepares: %llu, materials: %llu, render targets: %llu",
+			(unsigned long long)s.programChanges, (unsigned long long)s.shaderPrepares,
+			(unsigned long long)s.materialChanges, (unsigned long long)s.renderTargetChanges);
+	vsLog("  uploaded:  %llu bytes (%llu from buffers), %llu commands",
+			(unsigned long long)s.bytesUploaded, (unsigned long long)s.bufferBytesUploaded,
+			(unsigned long long)s.commands);
+	vsLog("  uniforms:  %llu uploaded, %llu skipped",
+			(unsigned long long)s.uniformUploads, (unsigned long long)s.uniformUploadsSkipped);
+	for ( int i = 0; i < vsDisplayList::OpCode_MAX; i++ )
+	{
+		if ( s.redundantOpCount[i] )
+			vsLog("  redundant %s:  %llu of %llu", vsDisplayList::GetOpCodeString((vsDisplayList::OpCode)i).c_str(),
+					(unsigned long long)s.redundantOpCount[i], (unsigned long long)s.opCount[i]);
+	}
+}
+
+vsImage*
+vsRenderer_Recording::Screenshot()
+{
+	return new vsImage( m_widthPixels, m_heightPixels );
+}
+
+vsImage*
+vsRenderer_Recording::Screenshot_Async()
+{
+	return new vsImage( m_widthPixels, m_heightPixels );
+}
+
+vsImage*
+vsRenderer_Recording::ScreenshotBack()
+{
+	return new vsImage( m_widthPixels, m_heightPixels );
+}
+
+vsImage*
+vsRenderer_Recording::ScreenshotDepth()
+{
+	return new vsImage( m_widthPixels, m_heightPixels );
+}
+
+vsImage*
+vsRenderer_Recording::ScreenshotAlpha()
+{
+	return new vsImage( m_widthPixels, m_heightPixels );
+}
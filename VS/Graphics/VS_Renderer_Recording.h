@@ -0,0 +1,274 @@
+/*
+ *  VS_Renderer_Recording.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_RENDERER_RECORDING_H
+#define VS_RENDERER_RECORDING_H
+
+#include "VS_Renderer.h"
+#include "VS_DisplayList.h"
+#include "VS_DisplayListState.h"
+#include "VS_MaterialInternal.h"
+#include "VS_ShaderOptions.h"
+#include "VS/Threads/VS_Mutex.h"
+#include "VS/Utils/VS_Array.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <atomic>
+#include <unordered_map>
+#include "VS/VS_EnableDebugNew.h"
+
+class vsShaderSuite;
+
+// vsRenderer_Recording is a renderer for running without a GPU, such as on a
+// headless build machine.  It walks display lists exactly the way that
+// vsRenderer_OpenGL3 does, tracking the same state (both decode the state ops
+// through vsDisplayListState) and making all the same decisions about when to change shaders, bind textures, upload arrays,
+// and so on.  But instead of calling OpenGL, it writes a compact log of the
+// commands it would have sent, and keeps counts of draws, state changes, and
+// bytes uploaded.
+//
+// That lets us measure how long the CPU side of rendering takes (building
+// render queues and interpreting display lists), and how many of the state
+// changes we make are redundant, without needing a GL context.  The log only
+// contains ids (never pointers), assigned to resources in the order we first
+// see them, so the same frame always produces the same log.
+//
+// Run with '--headless' on the command line to have vsScreen create one of
+// these instead of the OpenGL renderer.  In headless mode, textures, render
+// targets, and shaders don't create any GPU objects, and screenshots are
+// just blank images.
+
+class vsRenderer_Recording: public vsRenderer, protected vsDisplayListState
+{
+public:
+
+	enum CommandType
+	{
+		Command_SetState,				// detail: State, a: new value
+		Command_SetRenderTarget,		// a: render target id
+		Command_Clear,					// detail: ClearFlags
+		Command_Blit,					// a: source render target id, b: destination render target id
+		Command_SetVertexArrayObject,	// a: VAO id (0 for the default VAO)
+		Command_BindBuffer,				// detail: Upload type it's bound as, a: buffer id
+		Command_UseProgram,				// a: shader id, b: variant bits
+		Command_PrepareShader,			// a: material id, b: shader values id
+		Command_BindTexture,			// detail: texture slot, a: texture id
+		Command_Upload,					// detail: Upload, a: bytes
+		Command_Draw,					// detail: Primitive, a: index count, b: instance count
+		Command_DrawBuffer,				// detail: Primitive, a: index buffer id, b: instance count
+		Command_Uniform,				// a: shader variant id, b: uniform index
+		Command_Present,
+		Command_MAX
+	};
+
+	enum State
+	{
+		State_ColorMask,
+		State_DepthMask,
+		State_DepthTest,
+		State_DepthFunc,
+		State_StencilTest,
+		State_StencilFunc,
+		State_StencilMask,
+		State_StencilOp,
+		State_PolygonOffsetFill,
+		State_PolygonOffset,
+		State_CullFace,
+		State_CullMode,
+		State_Blend,
+		State_BlendFunc,
+		State_ScissorTest,
+		State_Scissor,
+		State_Viewport,
+		State_FramebufferSRGB,
+		State_MAX
+	};
+
+	enum Upload
+	{
+		Upload_Vertex,
+		Upload_Normal,
+		Upload_Texel,
+		Upload_Color,
+		Upload_Index,
+		Upload_LocalToWorld,
+		Upload_InstanceColor,
+		Upload_Buffer,		// a vsRenderBuffer, bound whole
+		Upload_MAX
+	};
+
+	enum Primitive
+	{
+		Primitive_Points,
+		Primitive_Lines,
+		Primitive_LineStrip,
+		Primitive_Triangles,
+		Primitive_TriangleStrip,
+		Primitive_TriangleFan
+	};
+
+	enum ClearFlags
+	{
+		Clear_Color = BIT(0),
+		Clear_Depth = BIT(1),
+		Clear_Stencil = BIT(2)
+	};
+
+	struct Command
+	{
+		uint8_t		type;
+		uint8_t		detail;
+		uint16_t	padding;
+		uint32_t	a;
+		uint32_t	b;
+	};
+
+	struct Stats
+	{
+		uint64_t	frames;
+		uint64_t	ops;
+		uint64_t	draws;
+		uint64_t	instances;
+		uint64_t	indices;
+		uint64_t	commands;
+		uint64_t	stateSets;			// render state sets the OpenGL renderer would make
+		uint64_t	redundantStateSets;	// ...which set a value that was already current
+		uint64_t	programChanges;
+		uint64_t	shaderPrepares;
+		uint64_t	textureBinds;
+		uint64_t	redundantTextureBinds;
+		uint64_t	renderTargetChanges;
+		uint64_t	materialChanges;
+		uint64_t	redundantOps;		// display list ops which didn't change anything
+		uint64_t	bytesUploaded;
+		uint64_t	bufferBytesUploaded;	// subset of 'bytesUploaded' which came from vsRenderBuffers
+		uint64_t	uniformUploads;
+		uint64_t	uniformUploadsSkipped;	// uniform sets which the shaders skipped, as the value hadn't changed
+		uint64_t	opCount[vsDisplayList::OpCode_MAX];
+		uint64_t	redundantOpCount[vsDisplayList::OpCode_MAX];
+
+		Stats();
+		void Clear();
+		void Add( const Stats& other );
+	};
+
+private:
+
+	int					m_bufferCount;
+	bool				m_antialias;
+
+	vsShaderSuite *		m_defaultShaderSuite;
+
+	vsRenderTarget *	m_window;
+	vsRenderTarget *	m_scene;
+	vsRenderTarget *	m_currentRenderTarget;
+
+	const void *		m_currentVAO;	// nullptr for the default VAO
+
+	vsMaterial *		m_currentMaterial;
+	vsMaterialInternal *m_currentMaterialInternal;
+	vsShader *			m_currentShader;
+	vsRenderBuffer *	m_currentBoundBuffer;
+
+	vsBox2D				m_currentViewportPixels;
+	int					m_lightCount;
+	vsColor				m_lightAmbient;		// the OpenGL renderer only passes
+	vsColor				m_lightDiffuse;		// the first light to shaders
+	vsColor				m_lightSpecular;
+	vsVector3D			m_lightPosition;
+
+	// What we've told the (imaginary) GPU.
+	vsShader *			m_lastShader;
+	vsMaterial *		m_previousMaterial;
+	vsShaderValues *	m_previousShaderValues;
+	uint32_t			m_boundTexture[MAX_TEXTURE_SLOTS];
+	uint32_t			m_state[State_MAX];
+
+	// Resources get forgotten as they're destroyed (see
+	// NotifyResourceDestroyed()), so that a new resource which happens to be
+	// allocated at the same address gets a new id.
+	std::unordered_map<const void*, uint32_t>	m_resourceId;
+	uint32_t			m_nextResourceId;
+	vsMutex				m_resourceIdMutex;
+
+	vsArray<Command>	m_log[2];
+	int					m_logStorage[2];	// how many commands each log has room for
+	int					m_logIndex;
+	uint64_t			m_lastFrameHash;
+
+	Stats				m_frame;
+	Stats				m_lastFrame;
+	Stats				m_total;
+	std::atomic<uint64_t>	m_bufferBytesUploaded;	// vsRenderBuffers may upload from loading threads
+
+	uint32_t			ResourceId( const void *resource );
+	void				Record( CommandType type, uint8_t detail = 0, uint32_t a = 0, uint32_t b = 0 );
+	void				SetState( State state, uint32_t value );
+	void				Redundant( vsDisplayList::OpCode op, bool redundant );
+
+	void				RecordUpload( Upload type, size_t bytes );
+	void				RecordDraw( Primitive primitive, int indexCount );
+	void				RecordDrawBuffer( Primitive primitive, vsRenderBuffer *ib );
+	void				BindBuffer( Upload type, vsRenderBuffer *buffer );
+	void				BindTextures();
+
+	void				FlushRenderState();
+	void				SetMaterialInternal( vsMaterialInternal *material );
+	void				SetRenderTarget( vsRenderTarget *target );
+	void				SetVertexArrayObject( const void *vao, vsDisplayList::OpCode op );
+	void				ResizeRenderTargetsToMatchWindow();
+
+public:
+
+	vsRenderer_Recording(int width, int height, int depth, int flags, int bufferCount);
+	virtual ~vsRenderer_Recording();
+	void Deinit() override;
+
+	static vsRenderer_Recording* Instance() { return static_cast<vsRenderer_Recording*>(vsRenderer::Instance()); }
+
+	bool	CheckVideoMode() override;
+	void	UpdateVideoMode(int width, int height, int depth, WindowType type, int bufferCount, bool antialias, bool vsync, bool borderless) override;
+	void	NotifyResized(int width, int height) override;
+
+	void	ClearState() override;
+	void	RenderDisplayList( vsDisplayList *list ) override;
+	void	Present() override;
+
+	vsRenderTarget *GetMainRenderTarget() override { return m_scene; }
+	vsRenderTarget *GetPresentTarget() override { return m_window; }
+
+	vsShader*	DefaultShaderFor( vsMaterialInternal *mat ) override;
+	void		NotifyBufferUploaded( int bytes ) override;
+	void		NotifyUniformUploaded( const vsShaderVariant *variant, int uniform ) override;
+	void		NotifyResourceDestroyed( const void *resource ) override;
+
+	vsImage*	Screenshot() override;
+	vsImage*	Screenshot_Async() override;
+	vsImage*	ScreenshotBack() override;
+	vsImage*	ScreenshotDepth() override;
+	vsImage*	ScreenshotAlpha() override;
+
+	// The log of the frame being recorded right now, and of the last frame
+	// that was presented.
+	const vsArray<Command>&	GetLog() const { return m_log[m_logIndex]; }
+	const vsArray<Command>&	GetLastFrameLog() const { return m_log[m_logIndex^1]; }
+	uint64_t				GetLastFrameHash() const { return m_lastFrameHash; }	// FNV-1a of the last frame's log
+
+	// The id which the log uses for 'resource', or 0 if it hasn't been seen.
+	uint32_t				FindResourceId( const void *resource );
+
+	const Stats&	GetFrameStats() const { return m_frame; }
+	const Stats&	GetLastFrameStats() const { return m_lastFrame; }
+	const Stats&	GetTotalStats() const { return m_total; }
+	void			ResetStats();
+
+	void			LogStats( const Stats& stats ) const;
+};
+
+#endif // VS_RENDERER_RECORDING_H
@@ -17,6 +17,8 @@
 #include "VS_Screen.h"
 #include "VS_System.h"
 #include "VS_Profile.h"
+#include "VS_ParallelDraw.h"
+#include "VS_FrameArena.h"
 //#include "VS_Transform.h"
 
 #include "VS_OpenGL.h"
@@ -79,7 +81,8 @@ vsScene::vsScene( const vsString& name ):
 	m_stencilTest( false ),
 	m_hasViewport( false ),
 	m_enabled( true ),
-	m_clearDepth( false )
+	m_clearDepth( false ),
+	m_parallelDraw( false )
 {
 	// m_queue->GetGenericList()->SetResizable();
 	m_camera = m_defaultCamera;
@@ -309,14 +312,33 @@ vsScene::Draw( vsDisplayList *list, vsRenderTarget *target, int flags )
 
 	{
 		PROFILE("Scene::DrawEntities");
-		vsEntity *entity = m_entityList->GetNext();
-		while ( entity != m_entityList )
+		if ( m_parallelDraw && vsParallelDraw::Instance() )
 		{
-			if ( m_is3d || (!m_camera || entity->OnScreen( m_camera->GetCameraTransform() )) )
+			int entityCount = 0;
+			for ( vsEntity *entity = m_entityList->GetNext(); entity != m_entityList; entity = entity->GetNext() )
+				entityCount++;
+
+			vsEntity **visible = vsFrameArena::Instance()->Alloc<vsEntity*>( entityCount );
+			int visibleCount = 0;
+			for ( vsEntity *entity = m_entityList->GetNext(); entity != m_entityList; entity = entity->GetNext() )
+			{
+				if ( m_is3d || (!m_camera || entity->OnScreen( m_camera->GetCameraTransform() )) )
+					visible[visibleCount++] = entity;
+			}
+
+			vsParallelDraw::Instance()->Draw( &s_renderQueue, visible, visibleCount );
+		}
+		else
+		{
+			vsEntity *entity = m_entityList->GetNext();
+			while ( entity != m_entityList )
 			{
-				entity->Draw( &s_renderQueue );
+				if ( m_is3d || (!m_camera || entity->OnScreen( m_camera->GetCameraTransform() )) )
+				{
+					entity->Draw( &s_renderQueue );
+				}
+				entity = entity->GetNext();
 			}
-			entity = entity->GetNext();
 		}
 	}
 
@@ -50,6 +50,7 @@ class vsScene
 	bool			m_hasViewport;
 	bool			m_enabled;	// if false, we won't automatically draw this scene
 	bool			m_clearDepth;
+	bool			m_parallelDraw;
 
 public:
 
@@ -61,6 +62,12 @@ public:
 
 	void			SetClearDepth(bool cd) { m_clearDepth = cd; }
 
+	// If set, our entities build their parts of the render queue on several
+	// threads at once.  Only turn this on if every entity's Draw() is
+	// thread-safe!  (See vsParallelDraw for details)
+	void			SetParallelDraw(bool parallel) { m_parallelDraw = parallel; }
+	bool			IsParallelDraw() const { return m_parallelDraw; }
+
 	void			SetEnabled(bool enable) { m_enabled = enable; }
 	bool			IsEnabled() { return m_enabled; }
 
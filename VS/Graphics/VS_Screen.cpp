@@ -9,11 +9,14 @@
 
 #include "VS_Screen.h"
 #include "VS_DisplayList.h"
+#include "VS_FrameArena.h"
+#include "VS_Heap.h"
 #include "VS_RenderPipeline.h"
 #include "VS_RenderPipelineStage.h"
 #include "VS_RenderPipelineStageBlit.h"
 #include "VS_RenderPipelineStageScenes.h"
 #include "VS_Renderer_OpenGL3.h"
+#include "VS_Renderer_Recording.h"
 #include "VS_RenderTarget.h"
 #include "VS_Scene.h"
 #include "VS_System.h"
@@ -34,6 +37,8 @@ vsScreen::vsScreen(int width, int height, int depth, vsRenderer::WindowType wind
 	m_sceneCount(0),
 	m_fifoUsageLastFrame(0),
 	m_fifoHighWater(0),
+	m_renderHeapAllocations(0),
+	m_renderHeapAllocationsLastFrame(0),
 	m_width(width),
 	m_height(height),
 	m_bufferCount(bufferCount),
@@ -64,7 +69,10 @@ vsScreen::vsScreen(int width, int height, int depth, vsRenderer::WindowType wind
 	flags |= vsRenderer::Flag_Resizable;
 
 	vsLog("Width before:  %d", m_width);
-	m_renderer = new vsRenderer_OpenGL3(m_width, m_height, m_depth, flags, bufferCount);
+	if ( vsRenderer::IsHeadless() )
+		m_renderer = new vsRenderer_Recording(m_width, m_height, m_depth, flags, bufferCount);
+	else
+		m_renderer = new vsRenderer_OpenGL3(m_width, m_height, m_depth, flags, bufferCount);
 
 	m_width = m_renderer->GetWidth();
 	m_height = m_renderer->GetHeight();
@@ -272,7 +280,7 @@ vsScreen::DrawPipeline_ThreadSafe( vsRenderPipeline *pipeline, vsShaderOptions *
 		// easy case, we're already on the main thread so just call DrawPipeline!
 		return DrawPipeline(pipeline, customOptions);
 	}
-	if ( vsRenderer_OpenGL3::Instance()->IsLoadingContext() )
+	if ( !vsRenderer::IsHeadless() && vsRenderer_OpenGL3::Instance()->IsLoadingContext() )
 	{
 		// ensure everything above has reached the main thread before we
 		// try to draw our map!
@@ -331,6 +339,7 @@ void
 vsScreen::_DrawPipeline( vsRenderPipeline *pipeline, vsShaderOptions *customOptions )
 {
 	vsTimerSystem::Instance()->BeginDraw();
+	uint64_t allocationsAtStart = vsHeap::GetAllocationCount();
 
 	PROFILE_GL("DrawPipeline");
 	m_currentSettings = &m_defaultRenderSettings;
@@ -365,6 +374,7 @@ vsScreen::_DrawPipeline( vsRenderPipeline *pipeline, vsShaderOptions *customOpti
 	pipeline->PostDraw();
 
 	m_currentSettings = nullptr;
+	m_renderHeapAllocations += vsHeap::GetAllocationCount() - allocationsAtStart;
 	vsTimerSystem::Instance()->EndDraw();
 }
 
@@ -374,6 +384,12 @@ vsScreen::Present()
 	vsTimerSystem::Instance()->BeginPresent();
 	m_renderer->Present();
 	vsTimerSystem::Instance()->EndPresent();
+
+	m_renderHeapAllocationsLastFrame = m_renderHeapAllocations;
+	m_renderHeapAllocations = 0;
+
+	if ( vsFrameArena::Instance() )
+		vsFrameArena::Instance()->FrameRendered();
 }
 
 vsScene *
@@ -36,6 +36,8 @@ class vsScreen
 	int					m_sceneCount;	// how many layers we have
 	size_t				m_fifoUsageLastFrame;
 	size_t				m_fifoHighWater;
+	uint64_t			m_renderHeapAllocations;
+	uint64_t			m_renderHeapAllocationsLastFrame;
 
 	vsDisplayList *		m_fifo;			// our FIFO display list, for rendering
 
@@ -109,6 +111,11 @@ public:
 	size_t			GetFifoSize() { return m_fifo->GetMaxSize(); }
 	// Returns the number of bytes we used in the fifo buffer last frame.
 	size_t			GetFifoUsage() { return m_fifoUsageLastFrame; }
+	// Returns the number of heap allocations made while building and
+	// rendering last frame's display lists.  In steady state this should be
+	// zero.  (Only counted when VS_INTERNAL_ALLOCATORS or VS_WRAP_ALLOCATORS
+	// is enabled)
+	uint64_t		GetRenderHeapAllocations() { return m_renderHeapAllocationsLastFrame; }
 
 	void			CreateScenes(int count);
 	void			DestroyScenes();
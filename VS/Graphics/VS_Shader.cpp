@@ -102,6 +102,8 @@ vsShader::~vsShader()
 	// vsRenderer_OpenGL3::DestroyShader(m_shader);
 	// vsDeleteArray( m_uniform );
 	// vsDeleteArray( m_attribute );
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 void
@@ -370,6 +372,19 @@ vsShader::SetViewport( const vsVector2D& dims )
 	m_current->SetViewport(dims);
 }
 
+bool
+vsShader::NeedsRendererUniforms( uint32_t generation )
+{
+	return m_current->NeedsRendererUniforms(generation);
+}
+
+uint32_t
+vsShader::NextRendererUniformsGeneration()
+{
+	static uint32_t s_generation = 0;
+	return ++s_generation;
+}
+
 int32_t
 vsShader::GetUniformId(const vsString& name) const
 {
@@ -57,6 +57,7 @@ public:
 		int32_t type;
 		int32_t arraySize;
 		int32_t def;
+		bool builtIn;	// set by the renderer every draw, rather than from shader values
 	};
 	struct Attribute
 	{
@@ -111,6 +112,14 @@ public:
 	void SetViewToProjection( const vsMatrix4x4& projection );
 	void SetViewport( const vsVector2D& dims );
 
+	// The renderer's own uniforms (fog, camera, projection, viewport, and
+	// lights) only change a few times per frame, so the renderer tags each
+	// set of them with a generation number from NextRendererUniformsGeneration().
+	// If the current variant has already been given that generation's values,
+	// this returns false and you can skip setting them.
+	bool NeedsRendererUniforms( uint32_t generation );
+	static uint32_t NextRendererUniformsGeneration();
+
 	const Uniform *GetUniform(int i) const;
 	int32_t GetUniformId(const vsString& name) const;
 	int32_t GetUniformCount() const;
@@ -11,6 +11,9 @@
 #include "VS_ShaderRef.h"
 
 #include "VS_TimerSystem.h"
+#include "VS_Heap.h"
+
+extern vsHeap *g_globalHeap;
 
 namespace
 {
@@ -62,10 +65,15 @@ vsShaderCache::LoadShader( const vsString& vFile, const vsString& fFile, bool li
 	{
 		// loads++;
 		// unsigned long before = vsTimerSystem::Instance()->GetMicroseconds();
+
+		// Cached shaders outlive the game which loaded them (see the [TODO]
+		// above), so they mustn't count against its heap.
+		vsHeap::Push(g_globalHeap);
 		shader = vsShader::Load( vFile, fFile, lit, texture );
 		// unsigned long after = vsTimerSystem::Instance()->GetMicroseconds();
 		// vsLog("Loading shader [%d] '%s', '%s', %d, %d: %f milliseconds", loads, vFile, fFile, lit, texture, (after-before)/1000.f);
 		AddShader( uniqueName, shader );
+		vsHeap::Pop(g_globalHeap);
 	}
 
 	vsShaderRef *ref = new vsShaderRef(shader);
@@ -8,6 +8,9 @@
  */
 
 #include "VS_ShaderUniformRegistry.h"
+#include "VS_Heap.h"
+
+extern vsHeap *g_globalHeap;
 
 namespace
 {
@@ -34,7 +37,11 @@ vsShaderUniformRegistry::UID( const vsString& uniformName )
 	if ( result )
 		return *result;
 
+	// Names stay registered after the game which first used them exits, so
+	// they belong on the global heap, not that game's.
+	vsHeap::Push(g_globalHeap);
 	m_uniform->AddItemWithKey(m_uniformCount, uniformName);
+	vsHeap::Pop(g_globalHeap);
 	return m_uniformCount++;
 }
 
@@ -13,10 +13,15 @@
 #include "VS_OpenGL.h"
 #include "VS_Matrix.h"
 #include "VS_Profile.h"
+#include "VS_Renderer.h"
+
+std::atomic<uint32_t> vsShaderValues::s_generation(0);
 
 vsShaderValues::vsShaderValues():
 	m_parent(nullptr),
-	m_value(16)
+	m_value(16),
+	m_generation(++s_generation),
+	m_hasBoundValues(false)
 {
 	for ( int i = 0; i < MAX_TEXTURE_SLOTS; i++ )
 	{
@@ -27,7 +32,9 @@ vsShaderValues::vsShaderValues():
 
 vsShaderValues::vsShaderValues( const vsShaderValues& other ):
 	m_parent(nullptr),
-	m_value(16)
+	m_value(16),
+	m_generation(++s_generation),
+	m_hasBoundValues(other.m_hasBoundValues)
 {
 	int valueCount = other.m_value.GetHashEntryCount();
 
@@ -44,6 +51,12 @@ vsShaderValues::vsShaderValues( const vsShaderValues& other ):
 	}
 }
 
+vsShaderValues::~vsShaderValues()
+{
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
+}
+
 void
 vsShaderValues::SetUniformF( const vsString& name, float value )
 {
@@ -52,6 +65,7 @@ vsShaderValues::SetUniformF( const vsString& name, float value )
 		m_value[id].u.f32 = value;
 		m_value[id].type = Value::Type_Float;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -63,6 +77,7 @@ vsShaderValues::SetUniformB( const vsString& name, bool value )
 		m_value[id].u.b = value;
 		m_value[id].type = Value::Type_Bool;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -74,6 +89,7 @@ vsShaderValues::SetUniformI( const vsString& name, int value )
 		m_value[id].u.i = value;
 		m_value[id].type = Value::Type_Int;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -88,6 +104,7 @@ vsShaderValues::SetUniformColor( const vsString& name, const vsColor& value )
 		m_value[id].u.vec4[3] = value.a;
 		m_value[id].type = Value::Type_Vec4;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -102,6 +119,7 @@ vsShaderValues::SetUniformVec2( const vsString& name, const vsVector2D& value )
 		m_value[id].u.vec4[3] = 0.0;
 		m_value[id].type = Value::Type_Vec4;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -116,6 +134,7 @@ vsShaderValues::SetUniformVec3( const vsString& name, const vsVector3D& value )
 		m_value[id].u.vec4[3] = 0.0;
 		m_value[id].type = Value::Type_Vec4;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -130,6 +149,7 @@ vsShaderValues::SetUniformVec4( const vsString& name, const vsVector4D& value )
 		m_value[id].u.vec4[3] = value.w;
 		m_value[id].type = Value::Type_Vec4;
 		m_value[id].bound = false;
+		Changed();
 	}
 }
 
@@ -141,6 +161,8 @@ vsShaderValues::BindUniformF( const vsString& name, const float* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -154,6 +176,8 @@ vsShaderValues::BindUniformB( const vsString& name, const bool* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -167,6 +191,8 @@ vsShaderValues::BindUniformI( const vsString& name, const int* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -180,6 +206,8 @@ vsShaderValues::BindUniformColor( const vsString& name, const vsColor* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -193,6 +221,8 @@ vsShaderValues::BindUniformVec2( const vsString& name, const vsVector2D* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -206,6 +236,8 @@ vsShaderValues::BindUniformVec3( const vsString& name, const vsVector3D* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -219,6 +251,8 @@ vsShaderValues::BindUniformVec4( const vsString& name, const vsVector4D* value )
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
@@ -232,11 +266,43 @@ vsShaderValues::BindUniformMat4( const vsString& name, const vsMatrix4x4* value
 		m_value[id].u.bind = value;
 		m_value[id].type = Value::Type_Bind;
 		m_value[id].bound = true;
+		m_hasBoundValues = true;
+		Changed();
 		return true;
 	}
 	return false;
 }
 
+void
+vsShaderValues::SetParent( vsShaderValues *parent )
+{
+	m_parent = parent;
+	Changed();
+}
+
+void
+vsShaderValues::Changed()
+{
+	m_generation = ++s_generation;
+}
+
+uint32_t
+vsShaderValues::GetGeneration() const
+{
+	// Every change anywhere takes a new, higher number from s_generation, so
+	// the highest number in our parent chain changes whenever anything in
+	// the chain does.
+	if ( m_parent )
+		return vsMax( m_generation, m_parent->GetGeneration() );
+	return m_generation;
+}
+
+bool
+vsShaderValues::HasBoundUniforms() const
+{
+	return m_hasBoundValues || ( m_parent && m_parent->HasBoundUniforms() );
+}
+
 bool
 vsShaderValues::Has( const vsString& name ) const
 {
@@ -451,6 +517,8 @@ vsShaderValues::operator=( const vsShaderValues& other )
 		m_texture[i] = other.m_texture[i];
 		m_textureSet[i] = other.m_textureSet[i];
 	}
+	m_hasBoundValues = other.m_hasBoundValues;
+	Changed();
 	return *this;
 }
 
@@ -13,6 +13,7 @@
 #include "VS/Utils/VS_HashTable.h"
 #include "VS/Utils/VS_IntHashTable.h"
 #include "VS/Utils/VS_String.h"
+#include <atomic>
 
 class vsColor;
 class vsShader;
@@ -64,13 +65,22 @@ class vsShaderValues
 	vsIntHashTable<Value> m_value;
 	vsTexture *m_texture[48];
 	bool m_textureSet[48];
+
+	// Atomic, since shader values can be created and changed on
+	// vsParallelDraw's worker threads, and every change needs a unique number.
+	static std::atomic<uint32_t> s_generation;
+	uint32_t m_generation;
+	bool m_hasBoundValues;
+
+	void Changed();
 public:
 
 	vsShaderValues();
 	vsShaderValues( const vsShaderValues& other );
+	~vsShaderValues();
 
 	// a parent object will handle any uniforms which we don't set ourselves.
-	void SetParent( vsShaderValues *parent ) { m_parent = parent; }
+	void SetParent( vsShaderValues *parent );
 
 	void SetUniformF( const vsString& name, float value );
 	void SetUniformB( const vsString& name, bool value );
@@ -96,6 +106,13 @@ public:
 	bool UniformVec4( uint32_t uid, vsVector4D& out ) const;
 	bool UniformMat4( uint32_t uid, vsMatrix4x4& out ) const;
 
+	// GetGeneration() changes whenever any of our uniforms (or our parent's)
+	// change, so shaders can tell when they need to look at us again.  Except
+	// that bound uniforms can change without us knowing about it, so if we
+	// HasBoundUniforms(), the generation can't be trusted.
+	uint32_t GetGeneration() const;
+	bool HasBoundUniforms() const;
+
 	bool operator==( const vsShaderValues& other ) const;
 	bool operator!=( const vsShaderValues& other ) const { return ! (*this == other); }
 
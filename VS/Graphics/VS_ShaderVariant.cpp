@@ -17,6 +17,7 @@
 #include "VS_ShaderValues.h"
 #include "VS_ShaderUniformRegistry.h"
 #include "VS_TimerSystem.h"
+#include "VS_Renderer.h"
 #include "VS_Renderer_OpenGL3.h"
 #include "VS_RenderBuffer.h"
 #include "VS_Profile.h"
@@ -27,6 +28,255 @@
 
 	extern vsArray<vsShaderVariantDefinition> g_shaderVariantDefinitions;
 
+int vsShaderVariant::s_uniformUploads = 0;
+int vsShaderVariant::s_uniformUploadsSkipped = 0;
+
+namespace
+{
+	// An active uniform, the way that glGetActiveUniform() would describe it.
+	struct DeclaredUniform
+	{
+		vsString name;
+		GLenum type;
+		GLint arraySize;
+	};
+
+	struct DeclaredType
+	{
+		vsString name;
+		vsArray<vsString> memberType;
+		vsArray<vsString> memberName;
+		vsArray<int> memberArraySize;
+	};
+
+	GLenum GLTypeFor( const vsString& type )
+	{
+		static const struct { const char *name; GLenum type; } c_types[] =
+		{
+			{ "bool", GL_BOOL },
+			{ "int", GL_INT },
+			{ "uint", GL_UNSIGNED_INT },
+			{ "float", GL_FLOAT },
+			{ "vec2", GL_FLOAT_VEC2 },
+			{ "vec3", GL_FLOAT_VEC3 },
+			{ "vec4", GL_FLOAT_VEC4 },
+			{ "mat4", GL_FLOAT_MAT4 },
+			{ "sampler2D", GL_SAMPLER_2D },
+			{ "usampler2D", GL_UNSIGNED_INT_SAMPLER_2D },
+			{ "sampler2DShadow", GL_SAMPLER_2D_SHADOW },
+			{ "samplerBuffer", GL_SAMPLER_BUFFER },
+			{ "isamplerBuffer", GL_INT_SAMPLER_BUFFER },
+			{ "usamplerBuffer", GL_UNSIGNED_INT_SAMPLER_BUFFER },
+		};
+		for ( size_t i = 0; i < sizeof(c_types)/sizeof(c_types[0]); i++ )
+			if ( type == c_types[i].name )
+				return c_types[i].type;
+		return 0;
+	}
+
+	// Splits GLSL source into identifiers, numbers, and single punctuation
+	// characters, dropping comments and anything which the preprocessor
+	// would have removed.  We only understand #define, #ifdef, #ifndef,
+	// #else, and #endif;  any other #if is assumed to be true.
+	void Tokenize( const vsString& source, vsArray<vsString>& tokens )
+	{
+		vsArray<vsString> defines;
+		vsArray<bool> active;	// one per nested #if;  whether its current branch is live
+		bool live = true;
+
+		size_t i = 0;
+		bool lineStart = true;
+		while ( i < source.size() )
+		{
+			char c = source[i];
+			if ( c == '/' && i+1 < source.size() && source[i+1] == '/' )
+			{
+				while ( i < source.size() && source[i] != '\n' )
+					i++;
+				continue;
+			}
+			if ( c == '/' && i+1 < source.size() && source[i+1] == '*' )
+			{
+				size_t end = source.find( "*/", i+2 );
+				i = ( end == vsString::npos ) ? source.size() : end + 2;
+				continue;
+			}
+			if ( c == '\n' )
+			{
+				lineStart = true;
+				i++;
+				continue;
+			}
+			if ( c == ' ' || c == '\t' || c == '\r' )
+			{
+				i++;
+				continue;
+			}
+			if ( c == '#' && lineStart )
+			{
+				size_t end = source.find( '\n', i );
+				if ( end == vsString::npos )
+					end = source.size();
+				vsString directive = source.substr( i+1, end-i-1 );
+				i = end;
+
+				vsString words[2];
+				size_t cursor = 0;
+				for ( int w = 0; w < 2; w++ )
+				{
+					size_t start = directive.find_first_not_of( " \t", cursor );
+					if ( start == vsString::npos )
+						break;
+					cursor = directive.find_first_of( " \t\r", start );
+					words[w] = directive.substr( start, cursor == vsString::npos ? vsString::npos : cursor-start );
+					if ( cursor == vsString::npos )
+						break;
+				}
+
+				if ( words[0] == "ifdef" || words[0] == "ifndef" || words[0] == "if" )
+				{
+					bool defined = defines.Contains( words[1] );
+					bool condition = ( words[0] == "ifdef" ) ? defined : ( words[0] == "ifndef" ) ? !defined : true;
+					active.AddItem( live );
+					live = live && condition;
+				}
+				else if ( ( words[0] == "else" || words[0] == "elif" ) && active.ItemCount() > 0 )
+					live = active[active.ItemCount()-1] && !live;
+				else if ( words[0] == "endif" && active.ItemCount() > 0 )
+				{
+					live = active[active.ItemCount()-1];
+					active.PopBack();
+				}
+				else if ( words[0] == "define" && live )
+					defines.AddItem( words[1] );
+				continue;
+			}
+
+			lineStart = false;
+			size_t start = i;
+			if ( isalnum(c) || c == '_' )
+			{
+				while ( i < source.size() && ( isalnum(source[i]) || source[i] == '_' ) )
+					i++;
+			}
+			else
+				i++;
+			if ( live )
+				tokens.AddItem( source.substr( start, i-start ) );
+		}
+	}
+
+	void AddDeclaredUniform( vsArray<DeclaredUniform>& out, const vsString& name, GLenum type, int arraySize )
+	{
+		DeclaredUniform u;
+		// GL reports arrays by the name of their first element.
+		u.name = ( arraySize > 0 ) ? name + "[0]" : name;
+		u.type = type;
+		u.arraySize = vsMax( arraySize, 1 );
+		for ( int i = 0; i < out.ItemCount(); i++ )
+			if ( out[i].name == u.name )
+				return;
+		out.AddItem( u );
+	}
+
+	void AddDeclaredUniform( vsArray<DeclaredUniform>& out, const vsArray<DeclaredType>& types, const vsString& typeName, const vsString& name, int arraySize )
+	{
+		GLenum type = GLTypeFor( typeName );
+		if ( type )
+		{
+			AddDeclaredUniform( out, name, type, arraySize );
+			return;
+		}
+		for ( int t = 0; t < types.ItemCount(); t++ )
+		{
+			if ( types[t].name != typeName )
+				continue;
+			// arrays of structs get reported one member of one element at a time.
+			for ( int e = 0; e < vsMax( arraySize, 1 ); e++ )
+			{
+				vsString element = ( arraySize > 0 ) ? vsFormatString( "%s[%d]", name, e ) : name;
+				for ( int m = 0; m < types[t].memberName.ItemCount(); m++ )
+					AddDeclaredUniform( out, types, types[t].memberType[m], element + "." + types[t].memberName[m], types[t].memberArraySize[m] );
+			}
+			return;
+		}
+	}
+
+	// Reads the next declarator ("name" or "name[N]") at 'cursor', returning
+	// the array size, or 0 if it isn't an array.
+	int ParseDeclarator( const vsArray<vsString>& tokens, int& cursor, vsString& name )
+	{
+		name = tokens[cursor++];
+		int arraySize = 0;
+		if ( cursor+2 < tokens.ItemCount() && tokens[cursor] == "[" && tokens[cursor+2] == "]" )
+		{
+			arraySize = atoi( tokens[cursor+1].c_str() );
+			cursor += 3;
+		}
+		return arraySize;
+	}
+
+	bool IsQualifier( const vsString& token )
+	{
+		return ( token == "lowp" || token == "mediump" || token == "highp" || token == "flat" );
+	}
+
+	// Finds the uniforms declared in GLSL source.  When we're headless we
+	// have no GL program to ask, so this stands in for glGetActiveUniform().
+	// Unlike GL, we report uniforms even if the shader never reads them.
+	void FindDeclaredUniforms( const vsString& source, vsArray<DeclaredUniform>& out )
+	{
+		vsArray<vsString> tokens;
+		Tokenize( source, tokens );
+		vsArray<DeclaredType> types;
+
+		int cursor = 0;
+		while ( cursor < tokens.ItemCount() )
+		{
+			if ( tokens[cursor] == "struct" && cursor+2 < tokens.ItemCount() && tokens[cursor+2] == "{" )
+			{
+				DeclaredType type;
+				type.name = tokens[cursor+1];
+				cursor += 3;
+				while ( cursor+1 < tokens.ItemCount() && tokens[cursor] != "}" )
+				{
+					while ( IsQualifier(tokens[cursor]) )
+						cursor++;
+					vsString memberType = tokens[cursor++];
+					while ( cursor < tokens.ItemCount() && tokens[cursor] != ";" )
+					{
+						vsString memberName;
+						int arraySize = ParseDeclarator( tokens, cursor, memberName );
+						type.memberType.AddItem( memberType );
+						type.memberName.AddItem( memberName );
+						type.memberArraySize.AddItem( arraySize );
+						if ( cursor < tokens.ItemCount() && tokens[cursor] == "," )
+							cursor++;
+					}
+					cursor++;
+				}
+				types.AddItem( type );
+			}
+			else if ( tokens[cursor] == "uniform" && cursor+2 < tokens.ItemCount() )
+			{
+				cursor++;
+				while ( IsQualifier(tokens[cursor]) )
+					cursor++;
+				vsString typeName = tokens[cursor++];
+				while ( cursor < tokens.ItemCount() && tokens[cursor] != ";" )
+				{
+					vsString name;
+					int arraySize = ParseDeclarator( tokens, cursor, name );
+					AddDeclaredUniform( out, types, typeName, name, arraySize );
+					if ( cursor < tokens.ItemCount() && tokens[cursor] == "," )
+						cursor++;
+				}
+			}
+			cursor++;
+		}
+	}
+}
+
 vsShaderVariant::vsShaderVariant( const vsString &vertexShader,
 		const vsString &fragmentShader,
 		bool lit,
@@ -41,6 +291,13 @@ vsShaderVariant::vsShaderVariant( const vsString &vertexShader,
 	m_vertexShaderFile(vFilename),
 	m_fragmentShaderFile(fFilename),
 	m_system(false),
+	m_preparedMaterialValues(nullptr),
+	m_preparedValues(nullptr),
+	m_preparedMaterialGeneration(0),
+	m_preparedValuesGeneration(0),
+	m_rendererUniformsGeneration(0),
+	m_valueUniformCount(0),
+	m_rendererUniformCount(0),
 	m_shader(-1),
 	m_variantBits(variantBits),
 	m_litBool(lit),
@@ -192,17 +449,30 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 	vString = version + vFilename + vString;
 	fString = version + fFilename + fString;
 
-#if !TARGET_OS_IPHONE
-	if ( m_shader == 0xffffffff )
-		m_shader = vsRenderer_OpenGL3::Compile( vString, fString );
+	int activeUniformCount = 0;
+	vsArray<DeclaredUniform> declared;
+	if ( vsRenderer::IsHeadless() )
+	{
+		// No GL program to query, so we read our uniforms out of the source,
+		// and end up with no attributes.
+		FindDeclaredUniforms( vString, declared );
+		FindDeclaredUniforms( fString, declared );
+		activeUniformCount = declared.ItemCount();
+		m_attributeCount = 0;
+	}
 	else
-		vsRenderer_OpenGL3::Compile( m_shader, vString, fString, false );
-	// vsLog("Created shader %d", m_shader);
+	{
+#if !TARGET_OS_IPHONE
+		if ( m_shader == 0xffffffff )
+			m_shader = vsRenderer_OpenGL3::Compile( vString, fString );
+		else
+			vsRenderer_OpenGL3::Compile( m_shader, vString, fString, false );
+		// vsLog("Created shader %d", m_shader);
 #endif // TARGET_OS_IPHONE
 
-	int activeUniformCount = 0;
-	glGetProgramiv( m_shader, GL_ACTIVE_UNIFORMS, &activeUniformCount );
-	glGetProgramiv( m_shader, GL_ACTIVE_ATTRIBUTES, &m_attributeCount );
+		glGetProgramiv( m_shader, GL_ACTIVE_UNIFORMS, &activeUniformCount );
+		glGetProgramiv( m_shader, GL_ACTIVE_ATTRIBUTES, &m_attributeCount );
+	}
 
 	// 'activeUniformCount' only counts an array of uniforms as a single thing.
 	// We're going to expand those out so that we can bind values to individual
@@ -217,7 +487,10 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 		GLint arraySize = 0;
 		GLenum type = 0;
 		GLsizei actualLength = 0;
-		glGetActiveUniform(m_shader, i, c_maxNameLength, &actualLength, &arraySize, &type, nameBuffer);
+		if ( vsRenderer::IsHeadless() )
+			arraySize = declared[i].arraySize;
+		else
+			glGetActiveUniform(m_shader, i, c_maxNameLength, &actualLength, &arraySize, &type, nameBuffer);
 		m_uniformCount += arraySize;
 	}
 
@@ -230,9 +503,18 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 		GLint arraySize = 0;
 		GLenum type = 0;
 		GLsizei actualLength = 0;
-		glGetActiveUniform(m_shader, i, c_maxNameLength, &actualLength, &arraySize, &type, nameBuffer);
-
-		vsString baseName = vsString(nameBuffer);
+		vsString baseName;
+		if ( vsRenderer::IsHeadless() )
+		{
+			baseName = declared[i].name;
+			arraySize = declared[i].arraySize;
+			type = declared[i].type;
+		}
+		else
+		{
+			glGetActiveUniform(m_shader, i, c_maxNameLength, &actualLength, &arraySize, &type, nameBuffer);
+			baseName = vsString(nameBuffer);
+		}
 		vsString::size_type arrayPos = baseName.find("[0]");
 
 		for ( int arrayIndex = 0; arrayIndex < arraySize; arrayIndex++ )
@@ -248,19 +530,20 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 
 			m_uniform[ui].name = name;
 			m_uniform[ui].uid = vsShaderUniformRegistry::UID(name);
-			m_uniform[ui].loc = glGetUniformLocation(m_shader, name.c_str());
+			m_uniform[ui].loc = vsRenderer::IsHeadless() ? ui : glGetUniformLocation(m_shader, name.c_str());
 			m_uniform[ui].type = type;
 			m_uniform[ui].arraySize = arraySize;
 			m_uniform[ui].i32 = 0;
 			m_uniform[ui].u32 = 0;
 			m_uniform[ui].f32 = 0.f;
+			m_uniform[ui].builtIn = false;
 			if ( baseName == "textures" )
 				m_uniform[ui].def = arrayIndex;
 			else
 				m_uniform[ui].def = 0;
 
 			// initialise to random values, so we definitely set them at least once.
-			switch ( m_uniform[ui].type )
+			switch ( vsRenderer::IsHeadless() ? 0 : m_uniform[ui].type )
 			{
 				case GL_BOOL:
 				case GL_INT:
@@ -339,7 +622,7 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 	m_fogColorId = GetUniformId("fogColor");
 
 	// Caution, raw loc here!
-	m_instanceColorAttributeLoc = glGetAttribLocation(m_shader, "instanceColorAttrib");
+	m_instanceColorAttributeLoc = vsRenderer::IsHeadless() ? -1 : glGetAttribLocation(m_shader, "instanceColorAttrib");
 
 	m_colorUniformId = GetUniformId("universal_color");
 	m_hasInstanceColorsUniformId = GetUniformId("hasInstanceColors");
@@ -357,7 +640,7 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 	m_cameraDirectionUniformId = GetUniformId("cameraDirection");
 
 
-	m_localToWorldAttributeLoc = glGetAttribLocation(m_shader, "localToWorldAttrib");
+	m_localToWorldAttributeLoc = vsRenderer::IsHeadless() ? -1 : glGetAttribLocation(m_shader, "localToWorldAttrib");
 
 	// for ( int i = 0; i < 4; i++ )
 	// {
@@ -372,6 +655,45 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 
 	m_depthOnlyUniformId = GetUniformId("depthOnly");
 
+	// These get set by the renderer (or the bottom of Prepare()) on every
+	// draw, so there's no point in Prepare() setting them from shader values
+	// first.
+	const int32_t builtInIds[] =
+	{
+		m_colorUniformId, m_hasInstanceColorsUniformId, m_resolutionUniformId,
+		m_mouseUniformId, m_depthOnlyUniformId, m_globalTimeUniformId,
+		m_globalSecondsUniformId, m_globalMicrosecondsUniformId
+	};
+	const int32_t rendererIds[] =
+	{
+		m_fogColorId, m_fogDensityId, m_worldToViewUniformId,
+		m_cameraPositionUniformId, m_cameraDirectionUniformId,
+		m_viewToProjectionUniformId, m_viewportUniformId,
+		m_lightAmbientUniformId, m_lightDiffuseUniformId, m_lightSpecularUniformId,
+		m_lightPositionUniformId, m_lightHalfVectorUniformId
+	};
+	m_rendererUniformCount = 0;
+	for ( size_t i = 0; i < sizeof(builtInIds)/sizeof(builtInIds[0]); i++ )
+		if ( builtInIds[i] >= 0 )
+			m_uniform[ builtInIds[i] ].builtIn = true;
+	for ( size_t i = 0; i < sizeof(rendererIds)/sizeof(rendererIds[0]); i++ )
+	{
+		if ( rendererIds[i] >= 0 )
+		{
+			m_uniform[ rendererIds[i] ].builtIn = true;
+			m_rendererUniformCount++;
+		}
+	}
+	m_valueUniformCount = 0;
+	for ( int i = 0; i < m_uniformCount; i++ )
+		if ( !m_uniform[i].builtIn )
+			m_valueUniformCount++;
+
+	// We may have a new program, so forget what we've set.
+	m_preparedMaterialValues = nullptr;
+	m_preparedValues = nullptr;
+	m_rendererUniformsGeneration = 0;
+
 
 
 	vsDeleteArray( oldUniform );
@@ -381,9 +703,12 @@ vsShaderVariant::Compile( const vsString &vertexShader, const vsString &fragment
 vsShaderVariant::~vsShaderVariant()
 {
 	// vsLog("Destroyed shader %d", m_shader);
-	vsRenderer_OpenGL3::DestroyShader(m_shader);
+	if ( !vsRenderer::IsHeadless() )
+		vsRenderer_OpenGL3::DestroyShader(m_shader);
 	vsDeleteArray( m_uniform );
 	vsDeleteArray( m_attribute );
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 void
@@ -429,7 +754,7 @@ vsShaderVariant::SetColor( vsVertexArrayObject *vao, const vsColor& color )
 		SetUniformValueVec4( m_colorUniformId, color );
 	}
 	// this is vertex color;  don't set that!
-	if ( !vao->IsSet(3) )
+	if ( !vsRenderer::IsHeadless() && !vao->IsSet(3) )
 		vao->SetStaticAttribute4F( 3, vsVector4D(1,1,1,1) );
 	// glVertexAttrib4f( 3, 1.f, 1.f, 1.f, 1.f );
 
@@ -561,6 +886,9 @@ vsShaderVariant::SetLocalToWorld( vsVertexArrayObject *vao, const vsMatrix4x4* l
 			inv.x.x = -2.f;
 			SetUniformValueMat4( m_localToWorldUniformId, inv );
 		}
+		// shader values can set this one too, so Prepare() needs to look
+		// at it again next time.
+		m_preparedMaterialValues = nullptr;
 	}
 	if ( m_localToWorldAttributeLoc >= 0 )
 	{
@@ -665,6 +993,27 @@ vsShaderVariant::SetViewport( const vsVector2D& viewportDims )
 	}
 }
 
+bool
+vsShaderVariant::NeedsRendererUniforms( uint32_t generation )
+{
+	if ( generation == m_rendererUniformsGeneration )
+	{
+		s_uniformUploadsSkipped += m_rendererUniformCount;
+		return false;
+	}
+	m_rendererUniformsGeneration = generation;
+	return true;
+}
+
+void
+vsShaderVariant::ConsumeUniformStats( int *uploads, int *skipped )
+{
+	*uploads = s_uniformUploads;
+	*skipped = s_uniformUploadsSkipped;
+	s_uniformUploads = 0;
+	s_uniformUploadsSkipped = 0;
+}
+
 int32_t
 vsShaderVariant::GetUniformId(const vsString& name) const
 {
@@ -714,8 +1063,23 @@ vsShaderVariant::Prepare( vsMaterial *material, vsShaderValues *values, vsRender
 	// vsAssert( current == (GLint)m_shader, "This shader isn't currently active??" );
 
 	vsShaderValues *matValues = material->GetShaderValues();
+	uint32_t matGeneration = matValues->GetGeneration();
+	uint32_t valuesGeneration = values ? values->GetGeneration() : 0;
+	if ( matValues == m_preparedMaterialValues && values == m_preparedValues &&
+			matGeneration == m_preparedMaterialGeneration &&
+			valuesGeneration == m_preparedValuesGeneration &&
+			!matValues->HasBoundUniforms() && !( values && values->HasBoundUniforms() ) )
+	{
+		// Nothing has changed since we last set these from the same values.
+		s_uniformUploadsSkipped += m_valueUniformCount;
+	}
+	else
 	{
 		PROFILE("Setting shader values");
+		m_preparedMaterialValues = matValues;
+		m_preparedValues = values;
+		m_preparedMaterialGeneration = matGeneration;
+		m_preparedValuesGeneration = valuesGeneration;
 
 		bool bb;
 		int b;
@@ -723,94 +1087,95 @@ vsShaderVariant::Prepare( vsMaterial *material, vsShaderValues *values, vsRender
 		vsVector4D v;
 		vsMatrix4x4 m;
 
-	for ( int i = 0; i < m_uniformCount; i++ )
-	{
-		const vsShader::Uniform& u = m_uniform[i];
-
-		switch( u.type )
+		for ( int i = 0; i < m_uniformCount; i++ )
 		{
-			case GL_BOOL:
-				{
-					bb = 0;
-					if ( !values || !values->UniformB( u.uid, bb ) )
-						 matValues->UniformB( u.uid, bb );
-					SetUniformValueB( i, bb );
-					break;
-				}
-			case GL_FLOAT:
-				{
-					f = 0.f;
-					if ( !values || !values->UniformF( u.uid, f ) )
-						matValues->UniformF( u.uid, f );
-					SetUniformValueF( i, f );
-					break;
-				}
-			case GL_FLOAT_VEC2:
-				{
-					v.Set(0,0,0,0);
-					if ( !values || !values->UniformVec4( u.uid, v ) )
-						matValues->UniformVec4( u.uid, v );
-					SetUniformValueVec2( i, vsVector2D(v.x,v.y) );
-					break;
-				}
-			case GL_FLOAT_VEC3:
-				{
-					v.Set(0,0,0,0);
-					if ( !values || !values->UniformVec4( u.uid, v ) )
-						matValues->UniformVec4( u.uid, v );
-					SetUniformValueVec3( i, v );
-					break;
-				}
-			case GL_FLOAT_VEC4:
-				{
-					v.Set(0,0,0,0);
-					if ( !values || !values->UniformVec4( u.uid, v ) )
-						matValues->UniformVec4( u.uid, v );
-					SetUniformValueVec4( i, v );
-					break;
-				}
-			case GL_FLOAT_MAT4:
-				{
-					m = vsMatrix4x4::Identity;
-					if ( !values || !values->UniformMat4( u.uid, m ) )
-						matValues->UniformMat4( u.uid, m );
-					SetUniformValueMat4( i, m );
-					break;
-				}
-			case GL_INT:
-			case GL_SAMPLER_2D:
-			case GL_UNSIGNED_INT_SAMPLER_2D:
-			case GL_SAMPLER_2D_SHADOW:
-			case GL_UNSIGNED_INT_SAMPLER_BUFFER:
-			case GL_INT_SAMPLER_BUFFER:
-			case GL_SAMPLER_BUFFER:
-				{
-					b = 0;
-					if ( !values || !values->UniformI( u.uid, b ) )
-						if ( !matValues->UniformI( u.uid, b) )
-						{
-							// for textures named "textures", we have a default automatic binding.
-							b = u.def;
-						}
-					SetUniformValueI( i, b );
-					break;
-				}
-			case GL_UNSIGNED_INT:
-				{
-					b = 0;
-					if ( !values || !values->UniformI( u.uid, b ) )
-						matValues->UniformI( u.uid, b);
-					uint32_t ui = (uint32_t)b; // [TODO] make less horrible
-					SetUniformValueUI( i, ui );
-					break;
-				}
+			const vsShader::Uniform& u = m_uniform[i];
+			if ( u.builtIn )
+				continue;
 
-			default:
-				// [TODO]  Handle more uniform types
-				break;
-		}
-	}
+			switch( u.type )
+			{
+				case GL_BOOL:
+					{
+						bb = 0;
+						if ( !values || !values->UniformB( u.uid, bb ) )
+							 matValues->UniformB( u.uid, bb );
+						SetUniformValueB( i, bb );
+						break;
+					}
+				case GL_FLOAT:
+					{
+						f = 0.f;
+						if ( !values || !values->UniformF( u.uid, f ) )
+							matValues->UniformF( u.uid, f );
+						SetUniformValueF( i, f );
+						break;
+					}
+				case GL_FLOAT_VEC2:
+					{
+						v.Set(0,0,0,0);
+						if ( !values || !values->UniformVec4( u.uid, v ) )
+							matValues->UniformVec4( u.uid, v );
+						SetUniformValueVec2( i, vsVector2D(v.x,v.y) );
+						break;
+					}
+				case GL_FLOAT_VEC3:
+					{
+						v.Set(0,0,0,0);
+						if ( !values || !values->UniformVec4( u.uid, v ) )
+							matValues->UniformVec4( u.uid, v );
+						SetUniformValueVec3( i, v );
+						break;
+					}
+				case GL_FLOAT_VEC4:
+					{
+						v.Set(0,0,0,0);
+						if ( !values || !values->UniformVec4( u.uid, v ) )
+							matValues->UniformVec4( u.uid, v );
+						SetUniformValueVec4( i, v );
+						break;
+					}
+				case GL_FLOAT_MAT4:
+					{
+						m = vsMatrix4x4::Identity;
+						if ( !values || !values->UniformMat4( u.uid, m ) )
+							matValues->UniformMat4( u.uid, m );
+						SetUniformValueMat4( i, m );
+						break;
+					}
+				case GL_INT:
+				case GL_SAMPLER_2D:
+				case GL_UNSIGNED_INT_SAMPLER_2D:
+				case GL_SAMPLER_2D_SHADOW:
+				case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+				case GL_INT_SAMPLER_BUFFER:
+				case GL_SAMPLER_BUFFER:
+					{
+						b = 0;
+						if ( !values || !values->UniformI( u.uid, b ) )
+							if ( !matValues->UniformI( u.uid, b) )
+							{
+								// for textures named "textures", we have a default automatic binding.
+								b = u.def;
+							}
+						SetUniformValueI( i, b );
+						break;
+					}
+				case GL_UNSIGNED_INT:
+					{
+						b = 0;
+						if ( !values || !values->UniformI( u.uid, b ) )
+							matValues->UniformI( u.uid, b);
+						uint32_t ui = (uint32_t)b; // [TODO] make less horrible
+						SetUniformValueUI( i, ui );
+						break;
+					}
 
+				default:
+					// [TODO]  Handle more uniform types
+					break;
+			}
+		}
 	}
 	{
 		PROFILE("Setting explicit variables");
@@ -858,14 +1223,26 @@ vsShaderVariant::Prepare( vsMaterial *material, vsShaderValues *values, vsRender
 
 }
 
+void
+vsShaderVariant::UniformUploaded( int i )
+{
+	s_uniformUploads++;
+	if ( vsRenderer::IsHeadless() )
+		vsRenderer::Instance()->NotifyUniformUploaded( this, i );
+}
+
 void
 vsShaderVariant::SetUniformValueF( int i, float value )
 {
 	if ( value != m_uniform[i].f32 )
 	{
-		glUniform1f( m_uniform[i].loc, value );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform1f( m_uniform[i].loc, value );
+		UniformUploaded(i);
 		m_uniform[i].f32 = value;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -873,9 +1250,13 @@ vsShaderVariant::SetUniformValueB( int i, bool value )
 {
 	if ( value != m_uniform[i].i32 )
 	{
-		glUniform1i( m_uniform[i].loc, value );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform1i( m_uniform[i].loc, value );
+		UniformUploaded(i);
 		m_uniform[i].i32 = value;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -883,9 +1264,13 @@ vsShaderVariant::SetUniformValueUI( int i, unsigned int value )
 {
 	if ( value != m_uniform[i].u32 )
 	{
-		glUniform1ui( m_uniform[i].loc, value );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform1ui( m_uniform[i].loc, value );
+		UniformUploaded(i);
 		m_uniform[i].u32 = value;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -893,9 +1278,13 @@ vsShaderVariant::SetUniformValueI( int i, int value )
 {
 	if ( value != m_uniform[i].i32 )
 	{
-		glUniform1i( m_uniform[i].loc, value );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform1i( m_uniform[i].loc, value );
+		UniformUploaded(i);
 		m_uniform[i].i32 = value;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -904,10 +1293,14 @@ vsShaderVariant::SetUniformValueVec2( int i, const vsVector2D& value )
 	if ( value.x != m_uniform[i].vec4[0] ||
 			value.y != m_uniform[i].vec4[1] )
 	{
-		glUniform2f( m_uniform[i].loc, value.x, value.y );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform2f( m_uniform[i].loc, value.x, value.y );
+		UniformUploaded(i);
 		m_uniform[i].vec4[0] = value.x;
 		m_uniform[i].vec4[1] = value.y;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -917,11 +1310,15 @@ vsShaderVariant::SetUniformValueVec3( int i, const vsVector3D& value )
 			value.y != m_uniform[i].vec4[1] ||
 			value.z != m_uniform[i].vec4[2] )
 	{
-		glUniform3f( m_uniform[i].loc, value.x, value.y, value.z );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform3f( m_uniform[i].loc, value.x, value.y, value.z );
+		UniformUploaded(i);
 		m_uniform[i].vec4[0] = value.x;
 		m_uniform[i].vec4[1] = value.y;
 		m_uniform[i].vec4[2] = value.z;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 
@@ -932,9 +1329,13 @@ vsShaderVariant::SetUniformValueVec3( int i, const vsColor& value )
 			value.g != m_uniform[i].vec4.y ||
 			value.b != m_uniform[i].vec4.z )
 	{
-		glUniform3f( m_uniform[i].loc, value.r, value.g, value.b );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform3f( m_uniform[i].loc, value.r, value.g, value.b );
+		UniformUploaded(i);
 		m_uniform[i].vec4.Set( value.r, value.g, value.b, 1.f );
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -942,9 +1343,13 @@ vsShaderVariant::SetUniformValueVec4( int i, const vsVector4D& value )
 {
 	if ( value != m_uniform[i].vec4 )
 	{
-		glUniform4f( m_uniform[i].loc, value.x, value.y, value.z, value.w );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform4f( m_uniform[i].loc, value.x, value.y, value.z, value.w );
+		UniformUploaded(i);
 		m_uniform[i].vec4 = value;
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -955,9 +1360,13 @@ vsShaderVariant::SetUniformValueVec4( int i, const vsColor& value )
 			value.b != m_uniform[i].vec4.z ||
 			value.a != m_uniform[i].vec4.w )
 	{
-		glUniform4f( m_uniform[i].loc, value.r, value.g, value.b, value.a );
+		if ( !vsRenderer::IsHeadless() )
+			glUniform4f( m_uniform[i].loc, value.r, value.g, value.b, value.a );
+		UniformUploaded(i);
 		m_uniform[i].vec4.Set( value.r, value.g, value.b, value.a );
 	}
+	else
+		s_uniformUploadsSkipped++;
 }
 
 void
@@ -965,12 +1374,11 @@ vsShaderVariant::SetUniformValueMat4( int i, const vsMatrix4x4& value )
 {
 	if ( value != m_uniform[i].mat )
 	{
-		glUniformMatrix4fv( m_uniform[i].loc, 1, GL_FALSE, &value.x.x );
+		if ( !vsRenderer::IsHeadless() )
+			glUniformMatrix4fv( m_uniform[i].loc, 1, GL_FALSE, &value.x.x );
+		UniformUploaded(i);
 		m_uniform[i].mat = value;
 	}
-	// else
-	// {
-	// 	vsLog("Woo, avoided re-setting a mat4 uniform value!");
-	// }
+	else
+		s_uniformUploadsSkipped++;
 }
-
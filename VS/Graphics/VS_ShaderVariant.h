@@ -60,6 +60,21 @@ private:
 
 	bool m_system; // system shader;  should not be reloaded!
 
+	// What our uniforms were last set from, so we can skip setting them
+	// again if nothing has changed.  (Each vsShader::Uniform also holds the
+	// value we last sent, so we never re-send an unchanged value)
+	vsShaderValues *m_preparedMaterialValues;
+	vsShaderValues *m_preparedValues;
+	uint32_t m_preparedMaterialGeneration;
+	uint32_t m_preparedValuesGeneration;
+	uint32_t m_rendererUniformsGeneration;
+	int32_t m_valueUniformCount;	// uniforms which Prepare() sets from shader values
+	int32_t m_rendererUniformCount;	// uniforms covered by NeedsRendererUniforms()
+
+	static int s_uniformUploads;
+	static int s_uniformUploadsSkipped;
+
+	inline void UniformUploaded( int i );
 	inline void SetUniformValueF( int i, float value );
 	inline void SetUniformValueB( int i, bool value );
 	inline void SetUniformValueI( int i, int value );
@@ -101,6 +116,7 @@ public:
 	void SetWorldToView( const vsMatrix4x4& worldToView );
 	void SetViewToProjection( const vsMatrix4x4& projection );
 	void SetViewport( const vsVector2D& viewportDims );
+	bool NeedsRendererUniforms( uint32_t generation );
 
 	const vsShader::Uniform *GetUniform(int i) const { return &m_uniform[i]; }
 	int32_t GetUniformId(const vsString& name) const;
@@ -112,6 +128,10 @@ public:
 			const vsColor& specular, const vsVector3D& position,
 			const vsVector3D& halfVector );
 
+	// How many uniform values we've sent to the GPU since the last call, and
+	// how many we didn't need to send because the GPU already had them.
+	static void ConsumeUniformStats( int *uploads, int *skipped );
+
 	friend class vsShader;
 };
 
@@ -51,6 +51,14 @@ vsTexture::MakeBufferTexture( const vsString& name, vsRenderBuffer *buffer )
 	return new vsTexture(t->GetName());
 }
 
+vsTexture*
+vsTexture::Stream( const vsString& filename, int priority )
+{
+	vsTextureManager *tm = static_cast<vsTextureManager*>( vsTextureManager::Instance() );
+	tm->StreamTexture( filename, priority );
+	return new vsTexture(filename);
+}
+
 void
 vsTexture::SetClampU( bool u )
 {
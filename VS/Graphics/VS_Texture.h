@@ -42,6 +42,13 @@ public:
 	 */
 	static vsTexture* MakeBufferTexture( const vsString& name, vsRenderBuffer *buffer );
 
+	/**
+	 * Like 'new vsTexture(filename)', except that the image is loaded in the
+	 * background by the vsTextureStreamer, and the texture shows a placeholder
+	 * until it's ready.  Higher priority textures are loaded first.
+	 */
+	static vsTexture* Stream( const vsString& filename, int priority = 0 );
+
 	// We set 'clamping' state on the vsTexture, so different vsTexture
 	// instances using the same backing texture data can have different
 	// settings for the texture.  These settings get copied if you make
@@ -61,6 +68,9 @@ public:
 
 	void SetLinearSampling();
 	void SetNearestSampling();
+
+	// true if drawing with either texture would look the same.
+	bool MatchesForBatching( const vsTexture &other ) const { return GetResource() == other.GetResource() && m_options == other.m_options; }
 };
 
 #endif //VS_TEXTURE_H
@@ -0,0 +1,264 @@
+/*
+ *  VS_TextureAtlas.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_TextureAtlas.h"
+#include "VS_MaterialInternal.h"
+#include "VS_Texture.h"
+#include "VS_TextureInternal.h"
+
+#include "VS/Files/VS_File.h"
+#include "VS/Utils/VS_Image.h"
+
+#include "VS_Profile.h"
+
+vsTextureAtlas * vsTextureAtlas::s_instance = nullptr;
+
+vsTextureAtlas::vsTextureAtlas( int pageSize, int padding ):
+	m_regionByName(256),
+	m_pageSize(pageSize),
+	m_padding(padding)
+{
+	vsAssert( s_instance == nullptr, "Multiple vsTextureAtlases created??" );
+	s_instance = this;
+}
+
+vsTextureAtlas::~vsTextureAtlas()
+{
+	for ( int i = 0; i < m_batchMaterial.ItemCount(); i++ )
+		m_batchMaterial[i]->ReleaseReference();
+	for ( int i = 0; i < m_page.ItemCount(); i++ )
+	{
+		vsDelete( m_page[i]->texture );
+		vsDelete( m_page[i] );
+	}
+	for ( int i = 0; i < m_region.ItemCount(); i++ )
+		vsDelete( m_region[i] );
+
+	vsAssert( s_instance == this, "vsTextureAtlas instance isn't me??" );
+	s_instance = nullptr;
+}
+
+vsTextureAtlas::Page *
+vsTextureAtlas::_AddPage()
+{
+	// Start the page out fully transparent, so that anything which samples
+	// outside its region (eg: through a bad texel) gets nothing, rather than
+	// uninitialised texture memory.
+	vsImage blank( m_pageSize, m_pageSize );
+	vsTextureInternal *ti = new vsTextureInternal( vsFormatString("AtlasPage%d", m_page.ItemCount()), &blank );
+	ti->SetUseMipmap(false);
+
+	Page *page = new Page;
+	page->texture = new vsTexture( ti );
+	page->usedPixels = 0;
+
+	Span all = { 0, 0, m_pageSize };
+	page->skyline.AddItem( all );
+
+	m_page.AddItem( page );
+	return page;
+}
+
+bool
+vsTextureAtlas::_Fits( Page *page, int index, int width, int height, int *y ) const
+{
+	// Would a 'width' by 'height' rectangle fit with its left edge at the
+	// start of span 'index'?  If so, it sits on top of the highest span
+	// underneath it.
+	const Span &first = page->skyline[index];
+	if ( first.x + width > m_pageSize )
+		return false;
+
+	int top = 0;
+	int remaining = width;
+	for ( int i = index; remaining > 0; i++ )
+	{
+		const Span &s = page->skyline[i];
+		top = vsMax( top, s.y );
+		remaining -= s.width;
+	}
+	if ( top + height > m_pageSize )
+		return false;
+
+	*y = top;
+	return true;
+}
+
+void
+vsTextureAtlas::_AddSpan( vsArray<Span> &skyline, const Span &span )
+{
+	// merge neighbouring spans of the same height.
+	if ( !skyline.IsEmpty() && skyline[ skyline.ItemCount()-1 ].y == span.y )
+		skyline[ skyline.ItemCount()-1 ].width += span.width;
+	else
+		skyline.AddItem( span );
+}
+
+bool
+vsTextureAtlas::_Pack( Page *page, int width, int height, int *x, int *y )
+{
+	// Bottom-left skyline packing:  of all the places the rectangle fits, take
+	// the one where its top edge is lowest, and the leftmost of those.
+	int bestIndex = -1;
+	int bestY = 0;
+	for ( int i = 0; i < page->skyline.ItemCount(); i++ )
+	{
+		int fitY;
+		if ( !_Fits( page, i, width, height, &fitY ) )
+			continue;
+		if ( bestIndex < 0 || fitY < bestY )
+		{
+			bestIndex = i;
+			bestY = fitY;
+		}
+	}
+	if ( bestIndex < 0 )
+		return false;
+
+	int left = page->skyline[bestIndex].x;
+	int right = left + width;
+
+	// Rebuild the skyline with the new rectangle on it.  Spans are usually
+	// only a few dozen, so this is cheaper than it sounds, and we only do it
+	// while loading.
+	vsArray<Span> skyline;
+	skyline.Reserve( page->skyline.ItemCount() + 2 );
+	for ( int i = 0; i < page->skyline.ItemCount(); i++ )
+	{
+		Span s = page->skyline[i];
+		if ( i == bestIndex )
+		{
+			Span placed = { left, bestY + height, width };
+			_AddSpan( skyline, placed );
+		}
+
+		if ( i >= bestIndex )
+		{
+			// trim off the part which is now underneath our rectangle.
+			int sRight = s.x + s.width;
+			if ( sRight <= right )
+				continue;
+			s.x = vsMax( s.x, right );
+			s.width = sRight - s.x;
+		}
+		_AddSpan( skyline, s );
+	}
+	page->skyline = skyline;
+	page->usedPixels += width * height;
+
+	*x = left;
+	*y = bestY;
+	return true;
+}
+
+const vsAtlasRegion *
+vsTextureAtlas::Add( const vsString &filename )
+{
+	PROFILE("vsTextureAtlas::Add");
+	vsScopedLock lock( m_mutex );
+
+	vsAtlasRegion **existing = m_regionByName.FindItem( filename );
+	if ( existing )
+		return *existing;
+
+	if ( !vsFile::Exists( filename ) )
+		return nullptr;
+
+	vsImage image( filename );
+	int width = image.GetWidth();
+	int height = image.GetHeight();
+	int paddedWidth = width + m_padding * 2;
+	int paddedHeight = height + m_padding * 2;
+	if ( paddedWidth > m_pageSize || paddedHeight > m_pageSize )
+	{
+		vsLog( "Texture atlas:  %s (%dx%d) is too large to fit on a %dx%d page", filename, width, height, m_pageSize, m_pageSize );
+		return nullptr;
+	}
+
+	int pageIndex = -1;
+	int x = 0, y = 0;
+	for ( int i = 0; i < m_page.ItemCount(); i++ )
+	{
+		if ( _Pack( m_page[i], paddedWidth, paddedHeight, &x, &y ) )
+		{
+			pageIndex = i;
+			break;
+		}
+	}
+	if ( pageIndex < 0 )
+	{
+		Page *page = _AddPage();
+		pageIndex = m_page.ItemCount()-1;
+		bool packed = _Pack( page, paddedWidth, paddedHeight, &x, &y );
+		vsAssert( packed, "Couldn't pack an image onto an empty atlas page??" );
+	}
+	Page *page = m_page[pageIndex];
+
+	// Fill the padding by repeating the image's edge pixels.
+	vsImage padded( paddedWidth, paddedHeight );
+	for ( int v = 0; v < paddedHeight; v++ )
+	{
+		int sv = vsClamp( v - m_padding, 0, height-1 );
+		for ( int u = 0; u < paddedWidth; u++ )
+		{
+			int su = vsClamp( u - m_padding, 0, width-1 );
+			padded.SetRawPixel( u, v, image.GetRawPixel( su, sv ) );
+		}
+	}
+	page->texture->GetResource()->Blit( &padded, vsVector2D( (float)x, (float)y ) );
+
+	vsAtlasRegion *region = new vsAtlasRegion;
+	region->texture = page->texture;
+	region->page = pageIndex;
+	region->x = x + m_padding;
+	region->y = y + m_padding;
+	region->width = width;
+	region->height = height;
+	region->texelMin.Set( region->x / (float)m_pageSize, region->y / (float)m_pageSize );
+	region->texelMax.Set( (region->x + width) / (float)m_pageSize, (region->y + height) / (float)m_pageSize );
+
+	m_region.AddItem( region );
+	m_regionByName.AddItemWithKey( region, filename );
+	return region;
+}
+
+vsMaterialInternal *
+vsTextureAtlas::GetBatchMaterial( vsMaterialInternal *material )
+{
+	vsScopedLock lock( m_mutex );
+	for ( int i = 0; i < m_batchMaterial.ItemCount(); i++ )
+	{
+		vsMaterialInternal *batch = m_batchMaterial[i];
+		if ( batch == material || batch->MatchesForBatching( *material ) )
+			return batch;
+	}
+
+	// Nothing else like this yet, so this material becomes the batch material
+	// for everything like it.  Hold a reference, so it doesn't get garbage
+	// collected out from under the materials which batch as it.
+	material->AddReference();
+	m_batchMaterial.AddItem( material );
+	return material;
+}
+
+vsTextureAtlas::Stats
+vsTextureAtlas::GetStats()
+{
+	vsScopedLock lock( m_mutex );
+	Stats stats;
+	stats.pages = m_page.ItemCount();
+	stats.images = m_region.ItemCount();
+
+	uint64_t used = 0;
+	for ( int i = 0; i < m_page.ItemCount(); i++ )
+		used += m_page[i]->usedPixels;
+	uint64_t total = (uint64_t)m_page.ItemCount() * m_pageSize * m_pageSize;
+	stats.fill = total ? used / (float)total : 0.f;
+	return stats;
+}
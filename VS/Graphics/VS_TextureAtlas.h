@@ -0,0 +1,130 @@
+/*
+ *  VS_TextureAtlas.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_TEXTUREATLAS_H
+#define VS_TEXTUREATLAS_H
+
+#include "VS/Math/VS_Math.h"
+#include "VS/Math/VS_Vector.h"
+#include "VS/Threads/VS_Mutex.h"
+#include "VS/Utils/VS_Array.h"
+#include "VS/Utils/VS_HashTable.h"
+
+class vsTexture;
+class vsMaterialInternal;
+
+// Where an image ended up inside a vsTextureAtlas page.
+struct vsAtlasRegion
+{
+	vsTexture *	texture;	// the page;  owned by the atlas
+	int			page;
+	int			x;			// in pixels, not including padding
+	int			y;
+	int			width;
+	int			height;
+	vsVector2D	texelMin;	// where the image's (0,0) texel is on the page
+	vsVector2D	texelMax;	// where the image's (1,1) texel is on the page
+
+	// Converts a texel on the original image into a texel on the page.
+	// Texels outside [0..1] would land on our neighbours, so they're clamped
+	// to our edges.
+	vsVector2D	Map( const vsVector2D &texel ) const
+	{
+		vsVector2D t( vsClamp( texel.x, 0.f, 1.f ), vsClamp( texel.y, 0.f, 1.f ) );
+		return vsVector2D( texelMin.x + t.x * (texelMax.x - texelMin.x),
+				texelMin.y + t.y * (texelMax.y - texelMin.y) );
+	}
+};
+
+// vsTextureAtlas packs lots of small images (HUD icons, sprites, font pages)
+// onto a few large textures, so that materials which would each have had
+// their own texture can share one, and get drawn together.
+//
+// Materials opt in with an 'atlas true' line in their .mat file.  Their
+// first texture gets packed onto a page, and the material uses the page
+// instead.  Atlased materials whose render settings are otherwise identical
+// share a "batch material" (see vsMaterialInternal::GetBatchMaterial()), so
+// the render queue puts them in the same batch and dynamic batching can merge
+// their fragments into a single draw.  Geometry needs its texels remapped
+// onto the page, with vsMaterial::MapTexel();  vsMakeTexturedBox2D() and
+// vsFont do this already.
+//
+// Because a sub-image can't wrap around inside its page, atlased materials
+// must only use texels in [0..1].  Don't atlas tiling materials!  Mapping a
+// texel outside that range asserts, and in release builds clamps it to the
+// edge of the image.
+//
+// Images are packed with a skyline packer, with 'padding' pixels around each
+// one, filled by repeating the image's edge pixels so that linear filtering
+// doesn't pick up colours from neighbouring images.  Pages are created as
+// they're needed.  Pages don't use mipmaps, since those would blend
+// neighbouring images together.
+
+class vsTextureAtlas
+{
+	static vsTextureAtlas *	s_instance;
+
+	struct Span		// a piece of a page's skyline
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	struct Page
+	{
+		vsTexture *		texture;
+		vsArray<Span>	skyline;	// left to right, covering the whole width of the page
+		int				usedPixels;
+	};
+
+	vsMutex							m_mutex;
+	vsArray<Page*>					m_page;
+	vsArray<vsAtlasRegion*>			m_region;
+	vsHashTable<vsAtlasRegion*>		m_regionByName;
+	vsArray<vsMaterialInternal*>	m_batchMaterial;	// we hold a reference to each of these
+	int								m_pageSize;
+	int								m_padding;
+
+	Page *	_AddPage();
+	bool	_Fits( Page *page, int index, int width, int height, int *y ) const;
+	bool	_Pack( Page *page, int width, int height, int *x, int *y );
+	static void	_AddSpan( vsArray<Span> &skyline, const Span &span );
+
+public:
+
+	static const int c_defaultPageSize = 2048;
+	static const int c_defaultPadding = 2;
+
+	struct Stats
+	{
+		int		pages;
+		int		images;
+		float	fill;	// fraction of all our pages' pixels which are used by images (including padding)
+	};
+
+	static vsTextureAtlas *	Instance() { return s_instance; }
+
+	vsTextureAtlas( int pageSize = c_defaultPageSize, int padding = c_defaultPadding );
+	~vsTextureAtlas();
+
+	// Packs the image in 'filename' onto one of our pages and returns where
+	// it went.  If we've already packed it, just returns where it is.  Returns
+	// nullptr if the image is too large to fit on a page.
+	const vsAtlasRegion *	Add( const vsString &filename );
+
+	// Returns the atlased material which 'material' should batch as:  the
+	// first one we saw which matches it in everything except its name.
+	// (Which may be 'material' itself)
+	vsMaterialInternal *	GetBatchMaterial( vsMaterialInternal *material );
+
+	Stats	GetStats();
+};
+
+#endif // VS_TEXTUREATLAS_H
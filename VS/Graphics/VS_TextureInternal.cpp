@@ -18,6 +18,8 @@
 #include "VS_RawImage.h"
 #include "VS_RenderTarget.h"
 #include "VS_RenderBuffer.h"
+#include "VS_Renderer.h"
+#include "VS_TextureStreamer.h"
 
 #include "VS/Files/VS_File.h"
 #include "VS/Memory/VS_Store.h"
@@ -79,11 +81,15 @@ vsTextureInternal::vsTextureInternal( const vsString &filename_in ):
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
-	GLuint t;
-	glGenTextures(1, &t);
-	m_texture = t;
+	if ( !vsRenderer::IsHeadless() )
+	{
+		GLuint t;
+		glGenTextures(1, &t);
+		m_texture = t;
+	}
 
 	_SimpleLoadFilename(filename_in);
 }
@@ -98,8 +104,15 @@ vsTextureInternal::vsTextureInternal( const vsString&name, const vsArray<vsStrin
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
+	if ( vsRenderer::IsHeadless() )
+	{
+		m_width = m_height = 1;
+		return;
+	}
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -153,7 +166,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsImage *image
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -161,6 +175,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsImage *image
 	m_width = w;
 	m_height = h;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -194,7 +211,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsFloatImage *
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -202,6 +220,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsFloatImage *
 	m_width = w;
 	m_height = h;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -234,7 +255,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsHalfIntImage
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -242,6 +264,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsHalfIntImage
 	m_width = w;
 	m_height = h;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -272,7 +297,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsRawImage *im
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -280,6 +306,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsRawImage *im
 	m_width = w;
 	m_height = h;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -315,7 +344,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsHalfFloatIma
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -323,6 +353,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsHalfFloatIma
 	m_width = w;
 	m_height = w;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -353,7 +386,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsSingleFloatI
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	int w = image->GetWidth();
 	int h = image->GetHeight();
@@ -361,6 +395,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, const vsSingleFloatI
 	m_width = w;
 	m_height = w;
 
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
@@ -390,14 +427,40 @@ vsTextureInternal::vsTextureInternal( const vsString &name, vsRenderBuffer *buff
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	GLuint t;
 	glGenTextures(1, &t);
 	m_texture = t;
 	// m_nearestSampling = false;
 }
 
+vsTextureInternal::vsTextureInternal( const vsString &filename, vsTextureStreamer *streamer ):
+	vsResource(filename),
+	m_texture(0),
+	m_depth(false),
+	m_premultipliedAlpha(false),
+	m_lockedSampling(false),
+	m_tbo(nullptr),
+	m_renderTarget(nullptr),
+	m_surfaceBuffer(0),
+	m_memoryUsage(0L),
+	m_state(0),
+	m_streamRequest(nullptr)
+{
+	if ( !vsRenderer::IsHeadless() )
+	{
+		GLuint t;
+		glGenTextures(1, &t);
+		m_texture = t;
+	}
+	_UploadPlaceholder();
+}
+
 vsTextureInternal::vsTextureInternal( const vsString &name, uint32_t glTextureId ):
 	vsResource(name),
 	m_texture(glTextureId),
@@ -407,9 +470,12 @@ vsTextureInternal::vsTextureInternal( const vsString &name, uint32_t glTextureId
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	// m_nearestSampling = false;
+	if ( vsRenderer::IsHeadless() )
+		return;
 
 	glBindTexture(GL_TEXTURE_2D, glTextureId);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -420,6 +486,9 @@ vsTextureInternal::vsTextureInternal( const vsString &name, uint32_t glTextureId
 void
 vsTextureInternal::Blit( const vsImage *image, const vsVector2D &where)
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	glBindTexture(GL_TEXTURE_2D, m_texture);
 	glTexSubImage2D(GL_TEXTURE_2D,
 			0,
@@ -436,6 +505,9 @@ vsTextureInternal::Blit( const vsImage *image, const vsVector2D &where)
 void
 vsTextureInternal::Blit( const vsFloatImage *image, const vsVector2D &where)
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	glBindTexture(GL_TEXTURE_2D, m_texture);
 	glTexSubImage2D(GL_TEXTURE_2D,
 			0,
@@ -452,6 +524,9 @@ vsTextureInternal::Blit( const vsFloatImage *image, const vsVector2D &where)
 void
 vsTextureInternal::Blit( const vsSingleFloatImage *image, const vsVector2D& where)
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	glBindTexture(GL_TEXTURE_2D, m_texture);
 	glTexSubImage2D(GL_TEXTURE_2D,
 			0,
@@ -478,7 +553,8 @@ vsTextureInternal::vsTextureInternal( const vsString &name, vsRenderTarget *rend
 	m_renderTarget(nullptr),
 	m_surfaceBuffer(0),
 	m_memoryUsage(0L),
-	m_state(0)
+	m_state(0),
+	m_streamRequest(nullptr)
 {
 	if ( renderTarget && renderTarget->GetTextureSurface() )
 	{
@@ -495,14 +571,22 @@ vsTextureInternal::~vsTextureInternal()
 	// or else it could also currently belong to a vsRenderTarget and it might be EITHER
 	// an opengl texture name OR an opengl renderbuffer name (for multisample and depth
 	// textures).  We need to track this better and clean up better!
-	GLuint t = m_texture;
-	glDeleteTextures(1, &t);
+	if ( m_streamRequest )
+		vsTextureStreamer::Instance()->Cancel(this);
+
+	if ( !vsRenderer::IsHeadless() )
+	{
+		GLuint t = m_texture;
+		glDeleteTextures(1, &t);
+	}
 	m_texture = 0;
 
 	vsGraphicsMemoryProfiler::Remove( vsGraphicsMemoryProfiler::Type_Texture, m_memoryUsage );
 
 	vsDelete( m_tbo );
 	m_renderTarget = nullptr; // this doesn't belong to us;  don't destroy it!
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 void
@@ -603,6 +687,8 @@ vsTextureInternal::Reload()
 			return;
 
 		// vsLog("Would reload %s", filename);
+		if ( m_streamRequest )
+			vsTextureStreamer::Instance()->Cancel(this);
 		_SimpleLoadFilename(filename);
 	}
 }
@@ -610,20 +696,20 @@ vsTextureInternal::Reload()
 void
 vsTextureInternal::_SimpleLoadFilename( const vsString &filename_in )
 {
+	if ( vsRenderer::IsHeadless() )
+	{
+		// no GPU to put the pixels on, so don't bother decoding them.
+		m_width = m_height = 1;
+		return;
+	}
+
 	bool success = false;
 	if ( vsFile::Exists(filename_in) )
 	{
-		glBindTexture(GL_TEXTURE_2D, m_texture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-		vsFile img(filename_in, vsFile::MODE_Read);
+		vsFile img(filename_in, vsFile::MODE_ReadMapped);
 
 		if ( img.IsOK() )
 		{
-			vsStore *s = new vsStore( img.GetLength() );
-			img.Store(s);
-
 			int w,h,n;
 
 			// glTexImage2D expects pixel data to start at the BOTTOM LEFT, but
@@ -633,54 +719,65 @@ vsTextureInternal::_SimpleLoadFilename( const vsString &filename_in )
 			// ref:	https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
 
 			stbi_set_flip_vertically_on_load(1);
-			unsigned char* data = stbi_load_from_memory( (uint8_t*)s->GetReadHead(), s->BytesLeftForReading(), &w, &h, &n, STBI_rgb_alpha );
-			vsDelete(s);
+			unsigned char* data = stbi_load_from_memory( (const uint8_t*)img.GetContents(), (int)img.GetLength(), &w, &h, &n, STBI_rgb_alpha );
 
 			if ( !data )
 				vsLog( "Failure while loading %s: %s", filename_in, stbi_failure_reason() );
 			else
 			{
-				glTexImage2D(GL_TEXTURE_2D,
-						0,
-						GL_RGBA,
-						w, h,
-						0,
-						GL_RGBA,
-						GL_UNSIGNED_INT_8_8_8_8_REV,
-						data);
+				_UploadRGBA( w, h, data );
 				stbi_image_free(data);
-
-				m_width = w;
-				m_height = w;
-
-				glGenerateMipmap(GL_TEXTURE_2D);
-				SetUseMipmap(true);
 				success = true;
-
-
-				_UseMemory( w * h * sizeof(uint32_t) );
 			}
 		}
 	}
 
 	if ( !success )
+		_UploadPlaceholder();
+}
+
+void
+vsTextureInternal::_UploadRGBA( int w, int h, const void *pixels )
+{
+	m_width = w;
+	m_height = h;
+
+	if ( !vsRenderer::IsHeadless() )
 	{
-		// put a placeholder image in here.
 		glBindTexture(GL_TEXTURE_2D, m_texture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexImage2D(GL_TEXTURE_2D,
 				0,
 				GL_RGBA,
-				8, 8,
+				w, h,
 				0,
 				GL_RGBA,
 				GL_UNSIGNED_INT_8_8_8_8_REV,
-				s_missingImage.RawData());
-		m_width = m_height = 1;
-		if ( IsUseMipmap() )
-			glGenerateMipmap(GL_TEXTURE_2D);
+				pixels);
+		_UseMemory( w * h * sizeof(uint32_t) );
 	}
+	SetUseMipmap(true);	// generates the mipmaps and sets up filtering
+}
+
+void
+vsTextureInternal::_UploadPlaceholder()
+{
+	m_width = m_height = 1;
+	if ( vsRenderer::IsHeadless() )
+		return;
+
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D,
+			0,
+			GL_RGBA,
+			8, 8,
+			0,
+			GL_RGBA,
+			GL_UNSIGNED_INT_8_8_8_8_REV,
+			s_missingImage.RawData());
+	if ( IsUseMipmap() )
+		glGenerateMipmap(GL_TEXTURE_2D);
 }
 
 void
@@ -688,6 +785,11 @@ vsTextureInternal::SetUseMipmap(bool mipmap)
 {
 	if ( mipmap )
 	{
+		if ( vsRenderer::IsHeadless() )
+		{
+			m_state |= State_Mipmap;
+			return;
+		}
 		glBindTexture(GL_TEXTURE_2D, m_texture);
 		glGenerateMipmap(GL_TEXTURE_2D);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -696,5 +798,13 @@ vsTextureInternal::SetUseMipmap(bool mipmap)
 		m_state |= State_Mipmap;
 	}
 	else
+	{
 		m_state &= ~State_Mipmap;
+		if ( vsRenderer::IsHeadless() )
+			return;
+		// otherwise we'd go on sampling from mipmaps which we're no longer
+		// keeping up to date.
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
 }
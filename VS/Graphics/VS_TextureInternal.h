@@ -23,6 +23,8 @@ class vsRawImage;
 class vsRenderBuffer;
 class vsRenderTarget;
 class vsSurface;
+class vsTextureStreamer;
+struct vsTextureStreamRequest;
 
 class vsTextureInternal : public vsResource
 {
@@ -56,7 +58,11 @@ class vsTextureInternal : public vsResource
 	};
 	uint8_t m_state;
 
+	vsTextureStreamRequest *m_streamRequest; // owned by the vsTextureStreamer
+
 	void _SimpleLoadFilename( const vsString &filename );
+	void _UploadRGBA( int w, int h, const void *pixels ); // bottom row first
+	void _UploadPlaceholder();
 	void _UseMemory( uint64_t amt );
 
 public:
@@ -72,6 +78,11 @@ public:
 	vsTextureInternal( const vsString &name, vsRenderTarget *renderTarget, int surfaceBuffer=0, bool depth=false );
 	vsTextureInternal( const vsString &name, vsRenderBuffer *buffer );
 
+	// Creates a texture showing a placeholder image, for 'streamer' to
+	// load the real image into later.  (Use vsTextureManager::StreamTexture()
+	// rather than calling this directly)
+	vsTextureInternal( const vsString &filename, vsTextureStreamer *streamer );
+
 	// SetRenderTarget() is for filling in the 'surface' later, if we were
 	// created for a surface without actually having allocated everything yet.
 	void SetRenderTarget( vsRenderTarget* renderTarget, int surfaceBuffer, bool depth );
@@ -102,6 +113,9 @@ public:
 
 	bool IsSamplingLocked() const { return m_lockedSampling; }
 
+	// true if we're still showing a placeholder while our image streams in.
+	bool IsStreaming() const { return m_streamRequest != nullptr; }
+
 	// ===============================================================================
 	// used as a cache during rendering, so we can remember what render state
 	// is set on this texture.
@@ -151,6 +165,7 @@ public:
 	void Reload(); // try to reload our content
 
 	friend class vsRenderTarget;
+	friend class vsTextureStreamer;
 };
 
 #endif // VS_TEXTUREINTERNAL_H
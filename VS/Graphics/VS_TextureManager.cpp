@@ -12,6 +12,7 @@
 #include "VS_Texture.h"
 #include "VS_Image.h"
 #include "VS_TextureInternal.h"
+#include "VS_TextureStreamer.h"
 #include "VS_FileCache.h"
 
 vsTextureManager::vsTextureManager():
@@ -25,6 +26,27 @@ vsTextureManager::LoadTexture( const vsString &filename )
 	return Get( filename );
 }
 
+vsTextureInternal *
+vsTextureManager::StreamTexture( const vsString &filename, int priority )
+{
+	vsTextureStreamer *streamer = vsTextureStreamer::Instance();
+	if ( !streamer )
+		return Get( filename );
+
+	vsScopedLock lock( m_mutex );
+	vsCacheEntry<vsTextureInternal> *ce = _Find( filename );
+	if ( ce )
+	{
+		streamer->SetPriority( ce->GetItem(), priority );
+		return ce->GetItem();
+	}
+
+	vsTextureInternal *texture = new vsTextureInternal( filename, streamer );
+	_Add( texture );
+	streamer->Request( texture, priority );
+	return texture;
+}
+
 void
 vsTextureManager::ReloadAll()
 {
@@ -23,6 +23,13 @@ public:
 	vsTextureManager();
 
 	vsTextureInternal *	LoadTexture( const vsString &name );
+
+	// As LoadTexture(), except that if the texture isn't already loaded, it
+	// returns a placeholder straight away and has the vsTextureStreamer load
+	// the real image in the background.  If the texture is still streaming,
+	// this changes its priority.  Loads immediately if there's no streamer.
+	vsTextureInternal *	StreamTexture( const vsString &name, int priority = 0 );
+
 	void ReloadAll();
 };
 
@@ -0,0 +1,463 @@
+/*
+ *  VS_TextureStreamer.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_TextureStreamer.h"
+#include "VS_TextureInternal.h"
+#include "VS_Renderer.h"
+#include "VS_Renderer_OpenGL3.h"
+
+#include "VS/Files/VS_File.h"
+#include "VS/Memory/VS_Heap.h"
+#include "VS/Memory/VS_Store.h"
+#include "VS/Threads/VS_Thread.h"
+#include "VS/Utils/VS_Sleep.h"
+#include "VS/Utils/VS_System.h"
+#include "VS/Utils/VS_TimerSystem.h"
+
+#include "VS_Profile.h"
+
+#include "stb_image.h"
+
+extern vsHeap *g_globalHeap;
+
+vsTextureStreamer * vsTextureStreamer::s_instance = nullptr;
+
+struct vsTextureStreamRequest
+{
+	enum State
+	{
+		State_WaitingForRead,
+		State_Reading,
+		State_WaitingForDecode,
+		State_Decoding,
+		State_WaitingForUpload
+	};
+
+	vsTextureInternal *	texture;	// nullptr once we've been cancelled
+	vsString			filename;
+	int					priority;
+	uint64_t			sequence;
+	uint64_t			requestTime;	// microseconds
+	State				state;
+
+	vsStore *			file;
+	uint8_t *			pixels;		// from stb_image;  RGBA, bottom row first
+	int					width;
+	int					height;
+
+	vsTextureStreamRequest():
+		texture(nullptr),
+		priority(0),
+		sequence(0),
+		requestTime(0),
+		state(State_WaitingForRead),
+		file(nullptr),
+		pixels(nullptr),
+		width(0),
+		height(0)
+	{
+	}
+
+	~vsTextureStreamRequest()
+	{
+		vsDelete( file );
+		if ( pixels )
+			stbi_image_free( pixels );
+	}
+};
+
+namespace
+{
+	uint64_t Now()
+	{
+		return vsTimerSystem::Instance() ? vsTimerSystem::Instance()->GetMicrosecondsSinceInit() : 0;
+	}
+}
+
+class vsTextureStreamer::IOThread : public vsThread
+{
+	vsTextureStreamer *	m_parent;
+
+protected:
+	virtual int Run()
+	{
+		m_parent->ReadLoop();
+		return 0;
+	}
+
+public:
+	IOThread( vsTextureStreamer *parent ):
+		vsThread( "TextureIO" ),
+		m_parent(parent)
+	{
+	}
+};
+
+class vsTextureStreamer::DecodeThread : public vsThread
+{
+	vsTextureStreamer *	m_parent;
+
+protected:
+	virtual int Run()
+	{
+		m_parent->DecodeLoop();
+		return 0;
+	}
+
+public:
+	DecodeThread( vsTextureStreamer *parent, int index ):
+		vsThread( vsFormatString("TexDecode%d", index) ),
+		m_parent(parent)
+	{
+	}
+};
+
+vsTextureStreamer::vsTextureStreamer( int decodeThreadCount ):
+	m_readReady(0),
+	m_decodeReady(0),
+	m_ioThread(nullptr),
+	m_decodeThread(nullptr),
+	m_decodeThreadCount(0),
+	m_uploadBudget(c_defaultUploadBudget),
+	m_nextSequence(0),
+	m_totalLatency(0),
+	m_maxLatency(0)
+{
+	vsAssert( s_instance == nullptr, "Multiple vsTextureStreamers created??" );
+	memset( &m_stats, 0, sizeof(m_stats) );
+
+	if ( decodeThreadCount < 0 )
+		decodeThreadCount = vsSystem::Instance()->GetNumberOfCores() / 2;
+	m_decodeThreadCount = vsMax( decodeThreadCount, 1 );
+
+	s_instance = this;
+
+	m_ioThread = new IOThread( this );
+	m_ioThread->Start();
+	m_decodeThread = new DecodeThread*[m_decodeThreadCount];
+	for ( int i = 0; i < m_decodeThreadCount; i++ )
+	{
+		m_decodeThread[i] = new DecodeThread( this, i );
+		m_decodeThread[i]->Start();
+	}
+}
+
+vsTextureStreamer::~vsTextureStreamer()
+{
+	// Each thread finishes whatever request it's holding and passes it on to
+	// the next queue before it notices that it should exit.  So once they're
+	// all gone, every remaining request is sitting in one of our queues.
+	m_readReady.Release();
+	m_decodeReady.Release();
+	vsDelete( m_ioThread );
+	for ( int i = 0; i < m_decodeThreadCount; i++ )
+		vsDelete( m_decodeThread[i] );
+	vsDeleteArray( m_decodeThread );
+
+	vsArray<vsTextureStreamRequest*> *queue[3] = { &m_readQueue, &m_decodeQueue, &m_uploadQueue };
+	for ( int q = 0; q < 3; q++ )
+	{
+		for ( int i = 0; i < queue[q]->ItemCount(); i++ )
+		{
+			vsTextureStreamRequest *r = (*queue[q])[i];
+			if ( r->texture )
+				r->texture->m_streamRequest = nullptr;
+			vsDelete( r );
+		}
+		queue[q]->Clear();
+	}
+
+	vsAssert( s_instance == this, "vsTextureStreamer instance isn't me??" );
+	s_instance = nullptr;
+}
+
+vsTextureStreamRequest *
+vsTextureStreamer::_PopBest( vsArray<vsTextureStreamRequest*>& queue )
+{
+	vsTextureStreamRequest *best = nullptr;
+	for ( int i = 0; i < queue.ItemCount(); i++ )
+	{
+		vsTextureStreamRequest *r = queue[i];
+		if ( !best || r->priority > best->priority ||
+				( r->priority == best->priority && r->sequence < best->sequence ) )
+			best = r;
+	}
+	if ( best )
+		queue.RemoveItem( best );
+	return best;
+}
+
+vsArray<vsTextureStreamRequest*> *
+vsTextureStreamer::_QueueFor( vsTextureStreamRequest *request )
+{
+	switch ( request->state )
+	{
+		case vsTextureStreamRequest::State_WaitingForRead:
+			return &m_readQueue;
+		case vsTextureStreamRequest::State_WaitingForDecode:
+			return &m_decodeQueue;
+		case vsTextureStreamRequest::State_WaitingForUpload:
+			return &m_uploadQueue;
+		default:
+			return nullptr;	// a thread has it
+	}
+}
+
+void
+vsTextureStreamer::Request( vsTextureInternal *texture, int priority )
+{
+	{
+		vsScopedLock lock( m_mutex );
+		if ( texture->m_streamRequest )
+		{
+			texture->m_streamRequest->priority = priority;
+			return;
+		}
+
+		// Our threads move requests from queue to queue, and mustn't have to
+		// grow them to do it;  they'd be allocating from whichever heap the
+		// main thread had pushed at the time.  So make room in every queue
+		// for every outstanding request here.  The queues live as long as
+		// we do, so they go on the global heap.
+		int outstanding = (int)( m_stats.requested - m_stats.uploaded - m_stats.failed - m_stats.cancelled ) + 1;
+		vsHeap::Push(g_globalHeap);
+		m_readQueue.Reserve( outstanding );
+		m_decodeQueue.Reserve( outstanding );
+		m_uploadQueue.Reserve( outstanding );
+		vsHeap::Pop(g_globalHeap);
+
+		vsTextureStreamRequest *r = new vsTextureStreamRequest;
+		r->texture = texture;
+		r->filename = texture->GetName();
+		r->priority = priority;
+		r->sequence = m_nextSequence++;
+		r->requestTime = Now();
+		texture->m_streamRequest = r;
+		m_readQueue.AddItem( r );
+		m_stats.requested++;
+	}
+	m_readReady.Post();
+}
+
+void
+vsTextureStreamer::SetPriority( vsTextureInternal *texture, int priority )
+{
+	vsScopedLock lock( m_mutex );
+	if ( texture->m_streamRequest )
+		texture->m_streamRequest->priority = priority;
+}
+
+void
+vsTextureStreamer::Cancel( vsTextureInternal *texture )
+{
+	vsScopedLock lock( m_mutex );
+	vsTextureStreamRequest *r = texture->m_streamRequest;
+	if ( !r )
+		return;
+
+	texture->m_streamRequest = nullptr;
+	m_stats.cancelled++;
+
+	vsArray<vsTextureStreamRequest*> *queue = _QueueFor( r );
+	if ( queue )
+	{
+		queue->RemoveItem( r );
+		vsDelete( r );
+	}
+	else
+	{
+		// A thread is working on it;  it'll throw the result away when it's
+		// done.
+		r->texture = nullptr;
+	}
+}
+
+void
+vsTextureStreamer::ReadLoop()
+{
+	while ( m_readReady.Wait() )
+	{
+		vsTextureStreamRequest *r = nullptr;
+		{
+			vsScopedLock lock( m_mutex );
+			r = _PopBest( m_readQueue );
+			if ( !r )
+				continue;	// it was cancelled
+			r->state = vsTextureStreamRequest::State_Reading;
+		}
+
+		vsStore *store = nullptr;
+		{
+			PROFILE("Texture read");
+			if ( vsFile::Exists( r->filename ) )
+			{
+				vsFile file( r->filename, vsFile::MODE_Read );
+				if ( file.IsOK() )
+				{
+					store = new vsStore( file.GetLength() );
+					file.Store( store );
+				}
+			}
+		}
+
+		{
+			vsScopedLock lock( m_mutex );
+			r->file = store;
+			if ( !r->texture )
+			{
+				vsDelete( r );
+				continue;
+			}
+			r->state = vsTextureStreamRequest::State_WaitingForDecode;
+			m_decodeQueue.AddItem( r );
+		}
+		m_decodeReady.Post();
+	}
+}
+
+void
+vsTextureStreamer::DecodeLoop()
+{
+	// glTexImage2D expects the bottom row first;  stb_image gives us the top
+	// row first unless we ask it to flip.  (See _SimpleLoadFilename())
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	while ( m_decodeReady.Wait() )
+	{
+		vsTextureStreamRequest *r = nullptr;
+		{
+			vsScopedLock lock( m_mutex );
+			r = _PopBest( m_decodeQueue );
+			if ( !r )
+				continue;
+			r->state = vsTextureStreamRequest::State_Decoding;
+		}
+
+		if ( r->file )
+		{
+			PROFILE("Texture decode");
+			int n;
+			r->pixels = stbi_load_from_memory( (uint8_t*)r->file->GetReadHead(), r->file->BytesLeftForReading(),
+					&r->width, &r->height, &n, STBI_rgb_alpha );
+			if ( !r->pixels )
+				vsLog( "Failure while loading %s: %s", r->filename, stbi_failure_reason() );
+			vsDelete( r->file );
+		}
+
+		{
+			vsScopedLock lock( m_mutex );
+			if ( !r->texture )
+			{
+				vsDelete( r );
+				continue;
+			}
+			r->state = vsTextureStreamRequest::State_WaitingForUpload;
+			m_uploadQueue.AddItem( r );
+		}
+	}
+}
+
+void
+vsTextureStreamer::Upload( vsTextureStreamRequest *r )
+{
+	vsTextureInternal *texture = r->texture;
+	if ( r->pixels )
+	{
+		texture->_UploadRGBA( r->width, r->height, r->pixels );
+		m_stats.uploaded++;
+		m_stats.bytesUploaded += r->width * r->height * 4;
+	}
+	else
+	{
+		// leave the placeholder in place.
+		m_stats.failed++;
+	}
+	texture->m_streamRequest = nullptr;
+
+	uint64_t latency = Now() - r->requestTime;
+	m_totalLatency += latency;
+	m_maxLatency = vsMax( m_maxLatency, latency );
+
+	vsDelete( r );
+}
+
+int
+vsTextureStreamer::UploadReady( int budget )
+{
+	PROFILE("vsTextureStreamer::UploadReady");
+	int uploads = 0;
+	int bytes = 0;
+	while ( true )
+	{
+		// We hold the lock while we upload, so that the texture can't be
+		// cancelled (ie: destroyed) while we're uploading into it, even if
+		// we're being flushed on a loading thread.
+		vsScopedLock lock( m_mutex );
+		vsTextureStreamRequest *r = _PopBest( m_uploadQueue );
+		if ( !r )
+			break;
+		int size = r->width * r->height * 4;
+		if ( budget >= 0 && uploads > 0 && bytes + size > budget )
+		{
+			m_uploadQueue.AddItem( r );
+			break;
+		}
+		Upload( r );
+		uploads++;
+		bytes += size;
+	}
+	m_stats.uploadsLastFrame = uploads;
+	m_stats.bytesUploadedLastFrame = bytes;
+	return uploads;
+}
+
+void
+vsTextureStreamer::Update( float timeStep )
+{
+	UploadReady( m_uploadBudget );
+}
+
+void
+vsTextureStreamer::Flush()
+{
+	PROFILE("vsTextureStreamer::Flush");
+	while ( true )
+	{
+		UploadReady( -1 );
+
+		bool done = false;
+		{
+			vsScopedLock lock( m_mutex );
+			done = ( m_stats.uploaded + m_stats.failed + m_stats.cancelled == m_stats.requested );
+		}
+		if ( done )
+			break;
+		vsSleep(1);
+	}
+
+	if ( !vsRenderer::IsHeadless() && vsRenderer_OpenGL3::Instance()->IsLoadingContext() )
+		vsRenderer_OpenGL3::Instance()->FenceLoadingContext();
+}
+
+vsTextureStreamer::Stats
+vsTextureStreamer::GetStats()
+{
+	vsScopedLock lock( m_mutex );
+	Stats stats = m_stats;
+	stats.waitingForRead = m_readQueue.ItemCount();
+	stats.waitingForDecode = m_decodeQueue.ItemCount();
+	stats.waitingForUpload = m_uploadQueue.ItemCount();
+	uint64_t outstanding = m_stats.requested - m_stats.uploaded - m_stats.failed - m_stats.cancelled;
+	stats.inFlight = (int)outstanding - stats.waitingForRead - stats.waitingForDecode - stats.waitingForUpload;
+
+	uint64_t finished = m_stats.uploaded + m_stats.failed;
+	stats.averageLatency = finished ? (m_totalLatency / (float)finished) / 1000000.f : 0.f;
+	stats.maxLatency = m_maxLatency / 1000000.f;
+	return stats;
+}
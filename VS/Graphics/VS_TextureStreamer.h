@@ -0,0 +1,129 @@
+/*
+ *  VS_TextureStreamer.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_TEXTURESTREAMER_H
+#define VS_TEXTURESTREAMER_H
+
+#include "Core/CORE_GameSystem.h"
+#include "VS/Threads/VS_Mutex.h"
+#include "VS/Threads/VS_Semaphore.h"
+#include "VS/Utils/VS_Array.h"
+
+class vsTextureInternal;
+struct vsTextureStreamRequest;
+
+// vsTextureStreamer loads image textures in the background.  Reading the file
+// happens on an I/O thread, decoding it happens on our decode threads, and
+// then the decoded pixels wait for Update() to upload them to the GPU on the
+// main thread, which only uploads a limited number of bytes each frame so that
+// a burst of finished textures can't cause a hitch.  Until then, the texture
+// shows the same placeholder image as a texture whose file is missing.
+//
+// Higher priority requests are read, decoded, and uploaded before lower
+// priority ones;  requests with the same priority are handled in the order
+// they were made.
+//
+// Normally you don't use this directly;  call vsTexture::Stream() or
+// vsTextureManager::StreamTexture() instead.  Destroying a texture cancels
+// its request.
+
+class vsTextureStreamer : public coreGameSystem
+{
+	static vsTextureStreamer *	s_instance;
+
+public:
+
+	struct Stats
+	{
+		int			waitingForRead;		// queue depths right now
+		int			waitingForDecode;
+		int			waitingForUpload;
+		int			inFlight;			// being read or decoded right now
+
+		uint64_t	requested;			// totals since we were created
+		uint64_t	uploaded;
+		uint64_t	failed;
+		uint64_t	cancelled;
+		uint64_t	bytesUploaded;
+
+		int			uploadsLastFrame;
+		int			bytesUploadedLastFrame;
+
+		float		averageLatency;		// seconds from request to upload
+		float		maxLatency;
+	};
+
+	static const int c_defaultUploadBudget = 8 * 1024 * 1024;	// bytes per frame
+
+private:
+
+	class IOThread;
+	class DecodeThread;
+
+	vsMutex						m_mutex;	// protects everything below, and every request
+	vsArray<vsTextureStreamRequest*>	m_readQueue;
+	vsArray<vsTextureStreamRequest*>	m_decodeQueue;
+	vsArray<vsTextureStreamRequest*>	m_uploadQueue;
+	vsSemaphore					m_readReady;
+	vsSemaphore					m_decodeReady;
+
+	IOThread *					m_ioThread;
+	DecodeThread **				m_decodeThread;
+	int							m_decodeThreadCount;
+
+	int							m_uploadBudget;
+	uint64_t					m_nextSequence;
+	uint64_t					m_totalLatency;		// microseconds, over every upload
+	uint64_t					m_maxLatency;
+	Stats						m_stats;
+
+	static vsTextureStreamRequest *	_PopBest( vsArray<vsTextureStreamRequest*>& queue );
+	vsArray<vsTextureStreamRequest*> *	_QueueFor( vsTextureStreamRequest *request );
+
+	void		ReadLoop();
+	void		DecodeLoop();
+	int			UploadReady( int budget );	// negative for no budget
+	void		Upload( vsTextureStreamRequest *request );
+
+public:
+
+	static vsTextureStreamer *	Instance() { return s_instance; }
+
+	// By default, we make one decode thread for every two logical cores,
+	// leaving the rest for the job system and the main thread.
+	vsTextureStreamer( int decodeThreadCount = -1 );
+	virtual ~vsTextureStreamer();
+
+	// Queues 'texture' to be loaded from the file it's named after.  If it's
+	// already queued, this just changes its priority.
+	void		Request( vsTextureInternal *texture, int priority = 0 );
+
+	// Changes the priority of a texture we haven't finished with yet.  Does
+	// nothing if it's not queued.
+	void		SetPriority( vsTextureInternal *texture, int priority );
+	void		Cancel( vsTextureInternal *texture );
+
+	// How many bytes of pixels Update() may upload each frame.  It always
+	// uploads at least one texture per frame, if any are ready.
+	void		SetUploadBudget( int bytesPerFrame ) { m_uploadBudget = bytesPerFrame; }
+
+	// Uploads finished textures, up to the budget.
+	virtual void	Update( float timeStep );
+
+	// Blocks until every request made so far has been uploaded, ignoring the
+	// upload budget.  For loading screens, or loading threads which have
+	// called vsRenderer_OpenGL3::SetLoadingContext();  in that case, we fence
+	// the loading context before returning, so the main context can draw
+	// with the new textures straight away.
+	void		Flush();
+
+	Stats		GetStats();
+};
+
+#endif // VS_TEXTURESTREAMER_H
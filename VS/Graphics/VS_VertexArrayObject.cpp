@@ -10,6 +10,7 @@
 #include "VS_VertexArrayObject.h"
 
 #include "VS_OpenGL.h"
+#include "VS_Renderer.h"
 #include "VS_Profile.h"
 
 
@@ -28,11 +29,20 @@ vsVertexArrayObject::~vsVertexArrayObject()
 {
 	if ( m_set )
 		glDeleteVertexArrays(1, &m_id);
+	if ( vsRenderer::Instance() )
+		vsRenderer::Instance()->NotifyResourceDestroyed( this );
 }
 
 void
 vsVertexArrayObject::Enter()
 {
+	if ( vsRenderer::IsHeadless() )
+	{
+		// no GL context;  just track our attributes.
+		m_in = true;
+		return;
+	}
+
 	if ( !m_set )
 	{
 		glGenVertexArrays(1, &m_id);
@@ -84,6 +94,9 @@ vsVertexArrayObject::Flush()
 void
 vsVertexArrayObject::_DoFlush()
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
+
 	// if ( m_anyDirty )
 	{
 		// PROFILE("vsVertexArrayObject::Flush - DIRTY");
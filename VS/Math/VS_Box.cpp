@@ -10,6 +10,7 @@
 #include "VS_Box.h"
 
 #include "VS_DisplayList.h"
+#include "VS_SIMD.h"
 
 bool
 vsBox2D::Intersects(const vsBox2D &other) const
@@ -552,6 +553,42 @@ vsBox3D::ExpandToInclude( const vsVector3D &pos )
 	}
 }
 
+void
+vsBox3D::ExpandToInclude( const vsVector3D *pos, int count )
+{
+	if ( count <= 0 )
+		return;
+
+	int i = 0;
+	if ( count >= 4 )
+	{
+		vsSimd4 minX, minY, minZ;
+		vsSimdLoad3( &pos[0].x, minX, minY, minZ );
+		vsSimd4 maxX = minX, maxY = minY, maxZ = minZ;
+
+		for ( i = 4; i + 4 <= count; i += 4 )
+		{
+			vsSimd4 x, y, z;
+			vsSimdLoad3( &pos[i].x, x, y, z );
+			minX = vsSimdMin( minX, x );
+			minY = vsSimdMin( minY, y );
+			minZ = vsSimdMin( minZ, z );
+			maxX = vsSimdMax( maxX, x );
+			maxY = vsSimdMax( maxY, y );
+			maxZ = vsSimdMax( maxZ, z );
+		}
+
+		// Each lane has the bounds of a quarter of the points;  fold them in.
+		vsVector3D lanes[8];
+		vsSimdStore3( &lanes[0].x, minX, minY, minZ );
+		vsSimdStore3( &lanes[4].x, maxX, maxY, maxZ );
+		for ( int l = 0; l < 8; l++ )
+			ExpandToInclude( lanes[l] );
+	}
+	for ( ; i < count; i++ )
+		ExpandToInclude( pos[i] );
+}
+
 void
 vsBox3D::ExpandToInclude( const vsBox3D &b )
 {
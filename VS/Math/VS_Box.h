@@ -113,6 +113,7 @@ public:
 	bool		CollideRay(vsVector3D *result, float *resultT, const vsVector3D &pos, const vsVector3D &dir) const;
 
 	void		ExpandToInclude( const vsVector3D &pos );
+	void		ExpandToInclude( const vsVector3D *pos, int count );	// uses SIMD instructions where we have them
 	void		ExpandToInclude( const vsBox3D &box );
 
 	float		DistanceFrom( const vsVector3D &pos ) const;
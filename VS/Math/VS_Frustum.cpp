@@ -8,6 +8,7 @@
  */
 
 #include "VS_Frustum.h"
+#include "VS_SIMD.h"
 
 #include "VS/Graphics/VS_Camera.h"
 #include "VS/Graphics/VS_Screen.h"
@@ -112,6 +113,111 @@ vsFrustum::IsPointInside( const vsVector3D &position, float radius ) const
 	return true;
 }
 
+// Turns per-lane 'outside' and 'intersecting' bits into Classifications.
+static void
+WriteClassifications( int outsideBits, int intersectBits, vsFrustum::Classification *result )
+{
+	for ( int l = 0; l < 4; l++ )
+	{
+		if ( outsideBits & BIT(l) )
+			result[l] = vsFrustum::Outside;
+		else if ( intersectBits & BIT(l) )
+			result[l] = vsFrustum::Intersect;
+		else
+			result[l] = vsFrustum::Inside;
+	}
+}
+
+void
+vsFrustum::ClassifySpheres( const float *x, const float *y, const float *z, const float *radius, Classification *result, int count ) const
+{
+	const vsSimd4 zero = vsSimdSplat( 0.f );
+	int i = 0;
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		vsSimd4 cx = vsSimdLoad( x + i );
+		vsSimd4 cy = vsSimdLoad( y + i );
+		vsSimd4 cz = vsSimdLoad( z + i );
+		vsSimd4 r = vsSimdLoad( radius + i );
+		vsSimd4 negR = vsSimdSub( zero, r );
+
+		vsSimdMask4 outside = vsSimdMaskNone();
+		vsSimdMask4 intersect = vsSimdMaskNone();
+		for ( int p = 0; p < 6; p++ )
+		{
+			// Same as ClassifySphere():  (center - planePoint).Dot(planeNormal)
+			const vsVector3D &point = m_planePoint[p];
+			const vsVector3D &normal = m_planeNormal[p];
+			vsSimd4 distance = vsSimdAdd( vsSimdAdd(
+						vsSimdMul( vsSimdSub( cx, vsSimdSplat(point.x) ), vsSimdSplat(normal.x) ),
+						vsSimdMul( vsSimdSub( cy, vsSimdSplat(point.y) ), vsSimdSplat(normal.y) ) ),
+					vsSimdMul( vsSimdSub( cz, vsSimdSplat(point.z) ), vsSimdSplat(normal.z) ) );
+			outside = vsSimdMaskOr( outside, vsSimdLess( distance, negR ) );
+			intersect = vsSimdMaskOr( intersect, vsSimdLess( distance, r ) );
+		}
+		WriteClassifications( vsSimdMaskBits(outside), vsSimdMaskBits(intersect), result + i );
+	}
+	for ( ; i < count; i++ )
+		result[i] = ClassifySphere( vsVector3D( x[i], y[i], z[i] ), radius[i] );
+}
+
+void
+vsFrustum::ClassifyBoxes3D( const vsBox3D *box, Classification *result, int count ) const
+{
+	// Unlike ClassifyBox3D(), we skip the bounding sphere test and go straight
+	// to the corners.  That test was only ever a shortcut;  whenever it gives
+	// an answer, the corner test gives the same one.
+	int i = 0;
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		float minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+		for ( int l = 0; l < 4; l++ )
+		{
+			const vsVector3D &min = box[i+l].GetMin();
+			const vsVector3D &max = box[i+l].GetMax();
+			minX[l] = min.x; minY[l] = min.y; minZ[l] = min.z;
+			maxX[l] = max.x; maxY[l] = max.y; maxZ[l] = max.z;
+		}
+		vsSimd4 lowX = vsSimdLoad( minX ), lowY = vsSimdLoad( minY ), lowZ = vsSimdLoad( minZ );
+		vsSimd4 highX = vsSimdLoad( maxX ), highY = vsSimdLoad( maxY ), highZ = vsSimdLoad( maxZ );
+		const vsSimd4 zero = vsSimdSplat( 0.f );
+
+		vsSimdMask4 outside = vsSimdMaskNone();
+		vsSimdMask4 intersect = vsSimdMaskNone();
+		for ( int p = 0; p < 6; p++ )
+		{
+			// The corners furthest along the plane's normal, and furthest
+			// against it, chosen the same way as vsBox3D::PCorner() and
+			// NCorner() do.
+			const vsVector3D &point = m_planePoint[p];
+			const vsVector3D &normal = m_planeNormal[p];
+			vsSimd4 px = ( normal.x >= 0.f ) ? highX : lowX;
+			vsSimd4 py = ( normal.y >= 0.f ) ? highY : lowY;
+			vsSimd4 pz = ( normal.z >= 0.f ) ? highZ : lowZ;
+			vsSimd4 nx = ( -normal.x >= 0.f ) ? highX : lowX;
+			vsSimd4 ny = ( -normal.y >= 0.f ) ? highY : lowY;
+			vsSimd4 nz = ( -normal.z >= 0.f ) ? highZ : lowZ;
+
+			vsSimd4 splatX = vsSimdSplat(point.x), splatY = vsSimdSplat(point.y), splatZ = vsSimdSplat(point.z);
+			vsSimd4 normalX = vsSimdSplat(normal.x), normalY = vsSimdSplat(normal.y), normalZ = vsSimdSplat(normal.z);
+
+			vsSimd4 pDistance = vsSimdAdd( vsSimdAdd(
+						vsSimdMul( vsSimdSub( px, splatX ), normalX ),
+						vsSimdMul( vsSimdSub( py, splatY ), normalY ) ),
+					vsSimdMul( vsSimdSub( pz, splatZ ), normalZ ) );
+			vsSimd4 nDistance = vsSimdAdd( vsSimdAdd(
+						vsSimdMul( vsSimdSub( nx, splatX ), normalX ),
+						vsSimdMul( vsSimdSub( ny, splatY ), normalY ) ),
+					vsSimdMul( vsSimdSub( nz, splatZ ), normalZ ) );
+			outside = vsSimdMaskOr( outside, vsSimdLess( pDistance, zero ) );
+			intersect = vsSimdMaskOr( intersect, vsSimdLess( nDistance, zero ) );
+		}
+		WriteClassifications( vsSimdMaskBits(outside), vsSimdMaskBits(intersect), result + i );
+	}
+	for ( ; i < count; i++ )
+		result[i] = ClassifyBox3D( box[i] );
+}
+
 // Code structure for the below visibility calculations taken from the
 // Lighthouse 3D OpenGL "View Frustum Culling Tutorial" at
 // http://www.lighthouse3d.com/tutorials/view-frustum-culling/
@@ -37,6 +37,12 @@ public:
 	};
 	Classification ClassifyBox3D( const vsBox3D &box ) const;
 	Classification ClassifySphere( const vsVector3D &position, float radius ) const;
+
+	// Batch versions of ClassifySphere() and ClassifyBox3D(), which use SIMD
+	// instructions where we have them.  Spheres are passed as separate arrays
+	// of their centers' components and their radii.
+	void	ClassifySpheres( const float *x, const float *y, const float *z, const float *radius, Classification *result, int count ) const;
+	void	ClassifyBoxes3D( const vsBox3D *box, Classification *result, int count ) const;
 };
 
 #endif // VS_FRUSTUM_H
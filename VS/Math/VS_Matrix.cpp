@@ -10,6 +10,7 @@
 #include "VS_Matrix.h"
 
 #include "VS_Quaternion.h"
+#include "VS_SIMD.h"
 
 vsMatrix4x4 vsMatrix4x4::Identity;
 vsMatrix3x3 vsMatrix3x3::Identity;
@@ -611,6 +612,67 @@ vsMatrix4x4::ApplyTo( const vsMatrix4x4 &o ) const
 	return result;
 }
 
+void
+vsMatrix4x4::ApplyTo( const vsVector3D *in, vsVector3D *out, int count ) const
+{
+	static_assert( sizeof(vsVector3D) == sizeof(float) * 3, "vsVector3D arrays must be tightly packed floats" );
+
+	const vsSimd4 xx = vsSimdSplat(x.x), xy = vsSimdSplat(x.y), xz = vsSimdSplat(x.z);
+	const vsSimd4 yx = vsSimdSplat(y.x), yy = vsSimdSplat(y.y), yz = vsSimdSplat(y.z);
+	const vsSimd4 zx = vsSimdSplat(z.x), zy = vsSimdSplat(z.y), zz = vsSimdSplat(z.z);
+	const vsSimd4 wx = vsSimdSplat(w.x), wy = vsSimdSplat(w.y), wz = vsSimdSplat(w.z);
+
+	// Four points at a time, in the same order of operations as the
+	// single-point ApplyTo().
+	int i = 0;
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		vsSimd4 vx, vy, vz;
+		vsSimdLoad3( &in[i].x, vx, vy, vz );
+
+		vsSimd4 rx = vsSimdAdd( vsSimdAdd( vsSimdAdd( vsSimdMul(vx, xx), vsSimdMul(vy, yx) ), vsSimdMul(vz, zx) ), wx );
+		vsSimd4 ry = vsSimdAdd( vsSimdAdd( vsSimdAdd( vsSimdMul(vx, xy), vsSimdMul(vy, yy) ), vsSimdMul(vz, zy) ), wy );
+		vsSimd4 rz = vsSimdAdd( vsSimdAdd( vsSimdAdd( vsSimdMul(vx, xz), vsSimdMul(vy, yz) ), vsSimdMul(vz, zz) ), wz );
+
+		vsSimdStore3( &out[i].x, rx, ry, rz );
+	}
+	for ( ; i < count; i++ )
+		out[i] = ApplyTo( in[i] );
+}
+
+void
+vsMatrix4x4::ApplyTo( const vsMatrix4x4 *in, vsMatrix4x4 *out, int count ) const
+{
+	static_assert( sizeof(vsVector4D) == sizeof(float) * 4, "vsVector4D must be four tightly packed floats" );
+
+	const vsSimd4 cx = vsSimdLoad( &x.x );
+	const vsSimd4 cy = vsSimdLoad( &y.x );
+	const vsSimd4 cz = vsSimdLoad( &z.x );
+	const vsSimd4 cw = vsSimdLoad( &w.x );
+
+	for ( int i = 0; i < count; i++ )
+	{
+		// Read all of 'in[i]' before we write anything, in case it's also
+		// 'out[i]'.
+		const vsMatrix4x4 o = in[i];
+		const vsVector4D *column = &o.x;
+		vsSimd4 result[4];
+		for ( int c = 0; c < 4; c++ )
+		{
+			const vsVector4D &oc = column[c];
+			result[c] = vsSimdAdd( vsSimdAdd( vsSimdAdd(
+							vsSimdMul( cx, vsSimdSplat(oc.x) ),
+							vsSimdMul( cy, vsSimdSplat(oc.y) ) ),
+						vsSimdMul( cz, vsSimdSplat(oc.z) ) ),
+					vsSimdMul( cw, vsSimdSplat(oc.w) ) );
+		}
+		vsSimdStore( &out[i].x.x, result[0] );
+		vsSimdStore( &out[i].y.x, result[1] );
+		vsSimdStore( &out[i].z.x, result[2] );
+		vsSimdStore( &out[i].w.x, result[3] );
+	}
+}
+
 vsMatrix4x4
 vsMatrix4x4::Transpose() const
 {
@@ -91,6 +91,12 @@ public:
 
 	vsMatrix4x4	operator*( const vsMatrix4x4 &o ) const { return ApplyTo(o); }
 	vsMatrix4x4	ApplyTo( const vsMatrix4x4 &o ) const;
+
+	// Batch versions of ApplyTo(), which use SIMD instructions where we have
+	// them.  They give exactly the same results as calling ApplyTo() on each
+	// item.  'in' and 'out' may be the same array.
+	void			ApplyTo( const vsVector3D *in, vsVector3D *out, int count ) const;
+	void			ApplyTo( const vsMatrix4x4 *in, vsMatrix4x4 *out, int count ) const;
 	vsMatrix4x4	ApplyInverseTo( const vsMatrix4x4 &o ) const;
 
 	bool operator==( const vsMatrix4x4 &o ) const { return ( x==o.x && y==o.y && z==o.z && w==o.w ); }
@@ -0,0 +1,160 @@
+/*
+ *  VS_SIMD.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_SIMD_H
+#define VS_SIMD_H
+
+// A minimal four-wide float vector, for the batch math functions (things like
+// vsMatrix4x4::ApplyTo() on arrays of points).  It's SSE on x86, NEON on ARM,
+// and plain C++ anywhere else, or if VS_NO_SIMD is defined.  Only the handful
+// of operations which the batch functions need are here;  this isn't meant
+// to be a general purpose SIMD library.
+//
+// The arithmetic functions do exactly the same IEEE operations as the scalar
+// code would, lane by lane.  So as long as you combine them in the same order
+// as the scalar version does, you'll get bit-identical results.
+
+#if !defined(VS_NO_SIMD) && ( defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) )
+#define VS_SIMD_SSE
+#include <emmintrin.h>
+#elif !defined(VS_NO_SIMD) && ( defined(__ARM_NEON) || defined(__ARM_NEON__) )
+#define VS_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define VS_SIMD_SCALAR
+#endif
+
+#if defined(VS_SIMD_SSE)
+
+typedef __m128 vsSimd4;
+typedef __m128 vsSimdMask4;
+
+inline vsSimd4 vsSimdSplat( float f ) { return _mm_set1_ps(f); }
+inline vsSimd4 vsSimdLoad( const float *f ) { return _mm_loadu_ps(f); }
+inline void vsSimdStore( float *f, vsSimd4 v ) { _mm_storeu_ps(f, v); }
+
+inline vsSimd4 vsSimdAdd( vsSimd4 a, vsSimd4 b ) { return _mm_add_ps(a, b); }
+inline vsSimd4 vsSimdSub( vsSimd4 a, vsSimd4 b ) { return _mm_sub_ps(a, b); }
+inline vsSimd4 vsSimdMul( vsSimd4 a, vsSimd4 b ) { return _mm_mul_ps(a, b); }
+inline vsSimd4 vsSimdMin( vsSimd4 a, vsSimd4 b ) { return _mm_min_ps(a, b); } // a < b ? a : b, like vsMin()
+inline vsSimd4 vsSimdMax( vsSimd4 a, vsSimd4 b ) { return _mm_max_ps(a, b); } // a > b ? a : b, like vsMax()
+
+inline vsSimdMask4 vsSimdLess( vsSimd4 a, vsSimd4 b ) { return _mm_cmplt_ps(a, b); }
+inline vsSimdMask4 vsSimdMaskOr( vsSimdMask4 a, vsSimdMask4 b ) { return _mm_or_ps(a, b); }
+inline vsSimdMask4 vsSimdMaskNone() { return _mm_setzero_ps(); }
+inline int vsSimdMaskBits( vsSimdMask4 m ) { return _mm_movemask_ps(m); } // bit i set if lane i is set
+
+// Loads four consecutive (x,y,z) triples and splits them into one vector per
+// component.
+inline void vsSimdLoad3( const float *xyz, vsSimd4 &x, vsSimd4 &y, vsSimd4 &z )
+{
+	__m128 a = _mm_loadu_ps( xyz );		// x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps( xyz + 4 );	// y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps( xyz + 8 );	// z2 x3 y3 z3
+
+	x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE(1,1,2,2) ), _MM_SHUFFLE(2,0,3,0) );
+	y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE(0,0,1,1) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE(2,2,3,3) ), _MM_SHUFFLE(2,0,2,0) );
+	z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE(1,1,2,2) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE(3,3,0,0) ), _MM_SHUFFLE(2,0,2,0) );
+}
+
+// The reverse of vsSimdLoad3().
+inline void vsSimdStore3( float *xyz, vsSimd4 x, vsSimd4 y, vsSimd4 z )
+{
+	__m128 a = _mm_shuffle_ps( _mm_unpacklo_ps( x, y ), _mm_shuffle_ps( z, x, _MM_SHUFFLE(1,1,0,0) ), _MM_SHUFFLE(2,0,1,0) );
+	__m128 b = _mm_shuffle_ps( _mm_shuffle_ps( y, z, _MM_SHUFFLE(1,1,1,1) ), _mm_shuffle_ps( x, y, _MM_SHUFFLE(2,2,2,2) ), _MM_SHUFFLE(2,0,2,0) );
+	__m128 c = _mm_shuffle_ps( _mm_shuffle_ps( z, x, _MM_SHUFFLE(3,3,2,2) ), _mm_shuffle_ps( y, z, _MM_SHUFFLE(3,3,3,3) ), _MM_SHUFFLE(2,0,2,0) );
+	_mm_storeu_ps( xyz, a );		// x0 y0 z0 x1
+	_mm_storeu_ps( xyz + 4, b );	// y1 z1 x2 y2
+	_mm_storeu_ps( xyz + 8, c );	// z2 x3 y3 z3
+}
+
+#elif defined(VS_SIMD_NEON)
+
+typedef float32x4_t vsSimd4;
+typedef uint32x4_t vsSimdMask4;
+
+inline vsSimd4 vsSimdSplat( float f ) { return vdupq_n_f32(f); }
+inline vsSimd4 vsSimdLoad( const float *f ) { return vld1q_f32(f); }
+inline void vsSimdStore( float *f, vsSimd4 v ) { vst1q_f32(f, v); }
+
+inline vsSimd4 vsSimdAdd( vsSimd4 a, vsSimd4 b ) { return vaddq_f32(a, b); }
+inline vsSimd4 vsSimdSub( vsSimd4 a, vsSimd4 b ) { return vsubq_f32(a, b); }
+inline vsSimd4 vsSimdMul( vsSimd4 a, vsSimd4 b ) { return vmulq_f32(a, b); }
+inline vsSimd4 vsSimdMin( vsSimd4 a, vsSimd4 b ) { return vbslq_f32( vcltq_f32(a, b), a, b ); }
+inline vsSimd4 vsSimdMax( vsSimd4 a, vsSimd4 b ) { return vbslq_f32( vcgtq_f32(a, b), a, b ); }
+
+inline vsSimdMask4 vsSimdLess( vsSimd4 a, vsSimd4 b ) { return vcltq_f32(a, b); }
+inline vsSimdMask4 vsSimdMaskOr( vsSimdMask4 a, vsSimdMask4 b ) { return vorrq_u32(a, b); }
+inline vsSimdMask4 vsSimdMaskNone() { return vdupq_n_u32(0); }
+inline int vsSimdMaskBits( vsSimdMask4 m )
+{
+	return (vgetq_lane_u32(m, 0) & 1) | (vgetq_lane_u32(m, 1) & 2) | (vgetq_lane_u32(m, 2) & 4) | (vgetq_lane_u32(m, 3) & 8);
+}
+
+inline void vsSimdLoad3( const float *xyz, vsSimd4 &x, vsSimd4 &y, vsSimd4 &z )
+{
+	float32x4x3_t v = vld3q_f32( xyz );
+	x = v.val[0];
+	y = v.val[1];
+	z = v.val[2];
+}
+
+inline void vsSimdStore3( float *xyz, vsSimd4 x, vsSimd4 y, vsSimd4 z )
+{
+	float32x4x3_t v;
+	v.val[0] = x;
+	v.val[1] = y;
+	v.val[2] = z;
+	vst3q_f32( xyz, v );
+}
+
+#else // VS_SIMD_SCALAR
+
+struct vsSimd4 { float f[4]; };
+struct vsSimdMask4 { bool b[4]; };
+
+inline vsSimd4 vsSimdSplat( float f ) { vsSimd4 r = {{ f, f, f, f }}; return r; }
+inline vsSimd4 vsSimdLoad( const float *f ) { vsSimd4 r = {{ f[0], f[1], f[2], f[3] }}; return r; }
+inline void vsSimdStore( float *f, vsSimd4 v ) { for ( int i = 0; i < 4; i++ ) f[i] = v.f[i]; }
+
+inline vsSimd4 vsSimdAdd( vsSimd4 a, vsSimd4 b ) { for ( int i = 0; i < 4; i++ ) a.f[i] += b.f[i]; return a; }
+inline vsSimd4 vsSimdSub( vsSimd4 a, vsSimd4 b ) { for ( int i = 0; i < 4; i++ ) a.f[i] -= b.f[i]; return a; }
+inline vsSimd4 vsSimdMul( vsSimd4 a, vsSimd4 b ) { for ( int i = 0; i < 4; i++ ) a.f[i] *= b.f[i]; return a; }
+inline vsSimd4 vsSimdMin( vsSimd4 a, vsSimd4 b ) { for ( int i = 0; i < 4; i++ ) a.f[i] = ( a.f[i] < b.f[i] ) ? a.f[i] : b.f[i]; return a; }
+inline vsSimd4 vsSimdMax( vsSimd4 a, vsSimd4 b ) { for ( int i = 0; i < 4; i++ ) a.f[i] = ( a.f[i] > b.f[i] ) ? a.f[i] : b.f[i]; return a; }
+
+inline vsSimdMask4 vsSimdLess( vsSimd4 a, vsSimd4 b ) { vsSimdMask4 r; for ( int i = 0; i < 4; i++ ) r.b[i] = a.f[i] < b.f[i]; return r; }
+inline vsSimdMask4 vsSimdMaskOr( vsSimdMask4 a, vsSimdMask4 b ) { for ( int i = 0; i < 4; i++ ) a.b[i] = a.b[i] || b.b[i]; return a; }
+inline vsSimdMask4 vsSimdMaskNone() { vsSimdMask4 r = {{ false, false, false, false }}; return r; }
+inline int vsSimdMaskBits( vsSimdMask4 m ) { return (m.b[0] ? 1 : 0) | (m.b[1] ? 2 : 0) | (m.b[2] ? 4 : 0) | (m.b[3] ? 8 : 0); }
+
+inline void vsSimdLoad3( const float *xyz, vsSimd4 &x, vsSimd4 &y, vsSimd4 &z )
+{
+	for ( int i = 0; i < 4; i++ )
+	{
+		x.f[i] = xyz[i*3];
+		y.f[i] = xyz[i*3+1];
+		z.f[i] = xyz[i*3+2];
+	}
+}
+
+inline void vsSimdStore3( float *xyz, vsSimd4 x, vsSimd4 y, vsSimd4 z )
+{
+	for ( int i = 0; i < 4; i++ )
+	{
+		xyz[i*3] = x.f[i];
+		xyz[i*3+1] = y.f[i];
+		xyz[i*3+2] = z.f[i];
+	}
+}
+
+#endif
+
+#endif // VS_SIMD_H
+
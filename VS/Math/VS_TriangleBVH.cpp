@@ -0,0 +1,442 @@
+/*
+ *  VS_TriangleBVH.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_TriangleBVH.h"
+#include "VS_Math.h"
+
+#include "VS/Threads/VS_JobSystem.h"
+
+#include "VS_Profile.h"
+
+#include <float.h>
+
+// 32 bytes.  Interior nodes have count == 0, and their children are at
+// 'first' and 'first+1'.  Leaves hold triangles [first, first+count) in leaf
+// order.
+struct vsTriangleBVH::Node
+{
+	vsVector3D	min;
+	int			first;
+	vsVector3D	max;
+	int			count;
+};
+
+namespace
+{
+	const int c_maxDepth = 64;
+
+	struct Bin
+	{
+		vsBox3D	bounds;
+		int		count;
+	};
+
+	float SurfaceArea( const vsBox3D &box )
+	{
+		if ( !box.IsSet() )
+			return 0.f;
+		vsVector3D e = box.Extents();
+		return 2.f * (e.x*e.y + e.y*e.z + e.z*e.x);
+	}
+
+	// Distance along the ray to where it enters 'node', or FLT_MAX if it
+	// misses the node or only reaches it after 'maxT'.
+	inline float RayVsNode( const vsVector3D &min, const vsVector3D &max, const vsVector3D &pos, const vsVector3D &invDir, float maxT )
+	{
+		float tx1 = (min.x - pos.x) * invDir.x;
+		float tx2 = (max.x - pos.x) * invDir.x;
+		float tmin = vsMin( tx1, tx2 );
+		float tmax = vsMax( tx1, tx2 );
+
+		float ty1 = (min.y - pos.y) * invDir.y;
+		float ty2 = (max.y - pos.y) * invDir.y;
+		tmin = vsMax( tmin, vsMin( ty1, ty2 ) );
+		tmax = vsMin( tmax, vsMax( ty1, ty2 ) );
+
+		float tz1 = (min.z - pos.z) * invDir.z;
+		float tz2 = (max.z - pos.z) * invDir.z;
+		tmin = vsMax( tmin, vsMin( tz1, tz2 ) );
+		tmax = vsMin( tmax, vsMax( tz1, tz2 ) );
+
+		tmin = vsMax( tmin, 0.f );
+		tmax = vsMin( tmax, maxT );
+		return ( tmax >= tmin ) ? tmin : FLT_MAX;
+	}
+
+	vsVector3D InverseDirection( const vsVector3D &dir )
+	{
+		// Dividing by zero gives us infinities, which the slab test handles.
+		return vsVector3D( 1.f / dir.x, 1.f / dir.y, 1.f / dir.z );
+	}
+};
+
+vsTriangleBVH::vsTriangleBVH():
+	m_node(nullptr),
+	m_nodeCount(0),
+	m_vertex(nullptr),
+	m_index(nullptr),
+	m_slot(nullptr),
+	m_triangleCount(0)
+{
+}
+
+vsTriangleBVH::~vsTriangleBVH()
+{
+	Clear();
+}
+
+void
+vsTriangleBVH::Clear()
+{
+	vsDeleteArray( m_node );
+	vsDeleteArray( m_vertex );
+	vsDeleteArray( m_index );
+	vsDeleteArray( m_slot );
+	m_nodeCount = 0;
+	m_triangleCount = 0;
+}
+
+void
+vsTriangleBVH::Build( const vsVector3D *vertex, int triangleCount )
+{
+	PROFILE("TriangleBVH::Build");
+	Clear();
+	if ( triangleCount <= 0 )
+		return;
+
+	m_triangleCount = triangleCount;
+	m_index = new int[triangleCount];
+
+	vsBox3D *bounds = new vsBox3D[triangleCount];
+	vsVector3D *centroid = new vsVector3D[triangleCount];
+	for ( int i = 0; i < triangleCount; i++ )
+	{
+		m_index[i] = i;
+		bounds[i].Set( const_cast<vsVector3D*>(&vertex[i*3]), 3 );
+		centroid[i] = bounds[i].Middle();
+	}
+
+	// A binary tree with at least one triangle per leaf can't have more than
+	// this many nodes.
+	m_node = new Node[ triangleCount * 2 - 1 ];
+	m_nodeCount = 1;
+	m_node[0].first = 0;
+	m_node[0].count = triangleCount;
+
+	// Each pending node carries its depth, so we can stop splitting before
+	// the tree gets deeper than the traversal stacks can handle.  A node at
+	// depth 'd' has at most 'd' pending siblings, so as long as interior
+	// nodes stay shallower than c_maxDepth-1, none of our stacks can ever
+	// hold more than c_maxDepth entries.
+	int stack[c_maxDepth];
+	int depth[c_maxDepth];
+	int stackSize = 0;
+	stack[stackSize] = 0;
+	depth[stackSize++] = 0;
+
+	while ( stackSize > 0 )
+	{
+		--stackSize;
+		Node &node = m_node[ stack[stackSize] ];
+		int nodeDepth = depth[stackSize];
+
+		vsBox3D nodeBounds, centroidBounds;
+		for ( int i = node.first; i < node.first + node.count; i++ )
+		{
+			nodeBounds.ExpandToInclude( bounds[ m_index[i] ] );
+			centroidBounds.ExpandToInclude( centroid[ m_index[i] ] );
+		}
+		node.min = nodeBounds.GetMin();
+		node.max = nodeBounds.GetMax();
+
+		if ( node.count <= c_maxLeafTriangles || nodeDepth >= c_maxDepth - 1 )
+			continue;
+
+		// Bin the triangles by centroid along each axis, and pick the split
+		// between bins which has the lowest surface area cost.
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		int bestSplit = 0;
+		vsVector3D cmin = centroidBounds.GetMin();
+		vsVector3D extent = centroidBounds.Extents();
+
+		for ( int axis = 0; axis < 3; axis++ )
+		{
+			if ( extent[axis] <= 0.f )
+				continue;
+
+			Bin bin[c_sahBins];
+			for ( int b = 0; b < c_sahBins; b++ )
+				bin[b].count = 0;
+
+			float scale = c_sahBins / extent[axis];
+			for ( int i = node.first; i < node.first + node.count; i++ )
+			{
+				int tri = m_index[i];
+				int b = vsMin( c_sahBins - 1, (int)((centroid[tri][axis] - cmin[axis]) * scale) );
+				bin[b].count++;
+				bin[b].bounds.ExpandToInclude( bounds[tri] );
+			}
+
+			// Sweep from each end, so we can cost every split in one pass.
+			float leftArea[c_sahBins-1];
+			int leftCount[c_sahBins-1];
+			vsBox3D box;
+			int count = 0;
+			for ( int b = 0; b < c_sahBins - 1; b++ )
+			{
+				count += bin[b].count;
+				if ( bin[b].count )
+					box.ExpandToInclude( bin[b].bounds );
+				leftArea[b] = SurfaceArea( box );
+				leftCount[b] = count;
+			}
+			box = vsBox3D();
+			count = 0;
+			for ( int b = c_sahBins - 1; b > 0; b-- )
+			{
+				count += bin[b].count;
+				if ( bin[b].count )
+					box.ExpandToInclude( bin[b].bounds );
+				float cost = leftArea[b-1] * leftCount[b-1] + SurfaceArea( box ) * count;
+				if ( leftCount[b-1] > 0 && count > 0 && cost < bestCost )
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		// Splitting has to beat just testing every triangle in this node.
+		float leafCost = SurfaceArea( nodeBounds ) * node.count;
+		if ( bestAxis < 0 || bestCost >= leafCost )
+			continue;
+
+		// Partition by the same bin calculation we used above, so rounding
+		// can't put a triangle on the other side from where we costed it.
+		float scale = c_sahBins / extent[bestAxis];
+		int i = node.first;
+		int j = node.first + node.count - 1;
+		while ( i <= j )
+		{
+			int b = vsMin( c_sahBins - 1, (int)((centroid[ m_index[i] ][bestAxis] - cmin[bestAxis]) * scale) );
+			if ( b < bestSplit )
+				i++;
+			else
+			{
+				int swap = m_index[i];
+				m_index[i] = m_index[j];
+				m_index[j--] = swap;
+			}
+		}
+
+		int leftCount = i - node.first;
+		if ( leftCount == 0 || leftCount == node.count )
+			continue;
+
+		int left = m_nodeCount;
+		m_nodeCount += 2;
+		m_node[left].first = node.first;
+		m_node[left].count = leftCount;
+		m_node[left+1].first = i;
+		m_node[left+1].count = node.count - leftCount;
+		node.first = left;
+		node.count = 0;
+
+		stack[stackSize] = left+1;
+		depth[stackSize++] = nodeDepth+1;
+		stack[stackSize] = left;
+		depth[stackSize++] = nodeDepth+1;
+	}
+
+	// Store the triangles in leaf order, so each leaf's vertices are together.
+	m_vertex = new vsVector3D[triangleCount * 3];
+	m_slot = new int[triangleCount];
+	for ( int i = 0; i < triangleCount; i++ )
+	{
+		int tri = m_index[i];
+		m_vertex[i*3] = vertex[tri*3];
+		m_vertex[i*3+1] = vertex[tri*3+1];
+		m_vertex[i*3+2] = vertex[tri*3+2];
+		m_slot[tri] = i;
+	}
+
+	vsDeleteArray( bounds );
+	vsDeleteArray( centroid );
+}
+
+vsBox3D
+vsTriangleBVH::GetBoundingBox() const
+{
+	if ( m_nodeCount == 0 )
+		return vsBox3D();
+	return vsBox3D( m_node[0].min, m_node[0].max );
+}
+
+bool
+vsTriangleBVH::CollideRay( const Ray &ray, Hit *hit ) const
+{
+	hit->t = ray.maxT;
+	hit->triangle = -1;
+	if ( m_nodeCount == 0 )
+		return false;
+
+	vsVector3D invDir = InverseDirection( ray.dir );
+	if ( RayVsNode( m_node[0].min, m_node[0].max, ray.pos, invDir, hit->t ) == FLT_MAX )
+		return false;
+
+	int stack[c_maxDepth];
+	int stackSize = 0;
+	const Node *node = &m_node[0];
+
+	while ( 1 )
+	{
+		if ( node->count > 0 )
+		{
+			for ( int i = node->first; i < node->first + node->count; i++ )
+			{
+				const vsVector3D *v = &m_vertex[i*3];
+				float t, u, w;
+				if ( vsCollideRayVsTriangle( ray.pos, ray.dir, v[0], v[1], v[2], &t, &u, &w ) && t < hit->t )
+				{
+					hit->t = t;
+					hit->u = u;
+					hit->v = w;
+					hit->triangle = m_index[i];
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearer child first;  a hit in there can let us skip
+			// the other one entirely.
+			const Node *a = &m_node[node->first];
+			const Node *b = a+1;
+			float ta = RayVsNode( a->min, a->max, ray.pos, invDir, hit->t );
+			float tb = RayVsNode( b->min, b->max, ray.pos, invDir, hit->t );
+			if ( tb < ta )
+			{
+				const Node *swapNode = a; a = b; b = swapNode;
+				float swapT = ta; ta = tb; tb = swapT;
+			}
+			if ( ta != FLT_MAX )
+			{
+				if ( tb != FLT_MAX )
+					stack[stackSize++] = (int)(b - m_node);
+				node = a;
+				continue;
+			}
+		}
+
+		// Pop the next node which is still closer than our best hit.
+		node = nullptr;
+		while ( stackSize > 0 && !node )
+		{
+			const Node *n = &m_node[ stack[--stackSize] ];
+			if ( RayVsNode( n->min, n->max, ray.pos, invDir, hit->t ) != FLT_MAX )
+				node = n;
+		}
+		if ( !node )
+			break;
+	}
+
+	return hit->triangle >= 0;
+}
+
+bool
+vsTriangleBVH::CollideRayAny( const Ray &ray, Hit *hit ) const
+{
+	if ( hit )
+	{
+		hit->t = ray.maxT;
+		hit->triangle = -1;
+	}
+	if ( m_nodeCount == 0 )
+		return false;
+
+	vsVector3D invDir = InverseDirection( ray.dir );
+	int stack[c_maxDepth];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while ( stackSize > 0 )
+	{
+		const Node &node = m_node[ stack[--stackSize] ];
+		if ( RayVsNode( node.min, node.max, ray.pos, invDir, ray.maxT ) == FLT_MAX )
+			continue;
+
+		if ( node.count > 0 )
+		{
+			for ( int i = node.first; i < node.first + node.count; i++ )
+			{
+				const vsVector3D *v = &m_vertex[i*3];
+				float t, u, w;
+				if ( vsCollideRayVsTriangle( ray.pos, ray.dir, v[0], v[1], v[2], &t, &u, &w ) && t < ray.maxT )
+				{
+					if ( hit )
+					{
+						hit->t = t;
+						hit->u = u;
+						hit->v = w;
+						hit->triangle = m_index[i];
+					}
+					return true;
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.first+1;
+			stack[stackSize++] = node.first;
+		}
+	}
+	return false;
+}
+
+int
+vsTriangleBVH::CollideRays( const Ray *ray, Hit *hit, int count, bool anyHit ) const
+{
+	auto collide = [=]( int start, int end )
+	{
+		for ( int i = start; i < end; i++ )
+		{
+			if ( anyHit )
+				CollideRayAny( ray[i], &hit[i] );
+			else
+				CollideRay( ray[i], &hit[i] );
+		}
+	};
+
+	vsJobSystem *jobs = vsJobSystem::Instance();
+	if ( jobs && count >= c_minParallelRays )
+		jobs->ParallelFor( 0, count, c_minParallelRays / 4, collide );
+	else
+		collide( 0, count );
+
+	int hits = 0;
+	for ( int i = 0; i < count; i++ )
+	{
+		if ( hit[i].triangle >= 0 )
+			hits++;
+	}
+	return hits;
+}
+
+vsVector3D
+vsTriangleBVH::GetTriangleNormal( int triangle, const vsVector3D &dir ) const
+{
+	const vsVector3D *v = &m_vertex[ m_slot[triangle] * 3 ];
+	vsVector3D normal = (v[2]-v[0]).Cross( v[1]-v[0] );
+	normal.NormaliseSafe();
+	if ( normal.Dot( dir ) > 0.f )
+		normal *= -1.f;
+	return normal;
+}
+
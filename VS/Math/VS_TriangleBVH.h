@@ -0,0 +1,88 @@
+/*
+ *  VS_TriangleBVH.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_TRIANGLEBVH_H
+#define VS_TRIANGLEBVH_H
+
+#include "VS_Box.h"
+#include "VS_Vector.h"
+
+// vsTriangleBVH is a bounding volume hierarchy over a fixed set of triangles,
+// for fast ray queries against static geometry.  It's built top-down using a
+// binned surface area heuristic.  Once built it's read-only, so any number of
+// threads can query it at once.
+//
+// Triangles are identified by their index in the array that was passed to
+// Build().
+
+class vsTriangleBVH
+{
+public:
+	struct Ray
+	{
+		vsVector3D	pos;
+		vsVector3D	dir;
+		float		maxT;	// only hits closer than this count
+	};
+
+	struct Hit
+	{
+		float	t;			// hit point is pos + dir * t
+		float	u, v;		// barycentric coordinates of the hit point
+		int		triangle;	// -1 if there was no hit
+	};
+
+private:
+	struct Node;
+
+	Node *			m_node;
+	int				m_nodeCount;
+
+	vsVector3D *	m_vertex;	// three per triangle, in leaf order
+	int *			m_index;	// leaf order -> original triangle index
+	int *			m_slot;		// original triangle index -> leaf order
+	int				m_triangleCount;
+
+public:
+	static const int c_maxLeafTriangles = 4;
+	static const int c_sahBins = 16;
+	static const int c_minParallelRays = 256;	// CollideRays() batches smaller than this just run on the calling thread
+
+	vsTriangleBVH();
+	~vsTriangleBVH();
+
+	// 'vertex' holds three vertices per triangle.
+	void		Build( const vsVector3D *vertex, int triangleCount );
+	void		Clear();
+
+	int			GetTriangleCount() const { return m_triangleCount; }
+	int			GetNodeCount() const { return m_nodeCount; }
+	vsBox3D		GetBoundingBox() const;
+
+	// Finds the closest hit along the ray.  Returns false if nothing was hit
+	// before 'ray.maxT'.
+	bool		CollideRay( const Ray &ray, Hit *hit ) const;
+
+	// Returns true as soon as we find any hit before 'ray.maxT', which isn't
+	// necessarily the closest one.  Much cheaper than CollideRay() when you
+	// only need to know whether the ray is blocked, for line of sight tests
+	// and the like.
+	bool		CollideRayAny( const Ray &ray, Hit *hit = nullptr ) const;
+
+	// Runs CollideRay() (or CollideRayAny(), if 'anyHit' is set) for each of
+	// 'count' rays, spreading big batches across the job system.  Misses have
+	// 'triangle' set to -1.  Returns the number of rays which hit something.
+	int			CollideRays( const Ray *ray, Hit *hit, int count, bool anyHit = false ) const;
+
+	// Facing away from 'dir', as vsModel::CollideRay() has always done.
+	vsVector3D	GetTriangleNormal( int triangle, const vsVector3D &dir ) const;
+};
+
+#endif // VS_TRIANGLEBVH_H
+
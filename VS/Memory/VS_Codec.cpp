@@ -0,0 +1,123 @@
+/*
+ *  VS_Codec.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Codec.h"
+
+#include "tracy/common/tracy_lz4.hpp"
+#include <climits>
+#include <zlib.h>
+
+namespace
+{
+	class vsZlibCodec : public vsCodec
+	{
+	public:
+		virtual const char * GetName() const { return "zlib"; }
+		virtual char GetTag() const { return 'Z'; }
+
+		virtual size_t GetMaxCompressedLength( size_t length ) const
+		{
+			return compressBound( (uLong)length );
+		}
+
+		virtual size_t Compress( const char *in, size_t inLength, char *out, size_t outCapacity ) const
+		{
+			uLongf outLength = (uLongf)outCapacity;
+			int ret = compress2( (Bytef*)out, &outLength, (const Bytef*)in, (uLong)inLength, Z_DEFAULT_COMPRESSION );
+			return ( ret == Z_OK ) ? outLength : 0;
+		}
+
+		virtual bool Decompress( const char *in, size_t inLength, char *out, size_t outLength ) const
+		{
+			// uncompress() quietly throws away the output if it's given no
+			// room for any, so it would claim success at fitting any stream
+			// into zero bytes.  Give it a byte of room, to catch that.
+			char scratch;
+			uLongf length = (uLongf)outLength;
+			if ( outLength == 0 )
+			{
+				out = &scratch;
+				length = 1;
+			}
+			int ret = uncompress( (Bytef*)out, &length, (const Bytef*)in, (uLong)inLength );
+			return ( ret == Z_OK && length == outLength );
+		}
+	};
+
+	class vsLZ4Codec : public vsCodec
+	{
+	public:
+		virtual const char * GetName() const { return "LZ4"; }
+		virtual char GetTag() const { return '4'; }
+
+		// LZ4 works in ints, so it can't handle anything 2GB or bigger.
+		virtual size_t GetMaxCompressedLength( size_t length ) const
+		{
+			vsAssert( length <= (size_t)LZ4_MAX_INPUT_SIZE, "Too much data for LZ4" );
+			return tracy::LZ4_compressBound( (int)length );
+		}
+
+		virtual size_t Compress( const char *in, size_t inLength, char *out, size_t outCapacity ) const
+		{
+			if ( inLength > (size_t)LZ4_MAX_INPUT_SIZE )
+				return 0;
+			int ret = tracy::LZ4_compress_default( in, out, (int)inLength, (int)vsMin( outCapacity, (size_t)INT_MAX ) );
+			return ( ret > 0 ) ? ret : 0;
+		}
+
+		virtual bool Decompress( const char *in, size_t inLength, char *out, size_t outLength ) const
+		{
+			if ( inLength > (size_t)INT_MAX || outLength > (size_t)INT_MAX )
+				return false;
+			int ret = tracy::LZ4_decompress_safe( in, out, (int)inLength, (int)outLength );
+			return ( ret >= 0 && (size_t)ret == outLength );
+		}
+	};
+
+	vsZlibCodec s_zlib;
+	vsLZ4Codec s_lz4;
+
+	const vsCodec * s_codec[vsCodec::Type_MAX] =
+	{
+		&s_zlib,
+		&s_lz4
+	};
+
+	const vsCodec * s_default = &s_zlib;
+};
+
+const vsCodec *
+vsCodec::Get( Type type )
+{
+	vsAssert( type >= 0 && type < Type_MAX, "Unknown codec type" );
+	return s_codec[type];
+}
+
+const vsCodec *
+vsCodec::FindByTag( char tag )
+{
+	for ( int i = 0; i < Type_MAX; i++ )
+	{
+		if ( s_codec[i]->GetTag() == tag )
+			return s_codec[i];
+	}
+	return nullptr;
+}
+
+const vsCodec *
+vsCodec::GetDefault()
+{
+	return s_default;
+}
+
+void
+vsCodec::SetDefault( Type type )
+{
+	s_default = Get( type );
+}
@@ -0,0 +1,58 @@
+/*
+ *  VS_Codec.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_CODEC_H
+#define VS_CODEC_H
+
+// A vsCodec compresses and decompresses whole buffers at once.  vsFile's
+// blocked compressed files and vsStore::Compress() go through one, and record
+// which one they used (by its tag) alongside the compressed data, so that
+// they can be read back no matter which codec is the default at the time.
+//
+// Decompressing needs to be told exactly how big the result is, so whoever
+// stores compressed data has to store its uncompressed length, too.
+//
+// Codecs don't keep any state between calls, so they're safe to use from any
+// number of threads at once.
+
+class vsCodec
+{
+public:
+
+	enum Type
+	{
+		Type_Zlib,	// DEFLATE at zlib's default level;  best ratio, slowest
+		Type_LZ4,	// several times faster to decompress than zlib, but bigger
+		Type_MAX
+	};
+
+	virtual ~vsCodec() {}
+
+	virtual const char *	GetName() const = 0;
+	virtual char			GetTag() const = 0;
+
+	// How big Compress()'s output might be, for 'length' bytes of input.
+	virtual size_t			GetMaxCompressedLength( size_t length ) const = 0;
+
+	// Returns the compressed length, or 0 if 'out' wasn't big enough.
+	virtual size_t			Compress( const char *in, size_t inLength, char *out, size_t outCapacity ) const = 0;
+
+	// Returns false if 'in' doesn't decompress to exactly 'outLength' bytes.
+	virtual bool			Decompress( const char *in, size_t inLength, char *out, size_t outLength ) const = 0;
+
+	static const vsCodec *	Get( Type type );
+	static const vsCodec *	FindByTag( char tag );	// nullptr if we don't know that tag
+
+	// The codec that new compressed data is written with, unless the caller
+	// asks for a specific one.  zlib, unless the game says otherwise.
+	static const vsCodec *	GetDefault();
+	static void				SetDefault( Type type );
+};
+
+#endif // VS_CODEC_H
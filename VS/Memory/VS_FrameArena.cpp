@@ -0,0 +1,136 @@
+/*
+ *  VS_FrameArena.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_FrameArena.h"
+
+vsFrameArena * vsFrameArena::s_instance = nullptr;
+thread_local vsFrameArena * vsFrameArena::s_threadInstance = nullptr;
+
+namespace
+{
+	inline size_t AlignUp( size_t value, size_t alignment )
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+};
+
+vsFrameArena::vsFrameArena( size_t initialSize, bool shared ):
+	m_current(0),
+	m_bytesUsedLastFrame(0),
+	m_frame(0),
+	m_shared(shared)
+{
+	vsAssert(!shared || s_instance == nullptr, "Multiple shared vsFrameArenas created??");
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		m_buffer[i].memory = new char[initialSize];
+		m_buffer[i].size = initialSize;
+		m_buffer[i].used = 0;
+		m_buffer[i].overflowBytes = 0;
+		m_buffer[i].overflow = nullptr;
+	}
+
+	if ( shared )
+		s_instance = this;
+}
+
+vsFrameArena::~vsFrameArena()
+{
+	for ( int i = 0; i < 2; i++ )
+	{
+		ResetBuffer( m_buffer[i] );
+		vsDeleteArray( m_buffer[i].memory );
+	}
+
+	if ( m_shared )
+	{
+		vsAssert(s_instance == this, "vsFrameArena instance isn't me??");
+		s_instance = nullptr;
+	}
+}
+
+void *
+vsFrameArena::Alloc( size_t bytes, size_t alignment )
+{
+	Buffer& buffer = m_buffer[m_current];
+
+	size_t start = AlignUp( buffer.used, alignment );
+	if ( start + bytes <= buffer.size )
+	{
+		buffer.used = start + bytes;
+		return buffer.memory + start;
+	}
+
+	// Out of space in this frame's buffer.  Fall back to the heap for now, and
+	// remember how much we needed so we can grow the buffer when it's reset.
+	size_t headerSize = AlignUp( sizeof(Overflow), alignment );
+	char *block = new char[ headerSize + bytes + alignment ];
+	Overflow *overflow = reinterpret_cast<Overflow*>(block);
+	overflow->next = buffer.overflow;
+	buffer.overflow = overflow;
+	buffer.overflowBytes += bytes + alignment;
+
+	return reinterpret_cast<void*>( AlignUp( (size_t)(block + headerSize), alignment ) );
+}
+
+void
+vsFrameArena::ResetBuffer( Buffer& buffer )
+{
+	while ( buffer.overflow )
+	{
+		Overflow *next = buffer.overflow->next;
+		char *block = reinterpret_cast<char*>(buffer.overflow);
+		vsDeleteArray( block );
+		buffer.overflow = next;
+	}
+	buffer.used = 0;
+}
+
+void
+vsFrameArena::FrameRendered()
+{
+	Buffer& finished = m_buffer[m_current];
+	m_bytesUsedLastFrame = finished.used + finished.overflowBytes;
+
+	m_current = 1 - m_current;
+	m_frame++;
+
+	// This buffer was last used two frames ago;  nobody can be looking at its
+	// contents any more.
+	Buffer& buffer = m_buffer[m_current];
+	size_t required = buffer.used + buffer.overflowBytes;
+	ResetBuffer( buffer );
+
+	if ( buffer.overflowBytes > 0 )
+	{
+		size_t newSize = buffer.size;
+		while ( newSize < required )
+			newSize *= 2;
+		vsLog("vsFrameArena:  growing frame buffer from %zu to %zu bytes", buffer.size, newSize);
+
+		vsDeleteArray( buffer.memory );
+		buffer.memory = new char[newSize];
+		buffer.size = newSize;
+		buffer.overflowBytes = 0;
+	}
+}
+
+void
+vsFrameArena::CatchUp()
+{
+	// If we skipped some frames entirely, one flip is still enough;  our
+	// other buffer holds data from even longer ago.
+	if ( s_instance && m_frame != s_instance->m_frame )
+	{
+		FrameRendered();
+		m_frame = s_instance->m_frame;
+	}
+}
+
@@ -0,0 +1,109 @@
+/*
+ *  VS_FrameArena.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_FRAMEARENA_H
+#define VS_FRAMEARENA_H
+
+#include "VS/VS_DisableDebugNew.h"
+#include <new>
+#include <utility>
+#include "VS/VS_EnableDebugNew.h"
+
+// vsFrameArena is a bump-pointer allocator for data which only needs to live
+// for a single frame (render queue batches, temporary display lists, and so
+// on).  Allocation is just a pointer increment, and everything allocated in a
+// frame is thrown away at once.
+//
+// The arena is double-buffered:  memory allocated during frame N stays valid
+// until the end of frame N+1, so anything which is still being read by the
+// renderer after the render queue has finished with it (instance matrix
+// arrays, for example) is safe.
+//
+// If a frame allocates more than fits in its buffer, the overflow is served
+// from the general heap, and the buffer is grown the next time it's reset.  So
+// after a few frames of warm-up, the steady state makes no heap allocations.
+//
+// Objects created with New<>() do NOT have their destructors called when the
+// arena is reset;  anything with a non-trivial destructor must be destroyed
+// manually by whoever created it.
+//
+// Worker threads which build render data get an arena of their own (see
+// vsParallelDraw), set with SetThreadInstance();  Instance() returns that
+// arena on those threads, and the shared one everywhere else.  Thread arenas
+// don't get their own FrameRendered() call;  instead they call CatchUp() before
+// they start allocating each frame, and flip if the shared arena has moved on.
+
+class vsFrameArena
+{
+	static vsFrameArena *	s_instance;
+	static thread_local vsFrameArena *	s_threadInstance;
+
+	struct Overflow
+	{
+		Overflow *	next;
+	};
+
+	struct Buffer
+	{
+		char *		memory;
+		size_t		size;
+		size_t		used;
+		size_t		overflowBytes;
+		Overflow *	overflow;
+	};
+
+	Buffer	m_buffer[2];
+	int		m_current;
+
+	size_t	m_bytesUsedLastFrame;
+	uint64_t	m_frame;
+	bool	m_shared;
+
+	void	ResetBuffer( Buffer& buffer );
+
+public:
+	static vsFrameArena* Instance() { return s_threadInstance ? s_threadInstance : s_instance; }
+	static void SetThreadInstance( vsFrameArena *arena ) { s_threadInstance = arena; }
+
+	// 'shared' arenas become the global Instance();  there can only be one.
+	vsFrameArena( size_t initialSize = 1024 * 1024, bool shared = true );
+	~vsFrameArena();
+
+	void *	Alloc( size_t bytes, size_t alignment = 16 );
+
+	// Uninitialised storage for 'count' objects of type T.
+	template<typename T>
+	T *		Alloc( int count ) { return reinterpret_cast<T*>( Alloc( sizeof(T) * count, alignof(T) ) ); }
+
+	template<typename T, typename... Args>
+	T *		New( Args&&... args );
+
+	// Called once the frame has been presented.  Flips to our other buffer,
+	// releasing everything which was allocated into it two frames ago.
+	void	FrameRendered();
+
+	// For thread arenas;  flip if the shared arena has had FrameRendered()
+	// called since we last caught up.  Only safe while nobody is allocating
+	// from us, and the shared arena isn't flipping.
+	void	CatchUp();
+
+	size_t	GetBytesUsedLastFrame() const { return m_bytesUsedLastFrame; }
+};
+
+#include "VS/VS_DisableDebugNew.h"
+template<typename T, typename... Args>
+T *
+vsFrameArena::New( Args&&... args )
+{
+	return ::new( Alloc( sizeof(T), alignof(T) ) ) T( std::forward<Args>(args)... );
+}
+#include "VS/VS_EnableDebugNew.h"
+
+#endif // VS_FRAMEARENA_H
+
@@ -13,11 +13,13 @@
 
 #ifdef MSVC
 #define strncpy strncpy_s
+#include <intrin.h>
 #endif
 
 vsHeap *g_globalHeap;
 
 vsHeap * vsHeap::s_current = nullptr;
+std::atomic<uint64_t> vsHeap::s_allocationCount(0);
 
 #define MAX_HEAP_STACK (4)
 static vsHeap *	s_stack[MAX_HEAP_STACK] = {nullptr,nullptr,nullptr,nullptr};
@@ -26,6 +28,121 @@ static vsHeap *	s_stack[MAX_HEAP_STACK] = {nullptr,nullptr,nullptr,nullptr};
 #undef malloc
 #undef free
 
+namespace
+{
+	// index of the lowest set bit.  'x' must be non-zero.
+	inline int LowestBit( uint64_t x )
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, x);
+		return (int)index;
+#else
+		return __builtin_ctzll(x);
+#endif
+	}
+
+	// index of the highest set bit.  'x' must be non-zero.
+	inline int HighestBit( uint64_t x )
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, x);
+		return (int)index;
+#else
+		return 63 - __builtin_clzll(x);
+#endif
+	}
+
+	// Each thread keeps a separate cache for each heap it has touched.  Cached
+	// blocks are chained together through their (otherwise unused) user area.
+	//
+	// Every slot which is bound to a heap is also linked into s_boundSlots, so
+	// that a heap which is being destroyed can find and clear the slots which
+	// other threads hold for it.  Binding, unbinding and walking that list all
+	// happen under s_boundSlotsLock, which is always taken before any heap's
+	// own lock.  A slot's 'heap' is only ever changed under that lock, but its
+	// owning thread reads it without locking, so it's atomic.
+	struct ThreadCacheSlot
+	{
+		std::atomic<vsHeap *>	heap;
+		int						count[HEAP_CACHE_BIN_COUNT];
+		memBlock *				bin[HEAP_CACHE_BIN_COUNT];
+
+		ThreadCacheSlot *		prevBound;
+		ThreadCacheSlot *		nextBound;
+	};
+
+	struct ThreadCache
+	{
+		ThreadCacheSlot slot[MAX_HEAP_STACK];
+
+		// threads which never call FlushThreadCache() themselves still need
+		// to unbind their slots before their thread_local storage goes away.
+		~ThreadCache() { vsHeap::FlushThreadCache(); }
+	};
+
+	thread_local ThreadCache s_threadCache;
+	vsSpinlock s_boundSlotsLock;
+	ThreadCacheSlot * s_boundSlots = nullptr;
+
+	inline memBlock *& CacheLink( memBlock *block )
+	{
+		return *(memBlock **)((char *)block->m_start + sizeof(memBlock));
+	}
+
+	// Assumes s_boundSlotsLock is already locked
+	void BindSlot( ThreadCacheSlot *slot, vsHeap *heap )
+	{
+		slot->heap.store( heap, std::memory_order_relaxed );
+		slot->prevBound = nullptr;
+		slot->nextBound = s_boundSlots;
+		if ( s_boundSlots )
+			s_boundSlots->prevBound = slot;
+		s_boundSlots = slot;
+	}
+
+	// Assumes s_boundSlotsLock is already locked.  Drops any blocks which are
+	// still in the slot;  the caller must have returned them to their heap
+	// first, if that heap is going to outlive them.
+	void UnbindSlot( ThreadCacheSlot *slot )
+	{
+		if ( slot->prevBound )
+			slot->prevBound->nextBound = slot->nextBound;
+		else
+			s_boundSlots = slot->nextBound;
+		if ( slot->nextBound )
+			slot->nextBound->prevBound = slot->prevBound;
+
+		slot->heap.store( nullptr, std::memory_order_relaxed );
+		slot->prevBound = nullptr;
+		slot->nextBound = nullptr;
+		memset( slot->count, 0, sizeof(slot->count) );
+		memset( slot->bin, 0, sizeof(slot->bin) );
+	}
+
+	ThreadCacheSlot * FindThreadCacheSlot( vsHeap *heap, bool create )
+	{
+		ThreadCacheSlot *empty = nullptr;
+		for ( int i = 0; i < MAX_HEAP_STACK; i++ )
+		{
+			ThreadCacheSlot *slot = &s_threadCache.slot[i];
+			vsHeap *slotHeap = slot->heap.load( std::memory_order_relaxed );
+			if ( slotHeap == heap )
+				return slot;
+			if ( !empty && slotHeap == nullptr )
+				empty = slot;
+		}
+		if ( create && empty )
+		{
+			s_boundSlotsLock.Lock();
+			BindSlot( empty, heap );
+			s_boundSlotsLock.Unlock();
+		}
+		return create ? empty : nullptr;
+	}
+};
+
 vsHeap::vsHeap(vsString name, size_t size):
 	m_name(name)
 {
@@ -53,6 +170,10 @@ vsHeap::vsHeap(vsString name, size_t size):
 
 	m_leakMark = 0;
 
+	m_flBitmap = 0;
+	memset( m_slBitmap, 0, sizeof(m_slBitmap) );
+	memset( m_freeBins, 0, sizeof(m_freeBins) );
+
 	//	for ( int i = 0; i < MAX_ALLOCATIONS; i++ )
 	//	{
 	//		m_unusedBlockList.Append( &m_blockStore[i] );
@@ -64,12 +185,13 @@ vsHeap::vsHeap(vsString name, size_t size):
 	iniBlock->m_size = m_memorySize;
 	iniBlock->m_sizeRequested = m_memorySize;
 	iniBlock->m_used = false;
+	iniBlock->m_cached = false;
 	iniBlock->m_next = nullptr;
 	iniBlock->m_prev = nullptr;
 	iniBlock->m_nextBlock = nullptr;
 	iniBlock->m_prevBlock = nullptr;
 
-	m_unusedBlockList.Append( iniBlock );
+	InsertFreeBlock( iniBlock );
 #endif // VS_INTERNAL_ALLOCATORS
 }
 
@@ -78,6 +200,19 @@ vsHeap::~vsHeap()
 	if ( s_current == this )
 	{
 	}
+
+	// our memory is going away;  make sure that no thread's cache keeps
+	// pointers to us or into our memory.
+	s_boundSlotsLock.Lock();
+	ThreadCacheSlot *slot = s_boundSlots;
+	while ( slot )
+	{
+		ThreadCacheSlot *next = slot->nextBound;
+		if ( slot->heap.load( std::memory_order_relaxed ) == this )
+			UnbindSlot( slot );
+		slot = next;
+	}
+	s_boundSlotsLock.Unlock();
 }
 
 void
@@ -111,25 +246,229 @@ vsHeap::Pop( vsHeap *oldCurrent /* == nullptr */ )
 	s_current = s_stack[0];
 }
 
+void
+vsHeap::FlushThreadCache()
+{
+	// holding s_boundSlotsLock means that none of our slots' heaps can be
+	// destroyed while we're returning blocks to them.
+	s_boundSlotsLock.Lock();
+	for ( int i = 0; i < MAX_HEAP_STACK; i++ )
+	{
+		ThreadCacheSlot *slot = &s_threadCache.slot[i];
+		vsHeap *heap = slot->heap.load( std::memory_order_relaxed );
+		if ( !heap )
+			continue;
+
+		heap->m_lock.Lock();
+		for ( int b = 0; b < HEAP_CACHE_BIN_COUNT; b++ )
+		{
+			memBlock *block = slot->bin[b];
+			while ( block )
+			{
+				memBlock *next = CacheLink(block);
+				heap->FreeBlock(block);
+				block = next;
+			}
+		}
+		heap->m_lock.Unlock();
+
+		UnbindSlot( slot );
+	}
+	s_boundSlotsLock.Unlock();
+}
+
 memBlock *
-vsHeap::FindFreeMemBlockOfSize( size_t size )
+vsHeap::CacheAlloc(size_t size)
 {
-	memBlock *block = m_unusedBlockList.m_next;
-	size_t largestBlockSize = 0;
-	bool foundMemBlockForAlloc = false;
+	ThreadCacheSlot *slot = FindThreadCacheSlot( this, true );
+	if ( !slot )
+		return nullptr;
 
-	while(block)
+	int binId = (int)(size >> HEAP_ALIGN_SIZE_LOG2);
+	if ( !slot->bin[binId] )
 	{
-		if ( block->m_used == false && block->m_size >= size )
+		// refill this bin with a batch of blocks, so we only take the lock once
+		// for the whole batch.
+		m_lock.Lock();
+		for ( int i = 0; i < HEAP_CACHE_BATCH_SIZE; i++ )
 		{
-			return block;
+			memBlock *block = AllocBlock(size);
+			block->m_cached = true;
+			CacheLink(block) = slot->bin[binId];
+			slot->bin[binId] = block;
+			slot->count[binId]++;
 		}
+		m_lock.Unlock();
+	}
 
-		if ( block->m_used == false && block->m_size > largestBlockSize )
-			largestBlockSize = block->m_size;
+	memBlock *block = slot->bin[binId];
+	slot->bin[binId] = CacheLink(block);
+	slot->count[binId]--;
+
+	block->m_cached = false;
+	return block;
+}
+
+void
+vsHeap::CacheFree(memBlock *block)
+{
+	ThreadCacheSlot *slot = FindThreadCacheSlot( this, true );
+	if ( !slot )
+	{
+		m_lock.Lock();
+		FreeBlock(block);
+		m_lock.Unlock();
+		return;
+	}
+
+	int binId = (int)(block->m_size >> HEAP_ALIGN_SIZE_LOG2);
+
+	block->m_cached = true;
+	CacheLink(block) = slot->bin[binId];
+	slot->bin[binId] = block;
+	slot->count[binId]++;
+
+	if ( slot->count[binId] > HEAP_CACHE_BIN_CAPACITY )
+	{
+		// too many blocks parked here;  give a batch of them back to the heap.
+		m_lock.Lock();
+		for ( int i = 0; i < HEAP_CACHE_BATCH_SIZE; i++ )
+		{
+			memBlock *release = slot->bin[binId];
+			slot->bin[binId] = CacheLink(release);
+			slot->count[binId]--;
+			FreeBlock(release);
+		}
+		m_lock.Unlock();
+	}
+}
+
+void
+vsHeap::MapSize( size_t size, int *fl, int *sl )
+{
+	if ( size < HEAP_SMALL_BLOCK_SIZE )
+	{
+		// small blocks all live in first-level bin 0, with one exact-size bin
+		// per 32 bytes.
+		*fl = 0;
+		*sl = (int)(size >> HEAP_ALIGN_SIZE_LOG2);
+	}
+	else
+	{
+		int high = HighestBit(size);
+		*fl = high - HEAP_FL_INDEX_SHIFT + 1;
+		*sl = (int)(size >> (high - HEAP_SL_INDEX_COUNT_LOG2)) ^ HEAP_SL_INDEX_COUNT;
+	}
+}
+
+void
+vsHeap::InsertFreeBlock( memBlock *block )
+{
+	int fl, sl;
+	MapSize( block->m_size, &fl, &sl );
+
+	memBlock *head = m_freeBins[fl][sl];
+	block->m_prev = nullptr;
+	block->m_next = head;
+	if ( head )
+		head->m_prev = block;
+	m_freeBins[fl][sl] = block;
 
+	m_flBitmap |= (uint64_t)1 << fl;
+	m_slBitmap[fl] |= (uint32_t)1 << sl;
+}
+
+void
+vsHeap::RemoveFreeBlock( memBlock *block )
+{
+	int fl, sl;
+	MapSize( block->m_size, &fl, &sl );
+
+	if ( block->m_next )
+		block->m_next->m_prev = block->m_prev;
+	if ( block->m_prev )
+		block->m_prev->m_next = block->m_next;
+	else
+	{
+		vsAssert( m_freeBins[fl][sl] == block, "Free block wasn't in the bin we expected!" );
+		m_freeBins[fl][sl] = block->m_next;
+		if ( m_freeBins[fl][sl] == nullptr )
+		{
+			m_slBitmap[fl] &= ~((uint32_t)1 << sl);
+			if ( m_slBitmap[fl] == 0 )
+				m_flBitmap &= ~((uint64_t)1 << fl);
+		}
+	}
+
+	block->m_next = block->m_prev = nullptr;
+}
+
+size_t
+vsHeap::GetLargestFreeBlockSize()
+{
+	if ( m_flBitmap == 0 )
+		return 0;
+
+	// the largest free block must be somewhere in our highest non-empty bin.
+	int fl = HighestBit(m_flBitmap);
+	int sl = HighestBit(m_slBitmap[fl]);
+
+	size_t largestBlockSize = 0;
+	memBlock *block = m_freeBins[fl][sl];
+	while ( block )
+	{
+		if ( block->m_size > largestBlockSize )
+			largestBlockSize = block->m_size;
 		block = block->m_next;
 	}
+	return largestBlockSize;
+}
+
+size_t
+vsHeap::GetLargestFreeBlock()
+{
+	m_lock.Lock();
+	size_t result = GetLargestFreeBlockSize();
+	m_lock.Unlock();
+	return result;
+}
+
+memBlock *
+vsHeap::FindFreeMemBlockOfSize( size_t size )
+{
+	// Round our search size up to the start of the next bin, so that any block
+	// we find in the bin we search is guaranteed to be large enough.  (Small
+	// bins are exact sizes, so don't need this)
+	size_t searchSize = size;
+	if ( searchSize >= HEAP_SMALL_BLOCK_SIZE )
+		searchSize += ((size_t)1 << (HighestBit(searchSize) - HEAP_SL_INDEX_COUNT_LOG2)) - 1;
+
+	int fl, sl;
+	MapSize( searchSize, &fl, &sl );
+
+	if ( fl < HEAP_FL_INDEX_COUNT )
+	{
+		uint32_t slMap = m_slBitmap[fl] & (~(uint32_t)0 << sl);
+		if ( !slMap )
+		{
+			// nothing big enough in this first-level bin;  move up to the
+			// next non-empty one, and take its smallest bin.
+			uint64_t flMap = (fl+1 < 64) ? (m_flBitmap & (~(uint64_t)0 << (fl+1))) : 0;
+			if ( flMap )
+			{
+				fl = LowestBit(flMap);
+				slMap = m_slBitmap[fl];
+			}
+		}
+		if ( slMap )
+		{
+			sl = LowestBit(slMap);
+			return m_freeBins[fl][sl];
+		}
+	}
+
+	bool foundMemBlockForAlloc = false;
+	size_t largestBlockSize = GetLargestFreeBlockSize();
 
 #ifdef _WIN32
 	vsLog("Unable to find block of size %lu in heap of size %lu.  Largest block available is %lu.", size, m_memorySize, largestBlockSize);
@@ -140,16 +479,11 @@ vsHeap::FindFreeMemBlockOfSize( size_t size )
 	return nullptr;
 }
 
-void *
-vsHeap::Alloc(size_t size_requested, const char *file, int line, int allocType)
+memBlock *
+vsHeap::AllocBlock(size_t size)
 {
-	m_lock.Lock();
-
-	size_t size = size_requested;
-	size += sizeof( memBlock ) + sizeof( unsigned long );		// we need to allocate enough space for our new 'memBlock' header, and some bytes on the end.
-	size = (size+31) & 0xffffffe0;								// round 'size' up to the nearest 32 bytes, to force alignment.
-
 	memBlock *block = FindFreeMemBlockOfSize(size);
+	RemoveFreeBlock(block);
 
 	void * end = (void *)((char *)block->m_start + size);
 
@@ -162,18 +496,33 @@ vsHeap::Alloc(size_t size_requested, const char *file, int line, int allocType)
 		split->m_end = block->m_end;
 		split->m_size = block->m_size - size;
 		split->m_used = false;
+		split->m_cached = false;
 
 		block->AppendBlock(split);
 
 		block->m_end = end;
 		block->m_size = size;
 
-		m_unusedBlockList.Append(split);
-		//block->Append(split);
+		InsertFreeBlock(split);
 	}
-	block->Extract();
 	m_blockList.Append(block);
 
+	block->m_used = true;
+	block->m_cached = false;
+
+	m_memoryUsed += block->m_size;
+	if ( m_memoryUsed > m_highWaterMark )
+	{
+		m_highWaterMark = m_memoryUsed;
+		/*if ( m_highWaterMark > 1024 * 1024 )
+		  TraceMemoryBlocks();*/
+	}
+	return block;
+}
+
+void *
+vsHeap::PrepareBlock(memBlock *block, size_t size_requested, const char *file, int line, int allocType)
+{
 	if ( file )
 	{
 		strncpy( block->m_filename, file, 127 );
@@ -183,17 +532,8 @@ vsHeap::Alloc(size_t size_requested, const char *file, int line, int allocType)
 	block->m_allocType = allocType;
 	block->m_sizeRequested = size_requested;
 
-	block->m_used = true;
 	void *result = (void *)((char *)block->m_start + sizeof(memBlock));
 
-	m_memoryUsed += block->m_size;
-	if ( m_memoryUsed > m_highWaterMark )
-	{
-		m_highWaterMark = m_memoryUsed;
-		/*if ( m_highWaterMark > 1024 * 1024 )
-		  TraceMemoryBlocks();*/
-	}
-
 	if ( allocType != Type_Heap )
 	{
 		// overwrite everything in the user area, to make it really obvious what
@@ -211,96 +551,115 @@ vsHeap::Alloc(size_t size_requested, const char *file, int line, int allocType)
 	unsigned long *safetyLong = (unsigned long *)safety;
 	*safetyLong = 0xeeeeeeee;
 
-	m_lock.Unlock();
-
 	return result;
 }
 
+void *
+vsHeap::Alloc(size_t size_requested, const char *file, int line, int allocType)
+{
+	size_t size = size_requested;
+	size += sizeof( memBlock ) + sizeof( unsigned long );		// we need to allocate enough space for our new 'memBlock' header, and some bytes on the end.
+	size = (size+31) & ~(size_t)31;								// round 'size' up to the nearest 32 bytes, to force alignment.
+
+	memBlock *block = nullptr;
+	if ( allocType != Type_Heap && size <= HEAP_CACHE_MAX_BLOCK_SIZE )
+		block = CacheAlloc(size);
+
+	if ( !block )
+	{
+		m_lock.Lock();
+		block = AllocBlock(size);
+		m_lock.Unlock();
+	}
+
+	return PrepareBlock(block, size_requested, file, line, allocType);
+}
+
 void
-vsHeap::Free(void *p, int allocType)
+vsHeap::FreeBlock(memBlock *block)
 {
-	m_lock.Lock();
+	block->m_used = false;
+	block->m_cached = false;
+	m_memoryUsed -= block->m_size;
+	block->Extract();	// remove from our list of used blocks
 
-	p = (void *)((char *)p - sizeof(memBlock));	// adjust pointer to point to the start of its memBlock header
+	memBlock *nextBlock = block->m_nextBlock;
+	memBlock *prevBlock = block->m_prevBlock;
 
-	memBlock *block = (memBlock *)p;
-	//memBlock *block = m_blockList.m_next;
-	//bool foundBlockToFree = false;
+	// check if we can merge together with the prev or the next block.
+	if ( nextBlock && !nextBlock->m_used )
+	{
+		// next block isn't being used;  let's merge it into us!
+		RemoveFreeBlock(nextBlock);
+
+		block->m_end = nextBlock->m_end;
+		block->m_size += nextBlock->m_size;
 
-	//while ( block )
-	//{
-	//	if ( block->m_start == p )
+		nextBlock->ExtractBlock();
+	}
+	if ( prevBlock && !prevBlock->m_used )
 	{
-		// make sure the user hasn't overwritten our code past the end of their memory block.
-		void * safety = (void *)((char *)block->m_end - sizeof(unsigned long));
-		unsigned long *safetyLong = (unsigned long *)safety;
-		vsAssert( *safetyLong == 0xeeeeeeee, "Buffer overflow detected!" );	// if we hit this assert, someone has overwritten the bounds of this memory buffer!
+		// previous block isn't being used;  let's merge ourself into it!
+		// Its size is changing, so it needs to move to a different bin.
+		RemoveFreeBlock(prevBlock);
 
-		if( block->m_allocType != allocType )
-		{
-			const char *allocFunction[] =
-			{
-				"vsHeap constructor",
-				"Static alloc",
-				"malloc",
-				"new",
-				"new []"
-			};
-			const char *freeFunction[] =
-			{
-				"vsHeap destructor",
-				"None",
-				"free",
-				"delete",
-				"delete []"
-			};
-			vsLog("Error:  Allocation from %s line %d was allocated using %s", block->m_filename, block->m_line, allocFunction[(int)block->m_allocType]);
-			vsLog("Error:   but was freed using %s;  should have been %s!", freeFunction[allocType], freeFunction[(int)block->m_allocType]);
-		}
+		prevBlock->m_end = block->m_end;
+		prevBlock->m_size += block->m_size;
+		block->ExtractBlock();
+
+		block = prevBlock;
+	}
 
-		// check if we can merge together with the prev or the next block.
-		void *	userArea = (void *)((char *)block->m_start + sizeof(memBlock));
-		size_t	userSize = block->m_size - sizeof(memBlock);
-		memset(userArea, 0xdddddddd, userSize );
-		block->m_used = false;
-		m_memoryUsed -= block->m_size;
+	InsertFreeBlock(block);
+}
 
-		memBlock *nextBlock = block->m_nextBlock;
-		memBlock *prevBlock = block->m_prevBlock;
+void
+vsHeap::Free(void *p, int allocType)
+{
+	p = (void *)((char *)p - sizeof(memBlock));	// adjust pointer to point to the start of its memBlock header
 
-		if ( nextBlock && !nextBlock->m_used )
-		{
-			//memBlock *nextBlock = block->m_next;
+	memBlock *block = (memBlock *)p;
 
-			// next block isn't being used;  let's merge it into us!
-			block->m_end = nextBlock->m_end;
-			block->m_size += nextBlock->m_size;
+	// make sure the user hasn't overwritten our code past the end of their memory block.
+	void * safety = (void *)((char *)block->m_end - sizeof(unsigned long));
+	unsigned long *safetyLong = (unsigned long *)safety;
+	vsAssert( *safetyLong == 0xeeeeeeee, "Buffer overflow detected!" );	// if we hit this assert, someone has overwritten the bounds of this memory buffer!
+	vsAssert( !block->m_cached, "Block freed twice!" );
 
-			nextBlock->ExtractBlock();
-			nextBlock->Extract();
-		}
-		if ( prevBlock && prevBlock != &m_unusedBlockList && !prevBlock->m_used )
+	if( block->m_allocType != allocType )
+	{
+		const char *allocFunction[] =
 		{
-			// previous block isn't being used;  let's merge ourself into it!
-			prevBlock->m_end = block->m_end;
-			prevBlock->m_size += block->m_size;
-			block->ExtractBlock();
-			block->Extract();
-			m_lock.Unlock();
-			return;
-		}
+			"vsHeap constructor",
+			"Static alloc",
+			"malloc",
+			"new",
+			"new []"
+		};
+		const char *freeFunction[] =
+		{
+			"vsHeap destructor",
+			"None",
+			"free",
+			"delete",
+			"delete []"
+		};
+		vsLog("Error:  Allocation from %s line %d was allocated using %s", block->m_filename, block->m_line, allocFunction[(int)block->m_allocType]);
+		vsLog("Error:   but was freed using %s;  should have been %s!", freeFunction[allocType], freeFunction[(int)block->m_allocType]);
+	}
 
-		block->Extract();
-		m_unusedBlockList.Append(block);
-		//foundBlockToFree = true;
-		m_lock.Unlock();
+	void *	userArea = (void *)((char *)block->m_start + sizeof(memBlock));
+	size_t	userSize = block->m_size - sizeof(memBlock);
+	memset(userArea, 0xdddddddd, userSize );
+
+	if ( block->m_allocType != Type_Heap && block->m_size <= HEAP_CACHE_MAX_BLOCK_SIZE )
+	{
+		CacheFree(block);
 		return;
 	}
-	//	block = block->m_next;
-	//}
-
-	//vsAssert(foundBlockToFree, "Tried to free a block we didn't allocate!");	// tried to free a block we didn't know about!
 
+	m_lock.Lock();
+	FreeBlock(block);
 	m_lock.Unlock();
 }
 
@@ -311,17 +670,10 @@ vsHeap::PrintStatus()
 	vsLog(" >> MEMORY STATUS");
 
 	size_t bytesFree = m_memorySize - m_memoryUsed;
-	size_t largestBlock = 0;
-
-	memBlock *block = m_unusedBlockList.m_next;
 
-	while ( block )
-	{
-		if ( !block->m_used && block->m_size > largestBlock )
-			largestBlock = block->m_size;
-
-		block = block->m_next;
-	}
+	m_lock.Lock();
+	size_t largestBlock = GetLargestFreeBlockSize();
+	m_lock.Unlock();
 
 #ifdef _WIN32
 	vsLog(" >> Heap current usage %lu / %lu (%0.2f%% usage)", m_memoryUsed, m_memorySize, 100.0f*m_memoryUsed/m_memorySize);
@@ -345,7 +697,7 @@ vsHeap::CheckForLeaks()
 
 	while ( block )
 	{
-		if ( block->m_used && block->m_blockId > m_leakMark )
+		if ( block->m_used && !block->m_cached && block->m_blockId > m_leakMark )
 		{
 			if ( !foundLeak )
 			{
@@ -368,7 +720,7 @@ vsHeap::TraceMemoryBlocks()
 
 	while ( block )
 	{
-		if ( block->m_used )
+		if ( block->m_used && !block->m_cached )
 		{
 #ifdef _WIN32
 			vsLog("[%d] %s:%d : %lu bytes", block->m_blockId, block->m_filename, block->m_line, block->m_sizeRequested);
@@ -401,6 +753,7 @@ memBlock::memBlock():
 	m_end(0),
 	m_size(0),
 	m_used(false),
+	m_cached(false),
 	m_next(nullptr),
 	m_prev(nullptr)
 {
@@ -455,6 +808,7 @@ void * MyMalloc(size_t size, const char *fileName, int lineNumber, int allocType
 {
 	void * result;
 
+	vsHeap::CountAllocation();
 	if ( vsHeap::GetCurrent() )
 	{
 		result = vsHeap::GetCurrent()->Alloc(size, fileName, lineNumber, allocType);
@@ -549,6 +903,7 @@ void operator delete[](void* p, std::nothrow_t const&) throw()
 #ifdef VS_WRAP_ALLOCATORS
 void* operator new(std::size_t n)
 {
+	vsHeap::CountAllocation();
 	void* result( malloc(n) );
 	if ( result == nullptr )
 	{
@@ -567,6 +922,7 @@ void* operator new(std::size_t n)
 // Array regular new
 void* operator new[](std::size_t n)
 {
+	vsHeap::CountAllocation();
 	void* result( malloc(n) );
 	if ( result == nullptr )
 	{
@@ -11,6 +11,7 @@
 #define MEM_HEAP_H
 
 #include "VS/Threads/VS_Spinlock.h"
+#include <atomic>
 
 
 class memBlock
@@ -29,6 +30,7 @@ public:
 	char		m_allocType;
 
 	bool		m_used;
+	bool		m_cached;	// freed by the user, but parked in a thread's cache
 
 	memBlock *	m_next;
 	memBlock *	m_prev;
@@ -54,6 +56,33 @@ enum
 	Type_NewArray
 };
 
+// Free blocks are kept in segregated free lists, indexed by a two-level
+// bitmap (in the style of TLSF).  The first level splits sizes into powers of
+// two, and the second level splits each power of two into a fixed number of
+// linear subdivisions.  Every block in a bin is at least as large as the bin's
+// minimum size, so finding a block which fits any request is a couple of
+// bitscans, no matter how fragmented the heap is.
+//
+// Block sizes are always multiples of 32 bytes, so every size below
+// HEAP_SMALL_BLOCK_SIZE gets its own exact-size bin in first-level bin 0.
+#define HEAP_SL_INDEX_COUNT_LOG2 (5)
+#define HEAP_SL_INDEX_COUNT (1 << HEAP_SL_INDEX_COUNT_LOG2)
+#define HEAP_ALIGN_SIZE_LOG2 (5)
+#define HEAP_FL_INDEX_SHIFT (HEAP_SL_INDEX_COUNT_LOG2 + HEAP_ALIGN_SIZE_LOG2)
+#define HEAP_SMALL_BLOCK_SIZE (1 << HEAP_FL_INDEX_SHIFT)
+#define HEAP_FL_INDEX_COUNT (64 - HEAP_FL_INDEX_SHIFT + 1)
+
+// Small blocks are freed into a per-thread cache instead of straight back into
+// the heap, and are handed back out from there without taking the heap's lock.
+// Caches are refilled from and flushed back to the heap in batches, so the lock
+// is only taken once per HEAP_CACHE_BATCH_SIZE allocations or frees.  Cached
+// blocks are still marked as 'used' inside the heap, but are flagged so that
+// they aren't reported as leaks.
+#define HEAP_CACHE_MAX_BLOCK_SIZE (512)
+#define HEAP_CACHE_BIN_COUNT ((HEAP_CACHE_MAX_BLOCK_SIZE >> HEAP_ALIGN_SIZE_LOG2) + 1)
+#define HEAP_CACHE_BIN_CAPACITY (32)
+#define HEAP_CACHE_BATCH_SIZE (16)
+
 class vsHeap
 {
 #define MAX_ALLOCATIONS (4096)
@@ -65,17 +94,32 @@ class vsHeap
 
 	size_t	m_memoryUsed;
 	size_t	m_highWaterMark;
-	size_t	m_totalAllocations;
+	std::atomic<size_t>	m_totalAllocations;
 
 	int		m_leakMark;
 
 	memBlock	m_blockList;
-	memBlock	m_unusedBlockList;
 //	memBlock	m_blockStore[MAX_ALLOCATIONS];
 
+	uint64_t	m_flBitmap;
+	uint32_t	m_slBitmap[HEAP_FL_INDEX_COUNT];
+	memBlock *	m_freeBins[HEAP_FL_INDEX_COUNT][HEAP_SL_INDEX_COUNT];
+
 	static vsHeap * s_current;
+	static std::atomic<uint64_t> s_allocationCount;
+
+	static void	MapSize( size_t size, int *fl, int *sl );
+	void		InsertFreeBlock( memBlock *block );
+	void		RemoveFreeBlock( memBlock *block );
+	size_t		GetLargestFreeBlockSize();
 
 	memBlock *	FindFreeMemBlockOfSize(size_t size);
+	memBlock *	AllocBlock(size_t size);		// Assumes m_lock is already locked
+	void		FreeBlock(memBlock *block);		// Assumes m_lock is already locked
+	void *		PrepareBlock(memBlock *block, size_t sizeRequested, const char *fileName, int line, int allocType);
+
+	memBlock *	CacheAlloc(size_t size);
+	void		CacheFree(memBlock *block);
 //	memBlock *	GetUnusedMemBlock();
 	vsSpinlock m_lock;
 
@@ -93,12 +137,28 @@ public:
 	static void	Push( vsHeap *newCurrent );	// push a new allocator context
 	static void	Pop( vsHeap *oldCurrent = nullptr );							// pop it off.
 
+	// Return all blocks in the calling thread's cache to their heaps.  vsThread
+	// calls this when its thread exits, and any other thread's cache is flushed
+	// when its thread_local storage is destroyed.
+	static void	FlushThreadCache();
+
+	// Running total of allocations made through our operator new/malloc
+	// wrappers, across all heaps and threads.  Only counts anything when
+	// VS_INTERNAL_ALLOCATORS or VS_WRAP_ALLOCATORS is enabled.
+	static uint64_t	GetAllocationCount() { return s_allocationCount.load(std::memory_order_relaxed); }
+	static void		CountAllocation() { s_allocationCount.fetch_add(1, std::memory_order_relaxed); }
+
+	// Bytes not allocated from this heap, and the largest block among them.
+	// Blocks sitting in a thread's cache count as allocated.
+	size_t	GetFreeBytes() const { return m_memorySize - m_memoryUsed; }
+	size_t	GetLargestFreeBlock();
+
 	void	PrintStatus();
 	void	PrintBlockList();
 	void	CheckForLeaks();
 	void	TraceMemoryBlocks();
 
-	void	SetMarkForLeakTesting() { m_leakMark = (int)m_totalAllocations; }
+	void	SetMarkForLeakTesting() { m_leakMark = (int)m_totalAllocations.load(); }
 };
 
 
@@ -11,6 +11,7 @@
 
 #include "VS_Angle.h"
 #include "VS_Box.h"
+#include "VS_Codec.h"
 #include "VS_Color.h"
 #include "VS_Fog.h"
 #include "VS_Light.h"
@@ -27,6 +28,20 @@
 
 #include <zlib.h>
 
+namespace
+{
+	// Compress() writes zlib data as a bare zlib stream, the way it always has.
+	// Other codecs get a header:  'V', 'S', the codec's tag, 'C', and then the
+	// uncompressed length as a uint32.  No zlib stream can start with 'V', so
+	// Expand() can tell which is which.
+	const size_t c_codecHeaderSize = 8;
+
+	bool HasCodecHeader( const char *data, size_t length )
+	{
+		return length >= c_codecHeaderSize && data[0] == 'V' && data[1] == 'S' && data[3] == 'C';
+	}
+};
+
 vsStore::vsStore():
 	m_buffer( nullptr ),
 	m_bufferLength( 0 ),
@@ -49,7 +64,7 @@ vsStore::vsStore( size_t maxSize ):
 {
 }
 
-vsStore::vsStore( char *buffer, int bufferLength ):
+vsStore::vsStore( char *buffer, size_t bufferLength ):
 	m_buffer( buffer ),
 	m_bufferLength( bufferLength ),
 	m_bufferEnd( &m_buffer[m_bufferLength] ),
@@ -262,6 +277,16 @@ vsStore::WriteBuffer( const void *buffer, size_t bufferLength )
 	m_writeHead += bufferLength;
 }
 
+char *
+vsStore::WriteSpace( size_t bytes )
+{
+	_EnsureBytesLeftForWriting( bytes );
+
+	char *result = m_writeHead;
+	m_writeHead += bytes;
+	return result;
+}
+
 size_t
 vsStore::ReadBuffer( void *buffer, size_t bufferLength )
 {
@@ -695,11 +720,37 @@ vsStore::ReadBox2D(vsBox2D *box)
 }
 
 bool
-vsStore::Compress()
+vsStore::Compress( const vsCodec *codec )
 {
 	Rewind();
 
-	vsStore zipStore(m_bufferLength + 1024); // a *little* extra space buffer for in case we don't get much compression
+	if ( !codec )
+		codec = vsCodec::GetDefault();
+
+	if ( codec != vsCodec::Get( vsCodec::Type_Zlib ) )
+	{
+		size_t length = BytesLeftForReading();
+		vsAssert( length <= UINT32_MAX, "vsStore::Compress: too much data for a codec header" );
+
+		vsStore packed( c_codecHeaderSize + codec->GetMaxCompressedLength( length ) );
+		const char header[4] = { 'V', 'S', codec->GetTag(), 'C' };
+		packed.WriteBuffer( header, sizeof(header) );
+		packed.WriteUint32( (uint32_t)length );
+
+		size_t packedLength = codec->Compress( GetReadHead(), length, packed.GetWriteHead(), packed.BytesLeftForWriting() );
+		if ( packedLength == 0 )
+		{
+			vsLog("vsStore::Compress: %s compression failed", codec->GetName());
+			return false;
+		}
+		packed.AdvanceWriteHead( packedLength );
+
+		if ( packed.Length() > m_bufferLength )
+			_ReplaceBuffer( packed.Length() );
+		Clear();
+		Append(&packed);
+		return true;
+	}
 
 	z_stream zipstream;
 	zipstream.zalloc = Z_NULL;
@@ -712,21 +763,28 @@ vsStore::Compress()
 		vsLog("vsStore::Compress: deflateInit error: %d", ret);
 		return false;
 	}
+
+	// Data which doesn't compress comes out a little bigger than it went in,
+	// so leave room for zlib's worst case.
+	vsStore zipStore( deflateBound( &zipstream, BytesLeftForReading() ) );
+
 	zipstream.avail_in = BytesLeftForReading();
 	zipstream.next_in = (Bytef*)GetReadHead();
-	zipstream.avail_out = m_bufferLength;
+	zipstream.avail_out = zipStore.BufferLength();
 	zipstream.next_out = (Bytef*)zipStore.GetWriteHead();
 
 	ret = deflate(&zipstream, Z_FINISH);
 	vsAssert(ret == Z_STREAM_END, "vsStore::Compress: Failed to fit compressed stream into available space");
 
-	int compressedBytes = m_bufferLength - zipstream.avail_out;
+	size_t compressedBytes = zipStore.BufferLength() - zipstream.avail_out;
 	zipStore.AdvanceWriteHead(compressedBytes);
 	// if ( compressedBytes > 0 )
 	// 	_WriteFinalBytes_Buffered(zipBuffer, compressedBytes);
 
 	deflateEnd(&zipstream);
 
+	if ( zipStore.Length() > m_bufferLength )
+		_ReplaceBuffer( zipStore.Length() );
 	Clear();
 	Append(&zipStore);
 
@@ -736,6 +794,36 @@ vsStore::Compress()
 bool
 vsStore::Expand()
 {
+	if ( HasCodecHeader( GetReadHead(), BytesLeftForReading() ) )
+	{
+		const vsCodec *codec = vsCodec::FindByTag( GetReadHead()[2] );
+		if ( !codec )
+		{
+			vsLog("Failed to expand data;  unknown codec '%c'", GetReadHead()[2]);
+			return false;
+		}
+		AdvanceReadHead( 4 );
+		uint32_t length = ReadUint32();
+
+		// decompress straight into our new buffer, then swap it in.
+		vsAssert( !m_bufferIsExternal, "Replacing an external vsStore buffer isn't supported" );
+		char *expanded = new char[length];
+		if ( !codec->Decompress( GetReadHead(), BytesLeftForReading(), expanded, length ) )
+		{
+			vsLog("Failed to expand data;  %s data is corrupt", codec->GetName());
+			vsDeleteArray( expanded );
+			return false;
+		}
+
+		vsDeleteArray( m_buffer );
+		m_buffer = expanded;
+		m_bufferLength = length;
+		m_bufferEnd = &m_buffer[m_bufferLength];
+		m_readHead = m_buffer;
+		m_writeHead = m_bufferEnd;
+		return true;
+	}
+
 	// We're going to need to inflate this date twice;  once to see how big it
 	// turns out to be, and once to actually read it.
 	z_stream zipstream;
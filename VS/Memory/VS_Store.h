@@ -11,6 +11,7 @@
 #define MEM_STORE_H
 
 class vsBox2D;
+class vsCodec;
 class vsColor;
 class vsColorPacked;
 class vsFog;
@@ -47,7 +48,7 @@ class vsStore
 public:
 			vsStore();
 			vsStore( size_t maxSize );
-			vsStore( char *buffer, int bufferLength );
+			vsStore( char *buffer, size_t bufferLength );	// a view of someone else's buffer;  we won't free it
 			vsStore( const vsStore& store ); // make a copy of the other store
 	virtual ~vsStore();
 
@@ -90,6 +91,7 @@ public:
 
 	void	WriteString( const vsString &value );
 	void	WriteBuffer( const void *buffer, size_t bufferLength );
+	char *	WriteSpace( size_t bytes );	// skip the write head over 'bytes' uninitialised bytes, and return them for the caller to fill in
 
 	const char*   GetBuffer() const { return m_buffer; }
 
@@ -147,8 +149,8 @@ public:
 	void		WriteBox2D(const vsBox2D &box);
 	void		ReadBox2D(vsBox2D *box);
 
-	bool		Compress(); // gzip the store, reset read head to start.  Returns true on success.
-	bool		Expand(); // ungzip the store, reset read head to start and write head to end.  Returns true on success.
+	bool		Compress( const vsCodec *codec = nullptr ); // compress the store with 'codec' (or vsCodec::GetDefault()), reset read head to start.  Returns true on success.
+	bool		Expand(); // decompress the store (whichever codec it was compressed with), reset read head to start and write head to end.  Returns true on success.
 };
 
 #endif // MEM_FIFO_H
@@ -0,0 +1,417 @@
+/*
+ *  VS_JobSystem.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_JobSystem.h"
+#include "VS_Thread.h"
+#include "VS_System.h"
+#include "VS_Heap.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <thread>
+#include "VS/VS_EnableDebugNew.h"
+
+#include "VS_Profile.h"
+
+vsJobSystem * vsJobSystem::s_instance = nullptr;
+
+extern vsHeap *g_globalHeap;
+
+namespace
+{
+	thread_local int s_dequeIndex = 0;
+};
+
+struct vsJob
+{
+	void (*function)(void*);
+	void (*rangeFunction)(void*, int, int);
+	void *			data;
+	int				start;
+	int				end;
+	vsJobCounter *	counter;
+	vsJob *			next;	// in the free list, or a counter's waiting list
+};
+
+// A spinlocked ring of jobs.  The owning thread pushes and pops at the bottom;
+// thieves take from the top, so they get the oldest (and usually biggest)
+// work.  'top' and 'bottom' only ever count upwards.
+struct vsJobSystem::Deque
+{
+	vsSpinlock	lock;
+	vsJob *		job[c_dequeCapacity];
+	int			top;
+	int			bottom;
+
+	Deque():
+		top(0),
+		bottom(0)
+	{
+	}
+
+	bool Push( vsJob *j )
+	{
+		lock.Lock();
+		bool room = (bottom - top) < c_dequeCapacity;
+		if ( room )
+			job[ (bottom++) & (c_dequeCapacity-1) ] = j;
+		lock.Unlock();
+		return room;
+	}
+
+	vsJob * Pop()
+	{
+		vsJob *result = nullptr;
+		lock.Lock();
+		if ( bottom > top )
+			result = job[ (--bottom) & (c_dequeCapacity-1) ];
+		lock.Unlock();
+		return result;
+	}
+
+	vsJob * Steal( bool patient )
+	{
+		vsJob *result = nullptr;
+		// If we're not being patient and somebody else is in here, we'll
+		// go and look somewhere else.
+		if ( patient )
+			lock.Lock();
+		if ( patient || lock.TryLock() )
+		{
+			if ( bottom > top )
+				result = job[ (top++) & (c_dequeCapacity-1) ];
+			lock.Unlock();
+		}
+		return result;
+	}
+};
+
+class vsJobSystem::Worker : public vsThread
+{
+	vsJobSystem *	m_parent;
+	int				m_dequeIndex;
+
+protected:
+	virtual int Run()
+	{
+		m_parent->WorkerLoop( m_dequeIndex );
+		return 0;
+	}
+
+public:
+	Worker( vsJobSystem *parent, int dequeIndex ):
+		vsThread( vsFormatString("Job%d", dequeIndex) ),
+		m_parent(parent),
+		m_dequeIndex(dequeIndex)
+	{
+	}
+
+	virtual ~Worker()
+	{
+		Wait();
+	}
+};
+
+vsJobCounter::vsJobCounter():
+	m_pending(0),
+	m_waiting(nullptr)
+{
+}
+
+vsJobCounter::~vsJobCounter()
+{
+	vsAssert( m_pending == 0 && m_waiting == nullptr, "vsJobCounter destroyed with jobs still pending??" );
+}
+
+vsJobSystem::vsJobSystem( int workerCount ):
+	m_worker(nullptr),
+	m_workerCount(0),
+	m_deque(nullptr),
+	m_dequeCount(0),
+	m_job(nullptr),
+	m_freeJobs(nullptr),
+	m_wake(nullptr),
+	m_sleeping(0)
+{
+	vsAssert( s_instance == nullptr, "Multiple vsJobSystems created??" );
+
+	m_job = new vsJob[c_maxJobs];
+	for ( int i = 0; i < c_maxJobs; i++ )
+		m_job[i].next = (i+1 < c_maxJobs) ? &m_job[i+1] : nullptr;
+	m_freeJobs = &m_job[0];
+
+	s_instance = this;
+
+	StartWorkers( workerCount );
+}
+
+vsJobSystem::~vsJobSystem()
+{
+	StopWorkers();
+	vsDeleteArray( m_job );
+
+	vsAssert( s_instance == this, "vsJobSystem instance isn't me??" );
+	s_instance = nullptr;
+}
+
+void
+vsJobSystem::StartWorkers( int workerCount )
+{
+	if ( workerCount < 0 )
+		workerCount = vsSystem::Instance()->GetNumberOfCores() - 1;
+	m_workerCount = vsClamp( workerCount, 0, c_maxWorkers );
+
+	m_wake = new vsSemaphore(0);
+	m_dequeCount = m_workerCount + 1;
+	m_deque = new Deque[m_dequeCount];
+
+	if ( m_workerCount > 0 )
+	{
+		m_worker = new Worker*[m_workerCount];
+		for ( int i = 0; i < m_workerCount; i++ )
+		{
+			m_worker[i] = new Worker( this, i+1 );
+			m_worker[i]->Start();
+		}
+	}
+}
+
+void
+vsJobSystem::StopWorkers()
+{
+	m_wake->Release();
+	for ( int i = 0; i < m_workerCount; i++ )
+		vsDelete( m_worker[i] );	// waits for the thread to exit
+	vsDeleteArray( m_worker );
+	vsDeleteArray( m_deque );
+	vsDelete( m_wake );
+	m_workerCount = 0;
+	m_dequeCount = 0;
+}
+
+void
+vsJobSystem::SetWorkerCount( int workerCount )
+{
+	vsAssert( s_dequeIndex == 0, "Changing the job system's worker count from inside a job??" );
+	for ( int i = 0; i < m_dequeCount; i++ )
+		vsAssert( m_deque[i].bottom == m_deque[i].top, "Changing the job system's worker count with jobs still queued??" );
+
+	StopWorkers();
+
+	// We were created along with the engine, and our workers have to last as
+	// long as we do, whichever game happens to be running right now.
+	vsHeap::Push(g_globalHeap);
+	StartWorkers( workerCount );
+	vsHeap::Pop(g_globalHeap);
+}
+
+int
+vsJobSystem::GetCurrentWorkerIndex()
+{
+	return s_dequeIndex;
+}
+
+vsJob *
+vsJobSystem::AllocJob()
+{
+	m_freeLock.Lock();
+	vsJob *job = m_freeJobs;
+	if ( job )
+		m_freeJobs = job->next;
+	m_freeLock.Unlock();
+	return job;
+}
+
+void
+vsJobSystem::FreeJob( vsJob *job )
+{
+	m_freeLock.Lock();
+	job->next = m_freeJobs;
+	m_freeJobs = job;
+	m_freeLock.Unlock();
+}
+
+void
+vsJobSystem::Run( void (*function)(void*), void *data, vsJobCounter *counter, vsJobCounter *dependency )
+{
+	vsJob *job = AllocJob();
+	if ( !job )
+	{
+		// Out of job slots;  just do it now.
+		if ( dependency )
+			Wait( dependency );
+		function( data );
+		return;
+	}
+
+	job->function = function;
+	job->rangeFunction = nullptr;
+	job->data = data;
+	job->start = job->end = 0;
+	job->counter = counter;
+	if ( counter )
+		counter->m_pending.fetch_add( 1, std::memory_order_relaxed );
+
+	Submit( job, dependency );
+}
+
+void
+vsJobSystem::RunRange( void (*function)(void*, int, int), void *data, int start, int end, vsJobCounter *counter, vsJobCounter *dependency )
+{
+	vsJob *job = AllocJob();
+	if ( !job )
+	{
+		if ( dependency )
+			Wait( dependency );
+		function( data, start, end );
+		return;
+	}
+
+	job->function = nullptr;
+	job->rangeFunction = function;
+	job->data = data;
+	job->start = start;
+	job->end = end;
+	job->counter = counter;
+	if ( counter )
+		counter->m_pending.fetch_add( 1, std::memory_order_relaxed );
+
+	Submit( job, dependency );
+}
+
+void
+vsJobSystem::Submit( vsJob *job, vsJobCounter *dependency )
+{
+	if ( dependency )
+	{
+		dependency->m_lock.Lock();
+		if ( !dependency->IsDone() )
+		{
+			// Complete() will push us once the dependency is done.
+			job->next = dependency->m_waiting;
+			dependency->m_waiting = job;
+			dependency->m_lock.Unlock();
+			return;
+		}
+		dependency->m_lock.Unlock();
+	}
+	Push( job );
+}
+
+void
+vsJobSystem::Push( vsJob *job )
+{
+	if ( !m_deque[ s_dequeIndex ].Push( job ) )
+	{
+		// Our deque is full;  rather than wait for room, just do it now.
+		Execute( job );
+		return;
+	}
+
+	// Wake somebody up to take it, if anybody's asleep.  The fence pairs with
+	// the one in WorkerLoop();  either they see our job before they sleep, or
+	// we see that they're sleeping.
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	if ( m_sleeping.load( std::memory_order_relaxed ) > 0 )
+		m_wake->Post();
+}
+
+vsJob *
+vsJobSystem::FindJob( int dequeIndex, bool patient )
+{
+	vsJob *job = m_deque[dequeIndex].Pop();
+	for ( int i = 1; !job && i < m_dequeCount; i++ )
+		job = m_deque[ (dequeIndex + i) % m_dequeCount ].Steal( patient );
+	return job;
+}
+
+void
+vsJobSystem::Execute( vsJob *job )
+{
+	vsJob j = *job;
+	FreeJob( job );
+
+	if ( j.rangeFunction )
+		j.rangeFunction( j.data, j.start, j.end );
+	else
+		j.function( j.data );
+
+	if ( j.counter )
+		Complete( j.counter );
+}
+
+void
+vsJobSystem::Complete( vsJobCounter *counter )
+{
+	// We take the lock even if nobody's waiting on this counter, so that Wait()
+	// can use it to make sure we're finished touching the counter.
+	counter->m_lock.Lock();
+	vsJob *released = nullptr;
+	if ( counter->m_pending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+	{
+		released = counter->m_waiting;
+		counter->m_waiting = nullptr;
+	}
+	counter->m_lock.Unlock();
+
+	while ( released )
+	{
+		vsJob *next = released->next;
+		Push( released );
+		released = next;
+	}
+}
+
+void
+vsJobSystem::Wait( vsJobCounter *counter )
+{
+	PROFILE("JobSystem::Wait");
+	while ( !counter->IsDone() )
+	{
+		vsJob *job = FindJob( s_dequeIndex );
+		if ( job )
+			Execute( job );
+		else
+			std::this_thread::yield();
+	}
+
+	// Whoever finished the last job might still be inside Complete();  wait
+	// for them to let go of the counter, so our caller can safely destroy it.
+	counter->m_lock.Lock();
+	counter->m_lock.Unlock();
+}
+
+void
+vsJobSystem::WorkerLoop( int dequeIndex )
+{
+	s_dequeIndex = dequeIndex;
+	while(1)
+	{
+		vsJob *job = FindJob( dequeIndex );
+		if ( !job )
+		{
+			m_sleeping.fetch_add( 1 );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			job = FindJob( dequeIndex, true );
+			if ( !job )
+			{
+				bool running = m_wake->Wait();
+				m_sleeping.fetch_sub( 1 );
+				if ( !running )
+					break;
+				continue;
+			}
+			m_sleeping.fetch_sub( 1 );
+		}
+
+		PROFILE("JobSystem::Job");
+		Execute( job );
+	}
+	s_dequeIndex = 0;
+}
+
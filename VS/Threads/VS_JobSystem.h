@@ -0,0 +1,160 @@
+/*
+ *  VS_JobSystem.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_JOBSYSTEM_H
+#define VS_JOBSYSTEM_H
+
+#include "Core/CORE_GameSystem.h"
+#include "VS/Math/VS_Math.h"
+#include "VS/Threads/VS_Semaphore.h"
+#include "VS/Threads/VS_Spinlock.h"
+#include <atomic>
+
+struct vsJob;
+
+// A vsJobCounter counts jobs which haven't finished yet.  Pass one to
+// vsJobSystem::Run() to be able to Wait() for that job later, or to make
+// other jobs depend on it.  Any number of jobs can share a counter.
+//
+// Don't destroy a counter which jobs have been added to without first calling
+// vsJobSystem::Wait() on it;  just seeing IsDone() isn't enough, as the job
+// which finished last may not quite be finished with the counter yet.
+class vsJobCounter
+{
+	friend class vsJobSystem;
+
+	std::atomic<int>	m_pending;
+	vsSpinlock			m_lock;		// protects m_waiting
+	vsJob *				m_waiting;	// jobs which depend on us, waiting to run
+
+public:
+	vsJobCounter();
+	~vsJobCounter();
+
+	bool	IsDone() const { return m_pending.load( std::memory_order_acquire ) == 0; }
+};
+
+// vsJobSystem is a work-stealing job scheduler.  It owns a worker thread per
+// spare hardware thread, and each worker (plus the main thread) has its own
+// deque of jobs.  Threads push and pop jobs at the bottom of their own deque,
+// and when it's empty they steal from the top of somebody else's.
+//
+// Waiting for a counter doesn't block;  the waiting thread runs other jobs
+// until the counter is done.  So it's fine to Wait() from inside a job.
+//
+// Jobs are plain function pointers, and must not throw.  Neither submitting
+// nor running a job allocates memory;  if we run out of job slots or deque
+// space, jobs just run immediately on the submitting thread.
+class vsJobSystem : public coreGameSystem
+{
+	static vsJobSystem *	s_instance;
+
+	class Worker;
+	struct Deque;
+
+	Worker **			m_worker;
+	int					m_workerCount;
+
+	Deque *				m_deque;	// [0] is shared by every thread which isn't one of our workers
+	int					m_dequeCount;
+
+	vsJob *				m_job;
+	vsJob *				m_freeJobs;
+	vsSpinlock			m_freeLock;
+
+	vsSemaphore *		m_wake;	// recreated along with our workers;  a released semaphore stays released
+	std::atomic<int>	m_sleeping;
+
+	void				StartWorkers( int workerCount );
+	void				StopWorkers();
+
+	vsJob *				AllocJob();
+	void				FreeJob( vsJob *job );
+
+	void				Submit( vsJob *job, vsJobCounter *dependency );
+	void				Push( vsJob *job );
+	vsJob *				FindJob( int dequeIndex, bool patient = false );
+	void				Execute( vsJob *job );
+	void				Complete( vsJobCounter *counter );
+	void				WorkerLoop( int dequeIndex );
+
+	template<typename F>
+	static void			CallRange( void *function, int start, int end ) { (*static_cast<F*>(function))( start, end ); }
+
+public:
+	static const int c_maxWorkers = 31;
+	static const int c_maxJobs = 4096;
+	static const int c_dequeCapacity = 1024;	// must be a power of two
+
+	static vsJobSystem *	Instance() { return s_instance; }
+
+	// By default, we make one worker for each logical core except the one
+	// that the main thread runs on.
+	vsJobSystem( int workerCount = -1 );
+	virtual ~vsJobSystem();
+
+	// Queue up 'function(data)' to run on some thread.  If 'counter' is passed,
+	// it counts this job until it's finished.  If 'dependency' is passed, the
+	// job won't start until 'dependency' is done.
+	void				Run( void (*function)(void*), void *data, vsJobCounter *counter = nullptr, vsJobCounter *dependency = nullptr );
+
+	// As Run(), but calls 'function(data, start, end)'.
+	void				RunRange( void (*function)(void*, int, int), void *data, int start, int end, vsJobCounter *counter = nullptr, vsJobCounter *dependency = nullptr );
+
+	// Runs jobs until 'counter' is done.
+	void				Wait( vsJobCounter *counter );
+
+	// Calls 'function(start, end)' for subranges of [begin, end) in parallel,
+	// and returns once they've all finished.  Subranges are at least
+	// 'grainSize' long (except for the last one).
+	template<typename F>
+	void				ParallelFor( int begin, int end, int grainSize, const F& function );
+
+	int					GetWorkerCount() const { return m_workerCount; }
+
+	// Replaces our workers with 'workerCount' new ones (with the same meaning
+	// as the constructor's argument).  For tests and benchmarks which compare
+	// different numbers of workers;  call it from the main thread, and only
+	// when there are no jobs queued or running.
+	void				SetWorkerCount( int workerCount );
+
+	// 1..GetWorkerCount() on our worker threads, 0 on any other thread.
+	static int			GetCurrentWorkerIndex();
+};
+
+template<typename F>
+void
+vsJobSystem::ParallelFor( int begin, int end, int grainSize, const F& function )
+{
+	int count = end - begin;
+	if ( count <= 0 )
+		return;
+
+	// No point making many more jobs than we have threads to run them;  a few
+	// each is enough for stealing to balance things out.
+	int jobCount = (count + grainSize - 1) / vsMax( 1, grainSize );
+	jobCount = vsMin( jobCount, (m_workerCount+1) * 4 );
+	if ( jobCount <= 1 )
+	{
+		function( begin, end );
+		return;
+	}
+
+	vsJobCounter counter;
+	for ( int i = 0; i < jobCount; i++ )
+	{
+		int start = begin + (int)(((int64_t)count * i) / jobCount);
+		int stop = begin + (int)(((int64_t)count * (i+1)) / jobCount);
+		RunRange( &CallRange<const F>, const_cast<F*>(&function), start, stop, &counter );
+	}
+	Wait( &counter );
+}
+
+#endif // VS_JOBSYSTEM_H
+
@@ -8,6 +8,7 @@
 
 #include "VS_Thread.h"
 #include "VS_Mutex.h"
+#include "VS_Heap.h"
 #include <SDL2/SDL_thread.h>
 #include <map>
 
@@ -53,6 +54,7 @@ int vsThread::DoStartThread(void* arg)
 
 	thread->m_done = false;
 	result = thread->Run();
+	vsHeap::FlushThreadCache();	// return any memory this thread freed to its heaps
 	thread->m_done = true;
 
 	return result;
@@ -66,6 +68,12 @@ vsThread::vsThread( const vsString& name ):
 }
 
 vsThread::~vsThread()
+{
+	Wait();
+}
+
+void
+vsThread::Wait()
 {
 	if ( m_thread != 0 )
 	{
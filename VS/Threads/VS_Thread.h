@@ -37,6 +37,11 @@ public:
 	void Start();
 	bool IsDone() { return m_done; }
 
+	// Blocks until Run() has returned.  ~vsThread() does this too, but by
+	// then a subclass has already been destroyed;  if its thread might not
+	// have reached Run() yet, the subclass's destructor must call Wait().
+	void Wait();
+
 	static const vsString& GetCurrentThreadName();
 	static bool IsMainThread();
 };
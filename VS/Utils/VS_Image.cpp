@@ -60,14 +60,13 @@ vsImage::vsImage( const vsString &filename ):
 	m_pbo(0),
 	m_sync(0)
 {
-	vsFile *img = new vsFile(filename, vsFile::MODE_Read);
-	vsStore s( img->GetLength() );
-	img->Store(&s);
-	vsDelete(img);
+	vsFile *img = new vsFile(filename, vsFile::MODE_ReadMapped);
+	vsStore s( const_cast<char*>(img->GetContents()), img->GetLength() );
 
 	vsAssertF( s.BytesLeftForReading() > 0, "Trying to load image '%s' but got zero bytes?", filename );
 
 	ReadFromFileData( s );
+	vsDelete(img);
 }
 
 vsImage::vsImage( const vsStore &filedata ):
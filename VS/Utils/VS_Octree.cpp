@@ -11,202 +11,215 @@
 
 #include "VS/Graphics/VS_Camera.h"
 #include "VS/Graphics/VS_Model.h"
+#include "VS/Math/VS_Frustum.h"
 
-#include <list>
+#include "VS_Profile.h"
 
 struct vsOctreeModelInfo
 {
 	vsModel *	m_model;
 	int			m_nodeId;
-	
+	int			m_slot;		// where we are in our node's m_info array
+
 	vsOctreeModelInfo() :
 		m_model(nullptr),
-		m_nodeId(-1)
-	{
-	}
-	
-	~vsOctreeModelInfo()
+		m_nodeId(-1),
+		m_slot(-1)
 	{
 	}
 };
 
 struct vsOctreeNode
 {
-	vsBox3D		m_bounds;
-	int			m_nodeId;
+	// Most nodes of a big tree never hold a model, so we don't allocate
+	// storage for a node's models until the first one is inserted.
+	vsOctreeModelInfo **	m_info;
+	int			m_infoCount;
+	int			m_infoStorage;
+
 	int			m_parentNodeId;
-	
-	std::list<vsOctreeModelInfo*>	m_infoList;
-	
-	int			m_childId[8];
-	
+	int			m_firstChildId;		// our eight children are consecutive, starting here.  -1 if we're a leaf.
+	int			m_level;
+	int			m_modelCount;		// models in this node and all of its descendants
+
+	vsOctreeNode() :
+		m_info(nullptr),
+		m_infoCount(0),
+		m_infoStorage(0),
+		m_parentNodeId(-1),
+		m_firstChildId(-1),
+		m_level(0),
+		m_modelCount(0)
+	{
+	}
+
 	~vsOctreeNode()
 	{
-		while ( m_infoList.begin() != m_infoList.end() )
+		for ( int i = 0; i < m_infoCount; i++ )
+			vsDelete( m_info[i] );
+		vsDeleteArray( m_info );
+	}
+
+	void AddInfo( vsOctreeModelInfo *info )
+	{
+		if ( m_infoCount == m_infoStorage )
 		{
-			vsOctreeModelInfo *info = *m_infoList.begin();
-			
-			m_infoList.remove(info);
-			
-			vsDelete(info);
+			m_infoStorage = vsMax( 4, m_infoStorage * 2 );
+			vsOctreeModelInfo **storage = new vsOctreeModelInfo*[m_infoStorage];
+			for ( int i = 0; i < m_infoCount; i++ )
+				storage[i] = m_info[i];
+			vsDeleteArray( m_info );
+			m_info = storage;
 		}
+		m_info[m_infoCount++] = info;
 	}
 };
 
-vsOctree::vsOctree( const vsBox3D &area, int levels )
+// Within each level, nodes are in Morton order;  the bits of a node's cell
+// coordinates are interleaved, x in the lowest bit of each triple.  So a
+// node's children are eight consecutive nodes in the next level down, and
+// child i is offset in +x if (i & 0x1), +y if (i & 0x2), and +z if (i & 0x4).
+static int
+Interleave( int x, int y, int z, int level )
 {
-	int nodeCount = 1;
-	int nodesThisLevel = 1;
-	for ( int i = 0; i < levels; i++ )
+	int result = 0;
+	for ( int bit = level-1; bit >= 0; bit-- )
 	{
-		nodesThisLevel *= 8;
-		nodeCount += nodesThisLevel;
+		result = (result << 3) |
+			((x >> bit) & 0x1) |
+			(((y >> bit) & 0x1) << 1) |
+			(((z >> bit) & 0x1) << 2);
 	}
-	
-	m_nodeCount = nodeCount;
-	m_node = new vsOctreeNode[m_nodeCount];
-	
-	m_nextNodeToInit = 0;
-	
-	InitNode( area, levels, -1 );
+	return result;
 }
 
-vsOctree::~vsOctree()
+static void
+Deinterleave( int index, int level, int *x, int *y, int *z )
 {
-	vsDeleteArray( m_node );
+	*x = *y = *z = 0;
+	for ( int bit = 0; bit < level; bit++ )
+	{
+		*x |= ((index >> (bit*3)) & 0x1) << bit;
+		*y |= ((index >> (bit*3+1)) & 0x1) << bit;
+		*z |= ((index >> (bit*3+2)) & 0x1) << bit;
+	}
 }
 
-void
-vsOctree::InitNode( const vsBox3D &bounds, int levelsToRecurse, int parentId )
+vsOctree::vsOctree( const vsBox3D &area, int levels ):
+	m_area( area ),
+	m_nodesDrawn( 0 )
 {
-	vsAssert( m_nextNodeToInit < m_nodeCount, "Octree setup error" );
-	vsOctreeNode *node = &m_node[ m_nextNodeToInit ];
-	
-	node->m_bounds = bounds;
-	node->m_nodeId = m_nextNodeToInit;
-	node->m_parentNodeId = parentId;
-	
-	m_nextNodeToInit++;
-	
-	if ( levelsToRecurse == 0 )
+	vsAssert( levels >= 0 && levels <= c_maxLevels, "Octree has too many levels" );
+	m_levels = vsClamp( levels, 0, c_maxLevels );
+
+	int nodeCount = 0;
+	int nodesThisLevel = 1;
+	for ( int i = 0; i <= m_levels; i++ )
 	{
-		for ( int i = 0; i < 8; i++ )
-		{
-			node->m_childId[i] = -1;
-		}
+		m_levelStart[i] = nodeCount;
+		nodeCount += nodesThisLevel;
+		nodesThisLevel *= 8;
 	}
-	else
+
+	m_nodeCount = nodeCount;
+	m_node = new vsOctreeNode[m_nodeCount];
+	m_bounds = new vsBox3D[m_nodeCount];
+
+	for ( int level = 0; level <= m_levels; level++ )
 	{
-		// THIS IS LOGIC IS WRONG FOR MOST CASES!  FIX ME BEFORE COMMITTING BACK TO TRUNK!
-		// (Check the implementation of the mmoQuadTreeStore class for a correct impl)
-		vsBox3D childBounds = bounds * 0.5f;	// each level's nodes are half the size of the parent nodes!
-		
-		float halfWidth = childBounds.Width() * 0.5f;
-		float halfHeight = childBounds.Height() * 0.5f;
-		float halfDepth = childBounds.Depth() * 0.5f;
-		
-		
-		vsVector3D offset[8];
-		
-		for ( int i = 0; i < 8; i++ )
-		{
-			if ( i & 0x1 )
-			{
-				offset[i].x += halfWidth;
-			}
-			else
-			{
-				offset[i].x -= halfWidth;
-			}
-
-			if ( i & 0x2 )
-			{
-				offset[i].y += halfHeight;
-			}
-			else
-			{
-				offset[i].y -= halfHeight;
-			}
-
-			if ( i & 0x4 )
-			{
-				offset[i].z += halfDepth;
-			}
-			else
-			{
-				offset[i].z -= halfDepth;
-			}
-		}
+		vsVector3D cellSize = area.Extents() * (1.f / (1 << level));
+		m_cellSize[level] = cellSize;
+		m_inverseCellSize[level].Set( cellSize.x > 0.f ? 1.f / cellSize.x : 0.f,
+				cellSize.y > 0.f ? 1.f / cellSize.y : 0.f,
+				cellSize.z > 0.f ? 1.f / cellSize.z : 0.f );
 
-		for ( int i = 0; i < 8; i++ )
+		int levelNodeCount = 1 << (level * 3);
+		for ( int i = 0; i < levelNodeCount; i++ )
 		{
-			node->m_childId[i] = m_nextNodeToInit;
-			InitNode( childBounds + offset[i], levelsToRecurse-1, node->m_nodeId );
+			int nodeId = m_levelStart[level] + i;
+			vsOctreeNode *node = &m_node[nodeId];
+			node->m_level = level;
+			if ( level > 0 )
+				node->m_parentNodeId = m_levelStart[level-1] + (i >> 3);
+			if ( level < m_levels )
+				node->m_firstChildId = m_levelStart[level+1] + (i << 3);
+
+			int x, y, z;
+			Deinterleave( i, level, &x, &y, &z );
+			vsVector3D cellMin = area.GetMin() + vsVector3D( x * cellSize.x, y * cellSize.y, z * cellSize.z );
+			m_bounds[nodeId].Set( cellMin - cellSize * 0.5f, cellMin + cellSize * 1.5f );
 		}
 	}
 }
 
-
-
-void
-vsOctree::Draw( const vsCamera3D *camera, vsRenderQueue *queue )
+vsOctree::~vsOctree()
 {
-	m_nodesDrawn = 0;
-	DrawNode( 0, camera, queue );
+	vsDeleteArray( m_node );
+	vsDeleteArray( m_bounds );
 }
 
-void
-vsOctree::DrawNode( int nodeId, const vsCamera3D *camera, vsRenderQueue *queue )
+int
+vsOctree::FindNode( const vsBox3D &modelBounds ) const
 {
-	vsAssert( nodeId >= 0 && nodeId < m_nodeCount, "Octree draw error" );
-	vsOctreeNode *node = &m_node[ nodeId ];
-	
-	if ( camera->IsBox3DVisible( node->m_bounds ) )
+	// deepest level whose cells are at least as big as the model
+	vsVector3D extents = modelBounds.Extents();
+	int level = m_levels;
+	while ( level > 0 &&
+			( extents.x > m_cellSize[level].x ||
+			  extents.y > m_cellSize[level].y ||
+			  extents.z > m_cellSize[level].z ) )
 	{
-		// draw all our contents.
-		for( std::list<vsOctreeModelInfo*>::iterator i = node->m_infoList.begin(); i != node->m_infoList.end(); i++ )
-		{
-			vsOctreeModelInfo *info = *i;
-			
-			info->m_model->Draw(queue);
-		}
-		
-		
-		m_nodesDrawn++;
-		
-		for ( int i = 0; i < 8; i++ )
-		{
-			if ( node->m_childId[i] > 0 )
-			{
-				DrawNode( node->m_childId[i], camera, queue );
-			}
-		}
+		level--;
 	}
+
+	// and the cell in that level which contains the model's center.
+	vsVector3D offset = modelBounds.Middle() - m_area.GetMin();
+	float last = (float)((1 << level) - 1);
+	int x = (int)vsClamp( offset.x * m_inverseCellSize[level].x, 0.f, last );
+	int y = (int)vsClamp( offset.y * m_inverseCellSize[level].y, 0.f, last );
+	int z = (int)vsClamp( offset.z * m_inverseCellSize[level].z, 0.f, last );
+	int nodeId = m_levelStart[level] + Interleave( x, y, z, level );
+
+	// If the model's center is outside the area, it may not fit in the
+	// nearest cell;  if so, move up until we find a node which holds it.
+	while ( nodeId > 0 && !m_bounds[nodeId].Encompasses( modelBounds ) )
+		nodeId = m_node[nodeId].m_parentNodeId;
+
+	return nodeId;
 }
 
 void
 vsOctree::InsertInfoAtNode( vsOctreeModelInfo *info, int nodeId )
 {
-	vsBox3D modelBounds = info->m_model->GetBoundingBox() + info->m_model->GetPosition();
 	vsAssert(nodeId >= 0 && nodeId < m_nodeCount, "Illegal octree node insertion");
 	vsOctreeNode *node = &m_node[nodeId];
-	
-	for ( int i = 0; i < 8; i++ )
-	{
-		if ( node->m_childId[i] > 0 )
-		{
-			vsOctreeNode *childNode = &m_node[ node->m_childId[i] ];
-			
-			if ( childNode->m_bounds.EncompassesBox( modelBounds ) )
-			{
-				InsertInfoAtNode( info, node->m_childId[i] );
-				return;
-			}
-		}
-	}
-	
+
 	info->m_nodeId = nodeId;
-	node->m_infoList.push_back(info);
+	info->m_slot = node->m_infoCount;
+	node->AddInfo( info );
+
+	for ( int id = nodeId; id >= 0; id = m_node[id].m_parentNodeId )
+		m_node[id].m_modelCount++;
+}
+
+void
+vsOctree::RemoveInfoFromNode( vsOctreeModelInfo *info )
+{
+	vsAssert( info->m_nodeId >= 0 && info->m_nodeId < m_nodeCount, "Illegal nodeId set on octree info object??" );
+	vsOctreeNode *node = &m_node[info->m_nodeId];
+	vsAssert( node->m_info[info->m_slot] == info, "Octree info object isn't where it thinks it is??" );
+
+	// swap the last model into our slot, so we don't have to shuffle the
+	// whole array down.
+	vsOctreeModelInfo *last = node->m_info[ --node->m_infoCount ];
+	node->m_info[info->m_slot] = last;
+	last->m_slot = info->m_slot;
+
+	for ( int id = info->m_nodeId; id >= 0; id = m_node[id].m_parentNodeId )
+		m_node[id].m_modelCount--;
+
+	info->m_nodeId = -1;
+	info->m_slot = -1;
 }
 
 vsOctreeModelInfo *
@@ -214,9 +227,10 @@ vsOctree::AddModel( vsModel *model )
 {
 	vsOctreeModelInfo *info = new vsOctreeModelInfo;
 	info->m_model = model;
-	
-	InsertInfoAtNode( info, 0 );
-	
+
+	vsBox3D modelBounds = model->GetBoundingBox() + model->GetPosition();
+	InsertInfoAtNode( info, FindNode( modelBounds ) );
+
 	return info;
 }
 
@@ -224,28 +238,85 @@ void
 vsOctree::UpdateModel( vsOctreeModelInfo *info )
 {
 	vsAssert( info->m_nodeId >= 0 && info->m_nodeId < m_nodeCount, "Illegal nodeId set on octree info object??" );
-	vsOctreeNode *node = &m_node[info->m_nodeId];
 	vsBox3D modelBounds = info->m_model->GetBoundingBox() + info->m_model->GetPosition();
-	node->m_infoList.remove(info);
+	int nodeId = FindNode( modelBounds );
 
-	if ( node->m_bounds.EncompassesBox( modelBounds ) )
-	{
-		InsertInfoAtNode( info, info->m_nodeId );
-	}
-	else
-	{
-		InsertInfoAtNode( info, 0 );
-	}
+	if ( nodeId == info->m_nodeId )
+		return;
+
+	// If the model has wandered out of its cell but is still inside the
+	// loose bounds of its node (and is still the right size for that level),
+	// there's no need to move it yet.
+	if ( m_node[info->m_nodeId].m_level == m_node[nodeId].m_level &&
+			m_bounds[info->m_nodeId].Encompasses( modelBounds ) )
+		return;
+
+	RemoveInfoFromNode( info );
+	InsertInfoAtNode( info, nodeId );
 }
 
 void
 vsOctree::RemoveModel( vsOctreeModelInfo *info )
 {
-	vsAssert( info->m_nodeId >= 0 && info->m_nodeId < m_nodeCount, "Illegal nodeId set on octree info object??" );
-	vsOctreeNode *node = &m_node[info->m_nodeId];
-	
-	node->m_infoList.remove(info);
-	
+	RemoveInfoFromNode( info );
 	vsDelete(info);
 }
 
+void
+vsOctree::Draw( const vsCamera3D *camera, vsRenderQueue *queue )
+{
+	PROFILE("vsOctree::Draw");
+	const vsFrustum &frustum = camera->GetFrustum();
+	m_nodesDrawn = 0;
+
+	// Each stack entry is a node id, shifted up one bit;  the low bit is set
+	// if we already know that the node is entirely inside the frustum, in
+	// which case so are all of its children and we don't need to test them.
+	// We push at most seven more entries than we pop on each level down.
+	int stack[ 1 + c_maxLevels * 7 ];
+	int stackCount = 0;
+
+	vsFrustum::Classification rootClass = frustum.ClassifyBox3D( m_bounds[0] );
+	if ( rootClass == vsFrustum::Outside )
+	{
+		// models which are outside the tree's area still need drawing.
+		for ( int i = 0; i < m_node[0].m_infoCount; i++ )
+			m_node[0].m_info[i]->m_model->Draw(queue);
+		return;
+	}
+	stack[stackCount++] = ( rootClass == vsFrustum::Inside ) ? 1 : 0;
+
+	while ( stackCount > 0 )
+	{
+		int entry = stack[--stackCount];
+		bool inside = ( entry & 0x1 ) != 0;
+		const vsOctreeNode *node = &m_node[ entry >> 1 ];
+
+		for ( int i = 0; i < node->m_infoCount; i++ )
+			node->m_info[i]->m_model->Draw(queue);
+		m_nodesDrawn++;
+
+		if ( node->m_firstChildId < 0 || node->m_modelCount == node->m_infoCount )
+			continue;	// nothing further down
+
+		vsFrustum::Classification childClass[8];
+		if ( inside )
+		{
+			for ( int i = 0; i < 8; i++ )
+				childClass[i] = vsFrustum::Inside;
+		}
+		else
+		{
+			frustum.ClassifyBoxes3D( &m_bounds[node->m_firstChildId], childClass, 8 );
+		}
+
+		// push in reverse, so we visit the children in order.
+		for ( int i = 7; i >= 0; i-- )
+		{
+			int childId = node->m_firstChildId + i;
+			if ( m_node[childId].m_modelCount > 0 && childClass[i] != vsFrustum::Outside )
+				stack[stackCount++] = (childId << 1) | ( childClass[i] == vsFrustum::Inside ? 1 : 0 );
+		}
+	}
+}
+
@@ -17,29 +17,52 @@ class vsCamera3D;
 struct vsOctreeNode;
 struct vsOctreeModelInfo;
 
+// vsOctree is a loose octree;  each node's bounds are twice the size of its
+// cell in the grid for its level, so that they overlap their neighbours by
+// half a cell on each side.  A model goes into the deepest level whose cells
+// are at least as big as it is, in whichever cell holds its center.  That
+// means we can find a model's node directly from its bounding box instead of
+// searching down from the root, and a model can wander up to half a cell
+// outside its cell before it needs to move at all.
+//
+// Nodes are stored level by level, with the eight children of each node next
+// to each other, so we can test all of a node's children against the frustum
+// in a single batch.  Models which don't fit inside the tree at all go into
+// the root node, whose contents are always drawn.
+
 class vsOctree
 {
+public:
+	static const int c_maxLevels = 7;	// a full seven level tree is 2.4 million nodes
+
+private:
 	vsOctreeNode *	m_node;
+	vsBox3D *		m_bounds;		// the loose bounds of each node
 	int				m_nodeCount;
-	
+	int				m_levels;
+
+	vsBox3D			m_area;
+	vsVector3D		m_cellSize[c_maxLevels+1];
+	vsVector3D		m_inverseCellSize[c_maxLevels+1];
+	int				m_levelStart[c_maxLevels+1];	// index of the first node in each level
+
 	int				m_nodesDrawn;
-	
-	int				m_nextNodeToInit;
-	
-	void			InitNode( const vsBox3D &bounds, int levelsToRecurse, int parentId );
-	void			DrawNode( int nodeId, const vsCamera3D *camera, vsRenderQueue *queue );
-	
+
+	int				FindNode( const vsBox3D &modelBounds ) const;
 	void			InsertInfoAtNode( vsOctreeModelInfo *info, int nodeId );
-	
+	void			RemoveInfoFromNode( vsOctreeModelInfo *info );
+
 public:
 					vsOctree( const vsBox3D &area, int levels );
 					~vsOctree();
-	
+
 	vsOctreeModelInfo *	AddModel( vsModel *model );
 	void				UpdateModel( vsOctreeModelInfo *info );
 	void				RemoveModel( vsOctreeModelInfo *info );
-	
+
 	void			Draw( const vsCamera3D *camera, vsRenderQueue *queue );
+
+	int				GetNodesDrawn() const { return m_nodesDrawn; }
 };
 
 
@@ -153,10 +153,10 @@ vsFragment *	vsMakeTexturedBox2D( const vsBox2D &box, vsMaterial *material, cons
 	};
 	vsVector2D tex[4] =
 	{
-		vsVector2D( 0.f, 1.f),
-		vsVector2D( 1.f, 1.f),
-		vsVector2D( 0.f, 0.f),
-		vsVector2D( 1.f, 0.f)
+		material->MapTexel( vsVector2D( 0.f, 1.f) ),
+		material->MapTexel( vsVector2D( 1.f, 1.f) ),
+		material->MapTexel( vsVector2D( 0.f, 0.f) ),
+		material->MapTexel( vsVector2D( 1.f, 0.f) )
 	};
 	int ts[4] =
 	{
@@ -691,6 +691,10 @@ vsFragment *	vsMakeTexturedBox2D( const vsBox2D &box, const vsString &material,
 
 vsFragment *	vsMakeTexturedBox2D( const vsBox2D &box, const vsString &material, const vsVector2D& texScale, const vsVector2D& texOffset, const vsColor *colorOverride )
 {
+	vsFragment *fragment = new vsFragment;
+	fragment->SetMaterial( material );
+	vsMaterial *mat = fragment->GetMaterial();
+
 	vsRenderBuffer *vbo = new vsRenderBuffer(vsRenderBuffer::Type_Static);
 	vsRenderBuffer *ibo = new vsRenderBuffer(vsRenderBuffer::Type_Static);
 	vsVector3D va[4] =
@@ -702,10 +706,10 @@ vsFragment *	vsMakeTexturedBox2D( const vsBox2D &box, const vsString &material,
 	};
 	vsVector2D tex[4] =
 	{
-		vsVector2D( 0.f * texScale.x, 1.f * texScale.y) + texOffset,
-		vsVector2D( 1.f * texScale.x, 1.f * texScale.y) + texOffset,
-		vsVector2D( 0.f * texScale.x, 0.f * texScale.y) + texOffset,
-		vsVector2D( 1.f * texScale.x, 0.f * texScale.y) + texOffset
+		mat->MapTexel( vsVector2D( 0.f * texScale.x, 1.f * texScale.y) + texOffset ),
+		mat->MapTexel( vsVector2D( 1.f * texScale.x, 1.f * texScale.y) + texOffset ),
+		mat->MapTexel( vsVector2D( 0.f * texScale.x, 0.f * texScale.y) + texOffset ),
+		mat->MapTexel( vsVector2D( 1.f * texScale.x, 0.f * texScale.y) + texOffset )
 	};
 	uint16_t ts[4] =
 	{
@@ -736,9 +740,7 @@ vsFragment *	vsMakeTexturedBox2D( const vsBox2D &box, const vsString &material,
 
 	ibo->SetArray(ts,4);
 
-	vsFragment *fragment = new vsFragment;
 	fragment->SetSimple(vbo,ibo,vsFragment::SimpleType_TriangleStrip);
-	fragment->SetMaterial( material );
 
 	return fragment;
 }
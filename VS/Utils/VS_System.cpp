@@ -16,8 +16,12 @@
 #include "VS_Preferences.h"
 #include "VS_Random.h"
 #include "VS_Screen.h"
+#include "VS_Renderer.h"
 #include "VS_DynamicBatchManager.h"
+#include "VS_FrameArena.h"
+#include "VS_ParallelDraw.h"
 #include "VS_SingletonManager.h"
+#include "VS_TextureAtlas.h"
 #include "VS_TextureManager.h"
 #include "VS_FileCache.h"
 #include "VS_File.h"
@@ -309,6 +313,18 @@ vsSystem::vsSystem(const vsString& companyName, const vsString& title, const vsS
 
 #if !TARGET_OS_IPHONE
 
+	for ( int i = 0; i < argc; i++ )
+	{
+		if ( vsString(argv[i]) == "--headless" )
+		{
+			// No window and no GL context;  we'll render through a
+			// vsRenderer_Recording instead.
+			vsLog("Headless mode enabled");
+			vsRenderer::SetHeadless(true);
+			SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		}
+	}
+
 	vsLog("Initialising SDL");
 
 	Uint32 sdlInitFlags = SDL_INIT_VIDEO;
@@ -428,6 +444,9 @@ vsSystem::Init()
 	vsBuiltInFont::Init();
 
 #if defined(_WIN32)
+	if ( vsRenderer::IsHeadless() )
+		return; // no window to drop anything onto.
+
 	// Initialize OLE, which is where all the windows Drag & Drop stuff takes place
 	OleInitialize(nullptr);
 
@@ -449,16 +468,22 @@ vsSystem::Init()
 void
 vsSystem::InitGameData()
 {
+	m_textureAtlas = new vsTextureAtlas;
 	m_materialManager = new vsMaterialManager;
 	m_dynamicBatchManager = new vsDynamicBatchManager;
+	m_frameArena = new vsFrameArena;
+	m_parallelDraw = new vsParallelDraw;
 }
 
 void
 vsSystem::DeinitGameData()
 {
+	vsDelete( m_textureAtlas ); // before the materials, as it holds references to some of them.
 	vsDelete( m_materialManager );
 	m_textureManager->CollectGarbage();
+	vsDelete( m_parallelDraw );
 	vsDelete( m_dynamicBatchManager );
+	vsDelete( m_frameArena );
 }
 
 void
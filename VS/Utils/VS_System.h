@@ -14,11 +14,14 @@
 #include "Utils/VS_Array.h"
 
 class vsDynamicBatchManager;
+class vsFrameArena;
+class vsParallelDraw;
 class vsMaterialManager;
 class vsPreferences;
 class vsPreferenceObject;
 class vsSystemPreferences;
 class vsScreen;
+class vsTextureAtlas;
 class vsTextureManager;
 struct SDL_Cursor;
 
@@ -82,8 +85,11 @@ class vsSystem
 	Orientation			m_orientation;
 
 	vsTextureManager *	m_textureManager;
+	vsTextureAtlas *	m_textureAtlas;
 	vsMaterialManager *	m_materialManager;
 	vsDynamicBatchManager *m_dynamicBatchManager;
+	vsFrameArena *		m_frameArena;
+	vsParallelDraw *	m_parallelDraw;
 
 	vsString			m_title;
 	vsScreen *			m_screen;
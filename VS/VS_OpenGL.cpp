@@ -9,6 +9,7 @@
 
 #include "VS_OpenGL.h"
 #include "VS_Profile.h"
+#include "VS_Renderer.h"
 
 #ifdef VS_GL_DEBUG
 
@@ -37,6 +38,8 @@ void ReportGLError( GLenum errcode, const char* string )
 void CheckGLError(const char* string)
 {
 	PROFILE("CheckGLError");
+	if ( vsRenderer::IsHeadless() )
+		return;
 	GLenum errcode = glGetError();
 	if ( errcode != GL_NO_ERROR )
 		ReportGLError(errcode, string);
@@ -47,6 +50,8 @@ vsGLContext::vsGLContext( const char* string, const char* file, int line ):
 	m_file(file),
 	m_line(line)
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
 	GLenum errcode = glGetError();
 	if ( errcode != GL_NO_ERROR )
 	{
@@ -57,6 +62,8 @@ vsGLContext::vsGLContext( const char* string, const char* file, int line ):
 
 vsGLContext::~vsGLContext()
 {
+	if ( vsRenderer::IsHeadless() )
+		return;
 	GLenum errcode = glGetError();
 	if ( errcode != GL_NO_ERROR )
 	{
@@ -0,0 +1,140 @@
+/*
+ *  Bench_Codec.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Codec.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Compresses and decompresses two kinds of buffer with every vsCodec, and
+// prints the compression ratio and both speeds (in MB/s of uncompressed
+// data).  The record buffer is vsRecord text like a saved game or a text
+// model file;  the model buffer is binary vertex and index data, like the
+// arrays inside a binary model file.
+
+namespace
+{
+	const size_t c_bufferBytes = 16 * 1024 * 1024;
+	const int c_runs = 3;
+
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	void Append( std::vector<char> *data, const vsString& text )
+	{
+		data->insert( data->end(), text.begin(), text.end() );
+	}
+
+	std::vector<char> MakeRecords()
+	{
+		const char *labels[] = { "position", "velocity", "health", "name", "enemy", "tile", "flags", "colour" };
+		const int labelCount = sizeof(labels) / sizeof(labels[0]);
+
+		std::vector<char> data;
+		data.reserve( c_bufferBytes + 1024 );
+		for ( int entity = 0; data.size() < c_bufferBytes; entity++ )
+		{
+			Append( &data, vsFormatString( "Entity \"entity_%d\"\n{\n", entity ) );
+			int lines = 4 + Random() % 8;
+			for ( int i = 0; i < lines; i++ )
+			{
+				const char *label = labels[ Random() % labelCount ];
+				Append( &data, vsFormatString( "\t%s %f %f %d\n", label,
+							(Random() % 100000) * 0.01f, (Random() % 2000) * 0.5f - 500.f, (int)(Random() % 256) ) );
+			}
+			Append( &data, "}\n" );
+		}
+		data.resize( c_bufferBytes );
+		return data;
+	}
+
+	std::vector<char> MakeModel()
+	{
+		// A bumpy grid:  position, normal, and texel per vertex, then
+		// uint16_t triangle indices.  Neighbouring vertices have similar
+		// values, as they would in a real mesh.
+		const int c_gridSize = 200;
+		const int vertexCount = c_gridSize * c_gridSize;
+		std::vector<char> data;
+		data.reserve( c_bufferBytes + 1024 * 1024 );
+		while ( data.size() < c_bufferBytes )
+		{
+			float height = 0.f;
+			for ( int v = 0; v < vertexCount; v++ )
+			{
+				int x = v % c_gridSize, z = v / c_gridSize;
+				height += ( (int)(Random() % 201) - 100 ) * 0.001f;
+				float vertex[8] = { x * 0.5f, height, z * 0.5f, 0.f, 1.f, 0.f, x / (float)c_gridSize, z / (float)c_gridSize };
+				data.insert( data.end(), (const char*)vertex, (const char*)(vertex + 8) );
+			}
+			for ( int z = 0; z+1 < c_gridSize; z++ )
+				for ( int x = 0; x+1 < c_gridSize; x++ )
+				{
+					uint16_t i = (uint16_t)( z * c_gridSize + x );
+					uint16_t quad[6] = { i, (uint16_t)(i+1), (uint16_t)(i+c_gridSize),
+						(uint16_t)(i+c_gridSize), (uint16_t)(i+1), (uint16_t)(i+c_gridSize+1) };
+					data.insert( data.end(), (const char*)quad, (const char*)(quad + 6) );
+				}
+		}
+		data.resize( c_bufferBytes );
+		return data;
+	}
+
+	double MBps( size_t bytes, double ms )
+	{
+		return bytes / ( 1024.0 * 1024.0 ) / ( ms / 1000.0 );
+	}
+
+	void Run( const char *name, const vsCodec *codec, const std::vector<char>& data )
+	{
+		std::vector<char> packed( codec->GetMaxCompressedLength( data.size() ) );
+		std::vector<char> unpacked( data.size() );
+		size_t packedLength = 0;
+		double compressMs = 0.0, decompressMs = 0.0;
+		for ( int run = 0; run < c_runs; run++ )
+		{
+			vsTestStopwatch compressWatch;
+			packedLength = codec->Compress( &data[0], data.size(), &packed[0], packed.size() );
+			double ms = compressWatch.GetMilliseconds();
+			if ( run == 0 || ms < compressMs )
+				compressMs = ms;
+
+			vsTestStopwatch decompressWatch;
+			bool ok = codec->Decompress( &packed[0], packedLength, &unpacked[0], unpacked.size() );
+			ms = decompressWatch.GetMilliseconds();
+			if ( run == 0 || ms < decompressMs )
+				decompressMs = ms;
+			TEST_CHECK( ok && memcmp( &unpacked[0], &data[0], data.size() ) == 0 );
+		}
+
+		printf( "%-8s %-6s %6.2f:1  %8.1f MB/s  %8.1f MB/s\n", name, codec->GetName(),
+				(double)data.size() / packedLength, MBps( data.size(), compressMs ), MBps( data.size(), decompressMs ) );
+	}
+}
+
+int main()
+{
+	std::vector<char> records = MakeRecords();
+	std::vector<char> model = MakeModel();
+
+	printf( "%-8s %-6s %8s  %13s  %13s\n", "buffer", "codec", "ratio", "compress", "decompress" );
+	for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+		Run( "records", vsCodec::Get( (vsCodec::Type)t ), records );
+	for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+		Run( "model", vsCodec::Get( (vsCodec::Type)t ), model );
+
+	return 0;
+}
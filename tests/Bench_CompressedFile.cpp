@@ -0,0 +1,158 @@
+/*
+ *  Bench_CompressedFile.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Codec.h"
+#include "VS_File.h"
+#include "VS_JobSystem.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Writes the same ~64MB of save game-like text as a single compressed stream
+// (MODE_WriteCompressed) and in independent blocks with each codec
+// (MODE_WriteCompressedBlocked), then times reading each file back through
+// MODE_ReadCompressed with the job system running 0, 1, 3, and 7 workers.
+// Only blocked files can use the workers, so the single stream is there as
+// the baseline.  Speeds are of uncompressed bytes.
+
+namespace
+{
+	const size_t c_dataBytes = 64 * 1024 * 1024;
+	const int c_runs = 3;
+	const int c_workerCounts[] = { 0, 1, 3, 7 };
+	const int c_workerCountCount = sizeof(c_workerCounts) / sizeof(c_workerCounts[0]);
+
+	struct Case
+	{
+		vsString		name;
+		vsString		filename;
+		vsFile::Mode	mode;
+		vsCodec::Type	codec;
+	};
+
+	std::vector<char> MakeData( size_t length )
+	{
+		const char *words[] = { "position", "velocity", "health", "name", "enemy", "tile", "flags", "colour", "{", "}", "\n" };
+		const int wordCount = sizeof(words) / sizeof(words[0]);
+
+		std::vector<char> data;
+		data.reserve( length );
+		uint32_t seed = 12345;
+		while ( data.size() < length )
+		{
+			seed = seed * 1103515245 + 12345;
+			vsString token = vsFormatString( "%s %u ", words[ (seed >> 16) % wordCount ], (seed >> 8) % 10000 );
+			for ( size_t i = 0; i < token.size() && data.size() < length; i++ )
+				data.push_back( token[i] );
+		}
+		return data;
+	}
+
+	double MBps( size_t bytes, double ms )
+	{
+		return bytes / ( 1024.0 * 1024.0 ) / ( ms / 1000.0 );
+	}
+
+	void Write( const Case& c, const std::vector<char>& data )
+	{
+		vsCodec::SetDefault( c.codec );
+		vsTestStopwatch watch;
+		{
+			vsFile file( c.filename, c.mode );
+			file.WriteBytes( &data[0], data.size() );
+		}
+		double ms = watch.GetMilliseconds();
+		vsCodec::SetDefault( vsCodec::Type_Zlib );
+
+		vsFile compressed( c.filename, vsFile::MODE_Read );
+		printf( "%-20s %7.1fMB, %4.1f:1, written at %7.1f MB/s\n", c.name.c_str(),
+				compressed.GetLength() / ( 1024.0 * 1024.0 ), (double)data.size() / compressed.GetLength(),
+				MBps( data.size(), ms ) );
+	}
+
+	double Read( const Case& c, const std::vector<char>& data )
+	{
+		double bestMs = 0.0;
+		for ( int run = 0; run < c_runs; run++ )
+		{
+			vsTestStopwatch watch;
+			vsFile file( c.filename, vsFile::MODE_ReadCompressed );
+			double ms = watch.GetMilliseconds();
+			TEST_CHECK( file.GetLength() == data.size() && memcmp( file.GetContents(), &data[0], data.size() ) == 0 );
+			if ( run == 0 || ms < bestMs )
+				bestMs = ms;
+		}
+		return MBps( data.size(), bestMs );
+	}
+}
+
+class CompressedFileBenchGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		std::vector<Case> cases;
+		cases.push_back( { "single stream", "user/Bench_CompressedFile_single.z", vsFile::MODE_WriteCompressed, vsCodec::Type_Zlib } );
+		for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+		{
+			const vsCodec *codec = vsCodec::Get( (vsCodec::Type)t );
+			cases.push_back( { vsFormatString( "blocked, %s", codec->GetName() ),
+					vsFormatString( "user/Bench_CompressedFile_blocked_%s.z", codec->GetName() ),
+					vsFile::MODE_WriteCompressedBlocked, (vsCodec::Type)t } );
+		}
+
+		std::vector<char> data = MakeData( c_dataBytes );
+		for ( size_t i = 0; i < cases.size(); i++ )
+			Write( cases[i], data );
+
+		printf( "\nReading, MB/s:\n%-20s", "" );
+		for ( int w = 0; w < c_workerCountCount; w++ )
+			printf( " %5d workers", c_workerCounts[w] );
+		printf( "\n" );
+
+		vsJobSystem *jobs = vsJobSystem::Instance();
+		int defaultWorkers = jobs->GetWorkerCount();
+		for ( size_t i = 0; i < cases.size(); i++ )
+		{
+			// Changing the worker count logs, so print the row afterwards.
+			double speed[c_workerCountCount];
+			for ( int w = 0; w < c_workerCountCount; w++ )
+			{
+				jobs->SetWorkerCount( c_workerCounts[w] );
+				speed[w] = Read( cases[i], data );
+			}
+			printf( "%-20s", cases[i].name.c_str() );
+			for ( int w = 0; w < c_workerCountCount; w++ )
+				printf( " %13.1f", speed[w] );
+			printf( "\n" );
+		}
+		jobs->SetWorkerCount( defaultWorkers );
+
+		for ( size_t i = 0; i < cases.size(); i++ )
+			vsFile::Delete( cases[i].filename );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", CompressedFileBenchGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0], 1024*1024*384 );
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ *  Bench_DisplayList.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_DisplayList.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstdint>
+#include "VS/VS_EnableDebugNew.h"
+
+// Display list encode and decode throughput, on a frame-sized list:  the kind
+// of op mix the render queue emits for a few thousand batched draws, plus
+// some immediate-mode geometry.  Decoding reads every payload, the way a
+// renderer would.
+
+namespace
+{
+	const int c_draws = 20000;
+	const int c_passes = 200;
+
+	void Record( vsDisplayList *list )
+	{
+		vsMatrix4x4 m;
+		vsVector3D vertex[4] = { vsVector3D(0,0,0), vsVector3D(1,0,0), vsVector3D(0,1,0), vsVector3D(1,1,0) };
+		int index[6] = { 0, 1, 2, 2, 1, 3 };
+		for ( int i = 0; i < c_draws; i++ )
+		{
+			// Nothing dereferences these;  they only need to be distinct.
+			m.w.x = (float)i;
+			list->SetMaterial( reinterpret_cast<vsMaterial*>( (uintptr_t)(0x1000 + (i>>4)*16) ) );
+			list->SetColor( c_white );
+			list->PushMatrix4x4( m );
+			if ( i & 3 )
+			{
+				list->BindBuffer( reinterpret_cast<vsRenderBuffer*>( (uintptr_t)0x2000 ) );
+				list->TriangleListBuffer( reinterpret_cast<vsRenderBuffer*>( (uintptr_t)0x3000 ) );
+				list->ClearArrays();
+			}
+			else
+			{
+				list->VertexArray( vertex, 4 );
+				list->TriangleListArray( index, 6 );
+				list->ClearVertexArray();
+			}
+			list->PopTransform();
+		}
+	}
+
+	double Decode( const vsDisplayList& list, int *opCount )
+	{
+		double sum = 0.0;
+		int ops = 0;
+		vsDisplayList::Iterator it = list.GetOps();
+		for ( vsDisplayList::OpView op = it.Next(); op.IsValid(); op = it.Next() )
+		{
+			switch ( op.GetType() )
+			{
+				case vsDisplayList::OpCode_PushMatrix4x4:
+					sum += op.Get<vsMatrix4x4>().w.x;
+					break;
+				case vsDisplayList::OpCode_SetColor:
+					sum += op.Get<vsColor>().r;
+					break;
+				case vsDisplayList::OpCode_SetMaterial:
+				case vsDisplayList::OpCode_BindBuffer:
+				case vsDisplayList::OpCode_TriangleListBuffer:
+					sum += (double)(uintptr_t)op.GetPointer<void>();
+					break;
+				case vsDisplayList::OpCode_VertexArray:
+					sum += op.GetArray<vsVector3D>()[1].x + op.GetArrayCount<vsVector3D>();
+					break;
+				case vsDisplayList::OpCode_TriangleListArray:
+					sum += op.GetArray<uint16_t>()[2] + op.GetArrayCount<uint16_t>();
+					break;
+				default:
+					break;
+			}
+			ops++;
+		}
+		*opCount = ops;
+		return sum;
+	}
+}
+
+int main()
+{
+	vsDisplayList list( 16 * 1024 * 1024 );
+
+	vsTestStopwatch watch;
+	for ( int pass = 0; pass < c_passes; pass++ )
+	{
+		list.Clear();
+		Record( &list );
+	}
+	double recordMs = watch.GetMilliseconds() / c_passes;
+
+	int opCount = 0;
+	double checksum = 0.0;
+	watch.Reset();
+	for ( int pass = 0; pass < c_passes; pass++ )
+		checksum += Decode( list, &opCount );
+	double decodeMs = watch.GetMilliseconds() / c_passes;
+
+	printf( "%d ops, %d bytes per list\n", opCount, (int)list.GetSize() );
+	printf( "record:  %6.3f ms/list  %6.1f Mops/s\n", recordMs, opCount / (recordMs * 1000.0) );
+	printf( "decode:  %6.3f ms/list  %6.1f Mops/s  (checksum %g)\n", decodeMs, opCount / (decodeMs * 1000.0), checksum );
+	return 0;
+}
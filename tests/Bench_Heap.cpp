@@ -0,0 +1,376 @@
+/*
+ *  Bench_Heap.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Heap.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Allocator throughput:  a random mix of mostly-small allocations and frees
+// with a working set of up to 30000 live blocks, timing each call.  Reports
+// median and tail latencies for vsHeap, with the system malloc alongside for
+// comparison.  Then the same sort of churn on 1, 2, 4 and 8 threads sharing
+// one heap, to show how well the per-thread caches keep them off the lock.
+//
+// Last, replays a generated trace shaped like a game's allocations:  each of
+// a few levels loads big long-lived assets, then runs frames of short-lived
+// scratch allocations, entities being spawned and killed, and arrays growing
+// by reallocation, then unloads.  A few allocations outlive their level.  We
+// time the replay on vsHeap and malloc, and at each checkpoint print vsHeap's
+// fragmentation:  the largest free block against the total free bytes.
+
+namespace
+{
+	const int c_operations = 2000000;
+
+	struct Timings
+	{
+		std::vector<double> alloc;
+		std::vector<double> free;
+	};
+
+	double Percentile( std::vector<double>& v, double p )
+	{
+		if ( v.empty() )
+			return 0.0;
+		return v[ (size_t)( p * (v.size()-1) ) ];
+	}
+
+	void Report( const char *name, Timings& t, double totalMs )
+	{
+		std::sort( t.alloc.begin(), t.alloc.end() );
+		std::sort( t.free.begin(), t.free.end() );
+		printf( "%-8s  %7.1f ms   alloc p50 %4.0f p99 %5.0f p99.9 %6.0f ns   free p50 %4.0f p99 %5.0f ns\n",
+				name, totalMs,
+				Percentile( t.alloc, 0.5 ), Percentile( t.alloc, 0.99 ), Percentile( t.alloc, 0.999 ),
+				Percentile( t.free, 0.5 ), Percentile( t.free, 0.99 ) );
+	}
+
+	template<typename AllocFn, typename FreeFn>
+	void Run( const char *name, AllocFn allocFn, FreeFn freeFn )
+	{
+		std::vector< std::pair<char*,size_t> > live;
+		live.reserve( 40000 );
+		Timings t;
+		t.alloc.reserve( c_operations );
+		t.free.reserve( c_operations );
+
+		uint32_t seed = 1;
+		vsTestStopwatch total;
+		for ( int i = 0; i < c_operations; i++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			uint32_t r = seed >> 8;
+			if ( live.size() < 100 || ( (r % 100) < 50 && live.size() < 30000 ) )
+			{
+				size_t size = ( r % 8 == 0 ) ? 1 + (r >> 3) % 65536 : 1 + (r >> 3) % 256;
+				vsTestStopwatch w;
+				char *p = (char*)allocFn( size );
+				t.alloc.push_back( w.GetNanoseconds() );
+				p[0] = p[size-1] = 1;
+				live.push_back( std::make_pair( p, size ) );
+			}
+			else
+			{
+				size_t index = (r >> 3) % live.size();
+				char *p = live[index].first;
+				live[index] = live.back();
+				live.pop_back();
+				vsTestStopwatch w;
+				freeFn( p );
+				t.free.push_back( w.GetNanoseconds() );
+			}
+		}
+		for ( size_t i = 0; i < live.size(); i++ )
+			freeFn( live[i].first );
+		Report( name, t, total.GetMilliseconds() );
+	}
+
+	void Churn( vsHeap *heap, uint32_t seed, int count )
+	{
+		std::vector<void*> live;
+		live.reserve( 4096 );
+		for ( int i = 0; i < count; i++ )
+		{
+			seed = seed * 1103515245 + 12345;
+			if ( live.size() < 64 || ( (seed >> 16) % 2 && live.size() < 4096 ) )
+			{
+				size_t size = (seed >> 8) % 200 + 1;
+				char *p = (char*)heap->Alloc( size, __FILE__, __LINE__, Type_Malloc );
+				p[0] = p[size-1] = 1;
+				live.push_back( p );
+			}
+			else
+			{
+				size_t index = (seed >> 4) % live.size();
+				heap->Free( live[index], Type_Malloc );
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+		for ( size_t i = 0; i < live.size(); i++ )
+			heap->Free( live[i], Type_Malloc );
+		vsHeap::FlushThreadCache();
+	}
+
+	void RunThreaded( vsHeap *heap, int threadCount )
+	{
+		const int count = 2000000;
+		vsTestStopwatch watch;
+		std::vector<std::thread> threads;
+		for ( int i = 0; i < threadCount; i++ )
+			threads.emplace_back( Churn, heap, (uint32_t)(i+1), count );
+		for ( size_t i = 0; i < threads.size(); i++ )
+			threads[i].join();
+		double ms = watch.GetMilliseconds();
+		printf( "%d threads:  %6.1f Mops/s\n", threadCount, threadCount * (double)count / (ms * 1000.0) );
+	}
+
+	// One allocation or free in a trace.  'size' is zero for a free.
+	struct TraceOp
+	{
+		uint32_t	id;
+		uint32_t	size;
+	};
+
+	struct Checkpoint
+	{
+		size_t		op;		// report before replaying this op
+		vsString	name;
+	};
+
+	typedef std::pair<uint32_t,uint32_t> TraceBlock;	// id, size
+
+	class TraceBuilder
+	{
+		uint32_t	m_seed;
+		uint32_t	m_nextId;
+		size_t		m_liveBytes;
+		size_t		m_liveBlocks;
+
+	public:
+		std::vector<TraceOp>	ops;
+		std::vector<Checkpoint>	checkpoints;
+		size_t					peakBytes;
+		size_t					peakBlocks;
+
+		TraceBuilder(): m_seed(7), m_nextId(0), m_liveBytes(0), m_liveBlocks(0), peakBytes(0), peakBlocks(0) {}
+
+		uint32_t Random( uint32_t low, uint32_t high )
+		{
+			m_seed = m_seed * 1103515245 + 12345;
+			return low + (m_seed >> 8) % ( high - low + 1 );
+		}
+
+		TraceBlock Alloc( uint32_t size )
+		{
+			TraceOp op = { m_nextId++, size };
+			ops.push_back( op );
+			m_liveBytes += size;
+			m_liveBlocks++;
+			peakBytes = std::max( peakBytes, m_liveBytes );
+			peakBlocks = std::max( peakBlocks, m_liveBlocks );
+			return std::make_pair( op.id, size );
+		}
+
+		void Free( const TraceBlock& block )
+		{
+			TraceOp op = { block.first, 0 };
+			ops.push_back( op );
+			m_liveBytes -= block.second;
+			m_liveBlocks--;
+		}
+
+		void AddCheckpoint( const vsString& name )
+		{
+			checkpoints.push_back( { ops.size(), name } );
+		}
+	};
+
+	void BuildTrace( TraceBuilder *t )
+	{
+		const int c_levels = 3;
+		const int c_frames = 600;
+		const int c_arrays = 12;
+		const size_t c_maxEntities = 1500;
+
+		std::vector<TraceBlock> persistent;
+		for ( int level = 0; level < c_levels; level++ )
+		{
+			// Assets:  textures and models, plus lots of little level objects.
+			std::vector<TraceBlock> assets;
+			for ( int i = 0; i < 600; i++ )
+				assets.push_back( t->Alloc( t->Random( 1024, 256 * 1024 ) ) );
+			for ( int i = 0; i < 20000; i++ )
+				assets.push_back( t->Alloc( t->Random( 16, 256 ) ) );
+			t->AddCheckpoint( vsFormatString( "level %d loaded", level ) );
+
+			std::vector< std::vector<TraceBlock> > entities;
+			std::vector<TraceBlock> arrays;
+			for ( int i = 0; i < c_arrays; i++ )
+				arrays.push_back( t->Alloc( 64 ) );
+
+			for ( int frame = 0; frame < c_frames; frame++ )
+			{
+				// Spawn a few entities of a few blocks each, and kill random
+				// ones to stay under the cap.  Now and then, something an
+				// entity allocated outlives the level (a log line, a stat for
+				// the save game).
+				int spawns = t->Random( 2, 8 );
+				for ( int s = 0; s < spawns; s++ )
+				{
+					std::vector<TraceBlock> entity;
+					int parts = t->Random( 2, 4 );
+					for ( int p = 0; p < parts; p++ )
+						entity.push_back( t->Alloc( t->Random( 64, 2048 ) ) );
+					if ( t->Random( 0, 99 ) == 0 )
+						persistent.push_back( t->Alloc( t->Random( 32, 512 ) ) );
+					entities.push_back( entity );
+				}
+				while ( entities.size() > c_maxEntities || ( !entities.empty() && t->Random( 0, 3 ) == 0 ) )
+				{
+					size_t index = t->Random( 0, (uint32_t)entities.size()-1 );
+					for ( size_t p = 0; p < entities[index].size(); p++ )
+						t->Free( entities[index][p] );
+					entities[index] = entities.back();
+					entities.pop_back();
+				}
+
+				// Arrays grow by allocating a bigger buffer, then freeing the
+				// old one.  They're cleared back to small every so often.
+				for ( int a = 0; a < c_arrays; a++ )
+				{
+					if ( t->Random( 0, 19 ) != 0 )
+						continue;
+					uint32_t size = ( arrays[a].second >= 512 * 1024 ) ? 64 : arrays[a].second * 2;
+					TraceBlock grown = t->Alloc( size );
+					t->Free( arrays[a] );
+					arrays[a] = grown;
+				}
+
+				// Scratch memory for the frame:  strings, temporary arrays.
+				std::vector<TraceBlock> scratch;
+				int scratchCount = t->Random( 100, 300 );
+				for ( int s = 0; s < scratchCount; s++ )
+					scratch.push_back( t->Alloc( t->Random( 0, 15 ) == 0 ? t->Random( 1024, 8192 ) : t->Random( 8, 512 ) ) );
+				for ( size_t s = 0; s < scratch.size(); s++ )
+					t->Free( scratch[s] );
+			}
+			t->AddCheckpoint( vsFormatString( "level %d played", level ) );
+
+			for ( size_t i = 0; i < entities.size(); i++ )
+				for ( size_t p = 0; p < entities[i].size(); p++ )
+					t->Free( entities[i][p] );
+			for ( size_t i = 0; i < arrays.size(); i++ )
+				t->Free( arrays[i] );
+			for ( size_t i = 0; i < assets.size(); i++ )
+				t->Free( assets[i] );
+			t->AddCheckpoint( vsFormatString( "level %d unloaded", level ) );
+		}
+		for ( size_t i = 0; i < persistent.size(); i++ )
+			t->Free( persistent[i] );
+	}
+
+	template<typename AllocFn, typename FreeFn, typename CheckpointFn>
+	double Replay( const TraceBuilder& trace, AllocFn allocFn, FreeFn freeFn, CheckpointFn checkpointFn )
+	{
+		std::vector<char*> block( trace.ops.size() );
+		size_t checkpoint = 0;
+		double ms = 0.0;
+		vsTestStopwatch watch;
+		for ( size_t i = 0; i < trace.ops.size(); i++ )
+		{
+			if ( checkpoint < trace.checkpoints.size() && trace.checkpoints[checkpoint].op == i )
+			{
+				ms += watch.GetMilliseconds();
+				checkpointFn( trace.checkpoints[checkpoint].name );
+				checkpoint++;
+				watch.Reset();
+			}
+
+			const TraceOp& op = trace.ops[i];
+			if ( op.size )
+			{
+				char *p = (char*)allocFn( op.size );
+				p[0] = p[op.size-1] = 1;
+				block[op.id] = p;
+			}
+			else
+				freeFn( block[op.id] );
+		}
+		return ms + watch.GetMilliseconds();
+	}
+
+	void RunTrace()
+	{
+		TraceBuilder trace;
+		BuildTrace( &trace );
+		printf( "\nTrace:  %zu operations, peak %.1fMB live\n", trace.ops.size(), trace.peakBytes / (1024.0 * 1024.0) );
+
+		// Give the heap some room over the trace's peak (and each block's
+		// header and rounding), but not so much that the untouched end of it
+		// hides any fragmentation.
+		size_t peak = trace.peakBytes + trace.peakBlocks * ( sizeof(memBlock) + 32 );
+		vsHeap *heap = new vsHeap( "trace", peak + peak / 4 );
+		double heapMs = Replay( trace,
+				[heap]( size_t size ) { return heap->Alloc( size, __FILE__, __LINE__, Type_Malloc ); },
+				[heap]( void *p ) { heap->Free( p, Type_Malloc ); },
+				[heap]( const vsString& name )
+				{
+					// Cached blocks would count as used;  hand them back first.
+					vsHeap::FlushThreadCache();
+					size_t freeBytes = heap->GetFreeBytes();
+					size_t largest = heap->GetLargestFreeBlock();
+					printf( "  %-18s %8.1fMB free, largest block %8.1fMB  (%5.1f%% fragmentation)\n", name.c_str(),
+							freeBytes / (1024.0 * 1024.0), largest / (1024.0 * 1024.0),
+							freeBytes ? 100.0 - 100.0 * largest / freeBytes : 0.0 );
+				} );
+		vsHeap::FlushThreadCache();
+		heap->CheckForLeaks();
+		delete heap;
+
+		double mallocMs = Replay( trace,
+				[]( size_t size ) { return ::malloc( size ); },
+				[]( void *p ) { ::free( p ); },
+				[]( const vsString& ) {} );
+
+		printf( "Replay:  vsHeap %.1f ms, malloc %.1f ms\n", heapMs, mallocMs );
+	}
+}
+
+int main()
+{
+	new vsHeap( "root", 512 * 1024 * 1024 );
+	vsHeap *heap = new vsHeap( "bench", 256 * 1024 * 1024 );
+
+	Run( "vsHeap",
+			[heap]( size_t size ) { return heap->Alloc( size, __FILE__, __LINE__, Type_Malloc ); },
+			[heap]( void *p ) { heap->Free( p, Type_Malloc ); } );
+	vsHeap::FlushThreadCache();
+	heap->PrintStatus();
+
+	Run( "malloc",
+			[]( size_t size ) { return ::malloc( size ); },
+			[]( void *p ) { ::free( p ); } );
+
+	for ( int threadCount = 1; threadCount <= 8; threadCount *= 2 )
+		RunThreaded( heap, threadCount );
+	heap->CheckForLeaks();
+
+	RunTrace();
+
+	return 0;
+}
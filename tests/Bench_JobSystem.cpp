@@ -0,0 +1,77 @@
+/*
+ *  Bench_JobSystem.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_JobSystem.h"
+#include "VS_Thread.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Job system scaling:  how long a compute-bound ParallelFor takes with
+// different numbers of workers, and the overhead of submitting and running
+// a job which does nothing.
+
+namespace
+{
+	std::atomic<int> s_count;
+	void Increment( void* )
+	{
+		s_count++;
+	}
+}
+
+int main()
+{
+	vsThread_Init();
+
+	const int size = 1 << 22;
+	std::vector<float> out( size );
+	auto kernel = [&]( int start, int end ) {
+		for ( int i = start; i < end; i++ )
+		{
+			float x = i * 0.001f;
+			for ( int k = 0; k < 16; k++ )
+				x = sinf(x) + 1.f;
+			out[i] = x;
+		}
+	};
+
+	const int workerCounts[] = { 0, 1, 3, 7, 15 };
+	for ( int workers : workerCounts )
+	{
+		vsJobSystem jobs( workers );
+
+		jobs.ParallelFor( 0, size, 4096, kernel );	// warm up
+		vsTestStopwatch watch;
+		for ( int rep = 0; rep < 5; rep++ )
+			jobs.ParallelFor( 0, size, 4096, kernel );
+		double parallelForMs = watch.GetMilliseconds() / 5;
+
+		const int jobCount = 100000;
+		vsJobCounter counter;
+		watch.Reset();
+		for ( int i = 0; i < jobCount; i++ )
+		{
+			jobs.Run( Increment, nullptr, &counter );
+			if ( (i & 1023) == 1023 )
+				jobs.Wait( &counter );
+		}
+		jobs.Wait( &counter );
+		double jobUs = 1000.0 * watch.GetMilliseconds() / jobCount;
+
+		printf( "%2d workers:  ParallelFor %7.2f ms   empty job %6.3f us\n", workers, parallelForMs, jobUs );
+	}
+
+	vsThread_Deinit();
+	return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ *  Bench_Octree.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Camera.h"
+#include "VS_Model.h"
+#include "VS_Octree.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// A vsOctree full of small models, a tenth of which move each frame, viewed
+// by a camera which turns a little each frame.  Times building the tree,
+// updating the models which moved, and culling.  Cameras need a screen, so
+// this runs inside a headless game.
+
+namespace
+{
+	const int c_modelCount = 100000;
+	const int c_frames = 100;
+
+	uint32_t s_seed = 12345;
+	float Random( float min, float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return min + (max - min) * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	vsVector3D RandomVector( float range )
+	{
+		return vsVector3D( Random(-range,range), Random(-range,range), Random(-range,range) );
+	}
+
+	// Counts its draws, instead of drawing.
+	int s_drawCount = 0;
+	class CountedModel : public vsModel
+	{
+	public:
+		virtual void Draw( vsRenderQueue *queue ) { UNUSED(queue); s_drawCount++; }
+	};
+
+	void Run( int levels )
+	{
+		const float range = 1000.f;
+		std::vector<CountedModel*> model( c_modelCount );
+		std::vector<vsVector3D> velocity( c_modelCount );
+		for ( int i = 0; i < c_modelCount; i++ )
+		{
+			float size = Random( 0.5f, 5.f );
+			model[i] = new CountedModel;
+			model[i]->SetBoundingBox( vsBox3D( vsVector3D(-size,-size,-size), vsVector3D(size,size,size) ) );
+			model[i]->SetPosition( RandomVector( range ) );
+			velocity[i] = RandomVector( 2.f );
+		}
+
+		vsTestStopwatch watch;
+		vsOctree octree( vsBox3D( vsVector3D(-range,-range,-range), vsVector3D(range,range,range) ), levels );
+		std::vector<vsOctreeModelInfo*> info( c_modelCount );
+		for ( int i = 0; i < c_modelCount; i++ )
+			info[i] = octree.AddModel( model[i] );
+		double buildMs = watch.GetMilliseconds();
+
+		vsCamera3D camera;
+		camera.SetNearPlane( 0.1f );
+		camera.SetFarPlane( 1000.f );
+
+		const int moversPerFrame = c_modelCount / 10;
+		double updateMs = 0.0, drawMs = 0.0;
+		long drawn = 0, nodesDrawn = 0;
+		for ( int frame = 0; frame < c_frames; frame++ )
+		{
+			float angle = frame * 0.01f;
+			camera.SetOrientation( vsQuaternion( vsVector3D( vsSin(angle), 0.f, vsCos(angle) ), vsVector3D( 0.f, 1.f, 0.f ) ) );
+
+			int first = ( frame * moversPerFrame ) % c_modelCount;
+			for ( int k = 0; k < moversPerFrame; k++ )
+			{
+				int i = ( first + k ) % c_modelCount;
+				model[i]->SetPosition( model[i]->GetPosition() + velocity[i] );
+			}
+
+			watch.Reset();
+			for ( int k = 0; k < moversPerFrame; k++ )
+				octree.UpdateModel( info[ ( first + k ) % c_modelCount ] );
+			updateMs += watch.GetMilliseconds();
+
+			s_drawCount = 0;
+			watch.Reset();
+			octree.Draw( &camera, nullptr );
+			drawMs += watch.GetMilliseconds();
+			drawn += s_drawCount;
+			nodesDrawn += octree.GetNodesDrawn();
+		}
+
+		printf( "%d levels:  build %7.2f ms | update %6.3f ms/frame | cull %6.3f ms/frame | %6ld models, %5ld nodes drawn per frame\n",
+				levels, buildMs, updateMs / c_frames, drawMs / c_frames, drawn / c_frames, nodesDrawn / c_frames );
+
+		for ( int i = 0; i < c_modelCount; i++ )
+		{
+			octree.RemoveModel( info[i] );
+			vsDelete( model[i] );
+		}
+	}
+}
+
+class OctreeBenchGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+		for ( int levels = 3; levels <= 6; levels++ )
+			Run( levels );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", OctreeBenchGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ *  Bench_RecordParse.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_File.h"
+#include "VS_Record.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstdarg>
+#include <cstring>
+#include <string>
+#include "VS/VS_EnableDebugNew.h"
+
+// Times reading records out of a ~50MB text file shaped like a model file:
+// lots of fragments, each with a vertex buffer and a triangle list.  We read
+// it as lots of top-level records and as one huge record, with and without
+// arena mode, and print a hash of everything we parsed so that runs can be
+// compared against each other.  vsFile needs the engine's file system, so
+// this runs inside a headless game.
+
+namespace
+{
+	const size_t c_fileBytes = 50 * 1024 * 1024;
+	const char *c_recordsFile = "user/Bench_RecordParse_records.txt";
+	const char *c_bigFile = "user/Bench_RecordParse_big.txt";
+	const int c_runs = 3;
+
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	void Append( std::string *text, const char *format, ... )
+	{
+		char line[256];
+		va_list args;
+		va_start( args, format );
+		vsnprintf( line, sizeof(line), format, args );
+		va_end( args );
+		*text += line;
+	}
+
+	std::string Generate()
+	{
+		std::string text;
+		text.reserve( c_fileBytes + 64 * 1024 );
+		for ( int fragment = 0; text.size() < c_fileBytes; fragment++ )
+		{
+			Append( &text, "Fragment\n{\n\tMaterial \"material_%d\"\n\tPNBuffer\n\t{\n", fragment % 17 );
+			for ( int v = 0; v < 500; v++ )
+			{
+				float x = (Random() % 10000) * 0.01f - 50.f;
+				float y = v * 0.125f;
+				float z = -(float)(Random() % 777) * 0.5f;
+				Append( &text, "\t\t%f %f %f %f %f %f\n", x, y, z, 0.f, 1.f, 0.f );
+			}
+			Append( &text, "\t}\n\tTriangleList\n\t{\n" );
+			for ( int i = 0; i < 100; i++ )
+				Append( &text, "\t\t%d %d %d %d %d %d\n", i, i+1, i+2, i+2, i+1, i+3 );
+			Append( &text, "\t}\n\t# a comment line, which should be ignored\n" );
+			Append( &text, "\tflags 3 = enabled, label_with_underscores, -7 +2.5 odd@token\n}\n" );
+		}
+		return text;
+	}
+
+	void WriteFile( const char *filename, const std::string& text )
+	{
+		vsFile file( filename, vsFile::MODE_Write );
+		file.WriteBytes( text.data(), text.size() );
+	}
+
+	uint64_t Hash( vsRecord *record, uint64_t hash )
+	{
+		vsString label = record->GetLabel().AsString();
+		for ( size_t i = 0; i < label.size(); i++ )
+			hash = hash * 131 + label[i];
+		hash = hash * 31 + record->GetTokenCount();
+		for ( int i = 0; i < record->GetTokenCount(); i++ )
+		{
+			const vsToken& token = record->GetToken(i);
+			hash = hash * 31 + token.GetType();
+			if ( token.IsType( vsToken::Type_Float ) )
+			{
+				float f = token.AsFloat();
+				uint32_t bits;
+				memcpy( &bits, &f, sizeof(bits) );
+				hash = hash * 31 + bits;
+			}
+			else if ( token.IsType( vsToken::Type_Integer ) )
+				hash = hash * 31 + (uint32_t)token.AsInteger();
+			else
+			{
+				vsString string = token.AsString();
+				for ( size_t c = 0; c < string.size(); c++ )
+					hash = hash * 131 + string[c];
+			}
+		}
+		for ( int i = 0; i < record->GetChildCount(); i++ )
+			hash = Hash( record->GetChild(i), hash );
+		return hash;
+	}
+
+	void Run( const char *name, const char *filename, size_t bytes, bool arena )
+	{
+		double bestMs = 0.0;
+		uint64_t hash = 0;
+		int count = 0;
+		for ( int run = 0; run < c_runs; run++ )
+		{
+			vsTestStopwatch watch;
+			vsFile file( filename, vsFile::MODE_Read );
+			vsRecord record;
+			record.SetArenaMode( arena );
+			count = 0;
+			hash = 0;
+			while ( file.Record( &record ) )
+			{
+				count++;
+				hash = Hash( &record, hash );
+			}
+			double ms = watch.GetMilliseconds();
+			if ( run == 0 || ms < bestMs )
+				bestMs = ms;
+		}
+		printf( "%-24s %6d records, hash %016llx:  %8.1f ms  %6.1f MB/s\n",
+				name, count, (unsigned long long)hash, bestMs, bytes / ( 1024.0 * 1024.0 ) / ( bestMs / 1000.0 ) );
+	}
+
+	void RunLongLine()
+	{
+		vsString line;
+		for ( int i = 0; i < 20000; i++ )
+			line += "1.5 2 label \"str\" ";
+
+		vsTestStopwatch watch;
+		vsRecord record;
+		record.ParseString( line );
+		printf( "ParseString of a %dKB line:  %d tokens, %.1f ms\n",
+				(int)(line.size() / 1024), record.GetTokenCount(), watch.GetMilliseconds() );
+	}
+}
+
+class RecordParseBenchGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		std::string text = Generate();
+		WriteFile( c_recordsFile, text );
+		WriteFile( c_bigFile, "Root\n{\n" + text + "}\n" );
+		printf( "%.1fMB record file\n", text.size() / ( 1024.0 * 1024.0 ) );
+
+		Run( "many records", c_recordsFile, text.size(), false );
+		Run( "many records, arena", c_recordsFile, text.size(), true );
+		Run( "one big record", c_bigFile, text.size(), false );
+		Run( "one big record, arena", c_bigFile, text.size(), true );
+		RunLongLine();
+
+		vsFile::Delete( c_recordsFile );
+		vsFile::Delete( c_bigFile );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", RecordParseBenchGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return 0;
+}
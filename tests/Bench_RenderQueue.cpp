@@ -0,0 +1,128 @@
+/*
+ *  Bench_RenderQueue.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_DisplayList.h"
+#include "VS_DynamicMaterial.h"
+#include "VS_FrameArena.h"
+#include "VS_RenderQueue.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Times the CPU side of a vsRenderQueue frame:  submitting batches, sorting
+// them, and drawing them into a display list.  Each case submits 'elements'
+// elements per material, in a shuffled order, like a scene full of entities
+// would.
+
+namespace
+{
+	const int c_frames = 200;
+
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	struct Case
+	{
+		const char *	name;
+		int				materials;
+		int				elements;	// per material
+		bool			zSort;
+	};
+
+	void Run( const Case& c, vsDisplayList *elementList )
+	{
+		std::vector<vsDynamicMaterial*> material;
+		for ( int i = 0; i < c.materials; i++ )
+		{
+			material.push_back( new vsDynamicMaterial );
+			material.back()->SetLayer( Random() % 8 );
+			material.back()->SetZSort( c.zSort );
+		}
+
+		std::vector<int> order;
+		std::vector<vsMatrix4x4> matrix;
+		for ( int i = 0; i < c.materials * c.elements; i++ )
+		{
+			order.push_back( Random() % c.materials );
+			vsMatrix4x4 m;
+			m.SetTranslation( vsVector3D( (float)(Random() % 1000), (float)(Random() % 1000), (float)(Random() % 1000) ) );
+			matrix.push_back( m );
+		}
+
+		vsRenderQueue queue;
+		vsDisplayList list( 1024 * 1024, true );
+		double totalMs = 0.0;
+		for ( int frame = 0; frame < c_frames; frame++ )
+		{
+			vsTestStopwatch watch;
+			queue.StartRender( vsMatrix4x4::Identity, vsMatrix4x4::Identity, vsMatrix4x4::Identity, vsBox2D() );
+			for ( size_t i = 0; i < order.size(); i++ )
+				queue.AddBatch( material[ order[i] ], matrix[i], elementList );
+			queue.Draw( &list );
+			queue.EndRender();
+			totalMs += watch.GetMilliseconds();
+
+			// The queue keeps its per-frame arrays in the frame arena, so
+			// flip it as a real frame would.
+			list.Clear();
+			vsFrameArena::Instance()->FrameRendered();
+		}
+		printf( "%-24s %5d materials x %4d elements:  %8.1f us/frame\n",
+				c.name, c.materials, c.elements, 1000.0 * totalMs / c_frames );
+
+		for ( size_t i = 0; i < material.size(); i++ )
+			vsDelete( material[i] );
+	}
+}
+
+class RenderQueueBenchGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		vsDisplayList elementList( 64 );
+		elementList.SetColor( c_white );
+
+		const Case cases[] =
+		{
+			{ "few materials", 16, 10, false },
+			{ "many materials", 128, 100, false },
+			{ "lots of materials", 512, 10, false },
+			{ "lots of everything", 512, 100, false },
+			{ "one big batch", 1, 50000, false },
+			{ "zSorted", 1, 1000, true },
+			{ "lots of zSorted", 1, 10000, true },
+			{ "tons of zSorted", 1, 50000, true },
+		};
+		for ( size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); i++ )
+			Run( cases[i], &elementList );
+
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", RenderQueueBenchGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ *  Bench_SIMD.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Box.h"
+#include "VS_Camera.h"
+#include "VS_Frustum.h"
+#include "VS_Matrix.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Times each batch math function against calling its one-at-a-time version
+// in a loop, over 100k items.  Frustums come from a camera, which needs a
+// screen, so the frustum cases run inside a headless game.
+
+namespace
+{
+	const int c_count = 100000;
+	const int c_passes = 50;
+
+	uint32_t s_seed = 12345;
+	float Random( float min, float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return min + (max - min) * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	vsVector3D RandomVector( float range )
+	{
+		return vsVector3D( Random(-range,range), Random(-range,range), Random(-range,range) );
+	}
+
+	vsMatrix4x4 RandomMatrix()
+	{
+		vsMatrix4x4 m;
+		m.x.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), 0.f );
+		m.y.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), 0.f );
+		m.z.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), 0.f );
+		m.w.Set( Random(-100.f,100.f), Random(-100.f,100.f), Random(-100.f,100.f), 1.f );
+		return m;
+	}
+
+	// Everything we compute goes in here, so the optimiser can't throw any of
+	// it away.
+	float s_sink = 0.f;
+
+	void Report( const char *name, double scalarMs, double batchMs )
+	{
+		printf( "%-24s scalar %8.1f us, batch %8.1f us  (%.1fx)\n", name,
+				1000.0 * scalarMs / c_passes, 1000.0 * batchMs / c_passes, scalarMs / batchMs );
+	}
+
+	void BenchTransformPoints()
+	{
+		vsMatrix4x4 m = RandomMatrix();
+		std::vector<vsVector3D> in( c_count ), out( c_count );
+		for ( int i = 0; i < c_count; i++ )
+			in[i] = RandomVector( 1000.f );
+
+		vsTestStopwatch watch;
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			for ( int i = 0; i < c_count; i++ )
+				out[i] = m.ApplyTo( in[i] );
+			s_sink += out[pass].x;
+		}
+		double scalarMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			m.ApplyTo( &in[0], &out[0], c_count );
+			s_sink += out[pass].x;
+		}
+		Report( "transform points", scalarMs, watch.GetMilliseconds() );
+	}
+
+	void BenchMultiplyMatrices()
+	{
+		const int count = c_count / 4;
+		vsMatrix4x4 m = RandomMatrix();
+		std::vector<vsMatrix4x4> in( count ), out( count );
+		for ( int i = 0; i < count; i++ )
+			in[i] = RandomMatrix();
+
+		vsTestStopwatch watch;
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			for ( int i = 0; i < count; i++ )
+				out[i] = m.ApplyTo( in[i] );
+			s_sink += out[pass].w.x;
+		}
+		double scalarMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			m.ApplyTo( &in[0], &out[0], count );
+			s_sink += out[pass].w.x;
+		}
+		Report( "multiply 25k matrices", scalarMs, watch.GetMilliseconds() );
+	}
+
+	void BenchBounds()
+	{
+		std::vector<vsVector3D> point( c_count );
+		for ( int i = 0; i < c_count; i++ )
+			point[i] = RandomVector( 1000.f );
+
+		vsTestStopwatch watch;
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			vsBox3D box;
+			for ( int i = 0; i < c_count; i++ )
+				box.ExpandToInclude( point[i] );
+			s_sink += box.GetMax().x;
+		}
+		double scalarMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			vsBox3D box;
+			box.ExpandToInclude( &point[0], c_count );
+			s_sink += box.GetMax().x;
+		}
+		Report( "bounds", scalarMs, watch.GetMilliseconds() );
+	}
+
+	void BenchFrustum()
+	{
+		vsCamera3D camera;
+		camera.SetNearPlane( 0.1f );
+		camera.SetFarPlane( 300.f );
+		const vsFrustum& frustum = camera.GetFrustum();
+
+		std::vector<float> x( c_count ), y( c_count ), z( c_count ), radius( c_count );
+		std::vector<vsBox3D> box( c_count );
+		for ( int i = 0; i < c_count; i++ )
+		{
+			vsVector3D center = RandomVector( 400.f );
+			x[i] = center.x;
+			y[i] = center.y;
+			z[i] = center.z;
+			radius[i] = Random( 0.f, 10.f );
+			vsVector3D extent( Random(0.f,10.f), Random(0.f,10.f), Random(0.f,10.f) );
+			box[i] = vsBox3D( center - extent, center + extent );
+		}
+		std::vector<vsFrustum::Classification> result( c_count );
+
+		vsTestStopwatch watch;
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			for ( int i = 0; i < c_count; i++ )
+				result[i] = frustum.ClassifySphere( vsVector3D( x[i], y[i], z[i] ), radius[i] );
+			s_sink += result[pass];
+		}
+		double scalarMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			frustum.ClassifySpheres( &x[0], &y[0], &z[0], &radius[0], &result[0], c_count );
+			s_sink += result[pass];
+		}
+		Report( "classify spheres", scalarMs, watch.GetMilliseconds() );
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			for ( int i = 0; i < c_count; i++ )
+				result[i] = frustum.ClassifyBox3D( box[i] );
+			s_sink += result[pass];
+		}
+		scalarMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int pass = 0; pass < c_passes; pass++ )
+		{
+			frustum.ClassifyBoxes3D( &box[0], &result[0], c_count );
+			s_sink += result[pass];
+		}
+		Report( "classify boxes", scalarMs, watch.GetMilliseconds() );
+	}
+}
+
+class SIMDBenchGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+		BenchFrustum();
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", SIMDBenchGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	BenchTransformPoints();
+	BenchMultiplyMatrices();
+	BenchBounds();
+
+	vsRunHeadless( argv[0] );
+
+	printf( "(checksum %g)\n", s_sink );
+	return 0;
+}
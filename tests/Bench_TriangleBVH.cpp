@@ -0,0 +1,129 @@
+/*
+ *  Bench_TriangleBVH.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_TriangleBVH.h"
+#include "VS_JobSystem.h"
+#include "VS_Math.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Ray queries against a bumpy heightfield:  testing every triangle (which is
+// what vsModel::CollideRay() used to do) against vsTriangleBVH, on one thread
+// and spread across the job system.
+
+namespace
+{
+	const int c_rayCount = 20000;
+
+	uint32_t s_seed = 12345;
+	float Random( float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return max * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	std::vector<vsVector3D> MakeHeightfield( int triangleCount )
+	{
+		int n = (int)sqrtf( triangleCount * 0.5f );
+		std::vector<vsVector3D> v;
+		auto h = [n]( int x, int z ) { return vsVector3D( x*100.f/n, 5.f*sinf(x*0.37f)*cosf(z*0.29f), z*100.f/n ); };
+		for ( int x = 0; x < n; x++ )
+		{
+			for ( int z = 0; z < n; z++ )
+			{
+				v.push_back( h(x,z) ); v.push_back( h(x+1,z) ); v.push_back( h(x,z+1) );
+				v.push_back( h(x+1,z) ); v.push_back( h(x+1,z+1) ); v.push_back( h(x,z+1) );
+			}
+		}
+		return v;
+	}
+
+	double RaysPerSecond( int rays, double ms )
+	{
+		return rays / ( ms * 0.001 );
+	}
+
+	void Run( int size )
+	{
+		std::vector<vsVector3D> mesh = MakeHeightfield( size );
+		int triangleCount = (int)mesh.size() / 3;
+
+		std::vector<vsTriangleBVH::Ray> rays( c_rayCount );
+		for ( int i = 0; i < c_rayCount; i++ )
+		{
+			rays[i].pos = vsVector3D( Random(100.f), 50.f, Random(100.f) );
+			rays[i].dir = vsVector3D( Random(100.f), 0.f, Random(100.f) ) - rays[i].pos;
+			rays[i].dir.Normalise();
+			rays[i].maxT = FLT_MAX;
+		}
+
+		vsTestStopwatch watch;
+		vsTriangleBVH bvh;
+		bvh.Build( &mesh[0], triangleCount );
+		double buildMs = watch.GetMilliseconds();
+
+		// Brute force gets slow quickly, so only time as many rays as we need.
+		int bruteRays = vsMin( c_rayCount, 20000000 / triangleCount );
+		int bruteHits = 0;
+		watch.Reset();
+		for ( int i = 0; i < bruteRays; i++ )
+		{
+			float best = FLT_MAX;
+			for ( int j = 0; j < triangleCount; j++ )
+			{
+				float t, u, w;
+				if ( vsCollideRayVsTriangle( rays[i].pos, rays[i].dir, mesh[j*3], mesh[j*3+1], mesh[j*3+2], &t, &u, &w ) && t < best )
+					best = t;
+			}
+			if ( best < FLT_MAX )
+				bruteHits++;
+		}
+		double bruteMs = watch.GetMilliseconds();
+
+		std::vector<vsTriangleBVH::Hit> hit( c_rayCount );
+		watch.Reset();
+		for ( int i = 0; i < c_rayCount; i++ )
+			bvh.CollideRay( rays[i], &hit[i] );
+		double closestMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int i = 0; i < c_rayCount; i++ )
+			bvh.CollideRayAny( rays[i], &hit[i] );
+		double anyMs = watch.GetMilliseconds();
+
+		double batchMs = 0.0;
+		int workers = 0;
+		{
+			vsJobSystem jobs;
+			workers = jobs.GetWorkerCount();
+			watch.Reset();
+			bvh.CollideRays( &rays[0], &hit[0], c_rayCount );
+			batchMs = watch.GetMilliseconds();
+		}
+
+		printf( "%6d triangles, %6d nodes, build %7.2f ms\n", triangleCount, bvh.GetNodeCount(), buildMs );
+		printf( "    brute force   %10.0f rays/s  (%d of %d hit)\n", RaysPerSecond( bruteRays, bruteMs ), bruteHits, bruteRays );
+		printf( "    closest       %10.0f rays/s\n", RaysPerSecond( c_rayCount, closestMs ) );
+		printf( "    any           %10.0f rays/s\n", RaysPerSecond( c_rayCount, anyMs ) );
+		printf( "    CollideRays   %10.0f rays/s  (%d workers)\n", RaysPerSecond( c_rayCount, batchMs ), workers );
+	}
+}
+
+int main()
+{
+	const int sizes[] = { 1000, 10000, 100000, 1000000 };
+	for ( size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++ )
+		Run( sizes[i] );
+	return 0;
+}
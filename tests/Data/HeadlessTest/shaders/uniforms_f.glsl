@@ -0,0 +1,14 @@
+#version 330
+// 'tint' is set on the material;  'pulse' comes from the material's parent
+// values, or is bound to a variable.
+uniform float tint;
+uniform float pulse;
+
+in vec4 frontColor;
+out vec4 fragColor[2];
+
+void main(void)
+{
+	fragColor[0] = frontColor * tint * pulse;
+	fragColor[1] = vec4(0.0, 0.0, 0.0, 1.0);
+}
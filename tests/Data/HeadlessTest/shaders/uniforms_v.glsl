@@ -0,0 +1,16 @@
+#version 330
+uniform mat4 worldToView;
+uniform mat4 viewToProjection;
+uniform vec4 universal_color;
+
+in mat4 localToWorldAttrib;
+in vec4 vertex;
+in vec4 color;
+
+out vec4 frontColor;
+
+void main(void)
+{
+	frontColor = universal_color * color;
+	gl_Position = viewToProjection * worldToView * localToWorldAttrib * vertex;
+}
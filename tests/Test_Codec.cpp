@@ -0,0 +1,152 @@
+/*
+ *  Test_Codec.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Codec.h"
+#include "VS_Store.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+#include "VS/VS_EnableDebugNew.h"
+
+// Round trips data through every vsCodec, both directly and through
+// vsStore::Compress() and Expand(), and checks that they reject data which
+// doesn't decompress to exactly the length they were told to expect.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	// Vaguely save game-like text;  very compressible.
+	std::vector<char> MakeText( size_t length )
+	{
+		const char *words[] = { "position", "velocity", "health", "name", "enemy", "tile", "flags", "colour", "{", "}", "\n" };
+		const int wordCount = sizeof(words) / sizeof(words[0]);
+
+		std::vector<char> data;
+		data.reserve( length );
+		while ( data.size() < length )
+		{
+			uint32_t r = Random();
+			vsString token = vsFormatString( "%s %u ", words[ r % wordCount ], r % 10000 );
+			for ( size_t i = 0; i < token.size() && data.size() < length; i++ )
+				data.push_back( token[i] );
+		}
+		return data;
+	}
+
+	// Random bytes;  won't compress at all, so the output is bigger than the
+	// input.
+	std::vector<char> MakeNoise( size_t length )
+	{
+		std::vector<char> data( length );
+		for ( size_t i = 0; i < length; i++ )
+			data[i] = (char)Random();
+		return data;
+	}
+
+	void TestCodec( const vsCodec *codec, const std::vector<char>& data )
+	{
+		// Leave room to check that we don't write past the end, and give
+		// empty vectors somewhere to point.
+		std::vector<char> packed( codec->GetMaxCompressedLength( data.size() ) + 1 );
+		size_t packedLength = codec->Compress( data.data(), data.size(), &packed[0], packed.size() - 1 );
+		TEST_CHECK( packedLength > 0 && packedLength < packed.size() );
+
+		std::vector<char> unpacked( data.size() + 1, 'x' );
+		TEST_CHECK( codec->Decompress( &packed[0], packedLength, &unpacked[0], data.size() ) );
+		TEST_CHECK( data.empty() || memcmp( &unpacked[0], data.data(), data.size() ) == 0 );
+		TEST_CHECK( unpacked[ data.size() ] == 'x' );
+
+		// Asking for the wrong length must fail.
+		TEST_CHECK( !codec->Decompress( &packed[0], packedLength, &unpacked[0], data.size() + 1 ) );
+		if ( !data.empty() )
+		{
+			TEST_CHECK( !codec->Decompress( &packed[0], packedLength, &unpacked[0], data.size() - 1 ) );
+			TEST_CHECK( !codec->Decompress( &packed[0], packedLength / 2, &unpacked[0], data.size() ) );
+		}
+	}
+
+	void TestStore( const vsCodec *codec, const std::vector<char>& data )
+	{
+		vsStore store( data.size() + 16 );
+		store.WriteBuffer( data.data(), data.size() );
+		TEST_CHECK( store.Compress( codec ) );
+		TEST_CHECK( store.Expand() );
+		TEST_CHECK( store.Length() == data.size() );
+		TEST_CHECK( data.empty() || memcmp( store.GetReadHead(), data.data(), data.size() ) == 0 );
+	}
+
+	void TestBareZlibStore( const std::vector<char>& data )
+	{
+		// What vsStore::Compress() wrote before there were codecs:  a zlib
+		// stream with no header of our own.  Expand() must still read it.
+		uLongf length = compressBound( (uLong)data.size() );
+		vsStore store( length );
+		TEST_CHECK( compress( (Bytef*)store.GetWriteHead(), &length, (const Bytef*)data.data(), (uLong)data.size() ) == Z_OK );
+		store.AdvanceWriteHead( length );
+		TEST_CHECK( store.Expand() );
+		TEST_CHECK( store.Length() == data.size() );
+		TEST_CHECK( memcmp( store.GetReadHead(), data.data(), data.size() ) == 0 );
+	}
+}
+
+int main()
+{
+	const size_t sizes[] = { 0, 1, 1000, 65536, 1024*1024+7 };
+	for ( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ )
+	{
+		std::vector<char> text = MakeText( sizes[s] );
+		std::vector<char> noise = MakeNoise( sizes[s] );
+		for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+		{
+			const vsCodec *codec = vsCodec::Get( (vsCodec::Type)t );
+			TestCodec( codec, text );
+			TestCodec( codec, noise );
+			TestStore( codec, text );
+			TestStore( codec, noise );
+		}
+		if ( !text.empty() )
+			TestBareZlibStore( text );
+	}
+
+	// Compressed data records its codec's tag, so every codec needs its own.
+	for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+	{
+		const vsCodec *codec = vsCodec::Get( (vsCodec::Type)t );
+		TEST_CHECK( vsCodec::FindByTag( codec->GetTag() ) == codec );
+	}
+	TEST_CHECK( vsCodec::FindByTag( '?' ) == nullptr );
+
+	// Compress() with too little room must fail cleanly.
+	std::vector<char> noise = MakeNoise( 1000 );
+	char tiny[16];
+	for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+		TEST_CHECK( vsCodec::Get( (vsCodec::Type)t )->Compress( noise.data(), noise.size(), tiny, sizeof(tiny) ) == 0 );
+
+	// And a store compressed with a non-default codec must expand no matter
+	// what the default is now.
+	std::vector<char> text = MakeText( 5000 );
+	vsStore store( text.size() );
+	store.WriteBuffer( text.data(), text.size() );
+	vsCodec::SetDefault( vsCodec::Type_LZ4 );
+	TEST_CHECK( store.Compress() );
+	vsCodec::SetDefault( vsCodec::Type_Zlib );
+	TEST_CHECK( store.Expand() );
+	TEST_CHECK( store.Length() == text.size() && memcmp( store.GetReadHead(), text.data(), text.size() ) == 0 );
+
+	return vsTestResult();
+}
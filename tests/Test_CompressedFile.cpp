@@ -0,0 +1,164 @@
+/*
+ *  Test_CompressedFile.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Codec.h"
+#include "VS_File.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Writes compressed files in both the single stream and the blocked formats
+// (with each codec), and reads them back through both compressed read modes.
+// Blocked files decompress their blocks in parallel on the engine's job
+// system.  vsFile needs the engine's file system, so this runs inside a
+// headless game.
+
+namespace
+{
+	const char *c_singleFile = "user/Test_CompressedFile_single.z";
+	const char *c_blockedFile = "user/Test_CompressedFile_blocked.z";
+
+	// Vaguely save game-like text, which compresses about 4:1.
+	std::vector<char> MakeData( size_t length )
+	{
+		const char *words[] = { "position", "velocity", "health", "name", "enemy", "tile", "flags", "colour", "{", "}", "\n" };
+		const int wordCount = sizeof(words) / sizeof(words[0]);
+
+		std::vector<char> data;
+		data.reserve( length );
+		uint32_t seed = 12345;
+		while ( data.size() < length )
+		{
+			seed = seed * 1103515245 + 12345;
+			vsString token = vsFormatString( "%s %u ", words[ (seed >> 16) % wordCount ], (seed >> 8) % 10000 );
+			for ( size_t i = 0; i < token.size() && data.size() < length; i++ )
+				data.push_back( token[i] );
+		}
+		return data;
+	}
+
+	void Write( const char *filename, vsFile::Mode mode, const std::vector<char>& data, size_t chunk )
+	{
+		vsFile file( filename, mode );
+		for ( size_t i = 0; i < data.size(); i += chunk )
+			file.WriteBytes( &data[i], vsMin( chunk, data.size() - i ) );
+	}
+
+	bool ReadsBack( const char *filename, const std::vector<char>& data )
+	{
+		vsFile file( filename, vsFile::MODE_ReadCompressed );
+		return file.IsOK() && file.GetLength() == data.size() &&
+			( data.empty() || memcmp( file.GetContents(), &data[0], data.size() ) == 0 );
+	}
+
+	bool ReadsBackProgressively( const char *filename, const std::vector<char>& data, size_t chunk )
+	{
+		vsFile file( filename, vsFile::MODE_ReadCompressed_Progressive );
+		std::vector<char> buffer( chunk );
+		size_t position = 0;
+		while ( 1 )
+		{
+			int bytes = file.ReadBytes( &buffer[0], chunk );
+			if ( bytes <= 0 )
+				break;
+			if ( position + bytes > data.size() || memcmp( &buffer[0], &data[position], bytes ) != 0 )
+				return false;
+			position += bytes;
+		}
+		return position == data.size();
+	}
+
+	void TestRoundTrip()
+	{
+		// Including sizes which don't fill the last block, and empty files.
+		const size_t sizes[] = { 0, 1, 1000, 256*1024, 256*1024+1, 3*1024*1024+17 };
+		const size_t writeChunks[] = { 7, 4096, 1024*1024 };
+		const size_t readChunks[] = { 333, 64*1024 };
+
+		for ( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ )
+		{
+			std::vector<char> data = MakeData( sizes[s] );
+			for ( size_t w = 0; w < sizeof(writeChunks)/sizeof(writeChunks[0]); w++ )
+			{
+				vsString error;
+				Write( c_singleFile, vsFile::MODE_WriteCompressed, data, writeChunks[w] );
+				TEST_CHECK( ReadsBack( c_singleFile, data ) );
+				for ( size_t r = 0; r < sizeof(readChunks)/sizeof(readChunks[0]); r++ )
+					TEST_CHECK( ReadsBackProgressively( c_singleFile, data, readChunks[r] ) );
+				TEST_CHECK( vsFile::IsCompressedFileValid( c_singleFile, error ) );
+
+				// Blocked files can use any codec.
+				for ( int t = 0; t < vsCodec::Type_MAX; t++ )
+				{
+					vsCodec::SetDefault( (vsCodec::Type)t );
+					Write( c_blockedFile, vsFile::MODE_WriteCompressedBlocked, data, writeChunks[w] );
+					TEST_CHECK( ReadsBack( c_blockedFile, data ) );
+					for ( size_t r = 0; r < sizeof(readChunks)/sizeof(readChunks[0]); r++ )
+						TEST_CHECK( ReadsBackProgressively( c_blockedFile, data, readChunks[r] ) );
+					TEST_CHECK( vsFile::IsCompressedFileValid( c_blockedFile, error ) );
+				}
+				vsCodec::SetDefault( vsCodec::Type_Zlib );
+			}
+		}
+	}
+
+	void TestCorruptBlock()
+	{
+		// A damaged block must make the read fail, not crash or hand back
+		// garbage.
+		std::vector<char> data = MakeData( 1024*1024 );
+		Write( c_blockedFile, vsFile::MODE_WriteCompressedBlocked, data, data.size() );
+
+		std::vector<char> compressed;
+		{
+			vsFile file( c_blockedFile, vsFile::MODE_Read );
+			compressed.assign( file.GetContents(), file.GetContents() + file.GetLength() );
+		}
+		TEST_CHECK( compressed.size() > 5002 );
+		compressed[5000] ^= 0x55;
+		compressed[5001] ^= 0xAA;
+		Write( c_blockedFile, vsFile::MODE_Write, compressed, compressed.size() );
+
+		vsString error;
+		TEST_CHECK( !vsFile::IsCompressedFileValid( c_blockedFile, error ) );
+		vsFile file( c_blockedFile, vsFile::MODE_ReadCompressed );
+		TEST_CHECK( !file.IsOK() );
+	}
+}
+
+class CompressedFileTestGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		TestRoundTrip();
+		TestCorruptBlock();
+
+		vsFile::Delete( c_singleFile );
+		vsFile::Delete( c_blockedFile );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", CompressedFileTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
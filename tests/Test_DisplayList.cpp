@@ -0,0 +1,364 @@
+/*
+ *  Test_DisplayList.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_DisplayList.h"
+#include "VS_Transform.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Round trips ops through vsDisplayList's encoding:  everything we write must
+// decode to the same op type and payload, every op must start four-byte
+// aligned, and ops too big for the 24-bit size in the op header must still
+// decode (and not throw off the ops after them).
+//
+// Then checks which ops Optimise() removes and merges, and that the ops which
+// survive still draw every index with the same color, material, matrix and
+// bound buffer as before.
+
+namespace
+{
+	std::vector<vsDisplayList::OpView> Ops( const vsDisplayList& list )
+	{
+		std::vector<vsDisplayList::OpView> result;
+		vsDisplayList::Iterator it = list.GetOps();
+		for ( vsDisplayList::OpView op = it.Next(); op.IsValid(); op = it.Next() )
+			result.push_back( op );
+		return result;
+	}
+
+	void TestRoundTrip()
+	{
+		vsMaterial *material = reinterpret_cast<vsMaterial*>( (uintptr_t)0x12345678 );
+		vsMatrix4x4 matrix;
+		matrix.SetTranslation( vsVector3D(1.f, 2.f, 3.f) );
+		vsMatrix4x4 matrices[4];
+		vsVector2D vertex2D[3] = { vsVector2D(1.f,2.f), vsVector2D(3.f,4.f), vsVector2D(5.f,6.f) };
+		vsVector2D texel[3] = { vsVector2D(0.f,0.f), vsVector2D(1.f,0.f), vsVector2D(0.f,1.f) };
+		vsColor color[3] = { c_red, c_green, c_blue };
+		int index[7] = { 0, 1, 2, 2, 1, 0, 65535 };
+
+		vsDisplayList list( 4096 );
+		list.SetColor( c_red );
+		list.SetMaterial( material );
+		list.PushTranslation( vsVector3D(4.f, 5.f, 6.f) );
+		list.PushMatrix4x4( matrix );
+		list.SetMatrices4x4( matrices, 4 );
+		list.VertexArray( vertex2D, 3 );
+		list.TexelArray( texel, 3 );
+		list.ColorArray( color, 3 );
+		list.TriangleListArray( index, 7 );	// odd-sized payload;  must be padded
+		list.TriangleListArray( index, 3 );
+		list.ClearArrays();
+		list.PopTransform();
+		list.PopTransform();
+
+		std::vector<vsDisplayList::OpView> op = Ops( list );
+		TEST_CHECK( op.size() == 13 );
+		if ( op.size() != 13 )
+			return;
+
+		for ( size_t i = 0; i < op.size(); i++ )
+			TEST_CHECK( ( (op[i].GetData() - op[0].GetData()) & 3 ) == 0 );
+
+		TEST_CHECK( op[0].GetType() == vsDisplayList::OpCode_SetColor && op[0].Get<vsColor>() == c_red );
+		TEST_CHECK( op[1].GetType() == vsDisplayList::OpCode_SetMaterial && op[1].GetPointer<vsMaterial>() == material );
+		TEST_CHECK( op[2].GetType() == vsDisplayList::OpCode_PushTranslation && op[2].Get<vsVector3D>() == vsVector3D(4.f, 5.f, 6.f) );
+		TEST_CHECK( op[3].GetType() == vsDisplayList::OpCode_PushMatrix4x4 && op[3].Get<vsMatrix4x4>() == matrix );
+
+		TEST_CHECK( op[4].GetType() == vsDisplayList::OpCode_SetMatrices4x4 );
+		TEST_CHECK( op[4].GetPointer<vsMatrix4x4>() == matrices && op[4].Get<uint32_t>( sizeof(void*) ) == 4 );
+
+		// 2D vertices are promoted to 3D as they're written.
+		TEST_CHECK( op[5].GetType() == vsDisplayList::OpCode_VertexArray && op[5].GetArrayCount<vsVector3D>() == 3 );
+		for ( int i = 0; i < 3; i++ )
+			TEST_CHECK( op[5].GetArray<vsVector3D>()[i] == vsVector3D( vertex2D[i].x, vertex2D[i].y, 0.f ) );
+
+		TEST_CHECK( op[6].GetType() == vsDisplayList::OpCode_TexelArray && op[6].GetArrayCount<vsVector2D>() == 3 );
+		TEST_CHECK( op[6].GetArray<vsVector2D>()[1] == texel[1] );
+		TEST_CHECK( op[7].GetType() == vsDisplayList::OpCode_ColorArray && op[7].GetArrayCount<vsColor>() == 3 );
+		TEST_CHECK( op[7].GetArray<vsColor>()[2] == c_blue );
+
+		TEST_CHECK( op[8].GetType() == vsDisplayList::OpCode_TriangleListArray && op[8].GetArrayCount<uint16_t>() == 7 );
+		for ( int i = 0; i < 7; i++ )
+			TEST_CHECK( op[8].GetArray<uint16_t>()[i] == index[i] );
+		TEST_CHECK( op[9].GetType() == vsDisplayList::OpCode_TriangleListArray && op[9].GetArrayCount<uint16_t>() == 3 );
+
+		TEST_CHECK( op[10].GetType() == vsDisplayList::OpCode_ClearArrays && op[10].GetPayloadSize() == 0 );
+		TEST_CHECK( op[11].GetType() == vsDisplayList::OpCode_PopTransform );
+		TEST_CHECK( op[12].GetType() == vsDisplayList::OpCode_PopTransform );
+
+		// Appending copies every op exactly.
+		vsDisplayList copy( 4096 );
+		copy.Append( list );
+		std::vector<vsDisplayList::OpView> copied = Ops( copy );
+		TEST_CHECK( copied.size() == op.size() && copy.GetSize() == list.GetSize() );
+		for ( size_t i = 0; i < copied.size() && i < op.size(); i++ )
+		{
+			TEST_CHECK( copied[i].GetSize() == op[i].GetSize() );
+			TEST_CHECK( memcmp( copied[i].GetData(), op[i].GetData(), op[i].GetSize() ) == 0 );
+		}
+	}
+
+	void CheckBigOps( vsDisplayList& list, const char *what, int opCount, int firstIndexCount, int secondIndexCount )
+	{
+		std::vector<vsDisplayList::OpView> op = Ops( list );
+		TEST_CHECK( op.size() == (size_t)opCount );
+		if ( op.size() != (size_t)opCount )
+		{
+			fprintf( stderr, "%s:  %d ops\n", what, (int)op.size() );
+			return;
+		}
+
+		TEST_CHECK( op[1].GetType() == vsDisplayList::OpCode_VertexArray && op[1].GetArrayCount<vsVector3D>() == 2000000 );
+		const vsVector3D *vertex = op[1].GetArray<vsVector3D>();
+		TEST_CHECK( vertex[0].y == 1.f && vertex[1999999].x == 1999999.f );
+
+		TEST_CHECK( op[2].GetArrayCount<uint16_t>() == firstIndexCount );
+		TEST_CHECK( op[2].GetArray<uint16_t>()[8999999] == 8999999 % 65536 );
+		TEST_CHECK( op[3].GetArrayCount<uint16_t>() == secondIndexCount );
+
+		// If we'd misread a big op's size, we'd have lost our place by now.
+		TEST_CHECK( op.back().GetType() == vsDisplayList::OpCode_SetColor && op.back().Get<vsColor>() == c_red );
+	}
+
+	void TestBigOps()
+	{
+		// 2M vertices is 24MB of payload, and 9M indices is 18MB;  both
+		// more than a 24-bit size can hold.
+		vsDisplayList list( 64 * 1024 * 1024 );
+		std::vector<vsVector3D> vertex( 2000000 );
+		for ( size_t i = 0; i < vertex.size(); i++ )
+			vertex[i].Set( (float)i, 1.f, 2.f );
+		std::vector<int> index( 9000000 );
+		for ( size_t i = 0; i < index.size(); i++ )
+			index[i] = (int)(i % 65536);
+
+		list.SetColor( c_white );
+		list.VertexArray( &vertex[0], (int)vertex.size() );
+		list.TriangleListArray( &index[0], (int)index.size() );
+		list.TriangleListArray( &index[0], 3 );
+		list.TriangleListArray( &index[0], 3 );
+		list.SetColor( c_red );
+		CheckBigOps( list, "written", 6, 9000000, 3 );
+
+		// Optimise() merges the two small index lists, and has to copy the
+		// big ops across as it goes.
+		list.Optimise();
+		CheckBigOps( list, "optimised", 5, 9000000, 6 );
+	}
+
+	// The state an index was drawn with, according to the ops before it.
+	struct DrawnIndex
+	{
+		bool			colorSet;
+		vsColor			color;
+		vsMaterial *	material;
+		vsMatrix4x4		matrix;
+		vsRenderBuffer *buffer;
+		uint16_t		index;
+
+		bool operator==( const DrawnIndex& o ) const
+		{
+			return colorSet == o.colorSet && ( !colorSet || color == o.color ) &&
+				material == o.material && matrix == o.matrix &&
+				buffer == o.buffer && index == o.index;
+		}
+	};
+
+	// Plays the handful of ops these tests use, well enough to see what state
+	// each draw would have used.  (A material may set its own color, so a
+	// SetMaterial leaves the color unset.)
+	std::vector<DrawnIndex> Play( const vsDisplayList& list )
+	{
+		std::vector<DrawnIndex> result;
+		std::vector<vsMatrix4x4> stack( 1, vsMatrix4x4::Identity );
+		DrawnIndex state;
+		state.colorSet = false;
+		state.material = nullptr;
+		state.buffer = nullptr;
+		state.index = 0;
+
+		vsDisplayList::Iterator it = list.GetOps();
+		for ( vsDisplayList::OpView op = it.Next(); op.IsValid(); op = it.Next() )
+		{
+			switch ( op.GetType() )
+			{
+				case vsDisplayList::OpCode_SetColor:
+					state.colorSet = true;
+					state.color = op.Get<vsColor>();
+					break;
+				case vsDisplayList::OpCode_SetMaterial:
+					state.material = op.GetPointer<vsMaterial>();
+					state.colorSet = false;
+					break;
+				case vsDisplayList::OpCode_PushTranslation:
+					{
+						vsMatrix4x4 translation;
+						translation.SetTranslation( op.Get<vsVector3D>() );
+						stack.push_back( stack.back() * translation );
+						break;
+					}
+				case vsDisplayList::OpCode_PushTransform:
+					stack.push_back( stack.back() * op.Get<vsTransform2D>().GetMatrix() );
+					break;
+				case vsDisplayList::OpCode_PushMatrix4x4:
+					stack.push_back( stack.back() * op.Get<vsMatrix4x4>() );
+					break;
+				case vsDisplayList::OpCode_PopTransform:
+					stack.pop_back();
+					break;
+				case vsDisplayList::OpCode_BindBuffer:
+					state.buffer = op.GetPointer<vsRenderBuffer>();
+					break;
+				case vsDisplayList::OpCode_UnbindBuffer:
+					if ( state.buffer == op.GetPointer<vsRenderBuffer>() )
+						state.buffer = nullptr;
+					break;
+				case vsDisplayList::OpCode_TriangleListArray:
+					state.matrix = stack.back();
+					for ( int i = 0; i < op.GetArrayCount<uint16_t>(); i++ )
+					{
+						state.index = op.GetArray<uint16_t>()[i];
+						result.push_back( state );
+					}
+					break;
+				default:
+					break;
+			}
+		}
+		return result;
+	}
+
+	void CheckOptimise( vsDisplayList& list, const char *what, int expectedRemoved, const std::vector<vsDisplayList::OpCode>& expectedOps )
+	{
+		std::vector<DrawnIndex> before = Play( list );
+		int removed = list.Optimise();
+		std::vector<DrawnIndex> after = Play( list );
+		std::vector<vsDisplayList::OpView> op = Ops( list );
+
+		bool ok = ( removed == expectedRemoved && op.size() == expectedOps.size() );
+		for ( size_t i = 0; ok && i < op.size(); i++ )
+			ok = ( op[i].GetType() == expectedOps[i] );
+		TEST_CHECK( ok );
+		if ( !ok )
+		{
+			fprintf( stderr, "%s:  removed %d, left", what, removed );
+			for ( size_t i = 0; i < op.size(); i++ )
+				fprintf( stderr, " %d", (int)op[i].GetType() );
+			fprintf( stderr, "\n" );
+		}
+		TEST_CHECK( before.size() == after.size() && before == after );
+	}
+
+	void TestOptimiseColors()
+	{
+		vsMaterial *material = reinterpret_cast<vsMaterial*>( (uintptr_t)0x12345678 );
+		vsVector3D vertex[3];
+		int index[3] = { 0, 1, 2 };
+
+		vsDisplayList list( 4096 );
+		list.SetColor( c_red );				// nothing draws with it:  removed
+		list.SetColor( c_green );
+		list.VertexArray( vertex, 3 );
+		list.TriangleListArray( index, 3 );
+		list.SetColor( c_green );			// already green:  removed
+		list.TriangleListArray( index, 3 );	// nothing left between the draws:  merged
+		list.SetMaterial( material );
+		list.SetColor( c_green );			// the material may have changed the color:  kept
+		list.TriangleListArray( index, 3 );	// kept ops in between:  not merged
+
+		std::vector<vsDisplayList::OpCode> expected = {
+			vsDisplayList::OpCode_SetColor,
+			vsDisplayList::OpCode_VertexArray,
+			vsDisplayList::OpCode_TriangleListArray,
+			vsDisplayList::OpCode_SetMaterial,
+			vsDisplayList::OpCode_SetColor,
+			vsDisplayList::OpCode_TriangleListArray
+		};
+		CheckOptimise( list, "colors", 3, expected );
+
+		std::vector<vsDisplayList::OpView> op = Ops( list );
+		if ( op.size() == expected.size() )
+		{
+			TEST_CHECK( op[0].Get<vsColor>() == c_green );
+			TEST_CHECK( op[2].GetArrayCount<uint16_t>() == 6 && op[5].GetArrayCount<uint16_t>() == 3 );
+		}
+	}
+
+	void TestOptimiseTransforms()
+	{
+		vsVector3D vertex[3];
+		int index[3] = { 0, 1, 2 };
+
+		vsDisplayList list( 4096 );
+		list.PushTranslation( vsVector3D(1.f, 2.f, 3.f) );
+		list.PushTranslation( vsVector3D::Zero );		// identity:  removed with its pop
+		list.VertexArray( vertex, 3 );
+		list.TriangleListArray( index, 3 );
+		list.PopTransform();
+		list.PushMatrix4x4( vsMatrix4x4::Identity );	// identity:  removed with its pop
+		list.TriangleListArray( index, 3 );				// merged
+		list.PopTransform();
+		list.PushTransform( vsTransform2D() );			// identity, but never popped:  kept
+		list.TriangleListArray( index, 3 );				// not merged across the push
+
+		std::vector<vsDisplayList::OpCode> expected = {
+			vsDisplayList::OpCode_PushTranslation,
+			vsDisplayList::OpCode_VertexArray,
+			vsDisplayList::OpCode_TriangleListArray,
+			vsDisplayList::OpCode_PushTransform,
+			vsDisplayList::OpCode_TriangleListArray
+		};
+		CheckOptimise( list, "transforms", 5, expected );
+	}
+
+	void TestOptimiseBuffers()
+	{
+		vsRenderBuffer *a = reinterpret_cast<vsRenderBuffer*>( (uintptr_t)0x1000 );
+		vsRenderBuffer *b = reinterpret_cast<vsRenderBuffer*>( (uintptr_t)0x2000 );
+		int index[3] = { 0, 1, 2 };
+
+		vsDisplayList list( 4096 );
+		list.BindBuffer( a );
+		list.TriangleListArray( index, 3 );
+		list.UnbindBuffer( a );				// the next BindBuffer unbinds it anyway:  removed
+		list.BindBuffer( b );
+		list.TriangleListArray( index, 3 );
+		list.UnbindBuffer( b );				// drawn with:  kept
+		list.TriangleListArray( index, 3 );
+		list.BindBuffer( b );
+		list.BindBuffer( b );				// already bound:  removed
+
+		std::vector<vsDisplayList::OpCode> expected = {
+			vsDisplayList::OpCode_BindBuffer,
+			vsDisplayList::OpCode_TriangleListArray,
+			vsDisplayList::OpCode_BindBuffer,
+			vsDisplayList::OpCode_TriangleListArray,
+			vsDisplayList::OpCode_UnbindBuffer,
+			vsDisplayList::OpCode_TriangleListArray,
+			vsDisplayList::OpCode_BindBuffer
+		};
+		CheckOptimise( list, "buffers", 2, expected );
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestBigOps();
+	TestOptimiseColors();
+	TestOptimiseTransforms();
+	TestOptimiseBuffers();
+	return vsTestResult();
+}
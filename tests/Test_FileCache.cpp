@@ -0,0 +1,308 @@
+/*
+ *  Test_FileCache.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_FileCache.h"
+#include "VS_MappedFile.h"
+#include "VS_Store.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Drives vsFileCache directly, without vsFile:  least recently used files
+// must be evicted first once we're over the byte budget, a file bigger than
+// the whole budget must not be cached, an entry evicted while someone holds
+// it must stay readable until they release it, and an entry made from a
+// vsMappedFile must share the mapping rather than copy it.  Then eight
+// threads load, hit, and purge a set of files bigger than the budget at once.
+// Finally, prints what a hit on a 256KB file costs compared to copying it, as
+// vsFile used to on every hit.
+
+namespace
+{
+	const size_t c_kb = 1024;
+
+	vsString Name( int i )
+	{
+		return vsFormatString( "levels/chunk%03d.win", i );
+	}
+
+	// A file's contents are 'length' bytes of its number, so that a reader can
+	// tell whose contents it's been given.
+	vsStore* Load( int i, size_t length )
+	{
+		vsStore *store = new vsStore( length );
+		memset( store->GetWriteHead(), i & 0xff, length );
+		store->AdvanceWriteHead( length );
+		return store;
+	}
+
+	void InsertAndRelease( const vsString& name, vsStore *store )
+	{
+		vsFileCache::Release( vsFileCache::Insert( name, store ) );
+	}
+
+	bool IsCached( const vsString& name )
+	{
+		vsFileCacheEntry *entry = vsFileCache::Acquire( name );
+		if ( entry )
+			vsFileCache::Release( entry );
+		return entry != nullptr;
+	}
+
+	void TestLRU()
+	{
+		// Ten files of 100KB into a 512KB budget leaves the last five.
+		vsFileCache::Startup( 512 * c_kb );
+		for ( int i = 0; i < 10; i++ )
+			InsertAndRelease( Name(i), Load( i, 100 * c_kb ) );
+
+		vsFileCache::Stats stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 5 );
+		TEST_CHECK( stats.bytes == 5 * 100 * c_kb );
+		TEST_CHECK( stats.evictions == 5 );
+		TEST_CHECK( stats.insertions == 10 );
+		TEST_CHECK( stats.budget == 512 * c_kb );
+		for ( int i = 0; i < 10; i++ )
+			TEST_CHECK( IsCached( Name(i) ) == ( i >= 5 ) );
+
+		// The loop above touched 5 through 9 in order, leaving 5 least
+		// recently used.  Touch it again, and the next insertion must evict 6.
+		TEST_CHECK( IsCached( Name(5) ) );
+		InsertAndRelease( Name(10), Load( 10, 100 * c_kb ) );
+		TEST_CHECK( IsCached( Name(5) ) );
+		TEST_CHECK( !IsCached( Name(6) ) );
+		TEST_CHECK( IsCached( Name(7) ) );
+
+		stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 5 && stats.evictions == 6 );
+		vsFileCache::Shutdown();
+	}
+
+	void TestBudget()
+	{
+		vsFileCache::Startup( 512 * c_kb );
+
+		// Exactly at budget is fine.
+		InsertAndRelease( Name(0), Load( 0, 256 * c_kb ) );
+		InsertAndRelease( Name(1), Load( 1, 256 * c_kb ) );
+		vsFileCache::Stats stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 2 && stats.bytes == 512 * c_kb && stats.evictions == 0 );
+
+		// One byte over evicts the oldest.
+		InsertAndRelease( Name(2), Load( 2, 1 ) );
+		stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 2 && stats.bytes == 256 * c_kb + 1 && stats.evictions == 1 );
+		TEST_CHECK( !IsCached( Name(0) ) );
+
+		// A file bigger than the whole budget is handed back to its loader,
+		// and doesn't disturb anything that's already cached.
+		vsFileCacheEntry *huge = vsFileCache::Insert( "huge.win", Load( 7, 1024 * c_kb ) );
+		TEST_CHECK( huge && huge->GetLength() == 1024 * c_kb && huge->GetData()[0] == 7 );
+		vsFileCache::Release( huge );
+		stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 2 && stats.bytes == 256 * c_kb + 1 && stats.evictions == 1 );
+		TEST_CHECK( !IsCached( "huge.win" ) );
+
+		// Shrinking the budget evicts down to it.
+		vsFileCache::SetBudget( 256 * c_kb );
+		stats = vsFileCache::GetStats();
+		TEST_CHECK( stats.entries == 1 && stats.bytes == 1 );
+		TEST_CHECK( IsCached( Name(2) ) );
+		vsFileCache::Shutdown();
+	}
+
+	void TestEvictionWhileAcquired()
+	{
+		vsFileCache::Startup( 512 * c_kb );
+		InsertAndRelease( Name(5), Load( 5, 100 * c_kb ) );
+
+		vsFileCacheEntry *held = vsFileCache::Acquire( Name(5) );
+		TEST_CHECK( held && held->GetData()[0] == 5 );
+
+		// Push it out of the cache by budget, then purge everything else.
+		for ( int i = 0; i < 6; i++ )
+			InsertAndRelease( Name(10+i), Load( 10+i, 100 * c_kb ) );
+		TEST_CHECK( !IsCached( Name(5) ) );
+		vsFileCache::Purge();
+		TEST_CHECK( vsFileCache::GetStats().entries == 0 && vsFileCache::GetStats().bytes == 0 );
+
+		if ( held )
+		{
+			TEST_CHECK( held->GetLength() == 100 * c_kb );
+			TEST_CHECK( held->GetData()[0] == 5 && held->GetData()[100 * c_kb - 1] == 5 );
+			TEST_CHECK( held->GetFilename() == Name(5) );
+			vsFileCache::Release( held );
+		}
+
+		// Replacing a held entry is just as safe.
+		InsertAndRelease( Name(1), Load( 1, c_kb ) );
+		held = vsFileCache::Acquire( Name(1) );
+		InsertAndRelease( Name(1), Load( 2, c_kb ) );
+		TEST_CHECK( held && held->GetData()[0] == 1 );
+		vsFileCacheEntry *replaced = vsFileCache::Acquire( Name(1) );
+		TEST_CHECK( replaced && replaced != held && replaced->GetData()[0] == 2 );
+		vsFileCache::Release( replaced );
+		vsFileCache::Release( held );
+		vsFileCache::Shutdown();
+	}
+
+	void TestMappedSharing()
+	{
+		const char *path = "Test_FileCache_mapped.win";
+		const size_t length = 64 * c_kb;
+		std::vector<char> contents( length );
+		for ( size_t i = 0; i < length; i++ )
+			contents[i] = (char)( i * 31 );
+		FILE *file = fopen( path, "wb" );
+		TEST_CHECK( file != nullptr );
+		if ( !file )
+			return;
+		fwrite( &contents[0], 1, length, file );
+		fclose( file );
+
+		vsFileCache::Startup( 512 * c_kb );
+		vsMappedFile *mapping = vsMappedFile::Open( path );
+		TEST_CHECK( mapping != nullptr );
+		if ( mapping )
+		{
+			vsFileCacheEntry *inserted = vsFileCache::Insert( "mapped.win", mapping );
+			const char *mapped = mapping->GetData();
+			mapping->ReleaseReference();	// now the cache's entry holds the only reference
+
+			vsFileCacheEntry *a = vsFileCache::Acquire( "mapped.win" );
+			vsFileCacheEntry *b = vsFileCache::Acquire( "mapped.win" );
+			TEST_CHECK( a == inserted && b == inserted );
+			TEST_CHECK( inserted->GetData() == mapped );
+			TEST_CHECK( inserted->GetLength() == length );
+			TEST_CHECK( memcmp( inserted->GetData(), &contents[0], length ) == 0 );
+			TEST_CHECK( vsFileCache::GetStats().bytes == length );
+
+			// Still mapped after it's left the cache, until the last release.
+			vsFileCache::Purge();
+			TEST_CHECK( memcmp( b->GetData(), &contents[0], length ) == 0 );
+			vsFileCache::Release( a );
+			vsFileCache::Release( inserted );
+			TEST_CHECK( memcmp( b->GetData(), &contents[0], length ) == 0 );
+			vsFileCache::Release( b );
+		}
+		vsFileCache::Shutdown();
+		remove( path );
+	}
+
+	void TestThreads()
+	{
+		const int c_threads = 8;
+		const int c_iterations = 50000;
+		const int c_files = 300;	// about 3.4MB of them
+
+		vsFileCache::Startup( 2 * 1024 * c_kb );
+		std::atomic<int> wrong( 0 );
+		std::atomic<bool> overBudget( false );
+
+		vsTestStopwatch watch;
+		std::vector<std::thread> threads;
+		for ( int t = 0; t < c_threads; t++ )
+		{
+			threads.emplace_back( [t, &wrong, &overBudget]{
+				uint32_t seed = t * 7919 + 1;
+				for ( int n = 0; n < c_iterations; n++ )
+				{
+					seed = seed * 1664525u + 1013904223u;
+					int i = ( seed >> 8 ) % c_files;
+					vsString name = Name(i);
+					vsFileCacheEntry *entry = vsFileCache::Acquire( name );
+					if ( !entry )
+						entry = vsFileCache::Insert( name, Load( i, 8 * c_kb + (i % 8) * c_kb ) );
+					if ( entry->GetLength() != 8 * c_kb + (i % 8) * c_kb ||
+							(uint8_t)entry->GetData()[0] != (uint8_t)i ||
+							(uint8_t)entry->GetData()[entry->GetLength()-1] != (uint8_t)i )
+						wrong++;
+					vsFileCache::Release( entry );
+
+					if ( t == 0 && n % 10000 == 0 )
+					{
+						vsFileCache::Stats stats = vsFileCache::GetStats();
+						if ( stats.bytes > stats.budget )
+							overBudget = true;
+						vsFileCache::Purge();
+					}
+				}
+			} );
+		}
+		for ( size_t i = 0; i < threads.size(); i++ )
+			threads[i].join();
+		double ms = watch.GetMilliseconds();
+
+		vsFileCache::Stats stats = vsFileCache::GetStats();
+		printf( "%d threads:  %llu hits, %llu misses, %llu evictions, %d entries, %zu of %zu bytes, %.0f ms\n",
+				c_threads, (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+				(unsigned long long)stats.evictions, stats.entries, stats.bytes, stats.budget, ms );
+
+		TEST_CHECK( wrong == 0 );
+		TEST_CHECK( !overBudget );
+		TEST_CHECK( stats.bytes <= stats.budget );
+		TEST_CHECK( stats.hits + stats.misses == (uint64_t)c_threads * c_iterations );
+		TEST_CHECK( stats.insertions == stats.misses );
+		TEST_CHECK( stats.hits > 0 && stats.evictions > 0 );
+		TEST_CHECK( stats.entries > 0 && stats.entries <= c_files );
+		vsFileCache::Shutdown();
+	}
+
+	void TimeHits()
+	{
+		const size_t length = 256 * c_kb;
+		const int c_hits = 20000;
+
+		vsFileCache::Startup();
+		InsertAndRelease( "shaders/big.glsl", Load( 3, length ) );
+		vsStore *original = Load( 3, length );
+
+		uint64_t sum = 0;
+		vsTestStopwatch watch;
+		for ( int n = 0; n < c_hits; n++ )
+		{
+			vsFileCacheEntry *entry = vsFileCache::Acquire( "shaders/big.glsl" );
+			vsStore view( const_cast<char*>(entry->GetData()), entry->GetLength() );
+			sum += view.GetBuffer()[n % 1000];
+			vsFileCache::Release( entry );
+		}
+		double sharedMs = watch.GetMilliseconds();
+
+		watch.Reset();
+		for ( int n = 0; n < c_hits; n++ )
+		{
+			vsStore copy( *original );
+			sum += copy.GetBuffer()[n % 1000];
+		}
+		double copiedMs = watch.GetMilliseconds();
+
+		TEST_CHECK( sum == 2 * 3 * (uint64_t)c_hits );
+		printf( "256KB hit:  shared %.2f us, copied %.2f us\n", sharedMs * 1000.0 / c_hits, copiedMs * 1000.0 / c_hits );
+
+		vsDelete( original );
+		vsFileCache::Shutdown();
+	}
+}
+
+int main()
+{
+	TestLRU();
+	TestBudget();
+	TestEvictionWhileAcquired();
+	TestMappedSharing();
+	TestThreads();
+	TimeHits();
+	return vsTestResult();
+}
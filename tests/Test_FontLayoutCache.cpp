@@ -0,0 +1,224 @@
+/*
+ *  Test_FontLayoutCache.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Font.h"
+#include "VS_FontLayoutCache.h"
+#include "VS_FontRenderer.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// vsFontRenderer::GetLayout() keeps the wrapped and justified layout of each
+// string it's asked for in its font's vsFontLayoutCache, keyed by the string
+// and every renderer setting which affects its layout.  Using fonts/Test.fnt
+// (a fixed width BMFont), this checks that text built from a cached layout
+// has exactly the vertices it had when its layout was new, that changing the
+// size, bounds, or justification doesn't find the old layout, and that the
+// cache's stats add up once it's full and evicting its least recently used
+// layouts.
+
+namespace
+{
+	const char *c_text = "The quick brown fox jumps over the lazy dog, AVAVA.";
+
+	struct Geometry
+	{
+		std::vector<char>	vertices;
+		std::vector<char>	indices;
+
+		bool operator==( const Geometry& o ) const { return vertices == o.vertices && indices == o.indices; }
+		bool operator!=( const Geometry& o ) const { return !(*this == o); }
+	};
+
+	Geometry Build( vsFontRenderer *renderer )
+	{
+		Geometry result;
+		vsFontFragment *fragment = renderer->Fragment2D( vsLocString(c_text) );
+		TEST_CHECK( fragment && fragment->IsSimple() );
+		if ( fragment && fragment->IsSimple() )
+		{
+			vsRenderBuffer *vbo = fragment->GetSimpleVBO();
+			vsRenderBuffer *ibo = fragment->GetSimpleIBO();
+			const char *v = (const char*)vbo->GetGenericArray();
+			const char *i = (const char*)ibo->GetGenericArray();
+			result.vertices.assign( v, v + vbo->GetGenericArraySize() );
+			result.indices.assign( i, i + ibo->GetGenericArraySize() );
+		}
+		vsDelete( fragment );
+		TEST_CHECK( !result.vertices.empty() );
+		return result;
+	}
+
+	// Counters since 'before'.
+	struct Delta
+	{
+		uint64_t hits;
+		uint64_t misses;
+	};
+
+	Delta Since( vsFontLayoutCache& cache, const vsFontLayoutCache::Stats& before )
+	{
+		vsFontLayoutCache::Stats now = cache.GetStats();
+		Delta delta = { now.hits - before.hits, now.misses - before.misses };
+		return delta;
+	}
+
+	void TestHits( vsFont *font )
+	{
+		vsFontLayoutCache& cache = font->GetLayoutCache();
+		cache.Clear();
+
+		vsFontRenderer renderer( font, 16.f, Justification_Center );
+		renderer.SetMaxWidth( 200.f );
+
+		vsFontLayoutCache::Stats before = cache.GetStats();
+		Geometry built = Build( &renderer );
+		Delta d = Since( cache, before );
+		TEST_CHECK( d.hits == 0 && d.misses == 1 );
+
+		before = cache.GetStats();
+		Geometry cached = Build( &renderer );
+		d = Since( cache, before );
+		TEST_CHECK( d.hits == 1 && d.misses == 0 );
+		TEST_CHECK( cached == built );
+
+		// And the same again from a layout built from scratch.
+		cache.Clear();
+		before = cache.GetStats();
+		Geometry rebuilt = Build( &renderer );
+		d = Since( cache, before );
+		TEST_CHECK( d.hits == 0 && d.misses == 1 );
+		TEST_CHECK( rebuilt == built );
+	}
+
+	void TestMisses( vsFont *font )
+	{
+		vsFontLayoutCache& cache = font->GetLayoutCache();
+		cache.Clear();
+
+		vsFontRenderer renderer( font, 16.f, Justification_Left );
+		renderer.SetMaxWidth( 200.f );
+		Geometry original = Build( &renderer );
+
+		// Each change must build a new layout the first time, and find it
+		// the second.
+		for ( int change = 0; change < 3; change++ )
+		{
+			switch ( change )
+			{
+				case 0: renderer.SetSize( 24.f ); break;
+				case 1: renderer.SetMaxWidthAndHeight( 120.f, 500.f ); break;
+				case 2: renderer.SetJustificationType( Justification_Right ); break;
+			}
+
+			vsFontLayoutCache::Stats before = cache.GetStats();
+			Geometry changed = Build( &renderer );
+			Delta d = Since( cache, before );
+			TEST_CHECK( d.hits == 0 && d.misses == 1 );
+			TEST_CHECK( changed != original );
+
+			before = cache.GetStats();
+			Geometry again = Build( &renderer );
+			d = Since( cache, before );
+			TEST_CHECK( d.hits == 1 && d.misses == 0 );
+			TEST_CHECK( again == changed );
+			original = changed;
+		}
+		TEST_CHECK( cache.GetStats().entries == 4 );
+	}
+
+	void TestCapacity( vsFont *font )
+	{
+		const int c_capacity = 3;
+		vsFontLayoutCache& cache = font->GetLayoutCache();
+		cache.Clear();
+		cache.ResetStats();
+		cache.SetCapacity( c_capacity );
+
+		// GetLineCount() looks up exactly one layout.  The comments give the
+		// cache's contents afterwards, most recently used first.
+		struct Step
+		{
+			const char *	text;
+			uint64_t		hits;
+			uint64_t		misses;
+			uint64_t		evictions;
+		};
+		const Step c_step[] =
+		{
+			{ "A", 0, 1, 0 },	// A
+			{ "B", 0, 2, 0 },	// B A
+			{ "C", 0, 3, 0 },	// C B A
+			{ "A", 1, 3, 0 },	// A C B
+			{ "D", 1, 4, 1 },	// D A C
+			{ "A", 2, 4, 1 },	// A D C
+			{ "C", 3, 4, 1 },	// C A D
+			{ "B", 3, 5, 2 },	// B C A
+			{ "D", 3, 6, 3 },	// D B C
+			{ "C", 4, 6, 3 },	// C D B
+			{ "A", 4, 7, 4 },	// A C D
+		};
+		const int c_stepCount = sizeof(c_step) / sizeof(c_step[0]);
+
+		vsFontRenderer renderer( font, 16.f );
+		for ( int i = 0; i < c_stepCount; i++ )
+		{
+			TEST_CHECK( renderer.GetLineCount( c_step[i].text ) == 1 );
+			vsFontLayoutCache::Stats stats = cache.GetStats();
+			bool ok = ( stats.hits == c_step[i].hits && stats.misses == c_step[i].misses &&
+					stats.evictions == c_step[i].evictions &&
+					stats.entries == vsMin( i+1, c_capacity ) && stats.capacity == c_capacity );
+			TEST_CHECK( ok );
+			if ( !ok )
+				fprintf( stderr, "Step %d (%s):  %d hits, %d misses, %d evictions, %d entries\n", i, c_step[i].text,
+						(int)stats.hits, (int)stats.misses, (int)stats.evictions, stats.entries );
+		}
+
+		// Shrinking the cache evicts the least recently used.
+		cache.SetCapacity( 1 );
+		vsFontLayoutCache::Stats stats = cache.GetStats();
+		TEST_CHECK( stats.entries == 1 && stats.evictions == 6 );
+		renderer.GetLineCount( "A" );
+		TEST_CHECK( cache.GetStats().hits == 5 );
+
+		cache.SetCapacity( vsFontLayoutCache::c_defaultCapacity );
+	}
+}
+
+class FontLayoutCacheTestGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		vsFont *font = new vsFont( "fonts/Test.txt" );
+		TestHits( font );
+		TestMisses( font );
+		TestCapacity( font );
+		vsDelete( font );
+
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", FontLayoutCacheTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,121 @@
+/*
+ *  Test_HeadlessRender.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Primitive.h"
+#include "VS_Renderer_Recording.h"
+#include "VS_Scene.h"
+#include "VS_Screen.h"
+#include "VS_Sprite.h"
+
+// Smoke test for headless mode:  starts the engine with '--headless', so that
+// it renders through vsRenderer_Recording, and runs a small game for a few
+// frames.  Every frame must draw something, and since nothing in the scene
+// moves, every frame after the first must record exactly the same commands as
+// the frame two before it.  (Not the frame before:  vsDynamicBatchManager's
+// pool hands out its batches in turn, so alternate frames draw from
+// alternate vertex buffers.)  Those identical frames mustn't make any heap
+// allocations while building and rendering their display lists, either.
+
+namespace
+{
+	const int c_frameCount = 10;
+	const int c_spriteCount = 40;
+}
+
+class HeadlessTestGame : public coreGame
+{
+	typedef coreGame Parent;
+
+	vsSprite *	m_sprite[c_spriteCount];
+	int			m_frame;
+	uint64_t	m_steadyHash[2];
+
+public:
+
+	HeadlessTestGame():
+		m_frame(0)
+	{
+		m_steadyHash[0] = m_steadyHash[1] = 0;
+		for ( int i = 0; i < c_spriteCount; i++ )
+			m_sprite[i] = nullptr;
+	}
+
+	virtual void Init()
+	{
+		Parent::Init();
+
+		TEST_CHECK( vsRenderer::IsHeadless() );
+
+		// Half opaque and half z-sorted, so that we exercise both the
+		// batched and the sorted paths through the render queue.
+		vsScene *scene = vsScreen::Instance()->GetScene(0);
+		for ( int i = 0; i < c_spriteCount; i++ )
+		{
+			const char *material = ( i % 2 ) ? "Translucent" : "White";
+			m_sprite[i] = new vsSprite;
+			m_sprite[i]->AddFragment( vsMakeSolidBox2D( vsBox2D( vsVector2D(-10.f,-10.f), vsVector2D(10.f,10.f) ), material ) );
+			m_sprite[i]->SetPosition( vsVector2D( (i % 8) * 30.f - 105.f, (i / 8) * 30.f - 60.f ) );
+			scene->RegisterEntityOnTop( m_sprite[i] );
+		}
+	}
+
+	virtual void Deinit()
+	{
+		for ( int i = 0; i < c_spriteCount; i++ )
+			vsDelete( m_sprite[i] );
+
+		Parent::Deinit();
+	}
+
+	virtual void DrawFrame()
+	{
+		Parent::DrawFrame();
+
+		vsRenderer_Recording *renderer = vsRenderer_Recording::Instance();
+		TEST_CHECK( renderer->GetLastFrameStats().draws > 0 );
+
+		// The first frame may still be uploading buffers and compiling
+		// shaders;  after that, a scene which doesn't change should render
+		// the same way every time.
+		if ( m_frame == 1 || m_frame == 2 )
+			m_steadyHash[m_frame & 1] = renderer->GetLastFrameHash();
+		else if ( m_frame > 2 )
+		{
+			TEST_CHECK( renderer->GetLastFrameHash() == m_steadyHash[m_frame & 1] );
+#if defined(VS_INTERNAL_ALLOCATORS) || defined(VS_WRAP_ALLOCATORS)
+			// (without either, allocations aren't counted at all)
+			TEST_CHECK( vsScreen::Instance()->GetRenderHeapAllocations() == 0 );
+#endif
+		}
+
+		if ( ++m_frame == c_frameCount )
+		{
+			renderer->LogStats( renderer->GetTotalStats() );
+			core::SetExit();
+		}
+	}
+
+	int GetFramesRendered() const { return m_frame; }
+};
+
+REGISTER_MAINGAME("HeadlessTest", HeadlessTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+
+	HeadlessTestGame *game = static_cast<HeadlessTestGame*>( coreGameRegistry::GetMainMenu() );
+	TEST_CHECK( game->GetFramesRendered() == c_frameCount );
+
+	return vsTestResult();
+}
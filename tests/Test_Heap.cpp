@@ -0,0 +1,138 @@
+/*
+ *  Test_Heap.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Heap.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Exercises vsHeap's size-class free lists:  lots of allocations of every
+// size class, freed in random order, checking that no two live blocks ever
+// overlap and that freed blocks coalesce back into one big free block.
+
+namespace
+{
+	struct Allocation
+	{
+		unsigned char *	ptr;
+		size_t			size;
+		unsigned char	fill;
+	};
+
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	size_t RandomSize()
+	{
+		// mostly small blocks, like the engine makes;  some up to 64k.
+		if ( Random() % 8 == 0 )
+			return 1 + Random() % 65536;
+		return 1 + Random() % 256;
+	}
+
+	bool IsIntact( const Allocation& a )
+	{
+		for ( size_t i = 0; i < a.size; i++ )
+			if ( a.ptr[i] != a.fill )
+				return false;
+		return true;
+	}
+
+	void FreeAll( vsHeap *heap, std::vector<Allocation>& live )
+	{
+		for ( size_t i = 0; i < live.size(); i++ )
+		{
+			TEST_CHECK( IsIntact( live[i] ) );
+			heap->Free( live[i].ptr, Type_Malloc );
+		}
+		live.clear();
+	}
+
+	void TestRandomAllocations( vsHeap *heap )
+	{
+		std::vector<Allocation> live;
+		for ( int i = 0; i < 200000; i++ )
+		{
+			if ( live.size() < 64 || ( Random() % 2 && live.size() < 2000 ) )
+			{
+				Allocation a;
+				a.size = RandomSize();
+				a.fill = (unsigned char)i;
+				a.ptr = (unsigned char*)heap->Alloc( a.size, __FILE__, __LINE__, Type_Malloc );
+				TEST_CHECK( a.ptr != nullptr );
+				TEST_CHECK( ((uintptr_t)a.ptr & 7) == 0 );
+				TEST_CHECK( heap->Contains( a.ptr ) && heap->Contains( a.ptr + a.size - 1 ) );
+				memset( a.ptr, a.fill, a.size );
+				live.push_back( a );
+			}
+			else
+			{
+				size_t index = Random() % live.size();
+				TEST_CHECK( IsIntact( live[index] ) );
+				heap->Free( live[index].ptr, Type_Malloc );
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+		FreeAll( heap, live );
+	}
+
+	void TestExactSizeClasses( vsHeap *heap )
+	{
+		// Every size from 1 to 4k, so that we touch every small size class
+		// and every boundary between them.
+		std::vector<Allocation> live;
+		for ( size_t size = 1; size <= 4096; size++ )
+		{
+			Allocation a;
+			a.size = size;
+			a.fill = (unsigned char)(size * 7);
+			a.ptr = (unsigned char*)heap->Alloc( size, __FILE__, __LINE__, Type_Malloc );
+			memset( a.ptr, a.fill, a.size );
+			live.push_back( a );
+		}
+		FreeAll( heap, live );
+	}
+
+	void TestCoalescing( vsHeap *heap, size_t heapSize )
+	{
+		// Everything has been freed, so after flushing our thread's cache the
+		// free blocks must have merged back together;  a block of most of the
+		// heap won't fit otherwise.
+		vsHeap::FlushThreadCache();
+		void *big = heap->Alloc( heapSize * 3 / 4, __FILE__, __LINE__, Type_Malloc );
+		TEST_CHECK( big != nullptr );
+		heap->Free( big, Type_Malloc );
+	}
+}
+
+int main()
+{
+	// The first vsHeap is allocated from the system and becomes current;  the
+	// heap we test lives inside it, the same way the game heap lives inside
+	// the global heap.
+	new vsHeap( "root", 128 * 1024 * 1024 );
+	const size_t heapSize = 32 * 1024 * 1024;
+	vsHeap *heap = new vsHeap( "test", heapSize );
+
+	TestRandomAllocations( heap );
+	TestExactSizeClasses( heap );
+	TestCoalescing( heap, heapSize );
+	heap->CheckForLeaks();
+
+	return vsTestResult();
+}
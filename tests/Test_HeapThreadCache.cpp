@@ -0,0 +1,114 @@
+/*
+ *  Test_HeapThreadCache.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Heap.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Exercises the per-thread block caches in front of vsHeap:  several threads
+// allocating from one heap at once, threads which exit without flushing
+// their caches, and a heap which is destroyed while another thread still
+// has a cache slot bound to it.
+
+namespace
+{
+	void Churn( vsHeap *heap, int count, unsigned char fill )
+	{
+		std::vector< std::pair<unsigned char*,size_t> > live;
+		for ( int i = 0; i < count; i++ )
+		{
+			size_t size = 16 + (i % 15) * 32;
+			unsigned char *p = (unsigned char*)heap->Alloc( size, __FILE__, __LINE__, Type_Malloc );
+			memset( p, fill, size );
+			live.push_back( std::make_pair( p, size ) );
+			if ( live.size() > 50 )
+			{
+				for ( size_t j = 0; j < live.size(); j++ )
+				{
+					// Another thread writing into our block would show up here.
+					TEST_CHECK( live[j].first[0] == fill && live[j].first[live[j].second-1] == fill );
+					heap->Free( live[j].first, Type_Malloc );
+				}
+				live.clear();
+			}
+		}
+		for ( size_t j = 0; j < live.size(); j++ )
+			heap->Free( live[j].first, Type_Malloc );
+	}
+
+	void TestThreadsExitWithoutFlushing( vsHeap *heap )
+	{
+		// None of these threads call FlushThreadCache();  their caches must
+		// be flushed when their thread_local storage is destroyed, or the
+		// leak check below will find the blocks still in them.
+		std::vector<std::thread> threads;
+		for ( int i = 0; i < 4; i++ )
+			threads.emplace_back( [heap, i]{ Churn( heap, 20000, (unsigned char)(i+1) ); } );
+		for ( size_t i = 0; i < threads.size(); i++ )
+			threads[i].join();
+		heap->CheckForLeaks();
+	}
+
+	void TestHeapDestroyedUnderLiveSlot( vsHeap *heap )
+	{
+		// 'holder' leaves blocks from 'heap' in its cache, then we destroy
+		// 'heap' while it's still bound.  Flushing afterwards must not touch
+		// the dead heap, and the slot must work for a new heap.
+		std::mutex mutex;
+		std::condition_variable cv;
+		int stage = 0;
+
+		std::thread holder( [&]{
+			Churn( heap, 1000, 0x5a );
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				stage = 1;
+				cv.notify_all();
+				cv.wait( lock, [&]{ return stage == 2; } );
+			}
+			vsHeap::FlushThreadCache();
+
+			vsHeap *second = new vsHeap( "second", 4 * 1024 * 1024 );
+			Churn( second, 1000, 0xa5 );
+			vsHeap::FlushThreadCache();
+			second->CheckForLeaks();
+			delete second;
+		} );
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait( lock, [&]{ return stage == 1; } );
+		}
+		delete heap;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stage = 2;
+			cv.notify_all();
+		}
+		holder.join();
+	}
+}
+
+int main()
+{
+	new vsHeap( "root", 64 * 1024 * 1024 );
+	vsHeap *heap = new vsHeap( "test", 8 * 1024 * 1024 );
+
+	TestThreadsExitWithoutFlushing( heap );
+	TestHeapDestroyedUnderLiveSlot( heap );
+
+	return vsTestResult();
+}
@@ -0,0 +1,168 @@
+/*
+ *  Test_InstanceCulling.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Camera.h"
+#include "VS_JobSystem.h"
+#include "VS_Model.h"
+#include "VS_ModelInstance.h"
+#include "VS_ModelInstanceGroup.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Shows instances of a three-lod model at three distances in front of a
+// camera, with some of them behind it or off to the side, and runs
+// vsModelInstanceGroup::Cull() on them.  Each lod must get exactly the
+// visible instances that belong to it, in the order they were shown:  first
+// those shown in the group's lod 0, then those in lod 1.  We do this with
+// automatic lod selection (where distance picks the lod) and without it
+// (where the instance's own lod does), on a group small enough to be culled
+// on the calling thread and on one big enough to be split across workers.
+
+namespace
+{
+	const int c_lodCount = 3;
+	const float c_distance[c_lodCount] = { 8.f, 30.f, 200.f };
+
+	// Our model's bounding sphere has a radius of sqrt(3), which covers
+	// about 3/distance of the screen's height with a 60 degree field of view;
+	// that's 0.375, 0.1 and 0.015 at the distances above.
+	const float c_screenSize[c_lodCount-1] = { 0.2f, 0.05f };
+
+	const int c_serialCount = 1000;
+	const int c_parallelCount = 20000;
+	const int c_workers = 3;
+
+	// Where we put instance 'i', whether the camera can see it, and which
+	// lod automatic lod selection should give it.  Positions are all
+	// different, so that the order of the results can be checked.
+	vsVector3D Place( int i, bool *visible, int *lod )
+	{
+		*lod = i % c_lodCount;
+		float d = c_distance[*lod];
+		int cell = i / c_lodCount;
+		vsVector3D position( ( (cell % 101) - 50 ) * 0.004f * d, ( ((cell / 101) % 101) - 50 ) * 0.004f * d, d );
+
+		*visible = true;
+		if ( i % 5 == 4 )
+		{
+			position.z = -d;	// behind the camera
+			*visible = false;
+		}
+		else if ( i % 7 == 6 )
+		{
+			position.x += 3.f * d;	// off to the right
+			*visible = false;
+		}
+		return position;
+	}
+
+	void RunCase( const char *what, vsModel *model, const vsCamera3D *camera, int count, bool autoLod )
+	{
+		vsModelInstanceGroup *group = new vsModelInstanceGroup( model );
+		group->SetFrustumCulling( true );
+		if ( autoLod )
+			group->SetLodScreenSizes( c_screenSize, c_lodCount-1 );
+		TEST_CHECK( group->GetLodCount() == c_lodCount );
+
+		// Instances go into the group's lod 0 or 1;  we want both to have
+		// instances that end up in every lod.
+		std::vector<vsModelInstance*> instance;
+		std::vector< std::pair<int,vsMatrix4x4> > shown[2];	// lod we expect, matrix
+		for ( int i = 0; i < count; i++ )
+		{
+			int source = ( i % 4 == 1 ) ? 1 : 0;
+			bool visible;
+			int lod;
+			vsVector3D position = Place( i, &visible, &lod );
+			vsMatrix4x4 matrix;
+			matrix.SetTranslation( position );
+			TEST_CHECK( camera->IsPositionVisible( position, 1.7320508f ) == visible );
+
+			vsModelInstance *inst = group->MakeInstance( source );
+			inst->SetMatrix( matrix, c_white );
+			inst->SetVisible( true );
+			instance.push_back( inst );
+
+			if ( visible )
+				shown[source].push_back( std::make_pair( autoLod ? lod : source, matrix ) );
+		}
+
+		group->Cull( camera );
+
+		bool ok = true;
+		for ( int l = 0; l < c_lodCount; l++ )
+		{
+			std::vector<vsMatrix4x4> expected;
+			for ( int source = 0; source < 2; source++ )
+				for ( size_t i = 0; i < shown[source].size(); i++ )
+					if ( shown[source][i].first == l )
+						expected.push_back( shown[source][i].second );
+
+			vsModelInstanceLodGroup *lod = group->GetLod(l);
+			bool lodOk = ( lod->GetCulledCount() == (int)expected.size() );
+			for ( int i = 0; lodOk && i < lod->GetCulledCount(); i++ )
+				lodOk = ( lod->GetCulledMatrices()[i] == expected[i] );
+			if ( !lodOk )
+				fprintf( stderr, "%s:  lod %d has %d instances;  expected %d\n", what, l, lod->GetCulledCount(), (int)expected.size() );
+			ok = ok && lodOk;
+		}
+		TEST_CHECK( ok );
+
+		for ( size_t i = 0; i < instance.size(); i++ )
+			vsDelete( instance[i] );
+		vsDelete( group );
+	}
+}
+
+class InstanceCullingTestGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		vsModel *model = new vsModel;
+		model->SetLodCount( c_lodCount );
+		model->SetBoundingBox( vsBox3D( vsVector3D(-1.f,-1.f,-1.f), vsVector3D(1.f,1.f,1.f) ) );
+
+		vsCamera3D *camera = new vsCamera3D;
+		camera->SetFieldOfView( DEGREES(60.f) );
+		camera->SetPosition( vsVector3D::Zero );
+		camera->LookAt( vsVector3D(0.f, 0.f, 1.f) );
+
+		RunCase( "serial", model, camera, c_serialCount, true );
+		RunCase( "serial, fixed lods", model, camera, c_serialCount, false );
+
+		vsJobSystem *jobs = vsJobSystem::Instance();
+		int defaultWorkers = jobs->GetWorkerCount();
+		jobs->SetWorkerCount( c_workers );
+		RunCase( "parallel", model, camera, c_parallelCount, true );
+		RunCase( "parallel, fixed lods", model, camera, c_parallelCount, false );
+		jobs->SetWorkerCount( defaultWorkers );
+
+		vsDelete( camera );
+		vsDelete( model );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", InstanceCullingTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,147 @@
+/*
+ *  Test_JobSystem.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_JobSystem.h"
+#include "VS_Thread.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <atomic>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Exercises vsJobSystem with no workers (everything runs on the main thread)
+// and with several:  plain jobs, more jobs than we have slots for,
+// dependency chains, fan-in, ParallelFor coverage, and ParallelFor nested
+// inside jobs, which only finishes if waiting threads help out rather than
+// block.
+
+namespace
+{
+	std::atomic<int> s_count;
+	void Increment( void* )
+	{
+		s_count++;
+	}
+
+	std::atomic<int> s_step;
+	int s_stepSeen[3];
+	void StepA( void* ) { s_stepSeen[0] = s_step++; }
+	void StepB( void* ) { s_stepSeen[1] = s_step++; }
+	void StepC( void* ) { s_stepSeen[2] = s_step++; }
+
+	void RecordCount( void *data )
+	{
+		static_cast<std::atomic<int>*>(data)->store( s_count.load() );
+	}
+
+	void TestManyJobs( vsJobSystem& jobs )
+	{
+		// More jobs than c_maxJobs, so some have to run inline.
+		s_count = 0;
+		vsJobCounter counter;
+		for ( int i = 0; i < 10000; i++ )
+			jobs.Run( Increment, nullptr, &counter );
+		jobs.Wait( &counter );
+		TEST_CHECK( s_count == 10000 );
+	}
+
+	void TestDependencyChain( vsJobSystem& jobs )
+	{
+		for ( int rep = 0; rep < 200; rep++ )
+		{
+			s_step = 0;
+			vsJobCounter a, b, c;
+			jobs.Run( StepA, nullptr, &a );
+			jobs.Run( StepB, nullptr, &b, &a );
+			jobs.Run( StepC, nullptr, &c, &b );
+			jobs.Wait( &c );
+			jobs.Wait( &b );
+			jobs.Wait( &a );
+			TEST_CHECK( s_stepSeen[0] == 0 && s_stepSeen[1] == 1 && s_stepSeen[2] == 2 );
+		}
+	}
+
+	void TestFanIn( vsJobSystem& jobs )
+	{
+		// One job which depends on many must see all of them finished.
+		for ( int rep = 0; rep < 100; rep++ )
+		{
+			s_count = 0;
+			std::atomic<int> seenAtEnd( -1 );
+			vsJobCounter many, after;
+			for ( int i = 0; i < 64; i++ )
+				jobs.Run( Increment, nullptr, &many );
+			jobs.Run( RecordCount, &seenAtEnd, &after, &many );
+			jobs.Wait( &after );
+			jobs.Wait( &many );
+			TEST_CHECK( seenAtEnd == 64 );
+		}
+	}
+
+	void TestParallelFor( vsJobSystem& jobs )
+	{
+		const int sizes[] = { 0, 1, 7, 1000, 100003 };
+		for ( int size : sizes )
+		{
+			std::vector< std::atomic<int> > hit( size );
+			for ( int i = 0; i < size; i++ )
+				hit[i] = 0;
+			jobs.ParallelFor( 0, size, 16, [&]( int start, int end ) {
+				for ( int i = start; i < end; i++ )
+					hit[i]++;
+			} );
+			for ( int i = 0; i < size; i++ )
+				TEST_CHECK( hit[i] == 1 );
+		}
+	}
+
+	void TestNestedParallelFor( vsJobSystem& jobs )
+	{
+		std::atomic<int> total( 0 );
+		jobs.ParallelFor( 0, 64, 1, [&]( int start, int end ) {
+			for ( int i = start; i < end; i++ )
+				jobs.ParallelFor( 0, 1000, 10, [&]( int a, int b ) { total += b - a; } );
+		} );
+		TEST_CHECK( total == 64000 );
+	}
+}
+
+int main()
+{
+	vsThread_Init();
+
+	const int workerCounts[] = { 0, 1, 3, 7 };
+	for ( int workers : workerCounts )
+	{
+		vsJobSystem jobs( workers );
+		TestManyJobs( jobs );
+		TestDependencyChain( jobs );
+		TestFanIn( jobs );
+		TestParallelFor( jobs );
+		TestNestedParallelFor( jobs );
+	}
+
+	// And the same job system, with its workers replaced between runs.
+	{
+		vsJobSystem jobs( 0 );
+		for ( int workers : workerCounts )
+		{
+			jobs.SetWorkerCount( workers );
+			TEST_CHECK( jobs.GetWorkerCount() == workers );
+			TestManyJobs( jobs );
+			TestParallelFor( jobs );
+		}
+		jobs.SetWorkerCount( 0 );
+		TestFanIn( jobs );
+	}
+
+	vsThread_Deinit();
+	return vsTestResult();
+}
@@ -0,0 +1,183 @@
+/*
+ *  Test_Octree.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Camera.h"
+#include "VS_Frustum.h"
+#include "VS_Model.h"
+#include "VS_Octree.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Moves models around inside a vsOctree and checks its culling against
+// testing every model against the frustum:  each model which might be
+// visible must be drawn exactly once.  (The octree is allowed to draw some
+// models which turn out to be outside the frustum;  it only culls whole
+// nodes.)  Frustums come from a camera, which needs a screen, so this runs
+// inside a headless game.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	float Random( float min, float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return min + (max - min) * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	vsVector3D RandomVector( float range )
+	{
+		return vsVector3D( Random(-range,range), Random(-range,range), Random(-range,range) );
+	}
+
+	// Counts its draws, instead of drawing.
+	class CountedModel : public vsModel
+	{
+	public:
+		int m_drawCount;
+
+		CountedModel(): m_drawCount(0) {}
+		virtual void Draw( vsRenderQueue *queue ) { UNUSED(queue); m_drawCount++; }
+	};
+
+	struct Mover
+	{
+		CountedModel *		model;
+		vsOctreeModelInfo *	info;
+		vsVector3D			velocity;
+	};
+
+	// Draws the octree, and checks that every model was drawn the right
+	// number of times.  Returns how many were drawn.
+	int DrawAndCheck( vsOctree *octree, const vsCamera3D& camera, const std::vector<Mover>& mover )
+	{
+		for ( size_t i = 0; i < mover.size(); i++ )
+			mover[i].model->m_drawCount = 0;
+
+		octree->Draw( &camera, nullptr );
+
+		int drawn = 0;
+		for ( size_t i = 0; i < mover.size(); i++ )
+		{
+			const CountedModel *model = mover[i].model;
+			if ( mover[i].info == nullptr )
+				TEST_CHECK( model->m_drawCount == 0 );
+			else
+			{
+				vsBox3D bounds = model->GetBoundingBox() + model->GetPosition();
+				bool visible = camera.GetFrustum().ClassifyBox3D( bounds ) != vsFrustum::Outside;
+				TEST_CHECK( model->m_drawCount <= 1 );
+				TEST_CHECK( !visible || model->m_drawCount == 1 );
+			}
+			drawn += model->m_drawCount;
+		}
+		return drawn;
+	}
+
+	void TestLevels( int levels )
+	{
+		const int modelCount = 5000;
+		const float range = 1000.f;
+		vsOctree octree( vsBox3D( vsVector3D(-range,-range,-range), vsVector3D(range,range,range) ), levels );
+
+		// Mostly small models, with some large enough to only fit in the
+		// top levels, and some which start outside the octree's area.
+		std::vector<Mover> mover( modelCount );
+		for ( int i = 0; i < modelCount; i++ )
+		{
+			float size = ( i % 50 == 0 ) ? Random( 100.f, 800.f ) : Random( 0.5f, 5.f );
+			mover[i].model = new CountedModel;
+			mover[i].model->SetBoundingBox( vsBox3D( vsVector3D(-size,-size,-size), vsVector3D(size,size,size) ) );
+			mover[i].model->SetPosition( RandomVector( ( i % 40 == 1 ) ? 1500.f : range ) );
+			mover[i].velocity = RandomVector( 20.f );
+			mover[i].info = octree.AddModel( mover[i].model );
+		}
+
+		vsCamera3D camera;
+		camera.SetNearPlane( 0.1f );
+		camera.SetFarPlane( 1000.f );
+
+		for ( int frame = 0; frame < 40; frame++ )
+		{
+			// Swing the camera around, so we look at different parts of the
+			// tree, and move most of the models.  Some of them wander out of
+			// the octree's area, and back in again.
+			float angle = frame * 0.3f;
+			camera.SetPosition( vsVector3D( 0.f, 0.f, frame * 10.f - 200.f ) );
+			camera.SetOrientation( vsQuaternion( vsVector3D( vsSin(angle), 0.2f, vsCos(angle) ), vsVector3D( 0.f, 1.f, 0.f ) ) );
+
+			for ( int i = frame % 4; i < modelCount; i += 4 )
+			{
+				if ( mover[i].info )
+				{
+					mover[i].model->SetPosition( mover[i].model->GetPosition() + mover[i].velocity );
+					octree.UpdateModel( mover[i].info );
+				}
+			}
+
+			// Take some models out partway through, and put them back later.
+			if ( frame == 10 || frame == 30 )
+			{
+				for ( int i = 0; i < modelCount; i += 3 )
+				{
+					if ( mover[i].info )
+					{
+						octree.RemoveModel( mover[i].info );
+						mover[i].info = nullptr;
+					}
+					else
+						mover[i].info = octree.AddModel( mover[i].model );
+				}
+			}
+
+			int live = 0;
+			for ( int i = 0; i < modelCount; i++ )
+				live += mover[i].info ? 1 : 0;
+
+			// It had better be culling something, unless the tree is too
+			// shallow to cull anything.
+			int drawn = DrawAndCheck( &octree, camera, mover );
+			TEST_CHECK( drawn > 0 && drawn <= live );
+			TEST_CHECK( levels < 2 || drawn < live );
+		}
+
+		for ( int i = 0; i < modelCount; i++ )
+		{
+			if ( mover[i].info )
+				octree.RemoveModel( mover[i].info );
+			vsDelete( mover[i].model );
+		}
+	}
+}
+
+class OctreeTestGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+		for ( int levels = 0; levels <= 6; levels++ )
+			TestLevels( levels );
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", OctreeTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
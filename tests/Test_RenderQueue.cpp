@@ -0,0 +1,379 @@
+/*
+ *  Test_RenderQueue.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_DisplayList.h"
+#include "VS_DynamicMaterial.h"
+#include "VS_JobSystem.h"
+#include "VS_Primitive.h"
+#include "VS_Renderer_Recording.h"
+#include "VS_RenderQueue.h"
+#include "VS_Scene.h"
+#include "VS_Screen.h"
+#include "VS_ShaderValues.h"
+#include "VS_Sprite.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Feeds batches straight into a vsRenderQueue and reads back the display list
+// it draws, to check the order that batches and their elements come out in.
+// Then draws a scene full of sprites serially and through vsParallelDraw with
+// different numbers of job system workers;  every way must record exactly the
+// same frame.  Materials need a renderer, so this runs inside a headless game.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	uint32_t Random()
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return s_seed >> 8;
+	}
+
+	vsMatrix4x4 Translation( float x, float y, float z )
+	{
+		vsMatrix4x4 m;
+		m.SetTranslation( vsVector3D(x,y,z) );
+		return m;
+	}
+
+	struct DrawnElement
+	{
+		vsMaterial *		material;
+		vsVector3D			position;
+
+		// For instanced elements.
+		const vsMatrix4x4 *	instanceMatrix;
+		int					instanceCount;
+		const vsColor *		instanceColor;
+		vsShaderValues *	shaderValues;
+	};
+
+	// Draws the queue, and returns what was drawn for each element, in the
+	// order they were drawn.
+	std::vector<DrawnElement> Draw( vsRenderQueue *queue )
+	{
+		vsDisplayList list( 1024 * 1024, true );
+		queue->Draw( &list );
+		queue->EndRender();
+
+		std::vector<DrawnElement> result;
+		vsMaterial *material = nullptr;
+		vsDisplayList::Iterator it = list.GetOps();
+		for ( vsDisplayList::OpView op = it.Next(); op.IsValid(); op = it.Next() )
+		{
+			if ( op.GetType() == vsDisplayList::OpCode_SetMaterial )
+				material = op.GetPointer<vsMaterial>();
+			else if ( op.GetType() == vsDisplayList::OpCode_SetMatrix4x4 ||
+					op.GetType() == vsDisplayList::OpCode_SetMatrices4x4 )
+			{
+				// Each element starts by setting its matrix.
+				DrawnElement e;
+				e.material = material;
+				e.position = vsVector3D::Zero;
+				e.instanceMatrix = nullptr;
+				e.instanceCount = 0;
+				e.instanceColor = nullptr;
+				e.shaderValues = nullptr;
+				if ( op.GetType() == vsDisplayList::OpCode_SetMatrix4x4 )
+					e.position = vsVector3D( op.Get<vsMatrix4x4>().w );
+				else
+				{
+					e.instanceMatrix = op.GetPointer<vsMatrix4x4>();
+					e.instanceCount = op.Get<uint32_t>( sizeof(void*) );
+				}
+				result.push_back( e );
+			}
+			else if ( op.GetType() == vsDisplayList::OpCode_SetColors && !result.empty() )
+				result.back().instanceColor = op.GetPointer<vsColor>();
+			else if ( op.GetType() == vsDisplayList::OpCode_SetShaderValues && !result.empty() )
+				result.back().shaderValues = op.GetPointer<vsShaderValues>();
+		}
+		return result;
+	}
+
+	void StartRender( vsRenderQueue *queue )
+	{
+		queue->StartRender( vsMatrix4x4::Identity, vsMatrix4x4::Identity, vsMatrix4x4::Identity, vsBox2D() );
+	}
+
+	void TestBatchOrder( vsDisplayList *elementList )
+	{
+		// More materials than the batch table starts out with room for, on a
+		// spread of layers (including negative ones), with their elements
+		// submitted in a random order.  Every batch must come out in one
+		// piece, ordered by layer and then by the order the materials were
+		// created in.
+		const int materialCount = 300;
+		const int elementCount = 3000;
+		std::vector<vsDynamicMaterial*> material;
+		std::vector<int> layer;
+		for ( int i = 0; i < materialCount; i++ )
+		{
+			layer.push_back( (int)(Random() % 7) - 3 );
+			material.push_back( new vsDynamicMaterial );
+			material[i]->SetLayer( layer[i] );
+		}
+
+		vsRenderQueue queue;
+		for ( int frame = 0; frame < 2; frame++ )
+		{
+			std::vector<int> submitted( materialCount, 0 );
+			StartRender( &queue );
+			for ( int i = 0; i < elementCount; i++ )
+			{
+				int m = Random() % materialCount;
+				submitted[m]++;
+				queue.AddBatch( material[m], Translation( (float)i, 0.f, 0.f ), elementList );
+			}
+			std::vector<DrawnElement> drawn = Draw( &queue );
+			TEST_CHECK( drawn.size() == (size_t)elementCount );
+
+			int previous = -1;
+			std::vector<bool> seen( materialCount, false );
+			for ( size_t i = 0; i < drawn.size(); )
+			{
+				int m = 0;
+				while ( m < materialCount && drawn[i].material != material[m] )
+					m++;
+				TEST_CHECK( m < materialCount );
+				if ( m == materialCount )
+					break;
+
+				TEST_CHECK( !seen[m] );
+				seen[m] = true;
+				if ( previous >= 0 )
+					TEST_CHECK( layer[previous] < layer[m] || ( layer[previous] == layer[m] && previous < m ) );
+				previous = m;
+
+				int run = 0;
+				while ( i < drawn.size() && drawn[i].material == material[m] )
+				{
+					run++;
+					i++;
+				}
+				TEST_CHECK( run == submitted[m] );
+			}
+		}
+
+		for ( int i = 0; i < materialCount; i++ )
+			vsDelete( material[i] );
+	}
+
+	void TestDepthSort( vsDisplayList *elementList )
+	{
+		// zSort elements draw back to front;  that's largest view space z
+		// first.  We use only a few depths so there are lots of ties, which
+		// must draw in the order they were submitted.  -0 and +0 are the
+		// same depth.
+		const float depths[] = { -100.f, -1.5f, -1e-30f, -0.f, 0.f, 1e-30f, 2.f, 50.f, 1e20f };
+		const int depthCount = sizeof(depths) / sizeof(depths[0]);
+
+		vsDynamicMaterial *material = new vsDynamicMaterial;
+		material->SetZSort( true );
+
+		vsRenderQueue queue;
+		for ( int count = 1; count <= 5000; count *= 7 )
+		{
+			StartRender( &queue );
+			for ( int i = 0; i < count; i++ )
+				queue.AddBatch( material, Translation( (float)i, 0.f, depths[ Random() % depthCount ] ), elementList );
+			std::vector<DrawnElement> drawn = Draw( &queue );
+			TEST_CHECK( drawn.size() == (size_t)count );
+
+			for ( size_t i = 1; i < drawn.size(); i++ )
+			{
+				const vsVector3D& a = drawn[i-1].position;
+				const vsVector3D& b = drawn[i].position;
+				TEST_CHECK( a.z >= b.z );
+				if ( a.z == b.z )
+					TEST_CHECK( a.x < b.x );
+			}
+		}
+
+		vsDelete( material );
+	}
+
+	void TestElements( vsDisplayList *elementList )
+	{
+		// One batch with enough elements that its array has to grow several
+		// times, mixing plain elements with instanced ones (which keep their
+		// extra data out of line).  Everything must survive the moves, and
+		// the batch must draw most-recently-submitted first.
+		const int elementCount = 1000;
+		vsMatrix4x4 instanceMatrix[8];
+		vsColor instanceColor[8];
+		vsShaderValues values;
+
+		vsDynamicMaterial *material = new vsDynamicMaterial;
+
+		vsRenderQueue queue;
+		StartRender( &queue );
+		for ( int i = 0; i < elementCount; i++ )
+		{
+			if ( i % 20 == 10 )
+				queue.AddInstanceBatch( material, instanceMatrix, instanceColor, 1 + i % 8, elementList, &values );
+			else if ( i % 10 == 5 )
+				queue.AddInstanceBatch( material, instanceMatrix, 1 + i % 8, elementList );
+			else
+				queue.AddBatch( material, Translation( (float)i, 0.f, 0.f ), elementList );
+		}
+		std::vector<DrawnElement> drawn = Draw( &queue );
+		TEST_CHECK( drawn.size() == (size_t)elementCount );
+
+		for ( size_t j = 0; j < drawn.size(); j++ )
+		{
+			int i = elementCount - 1 - (int)j;
+			const DrawnElement& e = drawn[j];
+			TEST_CHECK( e.material == material );
+			if ( i % 20 == 10 )
+			{
+				TEST_CHECK( e.instanceMatrix == instanceMatrix && e.instanceCount == 1 + i % 8 );
+				TEST_CHECK( e.instanceColor == instanceColor );
+				TEST_CHECK( e.shaderValues == &values );
+			}
+			else if ( i % 10 == 5 )
+			{
+				TEST_CHECK( e.instanceMatrix == instanceMatrix && e.instanceCount == 1 + i % 8 );
+				TEST_CHECK( e.instanceColor == nullptr && e.shaderValues == nullptr );
+			}
+			else
+			{
+				TEST_CHECK( e.instanceMatrix == nullptr && e.position.x == (float)i );
+				TEST_CHECK( e.instanceColor == nullptr && e.shaderValues == nullptr );
+			}
+		}
+
+		vsDelete( material );
+	}
+
+	// How the scene gets drawn.  The first is the reference which all the
+	// others must match.
+	struct DrawConfig
+	{
+		bool	parallel;
+		int		workers;
+	};
+	const DrawConfig c_drawConfig[] = { { false, 0 }, { true, 0 }, { true, 1 }, { true, 3 }, { true, 7 } };
+	const int c_drawConfigCount = sizeof(c_drawConfig) / sizeof(c_drawConfig[0]);
+	const int c_spriteCount = 2000;
+	const int c_warmUpFrames = 2;
+
+	// vsDynamicBatchManager's pool alternates between batches from one frame
+	// to the next, so each config draws two frames, and we compare each with
+	// the reference's frame of the same parity.
+	const int c_framesPerConfig = 2;
+}
+
+class RenderQueueTestGame : public coreGame
+{
+	typedef coreGame Parent;
+
+	std::vector<vsSprite*>	m_sprite;
+	uint64_t	m_referenceHash[c_framesPerConfig];
+	int			m_defaultWorkers;
+	int			m_frame;
+	int			m_config;
+
+	void ApplyConfig()
+	{
+		const DrawConfig& config = c_drawConfig[m_config];
+		vsScreen::Instance()->GetScene(0)->SetParallelDraw( config.parallel );
+		vsJobSystem::Instance()->SetWorkerCount( config.parallel ? config.workers : m_defaultWorkers );
+	}
+
+public:
+
+	RenderQueueTestGame():
+		m_defaultWorkers(0),
+		m_frame(0),
+		m_config(0)
+	{
+		m_referenceHash[0] = m_referenceHash[1] = 0;
+	}
+
+	virtual void Init()
+	{
+		Parent::Init();
+
+		// Something for our elements to draw;  the queue just appends it.
+		vsDisplayList elementList( 64 );
+		elementList.SetColor( c_white );
+
+		TestBatchOrder( &elementList );
+		TestDepthSort( &elementList );
+		TestElements( &elementList );
+
+		// Half opaque and half z-sorted, so both the batched and the sorted
+		// paths through the queue have to come out in the same order.
+		vsScene *scene = vsScreen::Instance()->GetScene(0);
+		for ( int i = 0; i < c_spriteCount; i++ )
+		{
+			vsSprite *sprite = new vsSprite;
+			sprite->AddFragment( vsMakeSolidBox2D( vsBox2D( vsVector2D(-2.f,-2.f), vsVector2D(2.f,2.f) ), ( i % 2 ) ? "Translucent" : "White" ) );
+			sprite->SetPosition( vsVector2D( (i % 50) * 4.f - 100.f, (i / 50) * 4.f - 80.f ) );
+			scene->RegisterEntityOnTop( sprite );
+			m_sprite.push_back( sprite );
+		}
+
+		m_defaultWorkers = vsJobSystem::Instance()->GetWorkerCount();
+		ApplyConfig();
+	}
+
+	virtual void Deinit()
+	{
+		for ( size_t i = 0; i < m_sprite.size(); i++ )
+			vsDelete( m_sprite[i] );
+		m_sprite.clear();
+
+		Parent::Deinit();
+	}
+
+	virtual void DrawFrame()
+	{
+		Parent::DrawFrame();
+
+		m_frame++;
+		if ( m_frame <= c_warmUpFrames )
+			return;
+
+		int configFrame = ( m_frame - c_warmUpFrames - 1 ) % c_framesPerConfig;
+		uint64_t hash = vsRenderer_Recording::Instance()->GetLastFrameHash();
+		if ( m_config == 0 )
+			m_referenceHash[configFrame] = hash;
+		else
+			TEST_CHECK( hash == m_referenceHash[configFrame] );
+
+		if ( configFrame == c_framesPerConfig-1 )
+		{
+			m_config++;
+			if ( m_config == c_drawConfigCount )
+			{
+				vsScreen::Instance()->GetScene(0)->SetParallelDraw( false );
+				vsJobSystem::Instance()->SetWorkerCount( m_defaultWorkers );
+				core::SetExit();
+			}
+			else
+				ApplyConfig();
+		}
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", RenderQueueTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,228 @@
+/*
+ *  Test_SIMD.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Box.h"
+#include "VS_Camera.h"
+#include "VS_Frustum.h"
+#include "VS_Matrix.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// The batch math functions promise exactly the same results as calling their
+// one-at-a-time versions in a loop, so that's what we check;  bit for bit.
+// We use awkward counts, so the scalar tails after the four-wide loops get
+// exercised too.  Frustums come from a camera, which needs a screen, so the
+// frustum tests run inside a headless game.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	float Random( float min, float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return min + (max - min) * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	vsVector3D RandomVector( float range )
+	{
+		return vsVector3D( Random(-range,range), Random(-range,range), Random(-range,range) );
+	}
+
+	vsMatrix4x4 RandomMatrix()
+	{
+		vsMatrix4x4 m;
+		m.x.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), Random(-1.f,1.f) );
+		m.y.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), Random(-1.f,1.f) );
+		m.z.Set( Random(-2.f,2.f), Random(-2.f,2.f), Random(-2.f,2.f), Random(-1.f,1.f) );
+		m.w.Set( Random(-100.f,100.f), Random(-100.f,100.f), Random(-100.f,100.f), Random(0.5f,2.f) );
+		return m;
+	}
+
+	bool Identical( const vsVector3D& a, const vsVector3D& b )
+	{
+		return memcmp( &a, &b, sizeof(a) ) == 0;
+	}
+
+	bool Identical( const vsMatrix4x4& a, const vsMatrix4x4& b )
+	{
+		return memcmp( &a, &b, sizeof(a) ) == 0;
+	}
+
+	const int c_counts[] = { 0, 1, 3, 4, 5, 7, 8, 63, 64, 65, 1001 };
+	const int c_countCount = sizeof(c_counts) / sizeof(c_counts[0]);
+
+	void TestTransformPoints()
+	{
+		for ( int c = 0; c < c_countCount; c++ )
+		{
+			int count = c_counts[c];
+			vsMatrix4x4 m = RandomMatrix();
+			std::vector<vsVector3D> in( count + 1 ), out( count + 1 ), inPlace;
+			for ( int i = 0; i < count; i++ )
+				in[i] = RandomVector( 1000.f );
+			inPlace = in;
+
+			// The element past the end mustn't be touched.
+			out[count] = vsVector3D( 1.f, 2.f, 3.f );
+
+			m.ApplyTo( &in[0], &out[0], count );
+			m.ApplyTo( &inPlace[0], &inPlace[0], count );
+			for ( int i = 0; i < count; i++ )
+			{
+				vsVector3D expected = m.ApplyTo( in[i] );
+				TEST_CHECK( Identical( out[i], expected ) );
+				TEST_CHECK( Identical( inPlace[i], expected ) );
+			}
+			TEST_CHECK( Identical( out[count], vsVector3D( 1.f, 2.f, 3.f ) ) );
+		}
+	}
+
+	void TestMultiplyMatrices()
+	{
+		for ( int c = 0; c < c_countCount; c++ )
+		{
+			int count = c_counts[c];
+			vsMatrix4x4 m = RandomMatrix();
+			std::vector<vsMatrix4x4> in( count + 1 ), out( count + 1 ), inPlace;
+			for ( int i = 0; i < count; i++ )
+				in[i] = RandomMatrix();
+			inPlace = in;
+
+			m.ApplyTo( &in[0], &out[0], count );
+			m.ApplyTo( &inPlace[0], &inPlace[0], count );
+			for ( int i = 0; i < count; i++ )
+			{
+				vsMatrix4x4 expected = m.ApplyTo( in[i] );
+				TEST_CHECK( Identical( out[i], expected ) );
+				TEST_CHECK( Identical( inPlace[i], expected ) );
+			}
+			TEST_CHECK( Identical( out[count], vsMatrix4x4::Identity ) );
+		}
+	}
+
+	void TestBounds()
+	{
+		for ( int c = 0; c < c_countCount; c++ )
+		{
+			int count = c_counts[c];
+			std::vector<vsVector3D> point( count + 1 );
+			for ( int i = 0; i < count; i++ )
+				point[i] = RandomVector( 1000.f );
+
+			// Starting from an empty box, and from one which is already set.
+			vsBox3D unset, unsetBatch;
+			vsBox3D set( vsVector3D(-1.f,-1.f,-1.f), vsVector3D(1.f,1.f,1.f) );
+			vsBox3D setBatch = set;
+			for ( int i = 0; i < count; i++ )
+			{
+				unset.ExpandToInclude( point[i] );
+				set.ExpandToInclude( point[i] );
+			}
+			unsetBatch.ExpandToInclude( &point[0], count );
+			setBatch.ExpandToInclude( &point[0], count );
+
+			TEST_CHECK( unset.IsSet() == unsetBatch.IsSet() );
+			if ( unset.IsSet() )
+			{
+				TEST_CHECK( Identical( unset.GetMin(), unsetBatch.GetMin() ) );
+				TEST_CHECK( Identical( unset.GetMax(), unsetBatch.GetMax() ) );
+			}
+			TEST_CHECK( Identical( set.GetMin(), setBatch.GetMin() ) );
+			TEST_CHECK( Identical( set.GetMax(), setBatch.GetMax() ) );
+		}
+	}
+
+	void TestFrustum( const vsFrustum& frustum )
+	{
+		const int count = 4099;
+		std::vector<float> x( count ), y( count ), z( count ), radius( count );
+		std::vector<vsBox3D> box( count );
+		for ( int i = 0; i < count; i++ )
+		{
+			vsVector3D center = RandomVector( 400.f );
+			x[i] = center.x;
+			y[i] = center.y;
+			z[i] = center.z;
+			radius[i] = ( i % 7 == 0 ) ? 0.f : Random( 0.f, 30.f );
+			vsVector3D extent( Random(0.f,30.f), Random(0.f,30.f), Random(0.f,30.f) );
+			box[i] = vsBox3D( center - extent, center + extent );
+		}
+
+		std::vector<vsFrustum::Classification> spheres( count ), boxes( count );
+		frustum.ClassifySpheres( &x[0], &y[0], &z[0], &radius[0], &spheres[0], count );
+		frustum.ClassifyBoxes3D( &box[0], &boxes[0], count );
+
+		int seen[3] = { 0, 0, 0 };
+		for ( int i = 0; i < count; i++ )
+		{
+			TEST_CHECK( spheres[i] == frustum.ClassifySphere( vsVector3D( x[i], y[i], z[i] ), radius[i] ) );
+			TEST_CHECK( boxes[i] == frustum.ClassifyBox3D( box[i] ) );
+			seen[ boxes[i] ]++;
+		}
+
+		// Make sure the test actually covered every outcome.
+		TEST_CHECK( seen[vsFrustum::Outside] > 0 && seen[vsFrustum::Intersect] > 0 && seen[vsFrustum::Inside] > 0 );
+	}
+
+	void TestFrustums()
+	{
+		for ( int f = 0; f < 20; f++ )
+		{
+			vsCamera3D camera( ( f % 4 == 3 ) ? vsCamera3D::PT_Orthographic : vsCamera3D::PT_Perspective );
+			if ( camera.GetProjectionType() == vsCamera3D::PT_Orthographic )
+				camera.SetFieldOfView( 300.f );
+			camera.SetNearPlane( 0.1f );
+			camera.SetFarPlane( 300.f );
+			camera.SetPosition( RandomVector( 10.f ) );
+
+			// Every fourth camera looks straight down an axis, so that its
+			// planes have components which are exactly zero.
+			if ( f % 4 == 0 )
+				camera.SetOrientation( vsQuaternion( vsVector3D( 0.f, 0.f, 1.f ), vsVector3D( 0.f, 1.f, 0.f ) ) );
+			else
+			{
+				vsVector3D forward = RandomVector( 1.f );
+				forward.NormaliseSafe();
+				camera.SetOrientation( vsQuaternion( forward, vsVector3D( 0.f, 1.f, 0.f ) ) );
+			}
+			TestFrustum( camera.GetFrustum() );
+		}
+	}
+}
+
+class SIMDTestGame : public coreGame
+{
+public:
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+		TestFrustums();
+		core::SetExit();
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", SIMDTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	TestTransformPoints();
+	TestMultiplyMatrices();
+	TestBounds();
+
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
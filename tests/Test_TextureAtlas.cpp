@@ -0,0 +1,167 @@
+/*
+ *  Test_TextureAtlas.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_MaterialInternal.h"
+#include "VS_Primitive.h"
+#include "VS_Renderer_Recording.h"
+#include "VS_Scene.h"
+#include "VS_Screen.h"
+#include "VS_Sprite.h"
+#include "VS_TextureAtlas.h"
+
+// Loads a few materials with 'atlas true' and checks that they were packed
+// onto the same page without overlapping, then draws a box with each of
+// them through the recording renderer;  they must all come out in a single
+// draw.  As a control, the same boxes with materials which aren't atlased
+// must take a draw each.
+
+namespace
+{
+	const char *c_atlased[] = { "AtlasRed", "AtlasGreen", "AtlasBlue", "AtlasYellow" };
+	const int c_atlasedCount = sizeof(c_atlased) / sizeof(c_atlased[0]);
+	const char *c_plain[] = { "PlainRed", "PlainBlue" };
+	const int c_plainCount = sizeof(c_plain) / sizeof(c_plain[0]);
+
+	bool Overlaps( const vsAtlasRegion *a, const vsAtlasRegion *b )
+	{
+		return a->x < b->x + b->width && b->x < a->x + a->width &&
+			a->y < b->y + b->height && b->y < a->y + a->height;
+	}
+
+	void TestPacking()
+	{
+		vsMaterial *material[c_atlasedCount];
+		for ( int i = 0; i < c_atlasedCount; i++ )
+			material[i] = new vsMaterial( c_atlased[i] );
+
+		const vsAtlasRegion *first = material[0]->GetResource()->m_atlasRegion;
+		TEST_CHECK( first != nullptr );
+		for ( int i = 0; first && i < c_atlasedCount; i++ )
+		{
+			vsMaterialInternal *resource = material[i]->GetResource();
+			const vsAtlasRegion *region = resource->m_atlasRegion;
+			TEST_CHECK( region != nullptr );
+			if ( !region )
+				continue;
+
+			TEST_CHECK( region->width == 16 && region->height == 16 );
+			TEST_CHECK( region->page == first->page );
+			TEST_CHECK( resource->GetBatchMaterial() == material[0]->GetResource()->GetBatchMaterial() );
+			TEST_CHECK( material[i]->MatchesForBatching( material[0] ) );
+			for ( int j = 0; j < i; j++ )
+				TEST_CHECK( !Overlaps( region, material[j]->GetResource()->m_atlasRegion ) );
+
+			// Texels map inside the region, and anything outside [0..1] is
+			// clamped to its edges instead of landing on a neighbour.
+			vsVector2D low = material[i]->MapTexel( vsVector2D(0.f, 0.f) );
+			vsVector2D high = material[i]->MapTexel( vsVector2D(1.f, 1.f) );
+			TEST_CHECK( low == region->texelMin && high == region->texelMax );
+			TEST_CHECK( region->Map( vsVector2D(-1.f, 2.f) ) == vsVector2D( region->texelMin.x, region->texelMax.y ) );
+			TEST_CHECK( region->Map( vsVector2D(3.f, -0.5f) ) == vsVector2D( region->texelMax.x, region->texelMin.y ) );
+		}
+
+		vsMaterial plain( c_plain[0] );
+		TEST_CHECK( plain.GetResource()->m_atlasRegion == nullptr );
+		TEST_CHECK( !plain.MatchesForBatching( material[0] ) );
+
+		for ( int i = 0; i < c_atlasedCount; i++ )
+			vsDelete( material[i] );
+	}
+}
+
+class TextureAtlasTestGame : public coreGame
+{
+	typedef coreGame Parent;
+
+	vsSprite *	m_atlased[c_atlasedCount];
+	vsSprite *	m_plain[c_plainCount];
+	int			m_frame;
+	uint64_t	m_emptyDraws;	// what the render pipeline draws with nothing in the scene
+
+	static vsSprite * MakeBox( const char *material, int index )
+	{
+		vsSprite *sprite = new vsSprite;
+		sprite->AddFragment( vsMakeTexturedBox2D( vsBox2D( vsVector2D(-10.f,-10.f), vsVector2D(10.f,10.f) ), material ) );
+		sprite->SetPosition( vsVector2D( index * 30.f - 50.f, 0.f ) );
+		return sprite;
+	}
+
+public:
+
+	TextureAtlasTestGame():
+		m_frame(0),
+		m_emptyDraws(0)
+	{
+	}
+
+	virtual void Init()
+	{
+		Parent::Init();
+
+		TestPacking();
+
+		for ( int i = 0; i < c_atlasedCount; i++ )
+			m_atlased[i] = MakeBox( c_atlased[i], i );
+		for ( int i = 0; i < c_plainCount; i++ )
+			m_plain[i] = MakeBox( c_plain[i], i );
+	}
+
+	virtual void Deinit()
+	{
+		for ( int i = 0; i < c_atlasedCount; i++ )
+			vsDelete( m_atlased[i] );
+		for ( int i = 0; i < c_plainCount; i++ )
+			vsDelete( m_plain[i] );
+
+		Parent::Deinit();
+	}
+
+	virtual void DrawFrame()
+	{
+		Parent::DrawFrame();
+
+		uint64_t draws = vsRenderer_Recording::Instance()->GetLastFrameStats().draws;
+		vsScene *scene = vsScreen::Instance()->GetScene(0);
+		if ( m_frame == 0 )
+		{
+			m_emptyDraws = draws;
+			for ( int i = 0; i < c_atlasedCount; i++ )
+				scene->RegisterEntityOnTop( m_atlased[i] );
+		}
+		else if ( m_frame == 1 )
+		{
+			// Four atlased boxes;  one draw.
+			TEST_CHECK( draws == m_emptyDraws + 1 );
+
+			for ( int i = 0; i < c_atlasedCount; i++ )
+				m_atlased[i]->Extract();
+			for ( int i = 0; i < c_plainCount; i++ )
+				scene->RegisterEntityOnTop( m_plain[i] );
+		}
+		else
+		{
+			// Two boxes with their own textures;  a draw each.
+			TEST_CHECK( draws == m_emptyDraws + c_plainCount );
+			core::SetExit();
+		}
+		m_frame++;
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", TextureAtlasTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,201 @@
+/*
+ *  Test_TextureStreamer.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Sleep.h"
+#include "VS_Texture.h"
+#include "VS_TextureInternal.h"
+#include "VS_TextureStreamer.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Streams a handful of PNGs with mixed priorities, cancels one of them while
+// it's still in flight, raises the priority of another after it was
+// requested, and asks for one file which doesn't exist.  Once everything has
+// been decoded, we limit vsTextureStreamer to one upload per frame and watch
+// the textures finish:  they must upload highest priority first, in request
+// order within a priority, and the streamer's stats must add up.
+
+namespace
+{
+	struct Stream
+	{
+		const char *	filename;
+		int				priority;
+		int				size;	// width and height;  zero if it can't load
+	};
+
+	const Stream c_stream[] =
+	{
+		{ "textures/Red.png", 0, 16 },			// raised to c_raisedPriority
+		{ "textures/Checker64.png", 5, 64 },
+		{ "textures/Green.png", 5, 16 },
+		{ "textures/Stripes256.png", 10, 256 },
+		{ "textures/Blue.png", 1, 16 },			// cancelled
+		{ "textures/Checker128.png", -2, 128 },
+		{ "textures/Yellow.png", 5, 16 },
+		{ "textures/Missing.png", -5, 0 },
+	};
+	const int c_streamCount = sizeof(c_stream) / sizeof(c_stream[0]);
+	const int c_raised = 0;
+	const int c_raisedPriority = 20;
+	const int c_cancelled = 4;
+	const int c_expectedOrder[] = { 0, 3, 1, 2, 6, 5, 7 };
+	const int c_expectedCount = sizeof(c_expectedOrder) / sizeof(c_expectedOrder[0]);
+
+	const double c_timeoutMs = 10000.0;
+}
+
+class TextureStreamerTestGame : public coreGame
+{
+	vsTexture *		m_texture[c_streamCount];
+	bool			m_done[c_streamCount];
+	std::vector<int>	m_order;
+	vsTextureStreamer::Stats	m_before;
+	vsTestStopwatch	m_watch;
+	int				m_frame;
+
+	void Start()
+	{
+		vsTextureStreamer *streamer = vsTextureStreamer::Instance();
+		m_before = streamer->GetStats();
+
+		for ( int i = 0; i < c_streamCount; i++ )
+		{
+			m_texture[i] = vsTexture::Stream( c_stream[i].filename, c_stream[i].priority );
+			m_done[i] = false;
+			if ( i == c_cancelled )
+			{
+				// Most likely it's still waiting to be read, or being read.
+				streamer->Cancel( m_texture[i]->GetResource() );
+				m_done[i] = true;
+			}
+		}
+		streamer->SetPriority( m_texture[c_raised]->GetResource(), c_raisedPriority );
+
+		// Nothing gets uploaded during this frame, so wait here until
+		// everything is ready to upload, so that only priority decides the
+		// order they're uploaded in.
+		vsTestStopwatch watch;
+		while ( streamer->GetStats().waitingForUpload < c_expectedCount && watch.GetMilliseconds() < c_timeoutMs )
+			vsSleep(1);
+		TEST_CHECK( streamer->GetStats().waitingForUpload == c_expectedCount );
+		for ( int i = 0; i < c_streamCount; i++ )
+			TEST_CHECK( m_texture[i]->GetResource()->IsStreaming() == !m_done[i] );
+
+		// A budget smaller than any texture is one upload per frame.
+		streamer->SetUploadBudget( 1 );
+	}
+
+	bool Watch()
+	{
+		int finished = 0;
+		for ( int i = 0; i < c_streamCount; i++ )
+		{
+			if ( !m_done[i] && !m_texture[i]->GetResource()->IsStreaming() )
+			{
+				m_done[i] = true;
+				m_order.push_back(i);
+				finished++;
+			}
+		}
+		// The missing file has nothing to upload, so it may come out in the
+		// same frame as the texture before it.
+		TEST_CHECK( finished <= 1 || ( finished == 2 && m_order.back() == c_streamCount-1 ) );
+		return (int)m_order.size() == c_expectedCount;
+	}
+
+	void Finish()
+	{
+		bool ordered = ( (int)m_order.size() == c_expectedCount );
+		for ( int i = 0; ordered && i < c_expectedCount; i++ )
+			ordered = ( m_order[i] == c_expectedOrder[i] );
+		TEST_CHECK( ordered );
+		if ( !ordered )
+		{
+			fprintf( stderr, "Upload order:" );
+			for ( size_t i = 0; i < m_order.size(); i++ )
+				fprintf( stderr, " %s", c_stream[ m_order[i] ].filename );
+			fprintf( stderr, "\n" );
+		}
+
+		uint64_t bytes = 0;
+		int loaded = 0;
+		for ( int i = 0; i < c_streamCount; i++ )
+		{
+			if ( i == c_cancelled || c_stream[i].size == 0 )
+				continue;
+			bytes += c_stream[i].size * c_stream[i].size * 4;
+			loaded++;
+			TEST_CHECK( m_texture[i]->GetResource()->GetWidth() == c_stream[i].size );
+		}
+
+		vsTextureStreamer *streamer = vsTextureStreamer::Instance();
+		vsTextureStreamer::Stats stats = streamer->GetStats();
+		TEST_CHECK( stats.requested - m_before.requested == (uint64_t)c_streamCount );
+		TEST_CHECK( stats.uploaded - m_before.uploaded == (uint64_t)loaded );
+		TEST_CHECK( stats.failed - m_before.failed == 1 );
+		TEST_CHECK( stats.cancelled - m_before.cancelled == 1 );
+		TEST_CHECK( stats.bytesUploaded - m_before.bytesUploaded == bytes );
+		TEST_CHECK( stats.waitingForRead == 0 && stats.waitingForDecode == 0 && stats.waitingForUpload == 0 );
+		TEST_CHECK( stats.inFlight == 0 );
+		TEST_CHECK( stats.maxLatency >= stats.averageLatency && stats.averageLatency > 0.f );
+
+		streamer->SetUploadBudget( vsTextureStreamer::c_defaultUploadBudget );
+	}
+
+public:
+
+	TextureStreamerTestGame():
+		m_frame(0)
+	{
+		for ( int i = 0; i < c_streamCount; i++ )
+		{
+			m_texture[i] = nullptr;
+			m_done[i] = true;
+		}
+	}
+
+	virtual void Deinit()
+	{
+		for ( int i = 0; i < c_streamCount; i++ )
+			vsDelete( m_texture[i] );
+
+		coreGame::Deinit();
+	}
+
+	virtual void Update( float timeStep )
+	{
+		UNUSED(timeStep);
+
+		if ( m_frame++ == 0 )
+		{
+			Start();
+			m_watch.Reset();
+		}
+		else if ( Watch() || m_watch.GetMilliseconds() > c_timeoutMs )
+		{
+			Finish();
+			core::SetExit();
+		}
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", TextureStreamerTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,268 @@
+/*
+ *  Test_Token.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_Record.h"
+#include "VS_Token.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Checks what vsToken extracts from a selection of lines, that extracting
+// from a range of a larger buffer never reads past the end of the range,
+// that floats parse to exactly what strtof() gives, and that vsRecords
+// parse and print the same way with and without arena mode.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	uint32_t Random( uint32_t max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return (s_seed >> 8) % max;
+	}
+
+	struct Expected
+	{
+		vsToken::Type	type;
+		const char *	text;	// for labels and strings
+		double			number;	// for floats and integers
+	};
+
+	struct Line
+	{
+		const char *	text;
+		Expected		token[8];
+		int				tokenCount;
+	};
+
+	const Line c_lines[] =
+	{
+		{ "Label 12 -7 +2.5", { { vsToken::Type_Label, "Label", 0.f }, { vsToken::Type_Integer, nullptr, 12.f },
+			{ vsToken::Type_Integer, nullptr, -7.f }, { vsToken::Type_Float, nullptr, 2.5f } }, 4 },
+		{ "3.5e2 .5 -.25 1. 0.1", { { vsToken::Type_Float, nullptr, 350.f }, { vsToken::Type_Float, nullptr, 0.5f },
+			{ vsToken::Type_Float, nullptr, -0.25f }, { vsToken::Type_Float, nullptr, 1.f }, { vsToken::Type_Float, nullptr, 0.1f } }, 5 },
+		{ "\"a \\\"quoted\\\" string\" {}=;", { { vsToken::Type_String, "a \"quoted\" string", 0.f }, { vsToken::Type_OpenBrace, nullptr, 0.f },
+			{ vsToken::Type_CloseBrace, nullptr, 0.f }, { vsToken::Type_Equals, nullptr, 0.f }, { vsToken::Type_Semicolon, nullptr, 0.f } }, 5 },
+		{ "label_with_underscores _x a1.2-3", { { vsToken::Type_Label, "label_with_underscores", 0.f }, { vsToken::Type_Label, "_x", 0.f },
+			{ vsToken::Type_Label, "a1.2-3", 0.f } }, 3 },
+		{ "a,b,\tc", { { vsToken::Type_Label, "a", 0.f }, { vsToken::Type_Label, "b", 0.f }, { vsToken::Type_Label, "c", 0.f } }, 3 },
+		{ "12abc", { { vsToken::Type_Integer, nullptr, 12.f }, { vsToken::Type_Label, "abc", 0.f } }, 2 },
+		{ "2147483647 -2147483648", { { vsToken::Type_Integer, nullptr, 2147483647.0 }, { vsToken::Type_Integer, nullptr, -2147483648.0 } }, 2 },
+		{ "x # a comment { 1 2 }", { { vsToken::Type_Label, "x", 0.f } }, 1 },
+		{ "# only a comment", { }, 0 },
+		{ "   \t ", { }, 0 },
+		{ "\"unterminated", { { vsToken::Type_String, "unterminated", 0.f } }, 1 },
+		{ "\"a long string, too long to fit inside a vsString without allocating\" end",
+			{ { vsToken::Type_String, "a long string, too long to fit inside a vsString without allocating", 0.f }, { vsToken::Type_Label, "end", 0.f } }, 2 },
+	};
+	const int c_lineCount = sizeof(c_lines) / sizeof(c_lines[0]);
+
+	bool Matches( const vsToken& token, const Expected& expected )
+	{
+		if ( !token.IsType( expected.type ) )
+			return false;
+		switch ( expected.type )
+		{
+			case vsToken::Type_Label:
+			case vsToken::Type_String:
+				return token.AsString() == expected.text;
+			case vsToken::Type_Integer:
+				return token.AsInteger() == (int)expected.number;
+			case vsToken::Type_Float:
+				return token.AsFloat() == (float)expected.number;
+			default:
+				return true;
+		}
+	}
+
+	void TestLines()
+	{
+		for ( int i = 0; i < c_lineCount; i++ )
+		{
+			const Line& line = c_lines[i];
+
+			// Consuming a vsString.
+			vsString string( line.text );
+			vsToken token;
+			int count = 0;
+			while ( token.ExtractFrom( string ) )
+			{
+				TEST_CHECK( count < line.tokenCount && Matches( token, line.token[count] ) );
+				count++;
+			}
+			TEST_CHECK( count == line.tokenCount );
+			TEST_CHECK( string.empty() );
+
+			// Reading from a range inside a larger buffer.  Whatever follows
+			// the range must not be read.
+			vsString buffer = vsString( line.text ) + "9\"{ trailing";
+			const char *cursor = buffer.c_str();
+			const char *end = cursor + strlen( line.text );
+			count = 0;
+			while ( token.ExtractFrom( cursor, end ) )
+			{
+				TEST_CHECK( count < line.tokenCount && Matches( token, line.token[count] ) );
+				TEST_CHECK( cursor <= end );
+				count++;
+			}
+			TEST_CHECK( count == line.tokenCount );
+		}
+	}
+
+	void TestRandomLines()
+	{
+		// Scraps of the awkward bits of the syntax, glued together at
+		// random.  Both ways of extracting must agree on every line.  (No
+		// exponents;  glued together, those mostly make numbers too big for
+		// a float, and the log fills up with complaints about them.)
+		const char *pieces[] = { " ", "\t", ",", "{", "}", ";", "=", "#", "\"", "\\", "\\n", "\\\"", "-", "+", ".", "0", "1", "12",
+			"3.5", "-0.25", "1.", "-.5", "+.", "..", "1.2.3", "abc", "_x", "a1.2-3", "@", "!$%", "\r", "0.000001", "123456.789" };
+		const int pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+
+		for ( int i = 0; i < 20000; i++ )
+		{
+			vsString line;
+			int pieceTotal = Random( 12 );
+			for ( int p = 0; p < pieceTotal; p++ )
+				line += pieces[ Random( pieceCount ) ];
+
+			vsString string = line;
+			vsString buffer = line + "7 trailing";
+			const char *cursor = buffer.c_str();
+			const char *end = cursor + line.size();
+
+			vsToken fromString, fromRange;
+			for ( int guard = 0; guard < 100; guard++ )
+			{
+				bool a = fromString.ExtractFrom( string );
+				bool b = fromRange.ExtractFrom( cursor, end );
+				TEST_CHECK( a == b && fromString == fromRange );
+				TEST_CHECK( cursor <= end );
+				if ( !a || !b )
+					break;
+			}
+		}
+	}
+
+	void TestFloats()
+	{
+		// Every float must come out exactly as strtof() would read it,
+		// including values which are very nearly halfway between two floats.
+		int checked = 0;
+		for ( int i = 0; i < 200000; i++ )
+		{
+			char text[64];
+			if ( i % 7 == 0 )
+			{
+				float f = (float)Random( 100000 ) / (float)( 1 << Random( 20 ) );
+				double halfway = (double)f + ( (double)nextafterf( f, 1e30f ) - f ) * 0.5;
+				snprintf( text, sizeof(text), "%.17f", halfway );
+			}
+			else
+			{
+				int length = 0;
+				if ( Random( 3 ) == 0 )
+					text[length++] = Random( 2 ) ? '-' : '+';
+				int intDigits = Random( 9 );
+				int fracDigits = Random( 24 );
+				for ( int d = 0; d < intDigits; d++ )
+					text[length++] = '0' + Random( 10 );
+				text[length++] = '.';
+				for ( int d = 0; d < fracDigits; d++ )
+					text[length++] = '0' + Random( 10 );
+				text[length] = 0;
+			}
+
+			vsString string( text );
+			vsToken token;
+			token.ExtractFrom( string );
+			if ( !token.IsNumeric() )
+				continue;	// things like "+." are strings
+
+			float expected = strtof( text, nullptr );
+			float got = token.AsFloat();
+			TEST_CHECK( memcmp( &got, &expected, sizeof(float) ) == 0 );
+			checked++;
+		}
+		TEST_CHECK( checked > 150000 );
+	}
+
+	// Feeds 'text' to 'record' a line at a time, the way vsFile::Record()
+	// does.  (vsRecord::ParseString() only handles a single line;  it
+	// doesn't split on newlines.)
+	void ParseLines( vsRecord *record, const char *text )
+	{
+		record->Init();
+		while ( *text )
+		{
+			const char *lineEnd = strchr( text, '\n' );
+			if ( !lineEnd )
+				lineEnd = text + strlen( text );
+			record->ParseString( vsString( text, lineEnd - text ) );
+			text = *lineEnd ? lineEnd + 1 : lineEnd;
+		}
+	}
+
+	void TestRecords()
+	{
+		const char *text =
+			"Thing 1 2.5 \"s\"\n"
+			"{\n"
+			"\tchild a b # comment\n"
+			"\tother { inner 3 }\n"
+			"\tlist\n"
+			"\t{\n"
+			"\t\t1 2 3\n"
+			"\t\t4 5 6\n"
+			"\t}\n"
+			"}";
+
+		vsRecord plain;
+		ParseLines( &plain, text );
+		TEST_CHECK( plain.GetLabel().AsString() == "Thing" && plain.GetTokenCount() == 3 );
+		TEST_CHECK( plain.GetChildCount() == 3 );
+		if ( plain.GetChildCount() == 3 )
+		{
+			TEST_CHECK( plain.GetChild(0)->GetLabel().AsString() == "child" && plain.GetChild(0)->GetTokenCount() == 2 );
+			TEST_CHECK( plain.GetChild(1)->GetChildCount() == 1 && plain.GetChild(1)->GetChild(0)->GetToken(0).AsInteger() == 3 );
+			TEST_CHECK( plain.GetChild(2)->GetChildCount() == 2 && plain.GetChild(2)->GetChild(1)->GetTokenCount() == 3 );
+		}
+
+		// Printing and parsing again must give the same record.
+		vsString printed = plain.ToString();
+		vsRecord reparsed;
+		ParseLines( &reparsed, printed.c_str() );
+		TEST_CHECK( reparsed.ToString() == printed );
+
+		// Arena mode must parse exactly the same way, including when a record
+		// is parsed over the top of an earlier one.
+		vsRecord arena;
+		arena.SetArenaMode( true );
+		for ( int i = 0; i < 3; i++ )
+		{
+			ParseLines( &arena, text );
+			TEST_CHECK( arena.ToString() == printed );
+			ParseLines( &arena, "Small 1" );
+			TEST_CHECK( arena.GetChildCount() == 0 && arena.ToString() == vsRecord( "Small 1" ).ToString() );
+		}
+	}
+}
+
+int main()
+{
+	TestLines();
+	TestRandomLines();
+	TestFloats();
+	TestRecords();
+	return vsTestResult();
+}
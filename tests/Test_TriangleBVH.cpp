@@ -0,0 +1,190 @@
+/*
+ *  Test_TriangleBVH.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_TriangleBVH.h"
+#include "VS_JobSystem.h"
+#include "VS_Math.h"
+
+#include "VS/VS_DisableDebugNew.h"
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "VS/VS_EnableDebugNew.h"
+
+// Checks vsTriangleBVH's ray queries against testing every triangle, on a
+// bumpy heightfield and on a degenerate mesh which builds the deepest tree
+// it can.
+
+namespace
+{
+	uint32_t s_seed = 12345;
+	float Random( float max )
+	{
+		s_seed = s_seed * 1103515245 + 12345;
+		return max * (s_seed >> 8) / (float)(1 << 24);
+	}
+
+	// Two triangles per grid square, about 'triangleCount' triangles in all,
+	// covering (0..100) on x and z.
+	std::vector<vsVector3D> MakeHeightfield( int triangleCount )
+	{
+		int n = (int)sqrtf( triangleCount * 0.5f );
+		std::vector<vsVector3D> v;
+		auto h = [n]( int x, int z ) { return vsVector3D( x*100.f/n, 5.f*sinf(x*0.37f)*cosf(z*0.29f), z*100.f/n ); };
+		for ( int x = 0; x < n; x++ )
+		{
+			for ( int z = 0; z < n; z++ )
+			{
+				v.push_back( h(x,z) ); v.push_back( h(x+1,z) ); v.push_back( h(x,z+1) );
+				v.push_back( h(x+1,z) ); v.push_back( h(x+1,z+1) ); v.push_back( h(x,z+1) );
+			}
+		}
+		return v;
+	}
+
+	// Rays down at the heightfield from above it.  Some are aimed past its
+	// edges, and some are too short to reach it, so not every ray hits.
+	std::vector<vsTriangleBVH::Ray> MakeRays( int count )
+	{
+		std::vector<vsTriangleBVH::Ray> rays( count );
+		for ( int i = 0; i < count; i++ )
+		{
+			vsTriangleBVH::Ray& r = rays[i];
+			r.pos = vsVector3D( Random(100.f), 50.f, Random(100.f) );
+			r.dir = vsVector3D( Random(140.f) - 20.f, 0.f, Random(140.f) - 20.f ) - r.pos;
+			r.dir.Normalise();
+			r.maxT = ( i % 4 == 3 ) ? 40.f + Random(30.f) : FLT_MAX;
+		}
+		return rays;
+	}
+
+	// The closest hit along the ray, by testing every triangle.  Returns -1
+	// if nothing is hit before 'ray.maxT'.
+	int BruteForce( const vsTriangleBVH::Ray& ray, const std::vector<vsVector3D>& v, float *bestT )
+	{
+		int best = -1;
+		*bestT = ray.maxT;
+		for ( size_t j = 0; j < v.size() / 3; j++ )
+		{
+			float t, u, w;
+			if ( vsCollideRayVsTriangle( ray.pos, ray.dir, v[j*3], v[j*3+1], v[j*3+2], &t, &u, &w ) && t < *bestT )
+			{
+				*bestT = t;
+				best = (int)j;
+			}
+		}
+		return best;
+	}
+
+	void TestHeightfield()
+	{
+		std::vector<vsVector3D> mesh = MakeHeightfield( 20000 );
+		int triangleCount = (int)mesh.size() / 3;
+		vsTriangleBVH bvh;
+		bvh.Build( &mesh[0], triangleCount );
+		TEST_CHECK( bvh.GetTriangleCount() == triangleCount );
+		TEST_CHECK( bvh.GetNodeCount() > 1 );
+
+		std::vector<vsTriangleBVH::Ray> rays = MakeRays( 1000 );
+		std::vector<vsTriangleBVH::Hit> closest( rays.size() );
+		std::vector<vsTriangleBVH::Hit> any( rays.size() );
+		int closestHits = bvh.CollideRays( &rays[0], &closest[0], (int)rays.size() );
+		int anyHits = bvh.CollideRays( &rays[0], &any[0], (int)rays.size(), true );
+
+		int expectedHits = 0;
+		for ( size_t i = 0; i < rays.size(); i++ )
+		{
+			float bestT;
+			int best = BruteForce( rays[i], mesh, &bestT );
+			if ( best >= 0 )
+				expectedHits++;
+
+			// Two triangles can share the closest point (along an edge), so
+			// compare distances rather than which triangle we got.
+			vsTriangleBVH::Hit hit;
+			bool got = bvh.CollideRay( rays[i], &hit );
+			TEST_CHECK( got == ( best >= 0 ) );
+			TEST_CHECK( !got || hit.t == bestT );
+			TEST_CHECK( got || hit.triangle == -1 );
+
+			TEST_CHECK( closest[i].triangle == hit.triangle && closest[i].t == hit.t );
+
+			bool gotAny = bvh.CollideRayAny( rays[i], &hit );
+			TEST_CHECK( gotAny == ( best >= 0 ) );
+			TEST_CHECK( !gotAny || ( hit.triangle >= 0 && hit.t < rays[i].maxT && hit.t >= bestT ) );
+			TEST_CHECK( ( any[i].triangle >= 0 ) == ( best >= 0 ) );
+		}
+		TEST_CHECK( closestHits == expectedHits && anyHits == expectedHits );
+		TEST_CHECK( expectedHits > 0 && expectedHits < (int)rays.size() );
+	}
+
+	void TestDeepTree()
+	{
+		// A chain of triangles at exponentially growing distances.  Each one
+		// is far enough from the next that it gets a bin to itself, so every
+		// split just peels the farthest triangle off the chain, and the tree
+		// gets as deep as we let it.
+		std::vector<vsVector3D> v;
+		std::vector<float> distance;
+		for ( float d = 16.f; d < 1e17f; d *= 1.1f )
+		{
+			v.push_back( vsVector3D( -d, -0.5f, -0.5f ) );
+			v.push_back( vsVector3D( -d, -0.5f, 0.5f ) );
+			v.push_back( vsVector3D( -d, 0.5f, 0.f ) );
+			distance.push_back( d );
+		}
+		int triangleCount = (int)distance.size();
+		vsTriangleBVH bvh;
+		bvh.Build( &v[0], triangleCount );
+
+		// A ray starting just behind each triangle must hit that one first.
+		for ( int i = 0; i < triangleCount; i++ )
+		{
+			vsTriangleBVH::Ray r;
+			r.pos = vsVector3D( -distance[i] * 1.04f, 0.f, 0.f );
+			r.dir = vsVector3D( 1.f, 0.f, 0.f );
+			r.maxT = FLT_MAX;
+			vsTriangleBVH::Hit hit;
+			TEST_CHECK( bvh.CollideRay( r, &hit ) && hit.triangle == i );
+			TEST_CHECK( bvh.CollideRayAny( r, &hit ) );
+		}
+	}
+
+	void TestEmpty()
+	{
+		vsTriangleBVH bvh;
+		bvh.Build( nullptr, 0 );
+		TEST_CHECK( bvh.GetTriangleCount() == 0 && bvh.GetNodeCount() == 0 );
+
+		vsTriangleBVH::Ray r;
+		r.pos = vsVector3D::Zero;
+		r.dir = vsVector3D( 0.f, 0.f, 1.f );
+		r.maxT = FLT_MAX;
+		vsTriangleBVH::Hit hit;
+		TEST_CHECK( !bvh.CollideRay( r, &hit ) && hit.triangle == -1 );
+		TEST_CHECK( !bvh.CollideRayAny( r, &hit ) );
+	}
+}
+
+int main()
+{
+	TestEmpty();
+	TestDeepTree();
+
+	// Once on the calling thread, and once spreading CollideRays() across
+	// workers.
+	TestHeightfield();
+	{
+		vsJobSystem jobs( 3 );
+		TestHeightfield();
+	}
+
+	return vsTestResult();
+}
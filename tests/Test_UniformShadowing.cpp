@@ -0,0 +1,193 @@
+/*
+ *  Test_UniformShadowing.cpp
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#include "VS_Test.h"
+#include "VS_HeadlessTest.h"
+
+#include "VS_Primitive.h"
+#include "VS_Renderer_Recording.h"
+#include "VS_Scene.h"
+#include "VS_Screen.h"
+#include "VS_Shader.h"
+#include "VS_Sprite.h"
+
+// vsShaderVariant::Prepare() skips setting a material's uniforms when it's
+// given the same shader values as last time and none of them have changed.
+// This draws a box whose material has two uniforms of its own ('tint' and
+// 'pulse') through the recording renderer, and changes those uniforms in
+// each of the ways they can change, checking from the command log which
+// ones get uploaded each frame.  Anything set through Set*(), or through a
+// parent set of values, must be uploaded the frame after it changes;  a
+// bound uniform must be uploaded whenever the variable it's bound to changes,
+// even though nobody tells us about it.
+
+namespace
+{
+	struct Uploads
+	{
+		int			prepares;	// of our material
+		int			tint;
+		int			pulse;
+		int			total;		// of any uniform, by any shader
+		uint64_t	skipped;
+	};
+
+	Uploads CountUploads( vsMaterial *material )
+	{
+		vsRenderer_Recording *renderer = vsRenderer_Recording::Instance();
+		vsShader *shader = material->GetResource()->m_shader;
+		uint32_t materialId = renderer->FindResourceId( material );
+		int32_t tintId = shader->GetUniformId( "tint" );
+		int32_t pulseId = shader->GetUniformId( "pulse" );
+
+		// Uniform uploads which come between our material being prepared and
+		// the next draw are from our shader.
+		Uploads result = { 0, 0, 0, 0, renderer->GetLastFrameStats().uniformUploadsSkipped };
+		bool ours = false;
+		const vsArray<vsRenderer_Recording::Command>& log = renderer->GetLastFrameLog();
+		for ( int i = 0; i < log.ItemCount(); i++ )
+		{
+			const vsRenderer_Recording::Command& c = log[i];
+			switch ( c.type )
+			{
+				case vsRenderer_Recording::Command_PrepareShader:
+					ours = ( materialId != 0 && c.a == materialId );
+					if ( ours )
+						result.prepares++;
+					break;
+				case vsRenderer_Recording::Command_UseProgram:
+				case vsRenderer_Recording::Command_Draw:
+				case vsRenderer_Recording::Command_DrawBuffer:
+					ours = false;
+					break;
+				case vsRenderer_Recording::Command_Uniform:
+					result.total++;
+					if ( ours && (int32_t)c.b == tintId )
+						result.tint++;
+					if ( ours && (int32_t)c.b == pulseId )
+						result.pulse++;
+					break;
+				default:
+					break;
+			}
+		}
+		return result;
+	}
+}
+
+class UniformShadowingTestGame : public coreGame
+{
+	typedef coreGame Parent;
+
+	vsSprite *		m_sprite;
+	vsMaterial *	m_material;
+	vsShaderValues *m_parentValues;
+	float			m_boundPulse;
+	Uploads			m_first;
+	int				m_frame;
+
+public:
+
+	UniformShadowingTestGame():
+		m_sprite(nullptr),
+		m_material(nullptr),
+		m_parentValues(nullptr),
+		m_boundPulse(0.f),
+		m_frame(0)
+	{
+	}
+
+	virtual void Init()
+	{
+		Parent::Init();
+
+		vsFragment *fragment = vsMakeSolidBox2D( vsBox2D( vsVector2D(-10.f,-10.f), vsVector2D(10.f,10.f) ), "Uniforms" );
+		m_material = fragment->GetMaterial();
+		m_material->SetUniformF( "tint", 0.5f );
+		m_parentValues = new vsShaderValues;
+
+		m_sprite = new vsSprite;
+		m_sprite->AddFragment( fragment );
+		vsScreen::Instance()->GetScene(0)->RegisterEntityOnTop( m_sprite );
+
+		TEST_CHECK( m_material->GetResource()->m_shader->GetUniformId( "tint" ) >= 0 );
+		TEST_CHECK( m_material->GetResource()->m_shader->GetUniformId( "pulse" ) >= 0 );
+	}
+
+	virtual void Deinit()
+	{
+		vsDelete( m_sprite );
+		vsDelete( m_parentValues );
+
+		Parent::Deinit();
+	}
+
+	virtual void DrawFrame()
+	{
+		Parent::DrawFrame();
+
+		// Changes we make here show up in the next frame's log.
+		Uploads uploads = CountUploads( m_material );
+		TEST_CHECK( uploads.prepares == 1 );
+		switch ( m_frame )
+		{
+			case 0:
+				// Everything is new.  ('pulse' hasn't been given a value, and
+				// a headless shader starts out with all its uniforms zero, so
+				// there's nothing to upload for it yet.)
+				TEST_CHECK( uploads.tint == 1 && uploads.pulse == 0 );
+				m_first = uploads;
+				break;
+			case 1:
+				// Exactly the same material and values as last frame.
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 0 );
+				TEST_CHECK( uploads.total < m_first.total );
+				TEST_CHECK( uploads.skipped > m_first.skipped );
+				m_material->SetUniformF( "tint", 0.75f );
+				break;
+			case 2:
+				TEST_CHECK( uploads.tint == 1 && uploads.pulse == 0 );
+				m_parentValues->SetUniformF( "pulse", 2.f );
+				m_material->GetShaderValues()->SetParent( m_parentValues );
+				break;
+			case 3:
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 1 );
+				m_parentValues->SetUniformF( "pulse", 3.f );
+				break;
+			case 4:
+				// Only the parent changed.
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 1 );
+				break;
+			case 5:
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 0 );
+				m_boundPulse = 4.f;
+				m_material->BindUniformF( "pulse", &m_boundPulse );
+				break;
+			case 6:
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 1 );
+				m_boundPulse = 5.f;
+				break;
+			default:
+				// Nothing was told that the bound value changed.
+				TEST_CHECK( uploads.tint == 0 && uploads.pulse == 1 );
+				core::SetExit();
+				break;
+		}
+		m_frame++;
+	}
+};
+
+REGISTER_MAINGAME("HeadlessTest", UniformShadowingTestGame);
+
+int main(int argc, char* argv[])
+{
+	UNUSED(argc);
+	vsRunHeadless( argv[0] );
+	return vsTestResult();
+}
@@ -0,0 +1,45 @@
+/*
+ *  VS_HeadlessTest.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_HEADLESSTEST_H
+#define VS_HEADLESSTEST_H
+
+#include "Core.h"
+#include "CORE_Game.h"
+#include "CORE_GameRegistry.h"
+#include "VS_Renderer.h"
+#include "VS_System.h"
+
+// Tests which need the whole engine (a renderer, materials, the frame arena,
+// and so on) register a coreGame with REGISTER_MAINGAME("HeadlessTest", ...)
+// and call vsRunHeadless() from main().  That starts the engine up with a
+// vsRenderer_Recording instead of OpenGL, runs the game until it calls
+// core::SetExit(), and shuts everything down again.
+//
+// The game's data comes from tests/Data/HeadlessTest, which
+// tests/CMakeLists.txt copies next to the test executables.  Benchmarks
+// which work on a lot of data can ask for a bigger game heap.
+
+inline void
+vsRunHeadless( char *argv0, size_t gameHeapBytes = 1024*1024*32 )
+{
+	char headless[] = "--headless";
+	char *args[] = { argv0, headless, nullptr };
+
+	// The game heap comes out of the global heap, which needs room for the
+	// engine's own allocations as well.
+	vsSystem *system = new vsSystem( "VectorStorm", "HeadlessTest", "HeadlessTest", 2, args, gameHeapBytes * 2 );
+	core::Init( gameHeapBytes );
+	core::SetGame( coreGameRegistry::GetMainMenu() );
+	core::Go();
+	core::Deinit();
+	vsDelete( system );
+}
+
+#endif // VS_HEADLESSTEST_H
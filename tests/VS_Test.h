@@ -0,0 +1,60 @@
+/*
+ *  VS_Test.h
+ *  VectorStorm
+ *
+ *  Created by agent on 18/10/2026
+ *  Copyright 2026 agent.  All rights reserved.
+ *
+ */
+
+#ifndef VS_TEST_H
+#define VS_TEST_H
+
+#include "VS/VS_DisableDebugNew.h"
+#include <chrono>
+#include <cstdio>
+#include "VS/VS_EnableDebugNew.h"
+
+// Shared helpers for the programs in tests/.
+//
+// Tests report every check which fails, and return vsTestResult() from main()
+// so that ctest sees a nonzero exit code if anything went wrong.  Benchmarks
+// just print their timings.
+
+inline int&
+vsTestFailures()
+{
+	static int s_failures = 0;
+	return s_failures;
+}
+
+#define TEST_CHECK(condition) \
+	do { \
+		if ( !(condition) ) \
+		{ \
+			vsTestFailures()++; \
+			fprintf( stderr, "%s:%d:  check failed:  %s\n", __FILE__, __LINE__, #condition ); \
+		} \
+	} while(0)
+
+inline int
+vsTestResult()
+{
+	if ( vsTestFailures() )
+		fprintf( stderr, "%d checks failed\n", vsTestFailures() );
+	return vsTestFailures() ? 1 : 0;
+}
+
+class vsTestStopwatch
+{
+	std::chrono::steady_clock::time_point m_start;
+public:
+	vsTestStopwatch(): m_start( std::chrono::steady_clock::now() ) {}
+
+	void	Reset() { m_start = std::chrono::steady_clock::now(); }
+	double	GetMilliseconds() const { return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - m_start ).count(); }
+	double	GetNanoseconds() const { return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - m_start ).count(); }
+};
+
+#endif // VS_TEST_H
+